@@ -66,10 +66,15 @@ public:
     
     void changed (Channel const& source, Text const& message, Dynamic const& payload) throw()
     {
-        if (message == Text::getMessageQueueBuffer())
+        switch (Text::getMessageID (message))
         {
-            liveQueue.push (payload.as<QueueBuffer>());
-            event.signal();
+            case Text::MessageQueueBuffer:
+                liveQueue.push (payload.as<QueueBuffer>());
+                event.signal();
+                break;
+                
+            default:
+                break;
         }
     }
     
@@ -73,6 +73,7 @@
                            AudioToolbox frameworks.
  - PLONK_AUDIOHOST_JUCE=1 : Use the Juce audio host. You must also link to Juce (either the static library
                             or otherwise using the Introjucer to generate the project).
+ - PLONK_AUDIOHOST_JACK=1 : Use the JACK audio host. You must also link to the JACK library (libjack).
  
  <strong>Plink</strong>
  <em>None</em>
@@ -0,0 +1,374 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+/*
+ Bounded MPMC queue
+ Dmitry Vyukov
+ http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#include "../core/plank_StandardHeader.h"
+#include "plank_RingQueue.h"
+
+#define PLANK_RINGQUEUE_SLOTALIGN 8
+
+static PLANK_INLINE_LOW PlankAtomicLRef pl_RingQueueSequence (PlankRingQueueRef p, const PlankUL index)
+{
+    return (PlankAtomicLRef)(p->slots + (index & p->mask) * p->slotSize);
+}
+
+static PLANK_INLINE_LOW PlankUC* pl_RingQueueData (PlankRingQueueRef p, const PlankUL index)
+{
+    return p->slots + (index & p->mask) * p->slotSize + p->dataOffset;
+}
+
+PlankRingQueueRef pl_RingQueue_CreateAndInit (const PlankRingQueueMode mode, const PlankI capacity, const PlankI elementSize)
+{
+    PlankRingQueueRef p;
+    p = pl_RingQueue_Create();
+    
+    if (p != PLANK_NULL)
+    {
+        if (pl_RingQueue_Init (p, mode, capacity, elementSize) != PlankResult_OK)
+            pl_RingQueue_Destroy (p);
+        else
+            return p;
+    }
+    
+    return PLANK_NULL;
+}
+
+PlankRingQueueRef pl_RingQueue_Create()
+{
+    PlankMemoryRef m;
+    PlankRingQueueRef p;
+    
+    m = pl_MemoryGlobal(); // OK, creation of the queue isn't itself lock free
+    p = (PlankRingQueueRef)pl_Memory_AllocateBytes (m, sizeof (PlankRingQueue));
+    
+    if (p != PLANK_NULL)
+        pl_MemoryZero (p, sizeof (PlankRingQueue));
+    
+    return p;
+}
+
+PlankResult pl_RingQueue_Init (PlankRingQueueRef p, const PlankRingQueueMode mode, const PlankI capacity, const PlankI elementSize)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m;
+    PlankUI numSlots, i;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((capacity < 1) || (elementSize < 1) ||
+        ((mode != PlankRingQueueMode_SingleProducerSingleConsumer) &&
+         (mode != PlankRingQueueMode_MultiProducerMultiConsumer)))
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p, sizeof (PlankRingQueue));
+    
+    numSlots = capacity < 2 ? 2 : pl_NextPowerOf2UI ((PlankUI)capacity);
+    
+    p->mode = mode;
+    p->mask = (PlankUL)numSlots - 1;
+    p->elementSize = elementSize;
+    
+    // only the MPMC queue has a sequence number before the data in each slot
+    p->dataOffset = (mode == PlankRingQueueMode_MultiProducerMultiConsumer) ? (PlankI)sizeof (PlankAtomicL) : 0;
+    p->dataOffset = (p->dataOffset + PLANK_RINGQUEUE_SLOTALIGN - 1) & ~(PLANK_RINGQUEUE_SLOTALIGN - 1);
+    p->slotSize = (p->dataOffset + elementSize + PLANK_RINGQUEUE_SLOTALIGN - 1) & ~(PLANK_RINGQUEUE_SLOTALIGN - 1);
+    
+    m = pl_MemoryGlobal();
+    p->slots = (PlankUC*)pl_Memory_AllocateBytes (m, (PlankUL)numSlots * p->slotSize);
+    
+    if (p->slots == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p->slots, (PlankUL)numSlots * p->slotSize);
+    
+    pl_AtomicL_Init (&p->head);
+    pl_AtomicL_Init (&p->tail);
+    
+    if (mode == PlankRingQueueMode_MultiProducerMultiConsumer)
+    {
+        for (i = 0; i < numSlots; ++i)
+        {
+            pl_AtomicL_Init (pl_RingQueueSequence (p, i));
+            pl_AtomicL_Set (pl_RingQueueSequence (p, i), (PlankL)i);
+        }
+    }
+    
+exit:
+    return result;    
+}
+
+PlankResult pl_RingQueue_DeInit (PlankRingQueueRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m;
+    PlankUL i;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if (p->slots != PLANK_NULL)
+    {
+        if (p->mode == PlankRingQueueMode_MultiProducerMultiConsumer)
+        {
+            for (i = 0; i <= p->mask; ++i)
+                pl_AtomicL_DeInit (pl_RingQueueSequence (p, i));
+        }
+        
+        m = pl_MemoryGlobal();
+        
+        if ((result = pl_Memory_Free (m, p->slots)) != PlankResult_OK)
+            goto exit;
+    }
+    
+    pl_AtomicL_DeInit (&p->head);
+    pl_AtomicL_DeInit (&p->tail);
+    pl_MemoryZero (p, sizeof (PlankRingQueue));
+    
+exit:
+    return result;    
+}
+
+PlankResult pl_RingQueue_Destroy (PlankRingQueueRef p)
+{
+    PlankResult result;
+    PlankMemoryRef m;
+    
+    result = PlankResult_OK;
+    m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((result = pl_RingQueue_DeInit (p)) != PlankResult_OK)
+        goto exit;
+    
+    result = pl_Memory_Free (m, p);   
+    
+exit:
+    return result;    
+}
+
+PlankResult pl_RingQueue_Clear (PlankRingQueueRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankUL i;
+    
+    if (p->slots == PLANK_NULL)
+        goto exit;
+    
+    pl_AtomicL_Set (&p->head, 0);
+    pl_AtomicL_Set (&p->tail, 0);
+    p->cachedHead = 0;
+    p->cachedTail = 0;
+    
+    if (p->mode == PlankRingQueueMode_MultiProducerMultiConsumer)
+    {
+        for (i = 0; i <= p->mask; ++i)
+            pl_AtomicL_Set (pl_RingQueueSequence (p, i), (PlankL)i);
+    }
+    
+    pl_AtomicMemoryBarrier();
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_RingQueue_PushSPSC (PlankRingQueueRef p, const void* value)
+{
+    const PlankUL tail = (PlankUL)pl_AtomicL_GetUnchecked (&p->tail);
+    
+    if ((tail - p->cachedHead) > p->mask)
+    {
+        // only read the consumer's index when the last view of it says we're full
+        p->cachedHead = (PlankUL)pl_AtomicL_Get (&p->head);
+        pl_AtomicMemoryBarrier();
+        
+        if ((tail - p->cachedHead) > p->mask)
+            return PlankResult_ContainerFull;
+    }
+    
+    pl_MemoryCopy (pl_RingQueueData (p, tail), value, p->elementSize);
+    pl_AtomicL_Set (&p->tail, (PlankL)(tail + 1));
+    
+    return PlankResult_OK;
+}
+
+static PlankResult pl_RingQueue_PopSPSC (PlankRingQueueRef p, void* value)
+{
+    const PlankUL head = (PlankUL)pl_AtomicL_GetUnchecked (&p->head);
+    
+    if (head == p->cachedTail)
+    {
+        // only read the producer's index when the last view of it says we're empty
+        p->cachedTail = (PlankUL)pl_AtomicL_Get (&p->tail);
+        pl_AtomicMemoryBarrier();
+        
+        if (head == p->cachedTail)
+            return PlankResult_ContainerEmpty;
+    }
+    
+    pl_MemoryCopy (value, pl_RingQueueData (p, head), p->elementSize);
+    pl_AtomicL_Set (&p->head, (PlankL)(head + 1));
+    
+    return PlankResult_OK;
+}
+
+static PlankResult pl_RingQueue_PushMPMC (PlankRingQueueRef p, const void* value)
+{
+    PlankUL tail;
+    PlankL difference;
+    PlankAtomicLRef sequence;
+    
+    tail = (PlankUL)pl_AtomicL_Get (&p->tail);
+    
+    for (;;)
+    {
+        sequence = pl_RingQueueSequence (p, tail);
+        difference = pl_AtomicL_Get (sequence) - (PlankL)tail;
+        
+        if (difference == 0)
+        {
+            if (pl_AtomicL_CompareAndSwap (&p->tail, (PlankL)tail, (PlankL)(tail + 1)))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // the slot still holds the value from the previous lap
+            return PlankResult_ContainerFull;
+        }
+        
+        tail = (PlankUL)pl_AtomicL_Get (&p->tail);
+    }
+    
+    pl_MemoryCopy (pl_RingQueueData (p, tail), value, p->elementSize);
+    pl_AtomicL_Set (sequence, (PlankL)(tail + 1));
+    
+    return PlankResult_OK;
+}
+
+static PlankResult pl_RingQueue_PopMPMC (PlankRingQueueRef p, void* value)
+{
+    PlankUL head;
+    PlankL difference;
+    PlankAtomicLRef sequence;
+    
+    head = (PlankUL)pl_AtomicL_Get (&p->head);
+    
+    for (;;)
+    {
+        sequence = pl_RingQueueSequence (p, head);
+        difference = pl_AtomicL_Get (sequence) - (PlankL)(head + 1);
+        
+        if (difference == 0)
+        {
+            if (pl_AtomicL_CompareAndSwap (&p->head, (PlankL)head, (PlankL)(head + 1)))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // the slot has not been written on this lap
+            return PlankResult_ContainerEmpty;
+        }
+        
+        head = (PlankUL)pl_AtomicL_Get (&p->head);
+    }
+    
+    pl_MemoryCopy (value, pl_RingQueueData (p, head), p->elementSize);
+    pl_AtomicL_Set (sequence, (PlankL)(head + p->mask + 1));
+    
+    return PlankResult_OK;
+}
+
+PlankResult pl_RingQueue_Push (PlankRingQueueRef p, const void* value)
+{
+    return (p->mode == PlankRingQueueMode_SingleProducerSingleConsumer) ?
+        pl_RingQueue_PushSPSC (p, value) :
+        pl_RingQueue_PushMPMC (p, value);
+}
+
+PlankResult pl_RingQueue_Pop (PlankRingQueueRef p, void* value)
+{
+    return (p->mode == PlankRingQueueMode_SingleProducerSingleConsumer) ?
+        pl_RingQueue_PopSPSC (p, value) :
+        pl_RingQueue_PopMPMC (p, value);
+}
+
+PlankI pl_RingQueue_GetSize (PlankRingQueueRef p)
+{
+    const PlankUL head = (PlankUL)pl_AtomicL_Get (&p->head);
+    const PlankUL tail = (PlankUL)pl_AtomicL_Get (&p->tail);
+    const PlankL size = (PlankL)(tail - head);
+    
+    return size < 0 ? 0 : size > (PlankL)(p->mask + 1) ? (PlankI)(p->mask + 1) : (PlankI)size;
+}
+
+PlankI pl_RingQueue_GetCapacity (PlankRingQueueRef p)
+{
+    return p->slots == PLANK_NULL ? 0 : (PlankI)(p->mask + 1);
+}
+
+PlankI pl_RingQueue_GetElementSize (PlankRingQueueRef p)
+{
+    return p->elementSize;
+}
+
+PlankRingQueueMode pl_RingQueue_GetMode (PlankRingQueueRef p)
+{
+    return p->mode;
+}
@@ -0,0 +1,130 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_RINGQUEUE_H
+#define PLANK_RINGQUEUE_H
+
+#include "../containers/atomic/plank_Atomic.h"
+
+PLANK_BEGIN_C_LINKAGE
+
+/** A bounded lock-free queue (FIFO) stored in a ring buffer.
+ 
+ Unlike the LockFreeQueue this does not allocate an element per item, values
+ are copied in and out of a fixed array of slots so each push and pop touches
+ only the slot and the indices. The capacity is rounded up to a power of two
+ and the head and tail are kept on separate cache lines. Values are copied
+ bytewise so should be plain data (or types that can be moved with memcpy).
+ 
+ A queue in PlankRingQueueMode_SingleProducerSingleConsumer mode is wait-free
+ but must only have one thread pushing and one thread popping at any time.
+ A queue in PlankRingQueueMode_MultiProducerMultiConsumer mode may be used by
+ any number of threads and uses a sequence number per slot (after D. Vyukov's
+ bounded MPMC queue) so is lock-free but not wait-free.
+ 
+ @defgroup PlankRingQueueClass Plank RingQueue class
+ @ingroup PlankClasses
+ @{
+ */
+
+typedef struct PlankRingQueue* PlankRingQueueRef; 
+
+/** The threading mode of a RingQueue. */
+typedef PlankI PlankRingQueueMode;
+
+enum PlankRingQueueModeIdentifiers
+{
+    PlankRingQueueMode_SingleProducerSingleConsumer = 0,    ///< One pushing thread and one popping thread, wait-free.
+    PlankRingQueueMode_MultiProducerMultiConsumer           ///< Any number of pushing and popping threads.
+};
+
+PlankRingQueueRef pl_RingQueue_CreateAndInit (const PlankRingQueueMode mode, const PlankI capacity, const PlankI elementSize);
+PlankRingQueueRef pl_RingQueue_Create();
+
+/** Initialises the queue.
+ @param capacity The minimum number of values the queue can hold, this is rounded up to a power of two (and is at least 2).
+ @param elementSize The size of each value in bytes. */
+PlankResult pl_RingQueue_Init (PlankRingQueueRef p, const PlankRingQueueMode mode, const PlankI capacity, const PlankI elementSize);
+PlankResult pl_RingQueue_DeInit (PlankRingQueueRef p);
+PlankResult pl_RingQueue_Destroy (PlankRingQueueRef p);
+
+/** Removes all the values.
+ This is only safe when no other threads are using the queue. */
+PlankResult pl_RingQueue_Clear (PlankRingQueueRef p);
+
+/** Copies elementSize bytes from @e value into the queue.
+ @return PlankResult_OK or PlankResult_ContainerFull if there is no free slot. */
+PlankResult pl_RingQueue_Push (PlankRingQueueRef p, const void* value);
+
+/** Copies the oldest value in the queue to elementSize bytes at @e value.
+ @return PlankResult_OK or PlankResult_ContainerEmpty if there are no values. */
+PlankResult pl_RingQueue_Pop (PlankRingQueueRef p, void* value);
+
+/** NB the result of this could be invalid by the time it is returned in a multithreaded context. */
+PlankI pl_RingQueue_GetSize (PlankRingQueueRef p);
+
+PlankI pl_RingQueue_GetCapacity (PlankRingQueueRef p);
+PlankI pl_RingQueue_GetElementSize (PlankRingQueueRef p);
+PlankRingQueueMode pl_RingQueue_GetMode (PlankRingQueueRef p);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankRingQueue
+{
+    PlankUC*                                slots;
+    PlankUL                                 mask;
+    PlankI                                  elementSize;
+    PlankI                                  slotSize;
+    PlankI                                  dataOffset;
+    PlankRingQueueMode                      mode;
+    PlankUC                                 padding1[64];
+    
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL head;          // written by consumers
+    PlankUL                                 cachedTail;     // consumer's last view of tail (SPSC only)
+    PlankUC                                 padding2[64];
+    
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL tail;          // written by producers
+    PlankUL                                 cachedHead;     // producer's last view of head (SPSC only)
+    PlankUC                                 padding3[64];
+} PlankRingQueue PLANK_ALIGN(PLANK_WIDESIZE);
+#endif
+
+#endif // PLANK_RINGQUEUE_H
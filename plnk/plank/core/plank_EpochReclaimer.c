@@ -0,0 +1,600 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+/*
+ Practical lock-freedom
+ Keir Fraser
+ 2004
+ */
+
+#include "plank_StandardHeader.h"
+#include "plank_Thread.h"
+#include "plank_EpochReclaimer.h"
+
+static void pl_EpochParticipant_Release (PlankEpochParticipantRef p);
+static PlankB pl_EpochReclaimer_CanAdvance (PlankEpochReclaimerRef p, const PlankL epoch);
+
+// called on each exiting thread that still has a participant
+#if PLANK_WIN
+static VOID WINAPI pl_EpochReclaimer_ThreadExit (PVOID value)
+#else
+static void pl_EpochReclaimer_ThreadExit (void* value)
+#endif
+{
+    if (value != PLANK_NULL)
+        pl_EpochParticipant_Release ((PlankEpochParticipantRef)value);
+}
+
+static PlankResult pl_EpochReclaimer_InitNative (PlankEpochReclaimerRef p)
+{
+#if PLANK_WIN
+    if ((p->wake = CreateSemaphore (NULL, 0, LONG_MAX, NULL)) == NULL)
+        return PlankResult_UnknownError;
+    
+    p->wakeCreated = PLANK_TRUE;
+    
+    if ((p->key = FlsAlloc (pl_EpochReclaimer_ThreadExit)) == FLS_OUT_OF_INDEXES)
+        return PlankResult_ThreadLocalStorageMaximumIdentifiersReached;
+#elif PLANK_APPLE
+    if (semaphore_create (mach_task_self(), &p->wake, SYNC_POLICY_FIFO, 0) != KERN_SUCCESS)
+        return PlankResult_UnknownError;
+    
+    p->wakeCreated = PLANK_TRUE;
+    
+    if (pthread_key_create (&p->key, pl_EpochReclaimer_ThreadExit) != 0)
+        return PlankResult_ThreadLocalStorageMaximumIdentifiersReached;
+#else
+    if (sem_init (&p->wake, 0, 0) != 0)
+        return PlankResult_UnknownError;
+    
+    p->wakeCreated = PLANK_TRUE;
+    
+    if (pthread_key_create (&p->key, pl_EpochReclaimer_ThreadExit) != 0)
+        return PlankResult_ThreadLocalStorageMaximumIdentifiersReached;
+#endif
+    
+    p->keyCreated = PLANK_TRUE;
+    return PlankResult_OK;
+}
+
+static void pl_EpochReclaimer_DeInitNative (PlankEpochReclaimerRef p)
+{
+#if PLANK_WIN
+    if (p->keyCreated)
+        FlsFree (p->key);
+    
+    if (p->wakeCreated)
+        CloseHandle (p->wake);
+#elif PLANK_APPLE
+    if (p->keyCreated)
+        pthread_key_delete (p->key);
+    
+    if (p->wakeCreated)
+        semaphore_destroy (mach_task_self(), p->wake);
+#else
+    if (p->keyCreated)
+        pthread_key_delete (p->key);
+    
+    if (p->wakeCreated)
+        sem_destroy (&p->wake);
+#endif
+    
+    p->keyCreated = PLANK_FALSE;
+    p->wakeCreated = PLANK_FALSE;
+}
+
+static PlankEpochParticipantRef pl_EpochReclaimer_GetThreadParticipant (PlankEpochReclaimerRef p)
+{
+#if PLANK_WIN
+    return (PlankEpochParticipantRef)FlsGetValue (p->key);
+#else
+    return (PlankEpochParticipantRef)pthread_getspecific (p->key);
+#endif
+}
+
+static void pl_EpochReclaimer_SetThreadParticipant (PlankEpochReclaimerRef p, PlankEpochParticipantRef participant)
+{
+#if PLANK_WIN
+    FlsSetValue (p->key, participant);
+#else
+    pthread_setspecific (p->key, participant);
+#endif
+}
+
+// posts the semaphore at most once between waits so this never blocks
+static void pl_EpochReclaimer_Wake (PlankEpochReclaimerRef p)
+{
+    if (! pl_AtomicL_CompareAndSwap (&p->wakePending, 0, 1))
+        return;
+    
+#if PLANK_WIN
+    ReleaseSemaphore (p->wake, 1, NULL);
+#elif PLANK_APPLE
+    semaphore_signal (p->wake);
+#else
+    sem_post (&p->wake);
+#endif
+}
+
+static void pl_EpochReclaimer_WaitNative (PlankEpochReclaimerRef p)
+{
+#if PLANK_WIN
+    WaitForSingleObject (p->wake, INFINITE);
+#elif PLANK_APPLE
+    while (semaphore_wait (p->wake) == KERN_ABORTED) { }
+#else
+    while ((sem_wait (&p->wake) != 0) && (errno == EINTR)) { }
+#endif
+}
+
+PlankEpochReclaimerRef pl_EpochReclaimer_CreateAndInit (const PlankI maxParticipants, const PlankI numBatches, const PlankI batchSize)
+{
+    PlankEpochReclaimerRef p;
+    p = pl_EpochReclaimer_Create();
+    
+    if (p != PLANK_NULL)
+    {
+        if (pl_EpochReclaimer_Init (p, maxParticipants, numBatches, batchSize) != PlankResult_OK)
+            pl_EpochReclaimer_Destroy (p);
+        else
+            return p;
+    }
+    
+    return PLANK_NULL;
+}
+
+PlankEpochReclaimerRef pl_EpochReclaimer_Create()
+{
+    PlankMemoryRef m;
+    PlankEpochReclaimerRef p;
+    
+    m = pl_MemoryGlobal();
+    p = (PlankEpochReclaimerRef)pl_Memory_AllocateBytes (m, sizeof (PlankEpochReclaimer));
+    
+    if (p != PLANK_NULL)
+        pl_MemoryZero (p, sizeof (PlankEpochReclaimer));
+    
+    return p;
+}
+
+PlankResult pl_EpochReclaimer_Init (PlankEpochReclaimerRef p, const PlankI maxParticipants, const PlankI numBatches, const PlankI batchSize)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m;
+    PlankEpochParticipantRef participant;
+    PlankEpochBatchRef batch;
+    PlankI i, j, index;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((maxParticipants < 1) || (numBatches < 1) || (batchSize < 1))
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p, sizeof (PlankEpochReclaimer));
+    
+    pl_AtomicL_Init (&p->epoch);
+    pl_AtomicL_Set (&p->epoch, 1);
+    pl_AtomicL_Init (&p->wakePending);
+    pl_AtomicL_Init (&p->heldBack);
+    
+    if ((result = pl_EpochReclaimer_InitNative (p)) != PlankResult_OK)
+        goto exit;
+    
+    p->maxParticipants = maxParticipants;
+    p->numBatches = numBatches;
+    p->batchSize = batchSize;
+    p->freeFunction = pl_MemoryDefaultFree;
+    
+    m = pl_MemoryGlobal();
+    p->participants = (PlankEpochParticipant*)pl_Memory_AllocateBytes (m, sizeof (PlankEpochParticipant) * maxParticipants);
+    p->batches = (PlankEpochBatch*)pl_Memory_AllocateBytes (m, sizeof (PlankEpochBatch) * maxParticipants * numBatches);
+    p->items = (PlankP*)pl_Memory_AllocateBytes (m, sizeof (PlankP) * maxParticipants * numBatches * batchSize);
+    
+    if ((p->participants == PLANK_NULL) || (p->batches == PLANK_NULL) || (p->items == PLANK_NULL))
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p->participants, sizeof (PlankEpochParticipant) * maxParticipants);
+    pl_MemoryZero (p->batches, sizeof (PlankEpochBatch) * maxParticipants * numBatches);
+    
+    for (i = 0; i < maxParticipants; ++i)
+    {
+        participant = p->participants + i;
+        pl_AtomicL_Init (&participant->epoch);
+        pl_AtomicL_Init (&participant->thread);
+        participant->reclaimer = p;
+        
+        if ((result = pl_RingQueue_Init (&participant->full, PlankRingQueueMode_SingleProducerSingleConsumer, numBatches, sizeof (PlankEpochBatchRef))) != PlankResult_OK)
+            goto exit;
+        
+        if ((result = pl_RingQueue_Init (&participant->spare, PlankRingQueueMode_SingleProducerSingleConsumer, numBatches, sizeof (PlankEpochBatchRef))) != PlankResult_OK)
+            goto exit;
+        
+        for (j = 0; j < numBatches; ++j)
+        {
+            index = i * numBatches + j;
+            batch = p->batches + index;
+            batch->owner = participant;
+            batch->items = p->items + index * batchSize;
+            
+            if (j == 0)
+                participant->current = batch;
+            else if ((result = pl_RingQueue_Push (&participant->spare, &batch)) != PlankResult_OK)
+                goto exit;
+        }
+    }
+    
+exit:
+    return result;
+}
+
+PlankResult pl_EpochReclaimer_DeInit (PlankEpochReclaimerRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m;
+    PlankEpochParticipantRef participant;
+    PlankEpochBatchRef batch;
+    PlankI i, j;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    // wherever each batch is (current, handed over or pending) free what it holds
+    if (p->batches != PLANK_NULL)
+    {
+        for (i = 0; i < p->maxParticipants * p->numBatches; ++i)
+        {
+            batch = p->batches + i;
+            
+            for (j = 0; j < batch->count; ++j)
+                (p->freeFunction) (p->freeUserData, batch->items[j]);
+            
+            batch->count = 0;
+        }
+    }
+    
+    if (p->participants != PLANK_NULL)
+    {
+        for (i = 0; i < p->maxParticipants; ++i)
+        {
+            participant = p->participants + i;
+            pl_RingQueue_DeInit (&participant->full);
+            pl_RingQueue_DeInit (&participant->spare);
+            pl_AtomicL_DeInit (&participant->epoch);
+            pl_AtomicL_DeInit (&participant->thread);
+        }
+    }
+    
+    m = pl_MemoryGlobal();
+    
+    if (p->participants != PLANK_NULL)
+        pl_Memory_Free (m, p->participants);
+    
+    if (p->batches != PLANK_NULL)
+        pl_Memory_Free (m, p->batches);
+    
+    if (p->items != PLANK_NULL)
+        pl_Memory_Free (m, p->items);
+    
+    pl_EpochReclaimer_DeInitNative (p);
+    pl_AtomicL_DeInit (&p->heldBack);
+    pl_AtomicL_DeInit (&p->wakePending);
+    pl_AtomicL_DeInit (&p->epoch);
+    pl_MemoryZero (p, sizeof (PlankEpochReclaimer));
+    
+exit:
+    return result;
+}
+
+PlankResult pl_EpochReclaimer_Destroy (PlankEpochReclaimerRef p)
+{
+    PlankResult result;
+    PlankMemoryRef m;
+    
+    result = PlankResult_OK;
+    m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((result = pl_EpochReclaimer_DeInit (p)) != PlankResult_OK)
+        goto exit;
+    
+    result = pl_Memory_Free (m, p);   
+    
+exit:
+    return result;
+}
+
+PlankResult pl_EpochReclaimer_SetFreeFunction (PlankEpochReclaimerRef p, PlankMemoryFreeFunction freeFunction, PlankP userData)
+{
+    if (freeFunction == PLANK_NULL)
+        return PlankResult_FunctionsInvalid;
+    
+    p->freeFunction = freeFunction;
+    p->freeUserData = userData;
+    
+    return PlankResult_OK;
+}
+
+PlankEpochParticipantRef pl_EpochReclaimer_GetParticipant (PlankEpochReclaimerRef p)
+{
+    const PlankL thread = (PlankL)pl_ThreadCurrentID();
+    PlankEpochParticipantRef participant;
+    PlankI i;
+    
+    if ((participant = pl_EpochReclaimer_GetThreadParticipant (p)) != PLANK_NULL)
+        return participant;
+    
+    for (i = 0; i < p->maxParticipants; ++i)
+    {
+        participant = p->participants + i;
+        
+        if ((pl_AtomicL_Get (&participant->thread) == 0) && 
+            pl_AtomicL_CompareAndSwap (&participant->thread, 0, thread))
+        {
+            // also arranges for the participant to be released when the thread exits
+            pl_EpochReclaimer_SetThreadParticipant (p, participant);
+            return participant;
+        }
+    }
+    
+    return PLANK_NULL;
+}
+
+PlankResult pl_EpochReclaimer_ReleaseParticipant (PlankEpochReclaimerRef p)
+{
+    PlankEpochParticipantRef participant;
+    
+    if ((participant = pl_EpochReclaimer_GetThreadParticipant (p)) != PLANK_NULL)
+    {
+        pl_EpochReclaimer_SetThreadParticipant (p, PLANK_NULL);
+        pl_EpochParticipant_Release (participant);
+    }
+    
+    return PlankResult_OK;
+}
+
+PlankResult pl_EpochReclaimer_FlushParticipant (PlankEpochReclaimerRef p)
+{
+    PlankEpochParticipantRef participant;
+    
+    if ((participant = pl_EpochReclaimer_GetThreadParticipant (p)) == PLANK_NULL)
+        return PlankResult_OK;
+    
+    return pl_EpochParticipant_Flush (participant);
+}
+
+static PlankB pl_EpochReclaimer_CanAdvance (PlankEpochReclaimerRef p, const PlankL epoch)
+{
+    PlankL participantEpoch;
+    PlankI i;
+    
+    for (i = 0; i < p->maxParticipants; ++i)
+    {
+        participantEpoch = pl_AtomicL_Get (&p->participants[i].epoch);
+        
+        if ((participantEpoch != 0) && (participantEpoch != epoch))
+            return PLANK_FALSE;
+    }
+    
+    return PLANK_TRUE;
+}
+
+PlankResult pl_EpochReclaimer_Collect (PlankEpochReclaimerRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankEpochParticipantRef participant;
+    PlankEpochBatchRef batch;
+    PlankL epoch;
+    PlankI i;
+    
+    epoch = pl_AtomicL_Get (&p->epoch);
+    
+    for (i = 0; i < p->maxParticipants; ++i)
+    {
+        participant = p->participants + i;
+        
+        while (pl_RingQueue_Pop (&participant->full, &batch) == PlankResult_OK)
+        {
+            batch->epoch = epoch;
+            batch->next = PLANK_NULL;
+            
+            if (p->pendingTail != PLANK_NULL)
+                p->pendingTail->next = batch;
+            else
+                p->pendingHead = batch;
+            
+            p->pendingTail = batch;
+            p->numPending += batch->count;
+        }
+    }
+    
+    // two advances are enough for everything collected above if no one holds the epoch back
+    for (i = 0; i < 2; ++i)
+    {
+        if (! pl_EpochReclaimer_CanAdvance (p, epoch))
+            break;
+        
+        epoch = epoch + 1;
+        pl_AtomicL_Set (&p->epoch, epoch);
+    }
+    
+    // a batch is safe once everyone inside a critical section has seen two epochs since it was retired
+    while ((p->pendingHead != PLANK_NULL) && ((p->pendingHead->epoch + 2) <= epoch))
+    {
+        batch = p->pendingHead;
+        p->pendingHead = batch->next;
+        
+        if (p->pendingHead == PLANK_NULL)
+            p->pendingTail = PLANK_NULL;
+        
+        for (i = 0; i < batch->count; ++i)
+            (p->freeFunction) (p->freeUserData, batch->items[i]);
+        
+        p->numPending -= batch->count;
+        batch->count = 0;
+        batch->next = PLANK_NULL;
+        
+        if ((result = pl_RingQueue_Push (&batch->owner->spare, &batch)) != PlankResult_OK)
+            goto exit;
+    }
+    
+exit:
+    return result;
+}
+
+PlankL pl_EpochReclaimer_GetNumPending (PlankEpochReclaimerRef p)
+{
+    return p->numPending;
+}
+
+PlankL pl_EpochReclaimer_GetEpoch (PlankEpochReclaimerRef p)
+{
+    return pl_AtomicL_Get (&p->epoch);
+}
+
+void pl_EpochReclaimer_Wait (PlankEpochReclaimerRef p)
+{
+    if (p->numPending > 0)
+    {
+        // participants leaving a critical section wake us from now on, unless
+        // one has already left in which case the epoch can move on without waiting
+        pl_AtomicL_Set (&p->heldBack, 1);
+        
+        if (pl_EpochReclaimer_CanAdvance (p, pl_AtomicL_Get (&p->epoch)))
+        {
+            pl_AtomicL_Set (&p->heldBack, 0);
+            return;
+        }
+    }
+    
+    pl_EpochReclaimer_WaitNative (p);
+    pl_AtomicL_Set (&p->heldBack, 0);
+    pl_AtomicL_Set (&p->wakePending, 0);
+}
+
+void pl_EpochReclaimer_Signal (PlankEpochReclaimerRef p)
+{
+    pl_EpochReclaimer_Wake (p);
+}
+
+void pl_EpochParticipant_Enter (PlankEpochParticipantRef p)
+{
+    pl_AtomicL_Set (&p->epoch, pl_AtomicL_Get (&p->reclaimer->epoch));
+}
+
+void pl_EpochParticipant_Exit (PlankEpochParticipantRef p)
+{
+    pl_AtomicL_Set (&p->epoch, 0);
+    
+    if (pl_AtomicL_Get (&p->reclaimer->heldBack))
+        pl_EpochReclaimer_Wake (p->reclaimer);
+}
+
+static void pl_EpochParticipant_Release (PlankEpochParticipantRef p)
+{
+    pl_EpochParticipant_Flush (p);
+    pl_EpochParticipant_Exit (p);
+    
+    // the full and spare queues go with the participant to its next owner
+    pl_AtomicL_Set (&p->thread, 0);
+}
+
+static PlankResult pl_EpochParticipant_HandOff (PlankEpochParticipantRef p)
+{
+    PlankResult result;
+    PlankEpochBatchRef batch;
+    
+    batch = p->current;
+    p->current = PLANK_NULL;
+    
+    // the full queue can hold all of this participant's batches so this can't fail
+    if ((result = pl_RingQueue_Push (&p->full, &batch)) != PlankResult_OK)
+        goto exit;
+    
+    if (pl_RingQueue_Pop (&p->spare, &batch) == PlankResult_OK)
+        p->current = batch;
+    
+    pl_EpochReclaimer_Wake (p->reclaimer);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_EpochParticipant_Retire (PlankEpochParticipantRef p, PlankP ptr)
+{
+    PlankEpochBatchRef batch;
+    
+    batch = p->current;
+    
+    if (batch == PLANK_NULL)
+    {
+        if (pl_RingQueue_Pop (&p->spare, &batch) != PlankResult_OK)
+            return PlankResult_ContainerFull;
+        
+        p->current = batch;
+    }
+    
+    batch->items[batch->count++] = ptr;
+    
+    return (batch->count < p->reclaimer->batchSize) ? PlankResult_OK : pl_EpochParticipant_HandOff (p);
+}
+
+PlankResult pl_EpochParticipant_Flush (PlankEpochParticipantRef p)
+{
+    if ((p->current == PLANK_NULL) || (p->current->count == 0))
+        return PlankResult_OK;
+    
+    return pl_EpochParticipant_HandOff (p);
+}
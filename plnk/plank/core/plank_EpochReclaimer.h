@@ -0,0 +1,223 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_EPOCHRECLAIMER_H
+#define PLANK_EPOCHRECLAIMER_H
+
+#include "../containers/plank_RingQueue.h"
+
+#if PLANK_APPLE
+    #include <mach/mach.h>
+#elif PLANK_LINUX || PLANK_ANDROID
+    #include <semaphore.h>
+#endif
+
+PLANK_BEGIN_C_LINKAGE
+
+/** Defers freeing memory until no thread can still be using it.
+ 
+ Each thread that frees memory through the reclaimer has a participant, found
+ (or claimed on first use) with pl_EpochReclaimer_GetParticipant(). A thread
+ retires a pointer with pl_EpochParticipant_Retire() which adds it to the
+ participant's current batch without any atomic operations. When the batch is
+ full it is handed to the reclaimer through a single-producer single-consumer
+ RingQueue. Batches and participants are all allocated by pl_EpochReclaimer_Init()
+ so retiring never allocates and the memory held by the reclaimer is bounded.
+ 
+ One thread (normally a low priority background thread) calls 
+ pl_EpochReclaimer_Collect() regularly. This collects handed over batches,
+ advances the global epoch when every participant inside a critical section 
+ has seen the current epoch and frees the batches that were collected two or
+ more epochs ago using the free function. Threads that read shared pointers 
+ that may be retired by other threads should bracket their reads with 
+ pl_EpochParticipant_Enter() and pl_EpochParticipant_Exit(). Participants
+ not inside a critical section never hold back the epoch so memory that is 
+ only retired when it is no longer shared (e.g., when a reference count 
+ reaches zero) is freed on the next collection.
+ 
+ The collecting thread sleeps in pl_EpochReclaimer_Wait() until there is 
+ something to do. Participants wake it by posting a semaphore when they hand 
+ over a batch, or when they leave a critical section that was holding back
+ collected batches, so retiring never blocks, even on a real-time thread.
+ 
+ When a thread exits its participant is released: its partly filled batch is
+ handed over and the participant can be claimed by another thread.
+ 
+ @defgroup PlankEpochReclaimerClass Plank EpochReclaimer class
+ @ingroup PlankClasses
+ @{
+ */
+
+typedef struct PlankEpochReclaimer* PlankEpochReclaimerRef; 
+typedef struct PlankEpochParticipant* PlankEpochParticipantRef; 
+typedef struct PlankEpochBatch* PlankEpochBatchRef; 
+
+PlankEpochReclaimerRef pl_EpochReclaimer_CreateAndInit (const PlankI maxParticipants, const PlankI numBatches, const PlankI batchSize);
+PlankEpochReclaimerRef pl_EpochReclaimer_Create();
+
+/** Initialises the reclaimer.
+ @param maxParticipants The number of threads that may retire memory.
+ @param numBatches The number of batches each participant has.
+ @param batchSize The number of pointers in each batch. */
+PlankResult pl_EpochReclaimer_Init (PlankEpochReclaimerRef p, const PlankI maxParticipants, const PlankI numBatches, const PlankI batchSize);
+
+/** Frees all retired memory, whatever the epoch, and deinitialises the reclaimer.
+ This must only be called when no other threads are using the reclaimer. */
+PlankResult pl_EpochReclaimer_DeInit (PlankEpochReclaimerRef p);
+PlankResult pl_EpochReclaimer_Destroy (PlankEpochReclaimerRef p);
+
+/** Sets the function used to free retired pointers.
+ By default pointers are freed with pl_MemoryDefaultFree(). */
+PlankResult pl_EpochReclaimer_SetFreeFunction (PlankEpochReclaimerRef p, PlankMemoryFreeFunction freeFunction, PlankP userData);
+
+/** Returns the calling thread's participant.
+ This claims a participant the first time it is called on a thread.
+ @return The participant or PLANK_NULL if all participants are already in use. */
+PlankEpochParticipantRef pl_EpochReclaimer_GetParticipant (PlankEpochReclaimerRef p);
+
+/** Releases the calling thread's participant, if it has one.
+ Its partly filled batch is handed over first. This happens automatically when 
+ the thread exits so only call this if the thread will stop retiring memory
+ for the rest of its life. */
+PlankResult pl_EpochReclaimer_ReleaseParticipant (PlankEpochReclaimerRef p);
+
+/** Hands over the calling thread's partly filled batch, if it has a participant.
+ Unlike pl_EpochReclaimer_GetParticipant() this never claims a participant so
+ it is cheap to call regularly (e.g., at the end of each audio callback). */
+PlankResult pl_EpochReclaimer_FlushParticipant (PlankEpochReclaimerRef p);
+
+/** Collects the batches handed over by the participants and frees those that are safe to free.
+ This must only be called by one thread at a time. */
+PlankResult pl_EpochReclaimer_Collect (PlankEpochReclaimerRef p);
+
+/** Returns the number of retired pointers that have been collected but not freed yet.
+ This is only valid on the collecting thread. */
+PlankL pl_EpochReclaimer_GetNumPending (PlankEpochReclaimerRef p);
+
+/** Returns the global epoch. */
+PlankL pl_EpochReclaimer_GetEpoch (PlankEpochReclaimerRef p);
+
+/** Waits until there may be something for pl_EpochReclaimer_Collect() to do.
+ This returns when a participant hands over a batch, when a participant leaves
+ a critical section that was holding back collected batches or when
+ pl_EpochReclaimer_Signal() is called. It must only be called by the collecting thread. */
+void pl_EpochReclaimer_Wait (PlankEpochReclaimerRef p);
+
+/** Wakes the thread waiting in pl_EpochReclaimer_Wait(). 
+ This never blocks. */
+void pl_EpochReclaimer_Signal (PlankEpochReclaimerRef p);
+
+/** Marks the start of a critical section in which the thread may read shared pointers. */
+void pl_EpochParticipant_Enter (PlankEpochParticipantRef p);
+
+/** Marks the end of a critical section. */
+void pl_EpochParticipant_Exit (PlankEpochParticipantRef p);
+
+/** Retires a pointer to be freed once no thread can be using it.
+ This must only be called by the thread that owns the participant.
+ @return PlankResult_OK or PlankResult_ContainerFull if all the participant's 
+ batches are waiting to be freed, in which case the pointer was not retired. */
+PlankResult pl_EpochParticipant_Retire (PlankEpochParticipantRef p, PlankP ptr);
+
+/** Hands the current batch to the reclaimer even if it is not full. */
+PlankResult pl_EpochParticipant_Flush (PlankEpochParticipantRef p);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankEpochBatch
+{
+    PlankEpochBatchRef                      next;           // in the reclaimer's pending list
+    PlankEpochParticipantRef                owner;
+    PlankL                                  epoch;          // when the reclaimer collected it
+    PlankI                                  count;
+    PlankP*                                 items;
+} PlankEpochBatch;
+
+typedef struct PlankEpochParticipant
+{
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL epoch;         // 0 outside a critical section
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL thread;        // the owning thread's ID, 0 if unclaimed
+    PlankEpochReclaimerRef                  reclaimer;
+    PlankEpochBatchRef                      current;        // only used by the owning thread
+    PlankUC                                 padding[64];
+    
+    PlankRingQueue                          full;           // owner to reclaimer
+    PlankRingQueue                          spare;          // reclaimer to owner
+} PlankEpochParticipant;
+
+typedef struct PlankEpochReclaimer
+{
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL epoch;
+    PlankUC                                 padding[64];
+    
+    PlankEpochParticipant*                  participants;
+    PlankEpochBatch*                        batches;
+    PlankP*                                 items;
+    PlankI                                  maxParticipants;
+    PlankI                                  numBatches;
+    PlankI                                  batchSize;
+    
+    PlankMemoryFreeFunction                 freeFunction;
+    PlankP                                  freeUserData;
+    
+    PlankEpochBatchRef                      pendingHead;    // only used by the collecting thread
+    PlankEpochBatchRef                      pendingTail;
+    PlankL                                  numPending;
+    
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL wakePending;   // 1 if the semaphore has been posted since the last wait
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL heldBack;      // 1 if the collector is waiting on a critical section
+    
+#if PLANK_WIN
+    HANDLE                                  wake;
+    DWORD                                   key;
+#elif PLANK_APPLE
+    semaphore_t                             wake;
+    pthread_key_t                           key;
+#else
+    sem_t                                   wake;
+    pthread_key_t                           key;
+#endif
+    PlankB                                  wakeCreated;
+    PlankB                                  keyCreated;
+} PlankEpochReclaimer;
+#endif
+
+#endif // PLANK_EPOCHRECLAIMER_H
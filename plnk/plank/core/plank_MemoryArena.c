@@ -0,0 +1,545 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // for MAP_ANONYMOUS and MADV_HUGEPAGE
+#endif
+
+#include "plank_StandardHeader.h"
+#include "plank_MemoryArena.h"
+
+#if PLANK_LINUX
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#define PLANK_MEMORYARENA_HEADERSIZE        (64)                // keeps allocations cache line aligned relative to their block
+#define PLANK_MEMORYARENA_DEFAULTLARGESIZE  (256 * 1024)
+#define PLANK_MEMORY_DEFAULTPAGESIZE        (4096)
+#define PLANK_MEMORY_MAXNODES               (1024)
+#define PLANK_MEMORY_LISTLENGTH             (1024)
+
+#if PLANK_LINUX
+#define PLANK_MEMORY_MPOLPREFERRED          (1)                 // MPOL_PREFERRED from numaif.h, part of libnuma not glibc
+#define PLANK_MEMORY_MPOLMFMOVE             (1 << 1)            // MPOL_MF_MOVE
+
+#ifndef MADV_HUGEPAGE
+    #define MADV_HUGEPAGE                   (14)
+#endif
+
+#ifndef MAP_HUGETLB
+    #define MAP_HUGETLB                     (0x40000)
+#endif
+#endif
+
+// precedes each allocation, mappedSize is 0 for allocations from the heap
+typedef struct PlankMemoryArenaHeader
+{
+    PlankUL mappedSize;
+    PlankUL numBytes;
+} PlankMemoryArenaHeader;
+
+#if PLANK_LINUX
+/** Reads a list of numbers and ranges (e.g., "0-3,8") from a sysfs file.
+ Returns whether the list contains @e value and sets @e last to the largest
+ number in the list, or -1 if the file could not be read. */
+static PlankB pl_MemoryListInternal (const char* path, const int value, int* last)
+{
+    char text[PLANK_MEMORY_LISTLENGTH];
+    char* c;
+    FILE* file;
+    int first, end;
+    PlankB found;
+    
+    found = PLANK_FALSE;
+    *last = -1;
+    file = fopen (path, "r");
+    
+    if (file == PLANK_NULL)
+        return PLANK_FALSE;
+    
+    if (fgets (text, sizeof (text), file) == PLANK_NULL)
+        text[0] = '\0';
+    
+    fclose (file);
+    
+    c = text;
+    
+    while ((*c >= '0') && (*c <= '9'))
+    {
+        first = end = (int)strtol (c, &c, 10);
+        
+        if (*c == '-')
+            end = (int)strtol (c + 1, &c, 10);
+        
+        if ((value >= first) && (value <= end))
+            found = PLANK_TRUE;
+        
+        if (end > *last)
+            *last = end;
+        
+        if (*c == ',')
+            ++c;
+    }
+    
+    return found;
+}
+#endif
+
+int pl_MemoryNumNodes()
+{
+#if PLANK_LINUX
+    int last;
+    pl_MemoryListInternal ("/sys/devices/system/node/online", 0, &last);
+    return (last < 0) ? 1 : last + 1;
+#else
+    return 1;
+#endif
+}
+
+int pl_MemoryCurrentNode()
+{
+#if PLANK_LINUX && defined(SYS_getcpu)
+    unsigned int core, node;
+    
+    if (syscall (SYS_getcpu, &core, &node, PLANK_NULL) != 0)
+        return 0;
+    
+    return (int)node;
+#else
+    return 0;
+#endif
+}
+
+int pl_MemoryNodeOfCore (const int core)
+{
+#if PLANK_LINUX
+    char path[64];
+    int numNodes, node, last;
+    
+    numNodes = pl_MemoryNumNodes();
+    
+    for (node = 0; node < numNodes; ++node)
+    {
+        snprintf (path, sizeof (path), "/sys/devices/system/node/node%d/cpulist", node);
+        
+        if (pl_MemoryListInternal (path, core, &last))
+            return node;
+    }
+    
+    return 0;
+#else
+    (void)core;
+    return 0;
+#endif
+}
+
+PlankUL pl_MemoryPageSize()
+{
+#if PLANK_LINUX
+    const long pageSize = sysconf (_SC_PAGESIZE);
+    return (pageSize > 0) ? (PlankUL)pageSize : PLANK_MEMORY_DEFAULTPAGESIZE;
+#else
+    return PLANK_MEMORY_DEFAULTPAGESIZE;
+#endif
+}
+
+PlankUL pl_MemoryHugePageSize()
+{
+#if PLANK_LINUX
+    char line[256];
+    FILE* file;
+    PlankUL size;
+    
+    size = 0;
+    file = fopen ("/proc/meminfo", "r");
+    
+    if (file == PLANK_NULL)
+        return 0;
+    
+    while (fgets (line, sizeof (line), file) != PLANK_NULL)
+    {
+        if (strncmp (line, "Hugepagesize:", 13) == 0)
+        {
+            size = (PlankUL)strtoul (line + 13, PLANK_NULL, 10) * 1024; // in kB
+            break;
+        }
+    }
+    
+    fclose (file);
+    return size;
+#else
+    return 0;
+#endif
+}
+
+#if PLANK_LINUX
+/** Rounds a block inwards to whole pages, returns 0 if it has none. */
+static PlankUL pl_MemoryWholePagesInternal (PlankP ptr, const PlankUL numBytes, PlankP* start)
+{
+    const PlankUL pageMask = pl_MemoryPageSize() - 1;
+    const PlankUL first = ((PlankUL)ptr + pageMask) & ~pageMask;
+    const PlankUL end = ((PlankUL)ptr + numBytes) & ~pageMask;
+    
+    *start = (PlankP)first;
+    return (end > first) ? end - first : 0;
+}
+#endif
+
+PlankResult pl_MemoryPlaceOnNode (PlankP ptr, const PlankUL numBytes, const int node)
+{
+#if PLANK_LINUX && defined(SYS_mbind)
+    unsigned long mask[PLANK_MEMORY_MAXNODES / (8 * sizeof (unsigned long))];
+    PlankP start;
+    PlankUL length;
+    
+    if (ptr == PLANK_NULL)
+        return PlankResult_MemoryError;
+    
+    if ((node < 0) || (node >= PLANK_MEMORY_MAXNODES))
+        return PlankResult_MemoryPlacementFailed;
+    
+    length = pl_MemoryWholePagesInternal (ptr, numBytes, &start);
+    
+    if (length == 0)
+        return PlankResult_OK;
+    
+    pl_MemoryZero (mask, sizeof (mask));
+    mask[node / (8 * sizeof (unsigned long))] = 1UL << (node % (8 * sizeof (unsigned long)));
+    
+    // the kernel reads maxnode - 1 bits of the mask
+    if (syscall (SYS_mbind, start, length, PLANK_MEMORY_MPOLPREFERRED, mask, (unsigned long)PLANK_MEMORY_MAXNODES + 1, PLANK_MEMORY_MPOLMFMOVE) != 0)
+        return PlankResult_MemoryPlacementFailed;
+    
+    return PlankResult_OK;
+#else
+    (void)numBytes;
+    (void)node;
+    return (ptr == PLANK_NULL) ? PlankResult_MemoryError : PlankResult_OK;
+#endif
+}
+
+PlankResult pl_MemoryAdviseHugePages (PlankP ptr, const PlankUL numBytes)
+{
+#if PLANK_LINUX
+    PlankP start;
+    PlankUL length;
+    
+    if (ptr == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    length = pl_MemoryWholePagesInternal (ptr, numBytes, &start);
+    
+    if (length == 0)
+        return PlankResult_OK;
+    
+    if (madvise (start, length, MADV_HUGEPAGE) != 0)
+        return PlankResult_MemoryPlacementFailed;
+    
+    return PlankResult_OK;
+#else
+    (void)numBytes;
+    return (ptr == PLANK_NULL) ? PlankResult_MemoryError : PlankResult_OK;
+#endif
+}
+
+PlankResult pl_MemoryTouch (PlankP ptr, const PlankUL numBytes)
+{
+    const PlankUL pageSize = pl_MemoryPageSize();
+    volatile PlankUC* bytes;
+    PlankUL i;
+    
+    if (ptr == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    bytes = (volatile PlankUC*)ptr;
+    
+    for (i = 0; i < numBytes; i += pageSize)
+        bytes[i] = bytes[i];
+    
+    if (numBytes > 0)
+        bytes[numBytes - 1] = bytes[numBytes - 1];
+    
+    return PlankResult_OK;
+}
+
+//------------------------------------------------------------------------------
+
+static PlankP pl_MemoryArenaAllocateBytesInternal (PlankP userData, PlankUL numBytes)
+{
+    return pl_MemoryArena_AllocateBytes ((PlankMemoryArenaRef)userData, numBytes);
+}
+
+static void pl_MemoryArenaFreeInternal (PlankP userData, PlankP ptr)
+{
+    pl_MemoryArena_Free ((PlankMemoryArenaRef)userData, ptr);
+}
+
+PlankMemoryArenaRef pl_MemoryArena_CreateAndInit (const int node, const PlankMemoryHugePages hugePages, const PlankUL largeSize)
+{
+    PlankMemoryArenaRef p;
+    p = pl_MemoryArena_Create();
+    
+    if (p != PLANK_NULL)
+    {
+        if (pl_MemoryArena_Init (p, node, hugePages, largeSize) != PlankResult_OK)
+            pl_MemoryArena_Destroy (p);
+        else
+            return p;
+    }
+    
+    return (PlankMemoryArenaRef)PLANK_NULL;
+}
+
+PlankMemoryArenaRef pl_MemoryArena_Create()
+{
+    PlankMemoryRef m;
+    PlankMemoryArenaRef p;
+    
+    m = pl_MemoryGlobal();
+    p = (PlankMemoryArenaRef)pl_Memory_AllocateBytes (m, sizeof (PlankMemoryArena));
+    
+    if (p != PLANK_NULL)
+        pl_MemoryZero (p, sizeof (PlankMemoryArena));
+    
+    return p;
+}
+
+PlankResult pl_MemoryArena_Init (PlankMemoryArenaRef p, const int node, const PlankMemoryHugePages hugePages, const PlankUL largeSize)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    p->node = (node < pl_MemoryNumNodes()) ? node : -1;
+    p->hugePages = hugePages;
+    p->largeSize = (largeSize > 0) ? largeSize : PLANK_MEMORYARENA_DEFAULTLARGESIZE;
+    
+    if ((result = pl_AtomicL_Init (&p->numBytesMapped)) != PlankResult_OK)
+        goto exit;
+    
+    if ((result = pl_Memory_Init (&p->memory)) != PlankResult_OK)
+        goto exit;
+    
+    if ((result = pl_Memory_SetFunctions (&p->memory, pl_MemoryArenaAllocateBytesInternal, pl_MemoryArenaFreeInternal)) != PlankResult_OK)
+        goto exit;
+    
+    result = pl_Memory_SetUserData (&p->memory, p);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_MemoryArena_DeInit (PlankMemoryArenaRef p)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if (pl_AtomicL_Get (&p->numBytesMapped) != 0)
+        result = PlankResult_MemoryError;
+    
+    pl_Memory_DeInit (&p->memory);
+    pl_AtomicL_DeInit (&p->numBytesMapped);
+    pl_MemoryZero (p, sizeof (PlankMemoryArena));
+    
+exit:
+    return result;
+}
+
+PlankResult pl_MemoryArena_Destroy (PlankMemoryArenaRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankResult freeResult;
+    PlankMemoryRef m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    // the arena is deinitialised even if memory was still mapped so free it either way
+    result = pl_MemoryArena_DeInit (p);
+    freeResult = pl_Memory_Free (m, p);
+    
+    if (result == PlankResult_OK)
+        result = freeResult;
+    
+exit:
+    return result;
+}
+
+#if PLANK_LINUX
+static PlankP pl_MemoryArenaMapInternal (PlankMemoryArenaRef p, const PlankUL numBytes, PlankUL* mappedSize)
+{
+    const int protection = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    PlankUL hugePageSize, pageSize;
+    void* ptr;
+    
+    ptr = MAP_FAILED;
+    
+    if (p->hugePages == PlankMemoryHugePages_Explicit)
+    {
+        hugePageSize = pl_MemoryHugePageSize();
+        
+        if (hugePageSize > 0)
+        {
+            *mappedSize = (numBytes + hugePageSize - 1) & ~(hugePageSize - 1);
+            ptr = mmap (PLANK_NULL, *mappedSize, protection, flags | MAP_HUGETLB, -1, 0);
+        }
+    }
+    
+    if (ptr == MAP_FAILED)
+    {
+        // the huge page pool is empty or was not requested
+        pageSize = pl_MemoryPageSize();
+        *mappedSize = (numBytes + pageSize - 1) & ~(pageSize - 1);
+        ptr = mmap (PLANK_NULL, *mappedSize, protection, flags, -1, 0);
+        
+        if (ptr == MAP_FAILED)
+            return PLANK_NULL;
+        
+        if (p->hugePages != PlankMemoryHugePages_None)
+            pl_MemoryAdviseHugePages (ptr, *mappedSize);
+    }
+    
+    // the mapping is untouched so binding it first means no pages are migrated,
+    // the pages are then faulted in now rather than on whichever thread first uses them
+    if (p->node >= 0)
+    {
+        pl_MemoryPlaceOnNode (ptr, *mappedSize, p->node);
+        pl_MemoryTouch (ptr, *mappedSize);
+    }
+    
+    return ptr;
+}
+#endif
+
+PlankP pl_MemoryArena_AllocateBytes (PlankMemoryArenaRef p, const PlankUL numBytes)
+{
+    PlankMemoryArenaHeader* header;
+    PlankUL blockSize, mappedSize;
+    
+    blockSize = numBytes + PLANK_MEMORYARENA_HEADERSIZE;
+    mappedSize = 0;
+    header = PLANK_NULL;
+    
+#if PLANK_LINUX
+    if (numBytes >= p->largeSize)
+        header = (PlankMemoryArenaHeader*)pl_MemoryArenaMapInternal (p, blockSize, &mappedSize);
+#endif
+    
+    if (header == PLANK_NULL)
+    {
+        mappedSize = 0;
+        header = (PlankMemoryArenaHeader*)pl_MemoryDefaultAllocateBytes (PLANK_NULL, blockSize);
+        
+        if (header == PLANK_NULL)
+            return PLANK_NULL;
+    }
+    else
+    {
+        pl_AtomicL_Add (&p->numBytesMapped, (PlankL)mappedSize);
+    }
+    
+    header->mappedSize = mappedSize;
+    header->numBytes = numBytes;
+    
+    return (PlankUC*)header + PLANK_MEMORYARENA_HEADERSIZE;
+}
+
+PlankResult pl_MemoryArena_Free (PlankMemoryArenaRef p, PlankP ptr)
+{
+    PlankMemoryArenaHeader* header;
+    
+    if (ptr == PLANK_NULL)
+        return PlankResult_OK;
+    
+    header = (PlankMemoryArenaHeader*)((PlankUC*)ptr - PLANK_MEMORYARENA_HEADERSIZE);
+    
+    if (header->mappedSize == 0)
+    {
+        pl_MemoryDefaultFree (PLANK_NULL, header);
+        return PlankResult_OK;
+    }
+    
+#if PLANK_LINUX
+    pl_AtomicL_Add (&p->numBytesMapped, -(PlankL)header->mappedSize);
+    
+    if (munmap (header, header->mappedSize) != 0)
+        return PlankResult_MemoryError;
+#endif
+    
+    return PlankResult_OK;
+}
+
+PlankMemoryRef pl_MemoryArena_GetMemory (PlankMemoryArenaRef p)
+{
+    return &p->memory;
+}
+
+int pl_MemoryArena_GetNode (PlankMemoryArenaRef p)
+{
+    return p->node;
+}
+
+PlankMemoryHugePages pl_MemoryArena_GetHugePages (PlankMemoryArenaRef p)
+{
+    return p->hugePages;
+}
+
+PlankUL pl_MemoryArena_GetLargeSize (PlankMemoryArenaRef p)
+{
+    return p->largeSize;
+}
+
+PlankL pl_MemoryArena_GetNumBytesMapped (PlankMemoryArenaRef p)
+{
+    return pl_AtomicL_Get (&p->numBytesMapped);
+}
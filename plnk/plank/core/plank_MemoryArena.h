@@ -0,0 +1,168 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_MEMORYARENA_H
+#define PLANK_MEMORYARENA_H
+
+#include "plank_Memory.h"
+#include "../containers/atomic/plank_Atomic.h"
+
+PLANK_BEGIN_C_LINKAGE
+
+/** Node-local and huge-page-backed memory.
+ 
+ On machines with more than one memory node (NUMA) memory is slower to access
+ from cores on other nodes. Linux places a page on the node of the thread that
+ first writes to it so memory allocated and cleared on one thread and then 
+ used by a worker pinned to another node is remote for its whole life. Large
+ buffers also use many TLB entries unless they are backed by huge pages.
+ 
+ The pl_Memory functions here find the nodes of cores and threads, place 
+ existing memory on a node (migrating pages that are already resident), 
+ advise the kernel to back memory with transparent huge pages and touch 
+ memory so it is faulted in before it is needed on a real-time thread. They
+ are hints: on other platforms, single node machines or if the kernel refuses
+ they do nothing and the memory is still valid. The system calls are made 
+ directly so libnuma is not needed.
+ 
+ A <i>Plank %MemoryArena</i> is an allocator for one node. Small allocations
+ come from the heap while allocations of at least the arena's large size are
+ mapped separately and backed by huge pages if requested. If the arena has a
+ node large allocations are bound to it and touched by the allocating thread
+ so they are resident before they are used. Otherwise they are left untouched
+ so each page is placed on the node of the first thread that writes to it,
+ e.g., the worker that loads or renders into it. The arena's PlankMemory (from
+ pl_MemoryArena_GetMemory()) can be used wherever a PlankMemory is.
+ 
+ @defgroup PlankMemoryArenaClass Plank MemoryArena class
+ @ingroup PlankClasses
+ @{
+ */
+
+typedef struct PlankMemoryArena* PlankMemoryArenaRef; 
+
+/** How an arena backs large allocations. */
+typedef PlankI PlankMemoryHugePages;
+enum PlankMemoryHugePagesIdentifiers
+{
+    PlankMemoryHugePages_None,          ///< Normal pages.
+    PlankMemoryHugePages_Transparent,   ///< Normal pages advised to be transparent huge pages (madvise).
+    PlankMemoryHugePages_Explicit       ///< Pages from the reserved huge page pool (MAP_HUGETLB), or transparent if the pool is empty.
+};
+
+/** The number of memory nodes, this is always at least 1. */
+int pl_MemoryNumNodes();
+
+/** The node of the core the calling thread is running on, 0 if this is unknown. */
+int pl_MemoryCurrentNode();
+
+/** The node of a core, 0 if this is unknown. */
+int pl_MemoryNodeOfCore (const int core);
+
+/** The size of a page in bytes. */
+PlankUL pl_MemoryPageSize();
+
+/** The size of a huge page in bytes, 0 if huge pages are not supported. */
+PlankUL pl_MemoryHugePageSize();
+
+/** Prefers a node for the whole pages in a block of memory.
+ Pages that are already resident are moved to the node and pages faulted in
+ later are allocated on it if it has free memory.
+ @return PlankResult_OK or PlankResult_MemoryPlacementFailed. */
+PlankResult pl_MemoryPlaceOnNode (PlankP ptr, const PlankUL numBytes, const int node);
+
+/** Advises the kernel to back the whole pages in a block of memory with transparent huge pages.
+ @return PlankResult_OK or PlankResult_MemoryPlacementFailed. */
+PlankResult pl_MemoryAdviseHugePages (PlankP ptr, const PlankUL numBytes);
+
+/** Writes to each page of a block of memory, leaving its contents unchanged.
+ This faults the pages in on the calling thread's node (unless they are 
+ already resident or a node was set with pl_MemoryPlaceOnNode()). */
+PlankResult pl_MemoryTouch (PlankP ptr, const PlankUL numBytes);
+
+PlankMemoryArenaRef pl_MemoryArena_CreateAndInit (const int node, const PlankMemoryHugePages hugePages, const PlankUL largeSize);
+PlankMemoryArenaRef pl_MemoryArena_Create();
+
+/** Initialises an arena.
+ @param node The node to place large allocations on, -1 leaves them on the node of the thread that first writes to them.
+ @param hugePages How large allocations are backed, one of the PlankMemoryHugePages values.
+ @param largeSize The size from which allocations are mapped separately, 0 uses a default. */
+PlankResult pl_MemoryArena_Init (PlankMemoryArenaRef p, const int node, const PlankMemoryHugePages hugePages, const PlankUL largeSize);
+
+/** Deinitialises the arena, all its memory must already have been freed.
+ If some is still mapped this returns PlankResult_MemoryError but the arena 
+ is deinitialised anyway. */
+PlankResult pl_MemoryArena_DeInit (PlankMemoryArenaRef p);
+
+/** Deinitialises and frees an arena created with pl_MemoryArena_Create().
+ The arena is freed even if pl_MemoryArena_DeInit() reports that memory was
+ still mapped, the error is still returned. */
+PlankResult pl_MemoryArena_Destroy (PlankMemoryArenaRef p);
+
+/** Allocates memory, large allocations are placed and backed as the arena was set up. */
+PlankP pl_MemoryArena_AllocateBytes (PlankMemoryArenaRef p, const PlankUL numBytes);
+
+/** Frees memory allocated by this arena. */
+PlankResult pl_MemoryArena_Free (PlankMemoryArenaRef p, PlankP ptr);
+
+/** A PlankMemory that allocates from this arena. */
+PlankMemoryRef pl_MemoryArena_GetMemory (PlankMemoryArenaRef p);
+
+int pl_MemoryArena_GetNode (PlankMemoryArenaRef p);
+PlankMemoryHugePages pl_MemoryArena_GetHugePages (PlankMemoryArenaRef p);
+PlankUL pl_MemoryArena_GetLargeSize (PlankMemoryArenaRef p);
+
+/** The number of bytes currently mapped for large allocations. */
+PlankL pl_MemoryArena_GetNumBytesMapped (PlankMemoryArenaRef p);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankMemoryArena
+{
+    PlankMemory                             memory;
+    int                                     node;
+    PlankMemoryHugePages                    hugePages;
+    PlankUL                                 largeSize;
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL numBytesMapped;
+} PlankMemoryArena;
+#endif
+
+#endif // PLANK_MEMORYARENA_H
@@ -47,6 +47,7 @@ const char* pl_ResultString (PlankResult result)
         "Invalid result code",                  //PlankResult_ResultInvalid,
         
         "Memory error",                         //PlankResult_MemoryError,
+        "Memory placement failed",              //PlankResult_MemoryPlacementFailed,
         
         "A null pointer was passed to a function where this is invalid",   //PlankResult_NullPointerError
         "Error in a parameter to an array function",                        //PlankResult_ArrayParameterError
@@ -92,6 +93,8 @@ const char* pl_ResultString (PlankResult result)
         "An index for a list, array etc was out of range",                                      //PlankResult_IndexOutOfRange
         "An item count was invalid (e.g., 0 or too small for the context)",                     //PlankResult_ItemCountInvalid
         "A container (e.g., list, queue, stack) is being de-initialised but is non-empty",      //PlankResult_ContainerNotEmptyOnDeInit
+        "A bounded container (e.g., ring queue) has no space for another item",                //PlankResult_ContainerFull
+        "A container has no items to remove",                                                   //PlankResult_ContainerEmpty
 
         "The maximum number of identifiers for thread-local storage has been reached",          //PlankResult_ThreadLocalStorageMaximumIdentifiersReached
         "A generic JSON error occurred",                                                        //PlankResult_JSONError
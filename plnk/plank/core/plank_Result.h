@@ -48,6 +48,7 @@ enum PlankResultIdentifiers
     PlankResult_ResultInvalid,      ///< The error code is itself invalid !
     
     PlankResult_MemoryError,        ///< A memory error occured e.g., out of memory.
+    PlankResult_MemoryPlacementFailed, ///< Placing memory on a node or advising huge pages failed.
     PlankResult_NullPointerError,   ///< A null pointer was passed to a function where this is invalid.
     PlankResult_ArrayParameterError, ///< There was an error in a parameter to an array function.
     
@@ -92,6 +93,8 @@ enum PlankResultIdentifiers
     PlankResult_IndexOutOfRange,            ///< An index for a list, array etc was out of range.
     PlankResult_ItemCountInvalid,           ///< An item count was invalid (e.g., 0 or too small for the context).
     PlankResult_ContainerNotEmptyOnDeInit,  ///< A container (list, queue, stack) is being de-initialised but is non-empty.
+    PlankResult_ContainerFull,              ///< A bounded container (e.g., ring queue) has no space for another item.
+    PlankResult_ContainerEmpty,             ///< A container has no items to remove.
     
     PlankResult_ThreadLocalStorageMaximumIdentifiersReached, ///< The maximum number of identifiers for thread-local storage has been reached.
     PlankResult_JSONError,                  ///< A generic JSON error occurred.
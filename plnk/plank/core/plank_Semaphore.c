@@ -0,0 +1,223 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "plank_StandardHeader.h"
+#include "plank_Semaphore.h"
+
+#if PLANK_LINUX || PLANK_ANDROID
+    #include <errno.h>
+    #include <time.h>
+#endif
+
+PlankSemaphoreRef pl_Semaphore_CreateAndInit()
+{
+    PlankSemaphoreRef p;
+    p = pl_Semaphore_Create();
+    
+    if (p != PLANK_NULL)
+    {
+        if (pl_Semaphore_Init (p) != PlankResult_OK)
+            pl_Semaphore_Destroy (p);
+        else
+            return p;
+    }
+    
+    return PLANK_NULL;
+}
+
+PlankSemaphoreRef pl_Semaphore_Create()
+{
+    PlankMemoryRef m;
+    PlankSemaphoreRef p;
+    
+    m = pl_MemoryGlobal();
+    p = (PlankSemaphoreRef)pl_Memory_AllocateBytes (m, sizeof (PlankSemaphore));
+    
+    if (p != PLANK_NULL)
+        pl_MemoryZero (p, sizeof (PlankSemaphore));
+    
+    return p;
+}
+
+PlankResult pl_Semaphore_Init (PlankSemaphoreRef p)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p, sizeof (PlankSemaphore));
+    pl_AtomicL_Init (&p->pending);
+    
+#if PLANK_WIN
+    if ((p->semaphore = CreateSemaphore (NULL, 0, LONG_MAX, NULL)) == NULL)
+#elif PLANK_APPLE
+    if (semaphore_create (mach_task_self(), &p->semaphore, SYNC_POLICY_FIFO, 0) != KERN_SUCCESS)
+#else
+    if (sem_init (&p->semaphore, 0, 0) != 0)
+#endif
+    {
+        result = PlankResult_UnknownError;
+        goto exit;
+    }
+    
+    p->created = PLANK_TRUE;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_Semaphore_DeInit (PlankSemaphoreRef p)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if (p->created)
+    {
+#if PLANK_WIN
+        CloseHandle (p->semaphore);
+#elif PLANK_APPLE
+        semaphore_destroy (mach_task_self(), p->semaphore);
+#else
+        sem_destroy (&p->semaphore);
+#endif
+    }
+    
+    pl_AtomicL_DeInit (&p->pending);
+    pl_MemoryZero (p, sizeof (PlankSemaphore));
+    
+exit:
+    return result;
+}
+
+PlankResult pl_Semaphore_Destroy (PlankSemaphoreRef p)
+{
+    PlankResult result;
+    PlankMemoryRef m;
+    
+    result = PlankResult_OK;
+    m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((result = pl_Semaphore_DeInit (p)) != PlankResult_OK)
+        goto exit;
+    
+    result = pl_Memory_Free (m, p);
+    
+exit:
+    return result;
+}
+
+void pl_Semaphore_Wait (PlankSemaphoreRef p)
+{
+#if PLANK_WIN
+    WaitForSingleObject (p->semaphore, INFINITE);
+#elif PLANK_APPLE
+    while (semaphore_wait (p->semaphore) == KERN_ABORTED) { }
+#else
+    while ((sem_wait (&p->semaphore) != 0) && (errno == EINTR)) { }
+#endif
+    
+    // signals from now on post again, the waiting thread looks for work after this
+    pl_AtomicL_Set (&p->pending, 0);
+}
+
+PlankB pl_Semaphore_WaitTimeout (PlankSemaphoreRef p, double time)
+{
+    PlankB signalled;
+    
+#if PLANK_WIN
+    signalled = WaitForSingleObject (p->semaphore, (DWORD)(time * 1000.0 + 0.5)) == WAIT_OBJECT_0;
+#elif PLANK_APPLE
+    mach_timespec_t timeout;
+    kern_return_t kr;
+    
+    timeout.tv_sec = (unsigned int)time;
+    timeout.tv_nsec = (clock_res_t)((time - timeout.tv_sec) * 1000000000.0);
+    
+    while ((kr = semaphore_timedwait (p->semaphore, timeout)) == KERN_ABORTED) { }
+    
+    signalled = kr == KERN_SUCCESS;
+#else
+    struct timespec timeout;
+    long nanos;
+    
+    clock_gettime (CLOCK_REALTIME, &timeout);
+    nanos = timeout.tv_nsec + (long)((time - (long)time) * 1000000000.0);
+    timeout.tv_sec += (time_t)time + nanos / 1000000000;
+    timeout.tv_nsec = nanos % 1000000000;
+    
+    do {
+        signalled = sem_timedwait (&p->semaphore, &timeout) == 0;
+    } while (! signalled && (errno == EINTR));
+#endif
+    
+    // on a time out any post still pending makes the next wait return straight away
+    if (signalled)
+        pl_AtomicL_Set (&p->pending, 0);
+    
+    return signalled;
+}
+
+void pl_Semaphore_Signal (PlankSemaphoreRef p)
+{
+    // post at most once between waits so the count stays bounded
+    if (! pl_AtomicL_CompareAndSwap (&p->pending, 0, 1))
+        return;
+    
+#if PLANK_WIN
+    ReleaseSemaphore (p->semaphore, 1, NULL);
+#elif PLANK_APPLE
+    semaphore_signal (p->semaphore);
+#else
+    sem_post (&p->semaphore);
+#endif
+}
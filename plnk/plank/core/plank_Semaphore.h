@@ -0,0 +1,128 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_SEMAPHORE_H
+#define PLANK_SEMAPHORE_H
+
+#include "../containers/atomic/plank_Atomic.h"
+
+#if PLANK_APPLE
+    #include <mach/mach.h>
+#elif PLANK_LINUX || PLANK_ANDROID
+    #include <semaphore.h>
+#endif
+
+PLANK_BEGIN_C_LINKAGE
+
+/** A wake-up signal for worker threads that never blocks the signalling thread.
+ 
+ This uses a mach semaphore on Apple platforms, a POSIX semaphore on Linux and
+ Android and a semaphore object on Windows. pl_Semaphore_Signal() posts the 
+ semaphore only if it hasn't already been posted since the last wait returned 
+ so any number of signals between two waits wake the waiting thread once and 
+ the count never grows. Posting a semaphore takes no lock so signalling is 
+ safe from an audio thread. A signal is never lost: one that arrives while 
+ the other thread isn't waiting makes its next wait return straight away. 
+ The waiting thread should check for work after each wait returns.
+ 
+ @defgroup PlankSemaphoreClass Plank Semaphore class
+ @ingroup PlankClasses
+ @{
+ */
+
+/** An opaque reference to the <i>Plank %Semaphore</i> object. */
+typedef struct PlankSemaphore* PlankSemaphoreRef; 
+
+/** Create and intitialise a <i>Plank %Semaphore</i> object and return an oqaque reference to it.
+ @return A <i>Plank %Semaphore</i> object as an opaque reference or PLANK_NULL. */
+PlankSemaphoreRef pl_Semaphore_CreateAndInit();
+
+/** Create a <i>Plank %Semaphore</i> object and return an oqaque reference to it.
+ @return A <i>Plank %Semaphore</i> object as an opaque reference or PLANK_NULL. */
+PlankSemaphoreRef pl_Semaphore_Create();
+
+/** Initialise a <i>Plank %Semaphore</i> object. 
+ @param p The <i>Plank %Semaphore</i> object. 
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Semaphore_Init (PlankSemaphoreRef p);
+
+/** Deinitialise a <i>Plank %Semaphore</i> object. 
+ @param p The <i>Plank %Semaphore</i> object. 
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Semaphore_DeInit (PlankSemaphoreRef p);
+
+/** Destroy a <i>Plank %Semaphore</i> object. 
+ @param p The <i>Plank %Semaphore</i> object. 
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Semaphore_Destroy (PlankSemaphoreRef p);
+
+/** Wait until the semaphore is signalled. 
+ @param p The <i>Plank %Semaphore</i> object. */
+void pl_Semaphore_Wait (PlankSemaphoreRef p);
+
+/** Wait until the semaphore is signalled or a time has elapsed. 
+ @param p The <i>Plank %Semaphore</i> object. 
+ @param time The maximum time to wait in seconds.
+ @return @c true if the semaphore was signalled, @c false if the wait timed out. */
+PlankB pl_Semaphore_WaitTimeout (PlankSemaphoreRef p, double time);
+
+/** Wake a thread waiting on the semaphore, this never blocks. 
+ @param p The <i>Plank %Semaphore</i> object. */
+void pl_Semaphore_Signal (PlankSemaphoreRef p);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankSemaphore
+{
+    PLANK_ALIGN(PLANK_WIDESIZE) PlankAtomicL pending;  // 1 if posted since the last wait returned
+    
+#if PLANK_WIN
+    HANDLE semaphore;
+#elif PLANK_APPLE
+    semaphore_t semaphore;
+#else
+    sem_t semaphore;
+#endif
+    PlankB created;
+} PlankSemaphore;
+#endif
+
+#endif // PLANK_SEMAPHORE_H
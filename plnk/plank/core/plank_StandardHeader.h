@@ -107,6 +107,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <ctype.h>
 #include <math.h>
 #include <time.h>
 #include <limits.h>
@@ -433,7 +434,7 @@ static PLANK_INLINE_LOW double pl_TimeNow()
 static PLANK_INLINE_LOW void pl_TimeToTimeSpec (struct timespec* time, double seconds)
 {
     time->tv_sec = (long)seconds;
-    time->tv_nsec = (long)((seconds - time->tv_sec) * 0.000000001);
+    time->tv_nsec = (long)((seconds - time->tv_sec) * 1000000000.0);
 }
 #endif
 
@@ -36,13 +36,48 @@
  -------------------------------------------------------------------------------
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // for cpu_set_t and pthread_setname_np()
+#endif
+
 #include "plank_StandardHeader.h"
 #include "plank_Thread.h"
 #include "../maths/plank_Maths.h"
 
-#define PLANK_THREAD_PAUSEQUANTA (0.00001)
-#define PLANK_THREAD_NOPRIORITY  (-1)
-#define PLANK_THREAD_NOAFFINITY  (-1)
+#if PLANK_LINUX || PLANK_ANDROID
+    #include <sys/syscall.h>
+#endif
+
+#if PLANK_LINUX
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+#endif
+
+#define PLANK_THREAD_PAUSEQUANTA            (0.00001)
+#define PLANK_THREAD_NOPRIORITY             (-1)
+#define PLANK_THREAD_NOAFFINITY             (-1)
+#define PLANK_THREAD_DEFAULTDEADLINELOAD    (0.5)
+#define PLANK_THREAD_PREFAULTSTACKSIZE      (64 * 1024)
+#define PLANK_THREAD_MAXCORES               (256)
+#define PLANK_THREAD_CPULISTLENGTH          (1024)
+
+#if PLANK_LINUX
+#define PLANK_THREAD_SCHEDDEADLINE          (6)         // SCHED_DEADLINE, missing from older headers
+#define PLANK_THREAD_DEADLINEMINRUNTIME     (1024.0)    // the kernel's minimum runtime in ns
+
+// struct sched_attr, glibc has no wrapper for sched_setattr() so this is passed to the syscall
+typedef struct PlankThreadSchedAttr
+{
+    PlankUI size;
+    PlankUI policy;
+    PlankULL flags;
+    PlankI nice;
+    PlankUI priority;
+    PlankULL runtime;
+    PlankULL deadline;
+    PlankULL period;
+} PlankThreadSchedAttr;
+#endif
 
 typedef PlankThreadNativeReturn (PLANK_THREADCALL *PlankThreadNativeFunction)(PlankP);
 PlankThreadNativeReturn PLANK_THREADCALL pl_ThreadNativeFunction (PlankP argument);
@@ -52,6 +87,16 @@ void pl_Thread_Reset (PlankThreadRef p)
     pl_AtomicI_Set (&p->shouldExitAtom, PLANK_FALSE);
     p->thread = (PlankThreadNativeHandle)0;
     p->threadID = (PlankThreadID)0;
+    p->nativeID = 0;
+    p->schedulingInEffect = PlankThreadScheduling_Other;
+    pl_AtomicI_Set (&p->isRunningAtom, PLANK_FALSE);    
+}
+
+// the native handle is kept so the thread can still be joined with pl_Thread_Wait()
+static void pl_ThreadExitedInternal (PlankThreadRef p)
+{
+    p->nativeID = 0;
+    p->schedulingInEffect = PlankThreadScheduling_Other;
     pl_AtomicI_Set (&p->isRunningAtom, PLANK_FALSE);    
 }
 
@@ -88,6 +133,23 @@ PlankResult pl_ThreadYield()
     return PlankResult_OK;
 }
 
+int pl_ThreadNumCores()
+{
+    int numCores;
+    
+#if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
+    numCores = (int)sysconf (_SC_NPROCESSORS_ONLN);
+#elif PLANK_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo (&info);
+    numCores = (int)info.dwNumberOfProcessors;
+#else
+    #error No platform defined to implement threads.
+#endif
+    
+    return numCores > 0 ? numCores : 1;
+}
+
 PlankThreadID pl_ThreadCurrentID()
 {
 #if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
@@ -100,6 +162,270 @@ PlankThreadID pl_ThreadCurrentID()
 #endif
 }
 
+int pl_ThreadIsolatedCores (int* cores, int maxCores)
+{
+#if PLANK_LINUX
+    char text[PLANK_THREAD_CPULISTLENGTH];
+    char* c;
+    FILE* file;
+    int numCores, first, last;
+    
+    file = fopen ("/sys/devices/system/cpu/isolated", "r");
+    
+    if (file == PLANK_NULL)
+        return 0;
+    
+    if (fgets (text, sizeof (text), file) == PLANK_NULL)
+        text[0] = '\0';
+    
+    fclose (file);
+    
+    // a list of cores and ranges e.g., "2-3,6"
+    numCores = 0;
+    c = text;
+    
+    while ((*c >= '0') && (*c <= '9'))
+    {
+        first = last = (int)strtol (c, &c, 10);
+        
+        if (*c == '-')
+            last = (int)strtol (c + 1, &c, 10);
+        
+        for (; (first <= last) && (numCores < maxCores); ++first)
+            cores[numCores++] = first;
+        
+        if (*c == ',')
+            ++c;
+    }
+    
+    return numCores;
+#else
+    (void)cores;
+    (void)maxCores;
+    return 0;
+#endif
+}
+
+static int pl_ThreadAllowedCoresInternal (int* cores, int maxCores)
+{
+#if PLANK_LINUX
+    cpu_set_t cpuset;
+    int numCores, i;
+    
+    numCores = 0;
+    
+    if (sched_getaffinity (0, sizeof (cpuset), &cpuset) != 0)
+        return 0;
+    
+    for (i = 0; (i < CPU_SETSIZE) && (numCores < maxCores); ++i)
+        if (CPU_ISSET (i, &cpuset))
+            cores[numCores++] = i;
+    
+    return numCores;
+#else
+    (void)cores;
+    (void)maxCores;
+    return 0;
+#endif
+}
+
+#if PLANK_LINUX
+static PlankThreadScheduling pl_ThreadSchedulingInEffectInternal (PlankThreadRef p)
+{
+    int policy = sched_getscheduler ((pid_t)p->nativeID);
+    
+    if (policy == SCHED_RR)
+        return PlankThreadScheduling_RoundRobin;
+    else if (policy == SCHED_FIFO)
+        return PlankThreadScheduling_FIFO;
+    else if (policy == PLANK_THREAD_SCHEDDEADLINE)
+        return PlankThreadScheduling_Deadline;
+    else
+        return PlankThreadScheduling_Other;
+}
+
+static PlankResult pl_ThreadSetSchedulerInternal (PlankThreadRef p, int policy, int priority)
+{
+    struct sched_param param;
+    struct rlimit limit;
+    int minPriority, maxPriority;
+
+    pl_MemoryZero (&param, sizeof (param));
+    
+    if (policy != SCHED_OTHER)
+    {
+        minPriority = sched_get_priority_min (policy);
+        maxPriority = sched_get_priority_max (policy);
+        param.sched_priority = ((maxPriority - minPriority) * priority) / 100 + minPriority;
+    }
+    
+    // on Linux this applies to the single thread with this ID
+    if (sched_setscheduler ((pid_t)p->nativeID, policy, &param) == 0)
+        return PlankResult_OK;
+    
+    // unprivileged processes may still use real-time priorities up to RLIMIT_RTPRIO
+    if ((policy != SCHED_OTHER) && (errno == EPERM) && 
+        (getrlimit (RLIMIT_RTPRIO, &limit) == 0) &&
+        (limit.rlim_cur > 0) && (limit.rlim_cur < (rlim_t)param.sched_priority))
+    {
+        param.sched_priority = (int)limit.rlim_cur;
+        
+        if (sched_setscheduler ((pid_t)p->nativeID, policy, &param) == 0)
+            return PlankResult_OK;
+    }
+    
+    return PlankResult_ThreadSetPriorityFailed;
+}
+
+static PlankResult pl_ThreadSetDeadlineInternal (PlankThreadRef p)
+{
+#if defined(SYS_sched_setattr)
+    PlankThreadSchedAttr attr;
+    double period;
+    
+    period = PLANK_BILLION_D * p->audioBlockSize / p->audioSampleRate;
+    
+    pl_MemoryZero (&attr, sizeof (attr));
+    attr.size       = sizeof (attr);
+    attr.policy     = PLANK_THREAD_SCHEDDEADLINE;
+    attr.runtime    = (PlankULL)pl_MaxD (period * p->deadlineLoad, PLANK_THREAD_DEADLINEMINRUNTIME);
+    attr.deadline   = (PlankULL)period;
+    attr.period     = (PlankULL)period;
+    
+    // fails without CAP_SYS_NICE, if the affinity is narrower than the root domain 
+    // or if admission control finds too little bandwidth left
+    return syscall (SYS_sched_setattr, (pid_t)p->nativeID, &attr, 0) == 0 
+           ? PlankResult_OK 
+           : PlankResult_ThreadSetPriorityFailed;
+#else
+    (void)p;
+    return PlankResult_ThreadSetPriorityFailed;
+#endif
+}
+
+static void pl_ThreadPrefaultStackInternal()
+{
+    volatile char stack[PLANK_THREAD_PREFAULTSTACKSIZE];
+    volatile int sum;
+    int i;
+    
+    for (i = 0; i < PLANK_THREAD_PREFAULTSTACKSIZE; i += 1024)
+        stack[i] = 0;
+    
+    // read the pages back so the writes are not optimised away
+    for (sum = 0, i = 0; i < PLANK_THREAD_PREFAULTSTACKSIZE; i += 1024)
+        sum += stack[i];
+}
+#endif
+
+static PlankResult pl_ThreadSetPriorityInternal (PlankThreadRef p, PlankThreadNativeHandle thread)
+{
+#if PLANK_LINUX
+    PlankResult result;
+    (void)thread;
+    
+    if (p->priority == 0)
+    {
+        result = pl_ThreadSetSchedulerInternal (p, SCHED_OTHER, 0);
+    }
+    else
+    {
+        result = PlankResult_ThreadSetPriorityFailed;
+        
+        if ((p->scheduling == PlankThreadScheduling_Deadline) && 
+            (p->audioBlockSize > 0) && (p->audioSampleRate > 0.0))
+            result = pl_ThreadSetDeadlineInternal (p);
+        
+        // deadline falls back to FIFO
+        if (result != PlankResult_OK)
+            result = pl_ThreadSetSchedulerInternal (p, 
+                                                    p->scheduling == PlankThreadScheduling_RoundRobin ? SCHED_RR : SCHED_FIFO,
+                                                    p->priority);
+    }
+    
+    p->schedulingInEffect = pl_ThreadSchedulingInEffectInternal (p);
+    return result;
+    
+#elif PLANK_APPLE || PLANK_ANDROID
+    struct sched_param param;
+    int policy, minPriority, maxPriority, result;
+    
+    if (pthread_getschedparam (thread, &policy, &param) != 0)
+        return PlankResult_ThreadSetPriorityFailed;
+    
+    policy = (p->priority == 0) ? SCHED_OTHER : (p->scheduling == PlankThreadScheduling_RoundRobin) ? SCHED_RR : SCHED_FIFO;
+    minPriority = sched_get_priority_min (policy);
+    maxPriority = sched_get_priority_max (policy);
+    
+    param.sched_priority = ((maxPriority - minPriority) * p->priority) / 100 + minPriority;
+    result = pthread_setschedparam (thread, policy, &param);
+    
+    if (result == 0)
+        p->schedulingInEffect = (policy == SCHED_RR) ? PlankThreadScheduling_RoundRobin : 
+                                (policy == SCHED_FIFO) ? PlankThreadScheduling_FIFO : 
+                                PlankThreadScheduling_Other;
+    
+    return result == 0 ? PlankResult_OK : PlankResult_ThreadSetPriorityFailed;
+#else
+    (void)p;
+    (void)thread;
+    return PlankResult_ThreadSetPriorityFailed;
+#endif
+}
+
+static PlankResult pl_ThreadSetAffinityInternal (PlankThreadRef p, PlankThreadNativeHandle thread)
+{
+#if PLANK_LINUX || PLANK_ANDROID
+    cpu_set_t cpuset;
+    (void)thread;
+    
+    if ((p->affinity < 0) || (p->affinity >= CPU_SETSIZE))
+        return PlankResult_ThreadSetAffinityFailed;
+    
+    CPU_ZERO (&cpuset);
+    CPU_SET (p->affinity, &cpuset);
+    
+    return sched_setaffinity ((pid_t)p->nativeID, sizeof (cpuset), &cpuset) == 0
+           ? PlankResult_OK
+           : PlankResult_ThreadSetAffinityFailed;
+#else
+    (void)p;
+    (void)thread;
+    return PlankResult_ThreadSetAffinityFailed;
+#endif
+}
+
+// called on the new thread before its function so the settings don't race the thread starting
+static void pl_ThreadApplySettingsInternal (PlankThreadRef p)
+{
+#if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
+    PlankThreadNativeHandle self = pthread_self();
+    
+#if PLANK_LINUX || PLANK_ANDROID
+    p->nativeID = (int)syscall (SYS_gettid);
+#endif
+    
+#if PLANK_LINUX
+    if (p->lockMemory)
+    {
+        // locks the whole process, not just this thread, and stays in effect after it exits
+        // needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK, carry on if not
+        mlockall (MCL_CURRENT | MCL_FUTURE);
+        pl_ThreadPrefaultStackInternal();
+    }
+#endif
+    
+    // affinity first as SCHED_DEADLINE is refused if it is set afterwards
+    if (p->affinity != PLANK_THREAD_NOAFFINITY)
+        pl_ThreadSetAffinityInternal (p, self);
+    
+    if (p->priority != PLANK_THREAD_NOPRIORITY)
+        pl_ThreadSetPriorityInternal (p, self);
+#else
+    (void)p;
+#endif
+}
+
 #if PLANK_WIN
 struct THREADNAME_INFO
 {
@@ -166,13 +492,14 @@ PlankThreadNativeReturn PLANK_THREADCALL pl_ThreadNativeFunction (PlankP argumen
     }
     else
     {
+        pl_ThreadApplySettingsInternal (p);
         pl_AtomicI_Set (&p->isRunningAtom, PLANK_TRUE);
         result = (*p->function) (p);
     }
   
 exit:
     if (result != PlankResult_ThreadWasDeleted)
-        pl_Thread_Reset (p);
+        pl_ThreadExitedInternal (p);
     
     return ((result == PlankResult_OK) || (result == PlankResult_ThreadWasDeleted)) ? 0 : (PlankThreadNativeReturn)(-1);
 }
@@ -215,6 +542,11 @@ PlankResult pl_Thread_Init (PlankThreadRef p)
     p->name[0] = '\0';
     p->priority = PLANK_THREAD_NOPRIORITY;
     p->affinity = PLANK_THREAD_NOAFFINITY;
+    p->scheduling = PlankThreadScheduling_RoundRobin;
+    p->audioBlockSize = 0;
+    p->audioSampleRate = 0.0;
+    p->deadlineLoad = PLANK_THREAD_DEFAULTDEADLINELOAD;
+    p->lockMemory = PLANK_FALSE;
     
     pl_AtomicI_Init (&p->shouldExitAtom);
     pl_AtomicI_Init (&p->isRunningAtom);
@@ -231,6 +563,16 @@ PlankResult pl_Thread_DeInit (PlankThreadRef p)
     PlankResult result;        
     result = PlankResult_OK;    
 
+    // release a thread that exited but was never waited for
+    if (p->thread && ! pl_AtomicI_Get (&p->isRunningAtom))
+    {
+#if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
+        pthread_detach (p->thread);
+#elif PLANK_WIN
+        CloseHandle ((HANDLE)p->thread);
+#endif
+    }
+
     pl_AtomicI_DeInit (&p->shouldExitAtom);
     pl_AtomicI_DeInit (&p->isRunningAtom);
     pl_AtomicI_DeInit (&p->paused);
@@ -310,6 +652,10 @@ PlankResult pl_Thread_Start (PlankThreadRef p)
     if (p->function == PLANK_NULL)
         return PlankResult_ThreadFunctionInvalid;
     
+    // join the previous run if it was not waited for
+    if (p->thread && (pl_Thread_Wait (p) != PlankResult_OK))
+        return PlankResult_ThreadStartFailed;
+    
 #if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
     if (pthread_create (&p->thread, NULL, pl_ThreadNativeFunction, p) != 0)
         return PlankResult_ThreadStartFailed;
@@ -324,13 +670,7 @@ PlankResult pl_Thread_Start (PlankThreadRef p)
     #error No platform defined to implement threads.
 #endif
     
-    if (p->priority != PLANK_THREAD_NOPRIORITY)
-        pl_Thread_SetPriority (p, p->priority);
-    
-    // need to be before running?
-    if (p->affinity != PLANK_THREAD_NOAFFINITY)
-        pl_Thread_SetAffinity (p, p->affinity);
-    
+    // the priority and affinity are applied by the thread itself in pl_ThreadNativeFunction()
     return PlankResult_OK;
 }
 
@@ -442,33 +782,14 @@ PlankB pl_Thread_GetShouldExit (PlankThreadRef p)
 
 PlankResult pl_Thread_SetPriority (PlankThreadRef p, int priority)
 {
-#if PLANK_APPLE || PLANK_LINUX || PLANK_ANDROID
-    struct sched_param param;
-    int policy, minPriority, maxPriority;
-
-    p->priority = priority;
+    p->priority = pl_ClipI (priority, 0, 100);
+    p->audioBlockSize = 0;
+    p->audioSampleRate = 0.0;
 
     if (!pl_Thread_IsRunning (p))
         return PlankResult_OK;
-        
-    priority = pl_ClipI (priority, 0, 100);
-                
-    if (pthread_getschedparam (p->thread, &policy, &param) != 0)
-        return PlankResult_ThreadSetPriorityFailed;
     
-    policy = (priority == 0) ? SCHED_OTHER : SCHED_RR;
-    minPriority = sched_get_priority_min (policy);
-    maxPriority = sched_get_priority_max (policy);
-    
-    param.sched_priority = ((maxPriority - minPriority) * priority) / 100 + minPriority;
-    return pthread_setschedparam (p->thread, policy, &param) == 0 
-           ? PlankResult_OK 
-           : PlankResult_ThreadSetPriorityFailed;
-#else
-    (void)p;
-    (void)priority;
-    return PlankResult_ThreadSetPriorityFailed;
-#endif
+    return pl_ThreadSetPriorityInternal (p, p->thread);
 }
 
 PlankResult pl_Thread_SetPriorityAudio (PlankThreadRef p, int blockSize, double sampleRate) 
@@ -492,45 +813,74 @@ PlankResult pl_Thread_SetPriorityAudio (PlankThreadRef p, int blockSize, double
 //    
 //    return PlankResult_OK;
 //#else
-    (void)blockSize;
-    (void)sampleRate;
-    return pl_Thread_SetPriority (p, 100);
+    p->priority = 100;
+    p->audioBlockSize = blockSize;
+    p->audioSampleRate = sampleRate;
+    
+    if (!pl_Thread_IsRunning (p))
+        return PlankResult_OK;
+
+    return pl_ThreadSetPriorityInternal (p, p->thread);
 //#endif
 }
 
-PlankResult pl_Thread_SetAffinity (PlankThreadRef p, int affinity)
+PlankResult pl_Thread_SetScheduling (PlankThreadRef p, PlankThreadScheduling scheduling)
 {
-    if (!pl_Thread_IsRunning (p))
-    {
-        p->affinity = affinity;
-        return PlankResult_OK;
-    }   
+    if ((scheduling < PlankThreadScheduling_RoundRobin) || (scheduling > PlankThreadScheduling_Deadline))
+        return PlankResult_ThreadSetPriorityFailed;
+    
+    p->scheduling = scheduling;
+    return PlankResult_OK;
+}
 
-#if PLANK_MAC
+PlankThreadScheduling pl_Thread_GetScheduling (PlankThreadRef p)
+{
+    return p->schedulingInEffect;
+}
+
+PlankResult pl_Thread_SetDeadlineLoad (PlankThreadRef p, double load)
+{
+    if ((load <= 0.0) || (load > 1.0))
+        return PlankResult_ThreadSetPriorityFailed;
     
-    (void)p;
-    (void)affinity;
-    return PlankResult_ThreadSetAffinityFailed;
+    p->deadlineLoad = load;
+    return PlankResult_OK;
+}
+
+PlankResult pl_Thread_SetLockMemory (PlankThreadRef p, PlankB lockMemory)
+{
+    if (pl_AtomicI_Get (&p->isRunningAtom))
+        return PlankResult_ThreadAlreadyRunning;
     
-#elif defined(CPU_ZERO)
+    p->lockMemory = lockMemory;
+    return PlankResult_OK;
+}
+
+PlankResult pl_Thread_SetAffinity (PlankThreadRef p, int affinity)
+{
+    p->affinity = affinity;
     
-    int numCores = sysconf (_SC_NPROCESSORS_ONLN);
+    if (!pl_Thread_IsRunning (p))
+        return PlankResult_OK;
+    
+    return pl_ThreadSetAffinityInternal (p, p->thread);
+}
 
-    if (affinity >= numCores)
+PlankResult pl_Thread_SetAffinityIsolated (PlankThreadRef p, int index)
+{
+    int cores[PLANK_THREAD_MAXCORES];
+    int numCores;
+    
+    if (index < 0)
         return PlankResult_ThreadSetAffinityFailed;
     
-    cpu_set_t cpuset;
-    CPU_ZERO (&cpuset);
-    int status = CPU_SET (affinity, &cpuset);
-    int error = pthread_setaffinity_np (p->thread, sizeof (cpu_set_t), &cpuset);
+    numCores = pl_ThreadIsolatedCores (cores, PLANK_THREAD_MAXCORES);
     
-    return PlankResult_OK;
+    if (numCores == 0)
+        numCores = pl_ThreadAllowedCoresInternal (cores, PLANK_THREAD_MAXCORES);
     
-#else
-    
-    (void)p;
-    (void)affinity;
-    return PlankResult_ThreadSetAffinityFailed;
+    if (numCores == 0)
+        return PlankResult_ThreadSetAffinityFailed;
     
-#endif
+    return pl_Thread_SetAffinity (p, cores[index % numCores]);
 }
@@ -63,6 +63,17 @@ typedef PlankUI PlankThreadID;
 typedef PlankUL PlankThreadID;
 #endif
 
+/** Thread scheduling policy. */
+typedef PlankI PlankThreadScheduling;
+
+enum PlankThreadSchedulingIdentifiers
+{
+    PlankThreadScheduling_RoundRobin = 0,   ///< Real-time round robin (SCHED_RR), this is the default.
+    PlankThreadScheduling_FIFO,             ///< Real-time first-in first-out (SCHED_FIFO).
+    PlankThreadScheduling_Deadline,         ///< Earliest deadline first (SCHED_DEADLINE, Linux only) for audio threads.
+    PlankThreadScheduling_Other             ///< Normal time-sharing scheduling.
+};
+
 /** The Thread run function.
  This should have the declaration:
  @code
@@ -108,10 +119,23 @@ PlankResult pl_ThreadSleep (PlankD seconds);
  @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_ThreadYield();
 
+/** The number of processor cores that are currently available.
+ @return The number of cores, this is always at least 1. */
+int pl_ThreadNumCores();
+
 /** Get the thread ID of the calling thread. 
  @return The thread's ID. */
 PlankThreadID pl_ThreadCurrentID();
 
+/** Gets the cores that are isolated from the general scheduler.
+ On Linux these are the cores listed in /sys/devices/system/cpu/isolated
+ (e.g., set using the isolcpus kernel parameter). Threads are only run on these
+ cores if their affinity is set to them.
+ @param cores An array to receive the core numbers.
+ @param maxCores The size of the @e cores array.
+ @return The number of isolated cores, or 0 if there are none or this is not supported. */
+int pl_ThreadIsolatedCores (int* cores, int maxCores);
+
 /** Create and initialise a <i>Plank %Thread</i> object and return an oqaque reference to it.
  @return A <i>Plank %Thread</i> object as an opaque reference or PLANK_NULL. */
 PlankThreadRef pl_Thread_CreateAndInit();
@@ -169,7 +193,8 @@ PlankResult pl_Thread_SetUserData (PlankThreadRef p, PlankP userData);
 PlankP pl_Thread_GetUserData (PlankThreadRef p);
 
 /** Starts the %Thread.
- The calls the function set using pl_Thread_SetFunction().
+ The calls the function set using pl_Thread_SetFunction(). If a previous
+ run was not waited for with pl_Thread_Wait() it is joined first.
  @param p The <i>Plank %Thread</i> object. 
  @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_Thread_Start (PlankThreadRef p);
@@ -183,6 +208,8 @@ PlankResult pl_Thread_Start (PlankThreadRef p);
 PlankResult pl_Thread_Cancel (PlankThreadRef p);
 
 /** Wait for the %Thread.
+ Blocks until the thread's run function returns and then releases it. This
+ also works once the thread has already exited.
  @param p The <i>Plank %Thread</i> object. 
  @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_Thread_Wait (PlankThreadRef p);
@@ -213,10 +240,85 @@ PlankResult pl_Thread_SetShouldExit (PlankThreadRef p);
  @return @c true if the %Thread should exit, otherwise @c false. */
 PlankB pl_Thread_GetShouldExit (PlankThreadRef p);
 
+/** Set the priority of the %Thread.
+ A priority of 0 is normal scheduling. A priority from 1 to 100 uses the
+ real-time policy set with pl_Thread_SetScheduling() with the priority scaled
+ to the policy's range. If the process is not allowed the requested real-time
+ priority it is lowered to the RLIMIT_RTPRIO limit if there is one, otherwise
+ the %Thread stays with normal scheduling and this returns
+ PlankResult_ThreadSetPriorityFailed. If the %Thread is not running the
+ priority is applied by the %Thread itself when it starts.
+ @param p The <i>Plank %Thread</i> object.
+ @param priority The priority from 0 to 100.
+ @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_Thread_SetPriority (PlankThreadRef p, int priority);
+
+/** Set the %Thread to the highest priority for processing audio.
+ With PlankThreadScheduling_Deadline on Linux the period and deadline are
+ the duration of one block and the runtime is the fraction of that set with
+ pl_Thread_SetDeadlineLoad(). If SCHED_DEADLINE is refused (e.g., without
+ privileges or because the affinity has been restricted) this falls back to
+ SCHED_FIFO at priority 100, then to normal scheduling as for
+ pl_Thread_SetPriority().
+ @param p The <i>Plank %Thread</i> object.
+ @param blockSize The number of frames processed each period.
+ @param sampleRate The sample rate.
+ @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_Thread_SetPriorityAudio (PlankThreadRef p, int blockSize, double sampleRate);
+
+/** Set the scheduling policy used for real-time priorities.
+ This takes effect at the next call to pl_Thread_SetPriority() or
+ pl_Thread_SetPriorityAudio() or when the %Thread starts.
+ @param p The <i>Plank %Thread</i> object.
+ @param scheduling One of the PlankThreadScheduling values (not PlankThreadScheduling_Other).
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Thread_SetScheduling (PlankThreadRef p, PlankThreadScheduling scheduling);
+
+/** Get the scheduling policy the %Thread is actually running with.
+ This may differ from the policy requested if it fell back to another.
+ @param p The <i>Plank %Thread</i> object.
+ @return One of the PlankThreadScheduling values. */
+PlankThreadScheduling pl_Thread_GetScheduling (PlankThreadRef p);
+
+/** Set the fraction of each period reserved for the %Thread under SCHED_DEADLINE.
+ The default is 0.5.
+ @param p The <i>Plank %Thread</i> object.
+ @param load The fraction of the period from greater than 0 to 1.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Thread_SetDeadlineLoad (PlankThreadRef p, double load);
+
+/** Lock the process's memory when the %Thread starts.
+ If this is set when the %Thread starts it calls mlockall() so that current
+ and future pages stay resident, then touches the top of its own stack so
+ those pages are faulted in before the run function is called. If the
+ process is not allowed to lock its memory the %Thread starts anyway.
+ Note that mlockall() applies to the whole process, not just this %Thread, 
+ and is not undone when the %Thread exits. This is only done on Linux.
+ This must be called before pl_Thread_Start().
+ @param p The <i>Plank %Thread</i> object.
+ @param lockMemory @c true to lock memory.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Thread_SetLockMemory (PlankThreadRef p, PlankB lockMemory);
+
+/** Set the core the %Thread runs on.
+ If the %Thread is not running the affinity is applied by the %Thread itself
+ when it starts.
+ @param p The <i>Plank %Thread</i> object.
+ @param affinity The core number.
+ @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_Thread_SetAffinity (PlankThreadRef p, int affinity);
 
+/** Set the %Thread to run on one of the isolated cores.
+ The core is the (index % n)th of the n cores returned by
+ pl_ThreadIsolatedCores(). If there are no isolated cores it is the
+ (index % n)th of the n cores the calling thread is allowed to run on. So a
+ pool of threads given indices 0, 1, 2... are spread over the isolated cores
+ when there are some and over the available cores otherwise.
+ @param p The <i>Plank %Thread</i> object.
+ @param index The index of the core.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_Thread_SetAffinityIsolated (PlankThreadRef p, int index);
+
 /** @} */
 
 PLANK_END_C_LINKAGE
@@ -255,6 +357,13 @@ typedef struct PlankThread
     char name[PLANK_THREAD_MAXNAMELENGTH];
     int priority;
     int affinity;
+    int nativeID;
+    PlankThreadScheduling scheduling;
+    PlankThreadScheduling schedulingInEffect;
+    int audioBlockSize;
+    double audioSampleRate;
+    double deadlineLoad;
+    PlankB lockMemory;
 } PlankThread;
 #endif
 
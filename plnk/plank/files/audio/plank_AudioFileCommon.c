@@ -53,6 +53,7 @@ const char* pl_PlankAudioFileGetFormatName (int format)
         case PLANKAUDIOFILE_FORMAT_OPUS:        return "Opus";
         case PLANKAUDIOFILE_FORMAT_CAF:         return "CAF";
         case PLANKAUDIOFILE_FORMAT_W64:         return "W64";
+        case PLANKAUDIOFILE_FORMAT_FLAC:        return "FLAC";
         case PLANKAUDIOFILE_FORMAT_REGION:      return "Region";
         case PLANKAUDIOFILE_FORMAT_MULTI:       return "Multi";
         case PLANKAUDIOFILE_FORMAT_ARRAY:       return "Array";
@@ -1492,3 +1493,28 @@ void pl_AudioFileFormatInfo_Opus_SetDefaultLayout (PlankAudioFileFormatInfoRef f
     pl_AudioFileFormatInfo_OggVorbis_SetDefaultLayout (formatInfo);
 }
 
+void pl_AudioFileFormatInfo_FLAC_SetDefaultLayout (PlankAudioFileFormatInfoRef formatInfo)
+{
+    PlankChannelIdentifier* channelIdentifiers;
+    PlankUI numChannels;
+    
+    numChannels = pl_AudioFileFormatInfo_GetNumChannels (formatInfo);
+    
+    if (numChannels > 0)
+    {
+        channelIdentifiers = pl_AudioFileFormatInfo_GetChannelIdentifiers (formatInfo);
+        
+        switch (numChannels)
+        {
+            case 1:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = PLANKAUDIOFILE_LAYOUT_MONO); break;
+            case 2:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = PLANKAUDIOFILE_LAYOUT_STEREO); break;
+            case 3:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = PLANKAUDIOFILE_LAYOUT_MPEG_3_0_A); break;
+            case 4:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = PLANKAUDIOFILE_LAYOUT_QUADRAPHONIC); break;
+            case 5:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = (PlankUI)PLANKAUDIOFILE_LAYOUT_MPEG_5_0_A); break;
+            case 6:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = (PlankUI)PLANKAUDIOFILE_LAYOUT_MPEG_5_1_A); break;
+            case 8:  pl_AudioFileFormatInfoLayoutToFormatChannelIdentifiers (channelIdentifiers, formatInfo->channelLayout = (PlankUI)PLANKAUDIOFILE_LAYOUT_MPEG_7_1_C); break;
+            default: pl_AudioFileFormatInfo_SetDiscreteLayout (formatInfo); // 6.1 has a back centre which has no standard layout here
+        }
+    }
+}
+
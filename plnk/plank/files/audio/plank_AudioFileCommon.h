@@ -56,6 +56,7 @@
 #define PLANKAUDIOFILE_FORMAT_OPUS                    6
 #define PLANKAUDIOFILE_FORMAT_CAF                     7
 #define PLANKAUDIOFILE_FORMAT_W64                     8
+#define PLANKAUDIOFILE_FORMAT_FLAC                    9
 #define PLANKAUDIOFILE_FORMAT_REGION                 99
 #define PLANKAUDIOFILE_FORMAT_MULTI                 100
 #define PLANKAUDIOFILE_FORMAT_ARRAY                 101
@@ -586,6 +587,7 @@ void pl_AudioFileFormatInfo_WAV_SetDefaultLayout (PlankAudioFileFormatInfoRef fo
 void pl_AudioFileFormatInfo_AIFF_SetDefaultLayout (PlankAudioFileFormatInfoRef formatInfo);
 void pl_AudioFileFormatInfo_OggVorbis_SetDefaultLayout (PlankAudioFileFormatInfoRef formatInfo);
 void pl_AudioFileFormatInfo_Opus_SetDefaultLayout (PlankAudioFileFormatInfoRef formatInfo);
+void pl_AudioFileFormatInfo_FLAC_SetDefaultLayout (PlankAudioFileFormatInfoRef formatInfo);
 
 PLANK_END_C_LINKAGE
 
@@ -0,0 +1,647 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "../../core/plank_StandardHeader.h"
+#include "plank_AudioFileIndex.h"
+#include "plank_AudioFileMetaData.h"
+#include "plank_AudioFileCuePoint.h"
+
+#define PLANKAUDIOFILEINDEX_BYTEORDERMARK   0x01020304
+
+// FNV-1a
+static PlankULL pl_AudioFileIndex_HashPath (const char* filepath)
+{
+    PlankULL hash = 14695981039346656037ULL;
+    
+    while (*filepath)
+    {
+        hash ^= (PlankUC)*filepath++;
+        hash *= 1099511628211ULL;
+    }
+    
+    return hash;
+}
+
+// DynamicArray grows in small steps which is slow for tables this size
+static PlankResult pl_AudioFileIndex_EnsureSpace (PlankDynamicArrayRef array, const PlankL numItems)
+{
+    PlankL required;
+    
+    required = pl_DynamicArray_GetSize (array) + numItems;
+    
+    if (required <= array->allocatedItems)
+        return PlankResult_OK;
+    
+    return pl_DynamicArray_EnsureSize (array, pl_MaxL (required, array->allocatedItems * 2));
+}
+
+static int pl_AudioFileIndex_CompareEntries (const void* a, const void* b)
+{
+    const PlankAudioFileIndexEntry* entryA = (const PlankAudioFileIndexEntry*)a;
+    const PlankAudioFileIndexEntry* entryB = (const PlankAudioFileIndexEntry*)b;
+    
+    return (entryA->pathHash < entryB->pathHash) ? -1 : (entryA->pathHash > entryB->pathHash) ? 1 : 0;
+}
+
+PlankAudioFileIndexRef pl_AudioFileIndex_CreateAndInit()
+{
+    PlankAudioFileIndexRef p;
+    p = pl_AudioFileIndex_Create();
+    
+    if (p != PLANK_NULL)
+    {
+        if (pl_AudioFileIndex_Init (p) != PlankResult_OK)
+            pl_AudioFileIndex_Destroy (p);
+        else
+            return p;
+    }
+    
+    return PLANK_NULL;
+}
+
+PlankAudioFileIndexRef pl_AudioFileIndex_Create()
+{
+    PlankMemoryRef m;
+    PlankAudioFileIndexRef p;
+    
+    m = pl_MemoryGlobal();
+    p = (PlankAudioFileIndexRef)pl_Memory_AllocateBytes (m, sizeof (PlankAudioFileIndex));
+    
+    if (p != PLANK_NULL)
+        pl_MemoryZero (p, sizeof (PlankAudioFileIndex));
+    
+    return p;
+}
+
+PlankResult pl_AudioFileIndex_Init (PlankAudioFileIndexRef p)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (p, sizeof (PlankAudioFileIndex));
+    
+    if ((result = pl_Lock_Init (&p->lock)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSize (&p->entries, sizeof (PlankAudioFileIndexEntry))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSize (&p->cuePoints, sizeof (PlankAudioFileIndexCuePoint))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSize (&p->channelIdentifiers, sizeof (PlankChannelIdentifier))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSize (&p->strings, 1)) != PlankResult_OK) goto exit;
+    
+    result = pl_AudioFileIndex_Clear (p);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_DeInit (PlankAudioFileIndexRef p)
+{
+    PlankResult result = PlankResult_OK;
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((result = pl_DynamicArray_DeInit (&p->entries)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&p->cuePoints)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&p->channelIdentifiers)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&p->strings)) != PlankResult_OK) goto exit;
+    if ((result = pl_Lock_DeInit (&p->lock)) != PlankResult_OK) goto exit;
+    
+    pl_MemoryZero (p, sizeof (PlankAudioFileIndex));
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_Destroy (PlankAudioFileIndexRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    if ((result = pl_AudioFileIndex_DeInit (p)) != PlankResult_OK)
+        goto exit;
+    
+    result = pl_Memory_Free (m, p);
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_AudioFileIndex_ClearInternal (PlankAudioFileIndexRef p)
+{
+    PlankResult result = PlankResult_OK;
+    char empty = '\0';
+    
+    if ((result = pl_DynamicArray_SetSize (&p->entries, 0)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->cuePoints, 0)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->channelIdentifiers, 0)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->strings, 0)) != PlankResult_OK) goto exit;
+    
+    // string offset 0 is always the empty string
+    if ((result = pl_DynamicArray_AddItem (&p->strings, &empty)) != PlankResult_OK) goto exit;
+    
+    p->isSorted = PLANK_TRUE;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_Clear (PlankAudioFileIndexRef p)
+{
+    PlankResult result;
+    
+    pl_Lock_Lock (&p->lock);
+    result = pl_AudioFileIndex_ClearInternal (p);
+    pl_Lock_Unlock (&p->lock);
+    
+    return result;
+}
+
+void pl_AudioFileIndex_Lock (PlankAudioFileIndexRef p)
+{
+    pl_Lock_Lock (&p->lock);
+}
+
+void pl_AudioFileIndex_Unlock (PlankAudioFileIndexRef p)
+{
+    pl_Lock_Unlock (&p->lock);
+}
+
+int pl_AudioFileIndex_GetNumEntries (PlankAudioFileIndexRef p)
+{
+    return (int)pl_DynamicArray_GetSize (&p->entries);
+}
+
+const PlankAudioFileIndexCuePoint* pl_AudioFileIndex_GetCuePoints (PlankAudioFileIndexRef p, const PlankAudioFileIndexEntry* entry)
+{
+    return (const PlankAudioFileIndexCuePoint*)pl_DynamicArray_GetArray (&p->cuePoints) + entry->cuePointsOffset;
+}
+
+const PlankChannelIdentifier* pl_AudioFileIndex_GetChannelIdentifiers (PlankAudioFileIndexRef p, const PlankAudioFileIndexEntry* entry)
+{
+    return (const PlankChannelIdentifier*)pl_DynamicArray_GetArray (&p->channelIdentifiers) + entry->channelIdentifiersOffset;
+}
+
+const char* pl_AudioFileIndex_GetString (PlankAudioFileIndexRef p, const PlankUI offset)
+{
+    return (const char*)pl_DynamicArray_GetArray (&p->strings) + offset;
+}
+
+static PlankResult pl_AudioFileIndex_AddString (PlankAudioFileIndexRef p, const char* text, PlankUI* offset)
+{
+    PlankResult result = PlankResult_OK;
+    PlankL length;
+    
+    if ((text == PLANK_NULL) || (text[0] == '\0'))
+    {
+        *offset = 0;
+        goto exit;
+    }
+    
+    *offset = (PlankUI)pl_DynamicArray_GetSize (&p->strings);
+    length = (PlankL)strlen (text) + 1;
+
+    if ((result = pl_AudioFileIndex_EnsureSpace (&p->strings, length)) != PlankResult_OK) goto exit;
+    
+    result = pl_DynamicArray_AddItems (&p->strings, text, length);
+    
+exit:
+    return result;
+}
+
+static void pl_AudioFileIndex_Sort (PlankAudioFileIndexRef p)
+{
+    PlankL numEntries;
+    
+    if (p->isSorted)
+        return;
+    
+    numEntries = pl_DynamicArray_GetSize (&p->entries);
+    
+    if (numEntries > 1)
+        qsort (pl_DynamicArray_GetArray (&p->entries), (size_t)numEntries, sizeof (PlankAudioFileIndexEntry), pl_AudioFileIndex_CompareEntries);
+    
+    p->isSorted = PLANK_TRUE;
+}
+
+// returns the index of the entry or -1
+static PlankL pl_AudioFileIndex_FindInternal (PlankAudioFileIndexRef p, const char* filepath, const PlankULL pathHash)
+{
+    PlankAudioFileIndexEntry* entries;
+    PlankL low, high, mid, numEntries;
+    
+    pl_AudioFileIndex_Sort (p);
+    
+    entries = (PlankAudioFileIndexEntry*)pl_DynamicArray_GetArray (&p->entries);
+    numEntries = pl_DynamicArray_GetSize (&p->entries);
+    
+    low = 0;
+    high = numEntries;
+    
+    // find the first entry with this hash
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        
+        if (entries[mid].pathHash < pathHash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    
+    for (; (low < numEntries) && (entries[low].pathHash == pathHash); ++low)
+    {
+        if (strcmp (pl_AudioFileIndex_GetString (p, entries[low].pathOffset), filepath) == 0)
+            return low;
+    }
+    
+    return -1;
+}
+
+PlankResult pl_AudioFileIndex_Find (PlankAudioFileIndexRef p, const char* filepath, const PlankAudioFileIndexEntry** entry)
+{
+    PlankResult result = PlankResult_OK;
+    PlankAudioFileIndexEntry* entries;
+    PlankLL fileSize, modificationTime;
+    PlankL index;
+    
+    *entry = PLANK_NULL;
+    
+    index = pl_AudioFileIndex_FindInternal (p, filepath, pl_AudioFileIndex_HashPath (filepath));
+    
+    if (index < 0)
+        goto exit;
+    
+    if ((result = pl_FileGetInfo (filepath, &fileSize, &modificationTime)) != PlankResult_OK) goto exit;
+    
+    entries = (PlankAudioFileIndexEntry*)pl_DynamicArray_GetArray (&p->entries);
+
+    if ((entries[index].fileSize == fileSize) && (entries[index].modificationTime == modificationTime))
+        *entry = entries + index;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_AddReader (PlankAudioFileIndexRef p, const char* filepath, PlankAudioFileReaderRef reader)
+{
+    PlankResult result = PlankResult_OK;
+    PlankAudioFileIndexEntry entry;
+    PlankAudioFileIndexCuePoint indexCuePoint;
+    PlankAudioFileCuePointRef cuePoint;
+    PlankSharedPtrArrayRef cuePoints;
+    PlankChannelIdentifier channelIdentifier;
+    PlankAudioFileMetaDataRef metaData;
+    PlankL index, i;
+    
+    switch (reader->format)
+    {
+        case PLANKAUDIOFILE_FORMAT_WAV:
+        case PLANKAUDIOFILE_FORMAT_AIFF:
+        case PLANKAUDIOFILE_FORMAT_AIFC:
+        case PLANKAUDIOFILE_FORMAT_CAF:
+        case PLANKAUDIOFILE_FORMAT_W64:
+            break;
+        default:
+            return PlankResult_AudioFileUnsupportedType;
+    }
+    
+    if ((reader->dataPosition < 0) || (reader->formatInfo.bytesPerFrame <= 0))
+        return PlankResult_AudioFileNotReady;
+    
+    pl_MemoryZero (&entry, sizeof (entry));
+    
+    if ((result = pl_FileGetInfo (filepath, &entry.fileSize, &entry.modificationTime)) != PlankResult_OK)
+        return result;
+    
+    entry.pathHash      = pl_AudioFileIndex_HashPath (filepath);
+    entry.numFrames     = reader->numFrames;
+    entry.dataPosition  = reader->dataPosition;
+    entry.sampleRate    = reader->formatInfo.sampleRate;
+    entry.numChannels   = (PlankUI)pl_AudioFileFormatInfo_GetNumChannels (&reader->formatInfo);
+    entry.channelLayout = reader->formatInfo.channelLayout;
+    entry.bitsPerSample = reader->formatInfo.bitsPerSample;
+    entry.bytesPerFrame = reader->formatInfo.bytesPerFrame;
+    entry.format        = (PlankUC)reader->formatInfo.format;
+    entry.encoding      = (PlankUC)reader->formatInfo.encoding;
+    
+    pl_Lock_Lock (&p->lock);
+    
+    // updated entries just leave their old data behind until the index is saved
+    if ((result = pl_AudioFileIndex_AddString (p, filepath, &entry.pathOffset)) != PlankResult_OK) goto exit;
+    
+    entry.channelIdentifiersOffset = (PlankUI)pl_DynamicArray_GetSize (&p->channelIdentifiers);
+    
+    if ((result = pl_AudioFileIndex_EnsureSpace (&p->channelIdentifiers, entry.numChannels)) != PlankResult_OK) goto exit;
+    
+    for (i = 0; i < (PlankL)entry.numChannels; ++i)
+    {
+        channelIdentifier = pl_AudioFileFormatInfo_GetChannelItentifier (&reader->formatInfo, (int)i);
+        if ((result = pl_DynamicArray_AddItem (&p->channelIdentifiers, &channelIdentifier)) != PlankResult_OK) goto exit;
+    }
+    
+    metaData = reader->metaData;
+    
+    if (metaData && (reader->metaDataIOFlags & PLANKAUDIOFILEMETADATA_IOFLAGS_CUEPOINTS))
+    {
+        cuePoints = pl_AudioFileMetaData_GetCuePoints (metaData);
+        
+        entry.flags |= PLANKAUDIOFILEINDEX_FLAGS_CUEPOINTS;
+        entry.cuePointsOffset = (PlankUI)pl_DynamicArray_GetSize (&p->cuePoints);
+        entry.numCuePoints = (PlankUI)pl_SharedPtrArray_GetLength (cuePoints);
+        
+        if ((result = pl_AudioFileIndex_EnsureSpace (&p->cuePoints, entry.numCuePoints)) != PlankResult_OK) goto exit;
+        
+        for (i = 0; i < (PlankL)entry.numCuePoints; ++i)
+        {
+            cuePoint = (PlankAudioFileCuePointRef)pl_SharedPtrArray_GetSharedPtr (cuePoints, i);
+            
+            pl_MemoryZero (&indexCuePoint, sizeof (indexCuePoint));
+            indexCuePoint.position = pl_AudioFileCuePoint_GetPosition (cuePoint);
+            indexCuePoint.cueID    = pl_AudioFileCuePoint_GetID (cuePoint);
+            indexCuePoint.type     = pl_AudioFileCuePoint_GetType (cuePoint);
+            
+            if ((result = pl_AudioFileIndex_AddString (p, pl_AudioFileCuePoint_GetLabel (cuePoint), &indexCuePoint.labelOffset)) != PlankResult_OK) goto exit;
+            if ((result = pl_DynamicArray_AddItem (&p->cuePoints, &indexCuePoint)) != PlankResult_OK) goto exit;
+        }
+    }
+    
+    index = pl_AudioFileIndex_FindInternal (p, filepath, entry.pathHash);
+    
+    if (index >= 0)
+    {
+        result = pl_DynamicArray_SetItem (&p->entries, index, &entry);
+    }
+    else
+    {
+        if ((result = pl_AudioFileIndex_EnsureSpace (&p->entries, 1)) != PlankResult_OK) goto exit;
+        
+        result = pl_DynamicArray_AddItem (&p->entries, &entry);
+        p->isSorted = PLANK_FALSE;
+    }
+    
+exit:
+    pl_Lock_Unlock (&p->lock);
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_LoadFromMemory (PlankAudioFileIndexRef p, const void* data, const PlankLL size)
+{
+    PlankResult result = PlankResult_OK;
+    const PlankUC* ptr;
+    const PlankAudioFileIndexEntry* entries;
+    const PlankAudioFileIndexCuePoint* cuePoints;
+    PlankAudioFileIndexHeader header;
+    PlankLL expectedSize;
+    PlankUI i;
+    
+    pl_Lock_Lock (&p->lock);
+    
+    if ((result = pl_AudioFileIndex_ClearInternal (p)) != PlankResult_OK) goto exit;
+    
+    if (size < (PlankLL)sizeof (PlankAudioFileIndexHeader))
+    {
+        result = PlankResult_FileReadError;
+        goto exit;
+    }
+    
+    ptr = (const PlankUC*)data;
+    pl_MemoryCopy (&header, ptr, sizeof (header));
+    ptr += sizeof (header);
+    
+    if ((header.magic != PLANKAUDIOFILEINDEX_MAGIC) ||
+        (header.version != PLANKAUDIOFILEINDEX_VERSION) ||
+        (header.byteOrderMark != PLANKAUDIOFILEINDEX_BYTEORDERMARK) ||
+        (header.stringsLength < 1))
+    {
+        result = PlankResult_FileReadError;
+        goto exit;
+    }
+    
+    expectedSize = (PlankLL)sizeof (PlankAudioFileIndexHeader) +
+                   (PlankLL)header.numEntries * (PlankLL)sizeof (PlankAudioFileIndexEntry) +
+                   (PlankLL)header.numCuePoints * (PlankLL)sizeof (PlankAudioFileIndexCuePoint) +
+                   (PlankLL)header.numChannelIdentifiers * (PlankLL)sizeof (PlankChannelIdentifier) +
+                   (PlankLL)header.stringsLength;
+    
+    if (size < expectedSize)
+    {
+        result = PlankResult_FileReadError;
+        goto exit;
+    }
+    
+    entries = (const PlankAudioFileIndexEntry*)ptr;
+    ptr += header.numEntries * sizeof (PlankAudioFileIndexEntry);
+    cuePoints = (const PlankAudioFileIndexCuePoint*)ptr;
+    ptr += header.numCuePoints * sizeof (PlankAudioFileIndexCuePoint);
+    
+    // check the offsets so a damaged index can't take us outside the tables
+    for (i = 0; i < header.numEntries; ++i)
+    {
+        if ((entries[i].pathOffset >= header.stringsLength) ||
+            (((PlankLL)entries[i].cuePointsOffset + entries[i].numCuePoints) > header.numCuePoints) ||
+            (((PlankLL)entries[i].channelIdentifiersOffset + entries[i].numChannels) > header.numChannelIdentifiers))
+        {
+            result = PlankResult_FileReadError;
+            goto exit;
+        }
+    }
+
+    for (i = 0; i < header.numCuePoints; ++i)
+    {
+        if (cuePoints[i].labelOffset >= header.stringsLength)
+        {
+            result = PlankResult_FileReadError;
+            goto exit;
+        }
+    }
+    
+    if ((result = pl_DynamicArray_SetSize (&p->entries, header.numEntries)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->cuePoints, header.numCuePoints)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->channelIdentifiers, header.numChannelIdentifiers)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->strings, header.stringsLength)) != PlankResult_OK) goto exit;
+    
+    pl_MemoryCopy (pl_DynamicArray_GetArray (&p->entries), entries, header.numEntries * sizeof (PlankAudioFileIndexEntry));
+    pl_MemoryCopy (pl_DynamicArray_GetArray (&p->cuePoints), cuePoints, header.numCuePoints * sizeof (PlankAudioFileIndexCuePoint));
+    pl_MemoryCopy (pl_DynamicArray_GetArray (&p->channelIdentifiers), ptr, header.numChannelIdentifiers * sizeof (PlankChannelIdentifier));
+    ptr += header.numChannelIdentifiers * sizeof (PlankChannelIdentifier);
+    pl_MemoryCopy (pl_DynamicArray_GetArray (&p->strings), ptr, header.stringsLength);
+    
+    // make sure the last string is terminated
+    ((char*)pl_DynamicArray_GetArray (&p->strings))[header.stringsLength - 1] = '\0';
+    
+    // saved indexes are sorted but don't rely on it
+    p->isSorted = PLANK_FALSE;
+    
+exit:
+    if (result != PlankResult_OK)
+        pl_AudioFileIndex_ClearInternal (p);
+    
+    pl_Lock_Unlock (&p->lock);
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_Load (PlankAudioFileIndexRef p, const char* filepath)
+{
+    PlankResult result = PlankResult_OK;
+    PlankDynamicArray data;
+    PlankFile file;
+    PlankLL size;
+    int bytesRead;
+    
+    pl_File_Init (&file);
+    pl_DynamicArray_InitWithItemSize (&data, 1);
+    
+    if ((result = pl_File_OpenBinaryNativeEndianRead (&file, filepath, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_SetPositionEnd (&file)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_GetPosition (&file, &size)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_ResetPosition (&file)) != PlankResult_OK) goto exit;
+    
+    if ((size <= 0) || (size > 0x7fffffff))
+    {
+        result = PlankResult_FileReadError;
+        goto exit;
+    }
+    
+    if ((result = pl_DynamicArray_SetSize (&data, (PlankL)size)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_Read (&file, pl_DynamicArray_GetArray (&data), (int)size, &bytesRead)) != PlankResult_OK) goto exit;
+    
+    result = pl_AudioFileIndex_LoadFromMemory (p, pl_DynamicArray_GetArray (&data), bytesRead);
+    
+exit:
+    pl_File_DeInit (&file);
+    pl_DynamicArray_DeInit (&data);
+    return result;
+}
+
+PlankResult pl_AudioFileIndex_Save (PlankAudioFileIndexRef p, const char* filepath)
+{
+    PlankResult result = PlankResult_OK;
+    PlankAudioFileIndex compact;
+    PlankAudioFileIndexHeader header;
+    PlankAudioFileIndexEntry entry;
+    PlankAudioFileIndexCuePoint cuePoint;
+    const PlankAudioFileIndexEntry* entries;
+    const PlankAudioFileIndexCuePoint* cuePoints;
+    const PlankChannelIdentifier* channelIdentifiers;
+    PlankFile file;
+    PlankL numEntries, i;
+    PlankUI j;
+    
+    pl_File_Init (&file);
+    pl_MemoryZero (&compact, sizeof (compact));
+    pl_DynamicArray_InitWithItemSize (&compact.entries, sizeof (PlankAudioFileIndexEntry));
+    pl_DynamicArray_InitWithItemSize (&compact.cuePoints, sizeof (PlankAudioFileIndexCuePoint));
+    pl_DynamicArray_InitWithItemSize (&compact.channelIdentifiers, sizeof (PlankChannelIdentifier));
+    pl_DynamicArray_InitWithItemSize (&compact.strings, 1);
+    
+    pl_Lock_Lock (&p->lock);
+    
+    if ((result = pl_AudioFileIndex_ClearInternal (&compact)) != PlankResult_OK) goto exit;
+    
+    pl_AudioFileIndex_Sort (p);
+    
+    // copy into a new index leaving behind anything left by updated entries
+    entries = (const PlankAudioFileIndexEntry*)pl_DynamicArray_GetArray (&p->entries);
+    numEntries = pl_DynamicArray_GetSize (&p->entries);
+    
+    if ((result = pl_DynamicArray_EnsureSize (&compact.entries, numEntries)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_EnsureSize (&compact.cuePoints, pl_DynamicArray_GetSize (&p->cuePoints))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_EnsureSize (&compact.channelIdentifiers, pl_DynamicArray_GetSize (&p->channelIdentifiers))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_EnsureSize (&compact.strings, pl_DynamicArray_GetSize (&p->strings))) != PlankResult_OK) goto exit;
+    
+    for (i = 0; i < numEntries; ++i)
+    {
+        entry = entries[i];
+        
+        if ((result = pl_AudioFileIndex_AddString (&compact, pl_AudioFileIndex_GetString (p, entries[i].pathOffset), &entry.pathOffset)) != PlankResult_OK) goto exit;
+        
+        channelIdentifiers = pl_AudioFileIndex_GetChannelIdentifiers (p, entries + i);
+        entry.channelIdentifiersOffset = (PlankUI)pl_DynamicArray_GetSize (&compact.channelIdentifiers);
+        if ((result = pl_DynamicArray_AddItems (&compact.channelIdentifiers, channelIdentifiers, entry.numChannels)) != PlankResult_OK) goto exit;
+        
+        cuePoints = pl_AudioFileIndex_GetCuePoints (p, entries + i);
+        entry.cuePointsOffset = (PlankUI)pl_DynamicArray_GetSize (&compact.cuePoints);
+        
+        for (j = 0; j < entry.numCuePoints; ++j)
+        {
+            cuePoint = cuePoints[j];
+            if ((result = pl_AudioFileIndex_AddString (&compact, pl_AudioFileIndex_GetString (p, cuePoints[j].labelOffset), &cuePoint.labelOffset)) != PlankResult_OK) goto exit;
+            if ((result = pl_DynamicArray_AddItem (&compact.cuePoints, &cuePoint)) != PlankResult_OK) goto exit;
+        }
+        
+        if ((result = pl_DynamicArray_AddItem (&compact.entries, &entry)) != PlankResult_OK) goto exit;
+    }
+    
+    pl_MemoryZero (&header, sizeof (header));
+    header.magic                    = PLANKAUDIOFILEINDEX_MAGIC;
+    header.version                  = PLANKAUDIOFILEINDEX_VERSION;
+    header.byteOrderMark            = PLANKAUDIOFILEINDEX_BYTEORDERMARK;
+    header.numEntries               = (PlankUI)pl_DynamicArray_GetSize (&compact.entries);
+    header.numCuePoints             = (PlankUI)pl_DynamicArray_GetSize (&compact.cuePoints);
+    header.numChannelIdentifiers    = (PlankUI)pl_DynamicArray_GetSize (&compact.channelIdentifiers);
+    header.stringsLength            = (PlankUI)pl_DynamicArray_GetSize (&compact.strings);
+    
+    if ((result = pl_File_OpenBinaryNativeEndianWrite (&file, filepath, PLANK_FALSE, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_Write (&file, &header, sizeof (header))) != PlankResult_OK) goto exit;
+    if ((result = pl_File_WriteDynamicArray (&file, &compact.entries)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_WriteDynamicArray (&file, &compact.cuePoints)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_WriteDynamicArray (&file, &compact.channelIdentifiers)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_WriteDynamicArray (&file, &compact.strings)) != PlankResult_OK) goto exit;
+    
+exit:
+    pl_Lock_Unlock (&p->lock);
+    pl_File_DeInit (&file);
+    pl_DynamicArray_DeInit (&compact.entries);
+    pl_DynamicArray_DeInit (&compact.cuePoints);
+    pl_DynamicArray_DeInit (&compact.channelIdentifiers);
+    pl_DynamicArray_DeInit (&compact.strings);
+    return result;
+}
@@ -0,0 +1,203 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_AUDIOFILEINDEX_H
+#define PLANK_AUDIOFILEINDEX_H
+
+#include "plank_AudioFileReader.h"
+#include "../../core/plank_Lock.h"
+
+#define PLANKAUDIOFILEINDEX_MAGIC               pl_FourCharCode ("PAFI")
+#define PLANKAUDIOFILEINDEX_VERSION             1
+#define PLANKAUDIOFILEINDEX_FLAGS_CUEPOINTS     (1 << 0)
+
+PLANK_BEGIN_C_LINKAGE
+
+/** The header of a saved index, followed by the entries, cue points, channel identifiers and strings. */
+typedef struct PlankAudioFileIndexHeader
+{
+    PlankFourCharCode magic;
+    PlankUI version;
+    PlankUI byteOrderMark;
+    PlankUI numEntries;
+    PlankUI numCuePoints;
+    PlankUI numChannelIdentifiers;
+    PlankUI stringsLength;
+    PlankUI reserved;
+} PlankAudioFileIndexHeader;
+
+/** The stored details of one file. Offsets index the cue point, channel identifier and string tables. */
+typedef struct PlankAudioFileIndexEntry
+{
+    PlankULL pathHash;
+    PlankLL fileSize;
+    PlankLL modificationTime;
+    PlankLL numFrames;
+    PlankLL dataPosition;
+    PlankD sampleRate;
+    PlankUI pathOffset;
+    PlankUI cuePointsOffset;
+    PlankUI numCuePoints;
+    PlankUI channelIdentifiersOffset;
+    PlankUI numChannels;
+    PlankChannelLayout channelLayout;
+    PlankI bitsPerSample;
+    PlankI bytesPerFrame;
+    PlankUC format;
+    PlankUC encoding;
+    PlankUC flags;
+    PlankUC reserved1;
+    PlankUI reserved2;
+} PlankAudioFileIndexEntry;
+
+/** A stored cue point. */
+typedef struct PlankAudioFileIndexCuePoint
+{
+    PlankD position;
+    PlankUI cueID;
+    PlankI type;
+    PlankUI labelOffset;
+    PlankUI reserved;
+} PlankAudioFileIndexCuePoint;
+
+/** A persistent index of audio file headers.
+ 
+ Each entry records what the <i>Plank AudioFileReader</i> needs to read an 
+ audio file without parsing it again: the format, frame count, the position 
+ of the audio data and optionally the cue points. Entries are keyed on the 
+ path and checked against the file's size and modification time before use 
+ so modified files are parsed again. Only the uncompressed IFF based formats 
+ (WAV, AIFF, AIFC, CAF and W64) are indexed.
+ 
+ Use pl_AudioFileReader_OpenWithIndex() to open files through an index. 
+ 
+ The saved index is a header followed by flat tables of fixed size records in 
+ the byte order of the machine that wrote it. Records refer to each other by 
+ offsets rather than pointers so the whole file is loaded with a single read 
+ and could equally be mapped into memory and passed to pl_AudioFileIndex_LoadFromMemory().
+ 
+ @defgroup PlankAudioFileIndexClass Plank AudioFileIndex class
+ @ingroup PlankClasses
+ @{
+ */
+
+/** Create and initialise a <i>Plank AudioFileIndex</i> object and return an oqaque reference to it.
+ @return A <i>Plank AudioFileIndex</i> object as an opaque reference or PLANK_NULL. */
+PlankAudioFileIndexRef pl_AudioFileIndex_CreateAndInit();
+
+/** Create a <i>Plank AudioFileIndex</i> object and return an oqaque reference to it.
+ @return A <i>Plank AudioFileIndex</i> object as an opaque reference or PLANK_NULL. */
+PlankAudioFileIndexRef pl_AudioFileIndex_Create();
+
+/** Initialise a <i>Plank AudioFileIndex</i> object. 
+ @param p The <i>Plank AudioFileIndex</i> object. 
+ @return A result code which will be PlankResult_OK if the operation was completely successful. */
+PlankResult pl_AudioFileIndex_Init (PlankAudioFileIndexRef p);
+
+/** Deinitialise a <i>Plank AudioFileIndex</i> object. 
+ @param p The <i>Plank AudioFileIndex</i> object. 
+ @return A result code which will be PlankResult_OK if the operation was completely successful. */
+PlankResult pl_AudioFileIndex_DeInit (PlankAudioFileIndexRef p);
+
+/** Destroy a <i>Plank AudioFileIndex</i> object. 
+ @param p The <i>Plank AudioFileIndex</i> object. 
+ @return A result code which will be PlankResult_OK if the operation was completely successful. */
+PlankResult pl_AudioFileIndex_Destroy (PlankAudioFileIndexRef p);
+
+/** Remove all the entries. */
+PlankResult pl_AudioFileIndex_Clear (PlankAudioFileIndexRef p);
+
+/** Replace the contents with an index previously written by pl_AudioFileIndex_Save(). */
+PlankResult pl_AudioFileIndex_Load (PlankAudioFileIndexRef p, const char* filepath);
+
+/** Replace the contents with an index held in memory in the format written by pl_AudioFileIndex_Save(). 
+ The data is copied so it need not remain valid after this call. */
+PlankResult pl_AudioFileIndex_LoadFromMemory (PlankAudioFileIndexRef p, const void* data, const PlankLL size);
+
+/** Write the index to a file, replacing any existing file. */
+PlankResult pl_AudioFileIndex_Save (PlankAudioFileIndexRef p, const char* filepath);
+
+/** The number of files in the index. */
+int pl_AudioFileIndex_GetNumEntries (PlankAudioFileIndexRef p);
+
+/** Add or update the entry for a file from an open reader.
+ The reader should have just been opened from @e filepath. If the reader was opened with
+ cue points in its metadata these are stored too.
+ @return PlankResult_AudioFileUnsupportedType if the format is not one that can be indexed. */
+PlankResult pl_AudioFileIndex_AddReader (PlankAudioFileIndexRef p, const char* filepath, PlankAudioFileReaderRef reader);
+
+/** Look up the entry for a file.
+ The entry is only returned if the file's size and modification time still match. 
+ The index must be locked using pl_AudioFileIndex_Lock() while the entry is used.
+ @param entry The entry is returned here, or PLANK_NULL if there is no valid entry. */
+PlankResult pl_AudioFileIndex_Find (PlankAudioFileIndexRef p, const char* filepath, const PlankAudioFileIndexEntry** entry);
+
+/** The cue points stored for an entry, there are entry->numCuePoints of these. */
+const PlankAudioFileIndexCuePoint* pl_AudioFileIndex_GetCuePoints (PlankAudioFileIndexRef p, const PlankAudioFileIndexEntry* entry);
+
+/** The channel identifiers stored for an entry, there are entry->numChannels of these. */
+const PlankChannelIdentifier* pl_AudioFileIndex_GetChannelIdentifiers (PlankAudioFileIndexRef p, const PlankAudioFileIndexEntry* entry);
+
+/** A string from the index, e.g., an entry's path or a cue point's label. */
+const char* pl_AudioFileIndex_GetString (PlankAudioFileIndexRef p, const PlankUI offset);
+
+/** Lock the index for use by the current thread.
+ All the functions here lock the index themselves except pl_AudioFileIndex_Find() 
+ and the accessors for an entry's data. */
+void pl_AudioFileIndex_Lock (PlankAudioFileIndexRef p);
+
+/** Unlock the index. */
+void pl_AudioFileIndex_Unlock (PlankAudioFileIndexRef p);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankAudioFileIndex
+{
+    PlankLock lock;
+    PlankDynamicArray entries;
+    PlankDynamicArray cuePoints;
+    PlankDynamicArray channelIdentifiers;
+    PlankDynamicArray strings;
+    PlankB isSorted;
+} PlankAudioFileIndex;
+#endif
+
+#endif // PLANK_AUDIOFILEINDEX_H
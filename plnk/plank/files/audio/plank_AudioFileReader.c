@@ -46,6 +46,8 @@
 #include "plank_AudioFileMetaData.h"
 #include "plank_AudioFileCuePoint.h"
 #include "plank_AudioFileRegion.h"
+#include "plank_AudioFileIndex.h"
+#include "plank_FLAC.h"
 
 
 // private structures
@@ -106,6 +108,12 @@ PlankResult pl_AudioFileReader_Opus_SetFramePosition (PlankAudioFileReaderRef p,
 PlankResult pl_AudioFileReader_Opus_GetFramePosition (PlankAudioFileReaderRef p, PlankLL *frameIndex);
 PlankResult pl_AudioFileReader_Opus_ParseMetaData (PlankAudioFileReaderRef p);
 
+PlankResult pl_AudioFileReader_FLAC_OpenWithFile (PlankAudioFileReaderRef p, PlankFileRef file);
+PlankResult pl_AudioFileReader_FLAC_Close (PlankAudioFileReaderRef p);
+PlankResult pl_AudioFileReader_FLAC_ReadFrames (PlankAudioFileReaderRef p, const PlankB convertByteOrder, const int numFrames, void* data, int *framesRead);
+PlankResult pl_AudioFileReader_FLAC_SetFramePosition (PlankAudioFileReaderRef p, const PlankLL frameIndex);
+PlankResult pl_AudioFileReader_FLAC_GetFramePosition (PlankAudioFileReaderRef p, PlankLL *frameIndex);
+
 PlankResult pl_AudioFileReader_Multi_Open (PlankAudioFileReaderRef p, PlankFileRef file);
 PlankResult pl_AudioFileReader_Multi_Close (PlankAudioFileReaderRef p);
 PlankResult pl_AudioFileReader_Multi_ReadFrames (PlankAudioFileReaderRef p, const PlankB convertByteOrder, const int numFrames, void* data, int *framesRead);
@@ -357,6 +365,7 @@ PlankResult pl_AudioFileReader_OpenInternalInternal (PlankAudioFileReaderRef p,
     PlankIffAudioFileReaderRef iff;
     int fileStreamType;
     PlankPath path;
+    PlankFile flacFile;
         
     result = PlankResult_OK;
     iff = PLANK_NULL;
@@ -465,6 +474,28 @@ PlankResult pl_AudioFileReader_OpenInternalInternal (PlankAudioFileReaderRef p,
             }
 #endif
         }
+        else if (mainID.fcc == pl_FourCharCode ("fLaC"))
+        {
+            // take the open file back from the Iff reader then close that
+            pl_IffFileReader_EndHeaderCache ((PlankIffFileReaderRef)iff);
+            pl_MemoryCopy (&flacFile, (PlankFileRef)iff, sizeof (PlankFile));
+            pl_MemoryZero ((PlankFileRef)iff, sizeof (PlankFile));
+            
+            p->peer = PLANK_NULL;
+            p->format = p->formatInfo.format = PLANKAUDIOFILE_FORMAT_INVALID;
+
+            if ((result = pl_IffAudioFileReader_Destroy (iff)) == PlankResult_OK)
+                result = pl_AudioFileReader_FLAC_OpenWithFile (p, &flacFile);
+            
+            if (result != PlankResult_OK)
+            {
+                pl_AudioFileReader_FLAC_Close (p);
+                pl_File_DeInit (&flacFile);
+
+                p->peer = PLANK_NULL;
+                p->format = p->formatInfo.format = PLANKAUDIOFILE_FORMAT_INVALID;
+            }
+        }
     }
     else if (iff->iff.common.headerInfo.idType == PLANKIFFFILE_ID_GUID)
     {
@@ -497,6 +528,138 @@ PlankResult pl_AudioFileReader_OpenWithFile (PlankAudioFileReaderRef p, PlankFil
     return pl_AudioFileReader_OpenInternalInternal (p, 0, file, metaDataIOFlags);
 }
 
+// the index must be locked
+static PlankResult pl_AudioFileReader_OpenWithIndexEntry (PlankAudioFileReaderRef p, 
+                                                          const char* filepath,
+                                                          PlankAudioFileIndexRef index,
+                                                          const PlankAudioFileIndexEntry* entry,
+                                                          const PlankAudioFileMetaDataIOFlags metaDataIOFlags)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffAudioFileReaderRef iff;
+    PlankAudioFileCuePointRef cuePoint;
+    const PlankAudioFileIndexCuePoint* indexCuePoints;
+    const PlankChannelIdentifier* channelIdentifiers;
+    PlankPath path;
+    PlankUI i;
+    
+    if ((result = pl_AudioFileReader_DeInit (p)) != PlankResult_OK) goto exit;
+    if ((result = pl_AudioFileReader_Init (p)) != PlankResult_OK) goto exit;
+    
+    if ((iff = pl_IffAudioFileReader_CreateAndInit()) == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    p->peer = iff;
+    p->format = p->formatInfo.format = entry->format;
+    
+    if ((result = pl_Path_InitPath (&path, filepath)) != PlankResult_OK) goto exit;
+    if ((result = pl_AudioFileReader_SetName (p, pl_Path_GetLastPath (&path))) != PlankResult_OK) goto exit;
+    
+    // no need to parse anything so just open the file
+    if ((result = pl_File_OpenBinaryRead ((PlankFileRef)iff,
+                                          filepath,
+                                          PLANK_FALSE,
+                                          (entry->encoding & PLANKAUDIOFILE_ENCODING_BIGENDIAN_FLAG) ? PLANK_TRUE : PLANK_FALSE)) != PlankResult_OK) goto exit;
+    
+    p->formatInfo.encoding      = entry->encoding;
+    p->formatInfo.bitsPerSample = entry->bitsPerSample;
+    p->formatInfo.bytesPerFrame = entry->bytesPerFrame;
+    p->formatInfo.sampleRate    = entry->sampleRate;
+    p->numFrames                = entry->numFrames;
+    p->dataPosition             = entry->dataPosition;
+    
+    if ((result = pl_AudioFileFormatInfo_SetNumChannels (&p->formatInfo, (int)entry->numChannels, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    
+    channelIdentifiers = pl_AudioFileIndex_GetChannelIdentifiers (index, entry);
+    
+    for (i = 0; i < entry->numChannels; ++i)
+    {
+        if ((result = pl_AudioFileFormatInfo_SetChannelItentifier (&p->formatInfo, (int)i, channelIdentifiers[i])) != PlankResult_OK) goto exit;
+    }
+    
+    p->formatInfo.channelLayout = entry->channelLayout;
+    p->metaDataIOFlags = metaDataIOFlags;
+    
+    if (metaDataIOFlags != PLANKAUDIOFILEMETADATA_IOFLAGS_NONE)
+    {
+        if ((result = pl_AudioFileMetaData_CreateSharedPtr (&p->metaData)) != PlankResult_OK) goto exit;
+        
+        indexCuePoints = pl_AudioFileIndex_GetCuePoints (index, entry);
+        
+        for (i = 0; i < entry->numCuePoints; ++i)
+        {
+            if ((result = pl_AudioFileCuePoint_CreateSharedPtr (&cuePoint)) != PlankResult_OK) goto exit;
+            
+            pl_AudioFileCuePoint_SetID (cuePoint, indexCuePoints[i].cueID);
+            pl_AudioFileCuePoint_SetPosition (cuePoint, indexCuePoints[i].position);
+            pl_AudioFileCuePoint_SetType (cuePoint, indexCuePoints[i].type);
+            
+            if (indexCuePoints[i].labelOffset != 0)
+                pl_AudioFileCuePoint_SetLabel (cuePoint, pl_AudioFileIndex_GetString (index, indexCuePoints[i].labelOffset));
+            
+            if ((result = pl_AudioFileMetaData_AddCuePoint (p->metaData, cuePoint)) != PlankResult_OK) goto exit;
+            pl_AudioFileCuePoint_DecrementRefCount (cuePoint);
+        }
+    }
+    
+    p->readFramesFunction       = (PlankM)pl_AudioFileReader_Iff_ReadFrames;
+    p->setFramePositionFunction = (PlankM)pl_AudioFileReader_Iff_SetFramePosition;
+    p->getFramePositionFunction = (PlankM)pl_AudioFileReader_Iff_GetFramePosition;
+    
+    result = pl_AudioFileReader_ResetFramePosition (p);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileReader_OpenWithIndex (PlankAudioFileReaderRef p, const char* filepath, PlankAudioFileIndexRef index, const PlankAudioFileMetaDataIOFlags metaDataIOFlags)
+{
+    PlankResult result = PlankResult_OK;
+    const PlankAudioFileIndexEntry* entry;
+    
+    entry = PLANK_NULL;
+    
+    if (index == PLANK_NULL)
+        return pl_AudioFileReader_OpenInternal (p, filepath, metaDataIOFlags);
+    
+    // the index only holds cue points so anything else needs a full parse
+    if ((metaDataIOFlags & ~PLANKAUDIOFILEMETADATA_IOFLAGS_CUEPOINTS) == 0)
+    {
+        pl_AudioFileIndex_Lock (index);
+        
+        result = pl_AudioFileIndex_Find (index, filepath, &entry);
+        
+        if ((entry != PLANK_NULL) &&
+            (!(metaDataIOFlags & PLANKAUDIOFILEMETADATA_IOFLAGS_CUEPOINTS) || (entry->flags & PLANKAUDIOFILEINDEX_FLAGS_CUEPOINTS)))
+        {
+            result = pl_AudioFileReader_OpenWithIndexEntry (p, filepath, index, entry, metaDataIOFlags);
+        }
+        else
+        {
+            entry = PLANK_NULL;
+        }
+        
+        pl_AudioFileIndex_Unlock (index);
+        
+        if ((result != PlankResult_OK) || (entry != PLANK_NULL))
+            goto exit;
+    }
+    
+    if ((result = pl_AudioFileReader_OpenInternal (p, filepath, metaDataIOFlags)) != PlankResult_OK) goto exit;
+    
+    result = pl_AudioFileIndex_AddReader (index, filepath, p);
+    
+    // not all formats can be indexed but they're still open
+    if (result == PlankResult_AudioFileUnsupportedType)
+        result = PlankResult_OK;
+    
+exit:
+    return result;
+}
+
 PlankResult pl_AudioFileReader_OpenWithAudioFileArray (PlankAudioFileReaderRef p, PlankDynamicArrayRef array, PlankB ownArray, const int multiMode, int* indexRef)
 {
     return pl_AudioFileReader_Array_Open (p, array, ownArray, multiMode, indexRef);
@@ -673,6 +836,7 @@ PlankResult pl_AudioFileReader_Close (PlankAudioFileReaderRef p)
         case PLANKAUDIOFILE_FORMAT_AIFF:
         case PLANKAUDIOFILE_FORMAT_AIFC:
         case PLANKAUDIOFILE_FORMAT_CAF:
+        case PLANKAUDIOFILE_FORMAT_W64:
         case PLANKAUDIOFILE_FORMAT_UNKNOWNIFF:
             result = pl_IffAudioFileReader_Destroy ((PlankIffAudioFileReaderRef)p->peer);
             p->peer = PLANK_NULL;
@@ -687,6 +851,9 @@ PlankResult pl_AudioFileReader_Close (PlankAudioFileReaderRef p)
             result = pl_AudioFileReader_Opus_Close (p);
             break;
 #endif
+        case PLANKAUDIOFILE_FORMAT_FLAC:
+            result = pl_AudioFileReader_FLAC_Close (p);
+            break;
         case PLANKAUDIOFILE_FORMAT_MULTI:
             result = pl_AudioFileReader_Multi_Close (p);
             break;
@@ -2269,6 +2436,9 @@ PlankResult pl_AudioFileReader_Iff_Open (PlankAudioFileReaderRef p)
     p->readFramesFunction       = (PlankM)pl_AudioFileReader_Iff_ReadFrames;
     p->setFramePositionFunction = (PlankM)pl_AudioFileReader_Iff_SetFramePosition;
     p->getFramePositionFunction = (PlankM)pl_AudioFileReader_Iff_GetFramePosition;
+    
+    // the header is parsed so audio data can be read directly from the file
+    if ((result = pl_IffFileReader_EndHeaderCache (iff)) != PlankResult_OK) goto exit;
 
     if ((result = pl_AudioFileReader_ResetFramePosition (p)) != PlankResult_OK) goto exit;     
     
@@ -2567,6 +2737,10 @@ exit:
     return result;
 }
 
+#endif // PLANK_OGGVORBIS || PLANK_OPUS
+
+// Vorbis comments are also used for FLAC metadata
+
 static const char* pl_OggTagCompare (const char *source, const char *tag)
 {
     int n, c = 0;
@@ -2704,14 +2878,9 @@ static PlankResult pl_AudioFileReader_OggFile_ParseComment (PlankAudioFileReader
         }
     }
     
-    
-exit:
     return result;
 }
 
-
-#endif
-
 // -- Ogg Vorbis Functions -- //////////////////////////////////////////////////
 
 #if PLANK_OGGVORBIS
@@ -3737,6 +3906,633 @@ PlankLL pl_OpusFileReader_TellCallback (PlankP datasource)
 
 #endif // PLANK_OPUS
 
+// -- FLAC Functions -- ////////////////////////////////////////////////////////
+
+#if PLANK_APPLE
+#pragma mark FLAC Functions
+#endif
+
+#define PLANKFLACREADER_MININPUTSIZE 65536
+
+typedef struct PlankFLACFileReader
+{
+    PlankFile file;
+    PlankFLACStreamInfo streamInfo;
+    PlankDynamicArray seekTable;
+    PlankDynamicArray input;
+    PlankDynamicArray samples;
+    PlankI* channels[PLANKFLAC_MAXCHANNELS];
+    PlankLL firstFramePosition;
+    PlankLL fileLength;
+    PlankLL inputPosition;
+    int inputStart;
+    int inputEnd;
+    int frameBound;
+    PlankB inputEOF;
+    PlankLL bufferFirstFrame;
+    int bufferFrames;
+    int bufferPosition;
+} PlankFLACFileReader;
+
+typedef PlankFLACFileReader* PlankFLACFileReaderRef;
+
+static PLANK_INLINE_LOW PlankUI pl_FLAC_ReadLE32 (const PlankUC* data)
+{
+    return ((PlankUI)data[0]) | ((PlankUI)data[1] << 8) | ((PlankUI)data[2] << 16) | ((PlankUI)data[3] << 24);
+}
+
+static PlankResult pl_AudioFileReader_FLAC_ReadBlock (PlankFLACFileReaderRef flac, PlankP data, const int length)
+{
+    PlankResult result;
+    int bytesRead;
+    
+    bytesRead = 0;
+    result = pl_File_Read ((PlankFileRef)flac, data, length, &bytesRead);
+    
+    if ((result == PlankResult_FileEOF) || (bytesRead != length))
+        result = PlankResult_AudioFileInavlidType;
+
+    return result;
+}
+
+static PlankResult pl_AudioFileReader_FLAC_ResetInput (PlankFLACFileReaderRef flac, const PlankLL position)
+{
+    PlankResult result;
+    
+    if ((result = pl_File_SetPosition ((PlankFileRef)flac, position)) != PlankResult_OK) goto exit;
+    
+    flac->inputPosition = position;
+    flac->inputStart    = 0;
+    flac->inputEnd      = 0;
+    flac->inputEOF      = PLANK_FALSE;
+    
+exit:
+    return result;
+}
+
+// keeps at least one whole frame in the input buffer unless we're near the end of the file
+static PlankResult pl_AudioFileReader_FLAC_FillInput (PlankFLACFileReaderRef flac)
+{
+    PlankResult result = PlankResult_OK;
+    PlankUC* input;
+    int capacity, remaining, bytesRead;
+    
+    if (flac->inputEOF || ((flac->inputEnd - flac->inputStart) >= flac->frameBound))
+        goto exit;
+    
+    input     = (PlankUC*)pl_DynamicArray_GetArray (&flac->input);
+    capacity  = (int)pl_DynamicArray_GetSize (&flac->input);
+    remaining = flac->inputEnd - flac->inputStart;
+    
+    if (flac->inputStart > 0)
+    {
+        memmove (input, input + flac->inputStart, remaining);
+        flac->inputPosition += flac->inputStart;
+        flac->inputStart = 0;
+        flac->inputEnd = remaining;
+    }
+    
+    bytesRead = 0;
+    result = pl_File_Read ((PlankFileRef)flac, input + flac->inputEnd, capacity - flac->inputEnd, &bytesRead);
+    flac->inputEnd += pl_MaxI (bytesRead, 0);
+
+    if (result == PlankResult_FileEOF)
+    {
+        flac->inputEOF = PLANK_TRUE;
+        result = PlankResult_OK;
+    }
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_AudioFileReader_FLAC_DecodeNextFrame (PlankFLACFileReaderRef flac)
+{
+    PlankResult result;
+    PlankFLACFrameHeader header;
+    PlankUC* input;
+    int available, frameLength, offset;
+    
+    for (;;)
+    {
+        if ((result = pl_AudioFileReader_FLAC_FillInput (flac)) != PlankResult_OK) goto exit;
+
+        input     = (PlankUC*)pl_DynamicArray_GetArray (&flac->input) + flac->inputStart;
+        available = flac->inputEnd - flac->inputStart;
+        
+        if (available <= 0)
+        {
+            result = PlankResult_FileEOF;
+            goto exit;
+        }
+
+        result = pl_FLAC_DecodeFrame (&flac->streamInfo, input, available, flac->channels, &header, &frameLength);
+        
+        if (result == PlankResult_OK)
+        {
+            flac->inputStart      += frameLength;
+            flac->bufferFirstFrame = header.firstSample;
+            flac->bufferFrames     = header.blockSize;
+            flac->bufferPosition   = 0;
+            goto exit;
+        }
+        
+        if ((result == PlankResult_FileEOF) && flac->inputEOF)
+        {
+            // truncated final frame
+            flac->inputStart = flac->inputEnd;
+            goto exit;
+        }
+        
+        // lost sync, skip to the next plausible frame
+        offset = pl_FLAC_FindFrame (&flac->streamInfo, input + 1, available - 1, &header);
+        flac->inputStart += (offset < 0) ? pl_MaxI (available - 1, 1) : offset + 1;
+    }
+    
+exit:
+    return result;
+}
+
+// finds the length from the last frame if the STREAMINFO didn't contain it
+static PlankResult pl_AudioFileReader_FLAC_ScanLength (PlankFLACFileReaderRef flac, PlankLL* numFrames)
+{
+    PlankResult result;
+    PlankFLACFrameHeader header;
+    PlankUC* input;
+    PlankLL start;
+    int offset, position;
+    
+    *numFrames = 0;
+    start = pl_MaxLL (flac->firstFramePosition, flac->fileLength - (PlankLL)flac->frameBound * 2);
+    
+    while (*numFrames == 0)
+    {
+        if ((result = pl_AudioFileReader_FLAC_ResetInput (flac, start)) != PlankResult_OK) goto exit;
+        if ((result = pl_AudioFileReader_FLAC_FillInput (flac)) != PlankResult_OK) goto exit;
+        
+        input = (PlankUC*)pl_DynamicArray_GetArray (&flac->input);
+        position = 0;
+        
+        while ((offset = pl_FLAC_FindFrame (&flac->streamInfo, input + position, flac->inputEnd - position, &header)) >= 0)
+        {
+            *numFrames = header.firstSample + header.blockSize;
+            position += offset + 1;
+        }
+        
+        if (start == flac->firstFramePosition)
+            break;
+        
+        start = pl_MaxLL (flac->firstFramePosition, start - (PlankLL)flac->frameBound * 2);
+    }
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_AudioFileReader_FLAC_ParseVorbisComment (PlankAudioFileReaderRef p, const PlankUC* data, const int length)
+{
+    PlankResult result = PlankResult_OK;
+    PlankDynamicArray text;
+    char* string;
+    int position, numComments, commentLength, i;
+    
+    pl_DynamicArray_InitWithItemSize (&text, 1);
+    
+    if (length < 8)
+        goto exit;
+    
+    position = 0;
+    commentLength = (int)pl_FLAC_ReadLE32 (data);
+    position += 4;
+    
+    for (i = -1, numComments = 0; i < numComments; ++i)
+    {
+        if ((commentLength < 0) || (commentLength > (length - position)))
+            goto exit;
+        
+        if ((result = pl_DynamicArray_SetSize (&text, commentLength + 1)) != PlankResult_OK) goto exit;
+        
+        string = (char*)pl_DynamicArray_GetArray (&text);
+        pl_MemoryCopy (string, data + position, commentLength);
+        string[commentLength] = '\0';
+        position += commentLength;
+        
+        if (i < 0)
+        {
+            // the vendor string is followed by the number of comments
+            if ((p->metaDataIOFlags & PLANKAUDIOFILEMETADATA_IOFLAGS_TEXT) && (commentLength > 0))
+                pl_AudioFileMetaData_SetVendor (p->metaData, string);
+            
+            if ((length - position) < 4)
+                goto exit;
+            
+            numComments = (int)pl_FLAC_ReadLE32 (data + position);
+            position += 4;
+        }
+        else
+        {
+            if ((result = pl_AudioFileReader_OggFile_ParseComment (p, string)) != PlankResult_OK) goto exit;
+        }
+        
+        if ((i + 1) < numComments)
+        {
+            if ((length - position) < 4)
+                goto exit;
+            
+            commentLength = (int)pl_FLAC_ReadLE32 (data + position);
+            position += 4;
+        }
+    }
+    
+exit:
+    pl_DynamicArray_DeInit (&text);
+    return result;
+}
+
+static PlankResult pl_AudioFileReader_FLAC_ParseHeader (PlankAudioFileReaderRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACFileReaderRef flac;
+    PlankFLACSeekPoint seekPoint;
+    PlankDynamicArray block;
+    PlankUC header[PLANKFLAC_METADATAHEADER_LENGTH];
+    PlankUC* data;
+    PlankLL position;
+    PlankB isLast, hasStreamInfo;
+    int type, length, i;
+    
+    flac = (PlankFLACFileReaderRef)p->peer;
+    hasStreamInfo = PLANK_FALSE;
+    isLast = PLANK_FALSE;
+    
+    pl_DynamicArray_InitWithItemSize (&block, 1);
+    
+    if ((result = pl_File_SetPosition ((PlankFileRef)flac, PLANKFLAC_MAGIC_LENGTH)) != PlankResult_OK) goto exit;
+    
+    while (!isLast)
+    {
+        if ((result = pl_AudioFileReader_FLAC_ReadBlock (flac, header, PLANKFLAC_METADATAHEADER_LENGTH)) != PlankResult_OK) goto exit;
+        if ((result = pl_File_GetPosition ((PlankFileRef)flac, &position)) != PlankResult_OK) goto exit;
+
+        isLast = (header[0] & PLANKFLAC_METADATA_LASTFLAG) ? PLANK_TRUE : PLANK_FALSE;
+        type   = header[0] & ~PLANKFLAC_METADATA_LASTFLAG;
+        length = ((int)header[1] << 16) | ((int)header[2] << 8) | (int)header[3];
+        
+        if ((length > 0) &&
+            ((type == PLANKFLAC_METADATA_STREAMINFO) ||
+             (type == PLANKFLAC_METADATA_SEEKTABLE) ||
+             ((type == PLANKFLAC_METADATA_VORBISCOMMENT) && p->metaData)))
+        {
+            if ((result = pl_DynamicArray_SetSize (&block, length)) != PlankResult_OK) goto exit;
+            
+            data = (PlankUC*)pl_DynamicArray_GetArray (&block);
+            
+            if ((result = pl_AudioFileReader_FLAC_ReadBlock (flac, data, length)) != PlankResult_OK) goto exit;
+            
+            if (type == PLANKFLAC_METADATA_STREAMINFO)
+            {
+                if ((result = pl_FLAC_ParseStreamInfo (&flac->streamInfo, data, length)) != PlankResult_OK) goto exit;
+                hasStreamInfo = PLANK_TRUE;
+            }
+            else if (type == PLANKFLAC_METADATA_SEEKTABLE)
+            {
+                for (i = 0; i < (length / PLANKFLAC_SEEKPOINT_LENGTH); ++i)
+                {
+                    pl_FLAC_ParseSeekPoint (&seekPoint, data + i * PLANKFLAC_SEEKPOINT_LENGTH);
+                    
+                    if (seekPoint.sampleNumber != PLANKFLAC_SEEKPOINT_PLACEHOLDER)
+                    {
+                        if ((result = pl_DynamicArray_AddItem (&flac->seekTable, &seekPoint)) != PlankResult_OK) goto exit;
+                    }
+                }
+            }
+            else
+            {
+                if ((result = pl_AudioFileReader_FLAC_ParseVorbisComment (p, data, length)) != PlankResult_OK) goto exit;
+            }
+        }
+        
+        if ((result = pl_File_SetPosition ((PlankFileRef)flac, position + length)) != PlankResult_OK) goto exit;
+    }
+    
+    if (!hasStreamInfo)
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+
+    flac->firstFramePosition = position + length;
+    
+exit:
+    pl_DynamicArray_DeInit (&block);
+    return result;
+}
+
+PlankResult pl_AudioFileReader_FLAC_OpenWithFile (PlankAudioFileReaderRef p, PlankFileRef file)
+{
+    PlankResult result;
+    PlankFLACFileReaderRef flac;
+    PlankMemoryRef m;
+    PlankFLACStreamInfo* info;
+    PlankFourCharCode magic;
+    PlankLL numFrames;
+    PlankI bytesPerSample;
+    int mode, i;
+    
+    m = pl_MemoryGlobal();
+    
+    flac = (PlankFLACFileReaderRef)pl_Memory_AllocateBytes (m, sizeof (PlankFLACFileReader));
+    
+    if (flac == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (flac, sizeof (PlankFLACFileReader));
+    
+    p->peer = flac;
+    p->format = p->formatInfo.format = PLANKAUDIOFILE_FORMAT_FLAC;
+    
+    pl_DynamicArray_InitWithItemSize (&flac->seekTable, sizeof (PlankFLACSeekPoint));
+    pl_DynamicArray_InitWithItemSize (&flac->input, 1);
+    pl_DynamicArray_InitWithItemSize (&flac->samples, sizeof (PlankI));
+
+    if ((result = pl_File_GetMode (file, &mode)) != PlankResult_OK) goto exit;
+    
+    if (!(mode & PLANKFILE_BINARY) || !(mode & PLANKFILE_READ))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+    
+    pl_MemoryCopy (&flac->file, file, sizeof (PlankFile));
+    pl_MemoryZero (file, sizeof (PlankFile));
+    
+    if ((result = pl_File_SetPosition ((PlankFileRef)flac, 0)) != PlankResult_OK) goto exit;
+    if ((result = pl_AudioFileReader_FLAC_ReadBlock (flac, &magic, sizeof (magic))) != PlankResult_OK) goto exit;
+    
+    if (pl_MemoryCompare (&magic, PLANKFLAC_MAGIC, PLANKFLAC_MAGIC_LENGTH) == PLANK_FALSE)
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+    
+    if ((result = pl_AudioFileReader_FLAC_ParseHeader (p)) != PlankResult_OK) goto exit;
+    
+    if ((result = pl_File_SetPositionEnd ((PlankFileRef)flac)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_GetPosition ((PlankFileRef)flac, &flac->fileLength)) != PlankResult_OK) goto exit;
+    
+    info = &flac->streamInfo;
+    flac->frameBound = pl_FLAC_GetFrameSizeBound (info);
+
+    if ((result = pl_DynamicArray_SetSize (&flac->input, pl_MaxI (flac->frameBound * 2, PLANKFLACREADER_MININPUTSIZE))) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&flac->samples, info->maxBlockSize * info->numChannels)) != PlankResult_OK) goto exit;
+    
+    for (i = 0; i < info->numChannels; ++i)
+        flac->channels[i] = (PlankI*)pl_DynamicArray_GetArray (&flac->samples) + i * info->maxBlockSize;
+    
+    numFrames = info->totalSamples;
+    
+    if (numFrames == 0)
+    {
+        if ((result = pl_AudioFileReader_FLAC_ScanLength (flac, &numFrames)) != PlankResult_OK) goto exit;
+    }
+    
+    if ((result = pl_AudioFileReader_FLAC_ResetInput (flac, flac->firstFramePosition)) != PlankResult_OK) goto exit;
+
+    // samples are returned left-justified in the smallest native endian container
+    bytesPerSample = (info->bitsPerSample + 7) / 8;
+    
+    p->formatInfo.encoding      = PLANK_BIGENDIAN ? PLANKAUDIOFILE_ENCODING_PCM_BIGENDIAN : PLANKAUDIOFILE_ENCODING_PCM_LITTLEENDIAN;
+    p->formatInfo.bitsPerSample = PLANKAUDIOFILE_CHARBITS * bytesPerSample;
+
+    pl_AudioFileFormatInfo_SetNumChannels (&p->formatInfo, info->numChannels, PLANK_FALSE);
+    pl_AudioFileFormatInfo_FLAC_SetDefaultLayout (&p->formatInfo);
+    
+    p->formatInfo.sampleRate        = info->sampleRate;
+    p->formatInfo.bytesPerFrame     = info->numChannels * bytesPerSample;
+    p->formatInfo.nominalBitRate    = numFrames > 0 ? (int)((flac->fileLength - flac->firstFramePosition) * 8 * info->sampleRate / numFrames) : 0;
+    p->formatInfo.minimumBitRate    = 0;
+    p->formatInfo.maximumBitRate    = 0;
+    p->formatInfo.frameDuration     = 0.0;
+    p->formatInfo.quality           = 1.f;
+
+    p->numFrames = numFrames;
+    p->readFramesFunction       = (PlankM)pl_AudioFileReader_FLAC_ReadFrames;
+    p->setFramePositionFunction = (PlankM)pl_AudioFileReader_FLAC_SetFramePosition;
+    p->getFramePositionFunction = (PlankM)pl_AudioFileReader_FLAC_GetFramePosition;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileReader_FLAC_Close (PlankAudioFileReaderRef p)
+{
+    PlankFLACFileReaderRef flac;
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m = pl_MemoryGlobal();
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    flac = (PlankFLACFileReaderRef)p->peer;
+    
+    if (flac == PLANK_NULL)
+        goto exit;
+    
+    if ((result = pl_File_DeInit (&flac->file)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&flac->seekTable)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&flac->input)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_DeInit (&flac->samples)) != PlankResult_OK) goto exit;
+    
+    pl_Memory_Free (m, flac);
+    p->peer = PLANK_NULL;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileReader_FLAC_ReadFrames (PlankAudioFileReaderRef p, const PlankB convertByteOrder, const int numFrames, void* data, int *framesReadOut)
+{
+    PlankResult result;
+    PlankFLACFileReaderRef flac;
+    int numFramesRemaining, framesThisTime, framesRead, numChannels, bytesPerSample, bytesPerFrame, shift, i, j;
+    const PlankI* src;
+    PlankUC* dst;
+    PlankUI value;
+    
+    (void)convertByteOrder; // always native
+    
+    result = PlankResult_OK;
+    flac = (PlankFLACFileReaderRef)p->peer;
+    
+    numFramesRemaining = numFrames;
+    numChannels        = flac->streamInfo.numChannels;
+    bytesPerFrame      = p->formatInfo.bytesPerFrame;
+    bytesPerSample     = bytesPerFrame / numChannels;
+    shift              = bytesPerSample * PLANKAUDIOFILE_CHARBITS - flac->streamInfo.bitsPerSample;
+    dst                = (PlankUC*)data;
+    framesRead         = 0;
+    
+    while (numFramesRemaining > 0)
+    {
+        if (flac->bufferPosition >= flac->bufferFrames)
+        {
+            if ((result = pl_AudioFileReader_FLAC_DecodeNextFrame (flac)) != PlankResult_OK) goto exit;
+        }
+        
+        framesThisTime = pl_MinI (flac->bufferFrames - flac->bufferPosition, numFramesRemaining);
+        
+        // interleave to the output...
+        
+        for (i = 0; i < numChannels; ++i)
+        {
+            src = flac->channels[i] + flac->bufferPosition;
+            
+            switch (bytesPerSample)
+            {
+                case 1:
+                    for (j = 0; j < framesThisTime; ++j)
+                        ((signed char*)dst)[j * numChannels + i] = (signed char)(src[j] << shift);
+                    break;
+                case 2:
+                    for (j = 0; j < framesThisTime; ++j)
+                        ((PlankS*)dst)[j * numChannels + i] = (PlankS)(src[j] << shift);
+                    break;
+                case 3:
+                    for (j = 0; j < framesThisTime; ++j)
+                    {
+                        value = (PlankUI)src[j] << shift;
+#if PLANK_BIGENDIAN
+                        dst[(j * numChannels + i) * 3 + 0] = (PlankUC)(value >> 16);
+                        dst[(j * numChannels + i) * 3 + 1] = (PlankUC)(value >> 8);
+                        dst[(j * numChannels + i) * 3 + 2] = (PlankUC)(value);
+#else
+                        dst[(j * numChannels + i) * 3 + 0] = (PlankUC)(value);
+                        dst[(j * numChannels + i) * 3 + 1] = (PlankUC)(value >> 8);
+                        dst[(j * numChannels + i) * 3 + 2] = (PlankUC)(value >> 16);
+#endif
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        
+        flac->bufferPosition += framesThisTime;
+        numFramesRemaining -= framesThisTime;
+        framesRead += framesThisTime;
+        
+        dst += framesThisTime * bytesPerFrame;
+    }
+    
+exit:
+    if (numFramesRemaining > 0)
+        pl_MemoryZero (dst, numFramesRemaining * bytesPerFrame);
+    
+    *framesReadOut = framesRead;
+    
+    return result;
+}
+
+PlankResult pl_AudioFileReader_FLAC_SetFramePosition (PlankAudioFileReaderRef p, const PlankLL frameIndex)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACFileReaderRef flac;
+    PlankFLACFrameHeader header;
+    const PlankFLACSeekPoint* seekPoints;
+    PlankLL offset, lower, upper, middle;
+    int numSeekPoints, found, i;
+    
+    flac = (PlankFLACFileReaderRef)p->peer;
+    
+    if ((frameIndex < 0) || (frameIndex > p->numFrames))
+    {
+        result = PlankResult_FileSeekFailed;
+        goto exit;
+    }
+    
+    // already decoded
+    if ((frameIndex >= flac->bufferFirstFrame) && (frameIndex < (flac->bufferFirstFrame + flac->bufferFrames)))
+    {
+        flac->bufferPosition = (int)(frameIndex - flac->bufferFirstFrame);
+        goto exit;
+    }
+    
+    flac->bufferFrames   = 0;
+    flac->bufferPosition = 0;
+    
+    if (frameIndex == p->numFrames)
+    {
+        flac->bufferFirstFrame = frameIndex;
+        result = pl_AudioFileReader_FLAC_ResetInput (flac, flac->fileLength);
+        goto exit;
+    }
+    
+    // the seek table gets us close, otherwise bisect the file on frame headers
+    offset        = flac->firstFramePosition;
+    seekPoints    = (const PlankFLACSeekPoint*)pl_DynamicArray_GetArray (&flac->seekTable);
+    numSeekPoints = (int)pl_DynamicArray_GetSize (&flac->seekTable);
+
+    if (numSeekPoints > 0)
+    {
+        for (i = 0; (i < numSeekPoints) && (seekPoints[i].sampleNumber <= frameIndex); ++i)
+            offset = flac->firstFramePosition + seekPoints[i].offset;
+    }
+    else
+    {
+        lower = flac->firstFramePosition;
+        upper = flac->fileLength;
+        
+        while ((upper - lower) > flac->frameBound)
+        {
+            middle = lower + (upper - lower) / 2;
+            
+            if ((result = pl_AudioFileReader_FLAC_ResetInput (flac, middle)) != PlankResult_OK) goto exit;
+            if ((result = pl_AudioFileReader_FLAC_FillInput (flac)) != PlankResult_OK) goto exit;
+            
+            found = pl_FLAC_FindFrame (&flac->streamInfo, (const PlankUC*)pl_DynamicArray_GetArray (&flac->input), flac->inputEnd, &header);
+            
+            if ((found < 0) || ((middle + found) >= upper) || (header.firstSample > frameIndex))
+                upper = middle;
+            else
+                lower = middle + found;
+        }
+        
+        offset = lower;
+    }
+    
+    if ((result = pl_AudioFileReader_FLAC_ResetInput (flac, offset)) != PlankResult_OK) goto exit;
+    
+    do
+    {
+        if ((result = pl_AudioFileReader_FLAC_DecodeNextFrame (flac)) != PlankResult_OK)
+        {
+            flac->bufferFrames = 0;
+            goto exit;
+        }
+    } while (frameIndex >= (flac->bufferFirstFrame + flac->bufferFrames));
+    
+    flac->bufferPosition = (int)(frameIndex - flac->bufferFirstFrame);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileReader_FLAC_GetFramePosition (PlankAudioFileReaderRef p, PlankLL *frameIndex)
+{
+    PlankFLACFileReaderRef flac;
+    
+    flac = (PlankFLACFileReaderRef)p->peer;
+    *frameIndex = flac->bufferFirstFrame + flac->bufferPosition;
+    
+    return PlankResult_OK;
+}
+
 // -- MultiFile Functions -- //////////////////////////////////////////////////
 
 #if PLANK_APPLE
@@ -53,6 +53,8 @@ PLANK_BEGIN_C_LINKAGE
 /** An opaque reference to the <i>Plank AudioFileReader</i> object. */
 typedef struct PlankAudioFileReader* PlankAudioFileReaderRef; 
 
+typedef struct PlankAudioFileIndex* PlankAudioFileIndexRef; // would prefer to move this declaration
+
 /** Create and initialise a <i>Plank AudioFileReader</i> object and return an oqaque reference to it.
  @return A <i>Plank AudioFileReader</i> object as an opaque reference or PLANK_NULL. */
 PlankAudioFileReaderRef pl_AudioFileReader_CreateAndInit();
@@ -95,6 +97,13 @@ PlankResult pl_AudioFileReader_OpenInternal (PlankAudioFileReaderRef p, const ch
  The AudioFileReader takes ownership of the file and zeros the incomming file object. */
 PlankResult pl_AudioFileReader_OpenWithFile (PlankAudioFileReaderRef p, PlankFileRef file, const PlankAudioFileMetaDataIOFlags metaDataIOFlags);
 
+/** Open a file using an index of previously parsed headers.
+ If the index holds a valid entry for the file it is opened without parsing its header. 
+ Otherwise the file is opened normally and added to the index. Entries can only supply 
+ cue points so requesting any other metadata always parses the file. 
+ @see PlankAudioFileIndexClass */
+PlankResult pl_AudioFileReader_OpenWithIndex (PlankAudioFileReaderRef p, const char* filepath, PlankAudioFileIndexRef index, const PlankAudioFileMetaDataIOFlags metaDataIOFlags);
+
 PlankResult pl_AudioFileReader_OpenWithAudioFileArray (PlankAudioFileReaderRef p, PlankDynamicArrayRef array, PlankB ownArray, const int multiMode, int* indexRef);
 
 typedef PlankResult (*PlankAudioFileReaderCustomNextFunction)(PlankP, PlankAudioFileReaderRef, PlankAudioFileReaderRef*);
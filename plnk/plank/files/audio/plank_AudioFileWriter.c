@@ -43,6 +43,7 @@
 #include "../../random/plank_RNG.h"
 #include "plank_AudioFileWriter.h"
 #include "plank_AudioFileMetaData.h"
+#include "plank_FLAC.h"
 #include "plank_AudioFileCuePoint.h"
 #include "plank_AudioFileRegion.h"
 
@@ -92,6 +93,11 @@ PlankResult pl_AudioFileWriter_Opus_OpenWithFile (PlankAudioFileWriterRef p, Pla
 PlankResult pl_AudioFileWriter_Opus_Close (PlankAudioFileWriterRef p);
 PlankResult pl_AudioFileWriter_Opus_WriteFrames (PlankAudioFileWriterRef p, const PlankB convertByteOrder, const int numFrames, const void* data);
 
+PlankResult pl_AudioFileWriter_FLAC_Open (PlankAudioFileWriterRef p, const char* filepath);
+PlankResult pl_AudioFileWriter_FLAC_OpenWithFile (PlankAudioFileWriterRef p, PlankFileRef file);
+PlankResult pl_AudioFileWriter_FLAC_Close (PlankAudioFileWriterRef p);
+PlankResult pl_AudioFileWriter_FLAC_WriteFrames (PlankAudioFileWriterRef p, const PlankB convertByteOrder, const int numFrames, const void* data);
+
 PlankResult pl_AudioFileWriter_WAV_WriteMetaData (PlankAudioFileWriterRef p);
 PlankResult pl_AudioFileWriter_AIFFAIFC_WriteMetaData (PlankAudioFileWriterRef p);
 PlankResult pl_AudioFileWriter_CAF_WritePreDataMetaData (PlankAudioFileWriterRef p);
@@ -99,6 +105,7 @@ PlankResult pl_AudioFileWriter_CAF_WritePostDataMetaData (PlankAudioFileWriterRe
 PlankResult pl_AudioFileWriter_W64_WriteMetaData (PlankAudioFileWriterRef p);
 PlankResult pl_AudioFileWriter_OggVorbis_WriteMetaData (PlankAudioFileWriterRef p);
 PlankResult pl_AudioFileWriter_Opus_WriteMetaData (PlankAudioFileWriterRef p);
+PlankResult pl_AudioFileWriter_FLAC_WriteMetaData (PlankAudioFileWriterRef p);
 
 typedef struct PlankIffAudioFileWriter* PlankIffAudioFileWriterRef;
 typedef struct PlankIffAudioFileWriter
@@ -660,6 +667,44 @@ PlankResult pl_AudioFileWriter_SetFormatOpusManaged (PlankAudioFileWriterRef p,
     return PlankResult_OK;
 }
 
+PlankResult pl_AudioFileWriter_SetFormatFLAC (PlankAudioFileWriterRef p, const int bitsPerSample, const PlankChannelLayout channelLayout, const double sampleRate)
+{
+    PlankUI numChannels;
+
+    if (p->peer)
+        return PlankResult_UnknownError;
+    
+    if ((bitsPerSample != 8) && (bitsPerSample != 16) && (bitsPerSample != 24))
+        return PlankResult_AudioFileInavlidType;
+    
+    numChannels = channelLayout & 0x0000FFFF;
+    
+    if ((numChannels < 1) || (numChannels > PLANKFLAC_MAXCHANNELS))
+        return PlankResult_AudioFileInavlidType;
+    
+    p->formatInfo.format            = PLANKAUDIOFILE_FORMAT_FLAC;
+    p->formatInfo.encoding          = PLANK_BIGENDIAN ? PLANKAUDIOFILE_ENCODING_PCM_BIGENDIAN : PLANKAUDIOFILE_ENCODING_PCM_LITTLEENDIAN;
+    p->formatInfo.bitsPerSample     = bitsPerSample;
+    
+    pl_AudioFileFormatInfo_SetNumChannels (&p->formatInfo, numChannels, PLANK_FALSE);
+    
+    if (channelLayout < PLANKAUDIOFILE_LAYOUT_STANARDMINIMUM)
+        pl_AudioFileFormatInfo_FLAC_SetDefaultLayout (&p->formatInfo);
+    else
+        pl_AudioFileWriter_SetChanneLayout (p, channelLayout);
+    
+    p->formatInfo.sampleRate        = sampleRate;
+    p->formatInfo.bytesPerFrame     = (PlankI) (bitsPerSample * numChannels / 8);
+    p->formatInfo.nominalBitRate    = 0;
+    p->formatInfo.minimumBitRate    = 0;
+    p->formatInfo.maximumBitRate    = 0;
+    p->formatInfo.frameDuration     = 1.0 / p->formatInfo.sampleRate;
+    p->formatInfo.quality           = 1.f;
+    p->dataOffset                   = 0;
+    
+    return PlankResult_OK;
+}
+
 PlankResult pl_AudioFileWriter_Open (PlankAudioFileWriterRef p, const char* filepath)
 {
     PlankResult result = PlankResult_OK;
@@ -684,6 +729,10 @@ PlankResult pl_AudioFileWriter_Open (PlankAudioFileWriterRef p, const char* file
     {
         result = pl_AudioFileWriter_W64_Open (p, filepath);
     }
+    else if (p->formatInfo.format == PLANKAUDIOFILE_FORMAT_FLAC)
+    {
+        result = pl_AudioFileWriter_FLAC_Open (p, filepath);
+    }
 #if PLANK_OGGVORBIS
     else if (p->formatInfo.format == PLANKAUDIOFILE_FORMAT_OGGVORBIS)
     {
@@ -729,6 +778,10 @@ PlankResult pl_AudioFileWriter_OpenWithFile (PlankAudioFileWriterRef p, PlankFil
     {
         result = pl_AudioFileWriter_W64_OpenWithFile (p, file);
     }
+    else if (p->formatInfo.format == PLANKAUDIOFILE_FORMAT_FLAC)
+    {
+        result = pl_AudioFileWriter_FLAC_OpenWithFile (p, file);
+    }
 #if PLANK_OGGVORBIS
     else if (p->formatInfo.format == PLANKAUDIOFILE_FORMAT_OGGVORBIS)
     {
@@ -787,6 +840,9 @@ PlankResult pl_AudioFileWriter_Close (PlankAudioFileWriterRef p)
             result = pl_AudioFileWriter_Opus_Close (p);
             break;
 #endif
+        case PLANKAUDIOFILE_FORMAT_FLAC:
+            result = pl_AudioFileWriter_FLAC_Close (p);
+            break;
         default:
             if (p->peer != PLANK_NULL)
                 result = PlankResult_UnknownError;
@@ -2102,10 +2158,12 @@ exit:
     return result;
 }
 
-PlankResult pl_AudioFileWriter_Ogg_CommentAddTag (PlankAudioFileWriterRef p, const char* key, const char* string);
-
 #endif
 
+// Vorbis comments are also used for FLAC metadata
+static PlankResult pl_AudioFileWriter_Ogg_WriteMetaData (PlankAudioFileWriterRef p);
+PlankResult pl_AudioFileWriter_Ogg_CommentAddTag (PlankAudioFileWriterRef p, const char* key, const char* string);
+
 #if PLANK_OGGVORBIS
 
 #include "../../containers/plank_DynamicArray.h"
@@ -3038,6 +3096,505 @@ exit:
 
 #endif // PLANK_OPUS
 
+// -- FLAC Functions -- ////////////////////////////////////////////////////////
+
+#if PLANK_APPLE
+#pragma mark FLAC Functions
+#endif
+
+#define PLANKFLACWRITER_NUMSEEKPOINTS 128
+
+typedef struct PlankFLACFileWriter
+{
+    PlankFile file;
+    PlankFLACEncoder encoder;
+    PlankDynamicArray comments;
+    PlankDynamicArray samples;
+    PlankDynamicArray frame;
+    PlankDynamicArray seekPoints;
+    PlankI* channels[PLANKFLAC_MAXCHANNELS];
+    PlankLL streamInfoPosition;
+    PlankLL seekTablePosition;
+    PlankLL frameOffset;
+    PlankLL frameNumber;
+    PlankLL totalFrames;
+    PlankLL seekInterval;
+    PlankLL nextSeekFrame;
+    int blockFrames;
+    int numComments;
+    int minFrameSize;
+    int maxFrameSize;
+} PlankFLACFileWriter;
+
+typedef PlankFLACFileWriter* PlankFLACFileWriterRef;
+
+static void pl_FLAC_WriteLE32 (PlankUC* data, const PlankUI value)
+{
+    data[0] = (PlankUC)(value);
+    data[1] = (PlankUC)(value >> 8);
+    data[2] = (PlankUC)(value >> 16);
+    data[3] = (PlankUC)(value >> 24);
+}
+
+static PlankResult pl_AudioFileWriter_FLAC_CommentAddTag (PlankAudioFileWriterRef p, const char* key, const char* string)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACFileWriterRef flac;
+    PlankUC length[4];
+    int keyLength, stringLength;
+    
+    flac = (PlankFLACFileWriterRef)p->peer;
+    keyLength = (int)strlen (key);
+    stringLength = (int)strlen (string);
+    
+    if (stringLength > 0)
+    {
+        pl_FLAC_WriteLE32 (length, (PlankUI)(keyLength + 1 + stringLength));
+        
+        if ((result = pl_DynamicArray_AddItems (&flac->comments, length, 4)) != PlankResult_OK) goto exit;
+        if ((result = pl_DynamicArray_AddItems (&flac->comments, key, keyLength)) != PlankResult_OK) goto exit;
+        if ((result = pl_DynamicArray_AddItems (&flac->comments, "=", 1)) != PlankResult_OK) goto exit;
+        if ((result = pl_DynamicArray_AddItems (&flac->comments, string, stringLength)) != PlankResult_OK) goto exit;
+        
+        flac->numComments++;
+    }
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_AudioFileWriter_FLAC_Free (PlankFLACFileWriterRef flac)
+{
+    PlankResult result;
+    PlankMemoryRef m;
+    
+    m = pl_MemoryGlobal();
+
+    result = pl_File_DeInit (&flac->file);
+    
+    pl_FLACEncoder_DeInit (&flac->encoder);
+    pl_DynamicArray_DeInit (&flac->comments);
+    pl_DynamicArray_DeInit (&flac->samples);
+    pl_DynamicArray_DeInit (&flac->frame);
+    pl_DynamicArray_DeInit (&flac->seekPoints);
+    pl_Memory_Free (m, flac);
+    
+    return result;
+}
+
+static PlankResult pl_AudioFileWriter_FLAC_WriteSeekTable (PlankFLACFileWriterRef flac)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACSeekPoint placeholder;
+    const PlankFLACSeekPoint* seekPoints;
+    PlankUC data[PLANKFLAC_SEEKPOINT_LENGTH];
+    int numSeekPoints, i;
+    
+    placeholder.sampleNumber = PLANKFLAC_SEEKPOINT_PLACEHOLDER;
+    placeholder.offset       = 0;
+    placeholder.numSamples   = 0;
+    
+    seekPoints    = (const PlankFLACSeekPoint*)pl_DynamicArray_GetArray (&flac->seekPoints);
+    numSeekPoints = (int)pl_DynamicArray_GetSize (&flac->seekPoints);
+
+    for (i = 0; i < PLANKFLACWRITER_NUMSEEKPOINTS; ++i)
+    {
+        pl_FLAC_WriteSeekPoint ((i < numSeekPoints) ? seekPoints + i : &placeholder, data);
+        if ((result = pl_File_Write ((PlankFileRef)flac, data, PLANKFLAC_SEEKPOINT_LENGTH)) != PlankResult_OK) goto exit;
+    }
+    
+exit:
+    return result;
+}
+
+// keeps every other point to stay within the space reserved in the header
+static void pl_AudioFileWriter_FLAC_ThinSeekPoints (PlankFLACFileWriterRef flac)
+{
+    PlankFLACSeekPoint* seekPoints;
+    int numSeekPoints, i;
+    
+    seekPoints    = (PlankFLACSeekPoint*)pl_DynamicArray_GetArray (&flac->seekPoints);
+    numSeekPoints = (int)pl_DynamicArray_GetSize (&flac->seekPoints);
+    
+    for (i = 0; i < (numSeekPoints + 1) / 2; ++i)
+        seekPoints[i] = seekPoints[i * 2];
+    
+    pl_DynamicArray_SetSize (&flac->seekPoints, (numSeekPoints + 1) / 2);
+    flac->seekInterval *= 2;
+}
+
+static PlankResult pl_AudioFileWriter_FLAC_EncodeBlock (PlankFLACFileWriterRef flac)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACSeekPoint seekPoint;
+    int frameLength;
+    
+    if (flac->blockFrames == 0)
+        goto exit;
+    
+    result = pl_FLACEncoder_EncodeFrame (&flac->encoder,
+                                         (const PlankI* const*)flac->channels,
+                                         flac->blockFrames,
+                                         flac->frameNumber,
+                                         (PlankUC*)pl_DynamicArray_GetArray (&flac->frame),
+                                         (int)pl_DynamicArray_GetSize (&flac->frame),
+                                         &frameLength);
+    
+    if (result != PlankResult_OK) goto exit;
+    if ((result = pl_File_Write ((PlankFileRef)flac, pl_DynamicArray_GetArray (&flac->frame), frameLength)) != PlankResult_OK) goto exit;
+    
+    if (flac->totalFrames >= flac->nextSeekFrame)
+    {
+        seekPoint.sampleNumber = flac->totalFrames;
+        seekPoint.offset       = flac->frameOffset;
+        seekPoint.numSamples   = flac->blockFrames;
+        
+        if ((result = pl_DynamicArray_AddItem (&flac->seekPoints, &seekPoint)) != PlankResult_OK) goto exit;
+        
+        if (pl_DynamicArray_GetSize (&flac->seekPoints) >= (PLANKFLACWRITER_NUMSEEKPOINTS * 2))
+            pl_AudioFileWriter_FLAC_ThinSeekPoints (flac);
+        
+        flac->nextSeekFrame = flac->totalFrames + flac->seekInterval;
+    }
+    
+    flac->minFrameSize = (flac->frameNumber == 0) ? frameLength : pl_MinI (flac->minFrameSize, frameLength);
+    flac->maxFrameSize = pl_MaxI (flac->maxFrameSize, frameLength);
+    flac->frameOffset += frameLength;
+    flac->totalFrames += flac->blockFrames;
+    flac->frameNumber++;
+    flac->blockFrames = 0;
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileWriter_FLAC_OpenInternal (PlankAudioFileWriterRef p, const char* filepath, PlankFileRef file)
+{
+    PlankResult result;
+    PlankFLACFileWriterRef flac;
+    PlankFLACStreamInfo info;
+    PlankMemoryRef m;
+    PlankUC header[PLANKFLAC_METADATAHEADER_LENGTH];
+    PlankUC streamInfo[PLANKFLAC_STREAMINFO_LENGTH];
+    PlankUC length[4];
+    const char* vendor;
+    int mode, numChannels, commentsLength, vendorLength, i;
+    
+    result = PlankResult_OK;
+    flac = 0;
+    vendor = "Plink|Plonk|Plank";
+    
+    if (((filepath) && (file)) || ((filepath == 0) && (file == 0)))
+    {
+        result = PlankResult_UnknownError;
+        goto exit;
+    }
+    
+    numChannels = pl_AudioFileFormatInfo_GetNumChannels (&p->formatInfo);
+    
+    if ((numChannels < 1) || (numChannels > PLANKFLAC_MAXCHANNELS))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+    
+    if (!(p->formatInfo.encoding & PLANKAUDIOFILE_ENCODING_PCM_FLAG) ||
+        !pl_AudioFileWriter_IsEncodingNativeEndian (p) ||
+        (p->formatInfo.bitsPerSample < PLANKFLAC_MINBITSPERSAMPLE) ||
+        (p->formatInfo.bitsPerSample > PLANKFLAC_MAXBITSPERSAMPLE))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+    
+    if ((p->formatInfo.sampleRate <= 0.0) || (p->formatInfo.sampleRate > PLANKFLAC_MAXSAMPLERATE))
+    {
+        result = PlankResult_AudioFileNotReady;
+        goto exit;
+    }
+    
+    m = pl_MemoryGlobal();
+    flac = (PlankFLACFileWriterRef)pl_Memory_AllocateBytes (m, sizeof (PlankFLACFileWriter));
+    
+    if (flac == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    pl_MemoryZero (flac, sizeof (PlankFLACFileWriter));
+    
+    pl_DynamicArray_InitWithItemSize (&flac->comments, 1);
+    pl_DynamicArray_InitWithItemSize (&flac->samples, sizeof (PlankI));
+    pl_DynamicArray_InitWithItemSize (&flac->frame, 1);
+    pl_DynamicArray_InitWithItemSize (&flac->seekPoints, sizeof (PlankFLACSeekPoint));
+    
+    if (filepath)
+    {
+        if ((result = pl_File_Init ((PlankFileRef)flac)) != PlankResult_OK) goto exit;
+        if ((result = pl_File_OpenBinaryWrite ((PlankFileRef)flac, filepath, PLANK_FALSE, PLANK_TRUE, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    }
+    else
+    {
+        if ((result = pl_File_GetMode (file, &mode)) != PlankResult_OK) goto exit;
+        
+        if (!(mode & PLANKFILE_BINARY))
+        {
+            result = PlankResult_AudioFileInavlidType;
+            goto exit;
+        }
+        
+        if (!(mode & PLANKFILE_WRITE))
+        {
+            result = PlankResult_AudioFileInavlidType;
+            goto exit;
+        }
+        
+        pl_MemoryCopy (&flac->file, file, sizeof (PlankFile));
+        pl_MemoryZero (file, sizeof (PlankFile));
+    }
+    
+    pl_MemoryZero (&info, sizeof (PlankFLACStreamInfo));
+    info.minBlockSize  = PLANKFLAC_DEFAULTBLOCKSIZE;
+    info.maxBlockSize  = PLANKFLAC_DEFAULTBLOCKSIZE;
+    info.sampleRate    = (PlankI)p->formatInfo.sampleRate;
+    info.numChannels   = numChannels;
+    info.bitsPerSample = p->formatInfo.bitsPerSample;
+    
+    if ((result = pl_FLACEncoder_Init (&flac->encoder, &info)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&flac->samples, info.maxBlockSize * numChannels)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&flac->frame, pl_FLAC_GetFrameSizeBound (&info))) != PlankResult_OK) goto exit;
+    
+    for (i = 0; i < numChannels; ++i)
+        flac->channels[i] = (PlankI*)pl_DynamicArray_GetArray (&flac->samples) + i * info.maxBlockSize;
+    
+    // a seek point roughly every second to start with, this is widened as the file grows
+    flac->seekInterval  = (PlankLL)info.maxBlockSize * pl_MaxI (1, info.sampleRate / info.maxBlockSize);
+    flac->nextSeekFrame = 0;
+    
+    p->peer = flac;
+    
+    pl_AudioFileWriter_FLAC_CommentAddTag (p, "ENCODER", vendor);
+    
+    if (p->metaData)
+    {
+        if ((result = pl_AudioFileWriter_FLAC_WriteMetaData (p)) != PlankResult_OK) goto exit;
+    }
+    
+    // the stream info and seek table are rewritten on close
+    if ((result = pl_File_Write ((PlankFileRef)flac, PLANKFLAC_MAGIC, PLANKFLAC_MAGIC_LENGTH)) != PlankResult_OK) goto exit;
+
+    pl_FLAC_WriteMetaDataHeader (PLANKFLAC_METADATA_STREAMINFO, PLANK_FALSE, PLANKFLAC_STREAMINFO_LENGTH, header);
+    pl_FLAC_WriteStreamInfo (&info, streamInfo);
+    if ((result = pl_File_Write ((PlankFileRef)flac, header, PLANKFLAC_METADATAHEADER_LENGTH)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_GetPosition ((PlankFileRef)flac, &flac->streamInfoPosition)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_Write ((PlankFileRef)flac, streamInfo, PLANKFLAC_STREAMINFO_LENGTH)) != PlankResult_OK) goto exit;
+    
+    pl_FLAC_WriteMetaDataHeader (PLANKFLAC_METADATA_SEEKTABLE, PLANK_FALSE, PLANKFLACWRITER_NUMSEEKPOINTS * PLANKFLAC_SEEKPOINT_LENGTH, header);
+    if ((result = pl_File_Write ((PlankFileRef)flac, header, PLANKFLAC_METADATAHEADER_LENGTH)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_GetPosition ((PlankFileRef)flac, &flac->seekTablePosition)) != PlankResult_OK) goto exit;
+    if ((result = pl_AudioFileWriter_FLAC_WriteSeekTable (flac)) != PlankResult_OK) goto exit;
+    
+    vendorLength   = (int)strlen (vendor);
+    commentsLength = (int)pl_DynamicArray_GetSize (&flac->comments);
+    
+    pl_FLAC_WriteMetaDataHeader (PLANKFLAC_METADATA_VORBISCOMMENT, PLANK_TRUE, 4 + vendorLength + 4 + commentsLength, header);
+    if ((result = pl_File_Write ((PlankFileRef)flac, header, PLANKFLAC_METADATAHEADER_LENGTH)) != PlankResult_OK) goto exit;
+    
+    pl_FLAC_WriteLE32 (length, (PlankUI)vendorLength);
+    if ((result = pl_File_Write ((PlankFileRef)flac, length, 4)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_Write ((PlankFileRef)flac, vendor, vendorLength)) != PlankResult_OK) goto exit;
+    
+    pl_FLAC_WriteLE32 (length, (PlankUI)flac->numComments);
+    if ((result = pl_File_Write ((PlankFileRef)flac, length, 4)) != PlankResult_OK) goto exit;
+    
+    if (commentsLength > 0)
+    {
+        if ((result = pl_File_Write ((PlankFileRef)flac, pl_DynamicArray_GetArray (&flac->comments), commentsLength)) != PlankResult_OK) goto exit;
+    }
+    
+    p->writeFramesFunction = (PlankM)pl_AudioFileWriter_FLAC_WriteFrames;
+    p->writeHeaderFunction = 0;
+    
+exit:
+    if ((result != PlankResult_OK) && (flac != 0))
+    {
+        pl_AudioFileWriter_FLAC_Free (flac);
+        p->peer = PLANK_NULL;
+    }
+    
+    return result;
+}
+
+PlankResult pl_AudioFileWriter_FLAC_Open (PlankAudioFileWriterRef p, const char* filepath)
+{
+    return pl_AudioFileWriter_FLAC_OpenInternal (p, filepath, 0);
+}
+
+PlankResult pl_AudioFileWriter_FLAC_OpenWithFile (PlankAudioFileWriterRef p, PlankFileRef file)
+{
+    return pl_AudioFileWriter_FLAC_OpenInternal (p, 0, file);
+}
+
+PlankResult pl_AudioFileWriter_FLAC_Close (PlankAudioFileWriterRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACFileWriterRef flac;
+    PlankFLACStreamInfo info;
+    PlankUC streamInfo[PLANKFLAC_STREAMINFO_LENGTH];
+    
+    if (p == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    flac = (PlankFLACFileWriterRef)p->peer;
+    
+    if (flac == PLANK_NULL)
+        goto exit;
+    
+    if ((result = pl_AudioFileWriter_FLAC_EncodeBlock (flac)) != PlankResult_OK) goto exit;
+    
+    while (pl_DynamicArray_GetSize (&flac->seekPoints) > PLANKFLACWRITER_NUMSEEKPOINTS)
+        pl_AudioFileWriter_FLAC_ThinSeekPoints (flac);
+    
+    info = flac->encoder.info;
+    info.minFrameSize = flac->minFrameSize;
+    info.maxFrameSize = flac->maxFrameSize;
+    info.totalSamples = flac->totalFrames;
+    
+    pl_FLAC_WriteStreamInfo (&info, streamInfo);
+    
+    if ((result = pl_File_SetPosition ((PlankFileRef)flac, flac->streamInfoPosition)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_Write ((PlankFileRef)flac, streamInfo, PLANKFLAC_STREAMINFO_LENGTH)) != PlankResult_OK) goto exit;
+    if ((result = pl_File_SetPosition ((PlankFileRef)flac, flac->seekTablePosition)) != PlankResult_OK) goto exit;
+    if ((result = pl_AudioFileWriter_FLAC_WriteSeekTable (flac)) != PlankResult_OK) goto exit;
+    
+exit:
+    if ((p != PLANK_NULL) && (p->peer != PLANK_NULL))
+    {
+        if (result == PlankResult_OK)
+            result = pl_AudioFileWriter_FLAC_Free ((PlankFLACFileWriterRef)p->peer);
+        else
+            pl_AudioFileWriter_FLAC_Free ((PlankFLACFileWriterRef)p->peer);
+
+        p->peer = PLANK_NULL;
+    }
+    
+    return result;
+}
+
+PlankResult pl_AudioFileWriter_FLAC_WriteFrames (PlankAudioFileWriterRef p, const PlankB convertByteOrder, const int numFrames, const void* data)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACFileWriterRef flac;
+    const PlankUC* src;
+    PlankI* dst;
+    int numFramesRemaining, framesThisTime, numChannels, bytesPerSample, shift, i, j;
+    PlankUI value;
+    
+    (void)convertByteOrder; // the encoding is always native
+    
+    flac = (PlankFLACFileWriterRef)p->peer;
+    
+    numChannels        = flac->encoder.info.numChannels;
+    bytesPerSample     = p->formatInfo.bytesPerFrame / numChannels;
+    shift              = bytesPerSample * PLANKAUDIOFILE_CHARBITS - flac->encoder.info.bitsPerSample;
+    numFramesRemaining = numFrames;
+    src                = (const PlankUC*)data;
+    
+    while (numFramesRemaining > 0)
+    {
+        framesThisTime = pl_MinI (flac->encoder.maxBlockSize - flac->blockFrames, numFramesRemaining);
+        
+        // deinterleave into the block...
+        
+        for (i = 0; i < numChannels; ++i)
+        {
+            dst = flac->channels[i] + flac->blockFrames;
+            
+            switch (bytesPerSample)
+            {
+                case 1:
+                    for (j = 0; j < framesThisTime; ++j)
+                        dst[j] = ((const signed char*)src)[j * numChannels + i] >> shift;
+                    break;
+                case 2:
+                    for (j = 0; j < framesThisTime; ++j)
+                        dst[j] = ((const PlankS*)src)[j * numChannels + i] >> shift;
+                    break;
+                case 3:
+                    for (j = 0; j < framesThisTime; ++j)
+                    {
+#if PLANK_BIGENDIAN
+                        value = ((PlankUI)src[(j * numChannels + i) * 3 + 0] << 24) |
+                                ((PlankUI)src[(j * numChannels + i) * 3 + 1] << 16) |
+                                ((PlankUI)src[(j * numChannels + i) * 3 + 2] << 8);
+#else
+                        value = ((PlankUI)src[(j * numChannels + i) * 3 + 2] << 24) |
+                                ((PlankUI)src[(j * numChannels + i) * 3 + 1] << 16) |
+                                ((PlankUI)src[(j * numChannels + i) * 3 + 0] << 8);
+#endif
+                        dst[j] = (PlankI)value >> (shift + 8);
+                    }
+                    break;
+                default:
+                    result = PlankResult_AudioFileInavlidType;
+                    goto exit;
+            }
+        }
+        
+        flac->blockFrames += framesThisTime;
+        numFramesRemaining -= framesThisTime;
+        src += framesThisTime * p->formatInfo.bytesPerFrame;
+        
+        if (flac->blockFrames == flac->encoder.maxBlockSize)
+        {
+            if ((result = pl_AudioFileWriter_FLAC_EncodeBlock (flac)) != PlankResult_OK) goto exit;
+        }
+    }
+    
+exit:
+    return result;
+}
+
+PlankResult pl_AudioFileWriter_FLAC_WriteMetaData (PlankAudioFileWriterRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankI trackNum, trackTotal;
+    char text[64];
+    const char* string;
+    
+    if (!p->metaData)
+        goto exit;
+    
+    if (p->metaDataIOFlags & PLANKAUDIOFILEMETADATA_IOFLAGS_TEXT)
+    {
+        if ((string = pl_AudioFileMetaData_GetTitle (p->metaData)) != 0)              pl_AudioFileWriter_FLAC_CommentAddTag (p, "TITLE", string);
+        if ((string = pl_AudioFileMetaData_GetAlbum (p->metaData)) != 0)              pl_AudioFileWriter_FLAC_CommentAddTag (p, "ALBUM", string);
+        if ((string = pl_AudioFileMetaData_GetOriginatorArtist (p->metaData)) != 0)   pl_AudioFileWriter_FLAC_CommentAddTag (p, "ARTIST", string);
+        if ((string = pl_AudioFileMetaData_GetPerformer (p->metaData)) != 0)          pl_AudioFileWriter_FLAC_CommentAddTag (p, "PERFORMER", string);
+        if ((string = pl_AudioFileMetaData_GetDescriptionComment (p->metaData)) != 0) pl_AudioFileWriter_FLAC_CommentAddTag (p, "DESCRIPTION", string);
+        if ((string = pl_AudioFileMetaData_GetGenre (p->metaData)) != 0)              pl_AudioFileWriter_FLAC_CommentAddTag (p, "GENRE", string);
+        if ((string = pl_AudioFileMetaData_GetOriginationDate (p->metaData)) != 0)    pl_AudioFileWriter_FLAC_CommentAddTag (p, "DATE", string);
+        if ((string = pl_AudioFileMetaData_GetISRC (p->metaData)) != 0)               pl_AudioFileWriter_FLAC_CommentAddTag (p, "ISRC", string);
+        
+        pl_AudioFileMetaData_GetTrackInfo (p->metaData, &trackNum, &trackTotal);
+        
+        if (trackNum > 0)
+        {
+            snprintf (text, 64, "%d", (int)trackNum);
+            pl_AudioFileWriter_FLAC_CommentAddTag (p, "TRACKNUMBER", text);
+        }
+    }
+    
+    result = pl_AudioFileWriter_Ogg_WriteMetaData (p);
+    
+exit:
+    return result;
+}
+
 static PlankResult pl_AudioFileWriter_WAV_WriteChunk_bext (PlankAudioFileWriterRef p)
 {
     PlankResult result = PlankResult_OK;
@@ -4063,7 +4620,6 @@ PlankResult pl_AudioFileWriter_W64_WriteMetaData (PlankAudioFileWriterRef p)
     return PlankResult_UnknownError;
 }
 
-#if PLANK_OGGVORBIS || PLANK_OPUS
 static PlankResult pl_AudioFileWriter_Ogg_WriteMetaData (PlankAudioFileWriterRef p)
 {
     PlankResult result = PlankResult_OK;
@@ -4123,7 +4679,6 @@ static PlankResult pl_AudioFileWriter_Ogg_WriteMetaData (PlankAudioFileWriterRef
 exit:
     return result;
 }
-#endif
 
 #if PLANK_OGGVORBIS
 PlankResult pl_AudioFileWriter_OggVorbis_WriteMetaData (PlankAudioFileWriterRef p)
@@ -4139,8 +4694,6 @@ PlankResult pl_AudioFileWriter_Opus_WriteMetaData (PlankAudioFileWriterRef p)
 }
 #endif // PLANK_OPUS
 
-#if PLANK_OGGVORBIS || PLANK_OPUS
-
 PlankResult pl_AudioFileWriter_Ogg_CommentAddTag (PlankAudioFileWriterRef p, const char* key, const char* string)
 {
     PlankResult result = PlankResult_OK;
@@ -4157,6 +4710,9 @@ PlankResult pl_AudioFileWriter_Ogg_CommentAddTag (PlankAudioFileWriterRef p, con
             result = pl_AudioFileWriter_Opus_CommentAdd (p, key, string);
             break;
 #endif
+        case PLANKAUDIOFILE_FORMAT_FLAC:
+            result = pl_AudioFileWriter_FLAC_CommentAddTag (p, key, string);
+            break;
         default:
             result = PlankResult_UnknownError;
     }
@@ -4164,5 +4720,3 @@ PlankResult pl_AudioFileWriter_Ogg_CommentAddTag (PlankAudioFileWriterRef p, con
     return result;
 }
 
-#endif
-
@@ -0,0 +1,1606 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "../../core/plank_StandardHeader.h"
+#include "../../maths/plank_Maths.h"
+#include "plank_FLAC.h"
+
+// -- CRCs -- //////////////////////////////////////////////////////////////////
+
+static const PlankUC pl_FLACCRC8Table[256] =
+{
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+};
+
+static const PlankUS pl_FLACCRC16Table[256] =
+{
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022,
+    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041,
+    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2,
+    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1,
+    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1,
+    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
+    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192,
+    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1,
+    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1,
+    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2,
+    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151,
+    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162,
+    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101,
+    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312,
+    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371,
+    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342,
+    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1,
+    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
+    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2,
+    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291,
+    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2,
+    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2,
+    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1,
+    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
+    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231,
+    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202
+};
+
+static PLANK_INLINE_LOW PlankUC pl_FLAC_CRC8 (const PlankUC* data, const int length)
+{
+    PlankUC crc = 0;
+    int i;
+
+    for (i = 0; i < length; ++i)
+        crc = pl_FLACCRC8Table[crc ^ data[i]];
+
+    return crc;
+}
+
+static PLANK_INLINE_LOW PlankUS pl_FLAC_CRC16 (const PlankUC* data, const int length)
+{
+    PlankUS crc = 0;
+    int i;
+
+    for (i = 0; i < length; ++i)
+        crc = (PlankUS)((crc << 8) ^ pl_FLACCRC16Table[(crc >> 8) ^ data[i]]);
+
+    return crc;
+}
+
+// -- Bit Reader -- ////////////////////////////////////////////////////////////
+
+typedef struct PlankFLACBitReader
+{
+    const PlankUC* data;
+    int length;
+    int position;
+    PlankULL cache;
+    int cacheBits;
+    PlankB overrun;
+} PlankFLACBitReader;
+
+static PLANK_INLINE_LOW void pl_FLACBitReader_Init (PlankFLACBitReader* p, const PlankUC* data, const int length)
+{
+    p->data      = data;
+    p->length    = length;
+    p->position  = 0;
+    p->cache     = 0;
+    p->cacheBits = 0;
+    p->overrun   = PLANK_FALSE;
+}
+
+static PLANK_INLINE_LOW void pl_FLACBitReader_Refill (PlankFLACBitReader* p)
+{
+    while ((p->cacheBits <= 56) && (p->position < p->length))
+    {
+        p->cache |= ((PlankULL)p->data[p->position++]) << (56 - p->cacheBits);
+        p->cacheBits += 8;
+    }
+}
+
+// numBits must be 0-32
+static PLANK_INLINE_LOW PlankUI pl_FLACBitReader_ReadBits (PlankFLACBitReader* p, const int numBits)
+{
+    PlankUI value;
+
+    if (numBits == 0)
+        return 0;
+
+    if (p->cacheBits < numBits)
+    {
+        pl_FLACBitReader_Refill (p);
+
+        if (p->cacheBits < numBits)
+        {
+            p->overrun = PLANK_TRUE;
+            p->cache = 0;
+            p->cacheBits = 0;
+            return 0;
+        }
+    }
+
+    value = (PlankUI)(p->cache >> (64 - numBits));
+    p->cache <<= numBits;
+    p->cacheBits -= numBits;
+
+    return value;
+}
+
+static PLANK_INLINE_LOW PlankI pl_FLACBitReader_ReadSigned (PlankFLACBitReader* p, const int numBits)
+{
+    PlankUI value;
+
+    if (numBits == 0)
+        return 0;
+
+    value = pl_FLACBitReader_ReadBits (p, numBits);
+    return (PlankI)(value << (32 - numBits)) >> (32 - numBits);
+}
+
+static PLANK_INLINE_LOW PlankUI pl_FLACBitReader_ReadUnary (PlankFLACBitReader* p)
+{
+    PlankUI count = 0;
+
+    for (;;)
+    {
+        if (p->cacheBits == 0)
+        {
+            pl_FLACBitReader_Refill (p);
+
+            if (p->cacheBits == 0)
+            {
+                p->overrun = PLANK_TRUE;
+                return 0;
+            }
+        }
+
+        if (p->cache == 0)
+        {
+            count += p->cacheBits;
+            p->cacheBits = 0;
+        }
+        else
+        {
+#if defined(__GNUC__)
+            const int zeros = __builtin_clzll (p->cache);
+            p->cache <<= zeros;
+            p->cacheBits -= zeros;
+            count += zeros;
+#else
+            while (!(p->cache & ((PlankULL)1 << 63)))
+            {
+                p->cache <<= 1;
+                p->cacheBits--;
+                count++;
+            }
+#endif
+            p->cache <<= 1;
+            p->cacheBits--;
+            return count;
+        }
+    }
+}
+
+static PLANK_INLINE_LOW void pl_FLACBitReader_AlignToByte (PlankFLACBitReader* p)
+{
+    const int extra = p->cacheBits & 7;
+    p->cache <<= extra;
+    p->cacheBits -= extra;
+}
+
+static PLANK_INLINE_LOW int pl_FLACBitReader_GetBytePosition (PlankFLACBitReader* p)
+{
+    return p->position - (p->cacheBits >> 3);
+}
+
+// -- Bit Writer -- ////////////////////////////////////////////////////////////
+
+typedef struct PlankFLACBitWriter
+{
+    PlankUC* data;
+    int capacity;
+    int position;
+    PlankULL cache;
+    int cacheBits;
+    PlankB overrun;
+} PlankFLACBitWriter;
+
+static PLANK_INLINE_LOW void pl_FLACBitWriter_Init (PlankFLACBitWriter* p, PlankUC* data, const int capacity)
+{
+    p->data      = data;
+    p->capacity  = capacity;
+    p->position  = 0;
+    p->cache     = 0;
+    p->cacheBits = 0;
+    p->overrun   = PLANK_FALSE;
+}
+
+static PLANK_INLINE_LOW void pl_FLACBitWriter_FlushBytes (PlankFLACBitWriter* p)
+{
+    while (p->cacheBits >= 8)
+    {
+        if (p->position < p->capacity)
+            p->data[p->position++] = (PlankUC)(p->cache >> 56);
+        else
+            p->overrun = PLANK_TRUE;
+
+        p->cache <<= 8;
+        p->cacheBits -= 8;
+    }
+}
+
+// numBits must be 0-32
+static PLANK_INLINE_LOW void pl_FLACBitWriter_WriteBits (PlankFLACBitWriter* p, const PlankUI value, const int numBits)
+{
+    PlankULL masked;
+
+    if (numBits == 0)
+        return;
+
+    if (p->cacheBits > 32)
+        pl_FLACBitWriter_FlushBytes (p);
+
+    masked = (numBits == 32) ? (PlankULL)value : ((PlankULL)value & (((PlankULL)1 << numBits) - 1));
+    p->cache |= masked << (64 - numBits - p->cacheBits);
+    p->cacheBits += numBits;
+}
+
+static PLANK_INLINE_LOW void pl_FLACBitWriter_WriteZeros (PlankFLACBitWriter* p, PlankUI numBits)
+{
+    while (numBits > 32)
+    {
+        pl_FLACBitWriter_WriteBits (p, 0, 32);
+        numBits -= 32;
+    }
+
+    pl_FLACBitWriter_WriteBits (p, 0, (int)numBits);
+}
+
+static PLANK_INLINE_LOW void pl_FLACBitWriter_AlignToByte (PlankFLACBitWriter* p)
+{
+    pl_FLACBitWriter_WriteBits (p, 0, (8 - (p->cacheBits & 7)) & 7);
+    pl_FLACBitWriter_FlushBytes (p);
+}
+
+// -- Metadata -- //////////////////////////////////////////////////////////////
+
+static PLANK_INLINE_LOW PlankUI pl_FLAC_ReadBE (const PlankUC* data, const int numBytes)
+{
+    PlankUI value = 0;
+    int i;
+
+    for (i = 0; i < numBytes; ++i)
+        value = (value << 8) | data[i];
+
+    return value;
+}
+
+static PLANK_INLINE_LOW void pl_FLAC_WriteBE (PlankUC* data, PlankULL value, const int numBytes)
+{
+    int i;
+
+    for (i = numBytes - 1; i >= 0; --i)
+    {
+        data[i] = (PlankUC)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+PlankResult pl_FLAC_ParseStreamInfo (PlankFLACStreamInfo* info, const PlankUC* data, const int length)
+{
+    PlankResult result = PlankResult_OK;
+
+    if (length < PLANKFLAC_STREAMINFO_LENGTH)
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+
+    info->minBlockSize  = (PlankI)pl_FLAC_ReadBE (data, 2);
+    info->maxBlockSize  = (PlankI)pl_FLAC_ReadBE (data + 2, 2);
+    info->minFrameSize  = (PlankI)pl_FLAC_ReadBE (data + 4, 3);
+    info->maxFrameSize  = (PlankI)pl_FLAC_ReadBE (data + 7, 3);
+    info->sampleRate    = (PlankI)(pl_FLAC_ReadBE (data + 10, 3) >> 4);
+    info->numChannels   = (PlankI)(((data[12] >> 1) & 0x07) + 1);
+    info->bitsPerSample = (PlankI)((((data[12] & 0x01) << 4) | (data[13] >> 4)) + 1);
+    info->totalSamples  = ((PlankLL)(data[13] & 0x0F) << 32) | (PlankLL)pl_FLAC_ReadBE (data + 14, 4);
+    pl_MemoryCopy (info->md5, data + 18, 16);
+
+    if ((info->maxBlockSize < PLANKFLAC_MINBLOCKSIZE) ||
+        (info->minBlockSize > info->maxBlockSize) ||
+        (info->sampleRate == 0))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+
+    if ((info->bitsPerSample < PLANKFLAC_MINBITSPERSAMPLE) ||
+        (info->bitsPerSample > PLANKFLAC_MAXBITSPERSAMPLE))
+    {
+        result = PlankResult_AudioFileUnsupportedType;
+        goto exit;
+    }
+
+exit:
+    return result;
+}
+
+void pl_FLAC_WriteStreamInfo (const PlankFLACStreamInfo* info, PlankUC* data)
+{
+    PlankULL packed;
+
+    pl_FLAC_WriteBE (data,     (PlankULL)info->minBlockSize, 2);
+    pl_FLAC_WriteBE (data + 2, (PlankULL)info->maxBlockSize, 2);
+    pl_FLAC_WriteBE (data + 4, (PlankULL)info->minFrameSize, 3);
+    pl_FLAC_WriteBE (data + 7, (PlankULL)info->maxFrameSize, 3);
+
+    // 20 bits rate, 3 bits channels - 1, 5 bits bits per sample - 1, 36 bits total samples
+    packed = ((PlankULL)info->sampleRate << 44) |
+             ((PlankULL)(info->numChannels - 1) << 41) |
+             ((PlankULL)(info->bitsPerSample - 1) << 36) |
+             ((PlankULL)info->totalSamples & (((PlankULL)1 << 36) - 1));
+
+    pl_FLAC_WriteBE (data + 10, packed, 8);
+    pl_MemoryCopy (data + 18, info->md5, 16);
+}
+
+void pl_FLAC_ParseSeekPoint (PlankFLACSeekPoint* point, const PlankUC* data)
+{
+    PlankULL sampleNumber;
+
+    sampleNumber = ((PlankULL)pl_FLAC_ReadBE (data, 4) << 32) | (PlankULL)pl_FLAC_ReadBE (data + 4, 4);
+
+    point->sampleNumber = (sampleNumber == ~(PlankULL)0) ? PLANKFLAC_SEEKPOINT_PLACEHOLDER : (PlankLL)sampleNumber;
+    point->offset       = (PlankLL)(((PlankULL)pl_FLAC_ReadBE (data + 8, 4) << 32) | (PlankULL)pl_FLAC_ReadBE (data + 12, 4));
+    point->numSamples   = (PlankI)pl_FLAC_ReadBE (data + 16, 2);
+}
+
+void pl_FLAC_WriteSeekPoint (const PlankFLACSeekPoint* point, PlankUC* data)
+{
+    if (point->sampleNumber == PLANKFLAC_SEEKPOINT_PLACEHOLDER)
+    {
+        pl_FLAC_WriteBE (data, ~(PlankULL)0, 8);
+        pl_MemoryZero (data + 8, 10);
+    }
+    else
+    {
+        pl_FLAC_WriteBE (data,      (PlankULL)point->sampleNumber, 8);
+        pl_FLAC_WriteBE (data + 8,  (PlankULL)point->offset, 8);
+        pl_FLAC_WriteBE (data + 16, (PlankULL)point->numSamples, 2);
+    }
+}
+
+void pl_FLAC_WriteMetaDataHeader (const int type, const PlankB isLast, const int length, PlankUC* data)
+{
+    data[0] = (PlankUC)((type & 0x7F) | (isLast ? PLANKFLAC_METADATA_LASTFLAG : 0));
+    pl_FLAC_WriteBE (data + 1, (PlankULL)length, 3);
+}
+
+int pl_FLAC_GetFrameSizeBound (const PlankFLACStreamInfo* info)
+{
+    int bound;
+
+    // header + per subframe (header, wasted bits, verbatim samples with the extra side channel bit) + padding and CRC-16
+    bound = PLANKFLAC_FRAMEHEADER_MAXLENGTH +
+            info->numChannels * (2 + (info->maxBlockSize * (info->bitsPerSample + 1) + 7) / 8) +
+            1 + 2;
+
+    return pl_MaxI (bound, info->maxFrameSize);
+}
+
+// -- Frame Header -- //////////////////////////////////////////////////////////
+
+static const PlankI pl_FLACSampleRates[12] =
+{
+    0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000
+};
+
+static const PlankI pl_FLACSampleSizes[8] =
+{
+    0, 8, 12, -1, 16, 20, 24, 32
+};
+
+PlankResult pl_FLAC_ParseFrameHeader (PlankFLACFrameHeader* header, const PlankFLACStreamInfo* info, const PlankUC* data, const int length)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACBitReader bits;
+    PlankB isVariable;
+    PlankUI blockSizeCode, sampleRateCode, channelCode, sampleSizeCode;
+    PlankULL number;
+    PlankUI byte;
+    int extraBytes, i, headerLength;
+
+    pl_FLACBitReader_Init (&bits, data, pl_MinI (length, PLANKFLAC_FRAMEHEADER_MAXLENGTH));
+
+    if (pl_FLACBitReader_ReadBits (&bits, 15) != 0x7FFC)
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    isVariable      = (PlankB)pl_FLACBitReader_ReadBits (&bits, 1);
+    blockSizeCode   = pl_FLACBitReader_ReadBits (&bits, 4);
+    sampleRateCode  = pl_FLACBitReader_ReadBits (&bits, 4);
+    channelCode     = pl_FLACBitReader_ReadBits (&bits, 4);
+    sampleSizeCode  = pl_FLACBitReader_ReadBits (&bits, 3);
+
+    if (pl_FLACBitReader_ReadBits (&bits, 1) != 0 ||
+        (blockSizeCode == 0) ||
+        (sampleRateCode == 15) ||
+        (channelCode > PLANKFLAC_CHANNELS_MIDSIDE) ||
+        (pl_FLACSampleSizes[sampleSizeCode] < 0))
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    // UTF-8 style coded frame or sample number
+    byte = pl_FLACBitReader_ReadBits (&bits, 8);
+
+    if (!(byte & 0x80))
+    {
+        number = byte;
+        extraBytes = 0;
+    }
+    else if ((byte & 0xE0) == 0xC0) { number = byte & 0x1F; extraBytes = 1; }
+    else if ((byte & 0xF0) == 0xE0) { number = byte & 0x0F; extraBytes = 2; }
+    else if ((byte & 0xF8) == 0xF0) { number = byte & 0x07; extraBytes = 3; }
+    else if ((byte & 0xFC) == 0xF8) { number = byte & 0x03; extraBytes = 4; }
+    else if ((byte & 0xFE) == 0xFC) { number = byte & 0x01; extraBytes = 5; }
+    else if (byte == 0xFE)          { number = 0;           extraBytes = 6; }
+    else
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    for (i = 0; i < extraBytes; ++i)
+    {
+        byte = pl_FLACBitReader_ReadBits (&bits, 8);
+
+        if ((byte & 0xC0) != 0x80)
+        {
+            result = PlankResult_AudioFileDataChunkInvalid;
+            goto exit;
+        }
+
+        number = (number << 6) | (byte & 0x3F);
+    }
+
+    if (blockSizeCode == 1)
+        header->blockSize = 192;
+    else if (blockSizeCode <= 5)
+        header->blockSize = 576 << (blockSizeCode - 2);
+    else if (blockSizeCode == 6)
+        header->blockSize = (PlankI)pl_FLACBitReader_ReadBits (&bits, 8) + 1;
+    else if (blockSizeCode == 7)
+        header->blockSize = (PlankI)pl_FLACBitReader_ReadBits (&bits, 16) + 1;
+    else
+        header->blockSize = 256 << (blockSizeCode - 8);
+
+    if (sampleRateCode == 0)
+        header->sampleRate = info->sampleRate;
+    else if (sampleRateCode < 12)
+        header->sampleRate = pl_FLACSampleRates[sampleRateCode];
+    else if (sampleRateCode == 12)
+        header->sampleRate = (PlankI)pl_FLACBitReader_ReadBits (&bits, 8) * 1000;
+    else if (sampleRateCode == 13)
+        header->sampleRate = (PlankI)pl_FLACBitReader_ReadBits (&bits, 16);
+    else
+        header->sampleRate = (PlankI)pl_FLACBitReader_ReadBits (&bits, 16) * 10;
+
+    if (bits.overrun)
+    {
+        result = (length < PLANKFLAC_FRAMEHEADER_MAXLENGTH) ? PlankResult_FileEOF : PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    headerLength = pl_FLACBitReader_GetBytePosition (&bits);
+
+    if (headerLength >= length)
+    {
+        result = PlankResult_FileEOF;
+        goto exit;
+    }
+
+    if (pl_FLAC_CRC8 (data, headerLength) != data[headerLength])
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    header->numChannels       = (channelCode < PLANKFLAC_CHANNELS_LEFTSIDE) ? (PlankI)channelCode + 1 : 2;
+    header->channelAssignment = (channelCode < PLANKFLAC_CHANNELS_LEFTSIDE) ? PLANKFLAC_CHANNELS_INDEPENDENT : (PlankI)channelCode;
+    header->bitsPerSample     = (sampleSizeCode == 0) ? info->bitsPerSample : pl_FLACSampleSizes[sampleSizeCode];
+    header->headerLength      = headerLength + 1;
+
+    if (isVariable)
+        header->firstSample = (PlankLL)number;
+    else
+        header->firstSample = (PlankLL)number * ((info->minBlockSize == info->maxBlockSize) ? info->maxBlockSize : header->blockSize);
+
+    if ((header->numChannels != info->numChannels) ||
+        (header->bitsPerSample != info->bitsPerSample) ||
+        (header->blockSize > info->maxBlockSize))
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+exit:
+    return result;
+}
+
+int pl_FLAC_FindFrame (const PlankFLACStreamInfo* info, const PlankUC* data, const int length, PlankFLACFrameHeader* header)
+{
+    int i;
+
+    for (i = 0; i < length - 1; ++i)
+    {
+        if ((data[i] == 0xFF) && ((data[i + 1] & 0xFE) == 0xF8))
+        {
+            if (pl_FLAC_ParseFrameHeader (header, info, data + i, length - i) == PlankResult_OK)
+                return i;
+        }
+    }
+
+    return -1;
+}
+
+// -- Decoding -- //////////////////////////////////////////////////////////////
+
+static PlankResult pl_FLAC_DecodeResidual (PlankFLACBitReader* bits, const int blockSize, const int order, PlankI* residual)
+{
+    PlankResult result = PlankResult_OK;
+    PlankUI method, partitionOrder, param, escapeParam, paramBits, quotient, value;
+    int numPartitions, partition, count, i, sample;
+
+    method = pl_FLACBitReader_ReadBits (bits, 2);
+
+    if (method > 1)
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    paramBits      = (method == 0) ? 4 : 5;
+    escapeParam    = (method == 0) ? 15 : 31;
+    partitionOrder = pl_FLACBitReader_ReadBits (bits, 4);
+    numPartitions  = 1 << partitionOrder;
+
+    if (((blockSize >> partitionOrder) << partitionOrder) != blockSize ||
+        ((blockSize >> partitionOrder) < order))
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    sample = order;
+
+    for (partition = 0; partition < numPartitions; ++partition)
+    {
+        count = (blockSize >> partitionOrder) - ((partition == 0) ? order : 0);
+        param = pl_FLACBitReader_ReadBits (bits, (int)paramBits);
+
+        if (param == escapeParam)
+        {
+            param = pl_FLACBitReader_ReadBits (bits, 5);
+
+            for (i = 0; i < count; ++i)
+                residual[sample++] = pl_FLACBitReader_ReadSigned (bits, (int)param);
+        }
+        else
+        {
+            for (i = 0; i < count; ++i)
+            {
+                quotient = pl_FLACBitReader_ReadUnary (bits);
+                value = (quotient << param) | pl_FLACBitReader_ReadBits (bits, (int)param);
+                residual[sample++] = (PlankI)(value >> 1) ^ -(PlankI)(value & 1);
+            }
+        }
+
+        if (bits->overrun)
+        {
+            result = PlankResult_FileEOF;
+            goto exit;
+        }
+    }
+
+exit:
+    return result;
+}
+
+static void pl_FLAC_RestoreFixed (PlankI* x, const int blockSize, const int order)
+{
+    int i;
+
+    switch (order)
+    {
+        case 0:
+            break;
+        case 1:
+            for (i = 1; i < blockSize; ++i)
+                x[i] += x[i - 1];
+            break;
+        case 2:
+            for (i = 2; i < blockSize; ++i)
+                x[i] += 2 * x[i - 1] - x[i - 2];
+            break;
+        case 3:
+            for (i = 3; i < blockSize; ++i)
+                x[i] += 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3];
+            break;
+        case 4:
+            for (i = 4; i < blockSize; ++i)
+                x[i] += 4 * x[i - 1] - 6 * x[i - 2] + 4 * x[i - 3] - x[i - 4];
+            break;
+    }
+}
+
+static void pl_FLAC_RestoreLPC (PlankI* x, const int blockSize, const PlankI* coefs, const int order, const int shift)
+{
+    PlankLL sum;
+    int i, j;
+
+    for (i = order; i < blockSize; ++i)
+    {
+        sum = 0;
+
+        for (j = 0; j < order; ++j)
+            sum += (PlankLL)coefs[j] * (PlankLL)x[i - j - 1];
+
+        x[i] += (PlankI)(sum >> shift);
+    }
+}
+
+static PlankResult pl_FLAC_DecodeSubframe (PlankFLACBitReader* bits, const int blockSize, int bitsPerSample, PlankI* x)
+{
+    PlankResult result = PlankResult_OK;
+    PlankI coefs[PLANKFLAC_MAXLPCORDER];
+    PlankUI type, wasted;
+    int order, precision, shift, i;
+    PlankI value;
+
+    if (pl_FLACBitReader_ReadBits (bits, 1) != 0)
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    type = pl_FLACBitReader_ReadBits (bits, 6);
+    wasted = 0;
+
+    if (pl_FLACBitReader_ReadBits (bits, 1))
+    {
+        wasted = pl_FLACBitReader_ReadUnary (bits) + 1;
+
+        if ((int)wasted >= bitsPerSample)
+        {
+            result = PlankResult_AudioFileDataChunkInvalid;
+            goto exit;
+        }
+
+        bitsPerSample -= wasted;
+    }
+
+    if (type == 0)
+    {
+        value = pl_FLACBitReader_ReadSigned (bits, bitsPerSample);
+
+        for (i = 0; i < blockSize; ++i)
+            x[i] = value;
+    }
+    else if (type == 1)
+    {
+        for (i = 0; i < blockSize; ++i)
+            x[i] = pl_FLACBitReader_ReadSigned (bits, bitsPerSample);
+    }
+    else if ((type >= 8) && (type <= 12))
+    {
+        order = (int)type - 8;
+
+        if (order > blockSize)
+        {
+            result = PlankResult_AudioFileDataChunkInvalid;
+            goto exit;
+        }
+
+        for (i = 0; i < order; ++i)
+            x[i] = pl_FLACBitReader_ReadSigned (bits, bitsPerSample);
+
+        if ((result = pl_FLAC_DecodeResidual (bits, blockSize, order, x)) != PlankResult_OK) goto exit;
+
+        pl_FLAC_RestoreFixed (x, blockSize, order);
+    }
+    else if (type >= 32)
+    {
+        order = (int)(type & 0x1F) + 1;
+
+        if (order > blockSize)
+        {
+            result = PlankResult_AudioFileDataChunkInvalid;
+            goto exit;
+        }
+
+        for (i = 0; i < order; ++i)
+            x[i] = pl_FLACBitReader_ReadSigned (bits, bitsPerSample);
+
+        precision = (int)pl_FLACBitReader_ReadBits (bits, 4) + 1;
+        shift = pl_FLACBitReader_ReadSigned (bits, 5);
+
+        if ((precision == 16) || (shift < 0))
+        {
+            result = PlankResult_AudioFileDataChunkInvalid;
+            goto exit;
+        }
+
+        for (i = 0; i < order; ++i)
+            coefs[i] = pl_FLACBitReader_ReadSigned (bits, precision);
+
+        if ((result = pl_FLAC_DecodeResidual (bits, blockSize, order, x)) != PlankResult_OK) goto exit;
+
+        pl_FLAC_RestoreLPC (x, blockSize, coefs, order, shift);
+    }
+    else
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    if (bits->overrun)
+    {
+        result = PlankResult_FileEOF;
+        goto exit;
+    }
+
+    if (wasted > 0)
+    {
+        for (i = 0; i < blockSize; ++i)
+            x[i] = (PlankI)((PlankUI)x[i] << wasted);
+    }
+
+exit:
+    return result;
+}
+
+PlankResult pl_FLAC_DecodeFrame (const PlankFLACStreamInfo* info, const PlankUC* data, const int length, PlankI** channels, PlankFLACFrameHeader* header, int* frameLength)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACBitReader bits;
+    PlankI* left;
+    PlankI* right;
+    PlankI mid, side;
+    int channel, channelBits, blockSize, end, i;
+
+    if ((result = pl_FLAC_ParseFrameHeader (header, info, data, length)) != PlankResult_OK) goto exit;
+
+    blockSize = header->blockSize;
+
+    pl_FLACBitReader_Init (&bits, data + header->headerLength, length - header->headerLength);
+
+    for (channel = 0; channel < header->numChannels; ++channel)
+    {
+        channelBits = header->bitsPerSample;
+
+        if (((header->channelAssignment == PLANKFLAC_CHANNELS_LEFTSIDE)  && (channel == 1)) ||
+            ((header->channelAssignment == PLANKFLAC_CHANNELS_RIGHTSIDE) && (channel == 0)) ||
+            ((header->channelAssignment == PLANKFLAC_CHANNELS_MIDSIDE)   && (channel == 1)))
+            channelBits++;
+
+        if ((result = pl_FLAC_DecodeSubframe (&bits, blockSize, channelBits, channels[channel])) != PlankResult_OK) goto exit;
+    }
+
+    pl_FLACBitReader_AlignToByte (&bits);
+    end = header->headerLength + pl_FLACBitReader_GetBytePosition (&bits);
+
+    if ((end + 2) > length)
+    {
+        result = PlankResult_FileEOF;
+        goto exit;
+    }
+
+    if (pl_FLAC_CRC16 (data, end) != (PlankUS)pl_FLAC_ReadBE (data + end, 2))
+    {
+        result = PlankResult_AudioFileDataChunkInvalid;
+        goto exit;
+    }
+
+    left  = channels[0];
+    right = (header->numChannels > 1) ? channels[1] : left;
+
+    switch (header->channelAssignment)
+    {
+        case PLANKFLAC_CHANNELS_LEFTSIDE:
+            for (i = 0; i < blockSize; ++i)
+                right[i] = left[i] - right[i];
+            break;
+        case PLANKFLAC_CHANNELS_RIGHTSIDE:
+            for (i = 0; i < blockSize; ++i)
+                left[i] += right[i];
+            break;
+        case PLANKFLAC_CHANNELS_MIDSIDE:
+            for (i = 0; i < blockSize; ++i)
+            {
+                side = right[i];
+                mid = (PlankI)(((PlankUI)left[i] << 1) | (side & 1));
+                left[i]  = (mid + side) >> 1;
+                right[i] = (mid - side) >> 1;
+            }
+            break;
+        default:
+            break;
+    }
+
+    *frameLength = end + 2;
+
+exit:
+    return result;
+}
+
+// -- Encoding -- //////////////////////////////////////////////////////////////
+
+static PLANK_INLINE_LOW PlankUI pl_FLAC_ZigZag (const PlankI value)
+{
+    return ((PlankUI)value << 1) ^ (PlankUI)(value >> 31);
+}
+
+PlankResult pl_FLACEncoder_Init (PlankFLACEncoderRef p, const PlankFLACStreamInfo* info)
+{
+    PlankResult result = PlankResult_OK;
+    PlankMemoryRef m;
+    int n, i;
+    double half, x;
+
+    pl_MemoryZero (p, sizeof (PlankFLACEncoder));
+
+    if ((info->maxBlockSize < PLANKFLAC_MINBLOCKSIZE) ||
+        (info->maxBlockSize > PLANKFLAC_MAXBLOCKSIZE) ||
+        (info->numChannels < 1) ||
+        (info->numChannels > PLANKFLAC_MAXCHANNELS) ||
+        (info->bitsPerSample < PLANKFLAC_MINBITSPERSAMPLE) ||
+        (info->bitsPerSample > PLANKFLAC_MAXBITSPERSAMPLE))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+
+    m = pl_MemoryGlobal();
+    n = info->maxBlockSize;
+
+    p->info                   = *info;
+    p->maxBlockSize           = n;
+    p->lpcOrder               = PLANKFLAC_ENCODERLPCORDER;
+    p->useLPC                 = PLANK_TRUE;
+    p->useStereoDecorrelation = info->numChannels == 2;
+
+    p->mid          = (PlankI*)pl_Memory_AllocateBytes (m, n * sizeof (PlankI));
+    p->side         = (PlankI*)pl_Memory_AllocateBytes (m, n * sizeof (PlankI));
+    p->shifted      = (PlankI*)pl_Memory_AllocateBytes (m, n * sizeof (PlankI));
+    p->residual     = (PlankI*)pl_Memory_AllocateBytes (m, n * sizeof (PlankI));
+    p->bestResidual = (PlankI*)pl_Memory_AllocateBytes (m, n * sizeof (PlankI));
+    p->window       = (double*)pl_Memory_AllocateBytes (m, n * sizeof (double));
+    p->windowed     = (double*)pl_Memory_AllocateBytes (m, n * sizeof (double));
+
+    if (!p->mid || !p->side || !p->shifted || !p->residual || !p->bestResidual || !p->window || !p->windowed)
+    {
+        pl_FLACEncoder_DeInit (p);
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+
+    // Welch window for the LPC analysis, short blocks compute their own
+    half = (n - 1) * 0.5;
+
+    for (i = 0; i < n; ++i)
+    {
+        x = (i - half) / (half + 1.0);
+        p->window[i] = 1.0 - x * x;
+    }
+
+exit:
+    return result;
+}
+
+PlankResult pl_FLACEncoder_DeInit (PlankFLACEncoderRef p)
+{
+    PlankMemoryRef m = pl_MemoryGlobal();
+
+    if (p->mid)          pl_Memory_Free (m, p->mid);
+    if (p->side)         pl_Memory_Free (m, p->side);
+    if (p->shifted)      pl_Memory_Free (m, p->shifted);
+    if (p->residual)     pl_Memory_Free (m, p->residual);
+    if (p->bestResidual) pl_Memory_Free (m, p->bestResidual);
+    if (p->window)       pl_Memory_Free (m, p->window);
+    if (p->windowed)     pl_Memory_Free (m, p->windowed);
+
+    pl_MemoryZero (p, sizeof (PlankFLACEncoder));
+
+    return PlankResult_OK;
+}
+
+typedef struct PlankFLACRicePlan
+{
+    int partitionOrder;
+    int method;
+    int params[1 << PLANKFLAC_MAXRICEPARTITIONORDER];
+} PlankFLACRicePlan;
+
+// estimates the bits needed for the partitioned Rice coding of the residual
+static PlankLL pl_FLAC_PlanRice (const PlankI* residual, const int blockSize, const int order, PlankFLACRicePlan* plan)
+{
+    PlankULL sums[1 << PLANKFLAC_MAXRICEPARTITIONORDER];
+    PlankULL sum, cost, partitionBest;
+    PlankLL bestTotal, total;
+    int params[1 << PLANKFLAC_MAXRICEPARTITIONORDER];
+    int maxOrder, partitionOrder, numPartitions, partition, count, start, end, i, k, bestK, needsWide;
+
+    maxOrder = 0;
+
+    while ((maxOrder < PLANKFLAC_MAXRICEPARTITIONORDER) &&
+           (((blockSize >> (maxOrder + 1)) << (maxOrder + 1)) == blockSize) &&
+           ((blockSize >> (maxOrder + 1)) > order))
+        maxOrder++;
+
+    // sums at the finest partition order, coarser orders are merged from these
+    numPartitions = 1 << maxOrder;
+
+    for (partition = 0; partition < numPartitions; ++partition)
+    {
+        start = (partition == 0) ? order : partition * (blockSize >> maxOrder);
+        end = (partition + 1) * (blockSize >> maxOrder);
+        sum = 0;
+
+        for (i = start; i < end; ++i)
+            sum += pl_FLAC_ZigZag (residual[i]);
+
+        sums[partition] = sum;
+    }
+
+    bestTotal = -1;
+
+    for (partitionOrder = maxOrder; partitionOrder >= 0; --partitionOrder)
+    {
+        numPartitions = 1 << partitionOrder;
+
+        if (partitionOrder < maxOrder)
+        {
+            for (partition = 0; partition < numPartitions; ++partition)
+                sums[partition] = sums[partition * 2] + sums[partition * 2 + 1];
+        }
+
+        total = 2 + 4;
+        needsWide = 0;
+
+        for (partition = 0; partition < numPartitions; ++partition)
+        {
+            count = (blockSize >> partitionOrder) - ((partition == 0) ? order : 0);
+            sum = sums[partition];
+            bestK = 0;
+            partitionBest = ~(PlankULL)0;
+
+            for (k = 0; k <= 30; ++k)
+            {
+                cost = (PlankULL)count * (PlankULL)(k + 1) + (sum >> k);
+
+                if (cost < partitionBest)
+                {
+                    partitionBest = cost;
+                    bestK = k;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            params[partition] = bestK;
+
+            if (bestK > 14)
+                needsWide = 1;
+
+            total += (PlankLL)partitionBest;
+        }
+
+        total += (PlankLL)numPartitions * (needsWide ? 5 : 4);
+
+        if ((bestTotal < 0) || (total < bestTotal))
+        {
+            bestTotal = total;
+            plan->partitionOrder = partitionOrder;
+            plan->method = needsWide;
+            pl_MemoryCopy (plan->params, params, numPartitions * sizeof (int));
+        }
+    }
+
+    return bestTotal;
+}
+
+static void pl_FLAC_WriteRice (PlankFLACBitWriter* bits, const PlankI* residual, const int blockSize, const int order, const PlankFLACRicePlan* plan)
+{
+    int numPartitions, partition, start, end, param, i;
+    PlankUI value;
+
+    pl_FLACBitWriter_WriteBits (bits, (PlankUI)plan->method, 2);
+    pl_FLACBitWriter_WriteBits (bits, (PlankUI)plan->partitionOrder, 4);
+
+    numPartitions = 1 << plan->partitionOrder;
+
+    for (partition = 0; partition < numPartitions; ++partition)
+    {
+        param = plan->params[partition];
+        start = (partition == 0) ? order : partition * (blockSize >> plan->partitionOrder);
+        end = (partition + 1) * (blockSize >> plan->partitionOrder);
+
+        pl_FLACBitWriter_WriteBits (bits, (PlankUI)param, plan->method ? 5 : 4);
+
+        for (i = start; i < end; ++i)
+        {
+            value = pl_FLAC_ZigZag (residual[i]);
+            pl_FLACBitWriter_WriteZeros (bits, value >> param);
+            pl_FLACBitWriter_WriteBits (bits, 1, 1);
+            pl_FLACBitWriter_WriteBits (bits, value, param);
+        }
+    }
+}
+
+static int pl_FLAC_ChooseFixedOrder (const PlankI* x, const int blockSize)
+{
+    PlankULL totals[PLANKFLAC_MAXFIXEDORDER + 1];
+    PlankLL e0, e1, e2, e3, e4;
+    int i, order, best;
+
+    if (blockSize <= PLANKFLAC_MAXFIXEDORDER)
+        return 0;
+
+    for (order = 0; order <= PLANKFLAC_MAXFIXEDORDER; ++order)
+        totals[order] = 0;
+
+    for (i = PLANKFLAC_MAXFIXEDORDER; i < blockSize; ++i)
+    {
+        e0 = x[i];
+        e1 = e0 - x[i - 1];
+        e2 = e1 - ((PlankLL)x[i - 1] - x[i - 2]);
+        e3 = e2 - ((PlankLL)x[i - 1] - 2 * (PlankLL)x[i - 2] + x[i - 3]);
+        e4 = e3 - ((PlankLL)x[i - 1] - 3 * (PlankLL)x[i - 2] + 3 * (PlankLL)x[i - 3] - x[i - 4]);
+
+        totals[0] += (PlankULL)(e0 < 0 ? -e0 : e0);
+        totals[1] += (PlankULL)(e1 < 0 ? -e1 : e1);
+        totals[2] += (PlankULL)(e2 < 0 ? -e2 : e2);
+        totals[3] += (PlankULL)(e3 < 0 ? -e3 : e3);
+        totals[4] += (PlankULL)(e4 < 0 ? -e4 : e4);
+    }
+
+    best = 0;
+
+    for (order = 1; order <= PLANKFLAC_MAXFIXEDORDER; ++order)
+    {
+        if (totals[order] < totals[best])
+            best = order;
+    }
+
+    return best;
+}
+
+static void pl_FLAC_ComputeFixedResidual (const PlankI* x, const int blockSize, const int order, PlankI* residual)
+{
+    int i;
+
+    for (i = order; i < blockSize; ++i)
+    {
+        switch (order)
+        {
+            case 0: residual[i] = x[i]; break;
+            case 1: residual[i] = x[i] - x[i - 1]; break;
+            case 2: residual[i] = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+            case 3: residual[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+            case 4: residual[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+        }
+    }
+}
+
+// autocorrelation, Levinson-Durbin recursion and coefficient quantisation
+static PlankB pl_FLAC_ComputeLPC (PlankFLACEncoderRef p, const PlankI* x, const int blockSize, const int order, PlankI* qcoefs, int* shiftOut)
+{
+    double autoc[PLANKFLAC_ENCODERLPCORDER + 1];
+    double lpc[PLANKFLAC_ENCODERLPCORDER];
+    double tmp[PLANKFLAC_ENCODERLPCORDER];
+    double error, r, cmax, qerror;
+    const double* window;
+    double* windowed;
+    int i, j, exponent, shift, precision, qmax, q;
+
+    window = p->window;
+    windowed = p->windowed;
+
+    if (blockSize == p->maxBlockSize)
+    {
+        for (i = 0; i < blockSize; ++i)
+            windowed[i] = x[i] * window[i];
+    }
+    else
+    {
+        const double half = (blockSize - 1) * 0.5;
+
+        for (i = 0; i < blockSize; ++i)
+        {
+            r = (i - half) / (half + 1.0);
+            windowed[i] = x[i] * (1.0 - r * r);
+        }
+    }
+
+    for (j = 0; j <= order; ++j)
+    {
+        r = 0.0;
+
+        for (i = j; i < blockSize; ++i)
+            r += windowed[i] * windowed[i - j];
+
+        autoc[j] = r;
+    }
+
+    if (autoc[0] <= 0.0)
+        return PLANK_FALSE;
+
+    autoc[0] *= 1.0 + 1.0e-9; // slight conditioning
+    error = autoc[0];
+
+    for (i = 0; i < order; ++i)
+    {
+        r = -autoc[i + 1];
+
+        for (j = 0; j < i; ++j)
+            r -= lpc[j] * autoc[i - j];
+
+        r /= error;
+
+        for (j = 0; j < i; ++j)
+            tmp[j] = lpc[j] + r * lpc[i - j - 1];
+
+        for (j = 0; j < i; ++j)
+            lpc[j] = tmp[j];
+
+        lpc[i] = r;
+        error *= 1.0 - r * r;
+
+        if (error <= 0.0)
+            return PLANK_FALSE;
+    }
+
+    // predictor coefficients are the negated reflection form
+    cmax = 0.0;
+
+    for (i = 0; i < order; ++i)
+    {
+        lpc[i] = -lpc[i];
+        cmax = pl_MaxD (cmax, pl_AbsD (lpc[i]));
+    }
+
+    if (cmax <= 0.0)
+        return PLANK_FALSE;
+
+    precision = PLANKFLAC_ENCODERLPCPRECISION;
+    qmax = (1 << (precision - 1)) - 1;
+
+    frexp (cmax, &exponent);
+    shift = precision - 1 - exponent;
+
+    if (shift > 15)
+        shift = 15;
+
+    if (shift < 0)
+        return PLANK_FALSE;
+
+    qerror = 0.0;
+
+    for (i = 0; i < order; ++i)
+    {
+        qerror += lpc[i] * (double)(1 << shift);
+        q = (int)floor (qerror + 0.5);
+        q = pl_ClipI (q, -qmax - 1, qmax);
+        qerror -= q;
+        qcoefs[i] = q;
+    }
+
+    *shiftOut = shift;
+    return PLANK_TRUE;
+}
+
+static PlankB pl_FLAC_ComputeLPCResidual (const PlankI* x, const int blockSize, const PlankI* qcoefs, const int order, const int shift, PlankI* residual)
+{
+    PlankLL sum, value;
+    int i, j;
+
+    for (i = order; i < blockSize; ++i)
+    {
+        sum = 0;
+
+        for (j = 0; j < order; ++j)
+            sum += (PlankLL)qcoefs[j] * (PlankLL)x[i - j - 1];
+
+        value = (PlankLL)x[i] - (sum >> shift);
+
+        if ((value > 0x3FFFFFFF) || (value < -0x3FFFFFFF))
+            return PLANK_FALSE;
+
+        residual[i] = (PlankI)value;
+    }
+
+    return PLANK_TRUE;
+}
+
+static void pl_FLACEncoder_WriteSubframe (PlankFLACEncoderRef p, PlankFLACBitWriter* bits, const PlankI* x, const int blockSize, int bitsPerSample)
+{
+    PlankFLACRicePlan fixedPlan, lpcPlan;
+    PlankI qcoefs[PLANKFLAC_ENCODERLPCORDER];
+    PlankI* temp;
+    PlankUI orBits;
+    PlankLL verbatimBits, fixedBits, lpcBits;
+    int wasted, fixedOrder, lpcOrder, shift, i;
+    PlankB isConstant, useLPC;
+
+    isConstant = PLANK_TRUE;
+    orBits = 0;
+
+    for (i = 0; i < blockSize; ++i)
+    {
+        orBits |= (PlankUI)x[i];
+
+        if (x[i] != x[0])
+            isConstant = PLANK_FALSE;
+    }
+
+    if (isConstant)
+    {
+        pl_FLACBitWriter_WriteBits (bits, 0, 8); // pad, type 000000, no wasted bits
+        pl_FLACBitWriter_WriteBits (bits, (PlankUI)x[0], bitsPerSample);
+        return;
+    }
+
+    wasted = 0;
+
+    while (!(orBits & 1) && (wasted < bitsPerSample - 1))
+    {
+        orBits >>= 1;
+        wasted++;
+    }
+
+    if (wasted > 0)
+    {
+        for (i = 0; i < blockSize; ++i)
+            p->shifted[i] = x[i] >> wasted;
+
+        x = p->shifted;
+        bitsPerSample -= wasted;
+    }
+
+    verbatimBits = (PlankLL)blockSize * bitsPerSample;
+
+    fixedOrder = pl_FLAC_ChooseFixedOrder (x, blockSize);
+    pl_FLAC_ComputeFixedResidual (x, blockSize, fixedOrder, p->bestResidual);
+    fixedBits = (PlankLL)fixedOrder * bitsPerSample + pl_FLAC_PlanRice (p->bestResidual, blockSize, fixedOrder, &fixedPlan);
+
+    useLPC = PLANK_FALSE;
+    lpcOrder = pl_MinI (p->lpcOrder, blockSize - 1);
+    lpcBits = -1;
+    shift = 0;
+
+    if (p->useLPC && (lpcOrder > PLANKFLAC_MAXFIXEDORDER) &&
+        pl_FLAC_ComputeLPC (p, x, blockSize, lpcOrder, qcoefs, &shift) &&
+        pl_FLAC_ComputeLPCResidual (x, blockSize, qcoefs, lpcOrder, shift, p->residual))
+    {
+        lpcBits = (PlankLL)lpcOrder * bitsPerSample + 4 + 5 +
+                  (PlankLL)lpcOrder * PLANKFLAC_ENCODERLPCPRECISION +
+                  pl_FLAC_PlanRice (p->residual, blockSize, lpcOrder, &lpcPlan);
+
+        useLPC = lpcBits < fixedBits;
+    }
+
+    if (useLPC)
+    {
+        temp = p->residual;
+        p->residual = p->bestResidual;
+        p->bestResidual = temp;
+        fixedBits = lpcBits;
+    }
+
+    // subframe header: zero pad bit, 6 bit type, wasted bits flag and unary count
+    if (verbatimBits <= fixedBits)
+    {
+        pl_FLACBitWriter_WriteBits (bits, 1, 7);
+    }
+    else if (useLPC)
+    {
+        pl_FLACBitWriter_WriteBits (bits, (PlankUI)(32 | (lpcOrder - 1)), 7);
+    }
+    else
+    {
+        pl_FLACBitWriter_WriteBits (bits, (PlankUI)(8 | fixedOrder), 7);
+    }
+
+    if (wasted > 0)
+    {
+        pl_FLACBitWriter_WriteBits (bits, 1, 1);
+        pl_FLACBitWriter_WriteZeros (bits, (PlankUI)(wasted - 1));
+        pl_FLACBitWriter_WriteBits (bits, 1, 1);
+    }
+    else
+    {
+        pl_FLACBitWriter_WriteBits (bits, 0, 1);
+    }
+
+    if (verbatimBits <= fixedBits)
+    {
+        for (i = 0; i < blockSize; ++i)
+            pl_FLACBitWriter_WriteBits (bits, (PlankUI)x[i], bitsPerSample);
+    }
+    else if (useLPC)
+    {
+        for (i = 0; i < lpcOrder; ++i)
+            pl_FLACBitWriter_WriteBits (bits, (PlankUI)x[i], bitsPerSample);
+
+        pl_FLACBitWriter_WriteBits (bits, PLANKFLAC_ENCODERLPCPRECISION - 1, 4);
+        pl_FLACBitWriter_WriteBits (bits, (PlankUI)shift, 5);
+
+        for (i = 0; i < lpcOrder; ++i)
+            pl_FLACBitWriter_WriteBits (bits, (PlankUI)qcoefs[i], PLANKFLAC_ENCODERLPCPRECISION);
+
+        pl_FLAC_WriteRice (bits, p->bestResidual, blockSize, lpcOrder, &lpcPlan);
+    }
+    else
+    {
+        for (i = 0; i < fixedOrder; ++i)
+            pl_FLACBitWriter_WriteBits (bits, (PlankUI)x[i], bitsPerSample);
+
+        pl_FLAC_WriteRice (bits, p->bestResidual, blockSize, fixedOrder, &fixedPlan);
+    }
+}
+
+static PlankULL pl_FLAC_EstimateStereoCost (const PlankI* x, const int blockSize)
+{
+    PlankULL total = 0;
+    PlankLL e;
+    int i;
+
+    for (i = 2; i < blockSize; ++i)
+    {
+        e = (PlankLL)x[i] - 2 * (PlankLL)x[i - 1] + x[i - 2];
+        total += (PlankULL)(e < 0 ? -e : e);
+    }
+
+    return total;
+}
+
+static int pl_FLAC_GetBlockSizeCode (const int blockSize, int* extraBits)
+{
+    int code;
+
+    *extraBits = 0;
+
+    if (blockSize == 192)
+        return 1;
+
+    for (code = 2; code <= 5; ++code)
+        if (blockSize == (576 << (code - 2)))
+            return code;
+
+    for (code = 8; code <= 15; ++code)
+        if (blockSize == (256 << (code - 8)))
+            return code;
+
+    *extraBits = (blockSize <= 256) ? 8 : 16;
+    return (blockSize <= 256) ? 6 : 7;
+}
+
+static int pl_FLAC_GetSampleRateCode (const int sampleRate)
+{
+    int code;
+
+    for (code = 1; code < 12; ++code)
+        if (pl_FLACSampleRates[code] == sampleRate)
+            return code;
+
+    return 0;
+}
+
+static int pl_FLAC_GetSampleSizeCode (const int bitsPerSample)
+{
+    int code;
+
+    for (code = 1; code < 8; ++code)
+        if (pl_FLACSampleSizes[code] == bitsPerSample)
+            return code;
+
+    return 0;
+}
+
+PlankResult pl_FLACEncoder_EncodeFrame (PlankFLACEncoderRef p, const PlankI* const* channels, const int blockSize, const PlankLL frameNumber, PlankUC* data, const int capacity, int* frameLength)
+{
+    PlankResult result = PlankResult_OK;
+    PlankFLACBitWriter bits;
+    const PlankI* subframes[PLANKFLAC_MAXCHANNELS];
+    PlankULL costs[4], best;
+    PlankULL number;
+    int subframeBits[PLANKFLAC_MAXCHANNELS];
+    int numChannels, bitsPerSample, assignment, blockSizeCode, extraBits, channel, numBytes, i;
+    PlankUS crc;
+
+    numChannels   = p->info.numChannels;
+    bitsPerSample = p->info.bitsPerSample;
+
+    if ((blockSize < 1) || (blockSize > p->maxBlockSize))
+    {
+        result = PlankResult_AudioFileInavlidType;
+        goto exit;
+    }
+
+    for (channel = 0; channel < numChannels; ++channel)
+    {
+        subframes[channel] = channels[channel];
+        subframeBits[channel] = bitsPerSample;
+    }
+
+    assignment = numChannels - 1;
+
+    if (p->useStereoDecorrelation && (numChannels == 2) && (blockSize > 2))
+    {
+        for (i = 0; i < blockSize; ++i)
+        {
+            p->mid[i]  = (channels[0][i] + channels[1][i]) >> 1;
+            p->side[i] = channels[0][i] - channels[1][i];
+        }
+
+        costs[0] = pl_FLAC_EstimateStereoCost (channels[0], blockSize);
+        costs[1] = pl_FLAC_EstimateStereoCost (channels[1], blockSize);
+        costs[2] = pl_FLAC_EstimateStereoCost (p->mid, blockSize);
+        costs[3] = pl_FLAC_EstimateStereoCost (p->side, blockSize);
+
+        best = costs[0] + costs[1];
+
+        if ((costs[0] + costs[3]) < best)
+        {
+            best = costs[0] + costs[3];
+            assignment = PLANKFLAC_CHANNELS_LEFTSIDE;
+        }
+
+        if ((costs[1] + costs[3]) < best)
+        {
+            best = costs[1] + costs[3];
+            assignment = PLANKFLAC_CHANNELS_RIGHTSIDE;
+        }
+
+        if ((costs[2] + costs[3]) < best)
+        {
+            assignment = PLANKFLAC_CHANNELS_MIDSIDE;
+        }
+
+        switch (assignment)
+        {
+            case PLANKFLAC_CHANNELS_LEFTSIDE:
+                subframes[1] = p->side;
+                subframeBits[1]++;
+                break;
+            case PLANKFLAC_CHANNELS_RIGHTSIDE:
+                subframes[0] = p->side;
+                subframeBits[0]++;
+                break;
+            case PLANKFLAC_CHANNELS_MIDSIDE:
+                subframes[0] = p->mid;
+                subframes[1] = p->side;
+                subframeBits[1]++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    pl_FLACBitWriter_Init (&bits, data, capacity);
+
+    // frame header, always fixed blocking
+    blockSizeCode = pl_FLAC_GetBlockSizeCode (blockSize, &extraBits);
+
+    pl_FLACBitWriter_WriteBits (&bits, 0x7FFC, 15);
+    pl_FLACBitWriter_WriteBits (&bits, 0, 1);
+    pl_FLACBitWriter_WriteBits (&bits, (PlankUI)blockSizeCode, 4);
+    pl_FLACBitWriter_WriteBits (&bits, (PlankUI)pl_FLAC_GetSampleRateCode (p->info.sampleRate), 4);
+    pl_FLACBitWriter_WriteBits (&bits, (PlankUI)assignment, 4);
+    pl_FLACBitWriter_WriteBits (&bits, (PlankUI)pl_FLAC_GetSampleSizeCode (bitsPerSample), 3);
+    pl_FLACBitWriter_WriteBits (&bits, 0, 1);
+
+    number = (PlankULL)frameNumber;
+
+    if (number < 0x80)
+    {
+        pl_FLACBitWriter_WriteBits (&bits, (PlankUI)number, 8);
+    }
+    else
+    {
+        numBytes = 2;
+
+        while ((numBytes < 7) && (number >= ((PlankULL)1 << (5 * numBytes + 1))))
+            numBytes++;
+
+        pl_FLACBitWriter_WriteBits (&bits, (PlankUI)(((0xFF00 >> numBytes) & 0xFF) | (number >> (6 * (numBytes - 1)))), 8);
+
+        for (i = numBytes - 2; i >= 0; --i)
+            pl_FLACBitWriter_WriteBits (&bits, (PlankUI)(0x80 | ((number >> (6 * i)) & 0x3F)), 8);
+    }
+
+    if (extraBits)
+        pl_FLACBitWriter_WriteBits (&bits, (PlankUI)(blockSize - 1), extraBits);
+
+    pl_FLACBitWriter_FlushBytes (&bits);
+    pl_FLACBitWriter_WriteBits (&bits, pl_FLAC_CRC8 (data, bits.position), 8);
+
+    for (channel = 0; channel < numChannels; ++channel)
+        pl_FLACEncoder_WriteSubframe (p, &bits, subframes[channel], blockSize, subframeBits[channel]);
+
+    pl_FLACBitWriter_AlignToByte (&bits);
+
+    if (bits.overrun || ((bits.position + 2) > capacity))
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+
+    crc = pl_FLAC_CRC16 (data, bits.position);
+    data[bits.position++] = (PlankUC)(crc >> 8);
+    data[bits.position++] = (PlankUC)(crc & 0xFF);
+
+    *frameLength = bits.position;
+
+exit:
+    return result;
+}
@@ -0,0 +1,200 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_FLAC_H
+#define PLANK_FLAC_H
+
+#include "plank_AudioFileCommon.h"
+
+PLANK_BEGIN_C_LINKAGE
+
+/** Native FLAC bitstream encoding and decoding.
+
+ These are the low-level frame and metadata block routines used by the
+ <i>Plank AudioFileReader</i> and <i>Plank AudioFileWriter</i> FLAC support.
+ All functions operate on memory buffers and keep no global state so separate
+ streams may be decoded or encoded concurrently on different threads.
+
+ Streams of up to PLANKFLAC_MAXCHANNELS channels and PLANKFLAC_MAXBITSPERSAMPLE
+ bits per sample are supported.
+
+ @defgroup PlankFLACClass Plank FLAC class
+ @ingroup PlankClasses
+ @{
+ */
+
+#define PLANKFLAC_MAXCHANNELS                   8
+#define PLANKFLAC_MINBITSPERSAMPLE              4
+#define PLANKFLAC_MAXBITSPERSAMPLE              24
+#define PLANKFLAC_MINBLOCKSIZE                  16
+#define PLANKFLAC_MAXBLOCKSIZE                  65535
+#define PLANKFLAC_DEFAULTBLOCKSIZE              4096
+#define PLANKFLAC_MAXFIXEDORDER                 4
+#define PLANKFLAC_MAXLPCORDER                   32
+#define PLANKFLAC_ENCODERLPCORDER               8
+#define PLANKFLAC_ENCODERLPCPRECISION           12
+#define PLANKFLAC_MAXRICEPARTITIONORDER         8
+#define PLANKFLAC_MAXSAMPLERATE                 655350
+
+#define PLANKFLAC_MAGIC                         "fLaC"
+#define PLANKFLAC_MAGIC_LENGTH                  4
+#define PLANKFLAC_METADATAHEADER_LENGTH         4
+#define PLANKFLAC_STREAMINFO_LENGTH             34
+#define PLANKFLAC_SEEKPOINT_LENGTH              18
+#define PLANKFLAC_FRAMEHEADER_MAXLENGTH         16
+
+#define PLANKFLAC_METADATA_STREAMINFO           0
+#define PLANKFLAC_METADATA_PADDING              1
+#define PLANKFLAC_METADATA_APPLICATION          2
+#define PLANKFLAC_METADATA_SEEKTABLE            3
+#define PLANKFLAC_METADATA_VORBISCOMMENT        4
+#define PLANKFLAC_METADATA_CUESHEET             5
+#define PLANKFLAC_METADATA_PICTURE              6
+#define PLANKFLAC_METADATA_LASTFLAG             0x80
+
+#define PLANKFLAC_CHANNELS_INDEPENDENT          0
+#define PLANKFLAC_CHANNELS_LEFTSIDE             8
+#define PLANKFLAC_CHANNELS_RIGHTSIDE            9
+#define PLANKFLAC_CHANNELS_MIDSIDE              10
+
+#define PLANKFLAC_SEEKPOINT_PLACEHOLDER         (-1)
+
+/** The contents of the mandatory STREAMINFO metadata block. */
+typedef struct PlankFLACStreamInfo
+{
+    PlankI minBlockSize;
+    PlankI maxBlockSize;
+    PlankI minFrameSize;        // 0 if unknown
+    PlankI maxFrameSize;        // 0 if unknown
+    PlankI sampleRate;
+    PlankI numChannels;
+    PlankI bitsPerSample;
+    PlankLL totalSamples;       // 0 if unknown
+    PlankUC md5[16];
+} PlankFLACStreamInfo;
+
+/** One SEEKTABLE entry, the offset is relative to the first frame. */
+typedef struct PlankFLACSeekPoint
+{
+    PlankLL sampleNumber;       // PLANKFLAC_SEEKPOINT_PLACEHOLDER for unused points
+    PlankLL offset;
+    PlankI numSamples;
+} PlankFLACSeekPoint;
+
+/** The decoded fields of a frame header. */
+typedef struct PlankFLACFrameHeader
+{
+    PlankLL firstSample;
+    PlankI blockSize;
+    PlankI sampleRate;
+    PlankI numChannels;
+    PlankI channelAssignment;
+    PlankI bitsPerSample;
+    PlankI headerLength;
+} PlankFLACFrameHeader;
+
+/** Scratch memory and settings for encoding frames. */
+typedef struct PlankFLACEncoder
+{
+    PlankFLACStreamInfo info;
+    PlankI* mid;
+    PlankI* side;
+    PlankI* shifted;
+    PlankI* residual;
+    PlankI* bestResidual;
+    double* window;
+    double* windowed;
+    PlankI maxBlockSize;
+    PlankI lpcOrder;
+    PlankB useLPC;
+    PlankB useStereoDecorrelation;
+} PlankFLACEncoder;
+
+typedef PlankFLACEncoder* PlankFLACEncoderRef;
+
+/** Parse a STREAMINFO block body (excluding the metadata block header). */
+PlankResult pl_FLAC_ParseStreamInfo (PlankFLACStreamInfo* info, const PlankUC* data, const int length);
+
+/** Write a STREAMINFO block body (excluding the metadata block header) of PLANKFLAC_STREAMINFO_LENGTH bytes. */
+void pl_FLAC_WriteStreamInfo (const PlankFLACStreamInfo* info, PlankUC* data);
+
+/** Parse a PLANKFLAC_SEEKPOINT_LENGTH byte seek point. */
+void pl_FLAC_ParseSeekPoint (PlankFLACSeekPoint* point, const PlankUC* data);
+
+/** Write a PLANKFLAC_SEEKPOINT_LENGTH byte seek point. */
+void pl_FLAC_WriteSeekPoint (const PlankFLACSeekPoint* point, PlankUC* data);
+
+/** Write a four byte metadata block header. */
+void pl_FLAC_WriteMetaDataHeader (const int type, const PlankB isLast, const int length, PlankUC* data);
+
+/** The largest number of bytes a single frame of this stream may occupy.
+ This is the size of a frame with every subframe stored verbatim or the
+ maximum frame size in the STREAMINFO, whichever is larger. */
+int pl_FLAC_GetFrameSizeBound (const PlankFLACStreamInfo* info);
+
+/** Parse and validate (via its CRC-8) a frame header at the start of @e data. */
+PlankResult pl_FLAC_ParseFrameHeader (PlankFLACFrameHeader* header, const PlankFLACStreamInfo* info, const PlankUC* data, const int length);
+
+/** Scan for the next valid frame header.
+ @return The offset of the frame within @e data or -1 if none was found. */
+int pl_FLAC_FindFrame (const PlankFLACStreamInfo* info, const PlankUC* data, const int length, PlankFLACFrameHeader* header);
+
+/** Decode the frame at the start of @e data into one array per channel.
+ Each channel array must hold at least the maximum block size of the stream.
+ Samples are returned right-justified at the stream's bit depth.
+ @return PlankResult_FileEOF if @e length is too short to contain the whole frame,
+ PlankResult_AudioFileDataChunkInvalid if the frame is corrupt. */
+PlankResult pl_FLAC_DecodeFrame (const PlankFLACStreamInfo* info, const PlankUC* data, const int length, PlankI** channels, PlankFLACFrameHeader* header, int* frameLength);
+
+/** Initialise an encoder for the stream described by @e info.
+ The block size is taken from info->maxBlockSize. */
+PlankResult pl_FLACEncoder_Init (PlankFLACEncoderRef p, const PlankFLACStreamInfo* info);
+
+/** Free the encoder's scratch memory. */
+PlankResult pl_FLACEncoder_DeInit (PlankFLACEncoderRef p);
+
+/** Encode one frame.
+ @param channels One array of @e blockSize samples per channel, right-justified at the stream's bit depth.
+ @param data The output buffer which should be at least pl_FLAC_GetFrameSizeBound() bytes. */
+PlankResult pl_FLACEncoder_EncodeFrame (PlankFLACEncoderRef p, const PlankI* const* channels, const int blockSize, const PlankLL frameNumber, PlankUC* data, const int capacity, int* frameLength);
+
+/** @} */
+
+PLANK_END_C_LINKAGE
+
+#endif // PLANK_FLAC_H
@@ -664,6 +664,26 @@ PlankB pl_FileExists (const char* filepath, const PlankB isDirectory)
     return isDirectory ? (st.st_mode & S_IFDIR ? PLANK_TRUE : PLANK_FALSE) : (st.st_mode & S_IFREG ? PLANK_TRUE : PLANK_FALSE);
 }
 
+PlankResult pl_FileGetInfo (const char* filepath, PlankLL* size, PlankLL* modificationTime)
+{
+    struct stat st;
+    pl_MemoryZero (&st, sizeof (st));
+
+    if ((filepath == 0) || (filepath[0] == 0))
+        return PlankResult_FilePathInvalid;
+    
+    if (stat (filepath, &st) != 0)
+        return PlankResult_FileInvalid;
+    
+    if (size != PLANK_NULL)
+        *size = (PlankLL)st.st_size;
+    
+    if (modificationTime != PLANK_NULL)
+        *modificationTime = (PlankLL)st.st_mtime;
+    
+    return PlankResult_OK;
+}
+
 static int pl_mkdir (const char* filepath)
 {
 #if (defined (_WIN32) || defined (_WIN64) || defined (WIN64))
@@ -1672,6 +1692,7 @@ PlankResult pl_File_WriteDynamicArray (PlankFileRef p, PlankDynamicArrayRef arra
         
         if ((result = pl_File_Write (p, ptr, thisTime)) != PlankResult_OK) goto exit;
         
+        ptr       += thisTime;
         remaining -= thisTime;
     }
     
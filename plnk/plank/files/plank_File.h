@@ -117,6 +117,10 @@ PlankResult pl_FileErase (const char* filepath);
 PlankB pl_FileExists (const char* filepath, const PlankB isDirectory);
 PlankResult pl_FileMakeDirectory (const char* filepath);
 
+/** Get the size in bytes and the last modification time of a file on the filesystem.
+ The modification time is in seconds since the epoch. Either output may be 0 to ignore it. */
+PlankResult pl_FileGetInfo (const char* filepath, PlankLL* size, PlankLL* modificationTime);
+
 
 typedef PlankResult (*PlankFileOpenFunction)(PlankFileRef);
 typedef PlankResult (*PlankFileCloseFunction)(PlankFileRef);
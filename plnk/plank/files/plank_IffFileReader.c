@@ -38,6 +38,7 @@
 
 #include "../core/plank_StandardHeader.h"
 #include "plank_IffFileReader.h"
+#include "../maths/plank_Maths.h"
 
 //static PLANK_INLINE_LOW PlankResult pl_IffFileReader_ReadChunkLength (PlankIffFileReaderRef p, PlankLL* length)
 //{
@@ -112,6 +113,8 @@ PlankResult pl_IffFileReader_Init (PlankIffFileReaderRef p)
     p->common.headerInfo.headerLength       = 4 + 4;
     p->common.headerInfo.lengthSize         = 4;
     
+    if ((result = pl_DynamicArray_InitWithItemSize (&p->chunkIndex, sizeof (PlankIffFileReaderChunkInfo))) != PlankResult_OK) goto exit;
+    
     result = pl_File_Init ((PlankFileRef)p);
     
 exit:
@@ -128,8 +131,13 @@ PlankResult pl_IffFileReader_DeInit (PlankIffFileReaderRef p)
         goto exit;
     }
     
+    pl_IffFileReader_EndHeaderCache (p);
+    
     if ((result = pl_File_DeInit ((PlankFileRef)p)) != PlankResult_OK)
         goto exit;
+    
+    if ((result = pl_DynamicArray_DeInit (&p->chunkIndex)) != PlankResult_OK)
+        goto exit;
 
     pl_MemoryZero (p, sizeof (PlankIffFileReader));
 
@@ -177,6 +185,10 @@ static PlankResult pl_IffFileReader_ParseMain (PlankIffFileReaderRef p)
     {
         goto exit;
     }
+    else if (p->common.headerInfo.mainID.fcc == pl_FourCharCode ("fLaC"))
+    {
+        goto exit;
+    }
     else if (p->common.headerInfo.mainID.fcc == pl_FourCharCode ("caff"))
     {
         p->common.headerInfo.formatID.fcc       = 0;
@@ -255,6 +267,8 @@ PlankResult pl_IffFileReader_Open (PlankIffFileReaderRef p, const char* filepath
 
     if (result != PlankResult_OK)
         goto exit;
+    
+    if ((result = pl_IffFileReader_BeginHeaderCache (p, PLANKIFFFILEREADER_HEADERCACHESIZE)) != PlankResult_OK) goto exit;
 
     result = pl_IffFileReader_ParseMain (p);
     
@@ -265,7 +279,7 @@ exit:
 PlankResult pl_IffFileReader_OpenWithFile (PlankIffFileReaderRef p, PlankFileRef file)
 {
     PlankResult result = PlankResult_OK;
-    int mode;
+    int mode, type;
     
     if ((result = pl_File_GetMode (file, &mode)) != PlankResult_OK) goto exit;
     
@@ -283,6 +297,13 @@ PlankResult pl_IffFileReader_OpenWithFile (PlankIffFileReaderRef p, PlankFileRef
     
     pl_MemoryCopy ((PlankFileRef)p, file, sizeof (PlankFile));
     pl_MemoryZero (file, sizeof (PlankFile));
+    
+    if ((result = pl_File_GetStreamType ((PlankFileRef)p, &type)) != PlankResult_OK) goto exit;
+    
+    if (type == PLANKFILE_STREAMTYPE_FILE)
+    {
+        if ((result = pl_IffFileReader_BeginHeaderCache (p, PLANKIFFFILEREADER_HEADERCACHESIZE)) != PlankResult_OK) goto exit;
+    }
 
     result = pl_IffFileReader_ParseMain (p);
     
@@ -295,6 +316,8 @@ PlankResult pl_IffFileReader_Close (PlankIffFileReaderRef p)
     if (p == PLANK_NULL)
         return PlankResult_FileCloseFailed;
     
+    pl_IffFileReader_EndHeaderCache (p);
+    
     return pl_File_Close ((PlankFileRef)p);
 }
 
@@ -336,6 +359,10 @@ PlankResult pl_IffFileReader_SetEndian (PlankIffFileReaderRef p, const PlankB is
     {
         pl_File_SetEndian ((PlankFileRef)p, isBigEndian);
         
+        // any chunk lengths already indexed were read with the wrong byte order
+        pl_DynamicArray_SetSize (&p->chunkIndex, 0);
+        p->chunkIndexEnd = 0;
+        
         if (p->common.headerInfo.lengthSize == 4)
         {
             chunkLength32 = (PlankUI)p->common.headerInfo.mainLength;
@@ -358,13 +385,39 @@ PlankResult pl_IffFileReader_SeekChunk (PlankIffFileReaderRef p, const PlankLL s
     PlankLL readChunkEnd, mainEnd, pos;
     PlankLL readChunkLength;
     PlankIffID chunkID, readChunkID;
+    PlankIffFileReaderChunkInfo* chunkInfos;
+    PlankIffFileReaderChunkInfo chunkInfo;
+    PlankL numChunkInfos, i;
+    PlankB isIndexing;
 
     if ((result = pl_IffFile_InitID ((PlankIffFileRef)p, chunkIDstr, &chunkID)) != PlankResult_OK) goto exit;
     
+    isIndexing = PLANK_FALSE;
+    
     switch (startPosition)
     {
         case 0:
-            pos = p->common.headerInfo.mainHeaderEnd;
+            // check the chunks we've already passed before scanning any further
+            chunkInfos = (PlankIffFileReaderChunkInfo*)pl_DynamicArray_GetArray (&p->chunkIndex);
+            numChunkInfos = pl_DynamicArray_GetSize (&p->chunkIndex);
+            
+            for (i = 0; i < numChunkInfos; ++i)
+            {
+                if (pl_IffFile_EqualIDs ((PlankIffFileRef)p, &chunkID, &chunkInfos[i].chunkID))
+                {
+                    if (chunkLength)
+                        *chunkLength = chunkInfos[i].chunkLength;
+                    
+                    if (chunkDataPos)
+                        *chunkDataPos = chunkInfos[i].chunkDataPos;
+                    
+                    result = pl_File_SetPosition ((PlankFileRef)p, chunkInfos[i].chunkDataPos);
+                    goto exit;
+                }
+            }
+            
+            pos = (p->chunkIndexEnd > 0) ? p->chunkIndexEnd : p->common.headerInfo.mainHeaderEnd;
+            isIndexing = PLANK_TRUE;
             break;
         case -1:
             if ((result = pl_File_GetPosition ((PlankFileRef)p, &pos)) != PlankResult_OK) goto exit;
@@ -381,6 +434,17 @@ PlankResult pl_IffFileReader_SeekChunk (PlankIffFileReaderRef p, const PlankLL s
     {
         if ((result = pl_IffFileReader_ParseChunkHeader (p, 0, &readChunkID, &readChunkLength, &readChunkEnd, &pos)) != PlankResult_OK) goto exit;
         
+        if (isIndexing)
+        {
+            chunkInfo.chunkID      = readChunkID;
+            chunkInfo.chunkLength  = readChunkLength;
+            chunkInfo.chunkDataPos = pos;
+            
+            if ((result = pl_DynamicArray_AddItem (&p->chunkIndex, &chunkInfo)) != PlankResult_OK) goto exit;
+            
+            p->chunkIndexEnd = readChunkEnd;
+        }
+        
         if (pl_IffFile_EqualIDs ((PlankIffFileRef)p, &chunkID, &readChunkID))
         {
             if (chunkLength)
@@ -440,5 +504,258 @@ exit:
     return result;
 }
 
+// -- Header Cache -- //////////////////////////////////////////////////////////
+
+// these replace the file's own callbacks while the cache is active, the file 
+// is the first member of the reader so we can get back to the cache from it
+
+static PlankResult pl_IffFileReaderCacheGetStatusCallback (PlankFileRef file, int type, int* status)
+{
+    PlankIffFileReaderRef p = (PlankIffFileReaderRef)file;
+    
+    switch (type)
+    {
+        case PLANKFILE_STATUS_EOF:              *status = p->headerCache.isEOF; break;
+        case PLANKFILE_STATUS_ISPOSITIONABLE:   *status = PLANK_TRUE; break;
+            
+        default: return PlankResult_UnknownError;
+    }
+    
+    return PlankResult_OK;
+}
+
+static PlankResult pl_IffFileReaderCacheFill (PlankIffFileReaderRef p, const PlankLL position)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffFileReaderHeaderCache* cache;
+    int bytesRead;
+    
+    cache = &p->headerCache;
+    cache->bufferStart = position;
+    cache->bufferLength = 0;
+    bytesRead = 0;
+    
+    if ((result = (cache->setPositionFunction) ((PlankFileRef)p, position, PLANKFILE_SETPOSITION_ABSOLUTE)) != PlankResult_OK) goto exit;
+    
+    result = (cache->readFunction) ((PlankFileRef)p, cache->buffer, cache->bufferSize, &bytesRead);
+    
+    // a short read at the end of the file is fine
+    if (result == PlankResult_FileEOF)
+        result = PlankResult_OK;
+    
+    cache->bufferLength = (bytesRead > 0) ? bytesRead : 0;
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_IffFileReaderCacheReadCallback (PlankFileRef file, PlankP ptr, int maximumBytes, int* bytesReadOut)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffFileReaderRef p;
+    PlankIffFileReaderHeaderCache* cache;
+    PlankUC* dst;
+    PlankLL bufferEnd;
+    int bytesRead, offset, count;
+    
+    p = (PlankIffFileReaderRef)file;
+    cache = &p->headerCache;
+    dst = (PlankUC*)ptr;
+    bytesRead = 0;
+    
+    while (bytesRead < maximumBytes)
+    {
+        bufferEnd = cache->bufferStart + cache->bufferLength;
+
+        if ((cache->position < cache->bufferStart) || (cache->position >= bufferEnd))
+        {
+            if ((cache->position >= bufferEnd) && (cache->position > cache->bufferStart) && (cache->bufferLength < cache->bufferSize))
+            {
+                // the last fill was short so we're already at the end of the file
+                cache->isEOF = PLANK_TRUE;
+                result = PlankResult_FileEOF;
+                goto exit;
+            }
+            
+            if ((maximumBytes - bytesRead) >= cache->bufferSize)
+            {
+                // large reads go straight to the file
+                if ((result = (cache->setPositionFunction) (file, cache->position, PLANKFILE_SETPOSITION_ABSOLUTE)) != PlankResult_OK) goto exit;
+                
+                count = 0;
+                result = (cache->readFunction) (file, dst + bytesRead, maximumBytes - bytesRead, &count);
+                
+                if (count > 0)
+                {
+                    bytesRead += count;
+                    cache->position += count;
+                }
+                
+                if (result == PlankResult_FileEOF)
+                    cache->isEOF = PLANK_TRUE;
+                
+                goto exit;
+            }
+            
+            if ((result = pl_IffFileReaderCacheFill (p, cache->position)) != PlankResult_OK) goto exit;
+            
+            if (cache->bufferLength == 0)
+            {
+                cache->isEOF = PLANK_TRUE;
+                result = PlankResult_FileEOF;
+                goto exit;
+            }
+        }
+        
+        offset = (int)(cache->position - cache->bufferStart);
+        count = pl_MinI (cache->bufferLength - offset, maximumBytes - bytesRead);
+        
+        pl_MemoryCopy (dst + bytesRead, cache->buffer + offset, count);
+        
+        bytesRead += count;
+        cache->position += count;
+    }
+    
+exit:
+    if (bytesReadOut != PLANK_NULL)
+        *bytesReadOut = bytesRead;
+    
+    return result;
+}
+
+static PlankResult pl_IffFileReaderCacheSetPositionCallback (PlankFileRef file, PlankLL offset, int code)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffFileReaderRef p;
+    PlankIffFileReaderHeaderCache* cache;
+    PlankLL newPosition;
+    
+    p = (PlankIffFileReaderRef)file;
+    cache = &p->headerCache;
+    
+    switch (code)
+    {
+        case PLANKFILE_SETPOSITION_ABSOLUTE:
+            newPosition = offset;
+            break;
+        case PLANKFILE_SETPOSITION_RELATIVE:
+            newPosition = cache->position + offset;
+            break;
+        case PLANKFILE_SETPOSITION_RELATIVEEND:
+            // only the file knows where its end is
+            if ((result = (cache->setPositionFunction) (file, offset, code)) != PlankResult_OK) goto exit;
+            if ((result = (cache->getPositionFunction) (file, &newPosition)) != PlankResult_OK) goto exit;
+            break;
+        default:
+            result = PlankResult_FileSeekFailed;
+            goto exit;
+    }
+    
+    if (newPosition < 0)
+    {
+        result = PlankResult_FileSeekFailed;
+        goto exit;
+    }
+    
+    cache->position = newPosition;
+    cache->isEOF = PLANK_FALSE;
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_IffFileReaderCacheGetPositionCallback (PlankFileRef file, PlankLL* position)
+{
+    PlankIffFileReaderRef p = (PlankIffFileReaderRef)file;
+    
+    file->position = p->headerCache.position;
+    
+    if (position != PLANK_NULL)
+        *position = file->position;
+    
+    return PlankResult_OK;
+}
 
+PlankResult pl_IffFileReader_BeginHeaderCache (PlankIffFileReaderRef p, const int size)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffFileReaderHeaderCache* cache;
+    PlankFileRef file;
+    PlankMemoryRef m;
+    PlankLL position;
+    
+    m = pl_MemoryGlobal();
+    file = (PlankFileRef)p;
+    cache = &p->headerCache;
+    
+    if ((cache->buffer != PLANK_NULL) || (size <= 0))
+        goto exit;
+    
+    if (!pl_File_IsValid (file))
+    {
+        result = PlankResult_FileInvalid;
+        goto exit;
+    }
+    
+    if (!pl_File_IsPositionable (file))
+        goto exit;
+    
+    if ((result = pl_File_GetPosition (file, &position)) != PlankResult_OK) goto exit;
+    
+    if ((cache->buffer = (PlankUC*)pl_Memory_AllocateBytes (m, size)) == PLANK_NULL)
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    cache->bufferStart          = 0;
+    cache->bufferLength         = 0;
+    cache->bufferSize           = size;
+    cache->position             = position;
+    cache->isEOF                = PLANK_FALSE;
+    
+    cache->statusFunction       = file->statusFunction;
+    cache->readFunction         = file->readFunction;
+    cache->setPositionFunction  = file->setPositionFunction;
+    cache->getPositionFunction  = file->getPositionFunction;
+    
+    file->statusFunction        = pl_IffFileReaderCacheGetStatusCallback;
+    file->readFunction          = pl_IffFileReaderCacheReadCallback;
+    file->setPositionFunction   = pl_IffFileReaderCacheSetPositionCallback;
+    file->getPositionFunction   = pl_IffFileReaderCacheGetPositionCallback;
+    
+exit:
+    return result;
+}
 
+PlankResult pl_IffFileReader_EndHeaderCache (PlankIffFileReaderRef p)
+{
+    PlankResult result = PlankResult_OK;
+    PlankIffFileReaderHeaderCache* cache;
+    PlankFileRef file;
+    PlankMemoryRef m;
+    PlankLL position;
+    
+    m = pl_MemoryGlobal();
+    file = (PlankFileRef)p;
+    cache = &p->headerCache;
+    
+    if (cache->buffer == PLANK_NULL)
+        goto exit;
+    
+    position = cache->position;
+    
+    file->statusFunction        = cache->statusFunction;
+    file->readFunction          = cache->readFunction;
+    file->setPositionFunction   = cache->setPositionFunction;
+    file->getPositionFunction   = cache->getPositionFunction;
+    
+    pl_Memory_Free (m, cache->buffer);
+    pl_MemoryZero (cache, sizeof (PlankIffFileReaderHeaderCache));
+    
+    if (pl_File_IsValid (file))
+        result = pl_File_SetPosition (file, position);
+    
+exit:
+    return result;
+}
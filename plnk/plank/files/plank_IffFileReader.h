@@ -54,6 +54,9 @@ PLANK_BEGIN_C_LINKAGE
 /** An opaque reference to the <i>Plank IffFileReader</i> object. */
 typedef struct PlankIffFileReader* PlankIffFileReaderRef; 
 
+/** The number of bytes read in one go while parsing the file header and chunks. */
+#define PLANKIFFFILEREADER_HEADERCACHESIZE      (16 * 1024)
+
 /** Create and initialise a <i>Plank IffFileReader</i> object and return an oqaque reference to it.
  @return A <i>Plank IffFileReader</i> object as an opaque reference or PLANK_NULL. */
 PlankIffFileReaderRef pl_IffFileReader_CreateAndInit();
@@ -132,6 +135,8 @@ PlankResult pl_IffFileReader_SetEndian (PlankIffFileReaderRef p, const PlankB is
  @param startPosition Where to start searching within the file, in bytes. There are two special values:
                       -  0 : Specifies the start of the file (although this will be offset to the first chunk).
                       - -1 : Specifies the current file position.
+                      Chunks passed while searching from the start are indexed so later searches from 
+                      the start don't need to scan the file again.
  @return A result code which will be PlankResult_OK if the operation was completely successful. */
 PlankResult pl_IffFileReader_SeekChunk (PlankIffFileReaderRef p, const PlankLL startPosition, const char* chunkID, PlankLL* chunkLength, PlankLL* chunkDataPos);
 
@@ -145,14 +150,56 @@ PlankResult pl_IffFileReader_SeekChunk (PlankIffFileReaderRef p, const PlankLL s
  @return A result code which will be PlankResult_OK if the operation was completely successful. */
 PlankResult pl_IffFileReader_ParseChunkHeader (PlankIffFileReaderRef p, char* chunkIDstr, PlankIffID* chunkID,  PlankLL* chunkLength, PlankLL* chunkEnd, PlankLL* chunkPos);
 
+/** Serve reads from an in-memory copy of the file while parsing.
+ The file is read in blocks of @e size bytes so the many small reads and 
+ seeks needed to parse chunk headers don't each go to the file system. 
+ This is called by pl_IffFileReader_Open() with PLANKIFFFILEREADER_HEADERCACHESIZE 
+ for files on disk. Other stream types are left unbuffered. 
+ @param p The <i>Plank IffFileReader</i> object.
+ @param size The cache block size in bytes.
+ @return A result code which will be PlankResult_OK if the operation was completely successful. */
+PlankResult pl_IffFileReader_BeginHeaderCache (PlankIffFileReaderRef p, const int size);
+
+/** Stop serving reads from the header cache and free it.
+ This should be called once parsing is complete and before the underlying 
+ file is used directly or taken over by another object. The file position is preserved.
+ @param p The <i>Plank IffFileReader</i> object.
+ @return A result code which will be PlankResult_OK if the operation was completely successful. */
+PlankResult pl_IffFileReader_EndHeaderCache (PlankIffFileReaderRef p);
+
 /** @} */
 
 PLANK_END_C_LINKAGE
 
 #if !DOXYGEN
+typedef struct PlankIffFileReaderChunkInfo
+{
+    PlankIffID chunkID;
+    PlankLL chunkLength;
+    PlankLL chunkDataPos;
+} PlankIffFileReaderChunkInfo;
+
+typedef struct PlankIffFileReaderHeaderCache
+{
+    PlankUC* buffer;
+    PlankLL bufferStart;
+    PlankLL position;
+    int bufferSize;
+    int bufferLength;
+    PlankB isEOF;
+    
+    PlankFileGetStatusFunction      statusFunction;
+    PlankFileReadFunction           readFunction;
+    PlankFileSetPositionFunction    setPositionFunction;
+    PlankFileGetPositionFunction    getPositionFunction;
+} PlankIffFileReaderHeaderCache;
+
 typedef struct PlankIffFileReader
 {
     PlankIffFile common;
+    PlankIffFileReaderHeaderCache headerCache;
+    PlankDynamicArray chunkIndex;
+    PlankLL chunkIndexEnd;
 } PlankIffFileReader;
 #endif
 
@@ -183,6 +183,48 @@
 
 
 
+#define PLANK_VECTORMATMULTRANS_NAME(TYPECODE) PLANK_VECTOR_NAMEINTERNAL(MatMulTrans,TYPECODE,_MNK)
+
+#define PLANK_VECTORMATMULTRANS_DEFINE(TYPECODE) \
+    /** Matrix multiply with the second matrix transposed.
+     All matrices are contiguous and row-major. Each row of @c result is
+     the dot product of the corresponding row of @c a with every row of @c b.
+     @f$ result = a \times b^T @f$
+     @param result The M x N output matrix.
+     @param a The M x K left matrix.
+     @param b The N x K right matrix.
+     @param M The number of rows in @c a and @c result.
+     @param N The number of rows in @c b and columns in @c result.
+     @param K The number of columns in @c a and @c b. */\
+    static PLANK_INLINE_LOW void PLANK_VECTORMATMULTRANS_NAME(TYPECODE) (Plank##TYPECODE *result, const Plank##TYPECODE* a, const Plank##TYPECODE* b, PlankUL M, PlankUL N, PlankUL K) {\
+        PlankUL m, n, k;\
+        for (m = 0; m < M; PLANK_INC(m)) {\
+            const Plank##TYPECODE* aRow = a + m * K;\
+            Plank##TYPECODE* resultRow = result + m * N;\
+            for (n = 0; (n + 4) <= N; n += 4) {\
+                const Plank##TYPECODE* b0 = b + n * K;\
+                const Plank##TYPECODE* b1 = b0 + K;\
+                const Plank##TYPECODE* b2 = b1 + K;\
+                const Plank##TYPECODE* b3 = b2 + K;\
+                Plank##TYPECODE s0 = (Plank##TYPECODE)0, s1 = (Plank##TYPECODE)0, s2 = (Plank##TYPECODE)0, s3 = (Plank##TYPECODE)0;\
+                for (k = 0; k < K; PLANK_INC(k)) {\
+                    const Plank##TYPECODE x = aRow[k];\
+                    s0 = pl_Add##TYPECODE (pl_Mul##TYPECODE (x, b0[k]), s0);\
+                    s1 = pl_Add##TYPECODE (pl_Mul##TYPECODE (x, b1[k]), s1);\
+                    s2 = pl_Add##TYPECODE (pl_Mul##TYPECODE (x, b2[k]), s2);\
+                    s3 = pl_Add##TYPECODE (pl_Mul##TYPECODE (x, b3[k]), s3);\
+                }\
+                resultRow[n] = s0; resultRow[n + 1] = s1; resultRow[n + 2] = s2; resultRow[n + 3] = s3;\
+            }\
+            for (; n < N; PLANK_INC(n)) {\
+                const Plank##TYPECODE* b0 = b + n * K;\
+                Plank##TYPECODE s0 = (Plank##TYPECODE)0;\
+                for (k = 0; k < K; PLANK_INC(k)) { s0 = pl_Add##TYPECODE (pl_Mul##TYPECODE (aRow[k], b0[k]), s0); }\
+                resultRow[n] = s0;\
+            }\
+        }\
+    }
+
 #define PLANK_VECTORZMUL_NAME(TYPECODE) PLANK_VECTOR_NAMEINTERNAL(ZMul,TYPECODE,_ZNNNNN)
 
 #define PLANK_VECTORZMUL_DEFINE(TYPECODE) \
@@ -446,6 +488,9 @@ PLANK_VECTORCONVERTERSROUND_DEFINE
 PLANK_VECTORZMUL_DEFINE(F)
 PLANK_VECTORZMUL_DEFINE(D)
 
+PLANK_VECTORMATMULTRANS_DEFINE(F)
+PLANK_VECTORMATMULTRANS_DEFINE(D)
+
 #define PLANK_SIMDF_LENGTH   1 
 #define PLANK_SIMDF_SIZE     4 
 #define PLANK_SIMDF_SHIFT    0   
@@ -480,6 +525,85 @@ typedef PlankLL PlankVLL;
 
 #endif // PLANK_VEC_CUSTOM
 
+/** The number of frames processed per tile by the general case interleavers. 
+ With many channels this keeps the frames being written within the cache. */
+#define PLANK_VECTORINTERLEAVE_TILE 16
+
+#define PLANK_VECTORINTERLEAVE_NAME(TYPECODE) PLANK_VECTOR_NAMEINTERNAL(Interleave,TYPECODE,_Nn)
+#define PLANK_VECTORDEINTERLEAVE_NAME(TYPECODE) PLANK_VECTOR_NAMEINTERNAL(Deinterleave,TYPECODE,_nN)
+
+#define PLANK_VECTORINTERLEAVE_DEFINE(TYPECODE) \
+    /** Interleaves a set of channel vectors into one frame-major vector.
+    @param result The output vector, this must hold @e N x @e numChannels items.
+    @param channels An array of @e numChannels input vectors.
+    @param numChannels The number of channels.
+    @param N The number of items in each of the input vectors. */\
+    static PLANK_INLINE_LOW void PLANK_VECTORINTERLEAVE_NAME(TYPECODE) (Plank##TYPECODE *result, const Plank##TYPECODE* const* channels, PlankUL numChannels, PlankUL N) {\
+        PlankUL i, j, c, end;\
+        if (numChannels == 1) {\
+            const Plank##TYPECODE* a = channels[0];\
+            for (i = 0; i < N; PLANK_INC(i)) { result[i] = a[i]; }\
+        } else if (numChannels == 2) {\
+            const Plank##TYPECODE* a = channels[0]; const Plank##TYPECODE* b = channels[1];\
+            for (i = 0; i < N; PLANK_INC(i)) { result[2 * i] = a[i]; result[2 * i + 1] = b[i]; }\
+        } else if (numChannels == 4) {\
+            const Plank##TYPECODE* a = channels[0]; const Plank##TYPECODE* b = channels[1];\
+            const Plank##TYPECODE* c2 = channels[2]; const Plank##TYPECODE* d = channels[3];\
+            for (i = 0; i < N; PLANK_INC(i)) { result[4 * i] = a[i]; result[4 * i + 1] = b[i]; result[4 * i + 2] = c2[i]; result[4 * i + 3] = d[i]; }\
+        } else {\
+            for (i = 0; i < N; i += PLANK_VECTORINTERLEAVE_TILE) {\
+                end = (i + PLANK_VECTORINTERLEAVE_TILE) < N ? (i + PLANK_VECTORINTERLEAVE_TILE) : N;\
+                for (c = 0; c < numChannels; PLANK_INC(c)) {\
+                    const Plank##TYPECODE* a = channels[c]; Plank##TYPECODE* r = result + i * numChannels + c;\
+                    for (j = i; j < end; PLANK_INC(j), r += numChannels) { *r = a[j]; }\
+                }\
+            }\
+        }\
+    }
+
+#define PLANK_VECTORDEINTERLEAVE_DEFINE(TYPECODE) \
+    /** Deinterleaves a frame-major vector into a set of channel vectors.
+    @param results An array of @e numChannels output vectors.
+    @param a The input vector, this must hold @e N x @e numChannels items.
+    @param numChannels The number of channels.
+    @param N The number of items in each of the output vectors. */\
+    static PLANK_INLINE_LOW void PLANK_VECTORDEINTERLEAVE_NAME(TYPECODE) (Plank##TYPECODE* const* results, const Plank##TYPECODE *a, PlankUL numChannels, PlankUL N) {\
+        PlankUL i, j, c, end;\
+        if (numChannels == 1) {\
+            Plank##TYPECODE* r = results[0];\
+            for (i = 0; i < N; PLANK_INC(i)) { r[i] = a[i]; }\
+        } else if (numChannels == 2) {\
+            Plank##TYPECODE* r0 = results[0]; Plank##TYPECODE* r1 = results[1];\
+            for (i = 0; i < N; PLANK_INC(i)) { r0[i] = a[2 * i]; r1[i] = a[2 * i + 1]; }\
+        } else if (numChannels == 4) {\
+            Plank##TYPECODE* r0 = results[0]; Plank##TYPECODE* r1 = results[1];\
+            Plank##TYPECODE* r2 = results[2]; Plank##TYPECODE* r3 = results[3];\
+            for (i = 0; i < N; PLANK_INC(i)) { r0[i] = a[4 * i]; r1[i] = a[4 * i + 1]; r2[i] = a[4 * i + 2]; r3[i] = a[4 * i + 3]; }\
+        } else {\
+            for (i = 0; i < N; i += PLANK_VECTORINTERLEAVE_TILE) {\
+                end = (i + PLANK_VECTORINTERLEAVE_TILE) < N ? (i + PLANK_VECTORINTERLEAVE_TILE) : N;\
+                for (c = 0; c < numChannels; PLANK_INC(c)) {\
+                    Plank##TYPECODE* r = results[c]; const Plank##TYPECODE* s = a + i * numChannels + c;\
+                    for (j = i; j < end; PLANK_INC(j), s += numChannels) { r[j] = *s; }\
+                }\
+            }\
+        }\
+    }
+
+// convert between separate channel vectors and frame-major vectors (as used by
+// audio files and many audio drivers), common channel counts are unrolled so 
+// compilers can vectorise them, other counts are processed in tiles
+PLANK_VECTORINTERLEAVE_DEFINE(F)
+PLANK_VECTORINTERLEAVE_DEFINE(D)
+PLANK_VECTORINTERLEAVE_DEFINE(S)
+PLANK_VECTORINTERLEAVE_DEFINE(I)
+PLANK_VECTORINTERLEAVE_DEFINE(LL)
+PLANK_VECTORDEINTERLEAVE_DEFINE(F)
+PLANK_VECTORDEINTERLEAVE_DEFINE(D)
+PLANK_VECTORDEINTERLEAVE_DEFINE(S)
+PLANK_VECTORDEINTERLEAVE_DEFINE(I)
+PLANK_VECTORDEINTERLEAVE_DEFINE(LL)
+
 /** Swap the endianness of a vector of unsigned short elements.
  @ingroup PlankEndianFunctions */
 static PLANK_INLINE_LOW void pl_VectorSwapEndianUS (PlankUS* data, PlankUL N)
@@ -589,6 +589,11 @@ static PLANK_INLINE_LOW void pl_VectorZMulF_ZNNNNN (float *resultReal, float *re
     vDSP_zvmul (&left, 1, &right, 1, &result, 1, N, 1);
 }
 
+static PLANK_INLINE_LOW void pl_VectorMatMulTransF_MNK (float *result, const float* a, const float* b, PlankUL M, PlankUL N, PlankUL K)
+{
+    cblas_sgemm (CblasRowMajor, CblasNoTrans, CblasTrans, (int)M, (int)N, (int)K, 1.f, a, (int)K, b, (int)K, 0.f, result, (int)N);
+}
+
 
 // works as documented but seems useless as it interpolates thr "wrong" two samples
 // fixed in 10.7.2 but is that seems to be the runtime lib so would still 
@@ -949,6 +954,11 @@ static PLANK_INLINE_LOW void pl_VectorZMulD_ZNNNNN (double *resultReal, double *
     vDSP_zvmulD (&left, 1, &right, 1, &result, 1, N, 1);
 }
 
+static PLANK_INLINE_LOW void pl_VectorMatMulTransD_MNK (double *result, const double* a, const double* b, PlankUL M, PlankUL N, PlankUL K)
+{
+    cblas_dgemm (CblasRowMajor, CblasNoTrans, CblasTrans, (int)M, (int)N, (int)K, 1.0, a, (int)K, b, (int)K, 0.0, result, (int)N);
+}
+
 // works as documented but seems useless as it interpolates thr "wrong" two samples
 // fixed in 10.7.2 but is that seems to be the runtime lib so would still 
 // be dangerous to use without some runtime checking
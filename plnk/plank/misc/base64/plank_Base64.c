@@ -43,10 +43,18 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#if PLANK_X86 && defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define PLANK_BASE64_SSSE3 1
+#endif
+
+#define PLANK_BASE64_INVALID 0xFF
+
 typedef struct PlankBase64Tables
 {
     const char decoding[256];
     const char encoding[64 + 16];
+    const PlankUC decodingChecked[256]; // PLANK_BASE64_INVALID for characters outside the alphabet
 } PlankBase64Tables;
 
 PlankL pl_Base64EncodedLength (const PlankL inputLength)
@@ -68,6 +76,12 @@ static void pl_Base64TablesInit (PlankBase64Tables* tables)
 
     for (i = 0; i < 64; ++i)
         ((char*)(tables->decoding))[tables->encoding[i]] = i;
+    
+    for (i = 0; i < 256; ++i)
+        ((PlankUC*)(tables->decodingChecked))[i] = PLANK_BASE64_INVALID;
+
+    for (i = 0; i < 64; ++i)
+        ((PlankUC*)(tables->decodingChecked))[(PlankUC)tables->encoding[i]] = (PlankUC)i;
 }
 
 static const PlankBase64Tables* pl_Base64Tables()
@@ -84,6 +98,197 @@ static const PlankBase64Tables* pl_Base64Tables()
     return &tables;
 }
 
+#if PLANK_BASE64_SSSE3
+/* 12 bytes to 16 characters, reads 16 bytes. */
+static PLANK_INLINE_LOW void pl_Base64_EncodeSSSE3 (char* text, const PlankUC* binary)
+{
+    __m128i in, bits, sextets, offset;
+    
+    // each 32-bit lane gets one triple as a 24-bit big endian value
+    in = _mm_loadu_si128 ((const __m128i*)binary);
+    bits = _mm_shuffle_epi8 (in, _mm_setr_epi8 (2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+    
+    sextets = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (_mm_srli_epi32 (bits, 18), _mm_set1_epi32 (0x0000003F)),
+                                          _mm_and_si128 (_mm_srli_epi32 (bits, 4),  _mm_set1_epi32 (0x00003F00))),
+                            _mm_or_si128 (_mm_and_si128 (_mm_slli_epi32 (bits, 10), _mm_set1_epi32 (0x003F0000)),
+                                          _mm_and_si128 (_mm_slli_epi32 (bits, 24), _mm_set1_epi32 (0x3F000000))));
+    
+    // 'A' + n, 'a' + n - 26, '0' + n - 52, '+', '/'
+    offset = _mm_set1_epi8 (65);
+    offset = _mm_add_epi8 (offset, _mm_and_si128 (_mm_cmpgt_epi8 (sextets, _mm_set1_epi8 (25)), _mm_set1_epi8 (6)));
+    offset = _mm_add_epi8 (offset, _mm_and_si128 (_mm_cmpgt_epi8 (sextets, _mm_set1_epi8 (51)), _mm_set1_epi8 (-75)));
+    offset = _mm_add_epi8 (offset, _mm_and_si128 (_mm_cmpgt_epi8 (sextets, _mm_set1_epi8 (61)), _mm_set1_epi8 (-15)));
+    offset = _mm_add_epi8 (offset, _mm_and_si128 (_mm_cmpgt_epi8 (sextets, _mm_set1_epi8 (62)), _mm_set1_epi8 (3)));
+    
+    _mm_storeu_si128 ((__m128i*)text, _mm_add_epi8 (sextets, offset));
+}
+
+/* 16 characters to 12 bytes, writes 16 bytes, returns PLANK_FALSE without writing if any character is not in the alphabet. */
+static PLANK_INLINE_LOW PlankB pl_Base64_DecodeSSSE3 (PlankUC* binary, const char* text)
+{
+    __m128i in, upper, lower, digit, plus, slash, shift, sextets, pairs, triples;
+    
+    in = _mm_loadu_si128 ((const __m128i*)text);
+    upper = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('A' - 1)), _mm_cmplt_epi8 (in, _mm_set1_epi8 ('Z' + 1)));
+    lower = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('a' - 1)), _mm_cmplt_epi8 (in, _mm_set1_epi8 ('z' + 1)));
+    digit = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('0' - 1)), _mm_cmplt_epi8 (in, _mm_set1_epi8 ('9' + 1)));
+    plus  = _mm_cmpeq_epi8 (in, _mm_set1_epi8 ('+'));
+    slash = _mm_cmpeq_epi8 (in, _mm_set1_epi8 ('/'));
+    
+    if (_mm_movemask_epi8 (_mm_or_si128 (_mm_or_si128 (upper, lower), _mm_or_si128 (_mm_or_si128 (digit, plus), slash))) != 0xFFFF)
+        return PLANK_FALSE;
+    
+    shift = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (upper, _mm_set1_epi8 (-65)), 
+                                        _mm_and_si128 (lower, _mm_set1_epi8 (-71))),
+                          _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (digit, _mm_set1_epi8 (4)),
+                                                      _mm_and_si128 (plus, _mm_set1_epi8 (19))),
+                                        _mm_and_si128 (slash, _mm_set1_epi8 (16))));
+    sextets = _mm_add_epi8 (in, shift);
+    
+    // pack pairs of sextets into 12 bits then pairs of those into 24 bits
+    pairs = _mm_maddubs_epi16 (sextets, _mm_set1_epi32 (0x01400140));
+    triples = _mm_madd_epi16 (pairs, _mm_set1_epi32 (0x00011000));
+    
+    _mm_storeu_si128 ((__m128i*)binary, _mm_shuffle_epi8 (triples, _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+    
+    return PLANK_TRUE;
+}
+#endif
+
+PlankL pl_Base64_EncodeBlock (char* text, const void* binary, const PlankL binaryLength)
+{
+    const char* table;
+    const PlankUC* input;
+    char* output;
+    PlankUI triple;
+    PlankL remaining;
+    
+    table = pl_Base64Tables()->encoding;
+    input = (const PlankUC*)binary;
+    output = text;
+    remaining = binaryLength;
+    
+#if PLANK_BASE64_SSSE3
+    while (remaining >= 16)
+    {
+        pl_Base64_EncodeSSSE3 (output, input);
+        input += 12;
+        output += 16;
+        remaining -= 12;
+    }
+#endif
+    
+    while (remaining >= 3)
+    {
+        triple = ((PlankUI)input[0] << 16) | ((PlankUI)input[1] << 8) | (PlankUI)input[2];
+        output[0] = table[(triple >> 18) & 0x3F];
+        output[1] = table[(triple >> 12) & 0x3F];
+        output[2] = table[(triple >> 6) & 0x3F];
+        output[3] = table[triple & 0x3F];
+        input += 3;
+        output += 4;
+        remaining -= 3;
+    }
+    
+    if (remaining > 0)
+    {
+        triple = ((PlankUI)input[0] << 16) | (remaining > 1 ? ((PlankUI)input[1] << 8) : 0);
+        output[0] = table[(triple >> 18) & 0x3F];
+        output[1] = table[(triple >> 12) & 0x3F];
+        output[2] = (remaining > 1) ? table[(triple >> 6) & 0x3F] : '=';
+        output[3] = '=';
+        output += 4;
+    }
+    
+    return (PlankL)(output - text);
+}
+
+PlankResult pl_Base64_DecodeBlock (void* binary, PlankL* binaryLength, const char* text, const PlankL textLength, PlankL* textUsed)
+{
+    PlankResult result;
+    const PlankUC* table;
+    const PlankUC* input;
+    const PlankUC* inputEnd;
+    PlankUC* output;
+    PlankUI a, b, c, d;
+    
+    result = PlankResult_OK;
+    table = pl_Base64Tables()->decodingChecked;
+    input = (const PlankUC*)text;
+    inputEnd = input + (textLength & ~(PlankL)3);
+    output = (PlankUC*)binary;
+    
+#if PLANK_BASE64_SSSE3
+    // only write all 16 bytes when there is room past the 12 decoded
+    while ((inputEnd - input) >= 24)
+    {
+        if (!pl_Base64_DecodeSSSE3 (output, (const char*)input))
+            break;
+        
+        input += 16;
+        output += 12;
+    }
+#endif
+    
+    while (input < inputEnd)
+    {
+        a = table[input[0]];
+        b = table[input[1]];
+        
+        if ((a | b) & 0x80)
+        {
+            result = PlankResult_ItemCountInvalid;
+            goto exit;
+        }
+        
+        if (input[3] == '=')
+        {
+            output[0] = (PlankUC)((a << 2) | (b >> 4));
+            
+            if (input[2] == '=')
+            {
+                output += 1;
+            }
+            else
+            {
+                c = table[input[2]];
+                
+                if (c & 0x80)
+                {
+                    result = PlankResult_ItemCountInvalid;
+                    goto exit;
+                }
+                
+                output[1] = (PlankUC)((b << 4) | (c >> 2));
+                output += 2;
+            }
+            
+            input += 4;
+            break; // padding ends the data
+        }
+        
+        c = table[input[2]];
+        d = table[input[3]];
+        
+        if ((c | d) & 0x80)
+        {
+            result = PlankResult_ItemCountInvalid;
+            goto exit;
+        }
+        
+        output[0] = (PlankUC)((a << 2) | (b >> 4));
+        output[1] = (PlankUC)((b << 4) | (c >> 2));
+        output[2] = (PlankUC)((c << 6) | d);
+        input += 4;
+        output += 3;
+    }
+    
+exit:
+    *binaryLength = (PlankL)(output - (PlankUC*)binary);
+    *textUsed = (PlankL)(input - (const PlankUC*)text);
+    return result;
+}
+
 PlankResult pl_Base64_Init (PlankBase64Ref p)
 {
     if (p == PLANK_NULL)
@@ -278,72 +483,48 @@ exit:
 const char* pl_Base64_Encode (PlankBase64Ref p, const void* binary, const PlankL binaryLength)
 {
     PlankResult result;
-    PlankFile binaryInputStream;
-    PlankFile textOutputStream;
     PlankL stringLength;
     char* string;
-    void* data;
-    int mode;
     
     result = PlankResult_OK;
     string = (char*)PLANK_NULL;
     stringLength = pl_Base64EncodedLength (binaryLength);
     
     if ((result = pl_DynamicArray_SetSize (&p->buffer, stringLength + 1)) != PlankResult_OK) goto exit;    
-    if ((result = pl_File_Init (&binaryInputStream)) != PlankResult_OK) goto exit;
-    if ((result = pl_File_Init (&textOutputStream)) != PlankResult_OK) goto exit;
-    
-    mode = PLANKFILE_BINARY | PLANKFILE_READ | PLANKFILE_NATIVEENDIAN;
-    if ((result = pl_File_OpenMemory (&binaryInputStream, (void*)binary, (PlankLL)binaryLength, mode)) != PlankResult_OK) goto exit;
-
-    data = (void*)pl_DynamicArray_GetArray (&p->buffer);
-    
-    mode = PLANKFILE_WRITE;
-    if ((result = pl_File_OpenMemory (&textOutputStream, data, (PlankLL)stringLength, mode)) != PlankResult_OK) goto exit;
-    if ((result = pl_Base64_EncodeFile (p, &textOutputStream, &binaryInputStream)) != PlankResult_OK) goto exit;
     
-    string = (char*)data;
+    string = (char*)pl_DynamicArray_GetArray (&p->buffer);
+    pl_Base64_EncodeBlock (string, binary, binaryLength);
     string[stringLength] = '\0';
     
 exit:    
-    pl_File_DeInit (&binaryInputStream);
-    pl_File_DeInit (&textOutputStream);
-
     return string;
 }
 
 const void* pl_Base64_Decode (PlankBase64Ref p, const char* text, PlankL* binaryLengthOut)
 {
     PlankResult result;
-    PlankFile textInputStream;
-    PlankFile binaryOutputStream;
-    PlankLL stringLength;//, binaryLength;
+    PlankL stringLength, binaryLength, textUsed;
     const void* data;
-    int mode;
     
     result = PlankResult_OK;
     data = (const void*)PLANK_NULL;
     stringLength = strlen (text);
     *binaryLengthOut = 0;
-        
-    if ((result = pl_DynamicArray_SetSize (&p->buffer, 0)) != PlankResult_OK) goto exit;
-    if ((result = pl_File_Init (&textInputStream)) != PlankResult_OK) goto exit;
-    if ((result = pl_File_Init (&binaryOutputStream)) != PlankResult_OK) goto exit;
     
-    mode = PLANKFILE_READ;
-    if ((result = pl_File_OpenMemory (&textInputStream, (void*)text, stringLength, mode)) != PlankResult_OK) goto exit;
-        
-    mode = PLANKFILE_BINARY | PLANKFILE_WRITE | PLANKFILE_NATIVEENDIAN;
-    if ((result = pl_File_OpenDynamicArray (&binaryOutputStream, &p->buffer, mode)) != PlankResult_OK) goto exit;
-    if ((result = pl_Base64_DecodeFile (p, &binaryOutputStream, &textInputStream)) != PlankResult_OK) goto exit;
+    if ((stringLength % 4) != 0)
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+    
+    if ((result = pl_DynamicArray_SetSize (&p->buffer, pl_Base64DecodedLength (stringLength))) != PlankResult_OK) goto exit;
+    if ((result = pl_Base64_DecodeBlock (pl_DynamicArray_GetArray (&p->buffer), &binaryLength, text, stringLength, &textUsed)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_SetSize (&p->buffer, binaryLength)) != PlankResult_OK) goto exit;
     
     data = (const void*)pl_DynamicArray_GetArray (&p->buffer);
-    *binaryLengthOut = pl_DynamicArray_GetSize (&p->buffer);
+    *binaryLengthOut = binaryLength;
     
 exit:
-    pl_File_DeInit (&textInputStream);
-    pl_File_DeInit (&binaryOutputStream);
-    
     return data;
 }
 
@@ -49,6 +49,28 @@ typedef struct PlankBase64* PlankBase64Ref;
 PlankL pl_Base64EncodedLength (const PlankL binaryLength);
 PlankL pl_Base64DecodedLength (const PlankL stringLength);
 
+/** Encode a block of binary data straight into a text buffer.
+ The text is padded if binaryLength is not a multiple of 3 so when encoding a
+ stream in several blocks all but the last block must be a multiple of 3 bytes.
+ No null terminator is written.
+ @param text The destination, this must have room for pl_Base64EncodedLength (binaryLength) characters.
+ @param binary The data to encode.
+ @param binaryLength The number of bytes to encode.
+ @return The number of characters written. */
+PlankL pl_Base64_EncodeBlock (char* text, const void* binary, const PlankL binaryLength);
+
+/** Decode a block of text straight into a binary buffer.
+ Only whole groups of 4 characters are decoded, any remaining characters are 
+ left for the caller to pass in again with the next block. Decoding stops 
+ after a group containing padding.
+ @param binary The destination, this must have room for textLength / 4 * 3 bytes.
+ @param binaryLength Receives the number of bytes written.
+ @param text The text to decode.
+ @param textLength The number of characters available.
+ @param textUsed Receives the number of characters decoded, always a multiple of 4.
+ @return PlankResult_OK or PlankResult_ItemCountInvalid if the text contains invalid characters. */
+PlankResult pl_Base64_DecodeBlock (void* binary, PlankL* binaryLength, const char* text, const PlankL textLength, PlankL* textUsed);
+
 PlankResult pl_Base64_Init (PlankBase64Ref p);
 PlankResult pl_Base64_DeInit (PlankBase64Ref p);
 PlankResult pl_Base64_EncodeFile (PlankBase64Ref p, PlankFileRef outputTextFile, PlankFileRef inputBinaryFile);
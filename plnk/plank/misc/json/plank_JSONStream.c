@@ -0,0 +1,1921 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "../../core/plank_StandardHeader.h"
+#include "plank_JSONStream.h"
+#include "../base64/plank_Base64.h"
+#include "../../maths/plank_Maths.h"
+#include "../../../ext/zlib/zlib.h"
+
+#define PLANK_JSONREADER_START          0
+#define PLANK_JSONREADER_DONE           1
+#define PLANK_JSONREADER_OBJECTFIRST    2
+#define PLANK_JSONREADER_OBJECTKEY      3
+#define PLANK_JSONREADER_OBJECTVALUE    4
+#define PLANK_JSONREADER_OBJECTNEXT     5
+#define PLANK_JSONREADER_ARRAYFIRST     6
+#define PLANK_JSONREADER_ARRAYVALUE     7
+#define PLANK_JSONREADER_ARRAYNEXT      8
+
+#define PLANK_JSONSTREAM_OBJECT         1
+#define PLANK_JSONSTREAM_ARRAY          2
+#define PLANK_JSONSTREAM_HASITEMS       4
+
+#define PLANK_JSONSTREAM_INT            0
+#define PLANK_JSONSTREAM_FLOAT          1
+#define PLANK_JSONSTREAM_DOUBLE         2
+
+#define PLANK_JSONSTREAM_MAXIMUMNUMBERLENGTH 64
+
+// decoded data is written to either a fixed buffer or a dynamic array grown as needed,
+// with compressed data it passes through the reader's window into zlib first
+typedef struct PlankJSONReaderSink
+{
+    PlankDynamicArrayRef array;
+    PlankUC* data;
+    PlankL capacity;
+    PlankL length;
+    z_stream* zip;
+    PlankB isZipEnd;
+} PlankJSONReaderSink;
+
+static PlankResult pl_JSONReaderFill (PlankJSONReaderRef p)
+{
+    PlankResult result;
+    int bytesRead;
+
+    result = PlankResult_OK;
+    p->bufferPosition = 0;
+    p->bufferLength = 0;
+
+    if (p->isEOF)
+        goto exit;
+
+    bytesRead = 0;
+    result = pl_File_Read (p->file, p->buffer, PLANK_JSONSTREAM_BUFFERSIZE, &bytesRead);
+
+    if (result == PlankResult_FileEOF)
+    {
+        p->isEOF = PLANK_TRUE;
+        result = PlankResult_OK;
+    }
+
+    if (bytesRead <= 0)
+    {
+        p->isEOF = PLANK_TRUE;
+        bytesRead = 0;
+    }
+
+    p->bufferLength = bytesRead;
+
+exit:
+    return result;
+}
+
+static PLANK_INLINE_LOW int pl_JSONReaderPeek (PlankJSONReaderRef p)
+{
+    if (p->bufferPosition >= p->bufferLength)
+    {
+        if ((pl_JSONReaderFill (p) != PlankResult_OK) || (p->bufferLength == 0))
+            return -1;
+    }
+
+    return (PlankUC)p->buffer[p->bufferPosition];
+}
+
+static PLANK_INLINE_LOW int pl_JSONReaderGet (PlankJSONReaderRef p)
+{
+    int c;
+
+    if ((c = pl_JSONReaderPeek (p)) >= 0)
+        p->bufferPosition++;
+
+    return c;
+}
+
+static int pl_JSONReaderSkipWhitespace (PlankJSONReaderRef p)
+{
+    int c;
+
+    while (((c = pl_JSONReaderPeek (p)) == ' ') || (c == '\n') || (c == '\r') || (c == '\t'))
+        p->bufferPosition++;
+
+    return c;
+}
+
+static PlankResult pl_JSONReaderExpect (PlankJSONReaderRef p, const int expected)
+{
+    if (pl_JSONReaderSkipWhitespace (p) != expected)
+        return PlankResult_JSONError;
+
+    p->bufferPosition++;
+    return PlankResult_OK;
+}
+
+static PLANK_INLINE_LOW PlankResult pl_JSONReaderAppendText (PlankJSONReaderRef p, const char* text, const PlankL length)
+{
+    return length > 0 ? pl_DynamicArray_AddItems (&p->text, text, length) : PlankResult_OK;
+}
+
+static PlankResult pl_JSONReaderAppendUTF8 (PlankJSONReaderRef p, const PlankUI code)
+{
+    char utf8[4];
+    PlankL length;
+
+    if (code < 0x80)
+    {
+        utf8[0] = (char)code;
+        length = 1;
+    }
+    else if (code < 0x800)
+    {
+        utf8[0] = (char)(0xC0 | (code >> 6));
+        utf8[1] = (char)(0x80 | (code & 0x3F));
+        length = 2;
+    }
+    else if (code < 0x10000)
+    {
+        utf8[0] = (char)(0xE0 | (code >> 12));
+        utf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (code & 0x3F));
+        length = 3;
+    }
+    else
+    {
+        utf8[0] = (char)(0xF0 | (code >> 18));
+        utf8[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (code & 0x3F));
+        length = 4;
+    }
+
+    return pl_JSONReaderAppendText (p, utf8, length);
+}
+
+static PlankResult pl_JSONReaderReadHex (PlankJSONReaderRef p, PlankUI* code)
+{
+    int i, c;
+
+    *code = 0;
+
+    for (i = 0; i < 4; ++i)
+    {
+        c = pl_JSONReaderGet (p);
+
+        if ((c >= '0') && (c <= '9'))      *code = (*code << 4) | (PlankUI)(c - '0');
+        else if ((c >= 'a') && (c <= 'f')) *code = (*code << 4) | (PlankUI)(c - 'a' + 10);
+        else if ((c >= 'A') && (c <= 'F')) *code = (*code << 4) | (PlankUI)(c - 'A' + 10);
+        else return PlankResult_JSONError;
+    }
+
+    return PlankResult_OK;
+}
+
+static PlankResult pl_JSONReaderReadEscape (PlankJSONReaderRef p)
+{
+    PlankResult result;
+    PlankUI code, low;
+    char c;
+
+    result = PlankResult_OK;
+
+    switch (pl_JSONReaderGet (p))
+    {
+        case '"':  c = '"';  break;
+        case '\\': c = '\\'; break;
+        case '/':  c = '/';  break;
+        case 'b':  c = '\b'; break;
+        case 'f':  c = '\f'; break;
+        case 'n':  c = '\n'; break;
+        case 'r':  c = '\r'; break;
+        case 't':  c = '\t'; break;
+        case 'u':
+            if ((result = pl_JSONReaderReadHex (p, &code)) != PlankResult_OK) goto exit;
+
+            if ((code >= 0xD800) && (code <= 0xDBFF))
+            {
+                if ((pl_JSONReaderGet (p) != '\\') || (pl_JSONReaderGet (p) != 'u'))
+                {
+                    result = PlankResult_JSONError;
+                    goto exit;
+                }
+
+                if ((result = pl_JSONReaderReadHex (p, &low)) != PlankResult_OK) goto exit;
+
+                if ((low < 0xDC00) || (low > 0xDFFF))
+                {
+                    result = PlankResult_JSONError;
+                    goto exit;
+                }
+
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            result = pl_JSONReaderAppendUTF8 (p, code);
+            goto exit;
+        default:
+            result = PlankResult_JSONError;
+            goto exit;
+    }
+
+    result = pl_JSONReaderAppendText (p, &c, 1);
+
+exit:
+    return result;
+}
+
+// reads the remainder of a string after the opening quote into the text array
+static PlankResult pl_JSONReaderReadString (PlankJSONReaderRef p)
+{
+    PlankResult result;
+    const char* start;
+    const char* end;
+    const char* ptr;
+    char terminator;
+
+    if ((result = pl_DynamicArray_SetSize (&p->text, 0)) != PlankResult_OK) goto exit;
+
+    for (;;)
+    {
+        if (pl_JSONReaderPeek (p) < 0)
+        {
+            result = PlankResult_JSONError;
+            goto exit;
+        }
+
+        start = p->buffer + p->bufferPosition;
+        end = p->buffer + p->bufferLength;
+        ptr = start;
+
+        while ((ptr < end) && (*ptr != '"') && (*ptr != '\\'))
+            ++ptr;
+
+        if ((result = pl_JSONReaderAppendText (p, start, ptr - start)) != PlankResult_OK) goto exit;
+
+        p->bufferPosition = (int)(ptr - p->buffer);
+
+        if (ptr < end)
+        {
+            p->bufferPosition++;
+
+            if (*ptr == '"')
+                break;
+
+            if ((result = pl_JSONReaderReadEscape (p)) != PlankResult_OK) goto exit;
+        }
+    }
+
+    // keep a terminator past the end so the text can be returned as a C string
+    terminator = '\0';
+    if ((result = pl_DynamicArray_AddItem (&p->text, &terminator)) != PlankResult_OK) goto exit;
+    result = pl_DynamicArray_SetSize (&p->text, pl_DynamicArray_GetSize (&p->text) - 1);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderReadNumber (PlankJSONReaderRef p, PlankJSONToken* token)
+{
+    char number[PLANK_JSONSTREAM_MAXIMUMNUMBERLENGTH];
+    char* end;
+    int c, length, i;
+    PlankB isReal, isNegative;
+    PlankULL value, limit, digit;
+
+    length = 0;
+    isReal = PLANK_FALSE;
+
+    while (((c = pl_JSONReaderPeek (p)) >= 0) &&
+           (((c >= '0') && (c <= '9')) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E')))
+    {
+        if (length == (PLANK_JSONSTREAM_MAXIMUMNUMBERLENGTH - 1))
+            return PlankResult_JSONError;
+
+        if ((c == '.') || (c == 'e') || (c == 'E'))
+            isReal = PLANK_TRUE;
+
+        number[length++] = (char)c;
+        p->bufferPosition++;
+    }
+
+    number[length] = '\0';
+
+    isNegative = number[0] == '-';
+    i = isNegative ? 1 : 0;
+
+    if ((length == i) || (number[i] < '0') || (number[i] > '9'))
+        return PlankResult_JSONError;
+
+    if (!isReal)
+    {
+        value = 0;
+        limit = isNegative ? (PlankULL)PLANK_LL_MAX + 1 : (PlankULL)PLANK_LL_MAX;
+
+        for (; i < length; ++i)
+        {
+            if ((number[i] < '0') || (number[i] > '9'))
+                return PlankResult_JSONError;
+
+            digit = (PlankULL)(number[i] - '0');
+
+            // anything too large for 64 bits is read as a real
+            if (value > ((limit - digit) / 10))
+            {
+                isReal = PLANK_TRUE;
+                break;
+            }
+
+            value = value * 10 + digit;
+        }
+    }
+
+    if (!isReal)
+    {
+        p->intValue = isNegative ? (PlankLL)((PlankULL)0 - value) : (PlankLL)value;
+        p->doubleValue = (double)p->intValue;
+        *token = PlankJSONToken_Int;
+    }
+    else
+    {
+        p->doubleValue = strtod (number, &end);
+
+        if (*end != '\0')
+            return PlankResult_JSONError;
+
+        p->intValue = (PlankLL)p->doubleValue;
+        *token = PlankJSONToken_Double;
+    }
+
+    return PlankResult_OK;
+}
+
+static PlankResult pl_JSONReaderReadLiteral (PlankJSONReaderRef p, const char* literal)
+{
+    while (*literal != '\0')
+    {
+        if (pl_JSONReaderGet (p) != *literal++)
+            return PlankResult_JSONError;
+    }
+
+    return PlankResult_OK;
+}
+
+static PLANK_INLINE_LOW void pl_JSONReaderEndValue (PlankJSONReaderRef p)
+{
+    if (p->depth == 0)
+        p->state = PLANK_JSONREADER_DONE;
+    else if (p->containers[p->depth - 1] == PLANK_JSONSTREAM_OBJECT)
+        p->state = PLANK_JSONREADER_OBJECTNEXT;
+    else
+        p->state = PLANK_JSONREADER_ARRAYNEXT;
+}
+
+// moves past any separator so the next character starts a value
+static PlankResult pl_JSONReaderBeginValue (PlankJSONReaderRef p)
+{
+    PlankResult result;
+    int c;
+
+    result = PlankResult_OK;
+    c = pl_JSONReaderSkipWhitespace (p);
+
+    switch (p->state)
+    {
+        case PLANK_JSONREADER_START:
+        case PLANK_JSONREADER_OBJECTVALUE:
+        case PLANK_JSONREADER_ARRAYVALUE:
+            break;
+        case PLANK_JSONREADER_ARRAYFIRST:
+            if (c == ']')
+                result = PlankResult_JSONError;
+            break;
+        case PLANK_JSONREADER_ARRAYNEXT:
+            if (c != ',')
+            {
+                result = PlankResult_JSONError;
+                goto exit;
+            }
+
+            p->bufferPosition++;
+            p->state = PLANK_JSONREADER_ARRAYVALUE;
+            pl_JSONReaderSkipWhitespace (p);
+            break;
+        default:
+            result = PlankResult_JSONError;
+    }
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderBeginContainer (PlankJSONReaderRef p, const PlankUC type)
+{
+    if (p->depth == PLANK_JSONSTREAM_MAXIMUMDEPTH)
+        return PlankResult_JSONError;
+
+    p->bufferPosition++;
+    p->containers[p->depth++] = type;
+    p->state = (type == PLANK_JSONSTREAM_OBJECT) ? PLANK_JSONREADER_OBJECTFIRST : PLANK_JSONREADER_ARRAYFIRST;
+
+    return PlankResult_OK;
+}
+
+static PlankResult pl_JSONReaderReadValue (PlankJSONReaderRef p, PlankJSONToken* token)
+{
+    PlankResult result;
+    int c;
+
+    result = PlankResult_OK;
+    c = pl_JSONReaderPeek (p);
+
+    switch (c)
+    {
+        case '{':
+            result = pl_JSONReaderBeginContainer (p, PLANK_JSONSTREAM_OBJECT);
+            *token = PlankJSONToken_ObjectBegin;
+            goto exit;
+        case '[':
+            result = pl_JSONReaderBeginContainer (p, PLANK_JSONSTREAM_ARRAY);
+            *token = PlankJSONToken_ArrayBegin;
+            goto exit;
+        case '"':
+            p->bufferPosition++;
+            result = pl_JSONReaderReadString (p);
+            *token = PlankJSONToken_String;
+            break;
+        case 't':
+            result = pl_JSONReaderReadLiteral (p, "true");
+            *token = PlankJSONToken_True;
+            break;
+        case 'f':
+            result = pl_JSONReaderReadLiteral (p, "false");
+            *token = PlankJSONToken_False;
+            break;
+        case 'n':
+            result = pl_JSONReaderReadLiteral (p, "null");
+            *token = PlankJSONToken_Null;
+            break;
+        default:
+            if ((c == '-') || ((c >= '0') && (c <= '9')))
+                result = pl_JSONReaderReadNumber (p, token);
+            else
+                result = PlankResult_JSONError;
+    }
+
+    if (result == PlankResult_OK)
+        pl_JSONReaderEndValue (p);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONReader_Init (PlankJSONReaderRef p)
+{
+    if (p == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    pl_MemoryZero (p, sizeof (PlankJSONReader));
+
+    return pl_DynamicArray_InitWithItemSize (&p->text, 1);
+}
+
+PlankResult pl_JSONReader_DeInit (PlankJSONReaderRef p)
+{
+    if (p == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    return pl_DynamicArray_DeInit (&p->text);
+}
+
+PlankResult pl_JSONReader_Open (PlankJSONReaderRef p, PlankFileRef file)
+{
+    PlankResult result;
+    int fileMode;
+
+    if ((result = pl_File_GetMode (file, &fileMode)) != PlankResult_OK) goto exit;
+
+    if (!(fileMode & PLANKFILE_READ) || !(fileMode & PLANKFILE_BINARY))
+    {
+        result = PlankResult_JSONFileError;
+        goto exit;
+    }
+
+    p->file = file;
+    p->token = PlankJSONToken_None;
+    p->state = PLANK_JSONREADER_START;
+    p->depth = 0;
+    p->bufferPosition = 0;
+    p->bufferLength = 0;
+    p->isEOF = PLANK_FALSE;
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONReader_Next (PlankJSONReaderRef p, PlankJSONToken* token)
+{
+    PlankResult result;
+    int c;
+
+    result = PlankResult_OK;
+    *token = PlankJSONToken_None;
+
+    if (p->file == PLANK_NULL)
+    {
+        result = PlankResult_JSONFileError;
+        goto exit;
+    }
+
+    c = pl_JSONReaderSkipWhitespace (p);
+
+    switch (p->state)
+    {
+        case PLANK_JSONREADER_DONE:
+            if (c >= 0)
+                result = PlankResult_JSONError;
+            else
+                *token = PlankJSONToken_End;
+
+            goto exit;
+
+        case PLANK_JSONREADER_OBJECTFIRST:
+        case PLANK_JSONREADER_OBJECTNEXT:
+        case PLANK_JSONREADER_OBJECTKEY:
+            if ((c == '}') && (p->state != PLANK_JSONREADER_OBJECTKEY))
+            {
+                p->bufferPosition++;
+                p->depth--;
+                pl_JSONReaderEndValue (p);
+                *token = PlankJSONToken_ObjectEnd;
+                goto exit;
+            }
+
+            if (p->state == PLANK_JSONREADER_OBJECTNEXT)
+            {
+                if (c != ',')
+                {
+                    result = PlankResult_JSONError;
+                    goto exit;
+                }
+
+                p->bufferPosition++;
+                p->state = PLANK_JSONREADER_OBJECTKEY;
+                c = pl_JSONReaderSkipWhitespace (p);
+            }
+
+            if (c != '"')
+            {
+                result = PlankResult_JSONError;
+                goto exit;
+            }
+
+            p->bufferPosition++;
+
+            if ((result = pl_JSONReaderReadString (p)) != PlankResult_OK) goto exit;
+            if ((result = pl_JSONReaderExpect (p, ':')) != PlankResult_OK) goto exit;
+
+            p->state = PLANK_JSONREADER_OBJECTVALUE;
+            *token = PlankJSONToken_Key;
+            goto exit;
+
+        case PLANK_JSONREADER_ARRAYFIRST:
+        case PLANK_JSONREADER_ARRAYNEXT:
+            if (c == ']')
+            {
+                p->bufferPosition++;
+                p->depth--;
+                pl_JSONReaderEndValue (p);
+                *token = PlankJSONToken_ArrayEnd;
+                goto exit;
+            }
+
+            break;
+        default:
+            break;
+    }
+
+    if ((result = pl_JSONReaderBeginValue (p)) != PlankResult_OK) goto exit;
+    result = pl_JSONReaderReadValue (p, token);
+
+exit:
+    p->token = *token;
+    return result;
+}
+
+PlankJSONToken pl_JSONReader_GetToken (PlankJSONReaderRef p)
+{
+    return p->token;
+}
+
+const char* pl_JSONReader_GetString (PlankJSONReaderRef p)
+{
+    return ((p->token == PlankJSONToken_Key) || (p->token == PlankJSONToken_String)) ? (const char*)pl_DynamicArray_GetArray (&p->text) : "";
+}
+
+PlankL pl_JSONReader_GetStringLength (PlankJSONReaderRef p)
+{
+    return ((p->token == PlankJSONToken_Key) || (p->token == PlankJSONToken_String)) ? pl_DynamicArray_GetSize (&p->text) : 0;
+}
+
+PlankLL pl_JSONReader_GetInt (PlankJSONReaderRef p)
+{
+    return p->intValue;
+}
+
+double pl_JSONReader_GetDouble (PlankJSONReaderRef p)
+{
+    return p->doubleValue;
+}
+
+int pl_JSONReader_GetDepth (PlankJSONReaderRef p)
+{
+    return p->depth;
+}
+
+PlankResult pl_JSONReader_SkipValue (PlankJSONReaderRef p)
+{
+    PlankResult result;
+    PlankJSONToken token;
+    int depth;
+
+    if ((result = pl_JSONReader_Next (p, &token)) != PlankResult_OK) goto exit;
+
+    switch (token)
+    {
+        case PlankJSONToken_ObjectBegin:
+        case PlankJSONToken_ArrayBegin:
+            depth = p->depth - 1;
+
+            while (p->depth > depth)
+            {
+                if ((result = pl_JSONReader_Next (p, &token)) != PlankResult_OK) goto exit;
+            }
+
+            break;
+        case PlankJSONToken_ObjectEnd:
+        case PlankJSONToken_ArrayEnd:
+        case PlankJSONToken_Key:
+        case PlankJSONToken_End:
+            result = PlankResult_JSONError;
+            break;
+        default:
+            break;
+    }
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONReader_Parse (PlankJSONReaderRef p, PlankJSONReaderFunction function, PlankP userData)
+{
+    PlankResult result;
+    PlankJSONToken token;
+
+    do
+    {
+        if ((result = pl_JSONReader_Next (p, &token)) != PlankResult_OK) goto exit;
+        if ((result = (function) (p, token, userData)) != PlankResult_OK) goto exit;
+    } while (token != PlankJSONToken_End);
+
+exit:
+    return result;
+}
+
+//
+
+static PlankResult pl_JSONReaderSinkReserve (PlankJSONReaderSink* sink, const PlankL numBytes)
+{
+    PlankResult result;
+    PlankL required, itemSize, numItems;
+
+    result = PlankResult_OK;
+    required = sink->length + numBytes;
+
+    if (required <= sink->capacity)
+        goto exit;
+
+    if (sink->array == PLANK_NULL)
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+
+    // grow geometrically, the dynamic array itself only grows by a fixed amount
+    itemSize = pl_DynamicArray_GetItemSize (sink->array);
+    numItems = (pl_MaxL (required, sink->capacity * 2) + itemSize - 1) / itemSize;
+
+    if ((result = pl_DynamicArray_EnsureSize (sink->array, numItems)) != PlankResult_OK) goto exit;
+
+    sink->data = (PlankUC*)pl_DynamicArray_GetArray (sink->array);
+    sink->capacity = numItems * itemSize;
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderSinkInflate (PlankJSONReaderSink* sink, const PlankUC* data, const PlankL length)
+{
+    PlankResult result;
+    z_stream* zip;
+    int ret;
+
+    result = PlankResult_OK;
+    zip = sink->zip;
+    zip->next_in = (Bytef*)data;
+    zip->avail_in = (uInt)length;
+
+    while ((zip->avail_in > 0) && !sink->isZipEnd)
+    {
+        if ((sink->length == sink->capacity) && (sink->array != PLANK_NULL))
+        {
+            if ((result = pl_JSONReaderSinkReserve (sink, PLANK_JSONSTREAM_WINDOWSIZE * 4)) != PlankResult_OK)
+                goto exit;
+        }
+
+        // a full fixed buffer still gets a call so zlib can consume the stream trailer
+        zip->next_out = sink->data + sink->length;
+        zip->avail_out = (uInt)(sink->capacity - sink->length);
+
+        ret = inflate (zip, Z_NO_FLUSH);
+
+        sink->length = sink->capacity - zip->avail_out;
+
+        if (ret == Z_STREAM_END)
+        {
+            sink->isZipEnd = PLANK_TRUE;
+        }
+        else if (ret == Z_BUF_ERROR)
+        {
+            result = zip->avail_out == 0 ? PlankResult_ItemCountInvalid : PlankResult_ZipError;
+            goto exit;
+        }
+        else if (ret != Z_OK)
+        {
+            result = PlankResult_ZipError;
+            goto exit;
+        }
+    }
+
+exit:
+    return result;
+}
+
+// decodes whole groups of base64 text, straight into the sink or through the window into zlib
+static PlankResult pl_JSONReaderSinkDecode (PlankJSONReaderRef p, PlankJSONReaderSink* sink, const char* text, PlankL textLength)
+{
+    PlankResult result;
+    PlankL numBytes, binaryLength, textUsed, chunkLength;
+
+    result = PlankResult_OK;
+
+    if (textLength == 0)
+        goto exit;
+
+    if (sink->zip == PLANK_NULL)
+    {
+        numBytes = textLength / 4 * 3;
+
+        if (text[textLength - 1] == '=')
+            numBytes -= (text[textLength - 2] == '=') ? 2 : 1;
+
+        if ((result = pl_JSONReaderSinkReserve (sink, numBytes)) != PlankResult_OK) goto exit;
+        if ((result = pl_Base64_DecodeBlock (sink->data + sink->length, &binaryLength, text, textLength, &textUsed)) != PlankResult_OK) goto exit;
+
+        sink->length += binaryLength;
+
+        if (textUsed != textLength)
+            result = PlankResult_JSONError;
+    }
+    else
+    {
+        while (textLength > 0)
+        {
+            chunkLength = pl_MinL (textLength, PLANK_JSONSTREAM_WINDOWSIZE / 3 * 4);
+
+            if ((result = pl_Base64_DecodeBlock (p->window, &binaryLength, text, chunkLength, &textUsed)) != PlankResult_OK) goto exit;
+
+            if (textUsed != chunkLength)
+            {
+                result = PlankResult_JSONError;
+                goto exit;
+            }
+
+            if ((result = pl_JSONReaderSinkInflate (sink, p->window, binaryLength)) != PlankResult_OK) goto exit;
+
+            text += chunkLength;
+            textLength -= chunkLength;
+        }
+    }
+
+exit:
+    return result;
+}
+
+// decodes the remainder of a base64 string after the opening quote directly from the file buffer,
+// only groups split across buffer reads or by escapes are gathered first
+static PlankResult pl_JSONReaderDecodeString (PlankJSONReaderRef p, PlankJSONReaderSink* sink)
+{
+    PlankResult result;
+    const char* start;
+    const char* end;
+    const char* ptr;
+    char group[4];
+    PlankL runLength, numChars;
+    int groupLength;
+
+    result = PlankResult_OK;
+    groupLength = 0;
+
+    for (;;)
+    {
+        if (pl_JSONReaderPeek (p) < 0)
+        {
+            result = PlankResult_JSONError;
+            goto exit;
+        }
+
+        start = p->buffer + p->bufferPosition;
+        end = p->buffer + p->bufferLength;
+        ptr = start;
+
+        while ((ptr < end) && (*ptr != '"') && (*ptr != '\\'))
+            ++ptr;
+
+        runLength = ptr - start;
+
+        if (groupLength > 0)
+        {
+            numChars = pl_MinL (4 - groupLength, runLength);
+            pl_MemoryCopy (group + groupLength, start, numChars);
+            groupLength += (int)numChars;
+            start += numChars;
+            runLength -= numChars;
+
+            if (groupLength == 4)
+            {
+                if ((result = pl_JSONReaderSinkDecode (p, sink, group, 4)) != PlankResult_OK) goto exit;
+                groupLength = 0;
+            }
+        }
+
+        numChars = runLength & ~(PlankL)3;
+
+        if ((result = pl_JSONReaderSinkDecode (p, sink, start, numChars)) != PlankResult_OK) goto exit;
+
+        pl_MemoryCopy (group + groupLength, start + numChars, runLength - numChars);
+        groupLength += (int)(runLength - numChars);
+
+        p->bufferPosition = (int)(ptr - p->buffer);
+
+        if (ptr < end)
+        {
+            p->bufferPosition++;
+
+            if (*ptr == '"')
+                break;
+
+            // only an escaped slash can appear in base64 text
+            if (pl_JSONReaderGet (p) != '/')
+            {
+                result = PlankResult_JSONError;
+                goto exit;
+            }
+
+            group[groupLength++] = '/';
+
+            if (groupLength == 4)
+            {
+                if ((result = pl_JSONReaderSinkDecode (p, sink, group, 4)) != PlankResult_OK) goto exit;
+                groupLength = 0;
+            }
+        }
+    }
+
+    if (groupLength != 0)
+        result = PlankResult_JSONError;
+
+exit:
+    return result;
+}
+
+// decodes an encoded string or an array of encoded strings
+static PlankResult pl_JSONReaderDecodeValue (PlankJSONReaderRef p, PlankJSONReaderSink* sink)
+{
+    PlankResult result;
+    int c;
+
+    c = pl_JSONReaderSkipWhitespace (p);
+    p->bufferPosition++;
+
+    if (c == '"')
+    {
+        result = pl_JSONReaderDecodeString (p, sink);
+    }
+    else if (c == '[')
+    {
+        c = pl_JSONReaderSkipWhitespace (p);
+
+        if (c == ']')
+        {
+            p->bufferPosition++;
+            result = PlankResult_OK;
+            goto exit;
+        }
+
+        do
+        {
+            if ((result = pl_JSONReaderExpect (p, '"')) != PlankResult_OK) goto exit;
+            if ((result = pl_JSONReaderDecodeString (p, sink)) != PlankResult_OK) goto exit;
+
+            c = pl_JSONReaderSkipWhitespace (p);
+            p->bufferPosition++;
+        } while (c == ',');
+
+        if (c != ']')
+            result = PlankResult_JSONError;
+    }
+    else
+    {
+        result = PlankResult_JSONError;
+    }
+
+exit:
+    return result;
+}
+
+// reads {"key": encoded} after the opening brace, the key determines if the data is compressed
+static PlankResult pl_JSONReaderReadEncoded (PlankJSONReaderRef p, PlankJSONReaderSink* sink, const char* binaryKey, const char* compressedKey)
+{
+    PlankResult result;
+    z_stream zip;
+    const char* key;
+    int ret;
+
+    if ((result = pl_JSONReaderExpect (p, '"')) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONReaderReadString (p)) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONReaderExpect (p, ':')) != PlankResult_OK) goto exit;
+
+    key = (const char*)pl_DynamicArray_GetArray (&p->text);
+
+    if (strcmp (key, binaryKey) == 0)
+    {
+        result = pl_JSONReaderDecodeValue (p, sink);
+    }
+    else if ((compressedKey != PLANK_NULL) && (strcmp (key, compressedKey) == 0))
+    {
+        pl_MemoryZero (&zip, sizeof (zip));
+
+        if ((ret = inflateInit (&zip)) != Z_OK)
+        {
+            result = PlankResult_ZipError;
+            goto exit;
+        }
+
+        sink->zip = &zip;
+        sink->isZipEnd = PLANK_FALSE;
+        result = pl_JSONReaderDecodeValue (p, sink);
+        sink->zip = PLANK_NULL;
+
+        if ((result == PlankResult_OK) && !sink->isZipEnd)
+            result = PlankResult_ZipError;
+
+        (void)inflateEnd (&zip);
+    }
+    else
+    {
+        result = PlankResult_JSONError;
+    }
+
+    if (result != PlankResult_OK)
+        goto exit;
+
+    result = pl_JSONReaderExpect (p, '}');
+
+exit:
+    return result;
+}
+
+static PLANK_INLINE_LOW void pl_JSONReaderStoreNumber (PlankJSONReaderRef p, PlankUC* data, const int type)
+{
+    switch (type)
+    {
+        case PLANK_JSONSTREAM_INT:      *(PlankLL*)data = p->intValue;              break;
+        case PLANK_JSONSTREAM_FLOAT:    *(float*)data = (float)p->doubleValue;      break;
+        case PLANK_JSONSTREAM_DOUBLE:   *(double*)data = p->doubleValue;            break;
+    }
+}
+
+// reads a plain array of numbers after the opening bracket
+static PlankResult pl_JSONReaderReadPlain (PlankJSONReaderRef p, PlankJSONReaderSink* sink, const int type, const PlankL itemSize)
+{
+    PlankResult result;
+    PlankJSONToken token;
+    int c;
+
+    result = PlankResult_OK;
+    c = pl_JSONReaderSkipWhitespace (p);
+
+    if (c == ']')
+    {
+        p->bufferPosition++;
+        goto exit;
+    }
+
+    do
+    {
+        pl_JSONReaderSkipWhitespace (p);
+
+        if ((result = pl_JSONReaderReadNumber (p, &token)) != PlankResult_OK) goto exit;
+        if ((result = pl_JSONReaderSinkReserve (sink, itemSize)) != PlankResult_OK) goto exit;
+
+        pl_JSONReaderStoreNumber (p, sink->data + sink->length, type);
+        sink->length += itemSize;
+
+        c = pl_JSONReaderSkipWhitespace (p);
+        p->bufferPosition++;
+    } while (c == ',');
+
+    if (c != ']')
+        result = PlankResult_JSONError;
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderReadArray (PlankJSONReaderRef p, PlankJSONReaderSink* sink, const int type, const PlankL itemSize, const char* binaryKey, const char* compressedKey)
+{
+    PlankResult result;
+    int c;
+
+    if ((result = pl_JSONReaderBeginValue (p)) != PlankResult_OK) goto exit;
+
+    c = pl_JSONReaderPeek (p);
+    p->bufferPosition++;
+
+    if (c == '[')
+        result = pl_JSONReaderReadPlain (p, sink, type, itemSize);
+    else if (c == '{')
+        result = pl_JSONReaderReadEncoded (p, sink, binaryKey, compressedKey);
+    else
+        result = PlankResult_JSONError;
+
+    if (result != PlankResult_OK)
+        goto exit;
+
+    if ((sink->length % itemSize) != 0)
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    p->token = PlankJSONToken_None;
+    pl_JSONReaderEndValue (p);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderReadArrayDynamic (PlankJSONReaderRef p, PlankDynamicArrayRef array, const int type, const PlankL itemSize, const char* binaryKey, const char* compressedKey)
+{
+    PlankResult result;
+    PlankJSONReaderSink sink;
+
+    if (pl_DynamicArray_GetItemSize (array) == 0)
+    {
+        if ((result = pl_DynamicArray_InitWithItemSize (array, itemSize)) != PlankResult_OK)
+            goto exit;
+    }
+    else if (pl_DynamicArray_GetItemSize (array) != itemSize)
+    {
+        result = PlankResult_ArrayParameterError;
+        goto exit;
+    }
+
+    pl_MemoryZero (&sink, sizeof (sink));
+    sink.array = array;
+
+    if ((result = pl_JSONReaderReadArray (p, &sink, type, itemSize, binaryKey, compressedKey)) != PlankResult_OK) goto exit;
+
+    result = pl_DynamicArray_SetSize (array, sink.length / itemSize);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONReaderReadArrayInto (PlankJSONReaderRef p, void* values, const PlankL capacity, PlankL* count, const int type, const PlankL itemSize, const char* binaryKey, const char* compressedKey)
+{
+    PlankResult result;
+    PlankJSONReaderSink sink;
+
+    pl_MemoryZero (&sink, sizeof (sink));
+    sink.data = (PlankUC*)values;
+    sink.capacity = capacity * itemSize;
+
+    result = pl_JSONReaderReadArray (p, &sink, type, itemSize, binaryKey, compressedKey);
+    *count = sink.length / itemSize;
+
+    return result;
+}
+
+PlankResult pl_JSONReader_ReadIntArray (PlankJSONReaderRef p, PlankDynamicArrayRef array)
+{
+    return pl_JSONReaderReadArrayDynamic (p, array, PLANK_JSONSTREAM_INT, sizeof (PlankLL), PLANK_JSON_INTARRAYBINARY, PLANK_JSON_INTARRAYCOMPRESSED);
+}
+
+PlankResult pl_JSONReader_ReadFloatArray (PlankJSONReaderRef p, PlankDynamicArrayRef array)
+{
+    return pl_JSONReaderReadArrayDynamic (p, array, PLANK_JSONSTREAM_FLOAT, sizeof (float), PLANK_JSON_FLOATARRAYBINARY, PLANK_JSON_FLOATARRAYCOMPRESSED);
+}
+
+PlankResult pl_JSONReader_ReadDoubleArray (PlankJSONReaderRef p, PlankDynamicArrayRef array)
+{
+    return pl_JSONReaderReadArrayDynamic (p, array, PLANK_JSONSTREAM_DOUBLE, sizeof (double), PLANK_JSON_DOUBLEARRAYBINARY, PLANK_JSON_DOUBLEARRAYCOMPRESSED);
+}
+
+PlankResult pl_JSONReader_ReadIntArrayInto (PlankJSONReaderRef p, PlankLL* values, const PlankL capacity, PlankL* count)
+{
+    return pl_JSONReaderReadArrayInto (p, values, capacity, count, PLANK_JSONSTREAM_INT, sizeof (PlankLL), PLANK_JSON_INTARRAYBINARY, PLANK_JSON_INTARRAYCOMPRESSED);
+}
+
+PlankResult pl_JSONReader_ReadFloatArrayInto (PlankJSONReaderRef p, float* values, const PlankL capacity, PlankL* count)
+{
+    return pl_JSONReaderReadArrayInto (p, values, capacity, count, PLANK_JSONSTREAM_FLOAT, sizeof (float), PLANK_JSON_FLOATARRAYBINARY, PLANK_JSON_FLOATARRAYCOMPRESSED);
+}
+
+PlankResult pl_JSONReader_ReadDoubleArrayInto (PlankJSONReaderRef p, double* values, const PlankL capacity, PlankL* count)
+{
+    return pl_JSONReaderReadArrayInto (p, values, capacity, count, PLANK_JSONSTREAM_DOUBLE, sizeof (double), PLANK_JSON_DOUBLEARRAYBINARY, PLANK_JSON_DOUBLEARRAYCOMPRESSED);
+}
+
+static PlankResult pl_JSONReaderReadScalar (PlankJSONReaderRef p, void* value, const int type, const PlankL itemSize, const char* binaryKey)
+{
+    PlankResult result;
+    PlankJSONReaderSink sink;
+    PlankJSONToken token;
+    int c;
+
+    if ((result = pl_JSONReaderBeginValue (p)) != PlankResult_OK) goto exit;
+
+    c = pl_JSONReaderPeek (p);
+
+    if (c == '{')
+    {
+        p->bufferPosition++;
+        pl_MemoryZero (&sink, sizeof (sink));
+        sink.data = (PlankUC*)value;
+        sink.capacity = itemSize;
+
+        if ((result = pl_JSONReaderReadEncoded (p, &sink, binaryKey, PLANK_NULL)) != PlankResult_OK) goto exit;
+
+        if (sink.length != itemSize)
+        {
+            result = PlankResult_JSONError;
+            goto exit;
+        }
+    }
+    else
+    {
+        if ((result = pl_JSONReaderReadNumber (p, &token)) != PlankResult_OK) goto exit;
+        pl_JSONReaderStoreNumber (p, (PlankUC*)value, type);
+    }
+
+    p->token = PlankJSONToken_None;
+    pl_JSONReaderEndValue (p);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONReader_ReadInt (PlankJSONReaderRef p, PlankLL* value)
+{
+    return pl_JSONReaderReadScalar (p, value, PLANK_JSONSTREAM_INT, sizeof (PlankLL), PLANK_JSON_INTBINARY);
+}
+
+PlankResult pl_JSONReader_ReadFloat (PlankJSONReaderRef p, float* value)
+{
+    return pl_JSONReaderReadScalar (p, value, PLANK_JSONSTREAM_FLOAT, sizeof (float), PLANK_JSON_FLOATBINARY);
+}
+
+PlankResult pl_JSONReader_ReadDouble (PlankJSONReaderRef p, double* value)
+{
+    return pl_JSONReaderReadScalar (p, value, PLANK_JSONSTREAM_DOUBLE, sizeof (double), PLANK_JSON_DOUBLEBINARY);
+}
+
+//
+
+static PlankResult pl_JSONWriterWrite (PlankJSONWriterRef p, const char* data, PlankL length)
+{
+    PlankResult result;
+    PlankL numBytes;
+
+    result = PlankResult_OK;
+
+    while (length > 0)
+    {
+        numBytes = pl_MinL (length, PLANK_JSONSTREAM_BUFFERSIZE - p->bufferPosition);
+        pl_MemoryCopy (p->buffer + p->bufferPosition, data, numBytes);
+        p->bufferPosition += (int)numBytes;
+        data += numBytes;
+        length -= numBytes;
+
+        if (p->bufferPosition == PLANK_JSONSTREAM_BUFFERSIZE)
+        {
+            if ((result = pl_JSONWriter_Flush (p)) != PlankResult_OK)
+                goto exit;
+        }
+    }
+
+exit:
+    return result;
+}
+
+static PLANK_INLINE_LOW PlankResult pl_JSONWriterWriteC (PlankJSONWriterRef p, const char c)
+{
+    if (p->bufferPosition == PLANK_JSONSTREAM_BUFFERSIZE)
+    {
+        PlankResult result;
+
+        if ((result = pl_JSONWriter_Flush (p)) != PlankResult_OK)
+            return result;
+    }
+
+    p->buffer[p->bufferPosition++] = c;
+    return PlankResult_OK;
+}
+
+static PlankResult pl_JSONWriterNewLine (PlankJSONWriterRef p, const int depth)
+{
+    PlankResult result;
+    int i, numSpaces;
+
+    result = PlankResult_OK;
+    numSpaces = PLANK_JSON_INDENT (p->flags) * depth;
+
+    if (PLANK_JSON_INDENT (p->flags) == 0)
+        goto exit;
+
+    if ((result = pl_JSONWriterWriteC (p, '\n')) != PlankResult_OK) goto exit;
+
+    for (i = 0; i < numSpaces; ++i)
+    {
+        if ((result = pl_JSONWriterWriteC (p, ' ')) != PlankResult_OK) goto exit;
+    }
+
+exit:
+    return result;
+}
+
+// writes the separator before a key in an object or a value in an array
+static PlankResult pl_JSONWriterBeginItem (PlankJSONWriterRef p, const PlankB isKey)
+{
+    PlankResult result;
+    PlankUC* container;
+
+    result = PlankResult_OK;
+
+    if (p->file == PLANK_NULL)
+    {
+        result = PlankResult_JSONFileError;
+        goto exit;
+    }
+
+    if (p->isAfterKey)
+    {
+        if (isKey)
+            result = PlankResult_JSONError;
+        else
+            p->isAfterKey = PLANK_FALSE;
+
+        goto exit;
+    }
+
+    if (p->depth == 0)
+    {
+        if (isKey)
+            result = PlankResult_JSONError;
+
+        goto exit;
+    }
+
+    container = &p->containers[p->depth - 1];
+
+    if (((*container & PLANK_JSONSTREAM_OBJECT) != 0) != (isKey != 0))
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    if (*container & PLANK_JSONSTREAM_HASITEMS)
+    {
+        if ((result = pl_JSONWriterWriteC (p, ',')) != PlankResult_OK) goto exit;
+
+        if (!PLANK_JSON_INDENT (p->flags) && !(p->flags & PLANK_JSON_COMPACT))
+        {
+            if ((result = pl_JSONWriterWriteC (p, ' ')) != PlankResult_OK) goto exit;
+        }
+    }
+
+    *container |= PLANK_JSONSTREAM_HASITEMS;
+    result = pl_JSONWriterNewLine (p, p->depth);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterBeginContainer (PlankJSONWriterRef p, const PlankUC type, const char c)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+
+    if (p->depth == PLANK_JSONSTREAM_MAXIMUMDEPTH)
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    p->containers[p->depth++] = type;
+    result = pl_JSONWriterWriteC (p, c);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterEndContainer (PlankJSONWriterRef p, const PlankUC type, const char c)
+{
+    PlankResult result;
+    PlankUC container;
+
+    if ((p->depth == 0) || p->isAfterKey)
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    container = p->containers[p->depth - 1];
+
+    if ((container & type) == 0)
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    p->depth--;
+
+    if (container & PLANK_JSONSTREAM_HASITEMS)
+    {
+        if ((result = pl_JSONWriterNewLine (p, p->depth)) != PlankResult_OK) goto exit;
+    }
+
+    result = pl_JSONWriterWriteC (p, c);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterWriteString (PlankJSONWriterRef p, const char* string)
+{
+    PlankResult result;
+    const char* start;
+    char escape[8];
+    PlankUC c;
+
+    if ((result = pl_JSONWriterWriteC (p, '"')) != PlankResult_OK) goto exit;
+
+    for (;;)
+    {
+        start = string;
+
+        while (((c = (PlankUC)*string) >= 0x20) && (c != '"') && (c != '\\') && ((c != '/') || !(p->flags & PLANK_JSON_ESCAPE_SLASH)))
+            ++string;
+
+        if ((result = pl_JSONWriterWrite (p, start, string - start)) != PlankResult_OK) goto exit;
+
+        if (c == '\0')
+            break;
+
+        escape[0] = '\\';
+        escape[2] = '\0';
+
+        switch (c)
+        {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '/':  escape[1] = '/';  break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:   sprintf (escape, "\\u%04X", (unsigned int)c);
+        }
+
+        if ((result = pl_JSONWriterWrite (p, escape, strlen (escape))) != PlankResult_OK) goto exit;
+
+        ++string;
+    }
+
+    result = pl_JSONWriterWriteC (p, '"');
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterWriteReal (PlankJSONWriterRef p, const double value, const char* format)
+{
+    PlankResult result;
+    char text[32];
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+
+    if ((value != value) || ((value - value) != (value - value)))
+    {
+        result = PlankResult_JSONError;
+        goto exit;
+    }
+
+    sprintf (text, format, value);
+
+    // make sure reals are read back as reals
+    if ((strchr (text, '.') == PLANK_NULL) && (strchr (text, 'e') == PLANK_NULL))
+        strcat (text, ".0");
+
+    result = pl_JSONWriterWrite (p, text, strlen (text));
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_Init (PlankJSONWriterRef p)
+{
+    if (p == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    pl_MemoryZero (p, sizeof (PlankJSONWriter));
+
+    return PlankResult_OK;
+}
+
+PlankResult pl_JSONWriter_DeInit (PlankJSONWriterRef p)
+{
+    PlankResult result;
+
+    if (p == PLANK_NULL)
+        return PlankResult_MemoryError;
+
+    result = pl_JSONWriter_Flush (p);
+    p->file = PLANK_NULL;
+
+    return result;
+}
+
+PlankResult pl_JSONWriter_Open (PlankJSONWriterRef p, PlankFileRef file, const int flags)
+{
+    PlankResult result;
+    int fileMode;
+
+    if ((result = pl_File_GetMode (file, &fileMode)) != PlankResult_OK) goto exit;
+
+    if (!(fileMode & PLANKFILE_WRITE) || !(fileMode & PLANKFILE_BINARY))
+    {
+        result = PlankResult_JSONFileError;
+        goto exit;
+    }
+
+    p->file = file;
+    p->flags = flags;
+    p->depth = 0;
+    p->bufferPosition = 0;
+    p->isAfterKey = PLANK_FALSE;
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_Flush (PlankJSONWriterRef p)
+{
+    PlankResult result;
+
+    result = PlankResult_OK;
+
+    if ((p->file != PLANK_NULL) && (p->bufferPosition > 0))
+    {
+        result = pl_File_Write (p->file, p->buffer, p->bufferPosition);
+        p->bufferPosition = 0;
+    }
+
+    return result;
+}
+
+PlankResult pl_JSONWriter_BeginObject (PlankJSONWriterRef p)
+{
+    return pl_JSONWriterBeginContainer (p, PLANK_JSONSTREAM_OBJECT, '{');
+}
+
+PlankResult pl_JSONWriter_EndObject (PlankJSONWriterRef p)
+{
+    return pl_JSONWriterEndContainer (p, PLANK_JSONSTREAM_OBJECT, '}');
+}
+
+PlankResult pl_JSONWriter_BeginArray (PlankJSONWriterRef p)
+{
+    return pl_JSONWriterBeginContainer (p, PLANK_JSONSTREAM_ARRAY, '[');
+}
+
+PlankResult pl_JSONWriter_EndArray (PlankJSONWriterRef p)
+{
+    return pl_JSONWriterEndContainer (p, PLANK_JSONSTREAM_ARRAY, ']');
+}
+
+PlankResult pl_JSONWriter_Key (PlankJSONWriterRef p, const char* key)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONWriterWriteString (p, key)) != PlankResult_OK) goto exit;
+
+    if (p->flags & PLANK_JSON_COMPACT)
+        result = pl_JSONWriterWriteC (p, ':');
+    else
+        result = pl_JSONWriterWrite (p, ": ", 2);
+
+    p->isAfterKey = PLANK_TRUE;
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_String (PlankJSONWriterRef p, const char* string)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    result = pl_JSONWriterWriteString (p, string);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_Int (PlankJSONWriterRef p, const PlankLL value)
+{
+    PlankResult result;
+    char text[24];
+    PlankULL magnitude;
+    int position;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+
+    // formatted by hand as the printf format for 64-bit ints differs between platforms
+    magnitude = value < 0 ? (PlankULL)0 - (PlankULL)value : (PlankULL)value;
+    position = sizeof (text);
+
+    do
+    {
+        text[--position] = (char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+        text[--position] = '-';
+
+    result = pl_JSONWriterWrite (p, text + position, sizeof (text) - position);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_Float (PlankJSONWriterRef p, const float value)
+{
+    return pl_JSONWriterWriteReal (p, value, "%.9g");
+}
+
+PlankResult pl_JSONWriter_Double (PlankJSONWriterRef p, const double value)
+{
+    return pl_JSONWriterWriteReal (p, value, "%.17g");
+}
+
+PlankResult pl_JSONWriter_Bool (PlankJSONWriterRef p, const PlankB state)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    result = state ? pl_JSONWriterWrite (p, "true", 4) : pl_JSONWriterWrite (p, "false", 5);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_Null (PlankJSONWriterRef p)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    result = pl_JSONWriterWrite (p, "null", 4);
+
+exit:
+    return result;
+}
+
+//
+
+static PlankResult pl_JSONWriterEncodedBegin (PlankJSONWriterRef p, const char* key)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriter_BeginObject (p)) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONWriter_Key (p, key)) != PlankResult_OK) goto exit;
+
+    p->lineLength = 0;
+    p->isLineArray = PLANK_FALSE;
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterEncodedLine (PlankJSONWriterRef p)
+{
+    PlankResult result;
+
+    if ((result = pl_JSONWriterBeginItem (p, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONWriterWriteC (p, '"')) != PlankResult_OK) goto exit;
+    if ((result = pl_JSONWriterWrite (p, p->line, p->lineLength)) != PlankResult_OK) goto exit;
+
+    result = pl_JSONWriterWriteC (p, '"');
+    p->lineLength = 0;
+
+exit:
+    return result;
+}
+
+// splits the encoded text the same way as pl_JSON_StringSplit(), a single string if it fits
+// on one line otherwise an array of lines, so only the first line is held back
+static PlankResult pl_JSONWriterEncodedAppend (PlankJSONWriterRef p, const char* text, PlankL length)
+{
+    PlankResult result;
+    PlankL numChars;
+
+    result = PlankResult_OK;
+
+    while (length > 0)
+    {
+        if (p->lineLength == PLANK_JSON_ENCODEDSTRINGLENGTH)
+        {
+            if (!p->isLineArray)
+            {
+                if ((result = pl_JSONWriter_BeginArray (p)) != PlankResult_OK) goto exit;
+                p->isLineArray = PLANK_TRUE;
+            }
+
+            if ((result = pl_JSONWriterEncodedLine (p)) != PlankResult_OK) goto exit;
+        }
+
+        numChars = pl_MinL (length, PLANK_JSON_ENCODEDSTRINGLENGTH - p->lineLength);
+        pl_MemoryCopy (p->line + p->lineLength, text, numChars);
+        p->lineLength += (int)numChars;
+        text += numChars;
+        length -= numChars;
+    }
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterEncodedEnd (PlankJSONWriterRef p)
+{
+    PlankResult result;
+
+    if (p->isLineArray)
+    {
+        if (p->lineLength > 0)
+        {
+            if ((result = pl_JSONWriterEncodedLine (p)) != PlankResult_OK) goto exit;
+        }
+
+        if ((result = pl_JSONWriter_EndArray (p)) != PlankResult_OK) goto exit;
+    }
+    else
+    {
+        if ((result = pl_JSONWriterEncodedLine (p)) != PlankResult_OK) goto exit;
+    }
+
+    result = pl_JSONWriter_EndObject (p);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterBinary (PlankJSONWriterRef p, const char* key, const void* data, PlankL length)
+{
+    PlankResult result;
+    const PlankUC* binary;
+    PlankL numBytes, numChars;
+
+    binary = (const PlankUC*)data;
+
+    if ((result = pl_JSONWriterEncodedBegin (p, key)) != PlankResult_OK) goto exit;
+
+    // the window size is a multiple of 3 so only the last block can be padded
+    while (length > 0)
+    {
+        numBytes = pl_MinL (length, PLANK_JSONSTREAM_WINDOWSIZE);
+        numChars = pl_Base64_EncodeBlock (p->text, binary, numBytes);
+
+        if ((result = pl_JSONWriterEncodedAppend (p, p->text, numChars)) != PlankResult_OK) goto exit;
+
+        binary += numBytes;
+        length -= numBytes;
+    }
+
+    result = pl_JSONWriterEncodedEnd (p);
+
+exit:
+    return result;
+}
+
+static PlankResult pl_JSONWriterCompressed (PlankJSONWriterRef p, const char* key, const void* data, PlankL length)
+{
+    PlankResult result;
+    z_stream zip;
+    PlankL numBytes, numChars;
+    int ret;
+
+    pl_MemoryZero (&zip, sizeof (zip));
+
+    if ((ret = deflateInit (&zip, PLANK_JSON_COMPRESSIONLEVEL)) != Z_OK)
+    {
+        result = PlankResult_ZipError;
+        goto earlyExit;
+    }
+
+    if ((result = pl_JSONWriterEncodedBegin (p, key)) != PlankResult_OK) goto exit;
+
+    zip.next_in = (Bytef*)data;
+    zip.avail_in = (uInt)length;
+    zip.next_out = p->window;
+    zip.avail_out = PLANK_JSONSTREAM_WINDOWSIZE;
+
+    // deflate into the window and encode it each time it fills
+    do
+    {
+        ret = deflate (&zip, Z_FINISH);
+
+        if ((ret != Z_OK) && (ret != Z_STREAM_END))
+        {
+            result = PlankResult_ZipError;
+            goto exit;
+        }
+
+        if ((zip.avail_out == 0) || (ret == Z_STREAM_END))
+        {
+            numBytes = PLANK_JSONSTREAM_WINDOWSIZE - zip.avail_out;
+            numChars = pl_Base64_EncodeBlock (p->text, p->window, numBytes);
+
+            if ((result = pl_JSONWriterEncodedAppend (p, p->text, numChars)) != PlankResult_OK) goto exit;
+
+            zip.next_out = p->window;
+            zip.avail_out = PLANK_JSONSTREAM_WINDOWSIZE;
+        }
+    } while (ret != Z_STREAM_END);
+
+    result = pl_JSONWriterEncodedEnd (p);
+
+exit:
+    (void)deflateEnd (&zip);
+
+earlyExit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_IntBinary (PlankJSONWriterRef p, const PlankLL value)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_INTBINARY, &value, sizeof (value));
+}
+
+PlankResult pl_JSONWriter_FloatBinary (PlankJSONWriterRef p, const float value)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_FLOATBINARY, &value, sizeof (value));
+}
+
+PlankResult pl_JSONWriter_DoubleBinary (PlankJSONWriterRef p, const double value)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_DOUBLEBINARY, &value, sizeof (value));
+}
+
+PlankResult pl_JSONWriter_IntArrayBinary (PlankJSONWriterRef p, const PlankLL* values, const PlankL count)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_INTARRAYBINARY, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_FloatArrayBinary (PlankJSONWriterRef p, const float* values, const PlankL count)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_FLOATARRAYBINARY, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_DoubleArrayBinary (PlankJSONWriterRef p, const double* values, const PlankL count)
+{
+    return pl_JSONWriterBinary (p, PLANK_JSON_DOUBLEARRAYBINARY, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_IntArrayCompressed (PlankJSONWriterRef p, const PlankLL* values, const PlankL count)
+{
+    return pl_JSONWriterCompressed (p, PLANK_JSON_INTARRAYCOMPRESSED, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_FloatArrayCompressed (PlankJSONWriterRef p, const float* values, const PlankL count)
+{
+    return pl_JSONWriterCompressed (p, PLANK_JSON_FLOATARRAYCOMPRESSED, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_DoubleArrayCompressed (PlankJSONWriterRef p, const double* values, const PlankL count)
+{
+    return pl_JSONWriterCompressed (p, PLANK_JSON_DOUBLEARRAYCOMPRESSED, values, sizeof (values[0]) * count);
+}
+
+PlankResult pl_JSONWriter_IntArray (PlankJSONWriterRef p, const PlankLL* values, const PlankL count)
+{
+    PlankResult result;
+    PlankL i;
+
+    if ((result = pl_JSONWriter_BeginArray (p)) != PlankResult_OK) goto exit;
+
+    for (i = 0; i < count; ++i)
+    {
+        if ((result = pl_JSONWriter_Int (p, values[i])) != PlankResult_OK) goto exit;
+    }
+
+    result = pl_JSONWriter_EndArray (p);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_FloatArray (PlankJSONWriterRef p, const float* values, const PlankL count)
+{
+    PlankResult result;
+    PlankL i;
+
+    if ((result = pl_JSONWriter_BeginArray (p)) != PlankResult_OK) goto exit;
+
+    for (i = 0; i < count; ++i)
+    {
+        if ((result = pl_JSONWriter_Float (p, values[i])) != PlankResult_OK) goto exit;
+    }
+
+    result = pl_JSONWriter_EndArray (p);
+
+exit:
+    return result;
+}
+
+PlankResult pl_JSONWriter_DoubleArray (PlankJSONWriterRef p, const double* values, const PlankL count)
+{
+    PlankResult result;
+    PlankL i;
+
+    if ((result = pl_JSONWriter_BeginArray (p)) != PlankResult_OK) goto exit;
+
+    for (i = 0; i < count; ++i)
+    {
+        if ((result = pl_JSONWriter_Double (p, values[i])) != PlankResult_OK) goto exit;
+    }
+
+    result = pl_JSONWriter_EndArray (p);
+
+exit:
+    return result;
+}
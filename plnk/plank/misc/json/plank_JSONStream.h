@@ -0,0 +1,244 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLANK_JSONSTREAM_H
+#define PLANK_JSONSTREAM_H
+
+#include "../../containers/plank_DynamicArray.h"
+#include "../../files/plank_File.h"
+#include "plank_JSON.h"
+
+/** The size of the file buffer used by the streaming reader and writer. */
+#define PLANK_JSONSTREAM_BUFFERSIZE         4096
+
+/** The size of the window used to pass binary data through zlib.
+ This must be a multiple of 3 so encoded text can be produced a window at a time. */
+#define PLANK_JSONSTREAM_WINDOWSIZE         3072
+
+/** The maximum nesting of objects and arrays. */
+#define PLANK_JSONSTREAM_MAXIMUMDEPTH       64
+
+PLANK_BEGIN_C_LINKAGE
+
+/** Tokens returned by the streaming JSON reader. */
+enum PlankJSONTokenIdentifiers
+{
+    PlankJSONToken_None = 0,
+    PlankJSONToken_ObjectBegin,
+    PlankJSONToken_ObjectEnd,
+    PlankJSONToken_ArrayBegin,
+    PlankJSONToken_ArrayEnd,
+    PlankJSONToken_Key,
+    PlankJSONToken_String,
+    PlankJSONToken_Int,
+    PlankJSONToken_Double,
+    PlankJSONToken_True,
+    PlankJSONToken_False,
+    PlankJSONToken_Null,
+    PlankJSONToken_End
+};
+
+typedef int PlankJSONToken;
+
+/** @defgroup PlankJSONReaderClass Plank JSONReader class
+ @ingroup PlankClasses
+
+ A streaming JSON reader over a PlankFile.
+
+ Unlike pl_JSON_FromFile() this does not build a tree of the whole document,
+ tokens are pulled one at a time with pl_JSONReader_Next() or pushed to a
+ callback with pl_JSONReader_Parse(). Numerical arrays, including Plank's
+ binary "Bf[]" and compressed "Zf[]" formats, can be read directly into
+ caller supplied storage with the pl_JSONReader_Read...Array() functions without
+ any intermediate copies of the encoded or decoded data.
+
+ @{
+ */
+
+typedef struct PlankJSONReader* PlankJSONReaderRef;
+
+/** A callback for pl_JSONReader_Parse().
+ When the token is PlankJSONToken_Key the callback may consume the value that
+ follows using pl_JSONReader_SkipValue() or one of the read functions.
+ Returning anything other than PlankResult_OK stops the parse. */
+typedef PlankResult (*PlankJSONReaderFunction)(PlankJSONReaderRef p, const PlankJSONToken token, PlankP userData);
+
+PlankResult pl_JSONReader_Init (PlankJSONReaderRef p);
+PlankResult pl_JSONReader_DeInit (PlankJSONReaderRef p);
+
+/** Start reading from a file.
+ The file must be open for binary reading and remain open while the reader is used. */
+PlankResult pl_JSONReader_Open (PlankJSONReaderRef p, PlankFileRef file);
+
+/** Read the next token.
+ Keys and strings are available from pl_JSONReader_GetString() and numbers
+ from pl_JSONReader_GetInt() and pl_JSONReader_GetDouble() until the next call.
+ PlankJSONToken_End is returned after the last top level value. */
+PlankResult pl_JSONReader_Next (PlankJSONReaderRef p, PlankJSONToken* token);
+
+PlankJSONToken pl_JSONReader_GetToken (PlankJSONReaderRef p);
+const char* pl_JSONReader_GetString (PlankJSONReaderRef p);
+PlankL pl_JSONReader_GetStringLength (PlankJSONReaderRef p);
+PlankLL pl_JSONReader_GetInt (PlankJSONReaderRef p);
+double pl_JSONReader_GetDouble (PlankJSONReaderRef p);
+int pl_JSONReader_GetDepth (PlankJSONReaderRef p);
+
+/** Skip the next value including any nested objects or arrays. */
+PlankResult pl_JSONReader_SkipValue (PlankJSONReaderRef p);
+
+/** Read the whole document passing each token to a callback. */
+PlankResult pl_JSONReader_Parse (PlankJSONReaderRef p, PlankJSONReaderFunction function, PlankP userData);
+
+/** Read the next value as a number.
+ This accepts a plain JSON number or Plank's encoded binary format. */
+PlankResult pl_JSONReader_ReadInt (PlankJSONReaderRef p, PlankLL* value);
+PlankResult pl_JSONReader_ReadFloat (PlankJSONReaderRef p, float* value);
+PlankResult pl_JSONReader_ReadDouble (PlankJSONReaderRef p, double* value);
+
+/** Read the next value as a numerical array into a dynamic array.
+ This accepts a plain JSON array of numbers or Plank's binary or compressed
+ array format. The array is resized to fit the data. If the array has not been
+ initialised it is initialised with the appropriate item size. */
+PlankResult pl_JSONReader_ReadIntArray (PlankJSONReaderRef p, PlankDynamicArrayRef array);
+PlankResult pl_JSONReader_ReadFloatArray (PlankJSONReaderRef p, PlankDynamicArrayRef array);
+PlankResult pl_JSONReader_ReadDoubleArray (PlankJSONReaderRef p, PlankDynamicArrayRef array);
+
+/** Read the next value as a numerical array into a fixed size buffer.
+ @param values The destination.
+ @param capacity The maximum number of values that can be written to the destination.
+ @param count Receives the number of values read.
+ @return PlankResult_ItemCountInvalid if the array is larger than the capacity. */
+PlankResult pl_JSONReader_ReadIntArrayInto (PlankJSONReaderRef p, PlankLL* values, const PlankL capacity, PlankL* count);
+PlankResult pl_JSONReader_ReadFloatArrayInto (PlankJSONReaderRef p, float* values, const PlankL capacity, PlankL* count);
+PlankResult pl_JSONReader_ReadDoubleArrayInto (PlankJSONReaderRef p, double* values, const PlankL capacity, PlankL* count);
+
+/// @} // End group PlankJSONReaderClass
+
+
+/** @defgroup PlankJSONWriterClass Plank JSONWriter class
+ @ingroup PlankClasses
+
+ A streaming JSON writer over a PlankFile.
+
+ Values are written as they are added so a document can be written without
+ building a tree in memory first. The layout follows the same flags as
+ pl_JSON_WriteToFile(). Numerical arrays in Plank's binary and compressed
+ formats are encoded straight from the source data.
+
+ @{
+ */
+
+typedef struct PlankJSONWriter* PlankJSONWriterRef;
+
+PlankResult pl_JSONWriter_Init (PlankJSONWriterRef p);
+
+/** Flushes any buffered output then deinitialises the writer. */
+PlankResult pl_JSONWriter_DeInit (PlankJSONWriterRef p);
+
+/** Start writing to a file.
+ The file must be open for binary writing and remain open while the writer is used.
+ @param flags PLANK_JSON_INDENT(), PLANK_JSON_COMPACT and PLANK_JSON_ESCAPE_SLASH are supported. */
+PlankResult pl_JSONWriter_Open (PlankJSONWriterRef p, PlankFileRef file, const int flags);
+PlankResult pl_JSONWriter_Flush (PlankJSONWriterRef p);
+
+PlankResult pl_JSONWriter_BeginObject (PlankJSONWriterRef p);
+PlankResult pl_JSONWriter_EndObject (PlankJSONWriterRef p);
+PlankResult pl_JSONWriter_BeginArray (PlankJSONWriterRef p);
+PlankResult pl_JSONWriter_EndArray (PlankJSONWriterRef p);
+PlankResult pl_JSONWriter_Key (PlankJSONWriterRef p, const char* key);
+
+PlankResult pl_JSONWriter_String (PlankJSONWriterRef p, const char* string);
+PlankResult pl_JSONWriter_Int (PlankJSONWriterRef p, const PlankLL value);
+PlankResult pl_JSONWriter_Float (PlankJSONWriterRef p, const float value);
+PlankResult pl_JSONWriter_Double (PlankJSONWriterRef p, const double value);
+PlankResult pl_JSONWriter_Bool (PlankJSONWriterRef p, const PlankB state);
+PlankResult pl_JSONWriter_Null (PlankJSONWriterRef p);
+
+PlankResult pl_JSONWriter_IntBinary (PlankJSONWriterRef p, const PlankLL value);
+PlankResult pl_JSONWriter_FloatBinary (PlankJSONWriterRef p, const float value);
+PlankResult pl_JSONWriter_DoubleBinary (PlankJSONWriterRef p, const double value);
+PlankResult pl_JSONWriter_IntArrayBinary (PlankJSONWriterRef p, const PlankLL* values, const PlankL count);
+PlankResult pl_JSONWriter_FloatArrayBinary (PlankJSONWriterRef p, const float* values, const PlankL count);
+PlankResult pl_JSONWriter_DoubleArrayBinary (PlankJSONWriterRef p, const double* values, const PlankL count);
+PlankResult pl_JSONWriter_IntArrayCompressed (PlankJSONWriterRef p, const PlankLL* values, const PlankL count);
+PlankResult pl_JSONWriter_FloatArrayCompressed (PlankJSONWriterRef p, const float* values, const PlankL count);
+PlankResult pl_JSONWriter_DoubleArrayCompressed (PlankJSONWriterRef p, const double* values, const PlankL count);
+PlankResult pl_JSONWriter_IntArray (PlankJSONWriterRef p, const PlankLL* values, const PlankL count);
+PlankResult pl_JSONWriter_FloatArray (PlankJSONWriterRef p, const float* values, const PlankL count);
+PlankResult pl_JSONWriter_DoubleArray (PlankJSONWriterRef p, const double* values, const PlankL count);
+
+/// @} // End group PlankJSONWriterClass
+
+PLANK_END_C_LINKAGE
+
+#if !DOXYGEN
+typedef struct PlankJSONReader
+{
+    PlankFileRef file;
+    PlankDynamicArray text;
+    PlankLL intValue;
+    double doubleValue;
+    PlankJSONToken token;
+    int state;
+    int depth;
+    int bufferPosition;
+    int bufferLength;
+    PlankB isEOF;
+    PlankUC containers[PLANK_JSONSTREAM_MAXIMUMDEPTH];
+    char buffer[PLANK_JSONSTREAM_BUFFERSIZE];
+    PlankUC window[PLANK_JSONSTREAM_WINDOWSIZE];
+} PlankJSONReader;
+
+typedef struct PlankJSONWriter
+{
+    PlankFileRef file;
+    int flags;
+    int depth;
+    int bufferPosition;
+    int lineLength;
+    PlankB isAfterKey;
+    PlankB isLineArray;
+    PlankUC containers[PLANK_JSONSTREAM_MAXIMUMDEPTH];
+    char buffer[PLANK_JSONSTREAM_BUFFERSIZE];
+    char line[PLANK_JSON_ENCODEDSTRINGLENGTH];
+    char text[PLANK_JSONSTREAM_WINDOWSIZE / 3 * 4];
+    PlankUC window[PLANK_JSONSTREAM_WINDOWSIZE];
+} PlankJSONWriter;
+#endif
+
+#endif // PLANK_JSONSTREAM_H
@@ -42,9 +42,22 @@
 #include "plank_NeuralNode.h"
 #include "plank_NeuralLayer.h"
 #include "../../maths/vectors/plank_Vectors.h"
-//#include "../../random/plank_RNG.h"
+#include "../../random/plank_RNG.h"
 
+static PlankResult pl_NeuralLayerF_InitVectors (PlankNeuralLayerFRef p, const int numNodes, const int numPreviousNodes)
+{
+    PlankResult result;
+    result = PlankResult_OK;
+
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->weightMatrix, sizeof (PlankF), numNodes * numPreviousNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->thresholdVector, sizeof (PlankF), numNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->outputVector, sizeof (PlankF), numNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->inputVector, sizeof (PlankF), numPreviousNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->adjustVector, sizeof (PlankF), numPreviousNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
 
+exit:
+    return result;
+}
 
 PlankResult pl_NeuralLayerF_InitNumNodesAndPrevious (PlankNeuralLayerFRef p, PlankNeuralNetworkFRef network, const int numNodes, const int numPreviousNodes)
 {
@@ -54,8 +67,7 @@ PlankResult pl_NeuralLayerF_InitNumNodesAndPrevious (PlankNeuralLayerFRef p, Pla
 PlankResult pl_NeuralLayerF_InitNumNodesPreviousWithRange (PlankNeuralLayerFRef p, PlankNeuralNetworkFRef network, const int numNodes, const int numPreviousNodes, const float range)
 {
     PlankResult result;
-    int numNodesChecked, numPreviousNodesChecked, i;
-    PlankNeuralNodeF* nodeArray;
+    int numNodesChecked, numPreviousNodesChecked;
     
     result = PlankResult_OK;
     
@@ -67,23 +79,13 @@ PlankResult pl_NeuralLayerF_InitNumNodesPreviousWithRange (PlankNeuralLayerFRef
     
     pl_MemoryZero (p, sizeof (PlankNeuralLayerF));
     
+    p->network = network;
+    
     numNodesChecked = pl_MaxI (1, numNodes);
     numPreviousNodesChecked = pl_MaxI (1, numPreviousNodes);
     
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->nodes, sizeof (PlankNeuralNodeF), numNodesChecked, PLANK_FALSE)) != PlankResult_OK)
-        goto exit;
-    
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-    
-    for (i = 0; i < numNodesChecked; ++i)
-    {
-        if ((result = pl_NeuralNodeF_InitWithNumWeightsAndRange (&nodeArray[i], network, numPreviousNodesChecked, range)) != PlankResult_OK)
-            goto exit;
-    }
-
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->outputVector, sizeof (PlankF), numNodesChecked, PLANK_TRUE)) != PlankResult_OK) goto exit;    
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->inputVector, sizeof (PlankF), numPreviousNodesChecked, PLANK_TRUE)) != PlankResult_OK) goto exit;
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->adjustVector, sizeof (PlankF), numPreviousNodesChecked, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    if ((result = pl_NeuralLayerF_InitVectors (p, numNodesChecked, numPreviousNodesChecked)) != PlankResult_OK) goto exit;
+    if ((result = pl_NeuralLayerF_Randomise (p, range)) != PlankResult_OK) goto exit;
 
 exit:
     return result;
@@ -92,8 +94,6 @@ exit:
 PlankResult pl_NeuralLayerF_DeInit (PlankNeuralLayerFRef p)
 {
     PlankResult result;
-    int numNodes, i;
-    PlankNeuralNodeF* nodeArray;
 
     result = PlankResult_OK;
 
@@ -103,13 +103,8 @@ PlankResult pl_NeuralLayerF_DeInit (PlankNeuralLayerFRef p)
         goto exit;
     }
     
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-
-    for (i = 0; i < numNodes; ++i)
-        pl_NeuralNodeF_DeInit (&nodeArray[i]);
-    
-    pl_DynamicArray_DeInit (&p->nodes);
+    pl_DynamicArray_DeInit (&p->weightMatrix);
+    pl_DynamicArray_DeInit (&p->thresholdVector);
     pl_DynamicArray_DeInit (&p->outputVector);
     pl_DynamicArray_DeInit (&p->inputVector);
     pl_DynamicArray_DeInit (&p->adjustVector);
@@ -122,52 +117,69 @@ exit:
 
 PlankResult pl_NeuralLayerF_Reset (PlankNeuralLayerFRef p, const float amount)
 {
-    PlankResult result;
-    int numNodes, i;
-    PlankNeuralNodeF* nodeArray;
+    PlankRNGRef r;
+    float amount2;
+    float* weightRowPtr;
+    float* thresholdVectorPtr;
+    int numNodes, numInputs, i, j;
     
-    result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightRowPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    r = pl_RNGGlobal();
+    
+    amount2 = amount * 2.f;
     
     for (i = 0; i < numNodes; ++i)
     {
-        if ((result = pl_NeuralNodeF_Reset (&nodeArray[i], amount)) != PlankResult_OK)
-            goto exit;
+        for (j = 0; j < numInputs; ++j)
+            weightRowPtr[j] = pl_RNG_NextFloat (r) * amount2 - amount;
+        
+        thresholdVectorPtr[i] = pl_RNG_NextFloat (r) * amount2 - amount;
+        weightRowPtr += numInputs;
     }
     
-exit:
-    return result;
+    return PlankResult_OK;
 }
 
 PlankResult pl_NeuralLayerF_Randomise (PlankNeuralLayerFRef p, const float amount)
 {
-    PlankResult result;
-    int numNodes, i;
-    PlankNeuralNodeF* nodeArray;
+    PlankRNGRef r;
+    float amount2;
+    float* weightRowPtr;
+    float* thresholdVectorPtr;
+    int numNodes, numInputs, i, j;
+    
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightRowPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    r = pl_RNGGlobal();
+    
+    amount2 = amount * 2.f;
     
-    result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-
     for (i = 0; i < numNodes; ++i)
     {
-        if ((result = pl_NeuralNodeF_Randomise (&nodeArray[i], amount)) != PlankResult_OK)
-            goto exit;
+        for (j = 0; j < numInputs; ++j)
+            weightRowPtr[j] += pl_RNG_NextFloat (r) * amount2 - amount;
+        
+        thresholdVectorPtr[i] += pl_RNG_NextFloat (r) * amount2 - amount;
+        weightRowPtr += numInputs;
     }
     
-exit:
-    return result;
+    return PlankResult_OK;
 }
 
 PlankResult pl_NeuralLayerF_SetNode (PlankNeuralLayerFRef p, const int nodeIndex, const float* weights, const float threshold)
 {
     PlankResult result;
-    int numNodes;
-    PlankNeuralNodeF* nodeArray;
+    int numNodes, numInputs;
+    float* weightMatrixPtr;
+    float* thresholdVectorPtr;
     
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
 
     if ((nodeIndex < 0) || (nodeIndex >= numNodes))
     {
@@ -175,8 +187,12 @@ PlankResult pl_NeuralLayerF_SetNode (PlankNeuralLayerFRef p, const int nodeIndex
         goto exit;
     }
     
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-    result = pl_NeuralNodeF_Set (&nodeArray[nodeIndex], weights, threshold);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightMatrixPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    
+    pl_VectorMoveF_NN (weightMatrixPtr + nodeIndex * numInputs, weights, numInputs);
+    thresholdVectorPtr[nodeIndex] = threshold;
     
 exit:
     return result;
@@ -186,10 +202,10 @@ PlankResult pl_NeuralLayerF_SetThreshold (PlankNeuralLayerFRef p, const int node
 {
     PlankResult result;
     int numNodes;
-    PlankNeuralNodeF* nodeArray;
+    float* thresholdVectorPtr;
     
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
     
     if ((nodeIndex < 0) || (nodeIndex >= numNodes))
     {
@@ -197,8 +213,8 @@ PlankResult pl_NeuralLayerF_SetThreshold (PlankNeuralLayerFRef p, const int node
         goto exit;
     }
     
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-    result = pl_NeuralNodeF_SetThreshold (&nodeArray[nodeIndex], threshold);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    thresholdVectorPtr[nodeIndex] = threshold;
     
 exit:
     return result;
@@ -207,20 +223,22 @@ exit:
 PlankResult pl_NeuralLayerF_SetWeight (PlankNeuralLayerFRef p, const int nodeIndex, const int weightIndex, const float weight)
 {
     PlankResult result;
-    int numNodes;
-    PlankNeuralNodeF* nodeArray;
+    int numNodes, numInputs;
+    float* weightMatrixPtr;
     
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
     
-    if ((nodeIndex < 0) || (nodeIndex >= numNodes))
+    if ((nodeIndex < 0) || (nodeIndex >= numNodes) ||
+        (weightIndex < 0) || (weightIndex >= numInputs))
     {
         result = PlankResult_IndexOutOfRange;
         goto exit;
     }
     
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-    result = pl_NeuralNodeF_SetWeight (&nodeArray[nodeIndex], weightIndex, weight);
+    weightMatrixPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    weightMatrixPtr[nodeIndex * numInputs + weightIndex] = weight;
     
 exit:
     return result;
@@ -229,11 +247,12 @@ exit:
 PlankResult pl_NeuralLayerF_GetNode (PlankNeuralLayerFRef p, const int nodeIndex, float* weights, float* threshold)
 {
     PlankResult result;
-    int numNodes;
-    PlankNeuralNodeF* nodeArray;
+    int numNodes, numInputs;
+    const float* weightMatrixPtr;
+    const float* thresholdVectorPtr;
     
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
     
     if ((nodeIndex < 0) || (nodeIndex >= numNodes))
     {
@@ -241,8 +260,12 @@ PlankResult pl_NeuralLayerF_GetNode (PlankNeuralLayerFRef p, const int nodeIndex
         goto exit;
     }
     
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
-    result = pl_NeuralNodeF_Get (&nodeArray[nodeIndex], weights, threshold);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightMatrixPtr = (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+
+    pl_VectorMoveF_NN (weights, weightMatrixPtr + nodeIndex * numInputs, numInputs);
+    *threshold = thresholdVectorPtr[nodeIndex];
     
 exit:
     return result;
@@ -251,23 +274,25 @@ exit:
 PlankResult pl_NeuralLayerF_Propogate (PlankNeuralLayerFRef p, const float* inputs)
 {
     PlankResult result;
-    int numNodes, numInputs, i;
-    PlankNeuralNodeF* nodeArray;
+    int numNodes, numInputs;
+    const float* weightMatrixPtr;
+    const float* thresholdVectorPtr;
     float* inputVectorPtr;
     float* outputVectorPtr;
     
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->outputVector);
     numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
     
+    weightMatrixPtr = (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->thresholdVector);
     inputVectorPtr = (float*)pl_DynamicArray_GetArray (&p->inputVector);
     outputVectorPtr = (float*)pl_DynamicArray_GetArray (&p->outputVector);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
 
     pl_VectorMoveF_NN (inputVectorPtr, inputs, numInputs);
-
-    for (i = 0; i < numNodes; ++i)
-        outputVectorPtr[i] = pl_NeuralNodeF_Propogate (&nodeArray[i], inputVectorPtr);
+    pl_VectorMatMulTransF_MNK (outputVectorPtr, inputVectorPtr, weightMatrixPtr, 1, numNodes, numInputs);
+    pl_VectorAddF_NNN (outputVectorPtr, outputVectorPtr, thresholdVectorPtr, numNodes);
+    pl_NeuralNetworkF_ActFuncVector (p->network, outputVectorPtr, numNodes);
         
 //exit:
     return result;
@@ -276,26 +301,142 @@ PlankResult pl_NeuralLayerF_Propogate (PlankNeuralLayerFRef p, const float* inpu
 PlankResult pl_NeuralLayerF_BackProp (PlankNeuralLayerFRef p, const float* errors, const float actFuncOffset, const float learnRate)
 {
     PlankResult result;
-    int numNodes, i;
-    PlankNeuralNodeF* nodeArray;
+    int numNodes, numInputs, i;
+    float output, adjust, learn;
+    float* weightRowPtr;
+    float* thresholdVectorPtr;
+    const float* outputVectorPtr;
     const float* inputVectorPtr;
     float* adjustVectorPtr;
    
     result = PlankResult_OK;
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->outputVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
     
     pl_DynamicArray_Zero (&p->adjustVector);
     
+    weightRowPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    outputVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->outputVector);
     inputVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->inputVector);
     adjustVectorPtr = (float*)pl_DynamicArray_GetArray (&p->adjustVector);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
 
     for (i = 0; i < numNodes; ++i)
-        pl_NeuralNodeF_BackProp (&nodeArray[i], inputVectorPtr, errors[i], actFuncOffset, learnRate, adjustVectorPtr);
+    {
+        output = outputVectorPtr[i];
+        adjust = errors[i] * (actFuncOffset + (output * (1.f - output)));
+        learn = adjust * learnRate;
+        
+        pl_VectorMulAddF_NN1N (weightRowPtr, inputVectorPtr, learn, weightRowPtr, numInputs);
+        pl_VectorMulAddF_NN1N (adjustVectorPtr, weightRowPtr, adjust, adjustVectorPtr, numInputs);
+        
+        thresholdVectorPtr[i] += learn;
+        weightRowPtr += numInputs;
+    }
     
     return result;
 }
 
+PlankResult pl_NeuralLayerF_PropogateBatch (PlankNeuralLayerFRef p, const float* inputs, const int numPatterns, float* outputs)
+{
+    PlankResult result;
+    int numNodes, numInputs, i;
+    const float* weightMatrixPtr;
+    const float* thresholdVectorPtr;
+    float* outputRowPtr;
+    
+    result = PlankResult_OK;
+    
+    if (numPatterns < 1)
+        goto exit;
+    
+    numNodes = (int)pl_DynamicArray_GetSize (&p->outputVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightMatrixPtr = (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+
+    pl_VectorMatMulTransF_MNK (outputs, inputs, weightMatrixPtr, numPatterns, numNodes, numInputs);
+    
+    outputRowPtr = outputs;
+    
+    for (i = 0; i < numPatterns; ++i)
+    {
+        pl_VectorAddF_NNN (outputRowPtr, outputRowPtr, thresholdVectorPtr, numNodes);
+        outputRowPtr += numNodes;
+    }
+    
+    pl_NeuralNetworkF_ActFuncVector (p->network, outputs, numPatterns * numNodes);
+    
+exit:
+    return result;
+}
+
+PlankResult pl_NeuralLayerF_BackPropBatch (PlankNeuralLayerFRef p, const float* inputs, const float* outputs, float* errors, const int numPatterns, const float actFuncOffset, float* weightGradients, float* thresholdGradients, float* previousErrors)
+{
+    PlankResult result;
+    int numNodes, numInputs, i, j;
+    float output, delta;
+    const float* weightMatrixPtr;
+    const float* inputRowPtr;
+    float* previousErrorRowPtr;
+    
+    result = PlankResult_OK;
+    numNodes = (int)pl_DynamicArray_GetSize (&p->outputVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightMatrixPtr = (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+
+    for (i = 0; i < numPatterns * numNodes; ++i)
+    {
+        output = outputs[i];
+        errors[i] *= actFuncOffset + (output * (1.f - output));
+    }
+    
+    if (previousErrors)
+        pl_VectorClearF_N (previousErrors, numPatterns * numInputs);
+
+    inputRowPtr = inputs;
+    previousErrorRowPtr = previousErrors;
+
+    for (i = 0; i < numPatterns; ++i)
+    {
+        pl_VectorAddF_NNN (thresholdGradients, thresholdGradients, errors, numNodes);
+
+        for (j = 0; j < numNodes; ++j)
+        {
+            delta = errors[j];
+            pl_VectorMulAddF_NN1N (weightGradients + j * numInputs, inputRowPtr, delta, weightGradients + j * numInputs, numInputs);
+            
+            if (previousErrorRowPtr)
+                pl_VectorMulAddF_NN1N (previousErrorRowPtr, weightMatrixPtr + j * numInputs, delta, previousErrorRowPtr, numInputs);
+        }
+        
+        errors += numNodes;
+        inputRowPtr += numInputs;
+        
+        if (previousErrorRowPtr)
+            previousErrorRowPtr += numInputs;
+    }
+    
+    return result;
+}
+
+PlankResult pl_NeuralLayerF_ApplyGradients (PlankNeuralLayerFRef p, const float* weightGradients, const float* thresholdGradients, const float scale)
+{
+    float* weightMatrixPtr;
+    float* thresholdVectorPtr;
+    int numNodes, numWeights;
+    
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
+    numWeights = (int)pl_DynamicArray_GetSize (&p->weightMatrix);
+    weightMatrixPtr = (float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+    
+    pl_VectorMulAddF_NN1N (weightMatrixPtr, weightGradients, scale, weightMatrixPtr, numWeights);
+    pl_VectorMulAddF_NN1N (thresholdVectorPtr, thresholdGradients, scale, thresholdVectorPtr, numNodes);
+    
+    return PlankResult_OK;
+}
+
 PlankResult pl_NeuralLayerF_GetOutputs (PlankNeuralLayerFRef p, float* outputs)
 {
     PlankResult result;
@@ -319,6 +460,16 @@ const float* pl_NeuralLayerF_GetAdjustPtr (PlankNeuralLayerFRef p)
     return (const float*)pl_DynamicArray_GetArray (&p->adjustVector);
 }
 
+const float* pl_NeuralLayerF_GetWeightsPtr (PlankNeuralLayerFRef p)
+{
+    return (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+}
+
+const float* pl_NeuralLayerF_GetThresholdsPtr (PlankNeuralLayerFRef p)
+{
+    return (const float*)pl_DynamicArray_GetArray (&p->thresholdVector);
+}
+
 int pl_NeuralLayerF_GetNumInputs (PlankNeuralLayerFRef p)
 {
     return (int)pl_DynamicArray_GetSize (&p->inputVector);
@@ -332,8 +483,9 @@ int pl_NeuralLayerF_GetNumOutputs (PlankNeuralLayerFRef p)
 PlankResult pl_NeuralLayerF_ToJSON (PlankNeuralLayerFRef p, PlankJSONRef j, const PlankB useBinary)
 {
     PlankResult result;
-    int i, numNodes;
-    PlankNeuralNodeF* nodeArray;
+    int i, numNodes, numInputs;
+    const float* weightMatrixPtr;
+    const float* thresholdVectorPtr;
     PlankJSONRef jlayer;
     PlankJSONRef jnodes;
     
@@ -345,12 +497,14 @@ PlankResult pl_NeuralLayerF_ToJSON (PlankNeuralLayerFRef p, PlankJSONRef j, cons
     pl_JSON_ObjectSetType (jlayer, PLANK_NEURALLAYERF_JSON_TYPE);
     pl_JSON_ObjectSetVersionString (jlayer, PLANK_NEURALLAYERF_JSON_VERSION);
 
-    numNodes = (int)pl_DynamicArray_GetSize (&p->nodes);
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
+    numNodes = (int)pl_DynamicArray_GetSize (&p->thresholdVector);
+    numInputs = (int)pl_DynamicArray_GetSize (&p->inputVector);
+    weightMatrixPtr = (const float*)pl_DynamicArray_GetArray (&p->weightMatrix);
+    thresholdVectorPtr = (const float*)pl_DynamicArray_GetArray (&p->thresholdVector);
     
     for (i = 0; i < numNodes; ++i)
 	{        
-        if ((result = pl_NeuralNodeF_ToJSON (&nodeArray[i], jnodes, useBinary)) != PlankResult_OK)
+        if ((result = pl_NeuralNodeF_ToJSONWithWeights (weightMatrixPtr + i * numInputs, numInputs, thresholdVectorPtr[i], jnodes, useBinary)) != PlankResult_OK)
             goto exit;
     }
     
@@ -366,7 +520,7 @@ PlankResult pl_NeuralLayerF_InitFromJSON (PlankNeuralLayerFRef p, PlankNeuralNet
     PlankResult result;
     PlankJSONRef jnodes;
     int numNodes, numPreviousNodes, i;
-    PlankNeuralNodeF* nodeArray;
+    PlankNeuralNodeF node;
     
     result = PlankResult_OK;
     
@@ -377,6 +531,9 @@ PlankResult pl_NeuralLayerF_InitFromJSON (PlankNeuralLayerFRef p, PlankNeuralNet
     }
     
     pl_MemoryZero (p, sizeof (PlankNeuralLayerF));
+    pl_MemoryZero (&node, sizeof (PlankNeuralNodeF));
+    
+    p->network = network;
     
     if (!pl_JSON_IsObjectType (j, PLANK_NEURALLAYERF_JSON_TYPE))
     {
@@ -410,24 +567,34 @@ PlankResult pl_NeuralLayerF_InitFromJSON (PlankNeuralLayerFRef p, PlankNeuralNet
         goto exit;
     }
     
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->nodes, sizeof (PlankNeuralNodeF), numNodes, PLANK_FALSE)) != PlankResult_OK) goto exit;
-    
-    nodeArray = (PlankNeuralNodeF*)pl_DynamicArray_GetArray (&p->nodes);
+    numPreviousNodes = 0;
     
     for (i = 0; i < numNodes; ++i)
     {
-        if ((result = pl_NeuralNodeF_InitFromJSON (&nodeArray[i], network, pl_JSON_ArrayAt (jnodes, i))) != PlankResult_OK)
+        // each node is parsed with the standalone node code then copied into its row of the matrix
+        if ((result = pl_NeuralNodeF_InitFromJSON (&node, network, pl_JSON_ArrayAt (jnodes, i))) != PlankResult_OK)
+            goto exit;
+        
+        if (i == 0)
+        {
+            numPreviousNodes = pl_NeuralNodeF_GetNumWeights (&node);
+            
+            if ((result = pl_NeuralLayerF_InitVectors (p, numNodes, numPreviousNodes)) != PlankResult_OK)
+                goto exit;
+        }
+        else if (pl_NeuralNodeF_GetNumWeights (&node) != numPreviousNodes)
+        {
+            result = PlankResult_JSONError;
+            goto exit;
+        }
+        
+        if ((result = pl_NeuralLayerF_SetNode (p, i, pl_NeuralNodeF_GetWeightsPtr (&node), pl_NeuralNodeF_GetThreshold (&node))) != PlankResult_OK)
             goto exit;
+        
+        pl_NeuralNodeF_DeInit (&node);
     }
-    
-    numPreviousNodes = pl_NeuralNodeF_GetNumWeights (&nodeArray[0]);
-    
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->outputVector, sizeof (PlankF), numNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->inputVector, sizeof (PlankF), numPreviousNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
-    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->adjustVector, sizeof (PlankF), numPreviousNodes, PLANK_TRUE)) != PlankResult_OK) goto exit;
         
 exit:
+    pl_NeuralNodeF_DeInit (&node);
     return result;
 }
-
-
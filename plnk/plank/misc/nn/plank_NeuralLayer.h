@@ -87,9 +87,45 @@ PlankResult pl_NeuralLayerF_SetWeight (PlankNeuralLayerFRef p, const int nodeInd
 PlankResult pl_NeuralLayerF_GetNode (PlankNeuralLayerFRef p, const int nodeIndex, float* weights, float* threshold);
 PlankResult pl_NeuralLayerF_Propogate (PlankNeuralLayerFRef p, const float* inputs);
 PlankResult pl_NeuralLayerF_BackProp (PlankNeuralLayerFRef p, const float* errors, const float actFuncOffset, const float learnRate);
+
+/** Propogate a batch of input vectors through the layer.
+ This does not change the state used by pl_NeuralLayerF_Propogate() and
+ pl_NeuralLayerF_BackProp() so may be called concurrently on the same layer
+ as long as the weights are not being modified.
+ @param p The <i>Plank %NeuralLayerF</i> object.
+ @param inputs The input vectors as a contiguous numPatterns x numInputs matrix.
+ @param numPatterns The number of input vectors.
+ @param outputs Receives the output vectors as a contiguous numPatterns x numOutputs matrix.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralLayerF_PropogateBatch (PlankNeuralLayerFRef p, const float* inputs, const int numPatterns, float* outputs);
+
+/** Accumulate the gradients for a batch without modifying the weights.
+ @param p The <i>Plank %NeuralLayerF</i> object.
+ @param inputs The inputs this layer was propogated with (numPatterns x numInputs).
+ @param outputs The outputs from pl_NeuralLayerF_PropogateBatch() (numPatterns x numOutputs).
+ @param errors On entry the errors at the outputs of this layer (numPatterns x numOutputs),
+               on exit these are replaced with the deltas.
+ @param numPatterns The number of patterns in the batch.
+ @param actFuncOffset The activation function derivative offset.
+ @param weightGradients A numOutputs x numInputs matrix to accumulate the weight gradients into.
+ @param thresholdGradients A vector of numOutputs to accumulate the threshold gradients into.
+ @param previousErrors If not null receives the errors to pass to the previous layer (numPatterns x numInputs).
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralLayerF_BackPropBatch (PlankNeuralLayerFRef p, const float* inputs, const float* outputs, float* errors, const int numPatterns, const float actFuncOffset, float* weightGradients, float* thresholdGradients, float* previousErrors);
+
+/** Add scaled gradients from pl_NeuralLayerF_BackPropBatch() to the weights and thresholds.
+ @param p The <i>Plank %NeuralLayerF</i> object.
+ @param weightGradients The numOutputs x numInputs weight gradients.
+ @param thresholdGradients The numOutputs threshold gradients.
+ @param scale The amount to scale the gradients by (usually the learn rate divided by the batch size).
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralLayerF_ApplyGradients (PlankNeuralLayerFRef p, const float* weightGradients, const float* thresholdGradients, const float scale);
+
 PlankResult pl_NeuralLayerF_GetOutputs (PlankNeuralLayerFRef p, float* outputs);
 const float* pl_NeuralLayerF_GetOutputsPtr (PlankNeuralLayerFRef p);
 const float* pl_NeuralLayerF_GetAdjustPtr (PlankNeuralLayerFRef p);
+const float* pl_NeuralLayerF_GetWeightsPtr (PlankNeuralLayerFRef p);
+const float* pl_NeuralLayerF_GetThresholdsPtr (PlankNeuralLayerFRef p);
 int pl_NeuralLayerF_GetNumInputs (PlankNeuralLayerFRef p);
 int pl_NeuralLayerF_GetNumOutputs (PlankNeuralLayerFRef p);
 PlankResult pl_NeuralLayerF_ToJSON (PlankNeuralLayerFRef p, PlankJSONRef j, const PlankB useBinary);
@@ -101,9 +137,14 @@ PlankResult pl_NeuralLayerF_InitFromJSON (PlankNeuralLayerFRef p, PlankNeuralNet
 PLANK_END_C_LINKAGE
 
 #if !DOXYGEN
+/* The weights for all nodes in the layer are held as a single row-major
+   numOutputs x numInputs matrix so the layer can be evaluated with one
+   matrix multiply rather than a dot product per node. */
 typedef struct PlankNeuralLayerF
 {
-    PlankDynamicArray nodes;
+    PlankNeuralNetworkFRef network;
+    PlankDynamicArray weightMatrix;
+    PlankDynamicArray thresholdVector;
     PlankDynamicArray outputVector;
     PlankDynamicArray inputVector;
     PlankDynamicArray adjustVector;
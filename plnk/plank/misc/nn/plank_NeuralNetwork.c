@@ -42,6 +42,7 @@
 #include "plank_NeuralLayer.h"
 #include "plank_NeuralNetwork.h"
 #include "../../maths/vectors/plank_Vectors.h"
+#include "../../core/plank_Thread.h"
 
 static const float NeuralFE1 = 2.7182818284590452354f;
 
@@ -50,6 +51,35 @@ static PlankF pl_NeuralNetworkFDefaultActFunction (PlankF value)
     return 1.f / (1.f + pl_PowF (NeuralFE1, -value));
 }
 
+typedef struct PlankNeuralNetworkFBatchWorker
+{
+    PlankNeuralNetworkFRef network;
+    const float* inputs;
+    const float* targets;
+    int numPatterns;
+    PlankDynamicArray gradients;
+    PlankDynamicArray activations;
+    PlankDynamicArray errors;
+    PlankThread thread;
+    PlankB threadStarted;
+    PlankResult result;
+} PlankNeuralNetworkFBatchWorker;
+
+static int pl_NeuralNetworkF_GetMaxWidth (PlankNeuralNetworkFRef p)
+{
+    int numLayers, maxWidth, i;
+    PlankNeuralLayerF* layerArray;
+    
+    numLayers = (int)pl_DynamicArray_GetSize (&p->layers);
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&p->layers);
+    maxWidth = pl_NeuralLayerF_GetNumInputs (&layerArray[0]);
+    
+    for (i = 0; i < numLayers; ++i)
+        maxWidth = pl_MaxI (maxWidth, pl_NeuralLayerF_GetNumOutputs (&layerArray[i]));
+    
+    return maxWidth;
+}
+
 PlankResult pl_NeuralNetworkF_InitWithLayersAndRange (PlankNeuralNetworkFRef p, const int* layers, const int numLayers, const float range)
 {
     PlankResult result;
@@ -92,6 +122,94 @@ exit:
     return result;
 }
 
+PlankResult pl_NeuralNetworkF_InitCopy (PlankNeuralNetworkFRef p, PlankNeuralNetworkFRef source)
+{
+    PlankResult result;
+    PlankDynamicArray structure;
+    PlankNeuralLayerF* layerArray;
+    int* structureArray;
+    int numLayers, i;
+    
+    result = PlankResult_OK;
+    pl_MemoryZero (&structure, sizeof (PlankDynamicArray));
+    
+    if ((p == PLANK_NULL) || (source == PLANK_NULL))
+    {
+        result = PlankResult_MemoryError;
+        goto exit;
+    }
+    
+    numLayers = (int)pl_DynamicArray_GetSize (&source->layers);
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&source->layers);
+
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&structure, sizeof (int), numLayers + 1, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    structureArray = (int*)pl_DynamicArray_GetArray (&structure);
+    structureArray[0] = pl_NeuralLayerF_GetNumInputs (&layerArray[0]);
+    
+    for (i = 0; i < numLayers; ++i)
+        structureArray[i + 1] = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+    
+    if ((result = pl_NeuralNetworkF_InitWithLayersAndRange (p, structureArray, numLayers + 1, 0.f)) != PlankResult_OK) goto exit;
+    if ((result = pl_NeuralNetworkF_CopyWeights (p, source)) != PlankResult_OK) goto exit;
+    
+    p->learnRate = source->learnRate;
+    p->actFuncOffset = source->actFuncOffset;
+    p->actFunc = source->actFunc;
+    
+exit:
+    pl_DynamicArray_DeInit (&structure);
+    return result;
+}
+
+PlankResult pl_NeuralNetworkF_CopyWeights (PlankNeuralNetworkFRef p, PlankNeuralNetworkFRef source)
+{
+    PlankResult result;
+    int numLayers, numNodes, numInputs, i;
+    PlankNeuralLayerF* layerArray;
+    PlankNeuralLayerF* sourceLayerArray;
+
+    result = PlankResult_OK;
+    numLayers = (int)pl_DynamicArray_GetSize (&p->layers);
+    
+    if (numLayers != (int)pl_DynamicArray_GetSize (&source->layers))
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+    
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&p->layers);
+    sourceLayerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&source->layers);
+    
+    for (i = 0; i < numLayers; ++i)
+    {
+        numNodes = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+        numInputs = pl_NeuralLayerF_GetNumInputs (&layerArray[i]);
+        
+        if ((numNodes != pl_NeuralLayerF_GetNumOutputs (&sourceLayerArray[i])) ||
+            (numInputs != pl_NeuralLayerF_GetNumInputs (&sourceLayerArray[i])))
+        {
+            result = PlankResult_ItemCountInvalid;
+            goto exit;
+        }
+    }
+    
+    for (i = 0; i < numLayers; ++i)
+    {
+        numNodes = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+        numInputs = pl_NeuralLayerF_GetNumInputs (&layerArray[i]);
+        
+        pl_MemoryCopy (pl_DynamicArray_GetArray (&layerArray[i].weightMatrix),
+                       pl_DynamicArray_GetArray (&sourceLayerArray[i].weightMatrix),
+                       numNodes * numInputs * sizeof (float));
+        pl_MemoryCopy (pl_DynamicArray_GetArray (&layerArray[i].thresholdVector),
+                       pl_DynamicArray_GetArray (&sourceLayerArray[i].thresholdVector),
+                       numNodes * sizeof (float));
+    }
+    
+exit:
+    return result;
+}
+
 PlankResult pl_NeuralNetworkF_DeInit (PlankNeuralNetworkFRef p)
 {
     PlankResult result;
@@ -114,6 +232,7 @@ PlankResult pl_NeuralNetworkF_DeInit (PlankNeuralNetworkFRef p)
 
     pl_DynamicArray_DeInit (&p->layers);
     pl_DynamicArray_DeInit (&p->errorVector);
+    pl_DynamicArray_DeInit (&p->batchVector);
     
     pl_MemoryZero (p, sizeof (PlankNeuralNetworkF));
     
@@ -379,6 +498,264 @@ exit:
 	return result;
 }
 
+PlankResult pl_NeuralNetworkF_ReserveBatch (PlankNeuralNetworkFRef p, const int maxPatterns)
+{
+    PlankResult result;
+    PlankL size;
+    
+    result = PlankResult_OK;
+    size = (PlankL)maxPatterns * pl_NeuralNetworkF_GetMaxWidth (p) * 2;
+    
+    if (pl_DynamicArray_GetItemSize (&p->batchVector) == 0)
+    {
+        if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&p->batchVector, sizeof (PlankF), size, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    }
+    else if (pl_DynamicArray_GetSize (&p->batchVector) < size)
+    {
+        if ((result = pl_DynamicArray_SetSize (&p->batchVector, size)) != PlankResult_OK) goto exit;
+    }
+    
+exit:
+    return result;
+}
+
+PlankResult pl_NeuralNetworkF_PropogateBatch (PlankNeuralNetworkFRef p, const float* inputs, const int numPatterns, float* outputs)
+{
+    PlankResult result;
+    int numLayers, scratchSize, i;
+    PlankNeuralLayerF* layerArray;
+    const float* layerInputs;
+    float* layerOutputs;
+    float* scratch;
+    
+    result = PlankResult_OK;
+    
+    if (numPatterns < 1)
+        goto exit;
+    
+    if ((result = pl_NeuralNetworkF_ReserveBatch (p, numPatterns)) != PlankResult_OK) goto exit;
+    
+    numLayers = (int)pl_DynamicArray_GetSize (&p->layers);
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&p->layers);
+    scratch = (float*)pl_DynamicArray_GetArray (&p->batchVector);
+    scratchSize = numPatterns * pl_NeuralNetworkF_GetMaxWidth (p);
+    layerInputs = inputs;
+    
+    // hidden layers ping-pong between the two halves of the scratch memory
+    for (i = 0; i < numLayers; ++i)
+    {
+        layerOutputs = (i == (numLayers - 1)) ? outputs : scratch + (i & 1) * scratchSize;
+        
+        if ((result = pl_NeuralLayerF_PropogateBatch (&layerArray[i], layerInputs, numPatterns, layerOutputs)) != PlankResult_OK) goto exit;
+        layerInputs = layerOutputs;
+    }
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_NeuralNetworkF_BatchWorkerProcess (PlankNeuralNetworkFBatchWorker* w)
+{
+    PlankResult result;
+    PlankNeuralNetworkFRef p;
+    int numLayers, numPatterns, numNodes, numInputs, maxWidth, i;
+    PlankNeuralLayerF* layerArray;
+    const float* layerInputs;
+    float* layerOutputs;
+    float* layerErrors;
+    float* previousErrors;
+    float* swapErrors;
+    float* gradients;
+    
+    result = PlankResult_OK;
+    p = w->network;
+    numPatterns = w->numPatterns;
+    numLayers = (int)pl_DynamicArray_GetSize (&p->layers);
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&p->layers);
+    maxWidth = pl_NeuralNetworkF_GetMaxWidth (p);
+    
+    // forward, keeping the activations of every layer for the backward pass
+    layerInputs = w->inputs;
+    layerOutputs = (float*)pl_DynamicArray_GetArray (&w->activations);
+    
+    for (i = 0; i < numLayers; ++i)
+    {
+        if ((result = pl_NeuralLayerF_PropogateBatch (&layerArray[i], layerInputs, numPatterns, layerOutputs)) != PlankResult_OK) goto exit;
+        
+        layerInputs = layerOutputs;
+        layerOutputs += numPatterns * pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+    }
+    
+    // backward, from the output errors
+    layerOutputs = (float*)layerInputs;
+    layerErrors = (float*)pl_DynamicArray_GetArray (&w->errors);
+    previousErrors = layerErrors + numPatterns * maxWidth;
+    gradients = (float*)pl_DynamicArray_GetArray (&w->gradients) + pl_DynamicArray_GetSize (&w->gradients);
+    
+    pl_VectorSubF_NNN (layerErrors, w->targets, layerOutputs, numPatterns * pl_NeuralNetworkF_GetNumOutputs (p));
+    
+    for (i = numLayers - 1; i >= 0; --i)
+    {
+        numNodes = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+        numInputs = pl_NeuralLayerF_GetNumInputs (&layerArray[i]);
+        layerInputs = (i > 0) ? layerOutputs - numPatterns * numInputs : w->inputs;
+        gradients -= numNodes * numInputs + numNodes;
+        
+        if ((result = pl_NeuralLayerF_BackPropBatch (&layerArray[i], layerInputs, layerOutputs, layerErrors, numPatterns, p->actFuncOffset,
+                                                     gradients, gradients + numNodes * numInputs,
+                                                     (i > 0) ? previousErrors : (float*)PLANK_NULL)) != PlankResult_OK) goto exit;
+        
+        swapErrors = layerErrors;
+        layerErrors = previousErrors;
+        previousErrors = swapErrors;
+        layerOutputs = (float*)layerInputs;
+    }
+    
+exit:
+    return result;
+}
+
+static PlankResult pl_NeuralNetworkF_BatchWorkerThread (PlankThreadRef t)
+{
+    PlankNeuralNetworkFBatchWorker* w = (PlankNeuralNetworkFBatchWorker*)pl_Thread_GetUserData (t);
+    w->result = pl_NeuralNetworkF_BatchWorkerProcess (w);
+    return w->result;
+}
+
+PlankResult pl_NeuralNetworkF_BackPropBatch (PlankNeuralNetworkFRef p, const float* inputs, const float* targets, const int numPatterns, const int numThreads)
+{
+    PlankResult result;
+    PlankDynamicArray workers;
+    PlankNeuralNetworkFBatchWorker* workerArray;
+    PlankNeuralLayerF* layerArray;
+    PlankL numGradients, numActivations;
+    int numLayers, numInputs, numOutputs, numWorkers, maxWidth, numNodes, numLayerInputs, patternIndex, i;
+    float* gradients;
+    float scale;
+    
+    result = PlankResult_OK;
+    pl_MemoryZero (&workers, sizeof (PlankDynamicArray));
+
+    if (numPatterns < 1)
+    {
+        result = PlankResult_ItemCountInvalid;
+        goto exit;
+    }
+    
+    numLayers = (int)pl_DynamicArray_GetSize (&p->layers);
+    layerArray = (PlankNeuralLayerF*)pl_DynamicArray_GetArray (&p->layers);
+    numInputs = pl_NeuralNetworkF_GetNumInputs (p);
+    numOutputs = pl_NeuralNetworkF_GetNumOutputs (p);
+    maxWidth = pl_NeuralNetworkF_GetMaxWidth (p);
+    numGradients = 0;
+    numActivations = 0;
+    
+    for (i = 0; i < numLayers; ++i)
+    {
+        numNodes = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+        numGradients += numNodes * pl_NeuralLayerF_GetNumInputs (&layerArray[i]) + numNodes;
+        numActivations += numNodes;
+    }
+    
+    numWorkers = numThreads > 0 ? numThreads : pl_ThreadNumCores();
+    numWorkers = pl_ClipI (numWorkers, 1, numPatterns);
+    
+    if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&workers, sizeof (PlankNeuralNetworkFBatchWorker), numWorkers, PLANK_TRUE)) != PlankResult_OK) goto exit;
+    workerArray = (PlankNeuralNetworkFBatchWorker*)pl_DynamicArray_GetArray (&workers);
+    patternIndex = 0;
+    
+    for (i = 0; i < numWorkers; ++i)
+    {
+        PlankNeuralNetworkFBatchWorker* w = &workerArray[i];
+        
+        w->network = p;
+        w->numPatterns = numPatterns / numWorkers + ((i < (numPatterns % numWorkers)) ? 1 : 0);
+        w->inputs = inputs + patternIndex * numInputs;
+        w->targets = targets + patternIndex * numOutputs;
+        patternIndex += w->numPatterns;
+        
+        if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&w->gradients, sizeof (PlankF), numGradients, PLANK_TRUE)) != PlankResult_OK) goto exit;
+        if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&w->activations, sizeof (PlankF), numActivations * w->numPatterns, PLANK_FALSE)) != PlankResult_OK) goto exit;
+        if ((result = pl_DynamicArray_InitWithItemSizeAndSize (&w->errors, sizeof (PlankF), maxWidth * w->numPatterns * 2, PLANK_FALSE)) != PlankResult_OK) goto exit;
+    }
+    
+    // the calling thread takes the first share, if a thread can't be started its share is done here too
+    for (i = 1; i < numWorkers; ++i)
+    {
+        PlankNeuralNetworkFBatchWorker* w = &workerArray[i];
+
+        pl_Thread_Init (&w->thread);
+        pl_Thread_SetName (&w->thread, "NeuralNetworkF BackPropBatch");
+        pl_Thread_SetFunction (&w->thread, pl_NeuralNetworkF_BatchWorkerThread);
+        pl_Thread_SetUserData (&w->thread, w);
+        
+        if (pl_Thread_Start (&w->thread) == PlankResult_OK)
+        {
+            w->threadStarted = PLANK_TRUE;
+        }
+        else
+        {
+            pl_Thread_DeInit (&w->thread);
+            w->result = pl_NeuralNetworkF_BatchWorkerProcess (w);
+        }
+    }
+    
+    workerArray[0].result = pl_NeuralNetworkF_BatchWorkerProcess (&workerArray[0]);
+    
+    for (i = 1; i < numWorkers; ++i)
+    {
+        PlankNeuralNetworkFBatchWorker* w = &workerArray[i];
+        
+        if (w->threadStarted)
+        {
+            pl_Thread_Wait (&w->thread);
+            pl_Thread_DeInit (&w->thread);
+        }
+    }
+    
+    gradients = (float*)pl_DynamicArray_GetArray (&workerArray[0].gradients);
+    
+    for (i = 0; i < numWorkers; ++i)
+    {
+        if ((result = workerArray[i].result) != PlankResult_OK)
+            goto exit;
+        
+        if (i > 0)
+            pl_VectorAddF_NNN (gradients, gradients, (const float*)pl_DynamicArray_GetArray (&workerArray[i].gradients), numGradients);
+    }
+    
+    scale = p->learnRate / (float)numPatterns;
+    
+    for (i = 0; i < numLayers; ++i)
+    {
+        numNodes = pl_NeuralLayerF_GetNumOutputs (&layerArray[i]);
+        numLayerInputs = pl_NeuralLayerF_GetNumInputs (&layerArray[i]);
+
+        if ((result = pl_NeuralLayerF_ApplyGradients (&layerArray[i], gradients, gradients + numNodes * numLayerInputs, scale)) != PlankResult_OK)
+            goto exit;
+        
+        gradients += numNodes * numLayerInputs + numNodes;
+    }
+    
+exit:
+    if (pl_DynamicArray_GetItemSize (&workers) > 0)
+    {
+        workerArray = (PlankNeuralNetworkFBatchWorker*)pl_DynamicArray_GetArray (&workers);
+        numWorkers = (int)pl_DynamicArray_GetSize (&workers);
+        
+        for (i = 0; i < numWorkers; ++i)
+        {
+            pl_DynamicArray_DeInit (&workerArray[i].gradients);
+            pl_DynamicArray_DeInit (&workerArray[i].activations);
+            pl_DynamicArray_DeInit (&workerArray[i].errors);
+        }
+        
+        pl_DynamicArray_DeInit (&workers);
+    }
+    
+	return result;
+}
+
 PlankResult pl_NeuralNetworkF_GetOutputs (PlankNeuralNetworkFRef p, float* outputs)
 {
     PlankResult result;
@@ -410,6 +787,24 @@ PlankResult pl_NeuralNetworkF_SetActFunc (PlankNeuralNetworkFRef p, PlankNeuralN
     return PlankResult_OK;
 }
 
+void pl_NeuralNetworkF_ActFuncVector (PlankNeuralNetworkFRef p, float* io, const int N)
+{
+    int i;
+    
+    if (p->actFunc == pl_NeuralNetworkFDefaultActFunction)
+    {
+        pl_VectorNegF_NN (io, io, N);
+        pl_VectorExpF_NN (io, io, N);
+        pl_VectorAddF_NN1 (io, io, 1.f, N);
+        pl_VectorReciprocalF_NN (io, io, N);
+    }
+    else
+    {
+        for (i = 0; i < N; ++i)
+            io[i] = p->actFunc (io[i]);
+    }
+}
+
 PlankResult pl_NeuralNetworkF_ToJSON (PlankNeuralNetworkFRef p, PlankJSONRef j, const PlankB useBinary)
 {
     PlankResult result;
@@ -79,6 +79,21 @@ typedef PlankF (*PlankNeuralNetworkFActFunction)(PlankF);
  @return PlankResult_OK if successful, otherwise an error code. */
 PlankResult pl_NeuralNetworkF_InitWithLayersAndRange (PlankNeuralNetworkFRef p, const int* layers, const int numLayers, const float range);
 
+/** Initialise a <i>Plank %NeuralNetworkF</i> object as a copy of another.
+ The structure, weights, thresholds, learn rate, activation function offset and
+ activation function are all copied.
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param source The <i>Plank %NeuralNetworkF</i> object to copy.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralNetworkF_InitCopy (PlankNeuralNetworkFRef p, PlankNeuralNetworkFRef source);
+
+/** Copy the weights and thresholds from another network.
+ This does not allocate memory. 
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param source The <i>Plank %NeuralNetworkF</i> object to copy from, this must have the same structure.
+ @return PlankResult_OK if successful, PlankResult_ItemCountInvalid if the structures differ. */
+PlankResult pl_NeuralNetworkF_CopyWeights (PlankNeuralNetworkFRef p, PlankNeuralNetworkFRef source);
+
 /** Deinitialise a <i>Plank %NeuralNetworkF</i> object.
  @param p The <i>Plank %NeuralNetworkF</i> object.
  @return PlankResult_OK if successful, otherwise an error code. */
@@ -102,10 +117,48 @@ PlankResult pl_NeuralNetworkF_SetWeight (PlankNeuralNetworkFRef p, const int lay
 PlankResult pl_NeuralNetworkF_Get (PlankNeuralNetworkFRef p, const int layerIndex, const int nodeIndex, float* weights, float* threshold);
 PlankResult pl_NeuralNetworkF_Propogate (PlankNeuralNetworkFRef p, const float* inputs);
 PlankResult pl_NeuralNetworkF_BackProp (PlankNeuralNetworkFRef p, const float* inputs, const float* targets);
+
+/** Propogate a batch of input vectors through the network.
+ Each layer is evaluated for all of the patterns with a single matrix multiply.
+ Intermediate results use scratch memory held by the network, this is
+ resized if needed unless pl_NeuralNetworkF_ReserveBatch() was used to
+ allocate enough in advance.
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param inputs The input vectors as a contiguous numPatterns x numInputs matrix.
+ @param numPatterns The number of input vectors.
+ @param outputs Receives the output vectors as a contiguous numPatterns x numOutputs matrix.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralNetworkF_PropogateBatch (PlankNeuralNetworkFRef p, const float* inputs, const int numPatterns, float* outputs);
+
+/** Preallocate the scratch memory needed by pl_NeuralNetworkF_PropogateBatch().
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param maxPatterns The largest batch that will be passed to pl_NeuralNetworkF_PropogateBatch().
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralNetworkF_ReserveBatch (PlankNeuralNetworkFRef p, const int maxPatterns);
+
+/** Train the network on a mini-batch of patterns.
+ Unlike pl_NeuralNetworkF_BackProp() the weights are updated once for the
+ whole batch using the mean of the gradients of each pattern. The batch is split
+ between @c numThreads threads (the calling thread does one share of the work).
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param inputs The input vectors as a contiguous numPatterns x numInputs matrix.
+ @param targets The target vectors as a contiguous numPatterns x numOutputs matrix.
+ @param numPatterns The number of patterns in the batch.
+ @param numThreads The number of threads to use, 0 uses one per core.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralNetworkF_BackPropBatch (PlankNeuralNetworkFRef p, const float* inputs, const float* targets, const int numPatterns, const int numThreads);
 PlankResult pl_NeuralNetworkF_GetOutputs (PlankNeuralNetworkFRef p, float* outputs);
 const float* pl_NeuralNetworkF_GetOutputsPtr (PlankNeuralNetworkFRef p);
 PlankResult pl_NeuralNetworkF_SetActFunc (PlankNeuralNetworkFRef p, PlankNeuralNetworkFActFunction actFunc);
 
+/** Apply the activation function to a vector in place.
+ The default sigmoid is evaluated with the vector functions, a custom
+ activation function is called for each item.
+ @param p The <i>Plank %NeuralNetworkF</i> object.
+ @param io The vector to process.
+ @param N The number of items in the vector. */
+void pl_NeuralNetworkF_ActFuncVector (PlankNeuralNetworkFRef p, float* io, const int N);
+
 PlankResult pl_NeuralNetworkF_ToJSON (PlankNeuralNetworkFRef p, PlankJSONRef j, const PlankB useBinary);
 PlankResult pl_NeuralNetworkF_InitFromJSON (PlankNeuralNetworkFRef p, PlankJSONRef j);
 
@@ -120,6 +173,7 @@ typedef struct PlankNeuralNetworkF
     float learnRate, actFuncOffset;
 	PlankDynamicArray layers;
 	PlankDynamicArray errorVector;
+    PlankDynamicArray batchVector;
     PlankNeuralNetworkFActFunction actFunc;
 } PlankNeuralNetworkF;
 #endif
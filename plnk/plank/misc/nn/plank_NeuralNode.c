@@ -341,31 +341,33 @@ float pl_NeuralNodeF_GetOutput (PlankNeuralNodeFRef p)
 }
 
 PlankResult pl_NeuralNodeF_ToJSON (PlankNeuralNodeFRef p, PlankJSONRef j, const PlankB useBinary)
+{
+    return pl_NeuralNodeF_ToJSONWithWeights ((const float*)pl_DynamicArray_GetArray (&p->weightVector),
+                                             (int)pl_DynamicArray_GetSize (&p->weightVector),
+                                             p->threshold,
+                                             j,
+                                             useBinary);
+}
+
+PlankResult pl_NeuralNodeF_ToJSONWithWeights (const float* weights, const int numWeights, const float threshold, PlankJSONRef j, const PlankB useBinary)
 {
     PlankResult result;
-    int numWeights;
-    const float* weightArray;
     PlankJSONRef jnode;
-    PlankJSONRef jweights;
     
     result = PlankResult_OK;
     
     jnode = pl_JSON_Object();
-    jweights = (PlankJSONRef)PLANK_NULL;
     
     pl_JSON_ObjectSetType (jnode, PLANK_NEURALNODEF_JSON_TYPE);
     pl_JSON_ObjectSetVersionString (jnode, PLANK_NEURALNODEF_JSON_VERSION);
     
-    numWeights = (int)pl_DynamicArray_GetSize (&p->weightVector);
-    weightArray = (const float*)pl_DynamicArray_GetArray (&p->weightVector);
-
     pl_JSON_ObjectPutKey (jnode,
                           PLANK_NEURALNODEF_JSON_THRESHOLD,
-                          useBinary ? pl_JSON_FloatBinary (p->threshold) : pl_JSON_Float (p->threshold));
+                          useBinary ? pl_JSON_FloatBinary (threshold) : pl_JSON_Float (threshold));
     
     pl_JSON_ObjectPutKey (jnode,
                           PLANK_NEURALNODEF_JSON_WEIGHTS,
-                          useBinary ? pl_JSON_FloatArrayBinary (weightArray, numWeights) : pl_JSON_FloatArray (weightArray, numWeights));    
+                          useBinary ? pl_JSON_FloatArrayBinary (weights, numWeights) : pl_JSON_FloatArray (weights, numWeights));
     
     pl_JSON_ArrayAppend (j, jnode);
     
@@ -102,6 +102,17 @@ PlankResult pl_NeuralNodeF_BackProp (PlankNeuralNodeFRef p, const float* inputVe
 float pl_NeuralNodeF_GetOutput (PlankNeuralNodeFRef p);
 
 PlankResult pl_NeuralNodeF_ToJSON (PlankNeuralNodeFRef p, PlankJSONRef j, const PlankB useBinary);
+
+/** Append a node in the <i>Plank %NeuralNodeF</i> JSON format to a JSON array.
+ This allows a layer holding its weights as a contiguous matrix to write each row
+ in exactly the same format as a standalone node.
+ @param weights The weights for the node.
+ @param numWeights The number of items in @c weights.
+ @param threshold The threshold for the node.
+ @param j The JSON array to append to.
+ @param useBinary Whether to encode the values as binary.
+ @return PlankResult_OK if successful, otherwise an error code. */
+PlankResult pl_NeuralNodeF_ToJSONWithWeights (const float* weights, const int numWeights, const float threshold, PlankJSONRef j, const PlankB useBinary);
 PlankResult pl_NeuralNodeF_InitFromJSON (PlankNeuralNodeFRef p, PlankNeuralNetworkFRef network, PlankJSONRef j);
 
 
@@ -70,6 +70,10 @@
 #include "containers/plank_LockFreeDynamicArray.h"
 #include "containers/plank_LockFreeQueue.h"
 #include "containers/plank_LockFreeStack.h"
+#include "containers/plank_RingQueue.h"
+#include "core/plank_Semaphore.h"
+#include "core/plank_EpochReclaimer.h"
+#include "core/plank_MemoryArena.h"
 #include "containers/plank_SimpleQueue.h"
 #include "containers/plank_SimpleStack.h"
 #include "containers/plank_SimpleLinkedList.h"
@@ -85,6 +89,7 @@
 #include "misc/nn/plank_NeuralNetwork.h"
 
 #include "misc/json/plank_JSON.h"
+#include "misc/json/plank_JSONStream.h"
 #include "misc/base64/plank_Base64.h"
 #include "misc/zip/plank_Zip.h"
 
@@ -100,6 +105,7 @@
 #include "files/audio/plank_AudioFileMetaData.h"
 #include "files/audio/plank_AudioFileCuePoint.h"
 #include "files/audio/plank_AudioFileRegion.h"
+#include "files/audio/plank_AudioFileIndex.h"
 
 #include "random/plank_RNG.h"
 #include "fft/plank_FFT.h"
@@ -282,7 +282,7 @@ public:
     
     PLONK_INLINE_LOW Type* swap (const Type* newValue) throw() 
     {
-        return pl_AtomicP_Swap (getAtomicRef(), newValue);
+        return static_cast<Type*> (pl_AtomicP_Swap (getAtomicRef(), const_cast<Type*> (newValue)));
     }
     
     PLONK_INLINE_LOW void swapWith (AtomicValue& other) throw() 
@@ -631,19 +631,19 @@ public:
     PLONK_INLINE_LOW Type* swap (Type* const newValue) throw() 
     {
         plonk_assert (ptrUsesValidBits (newValue));
-        return pl_AtomicPX_Swap (getAtomicRef(), newValue);
+        return static_cast<Type*> (pl_AtomicPX_Swap (getAtomicRef(), newValue));
     }
     
     PLONK_INLINE_LOW Type* swapAll (Type* const newValue, const UnsignedLong newExtra) throw()
     {
         plonk_assert (ptrUsesValidBits (newValue));
-        return pl_AtomicPX_SwapAll (getAtomicRef(), newValue, newExtra, 0);
+        return static_cast<Type*> (pl_AtomicPX_SwapAll (getAtomicRef(), newValue, newExtra, 0));
     }
     
     PLONK_INLINE_LOW Type* swapAll (Type* const newValue, const UnsignedLong newExtra, UnsignedLong& oldExtra) throw()
     {
         plonk_assert (ptrUsesValidBits (newValue));
-        return pl_AtomicPX_SwapAll (getAtomicRef(), newValue, newExtra, &oldExtra);
+        return static_cast<Type*> (pl_AtomicPX_SwapAll (getAtomicRef(), newValue, newExtra, &oldExtra));
     }
     
     PLONK_INLINE_LOW void swapWith (AtomicExtended& other) throw() 
@@ -70,6 +70,7 @@ template<class ValueType>                                                   clas
 
 template<class ValueType>                                                   class LockFreeQueue;
 template<class ValueType>                                                   class LockFreeStack;
+template<class ValueType>                                                   class RingQueue;
 
 template<class ValueType>                                                   class SimpleQueue;
 template<class ValueType>                                                   class SimpleStack;
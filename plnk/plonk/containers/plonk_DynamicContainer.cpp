@@ -42,6 +42,115 @@ BEGIN_PLONK_NAMESPACE
 
 #include "../core/plonk_Headers.h"
 
+/** A block on the DynamicInternal free list. */
+struct DynamicFreeBlock
+{
+    DynamicFreeBlock* next;
+};
+
+class DynamicFreeList
+{
+public:
+    DynamicFreeList() throw()
+    :   top (static_cast<DynamicFreeBlock*> (0), 0)
+    {
+    }
+    
+    ~DynamicFreeList()
+    {
+        DynamicFreeBlock* block;
+        
+        while ((block = pop()) != 0)
+            Memory::global().free (block);
+    }
+    
+    PLONK_INLINE_LOW DynamicFreeBlock* pop() throw()
+    {
+        DynamicFreeBlock* block;
+        UnsignedLong tag;
+        
+        do
+        {
+            tag = top.getExtraUnchecked();
+            block = top.getPtrUnchecked();
+            
+            if (block == 0)
+                return 0;
+            
+        } while (! top.compareAndSwap (block, tag, block->next, tag + 1));
+        
+        --numBlocks;
+        return block;
+    }
+    
+    PLONK_INLINE_LOW bool push (DynamicFreeBlock* block) throw()
+    {
+        if (numBlocks.getValueUnchecked() >= DynamicInternal::MaximumFreeBlocks)
+            return false;
+        
+        UnsignedLong tag;
+        DynamicFreeBlock* oldTop;
+        
+        ++numBlocks;
+        
+        do
+        {
+            tag = top.getExtraUnchecked();
+            oldTop = top.getPtrUnchecked();
+            block->next = oldTop;
+        } while (! top.compareAndSwap (oldTop, tag, block, tag + 1));
+        
+        return true;
+    }
+    
+private:
+    AtomicExtended<DynamicFreeBlock*> top;
+    AtomicInt numBlocks;
+};
+
+static DynamicFreeList& getDynamicFreeList() throw()
+{
+    static DynamicFreeList freeList;
+    return freeList;
+}
+
+void* DynamicInternal::operator new (size_t size)
+{
+    plonk_assert (size == sizeof (DynamicInternal)); // subclasses would need their own
+    
+    void* ptr = getDynamicFreeList().pop();
+    
+    if (ptr == 0)
+        ptr = PlonkBase::operator new (size);
+    
+    return ptr;
+}
+
+void DynamicInternal::operator delete (void* ptr)
+{
+    if (ptr == 0)
+        return;
+    
+    if (! getDynamicFreeList().push (static_cast<DynamicFreeBlock*> (ptr)))
+        PlonkBase::operator delete (ptr);
+}
+
+DynamicInternal::DynamicInternal (SmallValue const& value, const int smallTypeCode) throw()
+:   SmartPointer (SmartPointer::RefCountIntrusive),
+    item (static_cast<SmartPointer*> (0)),
+    typeCode (smallTypeCode),
+    small (value)
+{
+    plonk_assert (TypeCode::isSmall (smallTypeCode));
+}
+
+bool DynamicInternal::isSmall() const throw()
+{
+    return TypeCode::isSmall (typeCode);
+}
+
+//------------------------------------------------------------------------------
+
 Dynamic::Dynamic() throw()
 :   Base (new DynamicInternal())
 {
@@ -65,10 +174,131 @@ Dynamic::Dynamic (Internal* internalToUse) throw()
 {
 }
 
-Dynamic Dynamic::fromWeak (Weak const& weak) throw()
+static PLONK_INLINE_LOW DynamicInternal::SmallValue smallInteger (const LongLong value) throw()
 {
-    return weak.fromWeak();
-}    
+    DynamicInternal::SmallValue small;
+    small.i = value;
+    return small;
+}
+
+static PLONK_INLINE_LOW DynamicInternal::SmallValue smallDouble (const double value) throw()
+{
+    DynamicInternal::SmallValue small;
+    small.d = value;
+    return small;
+}
+
+static PLONK_INLINE_LOW DynamicInternal::SmallValue smallTimeStamp (TimeStamp const& value) throw()
+{
+    DynamicInternal::SmallValue small;
+    small.t.time = value.getTime();
+    small.t.fraction = value.getFraction();
+    return small;
+}
+
+Dynamic::Dynamic (const int value) throw()
+:   Base (new DynamicInternal (smallInteger (value), TypeCode::Int))
+{
+}
+
+Dynamic::Dynamic (const LongLong value) throw()
+:   Base (new DynamicInternal (smallInteger (value), TypeCode::LongLong))
+{
+}
+
+Dynamic::Dynamic (const float value) throw()
+:   Base (new DynamicInternal (smallDouble (value), TypeCode::Float))
+{
+}
+
+Dynamic::Dynamic (const double value) throw()
+:   Base (new DynamicInternal (smallDouble (value), TypeCode::Double))
+{
+}
+
+Dynamic::Dynamic (TimeStamp const& value) throw()
+:   Base (new DynamicInternal (smallTimeStamp (value), TypeCode::TimeStamp))
+{
+}
+
+Dynamic Dynamic::fromSmallText (const char* text) throw()
+{
+    if (text == 0)
+        return Dynamic();
+    
+    const size_t length = strlen (text);
+    
+    if (length >= DynamicInternal::SmallTextLength)
+        return Text (text);
+    
+    DynamicInternal::SmallValue small;
+    memcpy (small.text, text, length + 1);
+    return Dynamic (new DynamicInternal (small, TypeCode::SmallText));
+}
+
+int Dynamic::asInt() const throw()
+{
+    return int (this->asLongLong());
+}
+
+LongLong Dynamic::asLongLong() const throw()
+{
+    const DynamicInternal::SmallValue& small = this->getInternal()->getSmall();
+    
+    switch (this->getTypeCode())
+    {
+        case TypeCode::Int:
+        case TypeCode::LongLong:    return small.i;
+        case TypeCode::Float:
+        case TypeCode::Double:      return LongLong (small.d);
+        case TypeCode::TimeStamp:   return small.t.time;
+        default:                    return 0;
+    }
+}
+
+double Dynamic::asDouble() const throw()
+{
+    const DynamicInternal::SmallValue& small = this->getInternal()->getSmall();
+    
+    switch (this->getTypeCode())
+    {
+        case TypeCode::Int:
+        case TypeCode::LongLong:    return double (small.i);
+        case TypeCode::Float:
+        case TypeCode::Double:      return small.d;
+        case TypeCode::TimeStamp:   return double (small.t.time) + small.t.fraction;
+        default:                    return 0.0;
+    }
+}
+
+TimeStamp Dynamic::asTimeStamp() const throw()
+{
+    if (this->getTypeCode() != TypeCode::TimeStamp)
+        return TimeStamp();
+    
+    const DynamicInternal::SmallValue& small = this->getInternal()->getSmall();
+    return TimeStamp (small.t.time, small.t.fraction);
+}
+
+const char* Dynamic::getSmallText() const throw()
+{
+    return this->getTypeCode() == TypeCode::SmallText ? this->getInternal()->getSmall().text : 0;
+}
+
+Text Dynamic::toText() const throw()
+{
+    switch (this->getTypeCode())
+    {
+        case TypeCode::Text:        return this->as<Text>();
+        case TypeCode::SmallText:   return Text (this->getInternal()->getSmall().text);
+        case TypeCode::Int:         return Text (this->asInt());
+        case TypeCode::LongLong:    return Text (this->asLongLong());
+        case TypeCode::Float:       
+        case TypeCode::Double:      
+        case TypeCode::TimeStamp:   return Text (this->asDouble());
+        default:                    return Text::getEmpty();
+    }
+}
 
 Dynamic Dynamic::getMaxBlockSize() const throw()
 {
@@ -152,11 +382,14 @@ int Dynamic::getNumChannels() const throw()
         case TypeCode::Float:
         case TypeCode::Double:
         case TypeCode::Int: 
+        case TypeCode::LongLong: 
         case TypeCode::Int24: 
         case TypeCode::Short: 
         case TypeCode::Long: 
         case TypeCode::Char:
         case TypeCode::Bool:
+        case TypeCode::TimeStamp:
+        case TypeCode::SmallText:
             
         case TypeCode::FloatVariable:
         case TypeCode::DoubleVariable:
@@ -224,7 +457,9 @@ int Dynamic::getNumChannels() const throw()
         case TypeCode::DoubleBufferQueue:
         case TypeCode::IntBufferQueue:
         case TypeCode::Int24BufferQueue:
-        case TypeCode::LongBufferQueue:   return 1;
+        case TypeCode::LongBufferQueue:
+            
+        case TypeCode::FloatNeuralNetworkDoubleBuffer:  return 1;
             
         default:
             plonk_assertfalse;
@@ -47,25 +47,55 @@
 
 #include "../core/plonk_TypeUtility.h"
 
+class TimeStamp;
+template<class Type> class Variable;
+template<class ContainerType> struct DynamicSmallValue;
 
+/** The internal for Dynamic.
+ As well as a reference to any other container a DynamicInternal can hold a 
+ small value (int, LongLong, float, double, TimeStamp or a short string) 
+ in place so these don't need a further object. DynamicInternal objects are 
+ recycled through a lock-free free list so creating a Dynamic for a message
+ payload doesn't normally touch the allocator. */
 class DynamicInternal : public SmartPointer
 {
 public:
     typedef SmartPointerContainer<SmartPointer> GenericContainer;
     
+    enum Constants
+    {
+        SmallTextLength = 24,       ///< Includes the null terminator.
+        MaximumFreeBlocks = 4096
+    };
+    
+    union SmallValue
+    {
+        LongLong i;
+        double d;
+        struct { LongLong time; double fraction; } t;
+        char text[SmallTextLength];
+    };
+    
     DynamicInternal() throw()
-    :   item (static_cast<SmartPointer*> (0)),
+    :   SmartPointer (SmartPointer::RefCountIntrusive),
+        item (static_cast<SmartPointer*> (0)),
         typeCode (0)
     {
     }
     
+    DynamicInternal (SmallValue const& value, const int smallTypeCode) throw();
+    
     ~DynamicInternal()
     {
     }
     
+    static void* operator new (size_t size);
+    static void operator delete (void* ptr);
+    
     template<class ContainerType>
     DynamicInternal (ContainerType const& other) throw()
-    :   item (static_cast<SmartPointer*> (other.getInternal())),
+    :   SmartPointer (SmartPointer::RefCountIntrusive),
+        item (static_cast<SmartPointer*> (other.getInternal())),
         typeCode (TypeUtility<ContainerType>::getTypeCode())
     {
     }
@@ -104,18 +134,25 @@ public:
         return ! this->isNull();
     }
     
+    bool isSmall() const throw();
+    
+    PLONK_INLINE_LOW const SmallValue& getSmall() const throw()
+    {
+        return small;
+    }
+    
 private:
     GenericContainer item;
     int typeCode;
+    SmallValue small;
 };
 
 /** @ingroup PlonkContainerClasses */
-class Dynamic : public SmartPointerContainer<DynamicInternal>
+class Dynamic : public SmartPointerContainer<DynamicInternal,false>
 {
 public:
-    typedef SmartPointerContainer<DynamicInternal>  Base;
+    typedef SmartPointerContainer<DynamicInternal,false>    Base;
     typedef SmartPointerContainer<SmartPointer>     GenericContainer;
-    typedef WeakPointerContainer<Dynamic>           Weak;
     typedef DynamicInternal                         Internal;
 
     Dynamic() throw();
@@ -130,7 +167,44 @@ public:
     }
     
     explicit Dynamic (Internal* internalToUse) throw();
-    static Dynamic fromWeak (Weak const& weak) throw();
+    
+    /** @name Small values.
+     These are stored in the Dynamic itself rather than a separate object. */
+    /// @{
+    
+    Dynamic (const int value) throw();
+    Dynamic (const LongLong value) throw();
+    Dynamic (const float value) throw();
+    Dynamic (const double value) throw();
+    Dynamic (TimeStamp const& value) throw();
+    
+    /** Creates a Dynamic holding a copy of a string.
+     Strings shorter than DynamicInternal::SmallTextLength are stored in place, 
+     longer strings are stored as Text. */
+    static Dynamic fromSmallText (const char* text) throw();
+    
+    PLONK_INLINE_LOW bool isSmall() const throw()                     { return this->getInternal()->isSmall(); }
+    
+    /** Returns a small numerical value converted to an int, or 0. */
+    int asInt() const throw();
+    
+    /** Returns a small numerical value converted to a LongLong, or 0. */
+    LongLong asLongLong() const throw();
+    
+    /** Returns a small numerical value converted to a double, or 0. */
+    double asDouble() const throw();
+    
+    /** Returns a small TimeStamp value or a zero TimeStamp. */
+    TimeStamp asTimeStamp() const throw();
+    
+    /** Returns a small string or 0 if this doesn't hold one. */
+    const char* getSmallText() const throw();
+    
+    /** Returns a small string or Text as Text. 
+     Small numerical values are formatted. */
+    Text toText() const throw();
+    
+    /// @}
         
     template<class ContainerType>
     void setItem (ContainerType const& other) throw()
@@ -165,10 +239,15 @@ public:
         return reinterpret_cast<ContainerType&> (this->getItem());
     }
         
+    /** Returns the item as a ContainerType or a null ContainerType if it isn't one.
+     A small numerical value can also be returned as a Variable of that type 
+     (e.g., as<IntVariable>()) which is how it would have been sent before. */
     template<class ContainerType>
     PLONK_INLINE_LOW ContainerType as() const throw()
     {              
-        if ((this->isItemNull()) || (TypeUtility<ContainerType>::getTypeCode() != this->getTypeCode()))
+        if (this->isSmall())
+            return DynamicSmallValue<ContainerType>::as (*this);
+        else if ((this->isItemNull()) || (TypeUtility<ContainerType>::getTypeCode() != this->getTypeCode()))
             return ContainerType();
         else
             return reinterpret_cast<const ContainerType&> (this->getItem());
@@ -207,4 +286,42 @@ private:
     template<class ContainerType> operator ContainerType& ();
 };
 
+/** Converts a small Dynamic value to another container. @internal */
+template<class ContainerType>
+struct DynamicSmallValue
+{
+    static PLONK_INLINE_LOW ContainerType as (Dynamic const& dynamic) throw()
+    {
+        (void)dynamic;
+        return ContainerType();
+    }
+};
+
+/** Gets a small Dynamic value as a number. @internal */
+template<class Type>
+struct DynamicSmallNumber
+{
+    static PLONK_INLINE_LOW bool get (Dynamic const& dynamic, Type& value) throw()
+    {
+        (void)dynamic;
+        (void)value;
+        return false;
+    }
+};
+
+template<> struct DynamicSmallNumber<int>       { static PLONK_INLINE_LOW bool get (Dynamic const& dynamic, int& value) throw()         { value = dynamic.asInt(); return true; } };
+template<> struct DynamicSmallNumber<LongLong>  { static PLONK_INLINE_LOW bool get (Dynamic const& dynamic, LongLong& value) throw()    { value = dynamic.asLongLong(); return true; } };
+template<> struct DynamicSmallNumber<float>     { static PLONK_INLINE_LOW bool get (Dynamic const& dynamic, float& value) throw()       { value = float (dynamic.asDouble()); return true; } };
+template<> struct DynamicSmallNumber<double>    { static PLONK_INLINE_LOW bool get (Dynamic const& dynamic, double& value) throw()      { value = dynamic.asDouble(); return true; } };
+
+template<class Type>
+struct DynamicSmallValue< Variable<Type> >
+{
+    static PLONK_INLINE_LOW Variable<Type> as (Dynamic const& dynamic) throw()
+    {
+        Type value;
+        return DynamicSmallNumber<Type>::get (dynamic, value) ? Variable<Type> (value) : Variable<Type>();
+    }
+};
+
 #endif // PLONK_DYNAMICCONTAINER_H
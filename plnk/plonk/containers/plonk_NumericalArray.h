@@ -302,8 +302,29 @@ class NumericalArrayConverterBase<float, Int24>
 public:
     static PLONK_INLINE_LOW void convertDirect (float* const dst, const Int24* const src, const UnsignedLong numItems) throw()
     {
-        for (UnsignedLong i = 0; i < numItems; ++i)
-            dst[i] = float (src[i]);
+        // unpack to int in small chunks so the int to float conversion can use the vector routines
+        PLANK_ALIGN (PLANK_SIMDF_SIZE)
+        int temp[64];
+        
+        UnsignedLong i = 0;
+        
+        while (i < numItems)
+        {
+            const UnsignedLong numChunk = plonk::min (numItems - i, UnsignedLong (64));
+            
+            for (UnsignedLong j = 0; j < numChunk; ++j)
+            {
+                const PlankUC* const raw = src[i + j].getRaw().data;
+#if PLANK_LITTLEENDIAN
+                temp[j] = int (raw[0]) | (int (raw[1]) << 8) | (int ((signed char) raw[2]) << 16);
+#else
+                temp[j] = int (raw[2]) | (int (raw[1]) << 8) | (int ((signed char) raw[0]) << 16);
+#endif
+            }
+            
+            pl_VectorConvertI2F_NN (dst + i, temp, numChunk);
+            i += numChunk;
+        }
     }
     
     static PLONK_INLINE_LOW void convertScaled (float* const dst, const Int24* const src, const UnsignedLong numItems) throw()
@@ -765,6 +786,92 @@ public:
     }
 };
 
+//------------------------------------------------------------------------------
+
+template<class NumericalType>
+class NumericalArrayInterleaver
+{
+public:
+    PLONK_INLINE_LOW static void interleave (NumericalType* dst,
+                                             const NumericalType* const* srcs,
+                                             const UnsignedLong numChannels,
+                                             const UnsignedLong numFrames) throw()
+    {
+        for (UnsignedLong channel = 0; channel < numChannels; ++channel)
+        {
+            const NumericalType* src = srcs[channel];
+            NumericalType* frame = dst + channel;
+            
+            for (UnsignedLong i = 0; i < numFrames; ++i, frame += numChannels)
+                *frame = src[i];
+        }
+    }
+    
+    PLONK_INLINE_LOW static void deinterleave (NumericalType* const* dsts,
+                                               const NumericalType* src,
+                                               const UnsignedLong numChannels,
+                                               const UnsignedLong numFrames) throw()
+    {
+        for (UnsignedLong channel = 0; channel < numChannels; ++channel)
+        {
+            NumericalType* dst = dsts[channel];
+            const NumericalType* frame = src + channel;
+            
+            for (UnsignedLong i = 0; i < numFrames; ++i, frame += numChannels)
+                dst[i] = *frame;
+        }
+    }
+};
+
+#define PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(TYPECODE)\
+    template<>\
+    class NumericalArrayInterleaver<Plank##TYPECODE>\
+    {\
+    public:\
+        PLONK_INLINE_LOW static void interleave (Plank##TYPECODE* dst, const Plank##TYPECODE* const* srcs, const UnsignedLong numChannels, const UnsignedLong numFrames) throw() {\
+            pl_VectorInterleave##TYPECODE##_Nn (dst, srcs, numChannels, numFrames);\
+        }\
+        PLONK_INLINE_LOW static void deinterleave (Plank##TYPECODE* const* dsts, const Plank##TYPECODE* src, const UnsignedLong numChannels, const UnsignedLong numFrames) throw() {\
+            pl_VectorDeinterleave##TYPECODE##_nN (dsts, src, numChannels, numFrames);\
+        }\
+    }
+
+PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(F);
+PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(D);
+PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(S);
+PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(I);
+PLONK_NUMERICALARRAYINTERLEAVER_DEFINE(LL);
+
+//------------------------------------------------------------------------------
+
+template<class NumericalType>
+class NumericalArrayMulAdd
+{
+public:
+    PLONK_INLINE_LOW static void mulAdd (NumericalType* dst,
+                                         const NumericalType* src,
+                                         const NumericalType mul,
+                                         const NumericalType* add,
+                                         const UnsignedLong numItems) throw()
+    {
+        for (UnsignedLong i = 0; i < numItems; ++i)
+            dst[i] = src[i] * mul + add[i];
+    }
+};
+
+#define PLONK_NUMERICALARRAYMULADD_DEFINE(TYPECODE)\
+    template<>\
+    class NumericalArrayMulAdd<Plank##TYPECODE>\
+    {\
+    public:\
+        PLONK_INLINE_LOW static void mulAdd (Plank##TYPECODE* dst, const Plank##TYPECODE* src, const Plank##TYPECODE mul, const Plank##TYPECODE* add, const UnsignedLong numItems) throw() {\
+            pl_VectorMulAdd##TYPECODE##_NN1N (dst, src, mul, add, numItems);\
+        }\
+    }
+
+PLONK_NUMERICALARRAYMULADD_DEFINE(F);
+PLONK_NUMERICALARRAYMULADD_DEFINE(D);
+
 
 //------------------------------------------------------------------------------
 
@@ -804,7 +911,6 @@ class NumericalArray : public ObjectArray<NumericalType>
 public:
     typedef ObjectArrayInternal<NumericalType>          Internal;
     typedef ObjectArray<NumericalType>                  Base;   
-    typedef WeakPointerContainer<NumericalArray>        Weak;
     
     typedef ObjectArray<NumericalType>                  ObjectArrayType;
     typedef ObjectArray<ObjectArrayType>                ObjectArray2DType;
@@ -848,13 +954,6 @@ public:
     
     PLONKSMARTPOINTERCONTAINER_DEEPCOPY(NumericalArray,Internal)
         
-    /** Get a weakly linked copy of this object. 
-     This will return a blank/empty/null object of this type if
-     the original has already been deleted. */
-    static NumericalArray fromWeak (Weak const& weak) throw()
-    {
-        return weak.fromWeak();
-    }
         
     static const NumericalArray& getNull() throw()
 	{
@@ -917,6 +1016,40 @@ public:
         NumericalArrayFiller<NumericalType>::fill (dst, value, numItems);
     }
     
+    /** Interleaves separate channel arrays into a single frame-major array.
+     @param dst     The destination, this must hold numChannels x numFrames items.
+     @param srcs    An array of numChannels pointers to the channel data. */
+    static PLONK_INLINE_LOW void interleave (NumericalType* const dst, 
+                                             const NumericalType* const* srcs, 
+                                             const UnsignedLong numChannels,
+                                             const UnsignedLong numFrames) throw()
+    {
+        NumericalArrayInterleaver<NumericalType>::interleave (dst, srcs, numChannels, numFrames);
+    }
+    
+    /** Deinterleaves a single frame-major array into separate channel arrays.
+     @param dsts    An array of numChannels pointers to the channel data.
+     @param src     The source, this must hold numChannels x numFrames items. */
+    static PLONK_INLINE_LOW void deinterleave (NumericalType* const* dsts, 
+                                               const NumericalType* const src, 
+                                               const UnsignedLong numChannels,
+                                               const UnsignedLong numFrames) throw()
+    {
+        NumericalArrayInterleaver<NumericalType>::deinterleave (dsts, src, numChannels, numFrames);
+    }
+    
+    /** Multiplies an array by a scalar and adds a second array.
+     @f$ dst = src \times mul + add @f$ 
+     The destination may be the same as either of the sources. */
+    static PLONK_INLINE_LOW void mulAdd (NumericalType* const dst, 
+                                         const NumericalType* const src, 
+                                         const NumericalType mul,
+                                         const NumericalType* const add,
+                                         const UnsignedLong numItems) throw()
+    {
+        NumericalArrayMulAdd<NumericalType>::mulAdd (dst, src, mul, add, numItems);
+    }
+    
     PLONK_INLINE_LOW void fill (const NumericalType value) throw()
     {
         const int length = this->length();
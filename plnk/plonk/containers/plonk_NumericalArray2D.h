@@ -50,7 +50,6 @@ class NumericalArray2D : public ObjectArray2DBase<NumericalType, RowType>
 public:    
     typedef ObjectArrayInternal<RowType>                Internal; 
     typedef ObjectArray2DBase<NumericalType, RowType>   Base;    
-    typedef WeakPointerContainer<NumericalArray2D>      Weak;
     
     typedef ObjectArray<NumericalType>                  ObjectArrayType;
     typedef ObjectArray<ObjectArrayType>                ObjectArray2DType;
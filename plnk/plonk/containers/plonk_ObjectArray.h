@@ -101,12 +101,11 @@
  */
 template<class ObjectType>
 //class ObjectArray : public SenderContainer< ObjectArrayInternal<ObjectType> >
-class ObjectArray : public SmartPointerContainer< ObjectArrayInternal<ObjectType> >
+class ObjectArray : public SmartPointerContainer< ObjectArrayInternal<ObjectType>, false >
 {
 public:
     typedef ObjectArrayInternal<ObjectType>             Internal;
-    typedef SmartPointerContainer<Internal>             Base;    
-    typedef WeakPointerContainer<ObjectArray>           Weak;
+    typedef SmartPointerContainer<Internal,false>       Base;    
     
     typedef ObjectArray<ObjectType>                     ObjectArrayType;
     typedef ObjectArray<ObjectArrayType>                ObjectArray2DType;
@@ -141,13 +140,6 @@ public:
 	{
 	}
     
-    /** Get a weakly linked copy of this object. 
-     This will return a blank/empty/null object of this type if
-     the original has already been deleted. */    
-    static ObjectArray fromWeak (Weak const& weak) throw()
-    {
-        return weak.fromWeak();
-    }
     
     	
 	/** Creates an array with a particular size/length.
@@ -50,7 +50,6 @@ class ObjectArray2DBase : public ObjectArray<RowType>
 public:
     typedef ObjectArrayInternal<RowType>                Internal;
     typedef ObjectArray<RowType>                        Base;    
-    typedef WeakPointerContainer<ObjectArray2DBase>     Weak;
     
     typedef ObjectArray<ArrayType>                      ObjectArrayType;
     typedef ObjectArray<ObjectArrayType>                ObjectArray2DType;
@@ -588,7 +587,6 @@ class ObjectArray2D : public ObjectArray2DBase<ArrayType,RowType>
 public:
     typedef ObjectArrayInternal<RowType>            Internal; 
     typedef ObjectArray2DBase<ArrayType,RowType>    Base;    
-    typedef WeakPointerContainer<ObjectArray2D>     Weak;
     
     typedef ObjectArray<ArrayType>                  ObjectArrayType;
     typedef ObjectArray<ObjectArrayType>            ObjectArray2DType;
@@ -621,13 +619,6 @@ public:
         return *this;
 	}
     
-    /** Get a weakly linked copy of this object. 
-     This will return a blank/empty/null object of this type if
-     the original has already been deleted. */    
-    static ObjectArray2D fromWeak (Weak const& weak) throw()
-    {
-        return weak.fromWeak();
-    }    
         
     static const ObjectArray2D& getNull() throw()
 	{
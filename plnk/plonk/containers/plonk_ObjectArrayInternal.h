@@ -106,7 +106,8 @@ template<class ObjectType, class BaseType>
 ObjectArrayInternalBase<ObjectType,BaseType>
 ::ObjectArrayInternalBase (const int initSize, 
                            const bool isNullTerminated) throw()
-:	allocatedSize (initSize <= 0 ? 0 : initSize), 
+:	BaseType (SmartPointer::RefCountIntrusive), // arrays are never weakly referenced
+    allocatedSize (initSize <= 0 ? 0 : initSize), 
     sizeUsed (allocatedSize),
     array (allocatedSize == 0 ? 0 : ArrayAllocator<ObjectType>::allocate (allocatedSize)),
     arrayIsNullTerminated (isNullTerminated),
@@ -120,7 +121,8 @@ ObjectArrayInternalBase<ObjectType,BaseType>
                            ObjectType *dataToUse, 
                            const bool isNullTerminated,
                            const bool shouldTakeOwnership) throw()
-:	allocatedSize (shouldTakeOwnership ? initSize : 0),
+:	BaseType (SmartPointer::RefCountIntrusive),
+    allocatedSize (shouldTakeOwnership ? initSize : 0),
     sizeUsed (initSize),
     array (dataToUse),
     arrayIsNullTerminated (isNullTerminated),
@@ -334,8 +336,12 @@ void ObjectArrayInternalBase<ObjectType,BaseType>
         {
             arrayIsNullTerminated = needsNullTermination;
             needsUpdate = true;
-            ObjectType null = TypeUtility<ObjectType>::getNull();// ObjectType();
-            array[this->length()] = null;//ObjectType();
+            
+            if (arrayIsNullTerminated)
+            {
+                ObjectType null = TypeUtility<ObjectType>::getNull();// ObjectType();
+                array[this->length()] = null;//ObjectType();
+            }
         }
     }
     else 
@@ -352,7 +358,7 @@ void ObjectArrayInternalBase<ObjectType,BaseType>
         
         needsUpdate = true;
         
-        if (array)
+        if (array && arrayIsNullTerminated)
         {
             ObjectType null = TypeUtility<ObjectType>::getNull();// ObjectType();
             array[this->length()] = null;//ObjectType();
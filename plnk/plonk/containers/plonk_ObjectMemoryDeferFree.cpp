@@ -64,6 +64,12 @@ static PLONK_INLINE_LOW void staticDoFree (void* userData, void* ptr) throw()
     pl_MemoryDefaultFree (userData, ptr);
 }
 
+static AtomicValue<ObjectMemoryDeferFree*>& getRunning() throw()
+{
+    static AtomicValue<ObjectMemoryDeferFree*> running;
+    return running;
+}
+
 ObjectMemoryDeferFree::ObjectMemoryDeferFree (Memory& m) throw()
 :   ObjectMemoryBase (m),
     Threading::Thread ("plonk::ObjectMemoryDeferFree::Threading::Thread")
@@ -72,20 +78,39 @@ ObjectMemoryDeferFree::ObjectMemoryDeferFree (Memory& m) throw()
     getMemory().resetFunctions();
     
     AtomicOps::memoryBarrier();
-    queue = new LockFreeQueue<Element>;
+    ResultCode result = pl_EpochReclaimer_Init (&reclaimer, MaxThreads, NumBatches, BatchSize);
+    plonk_assert (result == PlankResult_OK);
+    result = pl_EpochReclaimer_SetFreeFunction (&reclaimer, staticDoFree, this);
+    plonk_assert (result == PlankResult_OK);
+    result = pl_RingQueue_Init (&overflow, PlankRingQueueMode_MultiProducerMultiConsumer, OverflowSize, sizeof (void*));
+    plonk_assert (result == PlankResult_OK);
     AtomicOps::memoryBarrier();
     
+#ifndef PLONK_DEBUG
+    (void)result;
+#endif
+    
     getMemory().setUserData (this);
     getMemory().setFunctions (staticAlloc, staticFree); 
+    
+    getRunning().setValue (this);
 }
 
 ObjectMemoryDeferFree::~ObjectMemoryDeferFree()
 {    
-    setShouldExitAndWait(); // the thread clears the queues
+    if (getRunning().getValue() == this)
+        getRunning().setValue (0);
+    
+    setShouldExit();
+    pl_EpochReclaimer_Signal (&reclaimer); // the background thread sleeps until woken
+    wait();
+    
     //<-- something could happen here on another thread but we should be shut down by now..?
     getMemory().resetUserData();
     getMemory().resetFunctions(); 
-    delete queue;
+    freeOverflow();
+    pl_RingQueue_DeInit (&overflow);
+    pl_EpochReclaimer_DeInit (&reclaimer); // frees anything still waiting
 }
 
 void* ObjectMemoryDeferFree::allocateBytes (PlankUL size)
@@ -103,45 +128,61 @@ void ObjectMemoryDeferFree::free (void* ptr)
         }
         else
         {
-            Element d (ptr);
-            queue->push (d);
+            PlankEpochParticipantRef participant = pl_EpochReclaimer_GetParticipant (&reclaimer);
+            
+            if ((participant != 0) && (pl_EpochParticipant_Retire (participant, ptr) == PlankResult_OK))
+                return;
+            
+            // out of batches, the background thread frees these next time it wakes
+            if (pl_RingQueue_Push (&overflow, &ptr) == PlankResult_OK)
+            {
+                pl_EpochReclaimer_Signal (&reclaimer);
+                return;
+            }
+            
+            // better than blocking or growing without bound
+            pl_MemoryDefaultFree (this, ptr);
         }
     }
 }
 
-//void ObjectMemoryDeferFree::increaseQueueCache (const int count) throw()
-//{
-//    queue.increaseCache (count);
-//}
+void ObjectMemoryDeferFree::flush() throw()
+{
+    PlankEpochParticipantRef participant = pl_EpochReclaimer_GetParticipant (&reclaimer);
+    
+    if (participant != 0)
+        pl_EpochParticipant_Flush (participant);
+}
 
-ResultCode ObjectMemoryDeferFree::run() throw()
+void ObjectMemoryDeferFree::flushCurrentThread() throw()
 {
-    const double minDuration = 0.000001;
-    const double maxDuration = 0.1;
-    double duration = minDuration;
+    ObjectMemoryDeferFree* const running = getRunning().getValue();
     
+    if (running != 0)
+        pl_EpochReclaimer_FlushParticipant (&running->reclaimer);
+}
+
+void ObjectMemoryDeferFree::freeOverflow() throw()
+{
+    void* ptr;
+    
+    // only retired once no longer shared so these don't need to wait for the epoch
+    while (pl_RingQueue_Pop (&overflow, &ptr) == PlankResult_OK)
+        staticDoFree (this, ptr);
+}
+
+ResultCode ObjectMemoryDeferFree::run() throw()
+{
     while (!getShouldExit())
     {
         plonk_assert (getMemory().getUserData() == this);
 
-        Element d = queue->pop();
-        
-        if (d.ptr != 0)
-        {
-            duration = minDuration; // reset back to high speed
-            staticDoFree (this, d.ptr);
-        }
-        else 
-        {
-            // gradually increase the amount of sleep if the queue is empty
-            duration = plonk::min (duration * 2.0, maxDuration);
-        }
-        
-        Threading::sleep (duration);
+        pl_EpochReclaimer_Collect (&reclaimer);
+        freeOverflow();
+        pl_EpochReclaimer_Wait (&reclaimer);
     }
     
     getMemory().resetFunctions();
-    queue->clearAll();
     
     return 0;
 }
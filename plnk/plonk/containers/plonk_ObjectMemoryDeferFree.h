@@ -39,20 +39,32 @@
 #ifndef PLONK_ObjectMemoryDeferFree_H
 #define PLONK_ObjectMemoryDeferFree_H
 
+/** Frees memory on a background thread so that objects can be released on the audio thread.
+ Each thread that frees memory adds the pointer to a batch of its own in a
+ PlankEpochReclaimer without any atomic operations or allocation. Full batches
+ are handed to the background thread which frees them. Handing over a batch
+ wakes the background thread without blocking, otherwise it sleeps.
+ 
+ A batch that is not full stays with its thread until the thread frees more 
+ memory, calls flush() or exits, audio hosts call flushCurrentThread() at the
+ end of each callback. A thread's slot is released when it exits so only 
+ MaxThreads threads need to be freeing memory at the same time. If all of a
+ thread's batches are waiting to be freed (or there are no free slots) the 
+ pointer goes through a fixed size overflow queue instead. Only if that is
+ full too is the memory freed directly on the calling thread. */
 class ObjectMemoryDeferFree :   public ObjectMemoryBase,
                                 public Threading::Thread
 {
 public:   
     
-    class Element : public PlonkBase
+    enum Constants
     {
-    public:
-        Element() : ptr (0) { }
-        Element (void* p) : ptr (p) { }
-
-        void* ptr;
+        MaxThreads = 32,
+        NumBatches = 16,
+        BatchSize = 32,
+        OverflowSize = 4096
     };
-            
+    
     ObjectMemoryDeferFree (Memory& memory) throw();
     ~ObjectMemoryDeferFree();
     
@@ -64,13 +76,18 @@ public:
     
     void* allocateBytes (PlankUL size);
     void free (void* ptr);
-
-//    void increaseQueueCache (const int count) throw();
     
-private:
-    LockFreeQueue<Element>* queue;
+    /** Hands the calling thread's partly filled batch to the background thread. */
+    void flush() throw();
+    
+    /** Calls flush() on the ObjectMemoryDeferFree that is running, if there is one. */
+    static void flushCurrentThread() throw();
     
+private:
+    void freeOverflow() throw();
     
+    PLONK_ALIGN(16) PlankEpochReclaimer reclaimer;
+    PLONK_ALIGN(16) PlankRingQueue overflow;    // pointers freed when all the thread's batches were in use
 };
 
 #endif // PLONK_ObjectMemoryDeferFree_H
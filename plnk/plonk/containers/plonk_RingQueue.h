@@ -0,0 +1,226 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_RINGQUEUE_H
+#define PLONK_RINGQUEUE_H
+
+#include "../core/plonk_CoreForwardDeclarations.h"
+#include "plonk_ContainerForwardDeclarations.h"
+
+#include "../core/plonk_SmartPointer.h"
+#include "../core/plonk_WeakPointer.h"
+
+template<class ValueType>                                               
+class RingQueueInternal : public SmartPointer
+{
+public:
+    typedef RingQueue<ValueType>        QueueType;
+    
+    RingQueueInternal (const int capacity, const bool multiThreaded) throw()
+    {
+        ResultCode result = pl_RingQueue_Init (&queue,
+                                               multiThreaded ? PlankRingQueueMode_MultiProducerMultiConsumer : PlankRingQueueMode_SingleProducerSingleConsumer,
+                                               capacity, sizeof (ValueType));
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    ~RingQueueInternal()
+    {
+        ResultCode result = pl_RingQueue_DeInit (&queue);
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW bool push (ValueType const& value) throw()
+    {
+        return pl_RingQueue_Push (&queue, &value) == PlankResult_OK;
+    }
+    
+    PLONK_INLINE_LOW bool pop (ValueType& value) throw()
+    {
+        return pl_RingQueue_Pop (&queue, &value) == PlankResult_OK;
+    }
+    
+    void clear() throw()
+    {
+        ResultCode result = pl_RingQueue_Clear (&queue);
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW int length() throw()
+    {
+        return pl_RingQueue_GetSize (&queue);
+    }
+    
+    PLONK_INLINE_LOW int getCapacity() throw()
+    {
+        return pl_RingQueue_GetCapacity (&queue);
+    }
+    
+    PLONK_INLINE_LOW bool isMultiThreaded() throw()
+    {
+        return pl_RingQueue_GetMode (&queue) == PlankRingQueueMode_MultiProducerMultiConsumer;
+    }
+    
+    friend class RingQueue<ValueType>;
+    
+private:
+    PLONK_ALIGN(16) PlankRingQueue queue;
+};
+
+//------------------------------------------------------------------------------
+
+/** A bounded lock-free queue that stores its values in a ring buffer.
+ Values are copied in and out of the queue's slots bytewise so this should 
+ only be used for plain data types (e.g., numbers, pointers and structs of
+ these) not Plonk objects or other types with constructors and destructors. 
+ Unlike LockFreeQueue push() and pop() never allocate memory but push() fails
+ if the queue is full.
+ 
+ By default the queue is for one thread pushing and one thread popping (e.g.,
+ messages from a control thread to the audio thread) in which case push() and
+ pop() are wait-free. Pass true for multiThreaded if more than one thread may 
+ push or pop at a time.
+ @ingroup PlonkContainerClasses */
+template<class ValueType>                                               
+class RingQueue : public SmartPointerContainer<RingQueueInternal<ValueType> >
+{
+public:
+    typedef RingQueueInternal<ValueType>    Internal;
+    typedef SmartPointerContainer<Internal> Base;
+    typedef WeakPointerContainer<RingQueue> Weak;
+    typedef ValueType                       Value;
+
+    /** Creates a queue that can hold at least @e capacity values.
+     The capacity is rounded up to a power of two. */
+    PLONK_INLINE_LOW explicit RingQueue (const int capacity = 1024, const bool multiThreaded = false)
+    :   Base (new Internal (capacity, multiThreaded))
+    {
+    }
+    
+    PLONK_INLINE_LOW explicit RingQueue (Internal* internalToUse) throw() 
+	:	Base (internalToUse)
+	{
+	}
+    
+    /** Get a weakly linked copy of this object. 
+     This will return a blank/empty/null object of this type if
+     the original has already been deleted. */    
+    static RingQueue fromWeak (Weak const& weak) throw()
+    {
+        return weak.fromWeak();
+    }    
+    
+    /** Copy constructor. */
+    PLONK_INLINE_LOW RingQueue (RingQueue const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    PLONK_INLINE_LOW RingQueue (Dynamic const& other) throw()
+    :   Base (other.as<RingQueue>().getInternal())
+    {
+    }    
+    
+    /** Assignment operator. */
+    PLONK_INLINE_LOW RingQueue& operator= (RingQueue const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    /** Adds a value to the queue.
+     @return false if the queue was full. */
+    PLONK_INLINE_LOW bool push (ValueType const& value) throw()
+    {
+        return this->getInternal()->push (value);
+    }
+    
+    /** Removes the oldest value in the queue.
+     @return false, leaving @e value unchanged, if the queue was empty. */
+    PLONK_INLINE_LOW bool pop (ValueType& value) throw()
+    {
+        return this->getInternal()->pop (value);
+    }
+    
+    /** Removes the oldest value in the queue or returns a default value if the queue was empty. */
+    PLONK_INLINE_LOW ValueType pop() throw()
+    {
+        ValueType value = ValueType();
+        this->getInternal()->pop (value);
+        return value;
+    }
+    
+    /** Removes all the values.
+     This is only safe when no other threads are using the queue. */
+    PLONK_INLINE_LOW void clear() throw()
+    {
+        this->getInternal()->clear();
+    }
+    
+    PLONK_INLINE_LOW int length() throw()
+    {
+        return this->getInternal()->length();
+    }
+    
+    PLONK_INLINE_LOW int getCapacity() throw()
+    {
+        return this->getInternal()->getCapacity();
+    }
+    
+    PLONK_INLINE_LOW bool isMultiThreaded() throw()
+    {
+        return this->getInternal()->isMultiThreaded();
+    }
+    
+    PLONK_OBJECTARROWOPERATOR(RingQueue);
+
+};
+
+
+#endif // PLONK_RINGQUEUE_H
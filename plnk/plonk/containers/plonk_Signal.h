@@ -61,11 +61,28 @@ public:
     typedef Variable<SampleType>            SampleVariable;
     typedef NumericalArray<SampleVariable>  SampleVariableArray;
     
+    /** The format the sample data is held in.
+     EncodingNative signals hold expanded SampleType frames, the others keep
+     the integer data of their source and are decoded as they are read. */
+    enum Encoding
+    {
+        EncodingNative,
+        EncodingShort,
+        EncodingInt24,
+        NumEncodings
+    };
+    
+    enum Constants
+    {
+        DecodeChunkSize = 64
+    };
+    
     PLONK_INLINE_LOW SignalInternal() throw()
     :   numInterleavedChannels (1),
         channel (-1),
         offset (0),
-        numFrames (-1)
+        numFrames (-1),
+        encoding (EncodingNative)
     {
         init();
     }
@@ -77,7 +94,8 @@ public:
         numInterleavedChannels (1),
         channel (-1),
         offset (0),
-        numFrames (-1)
+        numFrames (-1),
+        encoding (EncodingNative)
     {
         plonk_assert ((buffers.length() == 1) || buffers.isMatrix()); // each channel must be the same length
         init();
@@ -91,7 +109,8 @@ public:
         numInterleavedChannels (interleavedChannelsInBuffer),
         channel (-1),
         offset (0),
-        numFrames (-1)
+        numFrames (-1),
+        encoding (EncodingNative)
     {
         plonk_assert (numInterleavedChannels > 0);
         init();
@@ -108,15 +127,70 @@ public:
         numInterleavedChannels (interleavedChannelsInBuffer),
         channel (channelToUse),
         offset (offsetToUse),
-        numFrames (numFramesToUse)
+        numFrames (numFramesToUse),
+        encoding (EncodingNative)
+    {
+        plonk_assert (numInterleavedChannels > 0);
+        init();
+    }
+    
+    /** Create a compact signal from 16-bit data.
+     The data are either a single interleaved row or one row per channel. */
+    PLONK_INLINE_LOW SignalInternal (ShortArray2D const& shortBuffersToUse,
+                           SampleRate const& sampleRateToUse,
+                           const int interleavedChannelsInBuffer) throw()
+    :   sampleRate (sampleRateToUse),
+        numInterleavedChannels (interleavedChannelsInBuffer),
+        channel (-1),
+        offset (0),
+        numFrames (-1),
+        encoding (EncodingShort),
+        shortBuffers (shortBuffersToUse)
+    {
+        plonk_assert (numInterleavedChannels > 0);
+        plonk_assert ((shortBuffers.length() == 1) || shortBuffers.isMatrix());
+        init();
+    }
+    
+    /** Create a compact signal from 24-bit data.
+     The data are either a single interleaved row or one row per channel. */
+    PLONK_INLINE_LOW SignalInternal (Int24Array2D const& int24BuffersToUse,
+                           SampleRate const& sampleRateToUse,
+                           const int interleavedChannelsInBuffer) throw()
+    :   sampleRate (sampleRateToUse),
+        numInterleavedChannels (interleavedChannelsInBuffer),
+        channel (-1),
+        offset (0),
+        numFrames (-1),
+        encoding (EncodingInt24),
+        int24Buffers (int24BuffersToUse)
     {
         plonk_assert (numInterleavedChannels > 0);
+        plonk_assert ((int24Buffers.length() == 1) || int24Buffers.isMatrix());
+        init();
+    }
+    
+    /** Create a view onto the data of another signal in any encoding. */
+    PLONK_INLINE_LOW SignalInternal (SignalInternal const& source,
+                           const int channelToUse,
+                           const int offsetToUse,
+                           const int numFramesToUse) throw()
+    :   buffers (source.buffers),
+        sampleRate (source.sampleRate),
+        numInterleavedChannels (source.numInterleavedChannels),
+        channel (channelToUse),
+        offset (offsetToUse),
+        numFrames (numFramesToUse),
+        encoding (source.encoding),
+        shortBuffers (source.shortBuffers),
+        int24Buffers (source.int24Buffers)
+    {
         init();
     }
     
     PLONK_INLINE_LOW int getNumFrames() const throw()
     {   
-        const int numFramesPerBuffer = buffers.numColumns();
+        const int numFramesPerBuffer = getNumStoredColumns();
         const int bufferFrames = (numFramesPerBuffer / numInterleavedChannels) - offset;
         return numFrames < 0 ? bufferFrames : plonk::min (numFrames, bufferFrames);
     }
@@ -129,12 +203,12 @@ public:
         }
         else if (numInterleavedChannels > 1)
         {
-            plonk_assert (buffers.numRows() == 1);
+            plonk_assert (getNumStoredRows() == 1);
             return numInterleavedChannels;
         }
         else
         {
-            return buffers.numRows();
+            return getNumStoredRows();
         }
     }
     
@@ -147,9 +221,34 @@ public:
     {
         return isInterleaved() ? numInterleavedChannels : 1;
     }
+    
+    PLONK_INLINE_LOW int getEncoding() const throw()
+    {
+        return encoding;
+    }
+    
+    PLONK_INLINE_LOW bool isCompact() const throw()
+    {
+        return encoding != EncodingNative;
+    }
+    
+    /** A serial number that is unique to this internal and its current samples.
+     This is never reused, unlike the internal's address once it is deleted. */
+    PLONK_INLINE_LOW int getGeneration() const throw()
+    {
+        return generation.getValue();
+    }
+    
+    PLONK_INLINE_LOW void markChanged() throw()
+    {
+        generation = ++getGenerationCounter();
+    }
         
     SampleType* getSamples (const int channel) throw()
     {
+        if (isCompact())
+            return 0;
+        
         const int wrappedChannel = channel < 0 ? channel : plonk::wrap (channel, 0, getNumChannels());
         return isInterleaved() ? buffers.atUnchecked (0).getArray() + offset * numInterleavedChannels + wrappedChannel
                                  :
@@ -158,6 +257,9 @@ public:
     
     const SampleType* getSamples (const int channel) const throw()
     {
+        if (isCompact())
+            return 0;
+
         const int wrappedChannel = channel < 0 ? channel : plonk::wrap (channel, 0, getNumChannels());
         return isInterleaved() ? buffers.atUnchecked (0).getArray() + offset * numInterleavedChannels + wrappedChannel
                                  :
@@ -166,8 +268,33 @@ public:
 
     PLONK_INLINE_LOW bool isInterleaved() const throw()
     {
-        plonk_assert(buffers.length() > 0);
-        return (numInterleavedChannels > 1) || (buffers.numRows() == 1);
+        plonk_assert(getNumStoredRows() > 0);
+        return (numInterleavedChannels > 1) || (getNumStoredRows() == 1);
+    }
+    
+    void placeOnNode (const int node, const bool hugePages) throw()
+    {
+        switch (encoding)
+        {
+            case EncodingShort: placeRowsOnNode (shortBuffers, node, hugePages); break;
+            case EncodingInt24: placeRowsOnNode (int24Buffers, node, hugePages); break;
+            default:            placeRowsOnNode (buffers, node, hugePages);
+        }
+    }
+    
+    /** Decode a run of frames from one channel into contiguous SampleType values.
+     Integer data are scaled to the usual -1 to +1 range. This works for
+     native signals too in which case the frames are simply copied. */
+    void decode (const int channelToDecode, const int startFrame, const int numFramesToDecode, SampleType* const dst) const throw()
+    {
+        plonk_assert ((startFrame >= 0) && ((startFrame + numFramesToDecode) <= getNumFrames()));
+        
+        switch (encoding)
+        {
+            case EncodingShort: decodeFrom (shortBuffers, channelToDecode, startFrame, numFramesToDecode, dst); break;
+            case EncodingInt24: decodeFrom (int24Buffers, channelToDecode, startFrame, numFramesToDecode, dst); break;
+            default:            decodeFrom (buffers, channelToDecode, startFrame, numFramesToDecode, dst);
+        }
     }
     
 //    PLONK_INLINE_LOW Buffer getInterleaved() const throw()
@@ -194,14 +321,109 @@ private:
     int channel;
     int offset;
     int numFrames;
+    int encoding;
+    ShortArray2D shortBuffers;
+    Int24Array2D int24Buffers;
         
     SampleVariableArray sampleVariables;
     IntVariableArray intVariables;
+    AtomicInt generation;
         
     void init() throw()
     {
-        sampleVariables.setSize (buffers.length(), false);
-        intVariables.setSize (buffers.length(), false);
+        sampleVariables.setSize (getNumStoredRows(), false);
+        intVariables.setSize (getNumStoredRows(), false);
+        markChanged();
+    }
+    
+    static AtomicInt& getGenerationCounter() throw()
+    {
+        static AtomicInt counter;
+        return counter;
+    }
+    
+    PLONK_INLINE_LOW int getNumStoredRows() const throw()
+    {
+        switch (encoding)
+        {
+            case EncodingShort: return shortBuffers.numRows();
+            case EncodingInt24: return int24Buffers.numRows();
+            default:            return buffers.numRows();
+        }
+    }
+    
+    PLONK_INLINE_LOW int getNumStoredColumns() const throw()
+    {
+        switch (encoding)
+        {
+            case EncodingShort: return shortBuffers.numColumns();
+            case EncodingInt24: return int24Buffers.numColumns();
+            default:            return buffers.numColumns();
+        }
+    }
+    
+    template<class StoredType>
+    void decodeFrom (NumericalArray2D<StoredType> const& stored, 
+                     const int channelToDecode, 
+                     const int startFrame, 
+                     const int numFramesToDecode, 
+                     SampleType* dst) const throw()
+    {
+        typedef NumericalArrayConverter<SampleType,StoredType> Converter;
+        
+        const int storedChannel = channel >= 0 ? channel : plonk::wrap (channelToDecode, 0, getNumChannels());
+        
+        if (isInterleaved())
+        {
+            const StoredType* src = stored.atUnchecked (0).getArray() + (offset + startFrame) * numInterleavedChannels + storedChannel;
+            
+            if (numInterleavedChannels == 1)
+            {
+                Converter::convertScaled (dst, src, numFramesToDecode);
+            }
+            else
+            {
+                // gather the channel into a small contiguous block first so the conversion still vectorises
+                StoredType gathered[DecodeChunkSize];
+                int numFramesRemaining = numFramesToDecode;
+                
+                while (numFramesRemaining > 0)
+                {
+                    const int numChunkFrames = plonk::min (numFramesRemaining, int (DecodeChunkSize));
+                    
+                    for (int i = 0; i < numChunkFrames; ++i)
+                        gathered[i] = src[i * numInterleavedChannels];
+                    
+                    Converter::convertScaled (dst, gathered, numChunkFrames);
+                    
+                    src += numChunkFrames * numInterleavedChannels;
+                    dst += numChunkFrames;
+                    numFramesRemaining -= numChunkFrames;
+                }
+            }
+        }
+        else
+        {
+            const StoredType* const src = stored.atUnchecked (storedChannel).getArray() + offset + startFrame;
+            Converter::convertScaled (dst, src, numFramesToDecode);
+        }
+    }
+    
+    template<class StoredType>
+    static void placeRowsOnNode (NumericalArray2D<StoredType>& stored, const int node, const bool hugePages) throw()
+    {
+        const int numRows = stored.numRows();
+        
+        for (int i = 0; i < numRows; ++i)
+        {
+            NumericalArray<StoredType>& row = stored.atUnchecked (i);
+            const UnsignedLong numBytes = UnsignedLong (row.length()) * sizeof (StoredType);
+            
+            if (hugePages)
+                Memory::adviseHugePages (row.getArray(), numBytes);
+            
+            Memory::placeOnNode (row.getArray(), numBytes, node);
+        }
     }
 };
 
@@ -277,13 +499,47 @@ public:
         return null;
     }
     
+    /** Create a compact signal that keeps 16-bit samples.
+     The samples are converted to SampleType as they are read which
+     uses half (or a quarter for doubles) of the memory of an expanded signal. 
+     @param samples A buffer of interleaved frames. */
+    static SignalBase withCompactSamples (ShortArray const& samples,
+                                          SampleRate const& sampleRate = SampleRate::getDefault(),
+                                          const int interleavedChannelsInBuffer = 1) throw()
+    {
+        return SignalBase (new Internal (ShortArray2D (samples), sampleRate, interleavedChannelsInBuffer));
+    }
+    
+    /** Create a compact signal that keeps 16-bit samples.
+     @param samples One buffer per channel, each must be the same length. */
+    static SignalBase withCompactSamples (ShortArray2D const& samples,
+                                          SampleRate const& sampleRate = SampleRate::getDefault()) throw()
+    {
+        return SignalBase (new Internal (samples, sampleRate, 1));
+    }
+    
+    /** Create a compact signal that keeps 24-bit samples.
+     @param samples A buffer of interleaved frames. */
+    static SignalBase withCompactSamples (Int24Array const& samples,
+                                          SampleRate const& sampleRate = SampleRate::getDefault(),
+                                          const int interleavedChannelsInBuffer = 1) throw()
+    {
+        return SignalBase (new Internal (Int24Array2D (samples), sampleRate, interleavedChannelsInBuffer));
+    }
+    
+    /** Create a compact signal that keeps 24-bit samples.
+     @param samples One buffer per channel, each must be the same length. */
+    static SignalBase withCompactSamples (Int24Array2D const& samples,
+                                          SampleRate const& sampleRate = SampleRate::getDefault()) throw()
+    {
+        return SignalBase (new Internal (samples, sampleRate, 1));
+    }
+    
     SignalBase getSelection (const int offset, const int numFrames = -1) const throw()
     {
         int offsetToUse = plonk::clip (offset, 0, this->getNumFrames());
 
-        Internal* internal = new Internal (this->getInternal()->buffers,
-                                           this->getInternal()->sampleRate,
-                                           this->getInternal()->numInterleavedChannels,
+        Internal* internal = new Internal (*this->getInternal(),
                                            this->getInternal()->channel,
                                            plonk::clip (this->getInternal()->offset + offsetToUse,
                                                         this->getInternal()->offset,
@@ -294,9 +550,7 @@ public:
     
     SignalBase getChannel (const int channel) const throw()
     {
-        Internal* internal = new Internal (this->getInternal()->buffers,
-                                           this->getInternal()->sampleRate,
-                                           this->getInternal()->numInterleavedChannels,
+        Internal* internal = new Internal (*this->getInternal(),
                                            this->getInternal()->channel < 0 ? channel : this->getInternal()->channel,
                                            this->getInternal()->offset,
                                            this->getInternal()->numFrames);
@@ -357,6 +611,48 @@ public:
     {
         return this->getInternal()->isInterleaved();
     }
+    
+    /** Get the storage encoding, one of the SignalInternal::Encoding values. */
+    PLONK_INLINE_LOW int getEncoding() const throw()
+    {
+        return this->getInternal()->getEncoding();
+    }
+    
+    /** Determine whether the samples are held in a compact integer format.
+     getSamples() returns null for compact signals, use decode() or a
+     SignalDecodeWindow to read them instead. */
+    PLONK_INLINE_LOW bool isCompact() const throw()
+    {
+        return this->getInternal()->isCompact();
+    }
+    
+    /** Decode a run of frames from one channel into @e dst. */
+    PLONK_INLINE_LOW void decode (const int channel, const int startFrame, const int numFrames, SampleType* const dst) const throw()
+    {
+        this->getInternal()->decode (channel, startFrame, numFrames, dst);
+    }
+    
+    /** Call this after changing the stored samples in place.
+     Readers that keep decoded frames (see SignalDecodeWindow) decode them 
+     again. Selections and channels already taken from this signal are not
+     affected. */
+    PLONK_INLINE_LOW void markChanged() throw()
+    {
+        this->getInternal()->markChanged();
+    }
+    
+    /** Moves the stored samples to a memory node.
+     Use this for a signal that is played on workers pinned to cores on a
+     different node from the thread that loaded it (see Memory::getNodeOfCore()).
+     All the samples in the signal's buffers are moved, including any outside
+     a range or channel this signal refers to. This is only a hint and does
+     nothing on machines with one node.
+     @param node        The node to move the samples to.
+     @param hugePages   Whether to also advise that the samples are backed by huge pages. */
+    PLONK_INLINE_LOW void placeOnNode (const int node, const bool hugePages = true) throw()
+    {
+        this->getInternal()->placeOnNode (node, hugePages);
+    }
 
 //    PLONK_INLINE_LOW Buffer getInterleaved() const throw()
 //    {
@@ -393,6 +689,136 @@ public:
 
 };
 
+//------------------------------------------------------------------------------
+
+/** Reads frames directly from the samples of a native signal.
+ This and SignalDecodeWindow share the same read() interface so the
+ signal playback kernels can be written once for both storage modes.
+ @ingroup PlonkContainerClasses */
+template<class SampleType>
+class SignalDirectReader
+{
+public:
+    PLONK_INLINE_LOW SignalDirectReader (SignalBase<SampleType> const& signal, const int channel) throw()
+    :   samples (signal.getSamples (channel)),
+        frameStride (signal.getFrameStride())
+    {
+    }
+    
+    PLONK_INLINE_LOW SampleType read (const unsigned int frame) const throw()
+    {
+        return samples[frame * frameStride];
+    }
+    
+private:
+    const SampleType* const samples;
+    const unsigned int frameStride;
+};
+
+/** Decodes frames of a compact signal a window at a time.
+ Runs of sequential reads decode whole windows using the block converters.
+ If most of a window goes unused (e.g., for scattered read positions) the
+ next window is kept short so each miss stays cheap. The first few frames
+ are also kept separately so reads that wrap round to the start at a loop 
+ point don't discard the window at the end.
+ @ingroup PlonkContainerClasses */
+template<class SampleType>
+class SignalDecodeWindow
+{
+public:
+    enum Constants
+    {
+        MaximumFrames = 256,
+        MinimumFrames = 4
+    };
+    
+    SignalDecodeWindow() throw()
+    :   source (0),
+        generation (0),
+        channel (-1),
+        numSignalFrames (0),
+        start (0),
+        count (0),
+        hits (0),
+        headCount (0)
+    {
+    }
+    
+    /** Set the signal and channel to read, this keeps any decoded frames if they are unchanged. */
+    PLONK_INLINE_LOW void bind (SignalBase<SampleType> const& signalToRead, const int channelToRead) throw()
+    {
+        source = signalToRead.getInternal();
+        
+        const int generationToRead = source->getGeneration();
+        
+        if ((generationToRead != generation) || (channelToRead != channel))
+        {
+            generation = generationToRead;
+            channel = channelToRead;
+            count = 0;
+            headCount = 0;
+        }
+        
+        numSignalFrames = source->getNumFrames();
+    }
+    
+    PLONK_INLINE_LOW SampleType read (const unsigned int frame) throw()
+    {
+        const unsigned int index = frame - start;
+        
+        if (index < count)
+        {
+            ++hits;
+            return samples[index];
+        }
+        
+        return readMiss (frame);
+    }
+    
+private:
+    const SignalInternal<SampleType>* source;
+    int generation;
+    int channel;
+    unsigned int numSignalFrames;
+    unsigned int start;
+    unsigned int count;
+    unsigned int hits;
+    unsigned int headCount;
+    SampleType samples[MaximumFrames];
+    SampleType head[MinimumFrames];     // the first frames, for reads that wrap round
+    
+    SampleType readMiss (const unsigned int frame) throw()
+    {
+        if (frame < (unsigned int)MinimumFrames)
+        {
+            if (headCount == 0)
+            {
+                headCount = plonk::min ((unsigned int)MinimumFrames, numSignalFrames);
+                source->decode (channel, 0, headCount, head);
+            }
+            
+            plonk_assert (frame < headCount);
+            return head[frame];
+        }
+        
+        refill (frame);
+        return samples[0];
+    }
+    
+    void refill (const unsigned int frame) throw()
+    {
+        plonk_assert (frame < numSignalFrames);
+        
+        const unsigned int size = (hits >= (count >> 2)) ? MaximumFrames : MinimumFrames;
+        
+        start = frame;
+        count = plonk::min (size, numSignalFrames - frame);
+        hits = 0;
+        
+        source->decode (channel, start, count, samples);
+    }
+};
+
 
 
 #endif // PLONK_SIGNAL_H
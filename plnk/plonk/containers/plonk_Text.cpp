@@ -55,11 +55,6 @@ Text::Text (Internal* internalToUse) throw()
 {
 }         
 
-Text Text::fromWeak (Weak const& weak) throw()
-{
-    return weak.fromWeak();
-}            
-
 const Text& Text::getNull() throw()
 {
     static Text null;
@@ -105,7 +100,7 @@ Text::Text (Text const& copy) throw()
 }
 
 Text::Text (Dynamic const& other) throw()
-:   Base (other.as<Text>().getInternal())
+:   Base (other.toText().getInternal())
 {
 }
 
@@ -437,70 +432,173 @@ const Text& Text::getStandardDelimiters() throw()
 	return t;
 }
 
+/** The table of interned message names.
+ Entries are only ever appended so readers can scan up to the current count 
+ without locking. */
+class TextMessageTable
+{
+public:
+    TextMessageTable() throw()
+    :   lock (Lock::MutexLock)
+    {
+        add ("done");
+        add ("numChannelsChanged");
+        add ("audioFileChanged");
+        add ("looped");
+        add ("patch.start");
+        add ("patch.end");
+        add ("trigger");
+        add ("event");
+        add ("cue.point");
+        add ("queue.buffer");
+        add ("buffer.queue.underrun");
+    }
+    
+    int intern (Text const& name) throw()
+    {
+        int messageID = find (name);
+        
+        if (messageID != Text::MessageUnknown)
+            return messageID;
+        
+        lock.lock();
+        
+        messageID = find (name);
+        
+        if (messageID == Text::MessageUnknown)
+            messageID = add (name);
+        
+        lock.unlock();
+        
+        return messageID;
+    }
+    
+    int find (Text const& message) const throw()
+    {
+        const int count = numMessages.getValue();
+        const Text::Internal* const internal = message.getInternal();
+        int i;
+        
+        for (i = 0; i < count; ++i)
+            if (internals[i] == internal)
+                return i;
+        
+        const char* const string = message.getArray();
+        
+        if (string == 0)
+            return Text::MessageUnknown;
+        
+        for (i = 0; i < count; ++i)
+            if (strcmp (names[i].getArray(), string) == 0)
+                return i;
+        
+        return Text::MessageUnknown;
+    }
+    
+    const Text& getName (const int messageID) const throw()
+    {
+        if ((messageID < 0) || (messageID >= numMessages.getValue()))
+            return Text::getEmpty();
+        
+        return names[messageID];
+    }
+    
+private:
+    int add (Text const& name) throw()
+    {
+        const int messageID = numMessages.getValueUnchecked();
+        
+        if (messageID >= Text::MaximumMessages)
+            return Text::MessageUnknown;
+        
+        names[messageID] = Text (name.getArray()); // unique copy so the internal can't be modified by the caller
+        internals[messageID] = names[messageID].getInternal();
+        AtomicOps::memoryBarrier();
+        ++numMessages;
+        
+        return messageID;
+    }
+    
+    Text names[Text::MaximumMessages];
+    const Text::Internal* internals[Text::MaximumMessages];
+    AtomicInt numMessages;
+    Lock lock;
+};
+
+static TextMessageTable& getMessageTable() throw()
+{
+    static TextMessageTable table;
+    return table;
+}
+
+int Text::internMessage (Text const& name) throw()
+{
+    return getMessageTable().intern (name);
+}
+
+int Text::getMessageID (Text const& message) throw()
+{
+    return getMessageTable().find (message);
+}
+
+const Text& Text::getMessageName (const int messageID) throw()
+{
+    return getMessageTable().getName (messageID);
+}
+
 const Text& Text::getMessageDone() throw()
 {
-    static const Text t = "done";
-	return t;
+    return getMessageName (MessageDone);
 }
 
 const Text& Text::getMessageNumChannelsChanged() throw()
 {
-    static const Text t = "numChannelsChanged";
-	return t;
+    return getMessageName (MessageNumChannelsChanged);
 }
 
 const Text& Text::getMessageAudioFileChanged() throw()
 {
-    static const Text t = "audioFileChanged";
-	return t;
+    return getMessageName (MessageAudioFileChanged);
 }
 
 const Text& Text::getMessageLooped() throw()
 {
-    static const Text t = "looped";
-	return t;
+    return getMessageName (MessageLooped);
 }
 
 const Text& Text::getMessagePatchStart() throw()
 {
-    static const Text t = "patch.start";
-	return t;
+    return getMessageName (MessagePatchStart);
 }
 
 const Text& Text::getMessagePatchEnd() throw()
 {
-    static const Text t = "patch.end";
-	return t;
+    return getMessageName (MessagePatchEnd);
 }
 
 const Text& Text::getMessageTrigger() throw()
 {
-    static const Text t = "trigger";
-	return t;
+    return getMessageName (MessageTrigger);
 }
 
 const Text& Text::getMessageEvent() throw()
 {
-    static const Text t = "event";
-	return t;
+    return getMessageName (MessageEvent);
 }
 
 const Text& Text::getMessageCuePoint() throw()
 {
-    static const Text t = "cue.point";
-	return t;
+    return getMessageName (MessageCuePoint);
 }
 
 const Text& Text::getMessageQueueBuffer() throw()
 {
-    static const Text t = "queue.buffer";
-	return t;
+    return getMessageName (MessageQueueBuffer);
 }
 
 const Text& Text::getMessageBufferQueueUnderrun() throw()
 {
-    static const Text t = "buffer.queue.underrun";
-	return t;
+    return getMessageName (MessageBufferQueueUnderrun);
 }
 
 
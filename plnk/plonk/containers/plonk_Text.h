@@ -62,7 +62,33 @@ class Text : public CharArray
 public:
     typedef ObjectArrayInternal<char>   Internal;
     typedef CharArray                   Base;    
-    typedef WeakPointerContainer<Text>  Weak;
+    
+    /** Interned identifiers for the built-in notification messages.
+     These are the indices of the messages returned by the getMessageXxx() 
+     functions in the message table. Further messages can be added at runtime
+     using internMessage() and receivers can use getMessageID() to switch 
+     on the message rather than comparing strings. */
+    enum Messages
+    {
+        MessageUnknown = -1,
+        MessageDone,
+        MessageNumChannelsChanged,
+        MessageAudioFileChanged,
+        MessageLooped,
+        MessagePatchStart,
+        MessagePatchEnd,
+        MessageTrigger,
+        MessageEvent,
+        MessageCuePoint,
+        MessageQueueBuffer,
+        MessageBufferQueueUnderrun,
+        NumBuiltInMessages
+    };
+    
+    enum Constants
+    {
+        MaximumMessages = 256
+    };
     
 	static const char space;
 	
@@ -72,10 +98,6 @@ public:
     explicit Text (Internal* internalToUse) throw();
     
     
-    /** Get a weakly linked copy of this object. 
-     This will return a blank/empty/null object of this type if
-     the original has already been deleted. */
-    static Text fromWeak (Weak const& weak) throw();
     static const Text& getNull() throw();
     static const Text& getEmpty() throw();
     
@@ -172,6 +194,21 @@ public:
     static const Text& getMessageCuePoint() throw();
     static const Text& getMessageQueueBuffer() throw();
     static const Text& getMessageBufferQueueUnderrun() throw();
+    
+    /** Adds a message name to the message table and returns its ID.
+     If the name is already in the table its existing ID is returned. This 
+     takes a lock so should be called during setup rather than on the audio
+     thread. Returns MessageUnknown if the table is full. */
+    static int internMessage (Text const& name) throw();
+    
+    /** Returns the ID of an interned message or MessageUnknown.
+     This is lock free. Messages sent using the Text objects returned by
+     getMessageName() (and the getMessageXxx() functions) are matched 
+     by pointer without comparing the strings. */
+    static int getMessageID (Text const& message) throw();
+    
+    /** Returns the interned Text for a message ID. */
+    static const Text& getMessageName (const int messageID) throw();
 
     
     PLONK_OBJECTARROWOPERATOR(Text);
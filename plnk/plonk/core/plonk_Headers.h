@@ -76,6 +76,7 @@
 #include "../containers/plonk_Function.h"
 #include "../containers/plonk_LockFreeQueue.h"
 #include "../containers/plonk_LockFreeStack.h"
+#include "../containers/plonk_RingQueue.h"
 #include "../containers/plonk_ObjectMemoryDeferFree.h"
 #include "../containers/plonk_ObjectMemoryPools.h"
 
@@ -100,9 +101,12 @@
 #include "../files/audio/plonk_AudioFileMetaData.h"
 #include "../files/audio/plonk_AudioFileReader.h"
 #include "../files/audio/plonk_AudioFileWriter.h"
+#include "../files/audio/plonk_AudioFileWriterAsync.h"
+#include "../files/audio/plonk_AudioFileBulkLoader.h"
 
 #include "../misc/plonk_NeuralNetwork.h"
 #include "../misc/plonk_JSON.h"
+#include "../misc/plonk_JSONStream.h"
 #include "../misc/plonk_Base64.h"
 #include "../misc/plonk_Zip.h"
 
@@ -153,6 +157,9 @@
 #include "../graph/simple/plonk_PatchChannel.h"
 #include "../graph/simple/plonk_QueueChannel.h"
 #include "../graph/simple/plonk_BufferQueueChannel.h"
+#include "../graph/utility/plonk_VoicePool.h"
+#include "../graph/utility/plonk_BufferPlan.h"
+#include "../graph/utility/plonk_ExecutionPlan.h"
 
 #include "../graph/generators/plonk_Saw.h"
 #include "../graph/generators/plonk_WhiteNoise.h"
@@ -190,17 +197,20 @@
 #include "../graph/delay/plonk_Delay2Param.h"
 #include "../graph/delay/plonk_Delay3Param.h"
 #include "../graph/delay/plonk_Delay4Param.h"
+#include "../graph/delay/plonk_FDN.h"
 
 #include "../graph/control/plonk_EnvelopeChannel.h"
 #include "../graph/control/plonk_TriggerChannel.h"
 #include "../graph/control/plonk_SchmidtChannel.h"
 #include "../graph/control/plonk_DiffChannel.h"
 #include "../graph/control/plonk_PauseChannel.h"
+#include "../graph/control/plonk_NeuralNetworkChannel.h"
 
 #include "../graph/fft/plonk_FFTChannel.h"
 #include "../graph/fft/plonk_IFFTChannel.h"
 #include "../graph/fft/plonk_ZMulChannel.h"
 
 #include "../hosts/plonk_AudioHostBase.h"
+#include "../hosts/plonk_MultiGraphHost.h"
 
 #endif // PLONKHEADERS_H
\ No newline at end of file
@@ -168,6 +168,31 @@ void ThreadSpinLockInternal::signal() throw()
 
 //------------------------------------------------------------------------------
 
+SemaphoreLockInternal::SemaphoreLockInternal() throw()
+{
+    pl_Semaphore_Init (getPeerRef());
+}
+
+SemaphoreLockInternal::~SemaphoreLockInternal()
+{
+    pl_Semaphore_DeInit (getPeerRef());
+}
+
+void SemaphoreLockInternal::wait (const double time) throw()
+{
+    if (time <= 0.0)
+        pl_Semaphore_Wait (getPeerRef());
+    else
+        pl_Semaphore_WaitTimeout (getPeerRef(), time);
+}
+
+void SemaphoreLockInternal::signal() throw()
+{
+    pl_Semaphore_Signal (getPeerRef());
+}
+
+//------------------------------------------------------------------------------
+
 Lock::Lock (const Lock::Type lockType) throw()
 :   Base (lockInternalFromType (lockType))
 {
@@ -183,6 +208,7 @@ LockInternalBase* Lock::lockInternalFromType (const int lockType) throw()
         case MutexLock:         return new LockInternal();
         case SpinLock:          return new SpinLockInternal();
         case ThreadSpinLock:    return new ThreadSpinLockInternal();
+        case SemaphoreLock:     return new SemaphoreLockInternal();
         default:                return new NoLockInternal();
     }
 }
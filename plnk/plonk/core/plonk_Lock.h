@@ -124,6 +124,24 @@ private:
     PlankThreadSpinLock l;    
 };
 
+/** Only waits and signals, signal() never blocks so it can be used on the audio thread. */
+class SemaphoreLockInternal : public LockInternalBase
+{
+public:
+    SemaphoreLockInternal() throw();
+    ~SemaphoreLockInternal();
+    
+    void lock() throw() { }
+    void unlock() throw() { }
+    bool tryLock() throw() { return true; }
+    void wait (const double time) throw();
+    void signal() throw();
+    
+private:
+    PLONK_INLINE_LOW PlankSemaphoreRef getPeerRef() { return &s; }
+    PlankSemaphore s;
+};
+
 
 //------------------------------------------------------------------------------
 
@@ -139,6 +157,7 @@ public:
         MutexLock,          ///< Uses a mutex to lock.
         SpinLock,           ///< Uses a simple spin lock.
         ThreadSpinLock,     ///< Uses a spin lock that can be locked multiple times from the same thread.
+        SemaphoreLock,      ///< Doesn't lock, wait() and signal() use a semaphore and signal() never blocks.
         NumTypes
     };
     
@@ -148,6 +148,39 @@ public:
         (void)result;
 #endif
     }
+    
+    /** The number of memory nodes, this is 1 unless the machine is NUMA. */
+    static PLONK_INLINE_LOW int getNumNodes() throw()                       { return pl_MemoryNumNodes(); }
+    
+    /** The memory node of the core the calling thread is running on. */
+    static PLONK_INLINE_LOW int getCurrentNode() throw()                    { return pl_MemoryCurrentNode(); }
+    
+    static PLONK_INLINE_LOW int getNodeOfCore (const int core) throw()      { return pl_MemoryNodeOfCore (core); }
+    
+    /** Moves the whole pages of a block of memory to a node.
+     This is a hint, it returns @c false if the pages could not be placed but
+     the memory is valid either way. See pl_MemoryPlaceOnNode(). */
+    static PLONK_INLINE_LOW bool placeOnNode (void* const ptr, const UnsignedLong numBytes, const int node) throw()
+    {
+        return pl_MemoryPlaceOnNode (ptr, numBytes, node) == PlankResult_OK;
+    }
+    
+    /** Advises that the whole pages of a block of memory are backed by transparent huge pages.
+     This is a hint, it returns @c false if the advice was refused. */
+    static PLONK_INLINE_LOW bool adviseHugePages (void* const ptr, const UnsignedLong numBytes) throw()
+    {
+        return pl_MemoryAdviseHugePages (ptr, numBytes) == PlankResult_OK;
+    }
+    
+    /** Faults in each page of a block of memory on the calling thread without changing it. */
+    static PLONK_INLINE_LOW void touch (void* const ptr, const UnsignedLong numBytes) throw()
+    {
+        const ResultCode result = pl_MemoryTouch (ptr, numBytes);
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
 
     static FreeFunction defaultFree;
     static AllocateBytesFunction defaultAllocateBytes;
@@ -164,6 +197,72 @@ private:
 
 //------------------------------------------------------------------------------
 
+/** Allocates memory for one memory node.
+ Allocations of at least @e largeSize bytes are mapped separately and backed
+ by huge pages if requested. If the arena has a node these are placed on it 
+ and faulted in by the allocating thread, otherwise each page is placed on
+ the node of the thread that first writes to it. Smaller allocations come
+ from the heap. Memory must be freed by the arena that allocated it.
+ @see PlankMemoryArena */
+class MemoryArena
+{
+public:
+    enum HugePages
+    {
+        HugePagesNone = PlankMemoryHugePages_None,
+        HugePagesTransparent = PlankMemoryHugePages_Transparent,
+        HugePagesExplicit = PlankMemoryHugePages_Explicit
+    };
+    
+    /** Creates an arena.
+     @param node        The node for large allocations, -1 to leave them on the node that first writes to them.
+     @param hugePages   One of the HugePages values.
+     @param largeSize   The size in bytes from which allocations are mapped separately, 0 for the default. */
+    MemoryArena (const int node = -1, const int hugePages = HugePagesTransparent, const UnsignedLong largeSize = 0) throw()
+    :   internal (pl_MemoryArena_CreateAndInit (node, hugePages, largeSize))
+    {
+        plonk_assert (internal != 0);
+    }
+    
+    ~MemoryArena()
+    {
+        const ResultCode result = pl_MemoryArena_Destroy (internal);
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW void* allocateBytes (const UnsignedLong numBytes) throw()
+    {
+        void* const ptr = pl_MemoryArena_AllocateBytes (internal, numBytes);
+        plonk_assert (ptr != 0);
+        return ptr;
+    }
+    
+    PLONK_INLINE_LOW void free (void* ptr) throw()
+    {
+        const ResultCode result = pl_MemoryArena_Free (internal, ptr);
+        plonk_assert (result == PlankResult_OK);
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW int getNode() const throw()                    { return pl_MemoryArena_GetNode (internal); }
+    PLONK_INLINE_LOW int getHugePages() const throw()               { return pl_MemoryArena_GetHugePages (internal); }
+    PLONK_INLINE_LOW UnsignedLong getLargeSize() const throw()      { return pl_MemoryArena_GetLargeSize (internal); }
+    PLONK_INLINE_LOW LongLong getNumBytesMapped() const throw()     { return pl_MemoryArena_GetNumBytesMapped (internal); }
+    
+private:
+    PlankMemoryArenaRef const internal;
+    
+    MemoryArena (MemoryArena const&);
+    MemoryArena& operator= (MemoryArena const&);
+};
+
+//------------------------------------------------------------------------------
+
 /** Manage a custom memory allocation system.
  An ObjectMemoryBase subclass manages a Memory instance. Care should be take for this
  to be created before any other objects EXCEPT for Memory instances. 
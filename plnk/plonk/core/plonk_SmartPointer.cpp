@@ -152,7 +152,7 @@ void PlonkBase::operator delete[] (void* ptr)
 }
 
 SmartPointer::SmartPointer (const bool allocateWeakPointer) throw()
-:	counter (0), weakPointer (0)
+:	counter (0), weakPointer (0), refCountMode (RefCountShared)
 {		
     counter = new SmartPointerCounter (this);
     
@@ -172,6 +172,24 @@ SmartPointer::SmartPointer (const bool allocateWeakPointer) throw()
 #endif
 }
 
+SmartPointer::SmartPointer (const RefCountModes mode) throw()
+:	counter (0), weakPointer (0), refCountMode (mode)
+{
+    if (refCountMode == RefCountShared)
+    {
+        counter = new SmartPointerCounter (this);
+        
+        WeakPointer* weak = new WeakPointer (counter);
+        weak->incrementRefCount();  // for the WeakPointer object
+        weak->incrementWeakCount(); // for the weak count for this object
+        this->weakPointer = weak;
+    }
+    
+#if PLONK_SMARTPOINTER_DEBUG
+    ++getTotalSmartPointersAtom();
+#endif
+}
+
 SmartPointer::~SmartPointer()
 {
 #if PLONK_SMARTPOINTER_DEBUG
@@ -194,15 +212,9 @@ SmartPointer::~SmartPointer()
     }    
 }
 
-void SmartPointer::incrementRefCount()  throw()
-{	
-    counter->incrementRefCount();
-}
-
-void SmartPointer::decrementRefCount()  throw()
-{ 
-    plonk_assert (counter->getRefCount() > 0);
-    counter->decrementRefCount(); 
+void SmartPointer::deleteIntrusive() throw()
+{
+    delete this;
 }
 
 void* SmartPointer::getWeak() const throw()               
@@ -212,7 +224,10 @@ void* SmartPointer::getWeak() const throw()
 
 int SmartPointer::getRefCount() const throw()            
 { 
-    return counter->getRefCount(); 
+    if (counter != 0)
+        return counter->getRefCount();
+    
+    return intrusiveRefCount.getValue();
 }
 
 ///-----------------------------------------------------------------------------
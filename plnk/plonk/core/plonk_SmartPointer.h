@@ -87,20 +87,40 @@ public:
  especially with dynamically allocated audio components. A 'weak' version
  of this pointer can also be obtained which will not affect the reference
  count but will get set to 0 when its SmartPointer peer is deleted.
+ 
+ Types that are never weakly referenced can opt in to an intrusive count
+ by passing RefCountIntrusive to the constructor. This keeps a single atomic 
+ word in the object itself rather than allocating a SmartPointerCounter
+ which would otherwise need a double-width compare-and-swap for every copy.
+ Such objects have no WeakPointer so their containers must derive from
+ SmartPointerContainer<Internal,false> which has no getWeakPointer(), this 
+ is the case for the arrays, Text and Dynamic.
+ 
+ Short lived non-owning access needs no separate type. Containers hold only 
+ the internal pointer so a const& to the container is already a borrow that 
+ touches no count, this is how process() reaches its inputs (e.g., 
+ ChannelInternalBase::getInputAsUnit() returns a const reference).
  @see WeakPointer, SmartPointerContainer
  */
 class SmartPointer : public PlonkBase
 {
 public:
+    enum RefCountModes
+    {
+        RefCountShared,
+        RefCountIntrusive,
+        NumRefCountModes
+    };
 	
 	/// @name Construction and destruction
 	/// @{
 	
 	SmartPointer (const bool allocateWeakPointer = true) throw();
+    explicit SmartPointer (const RefCountModes mode) throw();
     virtual ~SmartPointer(); // MUST be virtual unless PlonkBase gains the need to be virtual    
     
-	void incrementRefCount() throw();    
-    void decrementRefCount() throw();
+	PLONK_INLINE_LOW void incrementRefCount() throw();    
+    PLONK_INLINE_LOW void decrementRefCount() throw();
     
 	/// @} <!-- end Construction and destruction -->
 	
@@ -110,6 +130,7 @@ public:
 //    PLONK_INLINE_LOW void update (Text const& message, Dynamic const& payload) throw() { (void)message; (void)payload; } // needed as a dummy in place of Sender::update?
     void* getWeak() const throw();
     int getRefCount() const throw();
+    PLONK_INLINE_LOW int getRefCountMode() const throw() { return refCountMode; }
     
     virtual SmartPointer* deepCopy() const throw() { return 0; }
     
@@ -120,8 +141,12 @@ public:
 protected:    
     SmartPointerCounter* counter;
     AtomicValue<void*> weakPointer;
+    AtomicInt intrusiveRefCount;
+    int refCountMode;
 	
 private:
+    void deleteIntrusive() throw();
+    
 	SmartPointer (const SmartPointer&);
     SmartPointer& operator= (const SmartPointer&);
 };
@@ -175,6 +200,31 @@ private:
 //    };        
 };
 
+//------------------------------------------------------------------------------
+
+PLONK_INLINE_LOW void SmartPointer::incrementRefCount() throw()
+{
+    if (counter != 0)
+        counter->incrementRefCount();
+    else
+        ++intrusiveRefCount;
+}
+
+PLONK_INLINE_LOW void SmartPointer::decrementRefCount() throw()
+{
+    if (counter != 0)
+    {
+        plonk_assert (counter->getRefCount() > 0);
+        counter->decrementRefCount();
+    }
+    else
+    {
+        plonk_assert (intrusiveRefCount.getValueUnchecked() > 0);
+        
+        if (--intrusiveRefCount == 0)
+            deleteIntrusive();
+    }
+}
 
 //------------------------------------------------------------------------------
 
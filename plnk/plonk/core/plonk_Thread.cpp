@@ -67,11 +67,22 @@ ResultCode Threading::yield() throw()
     return result;   
 }
 
+int Threading::getNumCores() throw()
+{
+    return pl_ThreadNumCores();
+}
+
 Threading::ID Threading::getCurrentThreadID() throw()
 {
     return pl_ThreadCurrentID();
 }
 
+int Threading::getNumIsolatedCores() throw()
+{
+    int cores[256];
+    return pl_ThreadIsolatedCores (cores, 256);
+}
+
 static AtomicValue<Threading::ID>& plonk_getAudioThreadIDRef() throw()
 {
     static AtomicValue<Threading::ID> audioThreadID;
@@ -209,6 +220,36 @@ bool Threading::Thread::setPriorityAudio (const int blockSize, const double samp
     return pl_Thread_SetPriorityAudio (getPeerRef(), blockSize, sampleRate) == PlankResult_OK;
 }
 
+bool Threading::Thread::setScheduling (const Scheduling scheduling) throw()
+{
+    return pl_Thread_SetScheduling (getPeerRef(), scheduling) == PlankResult_OK;
+}
+
+Threading::Thread::Scheduling Threading::Thread::getScheduling() throw()
+{
+    return static_cast<Scheduling> (pl_Thread_GetScheduling (getPeerRef()));
+}
+
+bool Threading::Thread::setDeadlineLoad (const double load) throw()
+{
+    return pl_Thread_SetDeadlineLoad (getPeerRef(), load) == PlankResult_OK;
+}
+
+bool Threading::Thread::setLockMemory (const bool lockMemory) throw()
+{
+    return pl_Thread_SetLockMemory (getPeerRef(), lockMemory) == PlankResult_OK;
+}
+
+bool Threading::Thread::setAffinity (const int core) throw()
+{
+    return pl_Thread_SetAffinity (getPeerRef(), core) == PlankResult_OK;
+}
+
+bool Threading::Thread::setAffinityIsolated (const int index) throw()
+{
+    return pl_Thread_SetAffinityIsolated (getPeerRef(), index) == PlankResult_OK;
+}
+
 Threading::ID Threading::Thread::getID() throw()
 {
     return pl_Thread_GetID (getPeerRef());
@@ -53,9 +53,16 @@ public:
      This signals that other threads can use the processing time. */
     static ResultCode yield() throw();
     
+    /** Get the number of processor cores available. */
+    static int getNumCores() throw();
+    
     /** Get the calling thread ID. */
     static Threading::ID getCurrentThreadID() throw();
     
+    /** Get the number of cores isolated from the general scheduler.
+     @see Thread::setAffinityIsolated() */
+    static int getNumIsolatedCores() throw();
+    
     static Threading::ID getAudioThreadID() throw(); // there will be more that one audio thread when going multicore, not really only one actual "audio thread"
     static bool setAudioThreadID (const Threading::ID theID) throw();
     static bool currentThreadIsAudioThread() throw();
@@ -127,9 +134,51 @@ public:
          This is thread-safe. */
         bool getShouldExit() throw();
         
+        /** Scheduling policies used for real-time priorities. */
+        enum Scheduling
+        {
+            SchedulingRoundRobin = PlankThreadScheduling_RoundRobin,
+            SchedulingFIFO = PlankThreadScheduling_FIFO,
+            SchedulingDeadline = PlankThreadScheduling_Deadline,
+            SchedulingOther = PlankThreadScheduling_Other
+        };
+        
+        /** Sets the priority from 0 (normal) to 100.
+         Priorities above 0 use the policy set with setScheduling(). This can
+         be called before start() in which case the thread applies it when it
+         starts. Returns @c false if the thread had to fall back to normal
+         scheduling (e.g., the process does not have the privileges). */
         bool setPriority (const int priority) throw();
+        
+        /** Sets the highest priority for processing audio.
+         With SchedulingDeadline on Linux the thread is given a SCHED_DEADLINE
+         reservation each block of the fraction of the block set with
+         setDeadlineLoad(), falling back to SCHED_FIFO if this is refused. */
         bool setPriorityAudio (const int blockSize, const double sampleRate) throw();
         
+        /** Sets the real-time policy used by setPriority() and setPriorityAudio().
+         This should be called before those. */
+        bool setScheduling (const Scheduling scheduling) throw();
+        
+        /** Gets the policy the thread is actually running with after any fall back. */
+        Scheduling getScheduling() throw();
+        
+        /** Sets the fraction of each block reserved under SchedulingDeadline, the default is 0.5. */
+        bool setDeadlineLoad (const double load) throw();
+        
+        /** Locks the process's memory and prefaults the thread's stack when it starts.
+         The lock applies to the whole process (every thread's pages) and is not 
+         undone when the thread exits. This must be called before start(). */
+        bool setLockMemory (const bool lockMemory) throw();
+        
+        /** Sets the core the thread runs on. */
+        bool setAffinity (const int core) throw();
+        
+        /** Sets the thread to run on one of the isolated cores.
+         Threads given indices 0, 1, 2... are spread over the isolated
+         cores, or over the available cores if none are isolated. */
+        bool setAffinityIsolated (const int index) throw();
+        
         /** Get this thread's ID. */
         Threading::ID getID() throw();
         
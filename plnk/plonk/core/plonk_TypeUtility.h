@@ -46,6 +46,8 @@
 #include "../containers/plonk_Text.h"
 
 class AudioFileReader;
+template<class ValueType> class NeuralNetworkDoubleBufferBase;
+typedef NeuralNetworkDoubleBufferBase<float> FloatNeuralNetworkDoubleBuffer;
 
 /** Used to determine information about some types.
  Especially used to determine information about sample buffer types
@@ -120,6 +122,10 @@ public:
         FloatUnitQueue, DoubleUnitQueue, ShortUnitQueue, CharUnitQueue, IntUnitQueue, Int24UnitQueue, LongUnitQueue,
         FloatBufferQueue, DoubleBufferQueue, ShortBufferQueue, CharBufferQueue, IntBufferQueue, Int24BufferQueue, LongBufferQueue,
 
+        FloatNeuralNetworkDoubleBuffer,
+        
+    // small values held in place by Dynamic
+        TimeStamp, SmallText,
         
     // count (??)
         NumTypeCodes
@@ -187,7 +193,11 @@ public:
             "AudioFileReader",
             
             "FloatUnitQueue", "DoubleUnitQueue", "ShortUnitQueue", "CharUnitQueue", "IntUnitQueue", "Int24UnitQueue", "LongUnitQueue",
-            "FloatBufferQueue", "DoublBufferQueue", "ShortBufferQueue", "CharBufferQueue", "IntBufferQueue", "Int24BufferQueue", "LongBufferQueue"
+            "FloatBufferQueue", "DoublBufferQueue", "ShortBufferQueue", "CharBufferQueue", "IntBufferQueue", "Int24BufferQueue", "LongBufferQueue",
+            
+            "FloatNeuralNetworkDoubleBuffer",
+            
+            "TimeStamp", "SmallText"
         };
         
         if ((code >= 0) && (code < TypeCode::NumTypeCodes))
@@ -235,6 +245,7 @@ public:
     static PLONK_INLINE_LOW bool isDynamic (const int code) throw()           { return (code == TypeCode::Dynamic); }
     
     static PLONK_INLINE_LOW bool isBuiltIn (const int code) throw()           { return (code >= TypeCode::Float) && (code <= TypeCode::Bool) && code != TypeCode::Int24; }
+    static PLONK_INLINE_LOW bool isSmall (const int code) throw()             { return (code == TypeCode::Int) || (code == TypeCode::LongLong) || (code == TypeCode::Float) || (code == TypeCode::Double) || (code == TypeCode::TimeStamp) || (code == TypeCode::SmallText); }
     static PLONK_INLINE_LOW bool isFixed (const int code) throw()             { return (code >= TypeCode::FixI8F8) && (code <= TypeCode::FixI16F16); }
     static PLONK_INLINE_LOW bool isAtomic (const int code) throw()            { return (code >= TypeCode::AtomicFloat) && (code <= TypeCode::AtomicDynamicPointer); }
     static PLONK_INLINE_LOW bool isVariable (const int code) throw()          { return (code >= TypeCode::FloatVariable) && (code <= TypeCode::BoolVariable); }
@@ -252,6 +263,7 @@ public:
     static PLONK_INLINE_LOW bool isAudioFileReader (const int code) throw()   { return (code == TypeCode::AudioFileReader); }
     static PLONK_INLINE_LOW bool isUnitQueue (const int code) throw()         { return (code >= TypeCode::FloatUnitQueue) && (code <= TypeCode::LongUnitQueue); }
     static PLONK_INLINE_LOW bool isBufferQueue (const int code) throw()       { return (code >= TypeCode::FloatBufferQueue) && (code <= TypeCode::LongBufferQueue); }
+    static PLONK_INLINE_LOW bool isNeuralNetwork (const int code) throw()     { return (code == TypeCode::FloatNeuralNetworkDoubleBuffer); }
 
     // could replace these later by designing the enum to be bit-mask based
     
@@ -4508,6 +4520,34 @@ public:
     typedef double ScaleType;
 };
 
+template<>
+class TypeUtilityBase<FloatNeuralNetworkDoubleBuffer>
+{
+public:
+    typedef FloatNeuralNetworkDoubleBuffer          TypeName;
+    typedef FloatNeuralNetworkDoubleBuffer          OriginalType;
+    typedef FloatNeuralNetworkDoubleBuffer const&   PassType;
+    typedef void                                    IndexType;
+    static PLONK_INLINE_LOW int  getTypeCode() { return TypeCode::FloatNeuralNetworkDoubleBuffer; }
+    static PLONK_INLINE_LOW const OriginalType& getNull() { return TypeUtilityBase<const OriginalType&>::getNull(); }
+    typedef int PeakType;
+    typedef double ScaleType;
+};
+
+template<>
+class TypeUtilityBase<const FloatNeuralNetworkDoubleBuffer>
+{
+public:
+    typedef const FloatNeuralNetworkDoubleBuffer    TypeName;
+    typedef FloatNeuralNetworkDoubleBuffer          OriginalType;
+    typedef FloatNeuralNetworkDoubleBuffer const&   PassType;
+    typedef void                                    IndexType;
+    static PLONK_INLINE_LOW int  getTypeCode() { return TypeCode::FloatNeuralNetworkDoubleBuffer; }
+    static PLONK_INLINE_LOW const OriginalType& getNull() { return TypeUtilityBase<const OriginalType&>::getNull(); }
+    typedef int PeakType;
+    typedef double ScaleType;
+};
+
 template<>
 class TypeUtilityBase<FloatUnitQueue>
 {
@@ -4883,6 +4923,7 @@ public:
     static PLONK_INLINE_LOW bool isAudioFileReader() throw()   { return TypeCode::isAudioFileReader (TypeUtility<Type>::getTypeCode()); }
     static PLONK_INLINE_LOW bool isUnitQueue() throw()         { return TypeCode::isUnitQueue (TypeUtility<Type>::getTypeCode()); }
     static PLONK_INLINE_LOW bool isBufferQueue() throw()       { return TypeCode::isBufferQueue (TypeUtility<Type>::getTypeCode()); }
+    static PLONK_INLINE_LOW bool isNeuralNetwork() throw()     { return TypeCode::isNeuralNetwork (TypeUtility<Type>::getTypeCode()); }
     
     static PLONK_INLINE_LOW bool isFloatType() throw()         { return TypeCode::isFloatType (TypeUtility<Type>::getTypeCode()); }
     static PLONK_INLINE_LOW bool isDoubleType() throw()        { return TypeCode::isDoubleType (TypeUtility<Type>::getTypeCode()); }
@@ -361,7 +361,7 @@
  Plonk is not tied to any particular platform or audio IO system. Plonk does
  provide some built-in "audio hosts" which interface with commonly available
  IO APIs. For example, there are audio hosts for PortAudio (PortAudioAudioHost), 
- iOS (IOSAudioHost) and Juce (JuceAudioHost). It's reasonably trivial to add
+ iOS (IOSAudioHost), Juce (JuceAudioHost) and JACK (JackAudioHost). It's reasonably trivial to add
  hosts, each derives from the AudioHostBase class.
  
  In each case the audio host class communicates with the host API. As a user you
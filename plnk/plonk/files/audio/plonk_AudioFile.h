@@ -54,6 +54,7 @@ public:
         FormatOpus                  = PLANKAUDIOFILE_FORMAT_OPUS,
         FormatCAF                   = PLANKAUDIOFILE_FORMAT_CAF,
         FormatW64                   = PLANKAUDIOFILE_FORMAT_W64,
+        FormatFLAC                  = PLANKAUDIOFILE_FORMAT_FLAC,
         FormatRegion                = PLANKAUDIOFILE_FORMAT_REGION,
         FormatMulti                 = PLANKAUDIOFILE_FORMAT_MULTI,
         FormatArray                 = PLANKAUDIOFILE_FORMAT_ARRAY,
@@ -0,0 +1,384 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "../../core/plonk_StandardHeader.h"
+
+BEGIN_PLONK_NAMESPACE
+
+#include "../../core/plonk_Headers.h"
+
+AudioFileBulkLoaderInternalBase::Worker::Worker (AudioFileBulkLoaderInternalBase* o, const char* name) throw()
+:   Threading::Thread (name),
+    owner (o)
+{
+}
+
+ResultCode AudioFileBulkLoaderInternalBase::Worker::run() throw()
+{
+    owner->scanFiles();
+    
+    // the last worker to finish scanning lays out the arena
+    while (!owner->layoutDone.getValue() && !getShouldExit())
+        owner->event.wait (0.001);
+    
+    if (!getShouldExit())
+        owner->loadFiles();
+    
+    return PlankResult_OK;
+}
+
+//------------------------------------------------------------------------------
+
+static int plonk_AudioFileBulkLoaderCompareSizes (const void* a, const void* b)
+{
+    const LongLong sizeA = static_cast<const LongLong*> (a)[0];
+    const LongLong sizeB = static_cast<const LongLong*> (b)[0];
+    return (sizeA < sizeB) ? 1 : (sizeA > sizeB) ? -1 : 0; // largest first
+}
+
+AudioFileBulkLoaderInternalBase::AudioFileBulkLoaderInternalBase (FilePathArray const& p,
+                                                                  const int bytes,
+                                                                  const int numWorkersToUse,
+                                                                  const int maxReads,
+                                                                  const LongLong maxBytesToUse,
+                                                                  const int bufferSizeToUse) throw()
+:   paths (p),
+    files (0),
+    order (0),
+    arena (0),
+    arenaSamples (0),
+    totalFrames (0),
+    numFiles (p.length()),
+    bytesPerSample (bytes),
+    maxConcurrentReads (maxReads),
+    maxBytes (maxBytesToUse),
+    bufferSize (plonk::max (1024, bufferSizeToUse)),
+    event (Lock::MutexLock)
+{
+    plonk_assert (bytesPerSample > 0);
+    
+    files = new FileInfo[plonk::max (1, numFiles)];
+    order = new int[plonk::max (1, numFiles)];
+    
+    for (int i = 0; i < numFiles; ++i)
+    {
+        files[i].numFrames = 0;
+        files[i].offset = 0;
+        files[i].sampleRate = 0.0;
+        files[i].numChannels = 0;
+        files[i].format = AudioFile::FormatInvalid;
+        order[i] = i;
+    }
+    
+    readsAvailable.setValue (maxConcurrentReads);
+    
+    const int numWorkers = plonk::min (numFiles, numWorkersToUse > 0 ? numWorkersToUse : Threading::getNumCores());
+    
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        const Text name = Text ("plonk::AudioFileBulkLoader::Worker[") + Text (i) + Text ("]");
+        workers.getInternal()->add (new Worker (this, name.getArray()));
+    }
+}
+
+AudioFileBulkLoaderInternalBase::~AudioFileBulkLoaderInternalBase()
+{
+    stop();
+    
+    const int numWorkers = workers.getInternal()->length();
+    
+    for (int i = 0; i < numWorkers; ++i)
+        delete workers.getInternal()->getArray()[i];
+    
+    if (arena != 0)
+        memory.free (arena);
+    
+    delete [] order;
+    delete [] files;
+}
+
+void AudioFileBulkLoaderInternalBase::start() throw()
+{
+    const int numWorkers = workers.getInternal()->length();
+    
+    if (numFiles == 0)
+        return;
+    
+    for (int i = 0; i < numWorkers; ++i)
+        workers.getInternal()->getArray()[i]->start();
+}
+
+void AudioFileBulkLoaderInternalBase::stop() throw()
+{
+    const int numWorkers = workers.getInternal()->length();
+    int i;
+    
+    stopRequested.setValue (1);
+    
+    for (i = 0; i < numWorkers; ++i)
+        workers.getInternal()->getArray()[i]->setShouldExit();
+    
+    for (i = 0; i < numWorkers; ++i)
+    {
+        event.signal();
+        
+        if (workers.getInternal()->getArray()[i]->isRunning())
+            workers.getInternal()->getArray()[i]->setShouldExitAndWait (0.0001);
+    }
+    
+    // the workers have exited so anything that did not get loaded is reported as failed
+    for (i = 0; i < numFiles; ++i)
+    {
+        if (files[i].status.compareAndSwap (FilePending, FileFailed) ||
+            files[i].status.compareAndSwap (FileLoading, FileFailed))
+        {
+            ++numFilesDone;
+        }
+    }
+    
+    event.signal();
+}
+
+bool AudioFileBulkLoaderInternalBase::wait (const double timeout) throw()
+{
+    plonk_assert (!Threading::currentThreadIsAudioThread());
+    
+    const double endTime = (timeout < 0.0) ? 0.0 : pl_TimeNow() + timeout;
+    
+    while (!isFinished())
+    {
+        if ((timeout >= 0.0) && (pl_TimeNow() >= endTime))
+            return false;
+        
+        event.wait (0.001);
+    }
+    
+    return true;
+}
+
+double AudioFileBulkLoaderInternalBase::getProgress() const throw()
+{
+    if (isFinished())
+        return 1.0;
+    
+    if (!layoutDone.getValue() || (totalFrames <= 0))
+        return 0.0;
+    
+    return double (framesLoaded.getValue()) / double (totalFrames);
+}
+
+bool AudioFileBulkLoaderInternalBase::placeOnNode (const int node) throw()
+{
+    if (!layoutDone.getValue() || (arena == 0))
+        return false;
+    
+    return Memory::placeOnNode (arena, (UnsignedLong)getNumBytes(), node);
+}
+
+void AudioFileBulkLoaderInternalBase::framesWereLoaded (const LongLong numFramesLoaded) throw()
+{
+    framesLoaded += numFramesLoaded;
+}
+
+void AudioFileBulkLoaderInternalBase::fileWasDone (const int index, const int status) throw()
+{
+    files[index].status.setValue (status);
+    
+    if (status == FileLoaded)
+        ++numFilesLoaded;
+    
+    ++numFilesDone;
+    event.signal();
+}
+
+void AudioFileBulkLoaderInternalBase::scanFiles() throw()
+{
+    int index;
+    
+    while ((index = ++nextScan - 1) < numFiles)
+    {
+        FileInfo& info = files[index];
+        
+        if (!shouldStop())
+        {
+            AudioFileReader reader (paths.atUnchecked (index), 0, AudioFile::MetaDataIOFlagsNone);
+            
+            if (reader.isReady())
+            {
+                info.numFrames   = reader.getNumFrames();
+                info.numChannels = reader.getNumChannels();
+                info.sampleRate  = reader.getSampleRate();
+                info.format      = reader.getFormat();
+            }
+        }
+        
+        if (++numScanned == numFiles)
+            layoutFiles();
+    }
+}
+
+void AudioFileBulkLoaderInternalBase::layoutFiles() throw()
+{
+    // sort the largest files first so the workers finish at about the same time
+    LongLong* sizes = new LongLong[numFiles * 2];
+    LongLong sampleAlignment, offset;
+    int i;
+    
+    for (i = 0; i < numFiles; ++i)
+    {
+        sizes[i * 2 + 0] = files[i].numFrames * files[i].numChannels;
+        sizes[i * 2 + 1] = i;
+    }
+    
+    qsort (sizes, numFiles, sizeof (LongLong) * 2, plonk_AudioFileBulkLoaderCompareSizes);
+    
+    for (i = 0; i < numFiles; ++i)
+        order[i] = (int)sizes[i * 2 + 1];
+    
+    delete [] sizes;
+    
+    // give each file a 16-byte aligned slice in file order until the memory limit is reached
+    sampleAlignment = plonk::max (1, 16 / bytesPerSample);
+    offset = 0;
+    
+    for (i = 0; i < numFiles; ++i)
+    {
+        FileInfo& info = files[i];
+        const LongLong numSamples = info.numFrames * info.numChannels;
+        
+        if ((numSamples <= 0) || (numSamples > 0x7FFFFFFF))
+        {
+            fileWasDone (i, FileFailed);
+            continue;
+        }
+        
+        if ((maxBytes > 0) && ((offset + numSamples) * bytesPerSample > maxBytes))
+        {
+            fileWasDone (i, FileSkipped);
+            continue;
+        }
+        
+        info.offset = offset;
+        offset += ((numSamples + sampleAlignment - 1) / sampleAlignment) * sampleAlignment;
+        totalFrames += info.numFrames;
+    }
+    
+    if (offset > 0)
+    {
+        arena = memory.allocateBytes ((UnsignedLong)(offset * bytesPerSample));
+        
+        if (arena != 0)
+        {
+            arenaSamples = offset;
+        }
+        else
+        {
+            for (i = 0; i < numFiles; ++i)
+                if (files[i].status.getValue() == FilePending)
+                    fileWasDone (i, FileFailed);
+        }
+    }
+    
+    layoutDone.setValue (1);
+    event.signal();
+}
+
+bool AudioFileBulkLoaderInternalBase::acquireRead (const int format) throw()
+{
+    // compressed files are limited by the decoder not the disk so don't need a slot
+    if ((maxConcurrentReads <= 0) ||
+        (format == AudioFile::FormatOggVorbis) ||
+        (format == AudioFile::FormatOpus) ||
+        (format == AudioFile::FormatFLAC))
+        return true;
+    
+    while (!shouldStop())
+    {
+        const int available = readsAvailable.getValue();
+        
+        if ((available > 0) && readsAvailable.compareAndSwap (available, available - 1))
+            return true;
+        
+        event.wait (0.001);
+    }
+    
+    return false;
+}
+
+void AudioFileBulkLoaderInternalBase::releaseRead (const int format) throw()
+{
+    if ((maxConcurrentReads <= 0) ||
+        (format == AudioFile::FormatOggVorbis) ||
+        (format == AudioFile::FormatOpus) ||
+        (format == AudioFile::FormatFLAC))
+        return;
+    
+    ++readsAvailable;
+    event.signal();
+}
+
+void AudioFileBulkLoaderInternalBase::loadFiles() throw()
+{
+    int next;
+    
+    while (((next = ++nextLoad - 1) < numFiles) && !shouldStop())
+    {
+        const int index = order[next];
+        FileInfo& info = files[index];
+        
+        if (!info.status.compareAndSwap (FilePending, FileLoading))
+            continue;
+        
+        if (!acquireRead (info.format))
+            break;
+        
+        AudioFileReader reader (paths.atUnchecked (index), bufferSize * bytesPerSample, AudioFile::MetaDataIOFlagsNone);
+        
+        // the file may have changed since it was scanned
+        const bool isValid = reader.isReady() &&
+                             (reader.getNumChannels() == info.numChannels) &&
+                             (reader.getNumFrames() >= info.numFrames);
+        
+        const bool success = isValid && loadFile (index, reader, static_cast<char*> (arena) + info.offset * bytesPerSample);
+        
+        releaseRead (info.format);
+        fileWasDone (index, success ? FileLoaded : FileFailed);
+    }
+}
+
+END_PLONK_NAMESPACE
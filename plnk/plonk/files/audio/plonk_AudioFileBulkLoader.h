@@ -0,0 +1,369 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_AUDIOFILEBULKLOADER_H
+#define PLONK_AUDIOFILEBULKLOADER_H
+
+#include "../../core/plonk_CoreForwardDeclarations.h"
+#include "../plonk_FilesForwardDeclarations.h"
+#include "../../core/plonk_SmartPointer.h"
+#include "../../core/plonk_SmartPointerContainer.h"
+#include "../../core/plonk_Thread.h"
+#include "../../core/plonk_Lock.h"
+#include "plonk_AudioFileReader.h"
+
+
+/** The type agnostic part of a bulk audio file loader.
+ This owns the worker threads, the contiguous sample arena and the progress
+ counters. Loading happens in two passes: the workers first read the header
+ of every file to find its size, then the arena is allocated once and the
+ workers decode and convert each file directly into its slice of the arena.
+ The arena is mapped from a MemoryArena with transparent huge pages and is not
+ cleared so each page is placed on the node of the worker that first writes
+ to it. */
+class AudioFileBulkLoaderInternalBase : public SmartPointer
+{
+public:
+    enum FileStatus
+    {
+        FilePending,
+        FileLoading,
+        FileLoaded,
+        FileFailed,     ///< The file could not be opened or read.
+        FileSkipped     ///< The file did not fit within the memory limit.
+    };
+    
+    struct FileInfo
+    {
+        LongLong numFrames;
+        LongLong offset;        ///< In samples from the start of the arena.
+        double sampleRate;
+        int numChannels;
+        int format;
+        AtomicInt status;
+    };
+    
+    class Worker : public Threading::Thread
+    {
+    public:
+        Worker (AudioFileBulkLoaderInternalBase* owner, const char* name) throw();
+        ResultCode run() throw();
+        
+    private:
+        AudioFileBulkLoaderInternalBase* owner;
+    };
+    
+    AudioFileBulkLoaderInternalBase (FilePathArray const& paths,
+                                     const int bytesPerSample,
+                                     const int numWorkers,
+                                     const int maxConcurrentReads,
+                                     const LongLong maxBytes,
+                                     const int bufferSize) throw();
+    ~AudioFileBulkLoaderInternalBase();
+    
+    /** Starts the worker threads, this must be called once after construction. */
+    void start() throw();
+    
+    /** Asks the workers to stop after the file they are loading and waits for them to exit. */
+    void stop() throw();
+    
+    /** Blocks until all the files are loaded or the timeout expires.
+     A negative timeout waits indefinitely. Returns isFinished(). */
+    bool wait (const double timeout) throw();
+    
+    PLONK_INLINE_LOW int getNumFiles() const throw()                { return numFiles; }
+    PLONK_INLINE_LOW FilePath getPath (const int index) const throw() { return paths.atUnchecked (index); }
+    PLONK_INLINE_LOW const FileInfo& getInfo (const int index) const throw() { return files[index]; }
+    PLONK_INLINE_LOW int getStatus (const int index) const throw()  { return files[index].status.getValue(); }
+    PLONK_INLINE_LOW bool isFinished() const throw()                { return numFilesDone.getValue() >= numFiles; }
+    PLONK_INLINE_LOW int getNumFilesLoaded() const throw()          { return numFilesLoaded.getValue(); }
+    PLONK_INLINE_LOW int getNumFilesFailed() const throw()          { return numFilesDone.getValue() - numFilesLoaded.getValue(); }
+    PLONK_INLINE_LOW LongLong getNumBytes() const throw()           { return arenaSamples * bytesPerSample; }
+    
+    /** The proportion of the sample frames that have been loaded so far. */
+    double getProgress() const throw();
+    
+    /** Moves the whole arena to a memory node, returns @c false if it could not be moved. */
+    bool placeOnNode (const int node) throw();
+    
+    friend class Worker;
+    
+protected:
+    /** Reads the whole file into the arena starting at @e dst.
+     This is called on a worker thread with an open reader. */
+    virtual bool loadFile (const int index, AudioFileReader& reader, void* dst) throw() = 0;
+    
+    void framesWereLoaded (const LongLong numFramesLoaded) throw();
+    
+    PLONK_INLINE_LOW void* getArenaBytes() const throw()    { return arena; }
+    PLONK_INLINE_LOW int getBufferSize() const throw()      { return bufferSize; }
+    PLONK_INLINE_LOW bool shouldStop() const throw()        { return stopRequested.getValue() != 0; }
+    
+private:
+    void scanFiles() throw();
+    void layoutFiles() throw();
+    void loadFiles() throw();
+    bool acquireRead (const int format) throw();
+    void releaseRead (const int format) throw();
+    void fileWasDone (const int index, const int status) throw();
+    
+    FilePathArray paths;
+    FileInfo* files;
+    int* order;
+    MemoryArena memory;
+    void* arena;
+    LongLong arenaSamples;
+    LongLong totalFrames;
+    const int numFiles;
+    const int bytesPerSample;
+    const int maxConcurrentReads;
+    const LongLong maxBytes;
+    const int bufferSize;
+    SimpleArray<Worker*> workers;
+    AtomicInt nextScan;
+    AtomicInt numScanned;
+    AtomicInt nextLoad;
+    AtomicInt layoutDone;
+    AtomicInt readsAvailable;
+    AtomicInt numFilesDone;
+    AtomicInt numFilesLoaded;
+    AtomicInt stopRequested;
+    AtomicLongLong framesLoaded;
+    Lock event;
+};
+
+//------------------------------------------------------------------------------
+
+template<class SampleType>
+class AudioFileBulkLoaderInternal : public AudioFileBulkLoaderInternalBase
+{
+public:
+    typedef NumericalArray<SampleType>  Buffer;
+    typedef SignalBase<SampleType>      SignalType;
+    typedef WavetableBase<SampleType>   WavetableType;
+    
+    AudioFileBulkLoaderInternal (FilePathArray const& paths,
+                                 const int numWorkers,
+                                 const int maxConcurrentReads,
+                                 const LongLong maxBytes,
+                                 const bool applyScaling,
+                                 const int bufferSize) throw()
+    :   AudioFileBulkLoaderInternalBase (paths, sizeof (SampleType), numWorkers, maxConcurrentReads, maxBytes, bufferSize),
+        scaling (applyScaling)
+    {
+    }
+    
+    ~AudioFileBulkLoaderInternal()
+    {
+        // the workers call loadFile() so must be stopped before this is destroyed
+        stop();
+    }
+    
+    /** The interleaved samples of a loaded file, these point into the arena and are not copied. */
+    Buffer getBuffer (const int index) const throw()
+    {
+        if (getStatus (index) != FileLoaded)
+            return Buffer::getNull();
+        
+        const FileInfo& info = getInfo (index);
+        return Buffer::withArrayNoCopy ((int)(info.numFrames * info.numChannels), getArena() + info.offset);
+    }
+    
+    SignalType getSignal (const int index) const throw()
+    {
+        const Buffer buffer = getBuffer (index);
+        
+        if (buffer.length() == 0)
+            return SignalType::getNull();
+        
+        const FileInfo& info = getInfo (index);
+        return SignalType (buffer, info.sampleRate, info.numChannels);
+    }
+    
+    WavetableType getWavetable (const int index) const throw()
+    {
+        plonk_assert ((getStatus (index) != FileLoaded) || (getInfo (index).numChannels == 1));
+        return WavetableType (getBuffer (index));
+    }
+    
+protected:
+    bool loadFile (const int index, AudioFileReader& reader, void* dst) throw()
+    {
+        const FileInfo& info = getInfo (index);
+        const int numChannels = info.numChannels;
+        const int chunkFrames = plonk::max (1, getBufferSize() / numChannels);
+        SampleType* data = static_cast<SampleType*> (dst);
+        LongLong framesRemaining = info.numFrames;
+        IntVariable oneLoop (1);
+        
+        while (framesRemaining > 0)
+        {
+            if (shouldStop())
+                return false;
+            
+            const int framesThisTime = (int)plonk::min (LongLong (chunkFrames), framesRemaining);
+            Buffer chunk = Buffer::withArrayNoCopy (framesThisTime * numChannels, data);
+            reader.getInternal()->readFrames (chunk, scaling, false, oneLoop);
+            
+            const int framesRead = chunk.length() / numChannels;
+            framesWereLoaded (framesRead);
+            
+            if (framesRead < framesThisTime)
+            {
+                // the header overstated the length so silence the remainder
+                Buffer::zeroData (data + framesRead * numChannels, (UnsignedLong)((framesRemaining - framesRead) * numChannels));
+                return (framesRemaining - framesRead) < info.numFrames;
+            }
+            
+            data += framesThisTime * numChannels;
+            framesRemaining -= framesThisTime;
+        }
+        
+        return true;
+    }
+    
+private:
+    PLONK_INLINE_LOW SampleType* getArena() const throw() { return static_cast<SampleType*> (getArenaBytes()); }
+    
+    const bool scaling;
+};
+
+/** Loads many audio files in parallel into one contiguous block of memory.
+ This is intended for sample libraries and instruments made of many files.
+ The files are decoded and converted to @e SampleType across a set of worker 
+ threads, compressed formats (Ogg Vorbis, Opus and FLAC) are decoded in
+ parallel on all the workers while the number of workers reading uncompressed 
+ files at once is limited by @e maxConcurrentReads so the disk is not thrashed.
+ 
+ Loading starts as soon as the loader is constructed and runs in the
+ background, use getProgress(), isFinished() or wait() to follow it. Each 
+ loaded file is available as a Signal or Wavetable. These refer directly to
+ the loader's memory so the loader must be kept alive for as long as they 
+ are in use.
+ 
+ @code
+ AudioFileBulkLoader<float> loader (paths, 0, 4, 2000 * 1024 * 1024);
+ loader.wait();
+ Signal piano = loader.getSignal (0);
+ @endcode
+ 
+ @see AudioFileReader
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class AudioFileBulkLoader : public SmartPointerContainer< AudioFileBulkLoaderInternal<SampleType> >
+{
+public:
+    typedef AudioFileBulkLoaderInternal<SampleType>     Internal;
+    typedef SmartPointerContainer<Internal>             Base;
+    typedef typename Internal::Buffer                   Buffer;
+    typedef typename Internal::SignalType               SignalType;
+    typedef typename Internal::WavetableType            WavetableType;
+    
+    AudioFileBulkLoader() throw()
+    :   Base (static_cast<Internal*> (0))
+    {
+    }
+    
+    /** Starts loading a set of files.
+     @param paths               The files to load.
+     @param numWorkers          The number of worker threads, 0 uses one per processor.
+     @param maxConcurrentReads  The maximum number of uncompressed files read at once, 0 for no limit.
+     @param maxBytes            The largest arena to allocate, files that would exceed this are skipped. 0 for no limit.
+     @param applyScaling        Whether to scale samples to the range of @e SampleType.
+     @param bufferSize          The number of samples decoded per read. */
+    AudioFileBulkLoader (FilePathArray const& paths,
+                         const int numWorkers = 0,
+                         const int maxConcurrentReads = 4,
+                         const LongLong maxBytes = 0,
+                         const bool applyScaling = true,
+                         const int bufferSize = 65536) throw()
+    :   Base (new Internal (paths, numWorkers, maxConcurrentReads, maxBytes, applyScaling, bufferSize))
+    {
+        this->getInternal()->start();
+    }
+    
+    AudioFileBulkLoader (AudioFileBulkLoader const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    AudioFileBulkLoader& operator= (AudioFileBulkLoader const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    /** Blocks the calling thread until loading has finished.
+     A negative timeout waits indefinitely. Returns isFinished(). */
+    PLONK_INLINE_LOW bool wait (const double timeout = -1.0) throw()      { return this->getInternal()->wait (timeout); }
+    
+    /** Stops loading, files that have not finished loading are marked as failed. */
+    PLONK_INLINE_LOW void cancel() throw()                              { this->getInternal()->stop(); }
+    
+    PLONK_INLINE_LOW bool isFinished() const throw()                    { return this->getInternal()->isFinished(); }
+    PLONK_INLINE_LOW double getProgress() const throw()                 { return this->getInternal()->getProgress(); }
+    PLONK_INLINE_LOW int getNumFiles() const throw()                    { return this->getInternal()->getNumFiles(); }
+    PLONK_INLINE_LOW int getNumFilesLoaded() const throw()              { return this->getInternal()->getNumFilesLoaded(); }
+    PLONK_INLINE_LOW int getNumFilesFailed() const throw()              { return this->getInternal()->getNumFilesFailed(); }
+    PLONK_INLINE_LOW LongLong getNumBytes() const throw()               { return this->getInternal()->getNumBytes(); }
+    PLONK_INLINE_LOW FilePath getPath (const int index) const throw()   { return this->getInternal()->getPath (index); }
+    
+    /** Moves all the loaded samples to a memory node.
+     Use this once loading has finished if the files will be played by 
+     workers on a different node from the loader's workers, see 
+     SignalBase::placeOnNode(). This is only a hint and returns @c false if
+     the samples could not be moved. */
+    PLONK_INLINE_LOW bool placeOnNode (const int node) throw()         { return this->getInternal()->placeOnNode (node); }
+    
+    /** Returns one of the Internal::FileStatus values. */
+    PLONK_INLINE_LOW int getStatus (const int index) const throw()      { return this->getInternal()->getStatus (index); }
+    PLONK_INLINE_LOW bool isLoaded (const int index) const throw()      { return getStatus (index) == Internal::FileLoaded; }
+    
+    /** The interleaved frames of a file, or a null Buffer if it is not loaded. */
+    PLONK_INLINE_LOW Buffer getBuffer (const int index) const throw()   { return this->getInternal()->getBuffer (index); }
+    
+    /** The file as an interleaved Signal, or a null Signal if it is not loaded. */
+    PLONK_INLINE_LOW SignalType getSignal (const int index) const throw()       { return this->getInternal()->getSignal (index); }
+    
+    /** The file as a Wavetable, this is only valid for mono files. */
+    PLONK_INLINE_LOW WavetableType getWavetable (const int index) const throw() { return this->getInternal()->getWavetable (index); }
+};
+
+#endif // PLONK_AUDIOFILEBULKLOADER_H
@@ -99,12 +99,15 @@ public:
     void readFrames (NumericalArray<SampleType>& data, const bool applyScaling, const bool deinterleave, IntVariable& numLoops) throw();
     
     template<class SampleType>
-    PLONK_INLINE_LOW void initSignal (SignalBase<SampleType>& signal, const int numFrames) const throw()
+    PLONK_INLINE_LOW void initSignal (SignalBase<SampleType>& signal, const int numFrames, const int node) const throw()
     {
         const int numChannels = getNumChannels();
         const int length = (numFrames > 0) ? numFrames * numChannels : (int)getNumFrames() * numChannels;
         NumericalArray<SampleType> buffer = NumericalArray<SampleType>::withSize (length);
         signal = SignalBase<SampleType> (buffer, getSampleRate(), numChannels);
+        
+        if (node >= 0)
+            signal.placeOnNode (node);
     }
     
     template<class SampleType>
@@ -303,14 +306,22 @@ void AudioFileReaderInternal::readFrames (NumericalArray<SampleType>& data,
             {
                 plonk_assertfalse; // haven't tested this yet...
                 SampleType* const deinterleaveBuffer = static_cast<SampleType*> (readBufferArray); 
-                Buffer::deinterleave (deinterleaveBuffer, dataArray, samplesRead, channels);
+                
+                for (int channel = 0; channel < channels; ++channel)
+                    for (int frame = 0; frame < framesRead; ++frame)
+                        deinterleaveBuffer[channel * framesRead + frame] = dataArray[frame * channels + channel];
+                
                 Buffer::copyData (dataArray, deinterleaveBuffer, samplesRead);
             }
             else if (!deinterleave && !isInterleaved)
             {
                 plonk_assertfalse; // haven't tested this yet...
                 SampleType* const interleaveBuffer = static_cast<SampleType*> (readBufferArray); 
-                Buffer::interleave (interleaveBuffer, dataArray, samplesRead / channels, channels);
+                
+                for (int channel = 0; channel < channels; ++channel)
+                    for (int frame = 0; frame < framesRead; ++frame)
+                        interleaveBuffer[frame * channels + channel] = dataArray[channel * framesRead + frame];
+                
                 Buffer::copyData (dataArray, interleaveBuffer, samplesRead);
             }
             
@@ -733,11 +744,13 @@ public:
     
     /** Initialises a Signal object in the appropriate format for the audio in the file.
      @param signal    The Signal object to initialise.
-     @param numFrames The number of frames the Signal should store. */
+     @param numFrames The number of frames the Signal should store.
+     @param node      The memory node of the threads that will play the Signal,
+                      -1 leaves it on the node of the calling thread. See SignalBase::placeOnNode(). */
     template<class SampleType>
-    void initSignal (SignalBase<SampleType>& signal, const int numFrames = 0) const throw()
+    void initSignal (SignalBase<SampleType>& signal, const int numFrames = 0, const int node = -1) const throw()
     {
-        getInternal()->initSignal (signal, numFrames);
+        getInternal()->initSignal (signal, numFrames, node);
     }
     
     /** Read frames into a pre-allocated Signal object and apply scaling. 
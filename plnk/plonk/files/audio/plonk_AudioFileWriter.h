@@ -118,6 +118,10 @@ public:
         {
             format = AudioFile::FormatW64;
         }
+        else if (ext.equalsIgnoreCase ("flac"))
+        {
+            format = AudioFile::FormatFLAC;
+        }
             
         if (!internal->initPCM (format, channelLayout, sampleRate, bufferSize))
         {
@@ -367,6 +371,12 @@ public:
         {
             if ((result = pl_AudioFileWriter_SetFormatW64 (&peer, sizeof (SampleType) * 8, channelLayout, sampleRate, this->isFloat)) != PlankResult_OK) goto exit;;
         }
+        else if (format == AudioFile::FormatFLAC)
+        {
+            // lossless integer only
+            if (this->isFloat) goto exit;
+            if ((result = pl_AudioFileWriter_SetFormatFLAC (&peer, sizeof (SampleType) * 8, channelLayout, sampleRate)) != PlankResult_OK) goto exit;
+        }
       
     exit:
         return result == PlankResult_OK;
@@ -673,7 +683,9 @@ public:
     /** Get the number of channels in the file. */
     PLONK_INLINE_LOW int getNumChannels() const throw()
     {
-        return pl_AudioFileWriter_GetNumChannels (&this->getInternal()->peer);
+        int numChannels = 0;
+        pl_AudioFileWriter_GetNumChannels (&this->getInternal()->peer, &numChannels);
+        return numChannels;
     }
     
     PLONK_INLINE_LOW ChannelLayout getChannelLayout() const throw()
@@ -0,0 +1,274 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#include "../../core/plonk_StandardHeader.h"
+
+BEGIN_PLONK_NAMESPACE
+
+#include "../../core/plonk_Headers.h"
+
+AudioFileWriterAsyncInternalBase::AudioFileWriterAsyncInternalBase() throw()
+:   event (Lock::MutexLock)
+{
+}
+
+AudioFileWriterAsyncInternalBase::~AudioFileWriterAsyncInternalBase()
+{
+}
+
+void AudioFileWriterAsyncInternalBase::bufferWasWritten (const bool success) throw()
+{
+    if (!success)
+        didFail.setValue (1);
+    
+    ++numBuffersWritten;
+    event.signal();
+}
+
+bool AudioFileWriterAsyncInternalBase::waitForBuffersWritten (const int target, const double timeout) throw()
+{
+    const double endTime = (timeout < 0.0) ? 0.0 : pl_TimeNow() + timeout;
+    
+    while ((getNumBuffersWritten() < target) && !getDidFail())
+    {
+        if ((timeout >= 0.0) && (pl_TimeNow() >= endTime))
+            return false;
+        
+        if (hasPendingBuffers())
+            schedule();
+        
+        event.wait (0.001);
+    }
+    
+    return getNumBuffersWritten() >= target;
+}
+
+//------------------------------------------------------------------------------
+
+AudioFileWriterAsyncFuture::AudioFileWriterAsyncFuture() throw()
+:   target (0),
+    waitForClose (false)
+{
+}
+
+AudioFileWriterAsyncFuture::AudioFileWriterAsyncFuture (AudioFileWriterAsyncTask const& t, const int n, const bool c) throw()
+:   task (t),
+    target (n),
+    waitForClose (c)
+{
+}
+
+bool AudioFileWriterAsyncFuture::isReady() const throw()
+{
+    if (task.isNull())
+        return true;
+    
+    if (task->getDidFail())
+        return true;
+    
+    if (task->getNumBuffersWritten() < target)
+        return false;
+    
+    return waitForClose ? task->isClosed() : true;
+}
+
+bool AudioFileWriterAsyncFuture::wait (const double timeout) throw()
+{
+    plonk_assert (!Threading::currentThreadIsAudioThread());
+    
+    if (task.isNull())
+        return true;
+    
+    const double endTime = (timeout < 0.0) ? 0.0 : pl_TimeNow() + timeout;
+    
+    if (!task.getInternal()->waitForBuffersWritten (target, timeout))
+        return isReady();
+    
+    while (!isReady())
+    {
+        if ((timeout >= 0.0) && (pl_TimeNow() >= endTime))
+            return false;
+        
+        if (task.getInternal()->hasPendingBuffers())
+            task.getInternal()->schedule();
+        
+        Threading::sleep (0.001);
+    }
+    
+    return true;
+}
+
+bool AudioFileWriterAsyncFuture::getSucceeded() const throw()
+{
+    return task.isNull() ? true : isReady() && !task->getDidFail();
+}
+
+//------------------------------------------------------------------------------
+
+AudioFileWriterAsyncPoolInternal::Worker::Worker (AudioFileWriterAsyncPoolInternal* o, const char* name) throw()
+:   Threading::Thread (name),
+    owner (o)
+{
+}
+
+ResultCode AudioFileWriterAsyncPoolInternal::Worker::run() throw()
+{
+    if (owner->priority >= 0)
+        setPriority (owner->priority);
+    
+    AudioFileWriterAsyncInternalBase* internal;
+    
+    while (!getShouldExit())
+    {
+        if (owner->tasks.pop (internal))
+        {
+            // take over the reference from add()
+            AudioFileWriterAsyncTask task (internal);
+            internal->decrementRefCount();
+            
+            // signals are merged so pass one on if another worker could help
+            if (owner->tasks.length() > 0)
+                owner->event.signal();
+            
+            // this worker owns the task until it releases the schedule flag,
+            // reclaim it if more buffers arrived after the release
+            do
+            {
+                task->service();
+                task->releaseSchedule();
+            }
+            while (task->hasPendingBuffers() && task->trySchedule());
+        }
+        else
+        {
+            owner->event.wait();
+        }
+    }
+    
+    // wake the next worker so they all see they should exit
+    owner->event.signal();
+    
+    return PlankResult_OK;
+}
+
+AudioFileWriterAsyncPoolInternal::AudioFileWriterAsyncPoolInternal (const int numWorkers, const int p, const int maxWriters) throw()
+:   tasks (plonk::max (1, maxWriters), true),
+    event (Lock::SemaphoreLock),
+    priority (p)
+{
+    plonk_assert (numWorkers > 0);
+    
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        const Text name = Text ("plonk::AudioFileWriterAsyncPool::Worker[") + Text (i) + Text ("]");
+        Worker* worker = new Worker (this, name.getArray());
+        workers.getInternal()->add (worker);
+        worker->start();
+    }
+}
+
+AudioFileWriterAsyncPoolInternal::~AudioFileWriterAsyncPoolInternal()
+{
+    const int numWorkers = workers.getInternal()->length();
+    int i;
+    
+    for (i = 0; i < numWorkers; ++i)
+        workers.getInternal()->getArray()[i]->setShouldExit();
+    
+    event.signal();
+    
+    for (i = 0; i < numWorkers; ++i)
+    {
+        workers.getInternal()->getArray()[i]->wait();
+        delete workers.getInternal()->getArray()[i];
+    }
+    
+    // anything still queued is written synchronously so no frames are lost
+    AudioFileWriterAsyncInternalBase* internal;
+    
+    while (tasks.pop (internal))
+    {
+        internal->service();
+        internal->releaseSchedule();
+        internal->decrementRefCount();
+    }
+}
+
+bool AudioFileWriterAsyncPoolInternal::add (AudioFileWriterAsyncTask const& task) throw()
+{
+    // the queue holds a plain pointer so keep the task alive until a worker takes it
+    AudioFileWriterAsyncInternalBase* const internal = task.getInternal();
+    internal->incrementRefCount();
+    
+    if (!tasks.push (internal))
+    {
+        internal->decrementRefCount();
+        return false;
+    }
+    
+    event.signal();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+AudioFileWriterAsyncPool::AudioFileWriterAsyncPool (const int numWorkers, const int priority, const int maxWriters) throw()
+:   Base (new Internal (numWorkers, priority, maxWriters))
+{
+}
+
+AudioFileWriterAsyncPool::AudioFileWriterAsyncPool (AudioFileWriterAsyncPool const& copy) throw()
+:   Base (static_cast<Base const&> (copy))
+{
+}
+
+AudioFileWriterAsyncPool& AudioFileWriterAsyncPool::operator= (AudioFileWriterAsyncPool const& other) throw()
+{
+    if (this != &other)
+        this->setInternal (other.getInternal());
+    
+    return *this;
+}
+
+const AudioFileWriterAsyncPool& AudioFileWriterAsyncPool::getDefault() throw()
+{
+    static AudioFileWriterAsyncPool pool;
+    return pool;
+}
+
+END_PLONK_NAMESPACE
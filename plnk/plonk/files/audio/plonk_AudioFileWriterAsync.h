@@ -0,0 +1,474 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_AUDIOFILEWRITERASYNC_H
+#define PLONK_AUDIOFILEWRITERASYNC_H
+
+#include "../../core/plonk_CoreForwardDeclarations.h"
+#include "../plonk_FilesForwardDeclarations.h"
+#include "../../core/plonk_SmartPointer.h"
+#include "../../core/plonk_WeakPointer.h"
+#include "../../core/plonk_SmartPointerContainer.h"
+#include "../../core/plonk_Thread.h"
+#include "../../core/plonk_Lock.h"
+#include "../../containers/plonk_RingQueue.h"
+#include "plonk_AudioFileWriter.h"
+
+
+/** The type agnostic part of an asynchronous audio file writer.
+ This holds the counters and the scheduling flag that the worker pool uses to
+ make sure only one worker thread is ever encoding a particular file. */
+class AudioFileWriterAsyncInternalBase : public SmartPointer
+{
+public:
+    AudioFileWriterAsyncInternalBase() throw();
+    ~AudioFileWriterAsyncInternalBase();
+    
+    /** Encode and write all pending buffers.
+     This is only ever called on a pool worker thread that has claimed this writer
+     via trySchedule(). Returns @c false if a write failed. */
+    virtual bool service() throw() = 0;
+    
+    /** Returns @c true if there are buffers waiting to be written. */
+    virtual bool hasPendingBuffers() throw() = 0;
+    
+    /** Queues the writer with its pool unless it is already queued or being serviced. */
+    virtual void schedule() throw() = 0;
+    
+    /** Attempts to claim this writer for servicing.
+     Returns @c true if the caller now owns it (and must push it to a pool). */
+    PLONK_INLINE_LOW bool trySchedule() throw()             { return scheduled.compareAndSwap (0, 1); }
+    PLONK_INLINE_LOW void releaseSchedule() throw()         { scheduled.setValue (0); }
+    
+    PLONK_INLINE_LOW int getNumBuffersQueued() const throw()  { return numBuffersQueued.getValue(); }
+    PLONK_INLINE_LOW int getNumBuffersWritten() const throw() { return numBuffersWritten.getValue(); }
+    PLONK_INLINE_LOW int getNumFramesDropped() const throw()  { return numFramesDropped.getValue(); }
+    PLONK_INLINE_LOW bool getDidFail() const throw()          { return didFail.getValue() != 0; }
+    PLONK_INLINE_LOW bool isClosed() const throw()            { return closed.getValue() != 0; }
+    
+    /** Blocks until at least @e target buffers have been written, the writer fails or the timeout expires. */
+    bool waitForBuffersWritten (const int target, const double timeout) throw();
+    
+protected:
+    void bufferWasWritten (const bool success) throw();
+    
+    AtomicInt scheduled;
+    AtomicInt numBuffersQueued;
+    AtomicInt numBuffersWritten;
+    AtomicInt numFramesDropped;
+    AtomicInt didFail;
+    AtomicInt closeRequested;
+    AtomicInt closed;
+    Lock event;
+};
+
+typedef SmartPointerContainer<AudioFileWriterAsyncInternalBase> AudioFileWriterAsyncTask;
+
+//------------------------------------------------------------------------------
+
+/** The result of AudioFileWriterAsync::flush() or AudioFileWriterAsync::close().
+ This becomes ready once all the frames written before the flush or close was
+ requested have been encoded and written to the file. It does not allocate memory
+ so it is safe to obtain on the audio thread (although not to wait on there).
+ @ingroup PlonkOtherUserClasses */
+class AudioFileWriterAsyncFuture
+{
+public:
+    AudioFileWriterAsyncFuture() throw();
+    AudioFileWriterAsyncFuture (AudioFileWriterAsyncTask const& task, const int target, const bool waitForClose) throw();
+    
+    /** Returns @c true if the flush or close has completed. */
+    bool isReady() const throw();
+    
+    /** Blocks the calling thread until the flush or close has completed.
+     A negative timeout waits indefinitely. Returns isReady(). */
+    bool wait (const double timeout = -1.0) throw();
+    
+    /** Returns @c true if every buffer was written successfully. */
+    bool getSucceeded() const throw();
+    
+private:
+    AudioFileWriterAsyncTask task;
+    int target;
+    bool waitForClose;
+};
+
+//------------------------------------------------------------------------------
+
+class AudioFileWriterAsyncPoolInternal : public SmartPointer
+{
+public:
+    class Worker : public Threading::Thread
+    {
+    public:
+        Worker (AudioFileWriterAsyncPoolInternal* owner, const char* name) throw();
+        ResultCode run() throw();
+        
+    private:
+        AudioFileWriterAsyncPoolInternal* owner;
+    };
+    
+    AudioFileWriterAsyncPoolInternal (const int numWorkers, const int priority, const int maxWriters) throw();
+    ~AudioFileWriterAsyncPoolInternal();
+    
+    bool add (AudioFileWriterAsyncTask const& task) throw();
+    
+    PLONK_INLINE_LOW int getNumWorkers() const throw() { return workers.getInternal()->length(); }
+    
+    friend class Worker;
+    
+private:
+    RingQueue<AudioFileWriterAsyncInternalBase*> tasks;   // each holds a reference taken in add()
+    SimpleArray<Worker*> workers;
+    Lock event;                                             // a semaphore so add() never blocks
+    int priority;
+};
+
+/** A pool of threads that encode and write files for AudioFileWriterAsync.
+ Each file is only ever encoded by one worker at a time but different files
+ are encoded in parallel across the workers. Writers waiting for a worker 
+ are queued in a bounded queue so scheduling a writer never allocates, 
+ @e maxWriters is the number of writers that may be waiting at once.
+ @ingroup PlonkOtherUserClasses */
+class AudioFileWriterAsyncPool : public SmartPointerContainer<AudioFileWriterAsyncPoolInternal>
+{
+public:
+    typedef AudioFileWriterAsyncPoolInternal    Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    
+    AudioFileWriterAsyncPool (const int numWorkers = 2, const int priority = -1, const int maxWriters = 256) throw();
+    AudioFileWriterAsyncPool (AudioFileWriterAsyncPool const& copy) throw();
+    AudioFileWriterAsyncPool& operator= (AudioFileWriterAsyncPool const& other) throw();
+    
+    /** The pool shared by writers that are not given a pool explicitly. */
+    static const AudioFileWriterAsyncPool& getDefault() throw();
+    
+    /** Queues a writer for a worker, returns @c false if maxWriters are already waiting. */
+    PLONK_INLINE_LOW bool add (AudioFileWriterAsyncTask const& task) throw() { return this->getInternal()->add (task); }
+    PLONK_INLINE_LOW int getNumWorkers() const throw() { return this->getInternal()->getNumWorkers(); }
+};
+
+//------------------------------------------------------------------------------
+
+template<class SampleType>
+class AudioFileWriterAsyncInternal : public AudioFileWriterAsyncInternalBase
+{
+public:
+    typedef AudioFileWriter<SampleType>         Writer;
+    typedef NumericalArray<SampleType>          Buffer;
+    typedef ObjectArray<Buffer>                 Buffers;
+    typedef RingQueue<int>                      BufferQueue;
+    
+    AudioFileWriterAsyncInternal (Writer const& writerToUse,
+                                  AudioFileWriterAsyncPool const& poolToUse,
+                                  const int numBuffers, const int bufferFrames) throw()
+    :   writer (writerToUse),
+        pool (poolToUse),
+        numChannels (plonk::max (1, writerToUse.getNumChannels())),
+        bufferLength (numChannels * (bufferFrames > 0 ? bufferFrames : 4096)),
+        bufferFrameCounts (IntArray::newClear (plonk::max (1, numBuffers))),
+        activeBuffers (plonk::max (1, numBuffers)),
+        freeBuffers (plonk::max (1, numBuffers)),
+        current (-1),
+        currentPosition (0)
+    {
+        plonk_assert (numBuffers > 1);
+        
+        // the queues pass indices into the preallocated buffers so never allocate
+        for (int i = 0; i < bufferFrameCounts.length(); ++i)
+        {
+            buffers.add (Buffer::withSize (bufferLength));
+            freeBuffers.push (i);
+        }
+        
+        freeBuffers.pop (current);
+    }
+    
+    ~AudioFileWriterAsyncInternal()
+    {
+    }
+    
+    /** Copy frames to the staging buffers, never blocks.
+     Returns @c false if some frames were dropped because the workers have fallen behind. */
+    bool writeFrames (const int numFrames, const SampleType* frameData) throw()
+    {
+        plonk_assert (closeRequested.getValueUnchecked() == 0);
+        
+        int numSamplesRemaining = numFrames * numChannels;
+        
+        while (numSamplesRemaining > 0)
+        {
+            if ((current < 0) && !freeBuffers.pop (current))
+            {
+                numFramesDropped += numSamplesRemaining / numChannels;
+                return false;
+            }
+            
+            const int numSamplesThisTime = plonk::min (bufferLength - currentPosition, numSamplesRemaining);
+            Buffer::copyData (buffers.atUnchecked (current).getArray() + currentPosition, frameData, numSamplesThisTime);
+            
+            currentPosition += numSamplesThisTime;
+            frameData += numSamplesThisTime;
+            numSamplesRemaining -= numSamplesThisTime;
+            
+            if (currentPosition == bufferLength)
+                queueCurrent();
+        }
+        
+        return true;
+    }
+    
+    /** Like writeFrames() but waits for a free buffer rather than dropping frames.
+     This is for offline exports and must not be called on the audio thread. */
+    bool writeFramesWait (const int numFrames, const SampleType* frameData) throw()
+    {
+        int numSamplesRemaining = numFrames * numChannels;
+        
+        while (numSamplesRemaining > 0)
+        {
+            while ((current < 0) && !freeBuffers.pop (current))
+            {
+                if (getDidFail())
+                    return false;
+                
+                schedule();
+                event.wait (0.001);
+            }
+            
+            const int numFramesThisTime = plonk::min (bufferLength - currentPosition, numSamplesRemaining) / numChannels;
+            
+            if (!writeFrames (numFramesThisTime, frameData))
+                return false;
+            
+            frameData += numFramesThisTime * numChannels;
+            numSamplesRemaining -= numFramesThisTime * numChannels;
+        }
+        
+        return true;
+    }
+    
+    AudioFileWriterAsyncFuture flush() throw()
+    {
+        if (currentPosition > 0)
+            queueCurrent();
+        
+        return AudioFileWriterAsyncFuture (AudioFileWriterAsyncTask (this), numBuffersQueued.getValue(), false);
+    }
+    
+    AudioFileWriterAsyncFuture close() throw()
+    {
+        if (currentPosition > 0)
+            queueCurrent();
+        
+        closeRequested.setValue (1);
+        schedule();
+        
+        return AudioFileWriterAsyncFuture (AudioFileWriterAsyncTask (this), numBuffersQueued.getValue(), true);
+    }
+    
+    bool hasPendingBuffers() throw()
+    {
+        return (activeBuffers.length() > 0) || ((closeRequested.getValue() != 0) && (closed.getValue() == 0));
+    }
+    
+    void schedule() throw()
+    {
+        // if the pool's queue is full the next buffer or a wait on a future tries again
+        if (trySchedule() && !pool.add (AudioFileWriterAsyncTask (this)))
+            releaseSchedule();
+    }
+    
+    bool service() throw()
+    {
+        int index;
+        bool success = true;
+        
+        while (activeBuffers.pop (index))
+        {
+            success = writer.writeFrames (bufferFrameCounts.atUnchecked (index), buffers.atUnchecked (index).getArray()) && success;
+            
+            freeBuffers.push (index);
+            bufferWasWritten (success);
+        }
+        
+        if ((closeRequested.getValue() != 0) && (closed.getValue() == 0))
+        {
+            writer.close();
+            closed.setValue (1);
+            event.signal();
+        }
+        
+        return success;
+    }
+    
+    PLONK_INLINE_LOW Writer& getWriter() throw() { return writer; }
+    PLONK_INLINE_LOW int getNumFreeBuffers() throw() { return freeBuffers.length() + (current >= 0 ? 1 : 0); }
+    
+private:
+    void queueCurrent() throw()
+    {
+        bufferFrameCounts.atUnchecked (current) = currentPosition / numChannels;
+        
+        // there are only as many indices as slots so this can't fail
+        const bool pushed = activeBuffers.push (current);
+        plonk_assert (pushed);
+#ifndef PLONK_DEBUG
+        (void)pushed;
+#endif
+        ++numBuffersQueued;
+        
+        current = -1;
+        currentPosition = 0;
+        
+        freeBuffers.pop (current);
+        schedule();
+    }
+    
+    Writer writer;
+    AudioFileWriterAsyncPool pool;
+    const int numChannels;
+    const int bufferLength;
+    Buffers buffers;
+    IntArray bufferFrameCounts;
+    BufferQueue activeBuffers;
+    BufferQueue freeBuffers;
+    int current;                // only touched by the thread calling writeFrames(), -1 if there is no buffer
+    int currentPosition;
+};
+
+
+/** Asynchronous audio file writing class.
+ This wraps an AudioFileWriter so that writeFrames() only copies into a set of
+ preallocated staging buffers and never blocks or allocates. Encoding (e.g., Ogg Vorbis
+ or Opus) and the file I/O happen on the threads of an AudioFileWriterAsyncPool.
+ The number of buffers provides the back-pressure: if the pool falls behind
+ writeFrames() drops frames and returns @c false rather than waiting 
+ (see getNumFramesDropped()). The writer must be driven from one thread.
+ 
+ @code
+ AudioFileWriter<float> file ("/path/to/take.ogg", 2, 44100.0, 0.5f);
+ AudioFileWriterAsync<float> capture (file);
+ ...
+ capture.writeFrames (numFrames, interleavedSamples); // e.g., on the audio thread
+ ...
+ capture.close().wait();
+ @endcode
+ 
+ @see AudioFileWriter, AudioFileWriterAsyncPool
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class AudioFileWriterAsync : public SmartPointerContainer< AudioFileWriterAsyncInternal<SampleType> >
+{
+public:
+    typedef AudioFileWriterAsyncInternal<SampleType>    Internal;
+    typedef SmartPointerContainer<Internal>             Base;
+    typedef AudioFileWriter<SampleType>                 Writer;
+    typedef NumericalArray<SampleType>                  Buffer;
+    
+    AudioFileWriterAsync() throw()
+    :   Base (static_cast<Internal*> (0))
+    {
+    }
+    
+    AudioFileWriterAsync (Writer const& writer,
+                          AudioFileWriterAsyncPool const& pool = AudioFileWriterAsyncPool::getDefault(),
+                          const int numBuffers = 8, const int bufferFrames = 4096) throw()
+    :   Base (new Internal (writer, pool, numBuffers, bufferFrames))
+    {
+    }
+    
+    AudioFileWriterAsync (AudioFileWriterAsync const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    AudioFileWriterAsync& operator= (AudioFileWriterAsync const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    /** Queue interleaved frames for writing without blocking. */
+    PLONK_INLINE_LOW bool writeFrames (const int numFrames, const SampleType* frameData) throw()
+    {
+        return this->getInternal()->writeFrames (numFrames, frameData);
+    }
+    
+    PLONK_INLINE_LOW bool writeFrames (Buffer const& frames) throw()
+    {
+        const int numChannels = this->getNumChannels();
+        plonk_assert ((frames.length() % numChannels) == 0);
+        return this->getInternal()->writeFrames (frames.length() / numChannels, frames.getArray());
+    }
+    
+    /** Queue interleaved frames for writing, waiting for buffers to become free if necessary. */
+    PLONK_INLINE_LOW bool writeFramesWait (const int numFrames, const SampleType* frameData) throw()
+    {
+        return this->getInternal()->writeFramesWait (numFrames, frameData);
+    }
+    
+    PLONK_INLINE_LOW bool writeFramesWait (Buffer const& frames) throw()
+    {
+        const int numChannels = this->getNumChannels();
+        plonk_assert ((frames.length() % numChannels) == 0);
+        return this->getInternal()->writeFramesWait (frames.length() / numChannels, frames.getArray());
+    }
+    
+    /** Queue any partially filled buffer and return a future for its completion. */
+    PLONK_INLINE_LOW AudioFileWriterAsyncFuture flush() throw()
+    {
+        return this->getInternal()->flush();
+    }
+    
+    /** Flush then close the file on the worker thread, no further frames may be written. */
+    PLONK_INLINE_LOW AudioFileWriterAsyncFuture close() throw()
+    {
+        return this->getInternal()->close();
+    }
+    
+    PLONK_INLINE_LOW int getNumChannels() const throw()         { return this->getInternal()->getWriter().getNumChannels(); }
+    PLONK_INLINE_LOW double getSampleRate() const throw()       { return this->getInternal()->getWriter().getSampleRate(); }
+    PLONK_INLINE_LOW int getNumFramesDropped() const throw()    { return this->getInternal()->getNumFramesDropped(); }
+    PLONK_INLINE_LOW int getNumFreeBuffers() const throw()      { return this->getInternal()->getNumFreeBuffers(); }
+    PLONK_INLINE_LOW bool getDidFail() const throw()            { return this->getInternal()->getDidFail(); }
+    PLONK_INLINE_LOW bool isClosed() const throw()              { return this->getInternal()->isClosed(); }
+};
+
+#endif // PLONK_AUDIOFILEWRITERASYNC_H
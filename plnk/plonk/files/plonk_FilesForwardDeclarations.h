@@ -48,6 +48,9 @@ class BinaryFile;
 class AudioFile;
 class AudioFileReader;
 template<class SampleType> class AudioFileWriter;
+template<class SampleType> class AudioFileWriterAsync;
+class AudioFileWriterAsyncPool;
+template<class SampleType> class AudioFileBulkLoader;
 
 typedef ObjectArray<TextFile>        TextFileArray;
 typedef ObjectArray<BinaryFile>      BinaryFileArray;
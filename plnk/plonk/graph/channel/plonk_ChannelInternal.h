@@ -72,7 +72,8 @@ public:
                      BlockSize const& blockSize,
                      SampleRate const& sampleRate) throw()
     :   Internal (inputDictionary, blockSize, sampleRate),
-        state (initState)
+        state (initState),
+        initialState (0)
     {
         this->getSampleRate().addReceiver (this);
         this->updateSampleRateInData();
@@ -81,6 +82,7 @@ public:
     ~ChannelInternal()
     {
         this->getSampleRate().removeReceiver (this);
+        delete initialState;
     }
     
     const DataType& getState() const throw() { return state; }
@@ -137,6 +139,25 @@ public:
         }
     }
     
+    void markInitialState() throw()
+    {
+        Internal::markInitialState();
+        
+        if (initialState == 0)
+            initialState = new DataType (state);
+        else
+            *initialState = state;
+    }
+    
+    void resetState() throw()
+    {
+        plonk_assert (initialState != 0); // markInitialState() must be called first
+        
+        Internal::resetState();
+        state = *initialState;
+        this->updateSampleRateInData();
+    }
+    
     void updateSampleRateInData() throw()
     {
         BaseData& baseData (reinterpret_cast<BaseData&> (state));
@@ -152,6 +173,7 @@ public:
     
 private:
     DataType state;
+    DataType* initialState;     // only allocated by markInitialState()
     
     ChannelInternal();
     ChannelInternal (const ChannelInternal&);
@@ -67,12 +67,15 @@ public:
     typedef LockFreeQueue<UnitType>                 QueueType;
     typedef QueueBufferBase<SampleType>             QueueBufferType;
     typedef LockFreeQueue<QueueBufferType>          BufferQueueType;
+    
+    typedef void (*ProcessFunction) (ChannelInternalBase*, ProcessInfo&, const int);
 
     ChannelInternalBase (Inputs const& inputDictionary, 
                          BlockSize const& blockSize, 
                          SampleRate const& sampleRate) throw()
     :   ChannelInternalCore (inputDictionary, blockSize, sampleRate),
         outputBuffer (Buffer::newClear (blockSize.getValue())),
+        initialValue (0),
         usingExternalBuffer (false)
     {
 #ifdef PLONK_DEBUG
@@ -98,6 +101,7 @@ public:
     PLONK_INLINE_LOW const SampleRate& getInputAsSampleRate (const int key) const throw()             { return this->template getInputAs<SampleRate> (key); }
     PLONK_INLINE_LOW const BlockSize& getInputAsBlockSize (const int key) const throw()               { return this->template getInputAs<BlockSize> (key); }
     PLONK_INLINE_LOW const AudioFileReader& getInputAsAudioFileReader (const int key) const throw()   { return this->template getInputAs<AudioFileReader> (key); }
+    PLONK_INLINE_LOW const FloatNeuralNetworkDoubleBuffer& getInputAsNeuralNetwork (const int key) const throw()   { return this->template getInputAs<FloatNeuralNetworkDoubleBuffer> (key); }
     PLONK_INLINE_LOW const QueueType& getInputAsUnitQueue (const int key) const throw()               { return this->template getInputAs<QueueType> (key); }
     PLONK_INLINE_LOW const BufferQueueType& getInputAsBufferQueue (const int key) const throw()       { return this->template getInputAs<BufferQueueType> (key); }
 
@@ -113,6 +117,7 @@ public:
     PLONK_INLINE_LOW SampleRate& getInputAsSampleRate (const int key) throw()                         { return this->template getInputAs<SampleRate> (key); }
     PLONK_INLINE_LOW BlockSize& getInputAsBlockSize (const int key) throw()                           { return this->template getInputAs<BlockSize> (key); }
     PLONK_INLINE_LOW AudioFileReader& getInputAsAudioFileReader (const int key) throw()               { return this->template getInputAs<AudioFileReader> (key); }
+    PLONK_INLINE_LOW FloatNeuralNetworkDoubleBuffer& getInputAsNeuralNetwork (const int key) throw()   { return this->template getInputAs<FloatNeuralNetworkDoubleBuffer> (key); }
     PLONK_INLINE_LOW QueueType& getInputAsUnitQueue (const int key) throw()                           { return this->template getInputAs<QueueType> (key); }
     PLONK_INLINE_LOW BufferQueueType& getInputAsBufferQueue (const int key) throw()                   { return this->template getInputAs<BufferQueueType> (key); }
 
@@ -145,6 +150,15 @@ public:
         outputBuffer = Buffer::newClear (this->getBlockSize().getValue());
     }
     
+    /** Returns to a buffer of the channel's own, e.g., one kept from before setOutputBuffer(). */
+    PLONK_INLINE_LOW void removeExternalBuffer (Buffer const& ownBuffer) throw()
+    {
+        plonk_assert (usingExternalBuffer == true);
+        usingExternalBuffer = false;
+        outputBuffer = ownBuffer;
+        this->updateBlockSize();
+    }
+    
     virtual void setBlockSize (BlockSize const& newBlockSize) throw()
     {        
         if (newBlockSize != this->getBlockSize())
@@ -172,6 +186,42 @@ public:
         outputBuffer.last() = value;
     }
     
+    /** Records the current state so resetState() can return to it later.
+     This is used by VoicePool to recycle voices rather than delete them. 
+     ChannelInternal allocates a copy of its Data here so only channels that
+     are marked pay for it, subclasses that keep other state that changes 
+     during processing should override both functions. */
+    virtual void markInitialState() throw()
+    {
+        initialValue = outputBuffer.last();
+    }
+    
+    /** Returns to the state recorded by markInitialState(). */
+    virtual void resetState() throw()
+    {
+        this->resetTimeStamps();
+        outputBuffer.last() = initialValue;
+    }
+    
+    /** Returns a function that calls this channel's process().
+     The default makes a virtual call. Subclasses with a cheap process() can 
+     return processDirect<TheirType> so an ExecutionPlan calls it directly. */
+    virtual ProcessFunction getProcessFunction() const throw()
+    {
+        return &ChannelInternalBase::processVirtual;
+    }
+    
+    static void processVirtual (ChannelInternalBase* internal, ProcessInfo& info, const int channel) throw()
+    {
+        internal->process (info, channel);
+    }
+    
+    template<class InternalType>
+    static void processDirect (ChannelInternalBase* internal, ProcessInfo& info, const int channel) throw()
+    {
+        static_cast<InternalType*> (internal)->InternalType::process (info, channel);
+    }
+    
     PLONK_INLINE_LOW const Text getOutputTypeName() const throw()         { return TypeUtility<SampleType>::getTypeName(); }
     virtual const Text getInputTypeName() const throw()         { return TypeUtility<SampleType>::getTypeName(); }
     PLONK_INLINE_LOW int getOutputTypeCode() const throw()                { return TypeUtility<SampleType>::getTypeCode(); }
@@ -204,6 +254,7 @@ public:
     
 private:
     Buffer outputBuffer;
+    SampleType initialValue;
     bool usingExternalBuffer;
     
 #ifdef PLONK_DEBUG
@@ -70,6 +70,23 @@ void ChannelInternalCore::updateTimeStamp() throw()
     }
 }
 
+void ChannelInternalCore::resetTimeStamps() throw()
+{
+    lastTimeStamp = TimeStamp (-1, 0.0);
+    nextTimeStamp = TimeStamp::getZero();
+    expiryTimeStamp = TimeStamp::getMaximum();
+}
+
+void ChannelInternalCore::suspendTimeStamps() throw()
+{
+    nextTimeStamp = TimeStamp::getMaximum();
+}
+
+void ChannelInternalCore::resumeTimeStamps() throw()
+{
+    nextTimeStamp = TimeStamp::getZero();
+}
+
 void ChannelInternalCore::setLabel (Text const& newId) throw()
 {
     identifier = newId;
@@ -78,11 +78,24 @@ public:
     virtual ~ChannelInternalCore() { }
     
     const TimeStamp& getNextTimeStamp() const throw() { return nextTimeStamp; }
+    const TimeStamp& getExpiryTimeStamp() const throw() { return expiryTimeStamp; }
     void setNextTimeStamp (TimeStamp const& newTimeStamp) throw();
     void setLastTimeStamp (TimeStamp const& newTimeStamp) throw();
     void setExpiryTimeStamp (TimeStamp const& newTimeStamp) throw();
     bool shouldBeDeletedNow (TimeStamp const& time) const throw();
     
+    /** Returns the time stamps to their state on construction.
+     The channel will then process on the next call regardless of the time and 
+     is no longer expired. */
+    void resetTimeStamps() throw();
+    
+    /** Stops the channel processing when its consumers pull it.
+     This is for ExecutionPlan which processes the channel itself. */
+    void suspendTimeStamps() throw();
+    
+    /** Lets the channel process again the next time it is pulled. */
+    void resumeTimeStamps() throw();
+    
     PLONK_INLINE_HIGH const Inputs& getInputs() const throw()                                      { return this->inputs; }
     PLONK_INLINE_HIGH Inputs& getInputs() throw()                                                  { return this->inputs; }
     
@@ -106,6 +119,11 @@ public:
     virtual bool isProxy() const throw()                { return false; }
     virtual bool isTypeConverter() const throw()        { return false; }
     virtual bool canUseExternalBuffer() const throw()   { return true;  }
+    
+    /** Returns @c true if the output may be written over a full length input.
+     Channels that read each input sample before writing the output sample at
+     the same index can share an input's buffer (see BufferPlan). */
+    virtual bool canProcessInPlace() const throw()      { return false; }
     virtual double getLatency() const throw()           { return 0.0;   }
     virtual int getNumChannels() const throw()          { return 1; }
     
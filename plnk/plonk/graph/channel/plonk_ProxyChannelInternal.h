@@ -112,6 +112,8 @@ public:
     
     bool isProxy() const throw() { return true; }
     
+    PLONK_INLINE_LOW const ChannelType& getOwner() const throw() { return owner; }
+    
     InternalBase* getChannel (const int /*index*/) throw()
     {
         return this;
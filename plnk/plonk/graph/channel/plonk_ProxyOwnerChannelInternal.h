@@ -71,6 +71,7 @@ public:
     typedef NumericalArray<SampleType>              Buffer;    
     typedef ObjectArray<Buffer>                     BufferArray;
     typedef typename ProxyInternal::Data            ProxyData;
+    typedef ObjectArray<SampleType*>                SamplePointerArray;
 
     ProxyOwnerChannelInternal (const int numOutputs, 
                                Inputs const& inputs, 
@@ -84,6 +85,7 @@ public:
         
         proxyChannels.setSize (numOutputs, false);
         channelBuffers.setSize (numOutputs, false);
+        channelPointers.setSize (numOutputs, false);
         proxies.getInternal()->setSize (numOutputs, false);
         
         WeakChannelType* proxiesArray = proxies.getInternal()->getArray();
@@ -147,6 +149,59 @@ public:
         return proxies.getInternal()->length();
     }
     
+    /** Writes frame-major (interleaved) samples to the outputs of all channels.
+     This allows a unit to render or read all of its channels as one contiguous
+     block and scatter it to the channel outputs in a single pass. If the unit
+     has more channels than the frames the extra channels wrap around to copy
+     the first channels. 
+     @param frames              The samples, numFrames x frameNumChannels items.
+     @param frameNumChannels    The number of channels in each frame.
+     @param numFrames           The number of frames to write.
+     @param offset              The position in the output buffers to start writing. */
+    void writeFrames (const SampleType* const frames, 
+                      const int frameNumChannels, 
+                      const int numFrames, 
+                      const int offset) throw()
+    {
+        plonk_assert (frameNumChannels > 0);
+        
+        const int numChannels = this->getNumChannels();
+        const int numDirect = plonk::min (numChannels, frameNumChannels);
+        SampleType** const outputs = getChannelPointers (offset, numFrames);
+        int channel;
+        
+        if (numDirect == frameNumChannels)
+        {
+            Buffer::deinterleave (outputs, frames, frameNumChannels, numFrames);
+        }
+        else
+        {
+            for (channel = 0; channel < numDirect; ++channel)
+            {
+                SampleType* const outputSamples = outputs[channel];
+                const SampleType* frameSamples = frames + channel;
+                
+                for (int i = 0; i < numFrames; ++i, frameSamples += frameNumChannels)
+                    outputSamples[i] = *frameSamples;
+            }
+        }
+        
+        for (channel = numDirect; channel < numChannels; ++channel)
+            Buffer::copyData (outputs[channel], outputs[channel % frameNumChannels], numFrames);
+    }
+    
+    /** Reads the outputs of all channels as frame-major (interleaved) samples.
+     @param frames      The destination, this must hold numFrames x getNumChannels() items.
+     @param numFrames   The number of frames to read.
+     @param offset      The position in the output buffers to start reading. */
+    void readFrames (SampleType* const frames, 
+                     const int numFrames, 
+                     const int offset) throw()
+    {
+        SampleType** const outputs = getChannelPointers (offset, numFrames);
+        Buffer::interleave (frames, outputs, this->getNumChannels(), numFrames);
+    }
+    
     void initProxyValue (const int index, SampleType const& value)
     {
         plonk_assert (index >= 0);
@@ -213,6 +268,23 @@ public:
 private:
     WeakChannelArrayType proxies;
     BufferArray channelBuffers;
+    SamplePointerArray channelPointers;
+    
+    PLONK_INLINE_LOW SampleType** getChannelPointers (const int offset, const int numFrames) throw()
+    {
+        const int numChannels = channelBuffers.length();
+        SampleType** const pointers = channelPointers.getArray();
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            Buffer& buffer = channelBuffers.atUnchecked (channel);
+            plonk_assert ((offset + numFrames) <= buffer.length());
+            pointers[channel] = buffer.getArray() + offset;
+        }
+        
+        (void)numFrames;
+        return pointers;
+    }
 };
 
 
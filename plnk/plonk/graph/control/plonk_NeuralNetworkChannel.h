@@ -0,0 +1,357 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_NEURALNETWORKCHANNEL_H
+#define PLONK_NEURALNETWORKCHANNEL_H
+
+#include "../channel/plonk_ChannelInternalCore.h"
+#include "../plonk_GraphForwardDeclarations.h"
+
+template<class SampleType> class NeuralNetworkChannelInternal;
+template<class SampleType> class NeuralNetworkUnit;
+
+template<class SampleType>
+struct NeuralNetworkData
+{    
+    ChannelInternalCore::Data base;
+    
+    int numOutputs;
+    double controlRate;
+};      
+
+//------------------------------------------------------------------------------
+
+/** Neural network channel.
+ The input frames to evaluate in each block are gathered into a preallocated 
+ scratch arena so the network is evaluated once per block as a batch. The 
+ outputs ramp linearly from one evaluation to the next. */
+template<class SampleType>
+class NeuralNetworkChannelInternal
+:   public ProxyOwnerChannelInternal<SampleType, NeuralNetworkData<SampleType> >
+{
+public:
+    typedef NeuralNetworkData<SampleType>                           Data;
+    typedef ChannelBase<SampleType>                                 ChannelType;
+    typedef ObjectArray<ChannelType>                                ChannelArrayType;
+    typedef ProxyOwnerChannelInternal<SampleType,Data>              Internal;
+    typedef UnitBase<SampleType>                                    UnitType;
+    typedef InputDictionary                                         Inputs;
+    typedef NumericalArray<SampleType>                              Buffer;
+    typedef FloatNeuralNetworkDoubleBuffer                          NetworksType;
+    typedef NetworksType::NetworkType                               NetworkType;
+    typedef NumericalArray<float>                                   NetworkBuffer;
+    
+    enum Constants
+    {
+        MaximumInputs = 64
+    };
+    
+    NeuralNetworkChannelInternal (Inputs const& inputs, 
+                                  Data const& data, 
+                                  BlockSize const& blockSize,
+                                  SampleRate const& sampleRate,
+                                  ChannelArrayType& channels) throw()
+    :   Internal (data.numOutputs, inputs, data, blockSize, sampleRate, channels),
+        period (1),
+        samplesUntilUpdate (0),
+        maximumEvaluations (0)
+    {
+    }
+    
+    Text getName() const throw()
+    {
+        return "Neural Network";
+    }       
+    
+    IntArray getInputKeys() const throw()
+    {
+        const IntArray keys (IOKey::Generic, IOKey::NeuralNetwork);
+        return keys;
+    }    
+    
+    void initChannel (const int channel) throw()
+    {        
+        const UnitType& inputUnit = this->getInputAsUnit (IOKey::Generic);
+        
+        if ((channel % this->getNumChannels()) == 0)
+        {
+            this->setBlockSize (BlockSize::decide (inputUnit.getBlockSize (0),
+                                                   this->getBlockSize()));
+            this->setSampleRate (SampleRate::decide (inputUnit.getSampleRate (0),
+                                                     this->getSampleRate()));
+            
+            this->setOverlap (inputUnit.getOverlap (0));
+            
+            initArena();
+        }
+        
+        this->initProxyValue (channel, SampleType (0));
+    }    
+    
+    void process (ProcessInfo& info, const int /*channel*/) throw()
+    {
+        NetworksType& networks = this->getInputAsNeuralNetwork (IOKey::NeuralNetwork);
+        NetworkType& network = networks.getActive();
+        UnitType& inputUnit = this->getInputAsUnit (IOKey::Generic);
+        
+        const int numInputs = network.getNumInputs();
+        const int numOutputs = this->getNumChannels();
+        const int numInputChannels = inputUnit.getNumChannels();
+        const int outputBufferLength = this->getOutputBuffer (0).length();
+        const SampleType* inputSamples[MaximumInputs];
+        int inputBufferLength = outputBufferLength;
+        int i, j;
+        
+        plonk_assert (numInputs <= MaximumInputs);
+        plonk_assert (numOutputs == network.getNumOutputs());
+        
+        for (i = 0; i < numInputs; ++i)
+        {
+            if (i < numInputChannels)
+            {
+                const Buffer& inputBuffer (inputUnit.process (info, i));
+                inputSamples[i] = inputBuffer.getArray();
+                inputBufferLength = plonk::min (inputBufferLength, inputBuffer.length());
+            }
+            else
+            {
+                inputSamples[i] = inputSamples[i % numInputChannels];
+            }
+        }
+        
+        // gather the input frames at each evaluation point this block
+        float* const networkInputs = arena.getArray();
+        float* const networkOutputs = networkInputs + maximumEvaluations * numInputs;
+        int numEvaluations = 0;
+        
+        for (j = samplesUntilUpdate; (j < outputBufferLength) && (numEvaluations < maximumEvaluations); j += period)
+        {
+            const int inputIndex = (inputBufferLength == outputBufferLength) ? j : (j * inputBufferLength) / outputBufferLength;
+            float* const frame = networkInputs + numEvaluations * numInputs;
+            
+            for (i = 0; i < numInputs; ++i)
+                frame[i] = float (inputSamples[i][inputIndex]);
+            
+            ++numEvaluations;
+        }
+        
+        if (numEvaluations > 0)
+            network.propogateBatch (networkOutputs, networkInputs, numEvaluations);
+        
+        // ramp between the evaluations
+        SampleType* const currentValues = rampState.getArray();
+        SampleType* const slopes = currentValues + numOutputs;
+        SampleType* const targets = slopes + numOutputs;
+        const SampleType periodReciprocal = SampleType (1.0 / double (period));
+        int offset = 0;
+        int evaluation = 0;
+        
+        while (offset < outputBufferLength)
+        {
+            if (samplesUntilUpdate == 0)
+            {
+                const float* const outputs = networkOutputs + evaluation * numOutputs;
+                
+                for (i = 0; i < numOutputs; ++i)
+                {
+                    currentValues[i] = targets[i];
+                    targets[i] = SampleType (outputs[i]);
+                    slopes[i] = (targets[i] - currentValues[i]) * periodReciprocal;
+                }
+                
+                evaluation = plonk::min (evaluation + 1, numEvaluations - 1);
+                samplesUntilUpdate = period;
+            }
+            
+            const int numSamplesThisTime = plonk::min (outputBufferLength - offset, samplesUntilUpdate);
+            
+            for (i = 0; i < numOutputs; ++i)
+            {
+                SampleType* const outputSamples = this->getOutputSamples (i) + offset;
+                SampleType value = currentValues[i];
+                const SampleType slope = slopes[i];
+                
+                for (j = 0; j < numSamplesThisTime; ++j)
+                {
+                    outputSamples[j] = value;
+                    value += slope;
+                }
+                
+                currentValues[i] = value;
+            }
+            
+            offset += numSamplesThisTime;
+            samplesUntilUpdate -= numSamplesThisTime;
+        }
+    }
+    
+private:
+    NetworkBuffer arena;
+    Buffer rampState;
+    int period;
+    int samplesUntilUpdate;
+    int maximumEvaluations;
+    
+    void initArena() throw()
+    {
+        const Data& data = this->getState();
+        NetworksType& networks = this->getInputAsNeuralNetwork (IOKey::NeuralNetwork);
+        const int numInputs = networks.getNetwork (0).getNumInputs();
+        const int numOutputs = this->getNumChannels();
+        const int blockSize = plonk::max (this->getBlockSize().getValue(), 1);
+        
+        period = plonk::max (1, int (data.base.sampleRate / plonk::max (data.controlRate, 1.0e-9) + 0.5));
+        samplesUntilUpdate = 0;
+        maximumEvaluations = blockSize / period + 1;
+        
+        arena = NetworkBuffer::newClear (maximumEvaluations * (numInputs + numOutputs));
+        rampState = Buffer::newClear (numOutputs * 3); // current, slope and target
+        
+        networks.getNetwork (0).reserveBatch (maximumEvaluations);
+        networks.getNetwork (1).reserveBatch (maximumEvaluations);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Evaluates a neural network at a control rate.
+ 
+ Each channel of the input unit feeds one input of the network and each 
+ output of the network is one output channel. The network is evaluated 
+ every 1/controlRate seconds and the outputs ramp linearly between the 
+ evaluations. All of the evaluations needed for a block are made in a single 
+ batch from memory allocated when the unit is created. 
+ 
+ The network is held in a FloatNeuralNetworkDoubleBuffer so new weights 
+ (e.g., from training on another thread) can be swapped in while the unit is 
+ running by calling setWeights() on the double buffer. Passing a 
+ FloatNeuralNetwork directly makes a private double buffer for the unit. 
+ 
+ @par Factory functions:
+ - ar (input, network, controlRate=100, mul=1, add=0, preferredBlockSize=default, preferredSampleRate=default)
+ - kr (input, network, controlRate=100, mul=1, add=0)
+ 
+ @par Inputs:
+ - input: (unit, multi) the network inputs, one channel per input, these are sampled at the control rate
+ - network: (neuralnetwork) the double buffered network to evaluate
+ - controlRate: (double) the rate in Hz at which to evaluate the network
+ - mul: (unit, multi) the multiplier applied to the output
+ - add: (unit, multi) the offset added to the output
+ - preferredBlockSize: the preferred output block size (for advanced usage, leave on default if unsure)
+ - preferredSampleRate: the preferred output sample rate (for advanced usage, leave on default if unsure)
+
+ @ingroup ControlUnits */
+template<class SampleType>
+class NeuralNetworkUnit
+{
+public:    
+    typedef NeuralNetworkChannelInternal<SampleType>        NeuralNetworkInternal;
+    typedef typename NeuralNetworkInternal::Data            Data;
+    typedef UnitBase<SampleType>                            UnitType;
+    typedef InputDictionary                                 Inputs;
+    typedef FloatNeuralNetworkDoubleBuffer                  NetworksType;
+    
+    static PLONK_INLINE_LOW UnitInfos getInfo() throw()
+    {
+        const double blockSize = (double)BlockSize::getDefault().getValue();
+        const double sampleRate = SampleRate::getDefault().getValue();
+        
+        return UnitInfo ("NeuralNetwork", "Evaluates a neural network at a control rate.",
+                         
+                         // output
+                         ChannelCount::VariableChannelCount, 
+                         IOKey::Generic,            Measure::None,      0.0,                IOLimit::None,                         
+                         IOKey::End,
+                         
+                         // inputs
+                         IOKey::Generic,            Measure::None,      IOInfo::NoDefault,  IOLimit::None,
+                         IOKey::NeuralNetwork,      Measure::None,      IOInfo::NoDefault,  IOLimit::None,
+                         IOKey::Multiply,           Measure::Factor,    1.0,                IOLimit::None,
+                         IOKey::Add,                Measure::None,      0.0,                IOLimit::None,
+                         IOKey::BlockSize,          Measure::Samples,   blockSize,          IOLimit::Minimum,   Measure::Samples,   1.0,
+                         IOKey::SampleRate,         Measure::Hertz,     sampleRate,         IOLimit::Minimum,   Measure::Hertz,     0.0,
+                         IOKey::End);
+    }
+    
+    static UnitType ar (UnitType const& input,
+                        NetworksType const& network,
+                        const double controlRate = 100.0,
+                        UnitType const& mul = SampleType (1),
+                        UnitType const& add = SampleType (0),
+                        BlockSize const& preferredBlockSize = BlockSize::getDefault(),
+                        SampleRate const& preferredSampleRate = SampleRate::getDefault()) throw()
+    {             
+        plonk_assert (controlRate > 0.0);
+        plonk_assert (network.getNetwork (0).getNumInputs() <= NeuralNetworkInternal::MaximumInputs);
+        
+        Data data;
+        Memory::zero (data);
+        data.base.sampleRate = -1.0;
+        data.base.sampleDuration = -1.0;
+        data.numOutputs = network.getNetwork (0).getNumOutputs();
+        data.controlRate = controlRate;
+        
+        Inputs inputs;
+        inputs.put (IOKey::Generic, input);
+        inputs.put (IOKey::NeuralNetwork, network);
+        inputs.put (IOKey::Multiply, mul);
+        inputs.put (IOKey::Add, add);
+        
+        return UnitType::template proxiesFromInputs<NeuralNetworkInternal> (inputs, 
+                                                                            data, 
+                                                                            preferredBlockSize, 
+                                                                            preferredSampleRate);
+    }
+    
+    static PLONK_INLINE_LOW UnitType kr (UnitType const& input,
+                                         NetworksType const& network,
+                                         const double controlRate = 100.0,
+                                         UnitType const& mul = SampleType (1),
+                                         UnitType const& add = SampleType (0)) throw()
+    {
+        return ar (input, network, controlRate, mul, add,
+                   BlockSize::getControlRateBlockSize(), 
+                   SampleRate::getControlRate());
+    }
+};
+
+typedef NeuralNetworkUnit<PLONK_TYPE_DEFAULT> NeuralNetwork;
+
+
+
+#endif // PLONK_NEURALNETWORKCHANNEL_H
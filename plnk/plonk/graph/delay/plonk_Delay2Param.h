@@ -219,8 +219,7 @@ private:
                 int numSamplesThisTime = plonk::min (bufferSamplesRemaining, numSamplesToProcess);
                 numSamplesToProcess -= numSamplesThisTime;
                 
-                while (numSamplesThisTime--) 
-                    FormType::template tick<inputFunction, readFunction, writeFunction, outputFunction> (data, state);
+                FormType::template tickBlock<inputFunction, readFunction, writeFunction, outputFunction> (data, state, numSamplesThisTime);
                 
                 if (state.writePosition >= state.bufferLength)
                     state.writePosition = 0;
@@ -107,35 +107,57 @@ public:
             
             Data& data = this->getState();
             
-            const int bufferLength (data.maximumDuration * data.base.sampleRate + 0.5);
+            const int bufferLength = FormType::getBufferLength (int (data.maximumDuration * data.base.sampleRate + 0.5));
             
             for (i = 0; i < FormType::getNumCircularBuffers(); ++i)
-                circularBuffers.put (i, Buffer::newClear (bufferLength * 3));
+                circularBuffers.put (i, Buffer::newClear (FormType::getBufferAllocationLength (bufferLength)));
             
             for (i = 0; i < this->getNumChannels(); ++i)
-            {
                 this->initProxyValue (i, SampleType (0));            
 
-                DelayState& delayState = delayStates.atUnchecked (i);
-                Buffer& circularBuffer = circularBuffers.wrapAt (i);
-                
-                Memory::zero (delayState);
-                
-                DelayStateBase& delayStateBase (reinterpret_cast<DelayStateBase&>(delayState));
-                delayStateBase.bufferSamples = circularBuffer.getArray();
-                delayStateBase.bufferLength = bufferLength,
-                delayStateBase.bufferLengthIndex = DurationType (bufferLength),
-                delayStateBase.buffer0 = DurationType (0);
-            }
+            initDelayStates (bufferLength);
         }
     }    
     
+    /** Clears the delay lines as well as restoring the Data. */
+    void resetState() throw()
+    {
+        Internal::resetState();
+        
+        // nothing to clear if the channel was never initialised
+        if ((circularBuffers.length() == 0) || (circularBuffers.atUnchecked (0).length() == 0))
+            return;
+        
+        for (int i = 0; i < circularBuffers.length(); ++i)
+            circularBuffers.atUnchecked (i).zero();
+        
+        initDelayStates (reinterpret_cast<DelayStateBase&> (delayStates.atUnchecked (0)).bufferLength);
+    }
+    
     PLONK_INLINE_LOW BufferArray& getCircularBuffers() { return circularBuffers; }
     PLONK_INLINE_LOW DelayStateArray& getDelayStates() { return delayStates; }
     
 private:
     BufferArray circularBuffers;
     DelayStateArray delayStates;
+    
+    void initDelayStates (const int bufferLength) throw()
+    {
+        for (int i = 0; i < this->getNumChannels(); ++i)
+        {
+            DelayState& delayState = delayStates.atUnchecked (i);
+            Buffer& circularBuffer = circularBuffers.wrapAt (i);
+            
+            Memory::zero (delayState);
+            
+            DelayStateBase& delayStateBase (reinterpret_cast<DelayStateBase&>(delayState));
+            delayStateBase.bufferSamples = circularBuffer.getArray() + FormType::GuardLength;
+            delayStateBase.bufferLength = bufferLength;
+            delayStateBase.bufferLengthIndex = DurationType (bufferLength);
+            delayStateBase.buffer0 = DurationType (0);
+            delayStateBase.bufferMask = bufferLength - 1;
+        }
+    }
 };
 
 
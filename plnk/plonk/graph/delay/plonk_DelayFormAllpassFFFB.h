@@ -109,20 +109,15 @@ public:
     static PLONK_INLINE_LOW void readIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void readRead (Data&, DelayState& state) throw()
     {
-        const DurationType readPosition = DurationType (state.writePosition) - state.paramsOut[DurationInSamplesOut] + state.bufferLengthIndex;
-//        plonk_assert (readPosition >= 0 && readPosition <= state.bufferLengthIndex);
+        const DurationType readPosition = Base::getReadPosition (state, state.paramsOut[DurationInSamplesOut]);
         state.readValue = InterpType::lookup (state.bufferSamples, readPosition);
     }
     
     static PLONK_INLINE_LOW void writeIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void writeWrite (Data&, DelayState& state) throw()
     {
-        plonk_assert (state.writePosition >= 0 && state.writePosition < state.bufferLength);
         state.writeValue = state.inputValue + state.paramsOut[CoeffOut] * state.readValue;
-        state.bufferSamples[state.writePosition] = state.writeValue;
-        state.bufferSamples[state.writePosition + state.bufferLength] = state.writeValue; // for interpolation
-        state.bufferSamples[state.writePosition + state.bufferLength + state.bufferLength] = state.writeValue; // for interpolation
-
+        Base::writeSample (state, state.writeValue);
     }
     
     static PLONK_INLINE_LOW void outputIgnore (Data&, DelayState&) throw() { }
@@ -160,6 +155,52 @@ public:
         outputFunction (data, state);
     }
     
+    /** Processes a span of samples with constant parameters.
+     The span is split into segments no longer than the delay so that each 
+     segment only reads samples written before it. Each segment is read from
+     the circular buffer as one block, the feedback is mixed into the written
+     block in place and the guards are only updated at the segment edges. 
+     Delays too short to be worth splitting are processed with tick(). */
+    template<InputFunction inputFunction, 
+             ReadFunction readFunction,
+             WriteFunction writeFunction,
+             OutputFunction outputFunction>
+    static PLONK_INLINE_LOW void tickBlock (Data& data, DelayState& state, const int numSamples) throw()
+    {
+        const DurationType duration = state.paramsOut[DurationInSamplesOut];
+        const int maximumSpan = Base::getFeedbackSpanLength (duration);
+        
+        if ((inputFunction != inputRead) || (readFunction != readRead) || 
+            (writeFunction != writeWrite) || (outputFunction != outputWrite) ||
+            (maximumSpan < Base::MinimumSpan))
+        {
+            for (int i = 0; i < numSamples; ++i)
+                tick<inputFunction, readFunction, writeFunction, outputFunction> (data, state);
+            
+            return;
+        }
+        
+        const SampleType coeff = SampleType (state.paramsOut[CoeffOut]);
+        int numSamplesRemaining = numSamples;
+        
+        while (numSamplesRemaining > 0)
+        {
+            const int numSamplesThisTime = plonk::min (numSamplesRemaining, maximumSpan);
+            SampleType* const outputSamples = state.outputSamples;
+            SampleType* const writeSamples = Base::getWriteSpan (state, numSamplesThisTime);
+            
+            Base::template readSpan<InterpType> (state, outputSamples, Base::getReadPosition (state, duration), numSamplesThisTime);
+            Buffer::mulAdd (writeSamples, outputSamples, coeff, state.inputSamples, numSamplesThisTime);
+            Base::commitSpan (state, numSamplesThisTime);
+            Buffer::mulAdd (outputSamples, writeSamples, -coeff, outputSamples, numSamplesThisTime);
+            
+            state.inputSamples += numSamplesThisTime;
+            state.outputSamples += numSamplesThisTime;
+            state.writePosition += numSamplesThisTime;
+            numSamplesRemaining -= numSamplesThisTime;
+        }
+    }
+    
     static PLONK_INLINE_LOW UnitType ar (UnitType const& input,
                                DurationUnitType const& duration,
                                CoeffUnitType const& coeff,
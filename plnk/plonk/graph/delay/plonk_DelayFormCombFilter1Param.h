@@ -129,23 +129,18 @@ public:
     static PLONK_INLINE_LOW void readIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void readRead (Data&, DelayState& state) throw()
     {
-        DurationType readPosition = DurationType (state.writePosition) - state.paramsOut[DurationInSamplesOut] + state.bufferLengthIndex;
-//        plonk_assert (readPosition >= 0 && readPosition <= state.bufferLengthIndex);
+        const DurationType readPosition = Base::getReadPosition (state, state.paramsOut[DurationInSamplesOut]);
         state.readValue = InterpType::lookup (state.bufferSamples, readPosition);
     }
     
     static PLONK_INLINE_LOW void writeIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void writeWrite (Data&, DelayState& state) throw()
     {
-        plonk_assert (state.writePosition >= 0 && state.writePosition < state.bufferLength);
-                
         state.writeValue = state.inputValue + FilterShape::process (SampleType (state.paramsOut[FeedbackOut] * state.readValue),
                                                                     state.filterShapeData,
                                                                     state.filterFormData);
         
-        state.bufferSamples[state.writePosition] = state.writeValue;
-        state.bufferSamples[state.writePosition + state.bufferLength] = state.writeValue; // for interpolation
-        state.bufferSamples[state.writePosition + state.bufferLength + state.bufferLength] = state.writeValue; // for interpolation
+        Base::writeSample (state, state.writeValue);
     }
     
     static PLONK_INLINE_LOW void outputIgnore (Data&, DelayState&) throw() { }
@@ -107,19 +107,15 @@ public:
     static PLONK_INLINE_LOW void readIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void readRead (Data&, DelayState& state) throw()
     {
-        DurationType readPosition = DurationType (state.writePosition) - state.paramsOut[DurationInSamples] + state.bufferLengthIndex;
-//        plonk_assert (readPosition >= 0 && readPosition <= state.bufferLengthIndex);
+        const DurationType readPosition = Base::getReadPosition (state, state.paramsOut[DurationInSamples]);
         state.readValue = InterpType::lookup (state.bufferSamples, readPosition);
     }
         
     static PLONK_INLINE_LOW void writeIgnore (Data&, DelayState&) throw() { }
     static PLONK_INLINE_LOW void writeWrite (Data&, DelayState& state) throw()
     {
-        plonk_assert (state.writePosition >= 0 && state.writePosition < state.bufferLength);
         state.writeValue = state.inputValue;
-        state.bufferSamples[state.writePosition] = state.writeValue;
-        state.bufferSamples[state.writePosition + state.bufferLength] = state.writeValue; // for interpolation
-        state.bufferSamples[state.writePosition + state.bufferLength + state.bufferLength] = state.writeValue; // for interpolation
+        Base::writeSample (state, state.writeValue);
     }
     
     static PLONK_INLINE_LOW void outputIgnore (Data&, DelayState&) throw() { }
@@ -151,6 +147,54 @@ public:
         outputFunction (data, state);
     }
     
+    /** Processes a span of samples with a constant duration.
+     The input is written to the circular buffer as one block then the output
+     is read back as one block. This gives the same result as tick() as long 
+     as the delay is not so short that reads overlap the samples being written
+     nor so long that the block write overwrites samples still to be read, 
+     otherwise the span is processed with tick(). */
+    template<InputFunction inputFunction, 
+             ReadFunction readFunction,
+             WriteFunction writeFunction,
+             OutputFunction outputFunction>
+    static PLONK_INLINE_LOW void tickBlock (Data& data, DelayState& state, const int numSamples) throw()
+    {
+        const DurationType duration = state.paramsOut[DurationInSamples];
+        const bool writes = (inputFunction == inputRead) && (writeFunction == writeWrite);
+        const bool ignores = (inputFunction == inputIgnore) && (writeFunction == writeIgnore);
+        const int durationInSamples = int (duration);
+        const int maximumSpan = writes ? state.bufferLength - durationInSamples - Base::GuardLength : numSamples;
+        
+        if ((readFunction != readRead) || (outputFunction != outputWrite) || 
+            !(writes || ignores) ||
+            (durationInSamples < Base::MinimumSpan) || (maximumSpan < Base::MinimumSpan))
+        {
+            for (int i = 0; i < numSamples; ++i)
+                tick<inputFunction, readFunction, writeFunction, outputFunction> (data, state);
+            
+            return;
+        }
+        
+        int numSamplesRemaining = numSamples;
+        
+        while (numSamplesRemaining > 0)
+        {
+            const int numSamplesThisTime = plonk::min (numSamplesRemaining, maximumSpan);
+            
+            if (writes)
+            {
+                Base::writeSpan (state, state.inputSamples, numSamplesThisTime);
+                state.inputSamples += numSamplesThisTime;
+            }
+            
+            Base::template readSpan<InterpType> (state, state.outputSamples, Base::getReadPosition (state, duration), numSamplesThisTime);
+            
+            state.outputSamples += numSamplesThisTime;
+            state.writePosition += numSamplesThisTime;
+            numSamplesRemaining -= numSamplesThisTime;
+        }
+    }
+    
     static PLONK_INLINE_LOW UnitType ar (UnitType const& input,
                                DurationUnitType const& duration,
                                const DurationType maximumDuration,
@@ -61,6 +61,7 @@ struct DelayFormData
         int bufferLength;
         IndexType bufferLengthIndex;
         IndexType buffer0;
+        int bufferMask;
 
         int writePosition;
         
@@ -76,10 +77,27 @@ struct DelayFormData
 
 //------------------------------------------------------------------------------
 
+/** Circular buffer access shared by the delay forms.
+ Circular buffers are a power of two in length with GuardLength samples 
+ mirrored either side of the buffer so that interpolation near the ends never
+ needs to wrap. The per-sample functions keep the guards up to date on each
+ write, the span functions write or read whole contiguous segments and only
+ deal with the wrap at the segment edges. */
 template<class SampleType, signed Form, signed NumInParams, signed NumOutParams>
 class DelayFormBase
 {
 public:    
+    typedef DelayFormData<SampleType, Form, NumInParams, NumOutParams>     DataType;
+    typedef typename DataType::DelayState                                   DelayStateType;
+    typedef typename TypeUtility<SampleType>::IndexType                     IndexType;
+    typedef NumericalArray<SampleType>                                      BufferType;
+    
+    enum Constants
+    {
+        GuardLength = 4,    // enough for the widest interpolator (Lagrange3)
+        MinimumSpan = 4     // shorter spans are processed a sample at a time
+    };
+    
     static PLONK_INLINE_LOW Text getName() throw()
     {
         return DelayFormType::getName (Form);
@@ -89,6 +107,121 @@ public:
     {
         return 1;
     }
+    
+    /** The power of two circular buffer length for a maximum delay in samples. 
+     This leaves room for the interpolator to read either side of the 
+     longest delay without touching the sample being written. */
+    static PLONK_INLINE_LOW int getBufferLength (const int maximumDurationInSamples) throw()
+    {
+        return Bits::nextPowerOf2 (plonk::max (maximumDurationInSamples, 1) + int (GuardLength));
+    }
+    
+    /** The number of samples to allocate for a circular buffer including its guards. */
+    static PLONK_INLINE_LOW int getBufferAllocationLength (const int bufferLength) throw()
+    {
+        return bufferLength + GuardLength * 2;
+    }
+    
+    /** A read position for the current write position wrapped into the buffer. */
+    static PLONK_INLINE_LOW IndexType getReadPosition (DelayStateType const& state, IndexType const& durationInSamples) throw()
+    {
+        IndexType readPosition = IndexType (state.writePosition) - durationInSamples;
+        
+        if (readPosition < IndexType (0))
+            readPosition += state.bufferLengthIndex;
+        
+        return readPosition;
+    }
+    
+    /** Writes a single sample at the write position, updating the guards if needed. */
+    static PLONK_INLINE_LOW void writeSample (DelayStateType& state, SampleType const& value) throw()
+    {
+        const int writePosition = state.writePosition;
+        plonk_assert (writePosition >= 0 && writePosition < state.bufferLength);
+
+        state.bufferSamples[writePosition] = value;
+        
+        if (writePosition < GuardLength)
+            state.bufferSamples[writePosition + state.bufferLength] = value;
+        else if (writePosition >= (state.bufferLength - GuardLength))
+            state.bufferSamples[writePosition - state.bufferLength] = value;
+    }
+    
+    /** Copies the ends of the buffer into the guards. */
+    static PLONK_INLINE_LOW void refreshGuards (DelayStateType& state) throw()
+    {
+        SampleType* const bufferSamples = state.bufferSamples;
+        BufferType::copyData (bufferSamples + state.bufferLength, bufferSamples, GuardLength);
+        BufferType::copyData (bufferSamples - GuardLength, bufferSamples + state.bufferLength - GuardLength, GuardLength);
+    }
+    
+    /** Returns a pointer to the next numSamples at the write position. 
+     The span must not cross the end of the buffer, call commitSpan() once 
+     the span has been filled. */
+    static PLONK_INLINE_LOW SampleType* getWriteSpan (DelayStateType& state, const int numSamples) throw()
+    {
+        (void)numSamples;
+        plonk_assert ((state.writePosition + numSamples) <= state.bufferLength);
+        return state.bufferSamples + state.writePosition;
+    }
+    
+    static PLONK_INLINE_LOW void commitSpan (DelayStateType& state, const int numSamples) throw()
+    {
+        const int writePosition = state.writePosition;
+        
+        if ((writePosition < GuardLength) || ((writePosition + numSamples) > (state.bufferLength - GuardLength)))
+            refreshGuards (state);
+    }
+    
+    /** Copies numSamples into the buffer at the write position. */
+    static PLONK_INLINE_LOW void writeSpan (DelayStateType& state, const SampleType* const samples, const int numSamples) throw()
+    {
+        BufferType::copyData (getWriteSpan (state, numSamples), samples, numSamples);
+        commitSpan (state, numSamples);
+    }
+    
+    /** Reads numSamples consecutive delayed samples starting at readPosition.
+     The read is split where it crosses the end of the buffer, in between it 
+     is a straight copy for whole sample delays or a contiguous interpolation 
+     for fractional ones. */
+    template<class InterpType>
+    static PLONK_INLINE_LOW void readSpan (DelayStateType const& state, 
+                                           SampleType* dst, 
+                                           IndexType const& readPosition, 
+                                           int numSamples) throw()
+    {
+        const SampleType* const bufferSamples = state.bufferSamples;
+        int index = int (readPosition);
+        const IndexType frac = readPosition - IndexType (index);
+        index &= state.bufferMask;
+        
+        while (numSamples > 0)
+        {
+            const int numSamplesThisTime = plonk::min (state.bufferLength - index, numSamples);
+            const SampleType* const src = bufferSamples + index;
+            
+            if ((InterpType::getExtension() == 0) || (frac == IndexType (0)))
+            {
+                BufferType::copyData (dst, src, numSamplesThisTime);
+            }
+            else
+            {
+                for (int i = 0; i < numSamplesThisTime; ++i)
+                    dst[i] = InterpType::lookup (src + i, frac);
+            }
+            
+            dst += numSamplesThisTime;
+            numSamples -= numSamplesThisTime;
+            index = (index + numSamplesThisTime) & state.bufferMask;
+        }
+    }
+    
+    /** The longest span that can be processed as a block with feedback. 
+     Reads for the span must only touch samples written before it started. */
+    static PLONK_INLINE_LOW int getFeedbackSpanLength (IndexType const& durationInSamples) throw()
+    {
+        return int (durationInSamples) - GuardLength;
+    }
 };
 
 template<class SampleType, signed Form, signed NumInParams, signed NumOutParams>
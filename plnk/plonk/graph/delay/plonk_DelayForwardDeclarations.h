@@ -64,5 +64,9 @@ template<class SampleType, Interp::TypeCode InterpTypeCode = Interp::Linear> cla
 template<class SampleType, Interp::TypeCode InterpTypeCode = Interp::Linear> class AllpassFFFBUnit;
 template<class SampleType, Interp::TypeCode InterpTypeCode = Interp::Linear> class AllpassDecayUnit;
 
+template<class SampleType> struct FDNData;
+template<class SampleType> class FDNChannelInternal;
+template<class SampleType> class FDNUnit;
+
 
 #endif // PLONK_DELAYFORWARDDECLARATIONS_H
\ No newline at end of file
@@ -53,6 +53,7 @@ DelayFormType::Name DelayFormType::fromInt (const int value) throw()
         DelayFormType::CombFilter1Param,
         DelayFormType::AllpassDecay,
         DelayFormType::AllpassFFFB,
+        DelayFormType::FDN,
     };
     
     if (value < 0 || value >= DelayFormType::NumNames)
@@ -76,6 +77,7 @@ Text DelayFormType::getName (const int index) throw()
         "CombFilter1Param",
         "AllpassDecay",
         "AllpassFFFB",
+        "FDN",
     };
     
     if (index < 0 || index >= DelayFormType::NumNames)
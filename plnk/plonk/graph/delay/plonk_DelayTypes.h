@@ -52,6 +52,7 @@ public:
         CombFilter1Param,
         AllpassDecay,
         AllpassFFFB,
+        FDN,
         NumNames
     };
     
@@ -0,0 +1,550 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_FDN_H
+#define PLONK_FDN_H
+
+#include "../channel/plonk_ChannelInternalCore.h"
+#include "plonk_DelayForwardDeclarations.h"
+
+
+/** Feedback matrix types for the feedback delay network. */
+class FDNMatrix
+{
+public:
+    enum Type
+    {
+        Householder,    ///< Reflection matrix, mixes every line with the sum of all lines.
+        Hadamard,       ///< Walsh-Hadamard matrix, mixes the lines with a butterfly network.
+        NumTypes
+    };
+};
+
+template<class SampleType>
+struct FDNData
+{    
+    typedef typename TypeUtility<SampleType>::IndexType IndexType;
+    
+    enum Constants
+    {
+        MaximumLines = 16
+    };
+    
+    ChannelInternalCore::Data base;
+    
+    int numOutputs;
+    int numLines;
+    int matrix;
+    IndexType durations[MaximumLines];
+    IndexType modulationDepth;
+    IndexType modulationRate;
+};      
+
+//------------------------------------------------------------------------------
+
+/** Feedback delay network channel.
+ All of the delay lines live in one contiguous arena along with the scratch 
+ rows used to process them. Each block is split into segments no longer than 
+ the shortest delay so every line can be read, filtered, mixed through the 
+ feedback matrix and written back a whole segment at a time. The matrix is 
+ applied to the segment rows rather than sample by sample so the inner loops 
+ run over contiguous samples and can be vectorised. */
+template<class SampleType>
+class FDNChannelInternal
+:   public ProxyOwnerChannelInternal<SampleType, FDNData<SampleType> >
+{
+public:
+    typedef FDNData<SampleType>                                     Data;
+    typedef typename Data::IndexType                                IndexType;
+    typedef IndexType                                               DurationType;
+    
+    typedef DelayForm<SampleType, DelayFormType::FDN, 1, 1>         FormType;
+    typedef typename FormType::DelayStateType                       DelayState;
+    typedef InterpLinear<SampleType,IndexType>                      InterpType;
+    
+    typedef ChannelBase<SampleType>                                 ChannelType;
+    typedef ObjectArray<ChannelType>                                ChannelArrayType;
+    typedef ProxyOwnerChannelInternal<SampleType,Data>              Internal;
+    typedef UnitBase<SampleType>                                    UnitType;
+    typedef UnitBase<DurationType>                                  DurationUnitType;
+    typedef InputDictionary                                         Inputs;
+    typedef NumericalArray<SampleType>                              Buffer;
+    typedef NumericalArray<DurationType>                            DurationBuffer;
+    
+    struct Line
+    {
+        DelayState delay;
+        SampleType* samples;
+        IndexType duration;
+        IndexType phase;
+        SampleType gain;
+        SampleType lowpass;
+    };
+    
+    typedef ObjectArray<Line>                                       LineArray;
+    
+    FDNChannelInternal (Inputs const& inputs, 
+                        Data const& data, 
+                        BlockSize const& blockSize,
+                        SampleRate const& sampleRate,
+                        ChannelArrayType& channels) throw()
+    :   Internal (data.numOutputs, inputs, data, blockSize, sampleRate, channels),
+        lines (LineArray::withSize (data.numLines)),
+        scratchLength (0),
+        currentDecay (0),
+        currentDamping (0),
+        dampingCoeff (0)
+    {
+        plonk_assert (Bits::isPowerOf2 (data.numLines));
+        plonk_assert (data.numLines <= Data::MaximumLines);
+    }
+    
+    Text getName() const throw()
+    {
+        return "FDN";
+    }       
+    
+    IntArray getInputKeys() const throw()
+    {
+        const IntArray keys (IOKey::Generic, IOKey::Decay, IOKey::Frequency);
+        return keys;
+    }    
+    
+    void initChannel (const int channel) throw()
+    {        
+        const UnitType& inputUnit = this->getInputAsUnit (IOKey::Generic);
+        
+        if ((channel % this->getNumChannels()) == 0)
+        {
+            this->setBlockSize (BlockSize::decide (inputUnit.getBlockSize (0),
+                                                   this->getBlockSize()));
+            this->setSampleRate (SampleRate::decide (inputUnit.getSampleRate (0),
+                                                     this->getSampleRate()));
+            
+            this->setOverlap (inputUnit.getOverlap (0));
+            
+            initLines();
+        }
+        
+        this->initProxyValue (channel, SampleType (0));
+    }    
+    
+    /** Clears the delay lines as well as restoring the Data. */
+    void resetState() throw()
+    {
+        Internal::resetState();
+        
+        if (arena.length() == 0)
+            return;
+        
+        arena.zero();
+        scratch.zero();
+        resetLines();
+    }
+    
+    void process (ProcessInfo& info, const int /*channel*/) throw()
+    {
+        const Data& data = this->getState();
+        const int numLines = data.numLines;
+        const int numOutputs = this->getNumChannels();
+        
+        UnitType& inputUnit = this->getInputAsUnit (IOKey::Generic);
+        DurationUnitType& decayUnit = ChannelInternalCore::getInputAs<DurationUnitType> (IOKey::Decay);
+        DurationUnitType& dampingUnit = ChannelInternalCore::getInputAs<DurationUnitType> (IOKey::Frequency);
+        
+        const int numInputs = inputUnit.getNumChannels();
+        const SampleType* inputSamples[Data::MaximumLines];
+        int i, j;
+        
+        for (i = 0; i < numLines; ++i)
+        {
+            if (i < numInputs)
+                inputSamples[i] = inputUnit.process (info, i).getArray();
+            else
+                inputSamples[i] = inputSamples[i % numInputs];
+        }
+        
+        updateCoeffs (decayUnit.process (info, 0).atUnchecked (0),
+                      dampingUnit.process (info, 0).atUnchecked (0));
+        
+        const int outputBufferLength = this->getOutputBuffer (0).length();
+        const IndexType modulationIncrement = data.modulationRate * IndexType (data.base.sampleDuration) * Math<IndexType>::get2Pi();
+        const SampleType scale = getMatrixScale (data.matrix, numLines);
+        const SampleType outputSign[2] = { SampleType (1), SampleType (-1) };
+        SampleType* const sumSamples = scratch.getArray() + numLines * scratchLength;
+        
+        for (i = 0; i < numOutputs; ++i)
+            Buffer::zeroData (this->getOutputSamples (i), outputBufferLength);
+
+        int offset = 0;
+        
+        while (offset < outputBufferLength)
+        {
+            int numSamplesThisTime = plonk::min (outputBufferLength - offset, scratchLength);
+            IndexType durations[Data::MaximumLines];
+            
+            // find the longest segment that doesn't wrap any line or read its own writes
+            for (i = 0; i < numLines; ++i)
+            {
+                Line& line = lines.atUnchecked (i);
+                durations[i] = line.duration + data.modulationDepth * plonk::sin (line.phase);
+                numSamplesThisTime = plonk::min (numSamplesThisTime, 
+                                                 FormType::getFeedbackSpanLength (durations[i]),
+                                                 line.delay.bufferLength - line.delay.writePosition);
+            }
+            
+            plonk_assert (numSamplesThisTime > 0);
+            numSamplesThisTime = plonk::max (numSamplesThisTime, 1);
+            
+            // read and filter
+            for (i = 0; i < numLines; ++i)
+            {
+                Line& line = lines.atUnchecked (i);
+                SampleType* const samples = line.samples;
+                const SampleType gain = line.gain;
+                SampleType lowpass = line.lowpass;
+                
+                FormType::template readSpan<InterpType> (line.delay, samples, 
+                                                         FormType::getReadPosition (line.delay, durations[i]), 
+                                                         numSamplesThisTime);
+                
+                for (j = 0; j < numSamplesThisTime; ++j)
+                {
+                    lowpass = samples[j] + dampingCoeff * (lowpass - samples[j]);
+                    samples[j] = lowpass * gain;
+                }
+                
+                line.lowpass = lowpass;
+                line.phase += modulationIncrement * IndexType (numSamplesThisTime);
+                
+                if (line.phase >= Math<IndexType>::get2Pi())
+                    line.phase -= Math<IndexType>::get2Pi();
+                
+                // tap the output before mixing, alternating polarity across the lines
+                SampleType* const outputSamples = this->getOutputSamples (i % numOutputs) + offset;
+                Buffer::mulAdd (outputSamples, samples, outputSign[(i / numOutputs) & 1], outputSamples, numSamplesThisTime);
+            }
+            
+            // mix
+            if (data.matrix == FDNMatrix::Hadamard)
+                mixHadamard (numLines, numSamplesThisTime);
+            else
+                mixHouseholder (numLines, numSamplesThisTime, sumSamples);
+            
+            // write back with the input
+            for (i = 0; i < numLines; ++i)
+            {
+                Line& line = lines.atUnchecked (i);
+                
+                Buffer::mulAdd (FormType::getWriteSpan (line.delay, numSamplesThisTime), 
+                                line.samples, scale, 
+                                inputSamples[i] + offset, 
+                                numSamplesThisTime);
+                
+                FormType::commitSpan (line.delay, numSamplesThisTime);
+                line.delay.writePosition += numSamplesThisTime;
+                
+                if (line.delay.writePosition >= line.delay.bufferLength)
+                    line.delay.writePosition = 0;
+            }
+            
+            offset += numSamplesThisTime;
+        }
+    }
+    
+private:
+    LineArray lines;
+    Buffer arena;
+    Buffer scratch;
+    int scratchLength;
+    DurationType currentDecay;
+    DurationType currentDamping;
+    SampleType dampingCoeff;
+    
+    void initLines() throw()
+    {
+        const Data& data = this->getState();
+        const int numLines = data.numLines;
+        const double sampleRate = data.base.sampleRate;
+        const int modulationSamples = int (data.modulationDepth * sampleRate + 0.5);
+        int i, arenaLength = 0;
+        
+        for (i = 0; i < numLines; ++i)
+        {
+            const int maximumSamples = int (data.durations[i] * sampleRate + 0.5) + modulationSamples;
+            arenaLength += FormType::getBufferAllocationLength (FormType::getBufferLength (maximumSamples));
+        }
+        
+        scratchLength = plonk::max (this->getBlockSize().getValue(), 1);
+        arena = Buffer::newClear (arenaLength);
+        scratch = Buffer::newClear (scratchLength * (numLines + 1)); // +1 for the Householder sum
+        
+        resetLines();
+    }
+    
+    /** Points the lines at their buffers in the arena with no delay history. */
+    void resetLines() throw()
+    {
+        const Data& data = this->getState();
+        const int numLines = data.numLines;
+        const double sampleRate = data.base.sampleRate;
+        const int modulationSamples = int (data.modulationDepth * sampleRate + 0.5);
+        SampleType* arenaSamples = arena.getArray();
+        
+        for (int i = 0; i < numLines; ++i)
+        {
+            Line& line = lines.atUnchecked (i);
+            const int maximumSamples = int (data.durations[i] * sampleRate + 0.5) + modulationSamples;
+            const int bufferLength = FormType::getBufferLength (maximumSamples);
+            
+            Memory::zero (line);
+            line.delay.bufferSamples = arenaSamples + FormType::GuardLength;
+            line.delay.bufferLength = bufferLength;
+            line.delay.bufferLengthIndex = IndexType (bufferLength);
+            line.delay.bufferMask = bufferLength - 1;
+            line.samples = scratch.getArray() + i * scratchLength;
+            line.duration = IndexType (data.durations[i] * sampleRate);
+            line.phase = Math<IndexType>::get2Pi() * IndexType (i) / IndexType (numLines);
+            
+            plonk_assert (line.duration > (data.modulationDepth * sampleRate));
+            
+            arenaSamples += FormType::getBufferAllocationLength (bufferLength);
+        }
+        
+        currentDecay = currentDamping = DurationType (-1);
+    }
+    
+    void updateCoeffs (DurationType const& decay, DurationType const& damping) throw()
+    {
+        const Data& data = this->getState();
+        
+        if (decay != currentDecay)
+        {
+            currentDecay = decay;
+            
+            for (int i = 0; i < data.numLines; ++i)
+            {
+                Line& line = lines.atUnchecked (i);
+                line.gain = SampleType (plonk::decayFeedback (DurationType (data.durations[i]), decay));
+            }
+        }
+        
+        if (damping != currentDamping)
+        {
+            currentDamping = damping;
+            const double cutoff = plonk::clip (double (damping), 0.0, data.base.sampleRate * 0.5);
+            dampingCoeff = SampleType (plonk::exp (-cutoff * data.base.sampleDuration * Math<double>::get2Pi()));
+        }
+    }
+    
+    static PLONK_INLINE_LOW SampleType getMatrixScale (const int matrix, const int numLines) throw()
+    {
+        return matrix == FDNMatrix::Hadamard ? SampleType (1.0 / plonk::sqrt (double (numLines))) : SampleType (1);
+    }
+    
+    /** In-place fast Walsh-Hadamard transform across the line rows (unscaled). */
+    void mixHadamard (const int numLines, const int numSamples) throw()
+    {
+        for (int half = 1; half < numLines; half <<= 1)
+        {
+            for (int i = 0; i < numLines; i += half << 1)
+            {
+                for (int j = i; j < (i + half); ++j)
+                {
+                    SampleType* const a = lines.atUnchecked (j).samples;
+                    SampleType* const b = lines.atUnchecked (j + half).samples;
+                    
+                    for (int k = 0; k < numSamples; ++k)
+                    {
+                        const SampleType valueA = a[k];
+                        const SampleType valueB = b[k];
+                        a[k] = valueA + valueB;
+                        b[k] = valueA - valueB;
+                    }
+                }
+            }
+        }
+    }
+    
+    /** Householder reflection across the line rows: x - (2/N) sum(x). */
+    void mixHouseholder (const int numLines, const int numSamples, SampleType* const sumSamples) throw()
+    {
+        int i;
+        
+        Buffer::copyData (sumSamples, lines.atUnchecked (0).samples, numSamples);
+        
+        for (i = 1; i < numLines; ++i)
+        {
+            const SampleType* const samples = lines.atUnchecked (i).samples;
+            
+            for (int k = 0; k < numSamples; ++k)
+                sumSamples[k] += samples[k];
+        }
+        
+        const SampleType factor = SampleType (-2.0 / double (numLines));
+        
+        for (i = 0; i < numLines; ++i)
+        {
+            SampleType* const samples = lines.atUnchecked (i).samples;
+            Buffer::mulAdd (samples, sumSamples, factor, samples, numSamples);
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Feedback delay network reverb.
+ 
+ A single unit that replaces a network of separate comb and allpass units. 
+ The input is fed into a set of delay lines whose outputs are damped by 
+ one-pole low-pass filters and fed back through a lossless mixing matrix. 
+ The delay times are slowly modulated to reduce metallic ringing, the 
+ modulation is updated once per processing segment. 
+ 
+ @par Factory functions:
+ - ar (input, decay=2, damping=8000, durations=default, matrix=FDNMatrix::Hadamard, modulationDepth=0.0005, modulationRate=0.5, numOutputs=2, mul=1, add=0, preferredBlockSize=default, preferredSampleRate=default)
+ 
+ @par Inputs:
+ - input: (unit, multi) the unit to reverberate, channels are fed to the lines in turn
+ - decay: (unit) the -60dB decay time in seconds
+ - damping: (unit) the cutoff frequency of the damping filters in Hz
+ - durations: (doubles) the delay line durations in seconds, there must be 2, 4, 8 or 16 
+ - matrix: (int) the feedback matrix type, FDNMatrix::Householder or FDNMatrix::Hadamard
+ - modulationDepth: (real) the depth of the delay modulation in seconds, this must be less than the shortest duration
+ - modulationRate: (real) the rate of the delay modulation in Hz
+ - numOutputs: (int) the number of output channels, the lines are tapped across these in turn
+ - mul: (unit, multi) the multiplier applied to the output
+ - add: (unit, multi) the offset added to the output
+ - preferredBlockSize: the preferred output block size (for advanced usage, leave on default if unsure)
+ - preferredSampleRate: the preferred output sample rate (for advanced usage, leave on default if unsure)
+
+ @ingroup DelayUnits */
+template<class SampleType>
+class FDNUnit
+{
+public:    
+    typedef FDNChannelInternal<SampleType>                  FDNInternal;
+    typedef typename FDNInternal::Data                      Data;
+    typedef UnitBase<SampleType>                            UnitType;
+    typedef InputDictionary                                 Inputs;
+    
+    typedef typename FDNInternal::DurationType              DurationType;
+    typedef UnitBase<DurationType>                          DurationUnitType;
+    
+    static PLONK_INLINE_LOW UnitInfos getInfo() throw()
+    {
+        const double blockSize = (double)BlockSize::getDefault().getValue();
+        const double sampleRate = SampleRate::getDefault().getValue();
+        
+        return UnitInfo ("FDN", "A feedback delay network reverb.",
+                         
+                         // output
+                         ChannelCount::VariableChannelCount, 
+                         IOKey::Generic,            Measure::None,      0.0,                IOLimit::None,                         
+                         IOKey::End,
+                         
+                         // inputs
+                         IOKey::Generic,            Measure::None,      IOInfo::NoDefault,  IOLimit::None,
+                         IOKey::Decay,              Measure::Seconds,   2.0,                IOLimit::Minimum,   Measure::Seconds,   0.0,
+                         IOKey::Frequency,          Measure::Hertz,     8000.0,             IOLimit::Minimum,   Measure::Hertz,     0.0,
+                         IOKey::Multiply,           Measure::Factor,    1.0,                IOLimit::None,
+                         IOKey::Add,                Measure::None,      0.0,                IOLimit::None,
+                         IOKey::BlockSize,          Measure::Samples,   blockSize,          IOLimit::Minimum,   Measure::Samples,   1.0,
+                         IOKey::SampleRate,         Measure::Hertz,     sampleRate,         IOLimit::Minimum,   Measure::Hertz,     0.0,
+                         IOKey::End);
+    }
+    
+    /** Eight mutually prime (at 44.1kHz) line durations in seconds. */
+    static const DoubleArray& getDefaultDurations() throw()
+    {
+        static const DoubleArray durations (0.02973, 0.03711, 0.04113, 0.04373, 
+                                            0.05331, 0.06171, 0.06871, 0.07473);
+        return durations;
+    }
+    
+    static UnitType ar (UnitType const& input,
+                        DurationUnitType const& decay = DurationType (2.0),
+                        DurationUnitType const& damping = DurationType (8000.0),
+                        DoubleArray const& durations = getDefaultDurations(),
+                        const int matrix = FDNMatrix::Hadamard,
+                        const DurationType modulationDepth = DurationType (0.0005),
+                        const DurationType modulationRate = DurationType (0.5),
+                        const int numOutputs = 2,
+                        UnitType const& mul = SampleType (1),
+                        UnitType const& add = SampleType (0),
+                        BlockSize const& preferredBlockSize = BlockSize::getDefault(),
+                        SampleRate const& preferredSampleRate = SampleRate::getDefault()) throw()
+    {             
+        const int numLines = durations.length();
+        
+        plonk_assert (numLines >= 2 && numLines <= Data::MaximumLines);
+        plonk_assert (Bits::isPowerOf2 (numLines));
+        plonk_assert (numOutputs >= 1);
+        
+        Data data;
+        Memory::zero (data);
+        data.base.sampleRate = -1.0;
+        data.base.sampleDuration = -1.0;
+        data.numOutputs = numOutputs;
+        data.numLines = numLines;
+        data.matrix = matrix;
+        data.modulationDepth = modulationDepth;
+        data.modulationRate = modulationRate;
+        
+        for (int i = 0; i < numLines; ++i)
+            data.durations[i] = DurationType (durations.atUnchecked (i));
+        
+        Inputs inputs;
+        inputs.put (IOKey::Generic, input);
+        inputs.put (IOKey::Decay, decay);
+        inputs.put (IOKey::Frequency, damping);
+        inputs.put (IOKey::Multiply, mul);
+        inputs.put (IOKey::Add, add);
+        
+        return UnitType::template proxiesFromInputs<FDNInternal> (inputs, 
+                                                                  data, 
+                                                                  preferredBlockSize, 
+                                                                  preferredSampleRate);
+    }
+};
+
+typedef FDNUnit<PLONK_TYPE_DEFAULT> FDN;
+
+
+
+#endif // PLONK_FDN_H
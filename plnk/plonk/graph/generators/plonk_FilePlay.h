@@ -181,7 +181,7 @@ public:
                 {
                     if (cue.getFramePosition (file.getSampleRate()) == filePosition)
                     {
-                        this->update (Text::getMessageCuePoint(), Text (cue.getLabel()));
+                        this->update (Text::getMessageCuePoint(), Dynamic::fromSmallText (cue.getLabel()));
                         
                         ++data.cueIndex;
                         cue = cuePoints[data.cueIndex];
@@ -232,19 +232,9 @@ public:
             else if (willHitEOF || hitEOF)
             {
                 const int bufferFramesAvailable = bufferAvailable / fileNumChannels;
+                const int outputLengthToWrite = plonk::min (bufferFramesAvailable, blockSize - offset);
                 
-                for (channel = 0; channel < numChannels; ++channel)
-                {
-                    Buffer& outputBuffer = this->getOutputBuffer (channel);
-                    SampleType* const outputSamples = outputBuffer.getArray() + offset;
-                    const int outputBufferLength = outputBuffer.length() - offset;
-                    const int outputLengthToWrite = plonk::min (bufferFramesAvailable, outputBufferLength);
-                    
-                    const SampleType* bufferSamples = buffer.getArray() + ((unsigned int)channel % (unsigned int)fileNumChannels);
-                    
-                    for (int i = 0; i < outputLengthToWrite; ++i, bufferSamples += fileNumChannels)
-                        outputSamples[i] = *bufferSamples;
-                }
+                this->writeFrames (buffer.getArray(), fileNumChannels, outputLengthToWrite, offset);
                 
                 if ((loopCount.getValue() == 0) || (loopCount.getValue() > 1))
                 {
@@ -266,19 +256,9 @@ public:
             else 
             {                
                 const int bufferFramesAvailable = bufferAvailable / fileNumChannels;
+                const int outputLengthToWrite = plonk::min (bufferFramesAvailable, blockSize - offset);
                 
-                for (channel = 0; channel < numChannels; ++channel)
-                {
-                    Buffer& outputBuffer = this->getOutputBuffer (channel);
-                    SampleType* const outputSamples = outputBuffer.getArray() + offset;
-                    const int outputBufferLength = outputBuffer.length() - offset;
-                    const int outputLengthToWrite = plonk::min (bufferFramesAvailable, outputBufferLength);
-                    
-                    const SampleType* bufferSamples = buffer.getArray() + ((unsigned int)channel % (unsigned int)fileNumChannels);
-                    
-                    for (int i = 0; i < outputLengthToWrite; ++i, bufferSamples += fileNumChannels)
-                        outputSamples[i] = *bufferSamples;
-                }
+                this->writeFrames (buffer.getArray(), fileNumChannels, outputLengthToWrite, offset);
                                 
                 offset += bufferFramesAvailable;
                 blockRemain -= bufferFramesAvailable;
@@ -288,7 +268,7 @@ public:
                 this->update (Text::getMessageAudioFileChanged(), file);
                 
             if (changedNumChannels)
-                this->update (Text::getMessageNumChannelsChanged(), IntVariable (fileNumChannels));
+                this->update (Text::getMessageNumChannelsChanged(), Dynamic (fileNumChannels));
         }
         
         if (data.done && data.deleteWhenDone)
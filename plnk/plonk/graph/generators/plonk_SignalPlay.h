@@ -169,80 +169,22 @@ public:
             RateUnitType& rateUnit = ChannelInternalCore::getInputAs<RateUnitType> (IOKey::Rate);
             const RateBufferType& rateBuffer (rateUnit.process (info, channel));
             
-            const RateType* rateSamples = rateBuffer.getArray();
-            const int rateBufferLength = rateBuffer.length();
-            
             UnitType& loop (this->getInputAsUnit (IOKey::Loop));
             const Buffer& loopBuffer (loop.process (info, channel));
             const SampleType* const loopSamples = loopBuffer.getArray();
             const bool loopFlag = loopSamples[0] >= SampleType (0.5);
             
             const SignalType& signal (this->getInputAsSignal (IOKey::Signal));
-            const SampleType* const signalSamples = signal.getSamples (channel);         
-            const unsigned int signalFrameStride = signal.getFrameStride();
-            const unsigned int numSignalFrames (signal.getNumFrames());
-            const RateType rateScale (signal.getSampleRate().getValue() * data.base.sampleDuration);
-            
             
-            if (rateBufferLength == outputBufferLength)
+            if (signal.isCompact())
             {
-                while (numSamplesRemaining--)
-                {
-                    const unsigned int sampleA (data.currentPosition);
-                    const unsigned int sampleB (sampleA + 1);
-                    const RateType frac (plonk::frac (data.currentPosition));
-                    
-                    *outputSamples++ = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride],
-                                                           signalSamples[(sampleB % numSignalFrames) * signalFrameStride], 
-                                                           frac);
-                    
-                    data.currentPosition += *rateSamples++ * rateScale;
-                    
-                    if (checkPosition (info, data, numSignalFrames, loopFlag))
-                        break;
-                }
-            }
-            else if (rateBufferLength == 1)
-            {
-                const RateType increment = rateSamples[0] * rateScale;
-                
-                while (numSamplesRemaining--)
-                {
-                    const unsigned int sampleA (data.currentPosition);
-                    const unsigned int sampleB (sampleA + 1);
-                    const RateType frac (plonk::frac (data.currentPosition));
-                    
-                    *outputSamples++ = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride],
-                                                           signalSamples[(sampleB % numSignalFrames) * signalFrameStride], 
-                                                           frac);
-                    data.currentPosition += increment;
-                    
-                    if (checkPosition (info, data, numSignalFrames, loopFlag))
-                        break;
-                }
+                decodeWindow.bind (signal, channel);
+                processFrames (info, data, decodeWindow, signal, rateBuffer, loopFlag, outputSamples, numSamplesRemaining);
             }
             else
             {
-                double ratePosition = 0.0;
-                const double rateIncrement = double (rateBufferLength) / double (outputBufferLength);
-                
-                while (numSamplesRemaining--)
-                {
-                    const unsigned int sampleA (data.currentPosition);
-                    const unsigned int sampleB (sampleA + 1);
-                    const RateType frac (plonk::frac (data.currentPosition));
-                    
-                    *outputSamples++ = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride],
-                                                           signalSamples[(sampleB % numSignalFrames) * signalFrameStride], 
-                                                           frac);
-                    
-                    data.currentPosition += rateSamples[int (ratePosition)] * rateScale;
-                    
-                    if (checkPosition (info, data, numSignalFrames, loopFlag))
-                        break;
-                    
-                    ratePosition += rateIncrement;
-                }                    
+                SignalDirectReader<SampleType> reader (signal, channel);
+                processFrames (info, data, reader, signal, rateBuffer, loopFlag, outputSamples, numSamplesRemaining);
             }
         }
         
@@ -257,6 +199,87 @@ public:
     }
     
 private:
+    SignalDecodeWindow<SampleType> decodeWindow;
+    
+    template<class ReaderType>
+    PLONK_INLINE_LOW void processFrames (ProcessInfo& info, 
+                                         Data& data,
+                                         ReaderType& reader, 
+                                         SignalType const& signal,
+                                         RateBufferType const& rateBuffer,
+                                         const bool loopFlag,
+                                         SampleType*& outputSamples,
+                                         int& numSamplesRemaining) throw()
+    {
+        const RateType* rateSamples = rateBuffer.getArray();
+        const int rateBufferLength = rateBuffer.length();
+        const int outputBufferLength = numSamplesRemaining;
+        
+        const unsigned int numSignalFrames (signal.getNumFrames());
+        const RateType rateScale (signal.getSampleRate().getValue() * data.base.sampleDuration);
+        
+        
+        if (rateBufferLength == outputBufferLength)
+        {
+            while (numSamplesRemaining--)
+            {
+                const unsigned int sampleA (data.currentPosition);
+                const unsigned int sampleB (sampleA + 1);
+                const RateType frac (plonk::frac (data.currentPosition));
+                
+                *outputSamples++ = InterpType::interp (reader.read (sampleA % numSignalFrames),
+                                                       reader.read (sampleB % numSignalFrames), 
+                                                       frac);
+                
+                data.currentPosition += *rateSamples++ * rateScale;
+                
+                if (checkPosition (info, data, numSignalFrames, loopFlag))
+                    break;
+            }
+        }
+        else if (rateBufferLength == 1)
+        {
+            const RateType increment = rateSamples[0] * rateScale;
+            
+            while (numSamplesRemaining--)
+            {
+                const unsigned int sampleA (data.currentPosition);
+                const unsigned int sampleB (sampleA + 1);
+                const RateType frac (plonk::frac (data.currentPosition));
+                
+                *outputSamples++ = InterpType::interp (reader.read (sampleA % numSignalFrames),
+                                                       reader.read (sampleB % numSignalFrames), 
+                                                       frac);
+                data.currentPosition += increment;
+                
+                if (checkPosition (info, data, numSignalFrames, loopFlag))
+                    break;
+            }
+        }
+        else
+        {
+            double ratePosition = 0.0;
+            const double rateIncrement = double (rateBufferLength) / double (outputBufferLength);
+            
+            while (numSamplesRemaining--)
+            {
+                const unsigned int sampleA (data.currentPosition);
+                const unsigned int sampleB (sampleA + 1);
+                const RateType frac (plonk::frac (data.currentPosition));
+                
+                *outputSamples++ = InterpType::interp (reader.read (sampleA % numSignalFrames),
+                                                       reader.read (sampleB % numSignalFrames), 
+                                                       frac);
+                
+                data.currentPosition += rateSamples[int (ratePosition)] * rateScale;
+                
+                if (checkPosition (info, data, numSignalFrames, loopFlag))
+                    break;
+                
+                ratePosition += rateIncrement;
+            }                    
+        }
+    }
 };
 
 //------------------------------------------------------------------------------
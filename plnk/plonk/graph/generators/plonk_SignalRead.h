@@ -123,15 +123,32 @@ public:
         PositionUnitType& positionUnit = ChannelInternalCore::getInputAs<PositionUnitType> (IOKey::Time);
         const PositionBufferType& positionBuffer (positionUnit.process (info, channel));
         
+        const SignalType& signal (this->getInputAsSignal (IOKey::Signal));
+        
+        if (signal.isCompact())
+        {
+            decodeWindow.bind (signal, channel);
+            processFrames (decodeWindow, signal, positionBuffer);
+        }
+        else
+        {
+            SignalDirectReader<SampleType> reader (signal, channel);
+            processFrames (reader, signal, positionBuffer);
+        }
+    }
+    
+private:
+    SignalDecodeWindow<SampleType> decodeWindow;
+    
+    template<class ReaderType>
+    PLONK_INLINE_LOW void processFrames (ReaderType& reader, SignalType const& signal, PositionBufferType const& positionBuffer) throw()
+    {
         SampleType* const outputSamples = this->getOutputSamples();
         const int outputBufferLength = this->getOutputBuffer().length();
         
         const PositionType* const positionSamples = positionBuffer.getArray();
         const int positionBufferLength = positionBuffer.length();
         
-        const SignalType& signal (this->getInputAsSignal (IOKey::Signal));
-        const SampleType* const signalSamples = signal.getSamples (channel);         
-        const unsigned int signalFrameStride = signal.getFrameStride();
         const unsigned int numSignalFrames (signal.getNumFrames());
         
         const PositionType positionScale (signal.getSampleRate().getValue());
@@ -148,8 +165,8 @@ public:
                 const unsigned int sampleB (sampleA + 1);
                 const PositionType frac (plonk::frac (currentPosition));
                 
-                outputSamples[i] = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride], 
-                                                       signalSamples[(sampleB % numSignalFrames) * signalFrameStride], 
+                outputSamples[i] = InterpType::interp (reader.read (sampleA % numSignalFrames), 
+                                                       reader.read (sampleB % numSignalFrames), 
                                                        frac);                
             }
         }
@@ -159,8 +176,8 @@ public:
             const unsigned int sampleA (plonk::max (PositionType (0), currentPosition));
             const unsigned int sampleB (sampleA + 1);
             const PositionType frac (plonk::frac (currentPosition));
-            const SampleType value = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride],
-                                                         signalSamples[(sampleB % numSignalFrames) * signalFrameStride],
+            const SampleType value = InterpType::interp (reader.read (sampleA % numSignalFrames),
+                                                         reader.read (sampleB % numSignalFrames),
                                                          frac);
             
             NumericalArrayFiller<SampleType>::fill (outputSamples, value, outputBufferLength);
@@ -178,17 +195,14 @@ public:
                 const unsigned int sampleB (sampleA + 1);
                 const PositionType frac (plonk::frac (currentPosition));
                 
-                outputSamples[i] = InterpType::interp (signalSamples[(sampleA % numSignalFrames) * signalFrameStride], 
-                                                       signalSamples[(sampleB % numSignalFrames) * signalFrameStride], 
+                outputSamples[i] = InterpType::interp (reader.read (sampleA % numSignalFrames), 
+                                                       reader.read (sampleB % numSignalFrames), 
                                                        frac);
                 
                 positionPosition += positionIncrement;
             }                    
         }
-        
     }
-    
-private:
 };
 
 //------------------------------------------------------------------------------
@@ -71,6 +71,7 @@ public:
         TypeAudioFileReader,
         TypeUnitQueue,
         TypeBufferQueue,
+        TypeNeuralNetwork,
         TypeBlockSize,
         TypeSampleRate,
 //        TypeBlockSizes,
@@ -146,6 +147,7 @@ public:
         AudioFileReader,        ///< An AudioFileReader
         UnitQueue,              ///< A unit queue
         BufferQueue,            ///< A buffer queue
+        NeuralNetwork,          ///< A neural network double buffer
 
         AutoDeleteFlag,         ///< To control the auto deletion
         PurgeExpiredUnitsFlag,
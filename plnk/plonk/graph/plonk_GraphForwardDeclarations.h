@@ -73,6 +73,12 @@ template<class SampleType>                                              class Un
 template<class SampleType, class DataType>                              class ProxyOwnerChannelInternal;
 template<class SampleType>                                              class ProxyChannelInternal;
 template<class OwnerType>                                               struct ChannelData;
+template<class SampleType>                                              class VoiceBase;
+template<class SampleType>                                              class VoicePoolBase;
+template<class SampleType>                                              class BufferPlanBase;
+template<class SampleType>                                              class ExecutionPlanBase;
+template<class SampleType>                                              class HostedGraphBase;
+template<class SampleType>                                              class MultiGraphHostBase;
         
 // common channels
 template<class SampleType>                                              class ConstantChannelInternal;
@@ -100,7 +100,6 @@ protected:
 public:
     typedef ObjectArrayInternal<ChannelType>    Internal;    
     typedef UnitType                            Base;    
-    typedef WeakPointerContainer<UnitBase>      Weak;
     typedef NumericalArray<SampleType>          Buffer;
     typedef InputDictionary                     Inputs;    
     
@@ -151,13 +150,6 @@ public:
     {
     }          
 
-    /** Get a weakly linked copy of this object. 
-     This will return a blank/empty/null object of this type if
-     the original has already been deleted. */
-    static UnitBase fromWeak (Weak const& weak) throw()
-    {
-        return weak.fromWeak();
-    }       
     
     static const UnitBase& getNull() throw()
 	{
@@ -142,6 +142,13 @@ public:
         return "Binary Operator (" + variant + ")";
     }    
     
+    bool canProcessInPlace() const throw() { return true; }
+    
+    typename InternalBase::ProcessFunction getProcessFunction() const throw()
+    {
+        return &InternalBase::template processDirect<BinaryOpInternal>;
+    }
+    
     IntArray getInputKeys() const throw()
     {
         const IntArray keys (IOKey::LeftOperand,
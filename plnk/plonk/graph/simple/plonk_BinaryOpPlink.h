@@ -86,6 +86,12 @@
         return "Binary Operator (" + variant + ")";\
     }\
     \
+    bool canProcessInPlace() const throw() { return true; }\
+    \
+    ProcessFunction getProcessFunction() const throw() {\
+        return &InternalBase::processDirect<BinaryOpInternal>;\
+    }\
+    \
     IntArray getInputKeys() const throw() {\
         const IntArray keys (IOKey::LeftOperand, IOKey::RightOperand);\
         return keys;\
@@ -43,7 +43,10 @@
 #include "../plonk_GraphForwardDeclarations.h"
 
 /** Bus read channel. 
- Reads data from a bus. */
+ Reads data from a bus. If the bus has samples lent with setDirect() for the
+ time being read (e.g., an audio host's input buffer) they are copied 
+ straight from there rather than through the bus's lanes. The output never
+ refers to the lent samples as they are only valid while they are lent. */
 template<class SampleType>
 class BusReadChannelInternal 
 :   public ChannelInternal<SampleType, ChannelInternalCore::Data>
@@ -119,7 +122,6 @@ public:
     
     void process (ProcessInfo& info, const int channel) throw()
     {                
-        SampleType* const outputSamples = this->getOutputSamples();
         const int outputBufferLength = this->getOutputBuffer().length();
         
         Busses& busses (this->getInputAsBusses (IOKey::Busses));
@@ -127,9 +129,18 @@ public:
         
         plonk_assert (bus.getSampleRate() == this->getSampleRate());
         
-        bus.read (nextValidReadTime, 
-                  outputBufferLength, 
-                  outputSamples);
+        const SampleType* const directSamples = bus.getDirect (nextValidReadTime, outputBufferLength);
+        
+        if (directSamples != 0)
+        {
+            Buffer::copyData (this->getOutputSamples(), directSamples, outputBufferLength);
+        }
+        else
+        {
+            bus.read (nextValidReadTime, 
+                      outputBufferLength, 
+                      this->getOutputSamples());
+        }
         
         latency = (info.getTimeStamp() - nextValidReadTime).getValue();
     }
@@ -65,10 +65,16 @@ public:
                              Data const& data, 
                              BlockSize const& blockSize,
                              SampleRate const& sampleRate) throw()
-    :   Internal (inputs, data, blockSize, sampleRate)
+    :   Internal (inputs, data, blockSize, sampleRate),
+        lane (0)
     {
     }
     
+    ~BusWriteChannelInternal()
+    {
+        laneBus.releaseLane (lane);
+    }
+    
     Text getName() const throw()
     {
         const Busses& busses (this->getInputAsBusses (IOKey::Busses));
@@ -116,6 +122,11 @@ public:
         
         plonk_assert (input.getOverlap (channel) == Math<DoubleVariable>::get1());
         
+        // each writer has its own lane so writers on different threads don't contend
+        laneBus.releaseLane (lane);
+        laneBus = busses.wrapAt (channel);
+        lane = laneBus.acquireLane();
+        
         this->initValue (SampleType (0));
     }    
     
@@ -153,10 +164,12 @@ public:
             }        
         }
         
-        bus.write (info.getTimeStamp(), outputBufferLength, outputSamples);
+        bus.write (info.getTimeStamp(), outputBufferLength, outputSamples, (bus == laneBus) ? lane : 0);
     }
 
 private:
+    Bus laneBus;
+    int lane;
 };
 
 //------------------------------------------------------------------------------
@@ -72,6 +72,11 @@ public:
         return "MulAdd";
     }    
     
+    typename InternalBase::ProcessFunction getProcessFunction() const throw()
+    {
+        return &InternalBase::template processDirect<MulAddInternal>;
+    }
+    
     IntArray getInputKeys() const throw()
     {
         const IntArray keys (IOKey::Generic,
@@ -256,6 +261,11 @@ public:
         return "MulAdd";
     }    
     
+    InternalBase::ProcessFunction getProcessFunction() const throw()
+    {
+        return &InternalBase::processDirect<MulAddInternal>;
+    }
+    
     IntArray getInputKeys() const throw()
     {
         const IntArray keys (IOKey::Generic,
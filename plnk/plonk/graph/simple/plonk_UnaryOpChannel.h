@@ -150,6 +150,13 @@ public:
         return "Unary Operator (" + variant + ")";
     }    
     
+    bool canProcessInPlace() const throw() { return true; }
+    
+    typename InternalBase::ProcessFunction getProcessFunction() const throw()
+    {
+        return &InternalBase::template processDirect<UnaryOpInternal>;
+    }
+    
     IntArray getInputKeys() const throw()
     {
         const IntArray keys (IOKey::Generic);
@@ -87,6 +87,12 @@
         return "Unary Operator (" + variant + ")";\
     }\
     \
+    bool canProcessInPlace() const throw() { return true; }\
+    \
+    ProcessFunction getProcessFunction() const throw() {\
+        return &InternalBase::processDirect<UnaryOpInternal>;\
+    }\
+    \
     IntArray getInputKeys() const throw() {\
         const IntArray keys (IOKey::Generic);\
         return keys;\
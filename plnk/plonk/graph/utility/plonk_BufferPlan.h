@@ -0,0 +1,435 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_BUFFERPLAN_H
+#define PLONK_BUFFERPLAN_H
+
+#include "../plonk_GraphForwardDeclarations.h"
+#include "../../core/plonk_SmartPointer.h"
+#include "../../core/plonk_SmartPointerContainer.h"
+
+
+/** Plans the output buffers of a graph so intermediate channels share a small arena.
+ The graph is searched from the root unit in the order the channels process
+ (depth first, inputs before the channel that reads them). A channel's output
+ is live from when it is written until its consumer has processed. As a unit
+ may pull its inputs in any order the live range also covers the sibling
+ inputs of the same consumer. Channels whose live ranges do not overlap are
+ given the same slot in the arena and a channel that returns @c true from
+ canProcessInPlace() writes over the slot of one of its inputs if nothing else
+ needs that input.
+
+ Only channels in the tree part of the graph are planned, i.e., channels with
+ exactly one consumer where that consumer (and its consumer, and so on up to
+ the root) also has exactly one consumer. A channel shared by several
+ consumers is processed by whichever of them runs first so its timing can't be
+ known in advance, it and the channels below it keep their own buffers. The
+ root unit's channels, proxies, proxy owners, constants, channels whose
+ canUseExternalBuffer() returns @c false and channels that run at a different
+ block size, sample rate or overlap from their consumer also keep their own
+ buffers. Per-channel state (the Data and anything else the channel owns) is
+ never shared.
+
+ The plan assumes that each unit processes all its inputs every time it
+ processes and before it writes its output, which is the case for the units in
+ the library. Channels that are referenced from outside the root's graph (e.g.,
+ also used in another graph or held in a Variable and read elsewhere) must not
+ be reachable from the root when planning. After planning getValue() on a
+ planned channel is only valid while its consumer is processing. If the graph
+ changes structure or block size call release() and plan again. */
+template<class SampleType>
+class BufferPlanInternal : public SmartPointer
+{
+public:
+    typedef ChannelBase<SampleType>                 ChannelType;
+    typedef ObjectArray<ChannelType>                ChannelArrayType;
+    typedef ChannelInternalBase<SampleType>         InternalBase;
+    typedef ProxyChannelInternal<SampleType>        ProxyInternal;
+    typedef UnitBase<SampleType>                    UnitType;
+    typedef NumericalArray2D<ChannelType,UnitType>  UnitsType;
+    typedef NumericalArray<SampleType>              Buffer;
+
+    enum Consumers
+    {
+        Unconsumed = -1,
+        SharedConsumer = -2,
+        RootConsumer = -3
+    };
+
+    BufferPlanInternal() throw()
+    :   blockSize (0),
+        numSlots (0),
+        numInPlace (0)
+    {
+    }
+
+    ~BufferPlanInternal()
+    {
+        release();
+    }
+
+    /** Plans and assigns the buffers of the graph under @e root.
+     Any previous plan is released first. */
+    void plan (UnitType const& root) throw()
+    {
+        release();
+
+        const int numRootChannels = root.getNumChannels();
+        int i, j;
+
+        if (numRootChannels < 1)
+            return;
+
+        blockSize = root.getBlockSize (0).getValue();
+
+        for (i = 0; i < numRootChannels; ++i)
+        {
+            const int index = collect (root.atUnchecked (i).getInternal());
+
+            if (index >= 0)
+                setConsumer (index, RootConsumer);
+        }
+
+        const int numNodes = nodes.length();
+        InternalBase** const nodeArray = nodes.getArray();
+        const int* const startArray = starts.getArray();
+        const int* const consumerArray = consumers.getArray();
+
+        IntArray inTree = IntArray::newClear (numNodes);
+        IntArray slots = IntArray::withSize (numNodes);
+        int* const inTreeArray = inTree.getArray();
+        int* const slotArray = slots.getArray();
+
+        // consumers always come after their inputs
+        for (i = numNodes; --i >= 0;)
+        {
+            const int consumer = consumerArray[i];
+
+            inTreeArray[i] = (consumer == RootConsumer) || ((consumer >= 0) && inTreeArray[consumer]);
+            slotArray[i] = -1;
+        }
+
+        for (i = 0; i < numNodes; ++i)
+        {
+            const int consumer = consumerArray[i];
+
+            if (! inTreeArray[i] || (consumer < 0) || ! canPlan (nodeArray[i], nodeArray[consumer]))
+                continue;
+
+            int slot = -1;
+
+            if (nodeArray[i]->canProcessInPlace())
+            {
+                for (j = startArray[i]; (j < i) && (slot < 0); ++j)
+                {
+                    if ((consumerArray[j] == i) && (slotArray[j] >= 0) && fits (i, slotArray[j], j, slots))
+                    {
+                        slot = slotArray[j];
+                        ++numInPlace;
+                    }
+                }
+            }
+
+            for (j = 0; (j < numSlots) && (slot < 0); ++j)
+            {
+                if (fits (i, j, -1, slots))
+                    slot = j;
+            }
+
+            if (slot < 0)
+                slot = numSlots++;
+
+            slotArray[i] = slot;
+            planned.add (ChannelType (nodeArray[i]));
+            plannedSlots.add (slot);
+        }
+
+        if (numSlots > 0)
+        {
+            arena = Buffer::newClear (numSlots * blockSize);
+            SampleType* const arenaSamples = arena.getArray();
+
+            const int numPlanned = planned.length();
+            const int* const plannedSlotArray = plannedSlots.getArray();
+
+            for (i = 0; i < numPlanned; ++i)
+                planned.atUnchecked (i).setOutputBuffer (Buffer::withArrayNoCopy (blockSize, arenaSamples + plannedSlotArray[i] * blockSize));
+        }
+
+        // only the planned channels are kept
+        nodes.clear();
+        starts.clear();
+        consumers.clear();
+    }
+
+    /** Returns the planned channels to their own buffers and frees the arena. */
+    void release() throw()
+    {
+        const int numPlanned = planned.length();
+
+        for (int i = 0; i < numPlanned; ++i)
+        {
+            InternalBase* const internal = planned.atUnchecked (i).getInternal();
+
+            if (internal->isUsingExternalBuffer())
+                internal->removeExternalBuffer();
+        }
+
+        planned = ChannelArrayType();
+        plannedSlots.clear();
+        nodes.clear();
+        starts.clear();
+        consumers.clear();
+        arena = Buffer();
+        blockSize = 0;
+        numSlots = 0;
+        numInPlace = 0;
+    }
+
+    PLONK_INLINE_LOW int getNumPlanned() const throw()  { return planned.length(); }
+    PLONK_INLINE_LOW int getNumSlots() const throw()    { return numSlots; }
+    PLONK_INLINE_LOW int getNumInPlace() const throw()  { return numInPlace; }
+    PLONK_INLINE_LOW int getBlockSize() const throw()   { return blockSize; }
+    PLONK_INLINE_LOW const Buffer& getArena() const throw() { return arena; }
+
+private:
+    ObjectArray<InternalBase*> nodes;   // in processing order
+    IntArray starts;                    // the first node in each node's subtree
+    IntArray consumers;
+    ChannelArrayType planned;
+    IntArray plannedSlots;
+    Buffer arena;
+    int blockSize;
+    int numSlots;
+    int numInPlace;
+
+    /** Adds the subtree under @e internal and returns the node's index or -1 if it is not a node. */
+    int collect (InternalBase* internal) throw()
+    {
+        if ((internal == 0) || internal->isNull() || internal->isConstant())
+            return -1;
+
+        int index = nodes.indexOf (internal);
+
+        if (index >= 0)
+            return index;
+
+        const int start = nodes.length();
+        IntArray inputIndices;
+
+        if (internal->isProxy())
+            inputIndices.add (collect (static_cast<ProxyInternal*> (internal)->getOwner().getInternal()));
+
+        DynamicArray inputs = internal->getInputs().getValues();
+        const int numInputs = inputs.length();
+        int i, j;
+
+        for (i = 0; i < numInputs; ++i)
+        {
+            Dynamic& input = inputs.atUnchecked (i);
+            const int typeCode = input.getTypeCode();
+
+            if (typeCode == TypeUtility<UnitType>::getTypeCode())
+            {
+                UnitType& inputUnit = input.asUnchecked<UnitType>();
+
+                for (j = 0; j < inputUnit.getNumChannels(); ++j)
+                    inputIndices.add (collect (inputUnit.atUnchecked (j).getInternal()));
+            }
+            else if (typeCode == TypeUtility<UnitsType>::getTypeCode())
+            {
+                UnitsType& inputUnits = input.asUnchecked<UnitsType>();
+
+                for (j = 0; j < inputUnits.length(); ++j)
+                {
+                    UnitType& inputUnit = inputUnits.atUnchecked (j);
+
+                    for (int k = 0; k < inputUnit.getNumChannels(); ++k)
+                        inputIndices.add (collect (inputUnit.atUnchecked (k).getInternal()));
+                }
+            }
+            else if (typeCode == TypeUtility<ChannelType>::getTypeCode())
+            {
+                inputIndices.add (collect (input.asUnchecked<ChannelType>().getInternal()));
+            }
+        }
+
+        index = nodes.length();
+        nodes.add (internal);
+        starts.add (start);
+        consumers.add (Unconsumed);
+
+        const int numInputIndices = inputIndices.length();
+        const int* const inputIndexArray = inputIndices.getArray();
+
+        for (i = 0; i < numInputIndices; ++i)
+            if (inputIndexArray[i] >= 0)
+                setConsumer (inputIndexArray[i], index);
+
+        return index;
+    }
+
+    void setConsumer (const int index, const int consumer) throw()
+    {
+        int& current = consumers.atUnchecked (index);
+
+        if (current == Unconsumed)
+            current = consumer;
+        else if (current != consumer)
+            current = SharedConsumer;
+    }
+
+    bool canPlan (const InternalBase* internal, const InternalBase* consumer) const throw()
+    {
+        return ! internal->isProxy() &&
+               ! internal->isProxyOwner() &&
+               ! internal->isUsingExternalBuffer() &&
+               internal->canUseExternalBuffer() &&
+               (internal->getBlockSize().getValue() == blockSize) &&
+               (internal->getOutputBuffer().length() == blockSize) &&
+               (consumer->getBlockSize().getValue() == blockSize) &&
+               (internal->getSampleRate().getValue() == consumer->getSampleRate().getValue()) &&
+               (internal->getOverlap().getValue() == consumer->getOverlap().getValue());
+    }
+
+    /** A node is live from where it is written to where its consumer processes
+     and also while any of its consumer's other inputs are processed. This is
+     two ranges of node indices: the consumer's subtree before this node's
+     subtree and this node up to its consumer. */
+    PLONK_INLINE_LOW void getLiveRanges (const int index, int* ranges) const throw()
+    {
+        const int consumer = consumers.atUnchecked (index);
+        ranges[0] = starts.atUnchecked (consumer);
+        ranges[1] = starts.atUnchecked (index) - 1;
+        ranges[2] = index;
+        ranges[3] = consumer;
+    }
+
+    static PLONK_INLINE_LOW bool overlaps (const int start1, const int end1, const int start2, const int end2) throw()
+    {
+        return (start1 <= end1) && (start2 <= end2) && (start1 <= end2) && (start2 <= end1);
+    }
+
+    /** Returns @c true if nothing already in @e slot is live at the same time as @e index.
+     @e except is an input that @e index processes in place over. */
+    bool fits (const int index, const int slot, const int except, IntArray const& slots) const throw()
+    {
+        const int* const slotArray = slots.getArray();
+        int ranges[4], otherRanges[4];
+
+        getLiveRanges (index, ranges);
+
+        for (int i = 0; i < index; ++i)
+        {
+            if ((slotArray[i] != slot) || (i == except))
+                continue;
+
+            getLiveRanges (i, otherRanges);
+
+            if (overlaps (ranges[0], ranges[1], otherRanges[0], otherRanges[1]) ||
+                overlaps (ranges[0], ranges[1], otherRanges[2], otherRanges[3]) ||
+                overlaps (ranges[2], ranges[3], otherRanges[0], otherRanges[1]) ||
+                overlaps (ranges[2], ranges[3], otherRanges[2], otherRanges[3]))
+                return false;
+        }
+
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Shares the output buffers of a graph's intermediate channels in a single arena.
+ Call plan() with the root unit once the graph is built, the plan holds the
+ planned channels and the arena until release() is called or the plan is
+ destroyed. See BufferPlanInternal for the channels that are planned and the
+ conditions under which a plan is valid.
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class BufferPlanBase : public SmartPointerContainer< BufferPlanInternal<SampleType> >
+{
+public:
+    typedef BufferPlanInternal<SampleType>      Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef UnitBase<SampleType>                UnitType;
+    typedef NumericalArray<SampleType>          Buffer;
+
+    BufferPlanBase() throw()
+    :   Base (new Internal())
+    {
+    }
+
+    explicit BufferPlanBase (UnitType const& root) throw()
+    :   Base (new Internal())
+    {
+        this->getInternal()->plan (root);
+    }
+
+    BufferPlanBase (BufferPlanBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+
+    BufferPlanBase& operator= (BufferPlanBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+
+        return *this;
+	}
+
+    PLONK_INLINE_LOW void plan (UnitType const& root) throw()       { this->getInternal()->plan (root); }
+    PLONK_INLINE_LOW void release() throw()                         { this->getInternal()->release(); }
+
+    /** The number of channels using the arena. */
+    PLONK_INLINE_LOW int getNumPlanned() const throw()              { return this->getInternal()->getNumPlanned(); }
+
+    /** The number of block sized slots in the arena. */
+    PLONK_INLINE_LOW int getNumSlots() const throw()                { return this->getInternal()->getNumSlots(); }
+
+    /** The number of planned channels writing over one of their inputs. */
+    PLONK_INLINE_LOW int getNumInPlace() const throw()              { return this->getInternal()->getNumInPlace(); }
+
+    PLONK_INLINE_LOW int getBlockSize() const throw()               { return this->getInternal()->getBlockSize(); }
+    PLONK_INLINE_LOW const Buffer& getArena() const throw()         { return this->getInternal()->getArena(); }
+};
+
+typedef BufferPlanBase<PLONK_TYPE_DEFAULT>  BufferPlan;
+
+
+#endif // PLONK_BUFFERPLAN_H
@@ -47,9 +47,27 @@
 #include "../../core/plonk_SmartPointer.h"
 #include "../utility/plonk_TimeStamp.h"
 
+/** The storage for a bus.
+ This is a fixed capacity ring of samples indexed by the absolute sample
+ position of the time stamps written to it. Each concurrent writer should
+ write to its own lane (see acquireLane()) so writers never contend, readers
+ mix the lanes as they read. Readers never block or retry: they copy the data
+ then check the writer hasn't overwritten it in the meantime, if it has the
+ read is treated as a miss and returns silence. A read is also a miss while
+ any lane in use is still writing the time being read, so the reader tries
+ again later rather than losing that lane's samples, unless the lane has 
+ fallen more than StallBlocks write blocks behind the latest write to any
+ lane, in which case its writer appears to have stopped.
+ Lane 0 is shared by writers that don't claim their own lane and these must
+ all be on the same thread. There are at most MaxLanes lanes.
+ 
+ A writer may instead lend the bus a block of its own memory with 
+ setDirect(), e.g., an audio host passing the device's input buffer. Readers
+ on the writer's thread read this block from there (see getDirect()) or mix it
+ with the lanes, it is not copied into the ring so readers on other threads
+ do not see it. */
 template<class SampleType>
-class BusBufferInternal : public SmartPointer,
-                          public BlockSize::Receiver // what about samplerate changes?
+class BusBufferInternal : public SmartPointer
 {
 public:    
     typedef NumericalArray<SampleType>                                          Buffer;
@@ -57,243 +75,454 @@ public:
     typedef Dictionary<BusType>                                                 BusDictionary;
     typedef typename BinaryOpFunctionsHelper<SampleType>::BinaryOpFunctionsType BinaryOpFunctionsType;    
 
+    enum Constants
+    {
+        MaxLanes = 31,  // one bit each in lanesInUse
+        StallBlocks = 2 // write blocks a lane may lag the others before reads stop waiting for it
+    };
+
+    /** The write position of one lane.
+     The positions are absolute sample positions, the valid data in the lane
+     is from start to end. The epoch changes whenever a lane jumps to a
+     discontiguous position so readers can detect the lane was reset. It is
+     also odd while a writer mixes into data already in the lane (like a 
+     seqlock) so readers discard anything they copied during the mix. */
+    class Lane
+    {
+    public:
+        Lane() throw() { }
+        
+        Buffer buffer;
+        AtomicLongLong start;
+        AtomicLongLong end;
+        AtomicInt epoch;
+        
+    private:
+        Char padding[64]; // keep neighbouring lanes' positions off the same cache line
+        
+        Lane (Lane const&);
+        Lane& operator= (Lane const&);
+    };
+    
     BusBufferInternal() throw()
+    :   lanes (0),
+        numLanes (0),
+        capacity (0),
+        mask (0),
+        stallSamples (0),
+        directData (0),
+        directStart (0),
+        directEnd (0),
+        directThread (0)
     {
-        this->bufferSize.addReceiver(this);
-        this->writeBlockSize.addReceiver(this);
     }
     
-    BusBufferInternal(BlockSize const& bufferSizeToUse,
-                      BlockSize const& writeBlockSizeToUse,
-                      SampleRate const& sampleRateToUse) throw()
+    BusBufferInternal (BlockSize const& bufferSizeToUse,
+                       BlockSize const& writeBlockSizeToUse,
+                       SampleRate const& sampleRateToUse,
+                       const int numLanesToUse) throw()
     :   bufferSize (bufferSizeToUse),
         writeBlockSize (writeBlockSizeToUse),
         sampleRate (sampleRateToUse),
-        buffer (Buffer::newClear (bufferSize.getValue())),
-        bufferStartTime (TimeStamp::getZero()),
-        bufferEndTime (bufferStartTime + TimeStamp::fromSamples (bufferSize.getValue(), sampleRate)),
-        latestValidTime (TimeStamp::getZero()),
-        readDiff (0.0),
-        firstWriteSize (0)
-    {
-        this->bufferSize.addReceiver(this);
-        this->writeBlockSize.addReceiver(this);
+        lanes (0),
+        numLanes (plonk::max (1, plonk::min (numLanesToUse, (int)MaxLanes))),
+        capacity ((int)Bits::nextPowerOf2 ((UnsignedInt)plonk::max (1, bufferSizeToUse.getValue()))),
+        mask (capacity - 1),
+        stallSamples (plonk::min (capacity / 2, plonk::max (1, writeBlockSizeToUse.getValue()) * (int)StallBlocks)),
+        mix (Buffer::newClear (capacity)),
+        directData (0),
+        directStart (0),
+        directEnd (0),
+        directThread (0)
+    {
+        lanes = new Lane[numLanes];
+        
+        for (int i = 0; i < numLanes; ++i)
+            lanes[i].buffer = Buffer::newClear (capacity);
+        
+        lanesInUse.setValue (1); // lane 0 is always available
     } 
     
     ~BusBufferInternal()
     {
-        this->bufferSize.removeReceiver(this);
-        this->writeBlockSize.removeReceiver(this);
+        delete [] lanes;
     }
     
-    void changed (BlockSize::Sender const& source, Text const& message, Dynamic const& payload) throw()
-    {
-        (void)message;
-        (void)payload;
-        
-        BlockSize blockSizeSource = static_cast<BlockSize> (source);
-        
-        if (blockSizeSource == bufferSize)
-        {
-            plonk_assert (bufferSize.getValue() > buffer.length()); // code assumes the buffer will only grow at the moment
-            
-            buffer.setSize (bufferSize.getValue(), true); // copies existing data and zeros extra space too
-            bufferEndTime = bufferStartTime + TimeStamp::fromSamples (bufferSize.getValue(), sampleRate);
-        }
-        else if (blockSizeSource == writeBlockSize)
-        {
-            // nothing
-        }
-    }
-    
-    PLONK_INLINE_LOW void growBufferSize() throw()                            { bufferSize.setValue (bufferSize.getValue() * 2); }
     PLONK_INLINE_LOW BlockSize getBufferSize() const throw()                  { return bufferSize; }
     PLONK_INLINE_LOW BlockSize getWriteBlockSize() const throw()              { return writeBlockSize; }
     PLONK_INLINE_LOW SampleRate getSampleRate() const throw()                 { return sampleRate; }
-    PLONK_INLINE_LOW double getDuration() const throw()                       { return (bufferEndTime - bufferStartTime).getValue(); }
-    PLONK_INLINE_LOW const TimeStamp& getLatestValidTime() const throw()      { return latestValidTime; }
-    PLONK_INLINE_LOW const TimeStamp getEarliestValidTime() const throw()     { return latestValidTime - this->getDuration(); }
+    PLONK_INLINE_LOW int getCapacity() const throw()                          { return capacity; }
+    PLONK_INLINE_LOW int getNumLanes() const throw()                          { return numLanes; }
+    PLONK_INLINE_LOW double getDuration() const throw()                       { return TimeStamp::fromSamples (capacity, sampleRate.getValue()).getValue(); }
+    PLONK_INLINE_LOW TimeStamp getLatestValidTime() const throw()             { return toTimeStamp (latestEnd.getValue()); }
+    PLONK_INLINE_LOW TimeStamp getEarliestValidTime() const throw()           { return toTimeStamp (latestEnd.getValue() - capacity); }
     Text getLabel() const throw()                                   { return identifier; }
     void setLabel (Text const& newId) throw()                       { identifier = newId; }
 
+    /** Claims a lane for a writer, returns 0 (the shared lane) if they are all in use. */
+    int acquireLane() throw()
+    {
+        for (int i = 1; i < numLanes; ++i)
+        {
+            const int bit = 1 << i;
+            int inUse = lanesInUse.getValue();
+            
+            while (! (inUse & bit))
+            {
+                if (lanesInUse.compareAndSwap (inUse, inUse | bit))
+                    return i;
+                
+                inUse = lanesInUse.getValue();
+            }
+        }
+        
+        return 0;
+    }
+    
+    /** Returns a lane from acquireLane(), its data is invalidated. */
+    void releaseLane (const int lane) throw()
+    {
+        if ((lane <= 0) || (lane >= numLanes))
+            return;
+        
+        resetLane (lanes[lane], 0);
+        
+        const int bit = 1 << lane;
+        int inUse = lanesInUse.getValue();
+        
+        while (! lanesInUse.compareAndSwap (inUse, inUse & ~bit))
+            inUse = lanesInUse.getValue();
+    }
+    
     SampleType getPeak() const throw()
     {
-        return buffer.findMaximumAbs();
+        return getMix().findMaximumAbs();
     }
     
     SampleType getMean() const throw()
     {
-        return buffer.findMeanAbs();
+        return getMix().findMeanAbs();
     }
     
     SampleType getRMS() const throw()
     {
-        return buffer.findRMS();
+        return getMix().findRMS();
     }
     
-    void write (TimeStamp writeStartTime,
+    /** Writes samples to a lane. 
+     Only one thread may write to a lane at a time. Any part of the time that
+     has already been written to this lane is mixed with the samples already
+     there and the rest is appended. */
+    void write (TimeStamp const& writeStartTime,
                 const int numWriteSamples,
-                const SampleType* sourceData) throw()
+                const SampleType* sourceData,
+                const int laneIndex = 0) throw()
     {
-        const int currentBufferSize = bufferSize.getValue();
-        const double currentSampleRate = sampleRate.getValue();
+        plonk_assert ((laneIndex >= 0) && (laneIndex < numLanes));
         
-        SampleType* const bufferSamples = buffer.getArray();
+        if ((numLanes == 0) || (numWriteSamples <= 0))
+            return;
         
-        int numSamplesRemaining = numWriteSamples;
+        Lane& lane = lanes[laneIndex];
+        SampleType* const bufferSamples = lane.buffer.getArray();
         
-        bool shouldMix = false;
+        const LongLong position = toPosition (writeStartTime);
+        const LongLong positionEnd = position + numWriteSamples;
+        const LongLong laneStart = lane.start.getValueUnchecked();
+        const LongLong laneEnd = lane.end.getValueUnchecked();
         
-        if ((latestValidTime - TimeStamp::fromSamples (numWriteSamples,
-                                                       currentSampleRate)) >= writeStartTime)
-        {
-            shouldMix = true;
-            
-            // if mixing on a bus the write size must match the write size set for this bus on this block
-            plonk_assert (numWriteSamples == firstWriteSize);
-        }
+        // the part already in the lane is mixed, the rest is appended
+        LongLong mixStart = position;
+        LongLong mixEnd = position;
+        
+        if ((position >= laneStart) && (position <= laneEnd))
+            mixEnd = plonk::min (positionEnd, laneEnd);
         else
-        {
-            // keep a record of the size used to write the first block at this time
-            firstWriteSize = writeBlockSize.getValue();
-        }
+            resetLane (lane, position);
         
-        while (numSamplesRemaining > 0)
-        {            
-            if (writeStartTime >= bufferEndTime)
-            {
-                bufferStartTime = bufferEndTime;
-                bufferEndTime = bufferStartTime + TimeStamp::fromSamples (currentBufferSize,
-                                                                          currentSampleRate);
-            }
-
-            const TimeStamp bufferOffsetTime = writeStartTime - bufferStartTime;
-            int bufferOffsetSamples = int (bufferOffsetTime.toSamples (currentSampleRate) + 0.5);
-            
-            if (bufferOffsetSamples >= currentBufferSize)
-                bufferOffsetSamples -= currentBufferSize;
-            
-            if (bufferOffsetSamples >= currentBufferSize)
-            {
-                bufferStartTime = writeStartTime;
-                bufferEndTime = bufferStartTime + TimeStamp::fromSamples (currentBufferSize,
-                                                                          currentSampleRate);
-                bufferOffsetSamples = 0;
-                buffer.zero();
-            }
+        // only the end will fit
+        const LongLong appendStart = plonk::max (mixEnd, positionEnd - capacity);
+        
+        // invalidate the part of the ring that is about to be overwritten before writing to it
+        if (appendStart < positionEnd)
+            lane.start.setValue (plonk::max (lane.start.getValueUnchecked(), positionEnd - capacity));
+        
+        mixStart = plonk::max (mixStart, lane.start.getValueUnchecked());
+        
+        if (mixStart < mixEnd)
+        {
+            ++lane.epoch; // odd while mixing
+            pl_AtomicMemoryBarrier();
             
-            const int bufferSamplesRemaining = currentBufferSize - bufferOffsetSamples;
-            const int samplesThisTime = plonk::min (numSamplesRemaining,
-                                                    bufferSamplesRemaining);
+            writeToRing (bufferSamples, mixStart, int (mixEnd - mixStart), sourceData + (mixStart - position), true);
             
-//            printf ("write-> %d samples from %d (to %d)\n", samplesThisTime, bufferOffsetSamples, bufferOffsetSamples + samplesThisTime);
+            pl_AtomicMemoryBarrier();
+            ++lane.epoch;
+        }
+        
+        if (appendStart < positionEnd)
+        {
+            writeToRing (bufferSamples, appendStart, int (positionEnd - appendStart), sourceData + (appendStart - position), false);
             
-            if (shouldMix)
-            {
-                NumericalArrayBinaryOp<SampleType, BinaryOpFunctionsType::addop>::calcNN (bufferSamples + bufferOffsetSamples,
-                                                                                          bufferSamples + bufferOffsetSamples,
-                                                                                          sourceData,
-                                                                                          samplesThisTime);
-            }
-            else
-            {
-                NumericalArray<SampleType>::copyData (bufferSamples + bufferOffsetSamples,
-                                                      sourceData,
-                                                      samplesThisTime);
-            }
+            lane.end.setValue (positionEnd);
             
-            numSamplesRemaining -= samplesThisTime;
-            sourceData += samplesThisTime;
+            LongLong latest = latestEnd.getValue();
             
-            const double timestampOffset = TimeStamp::fromSamples (samplesThisTime,
-                                                                   currentSampleRate);
-            writeStartTime += timestampOffset;
-            latestValidTime = writeStartTime;
+            while ((positionEnd > latest) && ! latestEnd.compareAndSwap (latest, positionEnd))
+                latest = latestEnd.getValue();
         }
     }
 
+    /** Lends the bus a block of samples without copying them.
+     The samples must stay valid until clearDirect() or the next call to 
+     setDirect(). They are only visible to readers on the calling thread. */
+    void setDirect (TimeStamp const& startTime,
+                    const int numSamples,
+                    const SampleType* data) throw()
+    {
+        directThread = Threading::getCurrentThreadID();
+        directStart = toPosition (startTime);
+        directEnd = directStart + numSamples;
+        directData = data;
+    }
+    
+    /** Withdraws the block from setDirect(). */
+    void clearDirect() throw()
+    {
+        directData = 0;
+        directStart = directEnd = 0;
+    }
+    
+    /** Returns the samples lent with setDirect() for this time or null.
+     This only succeeds on the thread that called setDirect() and when no lane
+     has data for the same time, otherwise the caller should read() instead.
+     If readStartTime is negative the read is from the start of the block. On
+     success readStartTime is advanced to the end of the read. */
+    const SampleType* getDirect (TimeStamp& readStartTime,
+                                 const int numReadSamples) const throw()
+    {
+        if ((directData == 0) || (directThread != Threading::getCurrentThreadID()))
+            return 0;
+        
+        const LongLong position = (readStartTime < TimeStamp::getZero()) ? directStart : toPosition (readStartTime);
+        const LongLong positionEnd = position + numReadSamples;
+        
+        if ((position < directStart) || (positionEnd > directEnd))
+            return 0;
+        
+        for (int i = 0; i < numLanes; ++i)
+            if ((lanes[i].end.getValue() > position) && (lanes[i].start.getValue() < positionEnd))
+                return 0;
+        
+        readStartTime = toTimeStamp (positionEnd);
+        return directData + (position - directStart);
+    }
+    
+    /** Reads and mixes samples from all the lanes that have data for this time.
+     If readStartTime is negative the most recent samples are read (or the start
+     of the samples lent with setDirect() on the lending thread). On success
+     readStartTime is advanced to the end of the read, otherwise the output is 
+     silent and readStartTime is left where the read should be attempted again. */
     void read (TimeStamp& readStartTime,
                const int numReadSamples, 
                SampleType* destData) throw()
     {                                
-        const int currentBufferSize = bufferSize.getValue();
-        const double currentSampleRate = sampleRate.getValue();
+        const bool hasDirect = (directData != 0) && (directThread == Threading::getCurrentThreadID());
+        const LongLong latestPosition = hasDirect ? directStart : latestEnd.getValue() - numReadSamples;
+        const LongLong position = (readStartTime < TimeStamp::getZero()) ? latestPosition : toPosition (readStartTime);
+        const LongLong positionEnd = position + numReadSamples;
         
-        const TimeStamp duration = TimeStamp::fromSamples (numReadSamples, currentSampleRate);
-        TimeStamp readEndTime;
+        bool found = false;
+        bool valid = true;
+        int i;
         
-        if (readStartTime < TimeStamp::getZero())
-        {
-            readEndTime = latestValidTime;
-            readStartTime = readEndTime - duration;
-        }
-        else
+        if ((numReadSamples > capacity) || (numReadSamples <= 0))
+            valid = false;
+        
+        if (valid)
         {
-            readEndTime = readStartTime + duration;
+            const LongLong latest = latestEnd.getValue();
+            const int inUse = lanesInUse.getValue();
+            
+            for (i = 0; i < numLanes; ++i)
+            {
+                const Lane& lane = lanes[i];
+                const LongLong laneStart = lane.start.getValue();
+                const LongLong laneEnd = lane.end.getValue();
+                
+                // a writer that has reached this time but not finished it yet
+                if ((inUse & (1 << i)) && 
+                    (laneStart < laneEnd) && (laneStart <= position) && (laneEnd < positionEnd) &&
+                    ((latest - laneEnd) <= stallSamples))
+                {
+                    valid = false;
+                    break;
+                }
+            }
         }
-
-        const TimeStamp earliestValidTime = this->getEarliestValidTime();
-        const double diff = (latestValidTime - readEndTime).getValue();
         
-        if ((readStartTime >= earliestValidTime) && 
-            (readStartTime < latestValidTime) && 
-            (readEndTime <= latestValidTime))
+        for (i = 0; valid && (i < numLanes); ++i)
         {
-            int bufferOffsetSamples = int ((readStartTime - bufferStartTime).toSamples (currentSampleRate) + 0.5);
+            Lane& lane = lanes[i];
+            const int epoch = lane.epoch.getValue();
             
-            if (bufferOffsetSamples < 0)
-                bufferOffsetSamples += currentBufferSize - 1; // -1 due to being rounded in the wrong direction above when negative
+            if ((lane.end.getValue() < positionEnd) || (lane.start.getValue() > position))
+                continue;
             
-            plonk_assert (bufferOffsetSamples < currentBufferSize);
-                            
-            SampleType* const bufferSamples = buffer.getArray();
+            // a writer is mixing into this lane, try again later
+            if (epoch & 1)
+            {
+                valid = false;
+                break;
+            }
             
-//            printf ("<--read %d samples from %d (to %d)\n", numReadSamples, bufferOffsetSamples, bufferOffsetSamples + numReadSamples);
-                
+            const SampleType* const bufferSamples = lane.buffer.getArray();
+            SampleType* dest = destData;
             int numSamplesRemaining = numReadSamples;
+            int bufferOffsetSamples = int (position & mask);
             
             while (numSamplesRemaining > 0)
             {
-                const int bufferSamplesRemaining = currentBufferSize - bufferOffsetSamples;
-                const int samplesThisTime = plonk::min (numSamplesRemaining, 
-                                                        bufferSamplesRemaining);
-                
-                NumericalArray<SampleType>::copyData (destData, bufferSamples + bufferOffsetSamples, samplesThisTime);                    
-                numSamplesRemaining -= samplesThisTime;
+                const int samplesThisTime = plonk::min (numSamplesRemaining, capacity - bufferOffsetSamples);
                 
-                if (numSamplesRemaining > 0)
+                if (found)
+                {
+                    NumericalArrayBinaryOp<SampleType, BinaryOpFunctionsType::addop>::calcNN (dest,
+                                                                                              dest,
+                                                                                              bufferSamples + bufferOffsetSamples,
+                                                                                              samplesThisTime);
+                }
+                else
                 {
-                    destData += samplesThisTime;
-                    bufferOffsetSamples = 0;
+                    Buffer::copyData (dest, bufferSamples + bufferOffsetSamples, samplesThisTime);
                 }
-            }                                  
+                
+                numSamplesRemaining -= samplesThisTime;
+                dest += samplesThisTime;
+                bufferOffsetSamples = 0;
+            }
+            
+            // the writer may have lapped us while copying
+            pl_AtomicMemoryBarrier();
+            
+            if ((lane.start.getValue() > position) || (lane.epoch.getValue() != epoch))
+                valid = false;
             
-            readStartTime = readEndTime; // for return
+            found = true;
         }
-        else
+        
+        if (valid && hasDirect && (position >= directStart) && (positionEnd <= directEnd))
         {
-            // zero this time and check if we need to enlarge the buffer
+            const SampleType* const directSamples = directData + (position - directStart);
             
-            if ((diff > 0.0) && (diff >= readDiff))
-                this->growBufferSize();
+            if (found)
+                NumericalArrayBinaryOp<SampleType, BinaryOpFunctionsType::addop>::calcNN (destData, destData, directSamples, numReadSamples);
+            else
+                Buffer::copyData (destData, directSamples, numReadSamples);
             
-            NumericalArray<SampleType>::zeroData (destData, numReadSamples);
+            found = true;
+        }
+        
+        if (found && valid)
+        {
+            readStartTime = toTimeStamp (positionEnd);
+        }
+        else
+        {
+            if (readStartTime < TimeStamp::getZero())
+                readStartTime = toTimeStamp (position);
+            
+            if (numReadSamples > 0)
+                Buffer::zeroData (destData, numReadSamples);
         }
-
-        readDiff = diff; // keep track of the read difference to determine if we're actually getting anywhere
     }
         
-
 private:
-    BlockSize bufferSize;       // size of the circular buffer
+    PLONK_INLINE_LOW LongLong toPosition (TimeStamp const& time) const throw()
+    {
+        return LongLong (::floor (time.toSamples (sampleRate.getValue()) + 0.5));
+    }
+    
+    PLONK_INLINE_LOW TimeStamp toTimeStamp (const LongLong position) const throw()
+    {
+        return TimeStamp::fromSamples (double (position), sampleRate.getValue());
+    }
+    
+    void resetLane (Lane& lane, const LongLong position) throw()
+    {
+        lane.epoch += 2; // stays even, odd is reserved for mixing
+        lane.end.setValue (position);
+        lane.start.setValue (position);
+    }
+    
+    void writeToRing (SampleType* const bufferSamples,
+                      const LongLong position,
+                      const int numSamples,
+                      const SampleType* sourceData,
+                      const bool shouldMix) throw()
+    {
+        int numSamplesRemaining = numSamples;
+        int bufferOffsetSamples = int (position & mask);
+        
+        while (numSamplesRemaining > 0)
+        {
+            const int samplesThisTime = plonk::min (numSamplesRemaining, capacity - bufferOffsetSamples);
+            
+            if (shouldMix)
+            {
+                NumericalArrayBinaryOp<SampleType, BinaryOpFunctionsType::addop>::calcNN (bufferSamples + bufferOffsetSamples,
+                                                                                          bufferSamples + bufferOffsetSamples,
+                                                                                          sourceData,
+                                                                                          samplesThisTime);
+            }
+            else
+            {
+                Buffer::copyData (bufferSamples + bufferOffsetSamples, sourceData, samplesThisTime);
+            }
+            
+            numSamplesRemaining -= samplesThisTime;
+            sourceData += samplesThisTime;
+            bufferOffsetSamples = 0;
+        }
+    }
+    
+    /** Mixes the lanes into the scratch buffer, only one thread should measure the levels at a time. */
+    const Buffer& getMix() const throw()
+    {
+        SampleType* const mixSamples = mix.getArray();
+        const int inUse = lanesInUse.getValue();
+        
+        Buffer::zeroData (mixSamples, capacity);
+        
+        for (int i = 0; i < numLanes; ++i)
+        {
+            if (inUse & (1 << i))
+            {
+                NumericalArrayBinaryOp<SampleType, BinaryOpFunctionsType::addop>::calcNN (mixSamples,
+                                                                                          mixSamples,
+                                                                                          lanes[i].buffer.getArray(),
+                                                                                          capacity);
+            }
+        }
+        
+        return mix;
+    }
+    
+    BlockSize bufferSize;       // requested size of the circular buffer
     BlockSize writeBlockSize;   // estimated size of the write operations
     SampleRate sampleRate;      // sample rate of the audio
-    Buffer buffer;              // the circular buffer
-    TimeStamp bufferStartTime;  // timestamp of the first sample in the buffer
-    TimeStamp bufferEndTime;    // calculated timestamp of the sample past the end of the buffer but this may not be where we have written to yet
-    TimeStamp latestValidTime;  // the latest time that has been written to the bus
-    double readDiff;
-    int firstWriteSize;         // size of the actual first write
+    Lane* lanes;                // one ring per writer
+    const int numLanes;
+    const int capacity;         // bufferSize rounded up to a power of 2
+    const int mask;
+    const int stallSamples;     // StallBlocks write blocks, how far a lane may lag the latest write before reads stop waiting for it
+    mutable Buffer mix;         // scratch for the levels, allocated once
+    AtomicInt lanesInUse;       // a bit for each claimed lane
+    AtomicLongLong latestEnd;   // the position after the latest sample written to any lane
+    const SampleType* directData;   // samples lent by setDirect()
+    LongLong directStart;
+    LongLong directEnd;
+    Threading::ID directThread;     // the only thread that reads the lent samples
     Text identifier;            // named ID for the buffer
 };
 
@@ -301,9 +530,9 @@ private:
 /** Enables the storage of globally accessible buffers to be used as signal busses.
  This stores a time stamped circular buffer such that BusRead units can read
  from the bus at "any" block size and get enough data to fill their output. 
- Of course this depends on the buffer size being large enough (although the
- buffer should automatically resize if you try to read in larger chunks
- than the current buffer size allows). */
+ Of course this depends on the buffer size being large enough, the capacity 
+ is fixed when the bus is created so reads larger than this return silence.
+ Writers and readers may be on different threads, see acquireLane(). */
 template<class SampleType>
 class BusBuffer : public SmartPointerContainer<BusBufferInternal<SampleType> >
 {
@@ -336,8 +565,9 @@ public:
     
     BusBuffer (BlockSize const& bufferSize, 
                BlockSize const& writeBlockSize, 
-               SampleRate const& sampleRate) throw()
-    :   Base (new Internal (bufferSize, writeBlockSize, sampleRate))
+               SampleRate const& sampleRate,
+               const int numLanes = BusBuffer::getDefaultNumLanes()) throw()
+    :   Base (new Internal (bufferSize, writeBlockSize, sampleRate, numLanes))
     {
     }        
     
@@ -357,7 +587,7 @@ public:
 		return null;
 	}	                    
     
-    PLONK_INLINE_LOW void growBufferSize() throw()                            { this->getInternal()->growBufferSize(); }
+
     PLONK_INLINE_LOW const BlockSize getBufferSize() const throw()            { return this->getInternal()->getBufferSize(); }
     PLONK_INLINE_LOW BlockSize getBufferSize() throw()                        { return this->getInternal()->getBufferSize(); }
     PLONK_INLINE_LOW const BlockSize getWriteBlockSize() const throw()        { return this->getInternal()->getWriteBlockSize(); }
@@ -365,15 +595,24 @@ public:
     PLONK_INLINE_LOW const SampleRate getSampleRate() const throw()           { return this->getInternal()->getSampleRate(); }
     PLONK_INLINE_LOW SampleRate getSampleRate() throw()                       { return this->getInternal()->getSampleRate(); }
     PLONK_INLINE_LOW double getDuration() throw()                             { return this->getInternal()->getDuration(); }
-    PLONK_INLINE_LOW const TimeStamp& getLatestValidTime() const throw()      { return this->getInternal()->getLatestValidTime(); }
-    PLONK_INLINE_LOW const TimeStamp  getEarliestValidTime() const throw()    { return this->getInternal()->getEarliestValidTime(); }
+    PLONK_INLINE_LOW int getCapacity() const throw()                          { return this->getInternal()->getCapacity(); }
+    PLONK_INLINE_LOW int getNumLanes() const throw()                          { return this->getInternal()->getNumLanes(); }
+    PLONK_INLINE_LOW const TimeStamp getLatestValidTime() const throw()       { return this->getInternal()->getLatestValidTime(); }
+    PLONK_INLINE_LOW const TimeStamp getEarliestValidTime() const throw()     { return this->getInternal()->getEarliestValidTime(); }
     PLONK_INLINE_LOW Text getLabel() const throw()                            { return this->getInternal()->getLabel(); }
     PLONK_INLINE_LOW void setLabel(Text const& newId) throw()                 { this->getInternal()->setLabel (newId); }
 
+    /** Claim a lane so this writer can write concurrently with others. 
+     Returns 0, the shared lane, if there are no free lanes. */
+    PLONK_INLINE_LOW int acquireLane() throw()                                { return this->getInternal()->acquireLane(); }
+    
+    /** Release a lane obtained from acquireLane(). */
+    PLONK_INLINE_LOW void releaseLane (const int lane) throw()                { this->getInternal()->releaseLane (lane); }
+
     /** Write data with a given time stampe start to the bus. */
-    PLONK_INLINE_LOW void write (TimeStamp const& timeStamp, const int numSamples, const SampleType* sourceData) throw()
+    PLONK_INLINE_LOW void write (TimeStamp const& timeStamp, const int numSamples, const SampleType* sourceData, const int lane = 0) throw()
     {
-        this->getInternal()->write (timeStamp, numSamples, sourceData);
+        this->getInternal()->write (timeStamp, numSamples, sourceData, lane);
     }
     
     /** Read data from the bus with a given time stamp. */
@@ -382,6 +621,24 @@ public:
         this->getInternal()->read (timeStamp, numSamples, destData);
     }
     
+    /** Lend the bus samples to be read in place on this thread, they are not copied. */
+    PLONK_INLINE_LOW void setDirect (TimeStamp const& timeStamp, const int numSamples, const SampleType* data) throw()
+    {
+        this->getInternal()->setDirect (timeStamp, numSamples, data);
+    }
+    
+    /** Withdraw the samples lent with setDirect(). */
+    PLONK_INLINE_LOW void clearDirect() throw()
+    {
+        this->getInternal()->clearDirect();
+    }
+    
+    /** Get a pointer to the lent samples for this time, or null if they must be read(). */
+    PLONK_INLINE_LOW const SampleType* getDirect (TimeStamp& timeStamp, const int numSamples) const throw()
+    {
+        return this->getInternal()->getDirect (timeStamp, numSamples);
+    }
+    
     PLONK_INLINE_LOW SampleType getPeak() const throw()
     {
         return this->getInternal()->getPeak();
@@ -442,6 +699,11 @@ public:
         return defaultBufferSize;
     }    
     
+    static int getDefaultNumLanes() throw()
+    {
+        return 4;
+    }
+    
     int getTypeCode() const throw()
     {
         return TypeUtility<BusBuffer>::getTypeCode();
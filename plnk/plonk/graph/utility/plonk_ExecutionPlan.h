@@ -0,0 +1,552 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_EXECUTIONPLAN_H
+#define PLONK_EXECUTIONPLAN_H
+
+#include "../plonk_GraphForwardDeclarations.h"
+#include "../../core/plonk_SmartPointer.h"
+#include "../../core/plonk_SmartPointerContainer.h"
+
+
+/** Renders a graph from a flat list of its channels rather than pulling it.
+ Normally each block the root unit's channels call process() on their inputs,
+ which call process() on theirs and so on, and every channel compares its
+ next time stamp with the block's time stamp to find out whether it has
+ already processed. compile() walks the graph once, in the same order as the
+ pull would reach the channels, and stores an entry for each channel with the
+ function that processes it, the channel and the channel index it would be
+ passed. process() then runs the entries in order with no recursion and no
+ time stamp checks. Channels in the plan have their time stamps suspended so
+ when their consumers pull them the call returns straight away and the
+ consumer reads the output that the plan has already written.
+
+ Channels are called through getProcessFunction() so channels that return
+ ChannelInternalBase::processDirect are called without a virtual call.
+
+ Only channels running at the root's block size and sample rate with no
+ overlap, all of whose consumers are also in the plan, are added. Others
+ (e.g., control rate channels, channels under a Resample, channels of a
+ different sample type below a type converter) are still pulled by their
+ consumers as normal, and root channels that can't be added are pulled by
+ the plan. Channels that are found through inputs held in Variables, queues 
+ and so on rather than the input dictionaries are not seen by the plan so are
+ also pulled as normal.
+
+ If a channel asks to be deleted (e.g., a SignalPlay with deleteWhenDone) the
+ request is passed to its consumers in the plan each block as it would be 
+ passed up the pull, so it stops at the first mixer (or similar) that resets 
+ it, and each channel that sees the request is marked as expired. The plan 
+ itself is unchanged as this doesn't change the structure of the graph.
+ 
+ compile() allocates so it must not be called on the audio thread. It builds
+ a new plan and hands it to process() which swaps it in at the start of its 
+ next block, the plan it replaces is deleted by the next call to compile() or 
+ release(). Call compile() (or invalidate()) after any other change to the 
+ structure of the graph or its block size. setRoot() and release() must not
+ be called while process() may be running. */
+template<class SampleType>
+class ExecutionPlanInternal : public SmartPointer
+{
+public:
+    typedef ChannelBase<SampleType>                 ChannelType;
+    typedef ObjectArray<ChannelType>                ChannelArrayType;
+    typedef ChannelInternalBase<SampleType>         InternalBase;
+    typedef ProxyChannelInternal<SampleType>        ProxyInternal;
+    typedef UnitBase<SampleType>                    UnitType;
+    typedef NumericalArray2D<ChannelType,UnitType>  UnitsType;
+    typedef typename InternalBase::ProcessFunction  ProcessFunction;
+
+    struct Entry
+    {
+        ProcessFunction function;
+        InternalBase* internal;
+        int channel;
+        int inputsStart;    // the entry's inputs in the plan are in entryInputs
+        int inputsEnd;
+        bool pulled;        // a root channel that is not in the plan
+    };
+
+    typedef ObjectArray<Entry>                      Entries;
+
+    /** A compiled plan. */
+    struct Plan : public PlonkBase
+    {
+        Entries entries;
+        IntArray entryInputs;
+        IntArray deleted;               // whether each entry asked to be deleted this block
+        ChannelArrayType planned;
+    };
+
+    ExecutionPlanInternal() throw()
+    :   current (0),
+        blockSize (0),
+        sampleRate (0.0)
+    {
+    }
+
+    ~ExecutionPlanInternal()
+    {
+        release();
+    }
+
+    /** Sets the graph to render and compiles it. */
+    void setRoot (UnitType const& newRoot) throw()
+    {
+        release();
+        root = newRoot;
+        compile();
+    }
+
+    /** Builds a plan from the root and hands it to process(). */
+    void compile() throw()
+    {
+        Plan* const plan = new Plan();
+        const int numRootChannels = root.getNumChannels();
+        int i, j;
+
+        if (numRootChannels > 0)
+        {
+            ChannelType& firstChannel = root.atUnchecked (0);
+            blockSize = firstChannel.getBlockSize().getValue();
+            sampleRate = firstChannel.getSampleRate().getValue();
+
+            nodeTable = IntArray::withSize (64);
+            nodeTable.fill (-1);
+
+            IntArray rootIndices = IntArray::withSize (numRootChannels);
+            int* const rootIndexArray = rootIndices.getArray();
+
+            for (i = 0; i < numRootChannels; ++i)
+                rootIndexArray[i] = collect (root.atUnchecked (i).getInternal(), i);
+
+            const int numNodes = nodes.length();
+            InternalBase** const nodeArray = nodes.getArray();
+            const int* const inputStartArray = inputStarts.getArray();
+            const int* const inputArray = inputs.getArray();
+
+            IntArray consumersInPlan = IntArray::withSize (numNodes);
+            IntArray inPlan = IntArray::withSize (numNodes);
+            int* const consumersInPlanArray = consumersInPlan.getArray();
+            int* const inPlanArray = inPlan.getArray();
+
+            for (i = 0; i < numNodes; ++i)
+                consumersInPlanArray[i] = true;
+
+            // consumers always come after their inputs
+            for (i = numNodes; --i >= 0;)
+            {
+                inPlanArray[i] = consumersInPlanArray[i] && canAdd (nodeArray[i]);
+
+                if (! inPlanArray[i])
+                {
+                    const int inputsEnd = (i + 1) < numNodes ? inputStartArray[i + 1] : inputs.length();
+
+                    for (j = inputStartArray[i]; j < inputsEnd; ++j)
+                        consumersInPlanArray[inputArray[j]] = false;
+                }
+            }
+
+            // root channels that can't be added are still processed, by pulling them
+            IntArray isRoot = IntArray::newClear (numNodes);
+            int* const isRootArray = isRoot.getArray();
+
+            for (i = 0; i < numRootChannels; ++i)
+                if (rootIndexArray[i] >= 0)
+                    isRootArray[rootIndexArray[i]] = true;
+
+            const int* const channelArray = channels.getArray();
+            IntArray entryIndices = IntArray::withSize (numNodes);
+            int* const entryIndexArray = entryIndices.getArray();
+
+            for (i = 0; i < numNodes; ++i)
+            {
+                entryIndexArray[i] = -1;
+
+                if (inPlanArray[i] || isRootArray[i])
+                {
+                    InternalBase* const internal = nodeArray[i];
+                    const int inputsEnd = (i + 1) < numNodes ? inputStartArray[i + 1] : inputs.length();
+
+                    Entry entry;
+                    entry.internal = internal;
+                    entry.channel = channelArray[i];
+                    entry.inputsStart = plan->entryInputs.length();
+                    entry.pulled = ! inPlanArray[i];
+                    entry.function = entry.pulled ? pull : internal->getProcessFunction();
+
+                    for (j = inputStartArray[i]; j < inputsEnd; ++j)
+                        if (entryIndexArray[inputArray[j]] >= 0)
+                            plan->entryInputs.add (entryIndexArray[inputArray[j]]);
+
+                    entry.inputsEnd = plan->entryInputs.length();
+                    entryIndexArray[i] = plan->entries.length();
+                    plan->entries.add (entry);
+
+                    if (! entry.pulled)
+                        plan->planned.add (ChannelType (internal));
+                }
+            }
+
+            plan->deleted = IntArray::newClear (plan->entries.length());
+
+            nodes.clear();
+            nodeTable.clear();
+            inputStarts.clear();
+            inputs.clear();
+            channels.clear();
+        }
+
+        lastNumEntries = plan->entries.length();
+
+        // whatever was in the exchange is either a plan that process() never
+        // took or one that it has finished with
+        delete exchange.swapAll (plan, Published);
+    }
+
+    /** Compiles the plan again, this is the same as compile(). */
+    PLONK_INLINE_LOW void invalidate() throw()
+    {
+        compile();
+    }
+
+    /** Processes one block of the root unit. */
+    void process (ProcessInfo& info) throw()
+    {
+        Plan* const next = exchange.getValueUnchecked();
+
+        if ((next != 0) && (exchange.getExtraUnchecked() == Published))
+            swapIn (next);
+
+        if (current == 0)
+            return;
+
+        const int numEntries = current->entries.length();
+        const Entry* const entryArray = current->entries.getArray();
+        const int* const entryInputArray = current->entryInputs.getArray();
+        int* const deletedArray = current->deleted.getArray();
+
+        for (int i = 0; i < numEntries; ++i)
+        {
+            const Entry& entry = entryArray[i];
+
+            // as if the entry had just pulled its inputs
+            info.resetShouldDelete();
+
+            for (int j = entry.inputsStart; j < entry.inputsEnd; ++j)
+            {
+                if (deletedArray[entryInputArray[j]])
+                {
+                    info.setShouldDelete();
+                    break;
+                }
+            }
+
+            entry.function (entry.internal, info, entry.channel);
+            deletedArray[i] = info.getShouldDelete();
+
+            if (deletedArray[i] && ! entry.pulled)
+                entry.internal->setExpiryTimeStamp (info.getTimeStamp() + entry.internal->getBlockDurationInTicks());
+        }
+    }
+
+    /** Returns the channels in the plan to being pulled and drops the root. */
+    void release() throw()
+    {
+        if (current != 0)
+        {
+            resume (current);
+            delete current;
+            current = 0;
+        }
+
+        delete exchange.swapAll (0, Published);
+        root = UnitType();
+        lastNumEntries = 0;
+    }
+
+    PLONK_INLINE_LOW const UnitType& getRoot() const throw()    { return root; }
+    
+    /** Returns the number of entries in the most recently compiled plan. */
+    PLONK_INLINE_LOW int getNumEntries() const throw()          { return lastNumEntries.getValue(); }
+
+private:
+    enum ExchangeStates
+    {
+        Published,                      // compile() has put a new plan in the exchange
+        Retired                         // process() has put back the plan it replaced
+    };
+    
+    UnitType root;
+    AtomicExtended<Plan*> exchange;
+    Plan* current;                      // only used by process() or when it isn't running
+    AtomicInt lastNumEntries;
+    int blockSize;
+    double sampleRate;
+
+    ObjectArray<InternalBase*> nodes;   // in processing order
+    IntArray nodeTable;                 // open addressed hash of indices into nodes, -1 is empty
+    IntArray inputStarts;               // where each node's inputs start in inputs
+    IntArray inputs;
+    IntArray channels;                  // the channel index each node is passed
+
+    /** Takes the next plan from the exchange leaving the current one in its place. */
+    void swapIn (Plan* const next) throw()
+    {
+        // the current plan may be deleted as soon as it is in the exchange
+        if (current != 0)
+            resume (current);
+
+        if (exchange.compareAndSwap (next, Published, current, Retired))
+        {
+            current = next;
+            suspend (current);
+        }
+        else if (current != 0)
+        {
+            // compile() replaced the plan, take it next block
+            suspend (current);
+        }
+    }
+
+    static void suspend (Plan* const plan) throw()
+    {
+        const int numPlanned = plan->planned.length();
+
+        for (int i = 0; i < numPlanned; ++i)
+            plan->planned.atUnchecked (i).getInternal()->suspendTimeStamps();
+    }
+
+    static void resume (Plan* const plan) throw()
+    {
+        const int numPlanned = plan->planned.length();
+
+        for (int i = 0; i < numPlanned; ++i)
+            plan->planned.atUnchecked (i).getInternal()->resumeTimeStamps();
+    }
+
+    /** Processes a channel that is not in the plan as ChannelBase::process() does. */
+    static void pull (InternalBase* internal, ProcessInfo& info, const int channel) throw()
+    {
+        if (info.getTimeStamp() >= internal->getNextTimeStamp())
+        {
+            internal->process (info, channel);
+            internal->setLastTimeStamp (info.getTimeStamp());
+            internal->updateTimeStamp();
+
+            if (info.getShouldDelete() == true)
+                internal->setExpiryTimeStamp (internal->getNextTimeStamp());
+        }
+    }
+
+    bool canAdd (const InternalBase* internal) const throw()
+    {
+        return (internal->getBlockSize().getValue() == blockSize) &&
+               (internal->getSampleRate().getValue() == sampleRate) &&
+               (internal->getOverlap().getValue() == 1.0) &&
+               (internal->getExpiryTimeStamp() == TimeStamp::getMaximum());
+    }
+
+    static PLONK_INLINE_LOW int hash (const InternalBase* internal) throw()
+    {
+        // the low bits of an allocation vary little
+        const UnsignedLong bits = reinterpret_cast<UnsignedLong> (internal) >> 4;
+        return int (bits ^ (bits >> 16));
+    }
+
+    /** Returns the slot in nodeTable holding @e internal or the empty slot where it would go. */
+    int findSlot (const InternalBase* internal) const throw()
+    {
+        const int mask = nodeTable.length() - 1;
+        const int* const tableArray = nodeTable.getArray();
+        InternalBase* const* const nodeArray = nodes.getArray();
+        int slot = hash (internal) & mask;
+
+        while ((tableArray[slot] >= 0) && (nodeArray[tableArray[slot]] != internal))
+            slot = (slot + 1) & mask;
+
+        return slot;
+    }
+
+    void addNode (InternalBase* internal) throw()
+    {
+        const int index = nodes.length();
+        nodes.add (internal);
+
+        if ((index * 2) < nodeTable.length())
+        {
+            nodeTable.atUnchecked (findSlot (internal)) = index;
+        }
+        else
+        {
+            nodeTable = IntArray::withSize (nodeTable.length() * 2);
+            nodeTable.fill (-1);
+
+            for (int i = 0; i <= index; ++i)
+                nodeTable.atUnchecked (findSlot (nodes.atUnchecked (i))) = i;
+        }
+    }
+
+    /** Adds the subtree under @e internal and returns the node's index or -1 if it is not a node.
+     A single channel input is passed the consumer's channel index, the
+     channels of a multichannel input are passed their own index. */
+    int collect (InternalBase* internal, const int channel) throw()
+    {
+        if ((internal == 0) || internal->isNull())
+            return -1;
+
+        int index = nodeTable.atUnchecked (findSlot (internal));
+
+        if (index >= 0)
+            return index;
+
+        IntArray inputIndices;
+
+        if (internal->isProxy())
+            inputIndices.add (collect (static_cast<ProxyInternal*> (internal)->getOwner().getInternal(), channel));
+
+        DynamicArray inputValues = internal->getInputs().getValues();
+        const int numInputValues = inputValues.length();
+        int i;
+
+        for (i = 0; i < numInputValues; ++i)
+        {
+            Dynamic& input = inputValues.atUnchecked (i);
+            const int typeCode = input.getTypeCode();
+
+            if (typeCode == TypeUtility<UnitType>::getTypeCode())
+            {
+                collectUnit (input.asUnchecked<UnitType>(), channel, inputIndices);
+            }
+            else if (typeCode == TypeUtility<UnitsType>::getTypeCode())
+            {
+                UnitsType& inputUnits = input.asUnchecked<UnitsType>();
+
+                for (int j = 0; j < inputUnits.length(); ++j)
+                    collectUnit (inputUnits.atUnchecked (j), channel, inputIndices);
+            }
+            else if (typeCode == TypeUtility<ChannelType>::getTypeCode())
+            {
+                inputIndices.add (collect (input.asUnchecked<ChannelType>().getInternal(), channel));
+            }
+        }
+
+        index = nodes.length();
+        addNode (internal);
+        channels.add (channel);
+        inputStarts.add (inputs.length());
+
+        const int numInputIndices = inputIndices.length();
+        const int* const inputIndexArray = inputIndices.getArray();
+
+        for (i = 0; i < numInputIndices; ++i)
+            if (inputIndexArray[i] >= 0)
+                inputs.add (inputIndexArray[i]);
+
+        return index;
+    }
+
+    void collectUnit (UnitType& unit, const int channel, IntArray& inputIndices) throw()
+    {
+        const int numChannels = unit.getNumChannels();
+
+        if (numChannels == 1)
+        {
+            inputIndices.add (collect (unit.atUnchecked (0).getInternal(), channel));
+        }
+        else
+        {
+            for (int i = 0; i < numChannels; ++i)
+                inputIndices.add (collect (unit.atUnchecked (i).getInternal(), i));
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Renders a graph from a flat list of its channels.
+ This is for rendering graphs made of many cheap units where the cost of 
+ pulling the graph each block is significant. Use process() instead of 
+ calling process() on the root unit and call compile() from another thread. 
+ See ExecutionPlanInternal for which channels are added to the plan.
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class ExecutionPlanBase : public SmartPointerContainer< ExecutionPlanInternal<SampleType> >
+{
+public:
+    typedef ExecutionPlanInternal<SampleType>   Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef UnitBase<SampleType>                UnitType;
+
+    ExecutionPlanBase() throw()
+    :   Base (new Internal())
+    {
+    }
+
+    explicit ExecutionPlanBase (UnitType const& root) throw()
+    :   Base (new Internal())
+    {
+        this->getInternal()->setRoot (root);
+    }
+
+    ExecutionPlanBase (ExecutionPlanBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+
+    ExecutionPlanBase& operator= (ExecutionPlanBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+
+        return *this;
+	}
+
+    PLONK_INLINE_LOW void setRoot (UnitType const& root) throw()    { this->getInternal()->setRoot (root); }
+    PLONK_INLINE_LOW const UnitType& getRoot() const throw()        { return this->getInternal()->getRoot(); }
+    PLONK_INLINE_LOW void compile() throw()                         { this->getInternal()->compile(); }
+    PLONK_INLINE_LOW void invalidate() throw()                      { this->getInternal()->invalidate(); }
+    PLONK_INLINE_LOW void process (ProcessInfo& info) throw()       { this->getInternal()->process (info); }
+    PLONK_INLINE_LOW void release() throw()                         { this->getInternal()->release(); }
+    PLONK_INLINE_LOW int getNumEntries() const throw()              { return this->getInternal()->getNumEntries(); }
+};
+
+typedef ExecutionPlanBase<PLONK_TYPE_DEFAULT>   ExecutionPlan;
+
+
+#endif // PLONK_EXECUTIONPLAN_H
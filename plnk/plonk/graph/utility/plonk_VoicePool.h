@@ -0,0 +1,510 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_VOICEPOOL_H
+#define PLONK_VOICEPOOL_H
+
+#include "../plonk_GraphForwardDeclarations.h"
+#include "../../core/plonk_SmartPointer.h"
+#include "../../core/plonk_SmartPointerContainer.h"
+#include "../../core/plonk_Thread.h"
+#include "../../core/plonk_Lock.h"
+#include "../../containers/plonk_RingQueue.h"
+
+
+/** One pre-built voice held by a VoicePool.
+ This holds the voice's unit, the parameter variables the unit was built from
+ and a flat list of every channel in the unit's graph so the whole graph can
+ be reset without searching it again. */
+template<class SampleType>
+class VoiceInternal : public SmartPointer
+{
+public:
+    typedef ChannelBase<SampleType>                 ChannelType;
+    typedef ChannelInternalBase<SampleType>         InternalBase;
+    typedef ProxyChannelInternal<SampleType>        ProxyInternal;
+    typedef UnitBase<SampleType>                    UnitType;
+    typedef NumericalArray2D<ChannelType,UnitType>  UnitsType;
+    typedef Variable<SampleType>                    VariableType;
+    typedef NumericalArray<VariableType>            VariablesType;
+
+    VoiceInternal (UnitType const& unitToUse, VariablesType const& parametersToUse) throw()
+    :   unit (unitToUse),
+        parameters (parametersToUse)
+    {
+        const int numChannels = unit.getNumChannels();
+        int i;
+
+        for (i = 0; i < numChannels; ++i)
+            collect (unit.atUnchecked (i).getInternal());
+
+        const int numInternals = internals.length();
+        InternalBase** const internalArray = internals.getArray();
+
+        for (i = 0; i < numInternals; ++i)
+            internalArray[i]->markInitialState();
+
+        // the counts while the voice is only referenced by the pool
+        for (i = 0; i < numChannels; ++i)
+            idleRefCounts.add (unit.atUnchecked (i).getInternal()->getRefCount());
+    }
+
+    ~VoiceInternal()
+    {
+    }
+
+    /** Returns every channel in the graph to its state when the voice was built. */
+    void reset() throw()
+    {
+        const int numInternals = internals.length();
+        InternalBase** const internalArray = internals.getArray();
+
+        for (int i = 0; i < numInternals; ++i)
+            internalArray[i]->resetState();
+    }
+
+    /** Returns @c true if nothing outside the pool refers to this voice's unit or its channels. */
+    bool isIdle() const throw()
+    {
+        if ((this->getRefCount() > 1) || (unit.getInternal()->getRefCount() > 1))
+            return false;
+
+        const int numChannels = unit.getNumChannels();
+        const int* const idleRefCountArray = idleRefCounts.getArray();
+
+        for (int i = 0; i < numChannels; ++i)
+            if (unit.atUnchecked (i).getInternal()->getRefCount() > idleRefCountArray[i])
+                return false;
+
+        return true;
+    }
+
+    friend class VoiceBase<SampleType>;
+
+private:
+    UnitType unit;
+    VariablesType parameters;
+    ObjectArray<InternalBase*> internals;
+    IntArray idleRefCounts;
+
+    void collect (InternalBase* internal) throw()
+    {
+        if ((internal == 0) || internal->isNull() || internal->isConstant() || internals.contains (internal))
+            return;
+
+        internals.add (internal);
+
+        if (internal->isProxy())
+            collect (static_cast<ProxyInternal*> (internal)->getOwner().getInternal());
+
+        DynamicArray inputs = internal->getInputs().getValues();
+        const int numInputs = inputs.length();
+
+        for (int i = 0; i < numInputs; ++i)
+        {
+            Dynamic& input = inputs.atUnchecked (i);
+            const int typeCode = input.getTypeCode();
+            int j;
+
+            if (typeCode == TypeUtility<UnitType>::getTypeCode())
+            {
+                UnitType& inputUnit = input.asUnchecked<UnitType>();
+
+                for (j = 0; j < inputUnit.getNumChannels(); ++j)
+                    collect (inputUnit.atUnchecked (j).getInternal());
+            }
+            else if (typeCode == TypeUtility<UnitsType>::getTypeCode())
+            {
+                UnitsType& inputUnits = input.asUnchecked<UnitsType>();
+
+                for (j = 0; j < inputUnits.length(); ++j)
+                {
+                    UnitType& inputUnit = inputUnits.atUnchecked (j);
+
+                    for (int k = 0; k < inputUnit.getNumChannels(); ++k)
+                        collect (inputUnit.atUnchecked (k).getInternal());
+                }
+            }
+            else if (typeCode == TypeUtility<ChannelType>::getTypeCode())
+            {
+                collect (input.asUnchecked<ChannelType>().getInternal());
+            }
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** A pre-built voice obtained from a VoicePool.
+ Set the parameters and add getUnit() to a mixer (e.g., a QueueMixer with
+ purging enabled). Once the voice is released and the mixer drops the unit
+ it is returned to the pool rather than deleted.
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class VoiceBase : public SmartPointerContainer< VoiceInternal<SampleType> >
+{
+public:
+    typedef VoiceInternal<SampleType>           Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef UnitBase<SampleType>                UnitType;
+    typedef Variable<SampleType>                VariableType;
+    typedef NumericalArray<VariableType>        VariablesType;
+
+    VoiceBase() throw()
+    :   Base (static_cast<Internal*> (0))
+    {
+    }
+
+    explicit VoiceBase (Internal* internalToUse) throw()
+    :   Base (internalToUse)
+    {
+    }
+
+    VoiceBase (VoiceBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+
+    VoiceBase& operator= (VoiceBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+
+        return *this;
+	}
+
+    PLONK_INLINE_LOW const UnitType& getUnit() const throw()                { return this->getInternal()->unit; }
+    PLONK_INLINE_LOW const VariablesType& getParameters() const throw()     { return this->getInternal()->parameters; }
+    PLONK_INLINE_LOW int getNumParameters() const throw()                   { return this->getInternal()->parameters.length(); }
+
+    PLONK_INLINE_LOW void setParameter (const int index, SampleType const& value) throw()
+    {
+        this->getInternal()->parameters.atUnchecked (index).setValue (value);
+    }
+
+    PLONK_INLINE_LOW void reset() throw()                                   { this->getInternal()->reset(); }
+    PLONK_INLINE_LOW bool isIdle() const throw()                            { return this->getInternal()->isIdle(); }
+};
+
+//------------------------------------------------------------------------------
+
+template<class SampleType>
+class VoicePoolInternal : public SmartPointer
+{
+public:
+    typedef VoiceBase<SampleType>                   VoiceType;
+    typedef VoiceInternal<SampleType>               VoiceInternalType;
+    typedef UnitBase<SampleType>                    UnitType;
+    typedef Variable<SampleType>                    VariableType;
+    typedef NumericalArray<VariableType>            VariablesType;
+    typedef RingQueue<VoiceInternalType*>           VoiceQueue;     // each holds a reference taken by the pool
+    typedef UnitType (*Function) (VariablesType const& parameters, Dynamic const& userData);
+
+    class Worker : public Threading::Thread
+    {
+    public:
+        Worker (VoicePoolInternal* o) throw()
+        :   Threading::Thread ("plonk::VoicePool::Worker"),
+            owner (o)
+        {
+        }
+
+        ResultCode run() throw()
+        {
+            if (owner->priority >= 0)
+                setPriority (owner->priority);
+
+            while (!getShouldExit())
+            {
+                owner->recycleIdle();
+                owner->fill();
+                
+                // voices become idle without telling the pool so poll while any are in use
+                if (owner->numActive.getValue() > 0)
+                    owner->event.wait (0.002);
+                else
+                    owner->event.wait();
+            }
+
+            return PlankResult_OK;
+        }
+
+    private:
+        VoicePoolInternal* owner;
+    };
+
+    VoicePoolInternal (Function functionToUse,
+                       const int numParametersToUse,
+                       const int numVoicesToUse,
+                       Dynamic const& userDataToUse,
+                       const int priorityToUse,
+                       const int maxActiveToUse) throw()
+    :   function (functionToUse),
+        userData (userDataToUse),
+        numParameters (numParametersToUse),
+        numVoices (numVoicesToUse),
+        priority (priorityToUse),
+        maxActive (maxActiveToUse),
+        available (numVoicesToUse, true),
+        acquired (maxActiveToUse, true),
+        event (Lock::SemaphoreLock),
+        worker (this)
+    {
+        plonk_assert (function != 0);
+        plonk_assert (numVoices > 0);
+        plonk_assert (maxActive > 0);
+
+        worker.start();
+    }
+
+    ~VoicePoolInternal()
+    {
+        worker.setShouldExit();
+        event.signal();
+        worker.wait();
+
+        VoiceInternalType* internal;
+
+        while (available.pop (internal))
+            internal->decrementRefCount();
+
+        while (acquired.pop (internal))
+            internal->decrementRefCount();
+
+        for (int i = 0; i < inUse.length(); ++i)
+            inUse.atUnchecked (i)->decrementRefCount();
+    }
+
+    /** Takes a reset voice from the pool and marks it active.
+     This does not allocate or block. If no voice is ready, or maxActive voices 
+     are already active, a null voice is returned and the miss is counted. */
+    VoiceType acquire() throw()
+    {
+        VoiceInternalType* internal;
+
+        // only acquire() pushes to acquired so this check can't be overtaken
+        if ((numActive.getValue() >= maxActive) || !available.pop (internal))
+        {
+            ++numMisses;
+            event.signal();
+            return VoiceType();
+        }
+
+        // the pool's reference moves to acquired, the caller gets another
+        const VoiceType voice (internal);
+        const bool pushed = acquired.push (internal);
+        plonk_assert (pushed);
+#ifndef PLONK_DEBUG
+        (void)pushed;
+#endif
+        ++numActive;
+        event.signal();
+
+        return voice;
+    }
+
+    /** Builds voices on the calling thread until the pool is full. */
+    void fill() throw()
+    {
+        while (available.length() < numVoices)
+        {
+            VariablesType parameters;
+
+            for (int i = 0; i < numParameters; ++i)
+                parameters.add (VariableType (SampleType (0)));
+
+            const UnitType unit = function (parameters, userData);
+            VoiceInternalType* const internal = new VoiceInternalType (unit, parameters);
+            internal->incrementRefCount();
+            
+            if (!available.push (internal))
+            {
+                internal->decrementRefCount();
+                break;
+            }
+            
+            ++numVoicesBuilt;
+        }
+    }
+
+    /** Resets active voices that are no longer referenced outside the pool and returns them to the pool.
+     This is called on the worker thread so clearing the voices' delay lines doesn't cost the audio thread. */
+    void recycleIdle() throw()
+    {
+        VoiceInternalType* internal;
+
+        while (acquired.pop (internal))
+            inUse.add (internal);
+
+        for (int i = inUse.length(); --i >= 0;)
+        {
+            internal = inUse.atUnchecked (i);
+            
+            if (internal->isIdle())
+            {
+                internal->reset();
+                
+                // the pool is already full if fill() replaced this voice
+                if (!available.push (internal))
+                    internal->decrementRefCount();
+                
+                inUse.remove (i);
+                --numActive;
+            }
+        }
+    }
+
+    /** Blocks until the pool is full or the timeout expires, a negative timeout waits indefinitely. */
+    bool waitUntilReady (const double timeout) throw()
+    {
+        plonk_assert (!Threading::currentThreadIsAudioThread());
+
+        const double endTime = (timeout < 0.0) ? 0.0 : pl_TimeNow() + timeout;
+
+        while (available.length() < numVoices)
+        {
+            if ((timeout >= 0.0) && (pl_TimeNow() >= endTime))
+                return false;
+
+            event.signal();
+            Threading::sleep (0.001);
+        }
+
+        return true;
+    }
+
+    PLONK_INLINE_LOW int getNumAvailable() throw()                  { return available.length(); }
+    PLONK_INLINE_LOW int getNumActive() const throw()               { return numActive.getValue(); }
+    PLONK_INLINE_LOW int getNumVoicesBuilt() const throw()          { return numVoicesBuilt.getValue(); }
+    PLONK_INLINE_LOW int getNumMisses() const throw()               { return numMisses.getValue(); }
+
+    friend class Worker;
+
+private:
+    Function function;
+    Dynamic userData;
+    const int numParameters;
+    const int numVoices;
+    const int priority;
+    const int maxActive;
+    VoiceQueue available;
+    VoiceQueue acquired;                            // passes acquired voices to the worker
+    ObjectArray<VoiceInternalType*> inUse;          // only used by the worker
+    AtomicInt numActive;
+    AtomicInt numVoicesBuilt;
+    AtomicInt numMisses;
+    Lock event;
+    Worker worker;
+};
+
+//------------------------------------------------------------------------------
+
+/** A pool of pre-built voices for fast polyphonic voice instantiation.
+ Building a voice graph allocates every channel, input dictionary and output
+ buffer in the graph. Instead a VoicePool builds voices ahead of time on a
+ background thread using a function with the signature:
+
+ @code
+ FloatUnit myVoice (FloatVariables const& parameters, Dynamic const& userData);
+ @endcode
+
+ The function is passed the number of parameter variables given to the pool,
+ these should be used as the voice's inputs. acquire() then takes a built voice
+ and returns it without allocating or blocking. Once the voice has been 
+ released and its unit is no longer used (e.g., it has expired and been purged
+ from a QueueMixer) the worker thread resets each channel in its graph to the
+ state it had when the voice was built and returns it to the pool rather than 
+ deleting it.
+
+ Channels are reset by restoring a copy of their Data that is only made for
+ pooled voices. Delays and FDNs also clear their delay lines. Channels that 
+ keep processing state elsewhere (e.g., file readers) are not fully reset so 
+ are not suitable for use in pooled voices.
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class VoicePoolBase : public SmartPointerContainer< VoicePoolInternal<SampleType> >
+{
+public:
+    typedef VoicePoolInternal<SampleType>       Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef typename Internal::Function         Function;
+    typedef typename Internal::VoiceType        VoiceType;
+
+    /** Create a pool.
+     @param function    The function that builds each voice.
+     @param numParameters The number of parameter variables to pass to the function.
+     @param numVoices   The number of voices to keep ready in the pool.
+     @param userData    Passed to the function.
+     @param priority    The priority of the worker thread or -1 for the default. 
+     @param maxActive   The number of voices that may be active at once. */
+    VoicePoolBase (Function function,
+                   const int numParameters,
+                   const int numVoices,
+                   Dynamic const& userData = Dynamic::getNull(),
+                   const int priority = -1,
+                   const int maxActive = 256) throw()
+    :   Base (new Internal (function, numParameters, numVoices, userData, priority, maxActive))
+    {
+    }
+
+    VoicePoolBase (VoicePoolBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+
+    VoicePoolBase& operator= (VoicePoolBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+
+        return *this;
+	}
+
+    PLONK_INLINE_LOW VoiceType acquire() throw()                            { return this->getInternal()->acquire(); }
+    PLONK_INLINE_LOW bool waitUntilReady (const double timeout = -1.0) throw() { return this->getInternal()->waitUntilReady (timeout); }
+    PLONK_INLINE_LOW int getNumAvailable() const throw()                    { return this->getInternal()->getNumAvailable(); }
+    PLONK_INLINE_LOW int getNumActive() const throw()                       { return this->getInternal()->getNumActive(); }
+    PLONK_INLINE_LOW int getNumVoicesBuilt() const throw()                  { return this->getInternal()->getNumVoicesBuilt(); }
+    PLONK_INLINE_LOW int getNumMisses() const throw()                       { return this->getInternal()->getNumMisses(); }
+};
+
+typedef VoiceBase<PLONK_TYPE_DEFAULT>       Voice;
+typedef VoicePoolBase<PLONK_TYPE_DEFAULT>   VoicePool;
+
+
+#endif // PLONK_VOICEPOOL_H
@@ -0,0 +1,129 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_JACKAUDIOHOST_H
+#define PLONK_JACKAUDIOHOST_H
+
+#include <jack/jack.h>
+
+BEGIN_PLONK_NAMESPACE
+
+/** An audio host for the JACK Audio Connection Kit.
+ The host registers its own JACK ports (in_1, in_2 ... and out_1, out_2 ...)
+ and renders in JACK's real-time process callback. The port buffers are
+ passed to AudioHostBase as they are so the graph renders straight into them
+ when JACK's buffer size is a multiple of the graph's (see 
+ AudioHostBase::setUseDirectInputs() to skip copying the inputs to the busses).
+ 
+ The sample rate and buffer size are JACK's, the preferred host values are
+ ignored. The host follows changes to either while running. Xruns reported
+ by JACK are counted, see getNumXruns().
+ 
+ The server is not started by the host. For testing without audio hardware
+ run the dummy driver, e.g., @c jackd @c -d @c dummy @c -r @c 48000 @c -p @c 256
+ and use setAutoConnect (false) if the dummy driver has no physical ports.
+ 
+ Only float samples are supported as this is JACK's native format. */
+template<class SampleType>
+class JackAudioHostBase : public AudioHostBase<SampleType>
+{
+public:
+    typedef NumericalArray<SampleType*>            BufferArray;
+    typedef NumericalArray<const SampleType*>      ConstBufferArray;
+    typedef ObjectArray<jack_port_t*>              PortArray;
+
+    /** Default constructor. */
+    JackAudioHostBase() throw();
+    ~JackAudioHostBase();
+    
+    Text getHostName() const throw();
+    Text getNativeHostName() const throw();
+    Text getInputName() const throw();
+    Text getOutputName() const throw();
+    double getCpuUsage() const throw();
+
+    void startHost() throw();
+    void stopHost() throw();
+    
+    /** Set the JACK client name, this must be called before startHost(). */
+    void setClientName (Text const& name) throw()               { clientName = name; }
+    Text getClientName() const throw()                          { return clientName; }
+    
+    /** Connect the ports to the physical ports when the host starts (the default). */
+    void setAutoConnect (const bool state) throw()              { autoConnect = state; }
+    bool getAutoConnect() const throw()                         { return autoConnect; }
+    
+    /** The number of xruns JACK has reported since the host started. */
+    int getNumXruns() const throw()                             { return numXruns.getValue(); }
+    
+    /** The delay in microseconds JACK reported with the last xrun. */
+    float getLastXrunDelay() const throw()                      { return lastXrunDelay; }
+    
+    int callback (jack_nframes_t numFrames) throw();
+    int bufferSizeChanged (jack_nframes_t numFrames) throw();
+    int sampleRateChanged (jack_nframes_t sampleRate) throw();
+    int xrun() throw();
+    void shutdown() throw();
+                
+private:
+    jack_client_t* client;
+    PortArray inputPorts;
+    PortArray outputPorts;
+    Text clientName;
+    bool autoConnect;
+    AtomicInt numXruns;
+    float lastXrunDelay;
+    AtomicInt serverHasShutdown;
+    
+    void connectPhysicalPorts() throw();
+};
+
+class JackAudioHost : public JackAudioHostBase<float>
+{
+public:
+    JackAudioHost() throw();
+    ~JackAudioHost();
+};
+
+#define PLANK_INLINING_FUNCTIONS 1
+#include "plonk_JackAudioHostInline.h"
+#undef PLANK_INLINING_FUNCTIONS
+
+END_PLONK_NAMESPACE
+
+#endif  // PLONK_JACKAUDIOHOST_H
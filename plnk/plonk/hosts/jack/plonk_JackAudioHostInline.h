@@ -0,0 +1,320 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#if PLANK_INLINING_FUNCTIONS
+
+template<class SampleType>
+static int jackProcessCallback (jack_nframes_t numFrames, void* userData)
+{
+    JackAudioHostBase<SampleType>* host = static_cast<JackAudioHostBase<SampleType>*> (userData);
+    return host->callback (numFrames);
+}
+
+template<class SampleType>
+static int jackBufferSizeCallback (jack_nframes_t numFrames, void* userData)
+{
+    JackAudioHostBase<SampleType>* host = static_cast<JackAudioHostBase<SampleType>*> (userData);
+    return host->bufferSizeChanged (numFrames);
+}
+
+template<class SampleType>
+static int jackSampleRateCallback (jack_nframes_t sampleRate, void* userData)
+{
+    JackAudioHostBase<SampleType>* host = static_cast<JackAudioHostBase<SampleType>*> (userData);
+    return host->sampleRateChanged (sampleRate);
+}
+
+template<class SampleType>
+static int jackXrunCallback (void* userData)
+{
+    JackAudioHostBase<SampleType>* host = static_cast<JackAudioHostBase<SampleType>*> (userData);
+    return host->xrun();
+}
+
+template<class SampleType>
+static void jackShutdownCallback (void* userData)
+{
+    JackAudioHostBase<SampleType>* host = static_cast<JackAudioHostBase<SampleType>*> (userData);
+    host->shutdown();
+}
+
+//------------------------------------------------------------------------------
+
+template<class SampleType>
+JackAudioHostBase<SampleType>::JackAudioHostBase() throw() 
+:   client (0),
+    clientName ("plonk"),
+    autoConnect (true),
+    lastXrunDelay (0.f)
+{
+    // JACK decides these, they are updated when the host starts
+    this->setPreferredHostBlockSize (256);
+    this->setPreferredGraphBlockSize (128);
+    this->setPreferredHostSampleRate (48000.0);
+    this->setNumInputs (1);
+    this->setNumOutputs (2);
+}
+
+template<class SampleType>
+JackAudioHostBase<SampleType>::~JackAudioHostBase()
+{
+    if (client)
+        this->stopHost();
+}
+
+template<class SampleType>
+Text JackAudioHostBase<SampleType>::getHostName() const throw()
+{
+    return "JACK (" + TypeUtility<SampleType>::getTypeName() + ")";
+}
+
+template<class SampleType>
+Text JackAudioHostBase<SampleType>::getNativeHostName() const throw()
+{
+    return "JACK";
+}
+
+template<class SampleType>
+Text JackAudioHostBase<SampleType>::getInputName() const throw()
+{
+    return client ? Text (jack_get_client_name (client)) : clientName;
+}
+
+template<class SampleType>
+Text JackAudioHostBase<SampleType>::getOutputName() const throw()
+{
+    return client ? Text (jack_get_client_name (client)) : clientName;
+}
+
+template<class SampleType>
+double JackAudioHostBase<SampleType>::getCpuUsage() const throw()
+{
+    if (!client) return 0.0;
+    return jack_cpu_load (client) * 0.01;
+}
+
+template<class SampleType>
+void JackAudioHostBase<SampleType>::stopHost() throw()
+{
+    if (!client)
+        return;
+    
+    // after a shutdown the server has gone and only closing the client is valid
+    if (! serverHasShutdown.getValue())
+        jack_deactivate (client);
+    
+    jack_client_close (client); // also unregisters the ports
+    
+    client = 0;
+    inputPorts.clear();
+    outputPorts.clear();
+    
+    this->setIsRunning (false);
+    this->hostStopped();
+}
+
+template<class SampleType>
+void JackAudioHostBase<SampleType>::startHost() throw()
+{
+    if (TypeUtility<SampleType>::getTypeCode() != TypeCode::Float)
+    {
+        plonk_assertfalse;
+        return;
+    }
+    
+    jack_status_t status;
+    client = jack_client_open (clientName.getArray(), JackNoStartServer, &status);
+    
+    if (!client)
+    {
+        printf ("jackerror: could not open client '%s' (0x%x)\n", clientName.getArray(), (int)status);
+        return;
+    }
+    
+    numXruns = 0;
+    lastXrunDelay = 0.f;
+    serverHasShutdown = false;
+
+    jack_set_process_callback (client, jackProcessCallback<SampleType>, this);
+    jack_set_buffer_size_callback (client, jackBufferSizeCallback<SampleType>, this);
+    jack_set_sample_rate_callback (client, jackSampleRateCallback<SampleType>, this);
+    jack_set_xrun_callback (client, jackXrunCallback<SampleType>, this);
+    jack_on_shutdown (client, jackShutdownCallback<SampleType>, this);
+    
+    const int numInputs = this->getNumInputs();
+    const int numOutputs = this->getNumOutputs();
+    int i;
+    
+    for (i = 0; i < numInputs; ++i)
+    {
+        const Text name = "in_" + Text (i + 1);
+        jack_port_t* const port = jack_port_register (client, name.getArray(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+        
+        if (!port)
+            printf ("jackerror: could not register port '%s'\n", name.getArray());
+        
+        inputPorts.add (port);
+    }
+    
+    for (i = 0; i < numOutputs; ++i)
+    {
+        const Text name = "out_" + Text (i + 1);
+        jack_port_t* const port = jack_port_register (client, name.getArray(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+        
+        if (!port)
+            printf ("jackerror: could not register port '%s'\n", name.getArray());
+        
+        outputPorts.add (port);
+    }
+    
+    if ((inputPorts.indexOf (0) >= 0) || (outputPorts.indexOf (0) >= 0))
+    {
+        this->stopHost();
+        return;
+    }
+    
+    this->setPreferredHostSampleRate ((double)jack_get_sample_rate (client));
+    this->setPreferredHostBlockSize ((int)jack_get_buffer_size (client));
+    
+    this->startHostInternal();
+    
+    if (jack_activate (client) != 0)
+    {
+        printf ("jackerror: could not activate client '%s'\n", clientName.getArray());
+        this->stopHost();
+        return;
+    }
+    
+    if (autoConnect)
+        connectPhysicalPorts();
+}
+
+template<class SampleType>
+void JackAudioHostBase<SampleType>::connectPhysicalPorts() throw()
+{
+    int i;
+    
+    // physical capture ports are outputs from JACK's point of view
+    const char** capturePorts = jack_get_ports (client, 0, JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | JackPortIsOutput);
+    
+    if (capturePorts)
+    {
+        for (i = 0; (i < inputPorts.length()) && capturePorts[i]; ++i)
+            jack_connect (client, capturePorts[i], jack_port_name (inputPorts.atUnchecked (i)));
+        
+        jack_free (capturePorts);
+    }
+    
+    const char** playbackPorts = jack_get_ports (client, 0, JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | JackPortIsInput);
+    
+    if (playbackPorts)
+    {
+        for (i = 0; (i < outputPorts.length()) && playbackPorts[i]; ++i)
+            jack_connect (client, jack_port_name (outputPorts.atUnchecked (i)), playbackPorts[i]);
+        
+        jack_free (playbackPorts);
+    }
+}
+
+template<class SampleType>
+int JackAudioHostBase<SampleType>::callback (jack_nframes_t numFrames) throw()
+{
+    this->setPreferredHostBlockSize ((int)numFrames);
+    
+    ConstBufferArray& inputs = this->getInputs();
+    BufferArray& outputs = this->getOutputs();
+
+    const int numInputs = inputs.length();
+    const int numOutputs = outputs.length();
+    
+    int i;
+    
+    // the port buffers go straight to the host, they are only valid during this callback
+    for (i = 0; i < numInputs; ++i)
+    {
+        const SampleType* const inputChannel = static_cast<const SampleType*> (jack_port_get_buffer (inputPorts.atUnchecked (i), numFrames));
+        inputs.atUnchecked (i) = inputChannel;
+    }
+    
+    for (i = 0; i < numOutputs; ++i)
+    {
+        SampleType* const outputChannel = static_cast<SampleType*> (jack_port_get_buffer (outputPorts.atUnchecked (i), numFrames));
+        outputs.atUnchecked (i) = outputChannel;
+    }
+    
+    this->process();
+    
+    return 0;
+}
+
+template<class SampleType>
+int JackAudioHostBase<SampleType>::bufferSizeChanged (jack_nframes_t numFrames) throw()
+{
+    // JACK doesn't call this while the process callback is running
+    this->hostBlockSizeChanged ((int)numFrames);
+    return 0;
+}
+
+template<class SampleType>
+int JackAudioHostBase<SampleType>::sampleRateChanged (jack_nframes_t sampleRate) throw()
+{
+    this->setPreferredHostSampleRate ((double)sampleRate);
+    
+    if (this->getIsRunning() && (SampleRate::getDefault().getValue() != (double)sampleRate))
+        SampleRate::getDefault().setValue ((double)sampleRate);
+    
+    return 0;
+}
+
+template<class SampleType>
+int JackAudioHostBase<SampleType>::xrun() throw()
+{
+    lastXrunDelay = jack_get_xrun_delayed_usecs (client);
+    ++numXruns;
+    return 0;
+}
+
+template<class SampleType>
+void JackAudioHostBase<SampleType>::shutdown() throw()
+{
+    // only async-signal safe work is allowed here, stopHost() closes the client later
+    serverHasShutdown = true;
+    this->setIsRunning (false);
+}
+
+#endif // PLANK_INLINING_FUNCTIONS
@@ -57,20 +57,35 @@ public:
     typedef PLONK_BUSARRAYBASETYPE<BusType>     BussesType;
     typedef Dictionary<Dynamic>                 OptionDictionary;
     typedef NumericalArray<SampleType>          BufferType;
+    typedef ObjectArray<BufferType>             BuffersType;
+    typedef ExecutionPlanBase<SampleType>       ExecutionPlanType;
+    typedef ChannelInternalBase<SampleType>     ChannelInternalType;
     
     /** Constructor */
     AudioHostBase() throw()
     :   preferredHostSampleRate (0.0),
         preferredHostBlockSize (0),
         preferredGraphBlockSize (0),
+        useExecutionPlan (false),
+        useDirectInputs (false),
         isRunning (false),
-        isPaused (false)
+        isPaused (false),
+        fifoChunkSize (0),
+        fifoInputStart (0),
+        numFifoInputFrames (0),
+        fifoOutputStart (0),
+        numFifoOutputFrames (0),
+        baseLatency (0),
+        minSpareOutputFrames (0),
+        numFramesSinceDrain (0),
+        latencyDrainFrames (0)
     { 
     }
         
     /** Destructor */
     virtual ~AudioHostBase() 
     {
+        releaseDirectOutputs();
     }
         
     /** Determine whether the audio device is running. */
@@ -106,9 +121,43 @@ public:
     PLONK_INLINE_LOW int getPreferredGraphBlockSize() const throw() { return preferredGraphBlockSize; }
         
     /** Set the graph's preferred block size.
+     This may be any size, if the host's blocks are not a multiple of it the
+     host and graph are joined by a FIFO which adds latency (see getLatency()).
      This must be called before startHost() to have any effect. */
     PLONK_INLINE_LOW void setPreferredGraphBlockSize (const int newSize) throw() {  preferredGraphBlockSize = newSize; }
     
+    /** Get the number of frames of latency added between the host and the graph.
+     This is 0 when the host's blocks are a multiple of the graph's block
+     size, otherwise it starts at the graph block size less the greatest
+     common divisor of the two block sizes. If the host later calls back with
+     a block size that would need more this grows, up to one less than the
+     graph block size. Once the extra latency has gone unused for about a 
+     second it is removed again, back down to the starting latency. */
+    PLONK_INLINE_LOW int getLatency() const throw() { return latency.getValue(); }
+    
+    /** Determine whether the graph is rendered through an ExecutionPlan. */
+    PLONK_INLINE_LOW bool getUseExecutionPlan() const throw() { return useExecutionPlan; }
+    
+    /** Render the graph through an ExecutionPlan rather than pulling it each block.
+     This must be called before startHost() to have any effect. */
+    PLONK_INLINE_LOW void setUseExecutionPlan (const bool state) throw() { useExecutionPlan = state; }
+    
+    /** Determine whether the device's input buffers are lent to the input busses. */
+    PLONK_INLINE_LOW bool getUseDirectInputs() const throw() { return useDirectInputs; }
+    
+    /** Lend the device's input buffers to the input busses rather than copying them.
+     BusRead units on the audio thread then copy the device's samples straight
+     to their outputs. The input is not copied to the busses so it can't be read from 
+     other threads or later than the block it arrived in. This only applies 
+     when the host's block size is a multiple of the graph's. 
+     This must be called before startHost() to have any effect. */
+    PLONK_INLINE_LOW void setUseDirectInputs (const bool state) throw() { useDirectInputs = state; }
+    
+    /** Compile the execution plan again, it is used from the start of the next block.
+     Call this after changing the structure of the graph while using an ExecutionPlan.
+     This allocates so must not be called from the audio thread. */
+    PLONK_INLINE_LOW void invalidateExecutionPlan() throw() { executionPlan.invalidate(); }
+    
     /** Set the number of audio inputs required.
      This must be called before startHost() to have any effect. */
     void setNumInputs (const int numInputs) throw();
@@ -182,31 +231,60 @@ protected:
         const int numOutputs = this->outputs.length();
         plonk_assert (this->busses.length() == numInputs);
 
-        int blockRemain = preferredHostBlockSize;        
+        const int hostBlockSize = preferredHostBlockSize;        
         const int graphBlockSize = BlockSize::getDefault().getValue();
         
-        // must do more checks in case the block sizes are not compatible on this run
-        
-
-        // push all the input samples for this hardware frame onto the busses
-        for (i = 0; i < numInputs; ++i)
+        if (this->outputUnit.isNull())
         {
-            BusType& bus = this->busses.atUnchecked (i);
-            bus.getWriteBlockSize().setValue (blockRemain);
-            bus.write (this->info.getTimeStamp(), blockRemain, this->inputs.atUnchecked (i));
-        }
+            for (i = 0; i < numInputs; ++i)
+            {
+                BusType& bus = this->busses.atUnchecked (i);
+                bus.write (this->info.getTimeStamp(), hostBlockSize, this->inputs.atUnchecked (i));
+            }
 
-        // write the hardware frame in possible smaller blocks
-        if (this->outputUnit.isNotNull())
+            for (i = 0; i < numOutputs; ++i)
+                BufferType::zeroData (this->outputs.atUnchecked (i), hostBlockSize);
+            
+            this->info.offsetTimeStamp (SampleRate::getDefault().getSampleDurationInTicks() * hostBlockSize);
+        }
+        else if ((latency.getValue() == 0) && ((hostBlockSize % graphBlockSize) == 0))
         {
+            int blockRemain = hostBlockSize;
+            
+            // push all the input samples for this hardware frame onto the busses
+            for (i = 0; i < numInputs; ++i)
+            {
+                BusType& bus = this->busses.atUnchecked (i);
+                
+                // the busses share the default BlockSize as their write block size so leave it alone
+                if (useDirectInputs)
+                    bus.setDirect (this->info.getTimeStamp(), blockRemain, this->inputs.atUnchecked (i));
+                else
+                    bus.write (this->info.getTimeStamp(), blockRemain, this->inputs.atUnchecked (i));
+            }
+            
+            ChannelInternalType** const directOutputArray = directOutputs.getArray();
+            
+            // write the hardware frame in possible smaller blocks
             while (blockRemain > 0)
             {            
-                this->outputUnit.process (this->info);
+                // output channels that can render straight to the device do so
+                for (i = 0; i < numOutputs; ++i)
+                {
+                    if (directOutputArray[i] != 0)
+                        referOutputTo (directOutputArray[i], this->outputs.atUnchecked (i), graphBlockSize);
+                }
+                
+                processGraph();
                 
                 for (i = 0; i < numOutputs; ++i)
                 {
-                    const SampleType* const unitOutput = this->outputUnit.getOutputSamples (i);
-                    BufferType::copyData (this->outputs.atUnchecked (i), unitOutput, graphBlockSize);   
+                    if (directOutputArray[i] == 0)
+                    {
+                        const SampleType* const unitOutput = this->outputUnit.getOutputSamples (i);
+                        BufferType::copyData (this->outputs.atUnchecked (i), unitOutput, graphBlockSize);   
+                    }
+                    
                     this->outputs.atUnchecked (i) += graphBlockSize;
                 }
                 
@@ -214,15 +292,28 @@ protected:
                 
                 blockRemain -= graphBlockSize;
             }
-        }
-        else if (numOutputs > 0)
-        {
+            
+            // the device's buffers are only valid during the callback
             for (i = 0; i < numOutputs; ++i)
-                BufferType::zeroData (this->outputs.atUnchecked (i), blockRemain);
+            {
+                if (directOutputArray[i] != 0)
+                    referOutputTo (directOutputArray[i], directOutputHomes.atUnchecked (i).getArray(), graphBlockSize);
+            }
             
-            this->info.offsetTimeStamp (SampleRate::getDefault().getSampleDurationInTicks() * blockRemain);
+            if (useDirectInputs)
+            {
+                for (i = 0; i < numInputs; ++i)
+                    this->busses.atUnchecked (i).clearDirect();
+            }
+        }
+        else
+        {
+            processFifo (hostBlockSize, graphBlockSize);
         }
         
+        // objects released during the callback are freed in the background
+        ObjectMemoryDeferFree::flushCurrentThread();
+        
 #if PLONK_DEBUG
         // null the pointers to cause crash if buffers are not updated each HW block
         this->inputs.zero();
@@ -230,11 +321,234 @@ protected:
 #endif
     }
     
+    /** Processes a host block of any size through the FIFOs. @internal */
+    void processFifo (const int hostBlockSize, const int graphBlockSize) throw()
+    {
+        const int numInputs = this->inputs.length();
+        const int numOutputs = this->outputs.length();
+        const int inputFifoSize = numInputs > 0 ? inputFifos.atUnchecked (0).length() : 0;
+        const int outputFifoSize = numOutputs > 0 ? outputFifos.atUnchecked (0).length() : 0;
+        int i, done = 0;
+        
+        // blocks larger than the FIFOs were made for are split
+        while (done < hostBlockSize)
+        {
+            const int count = plonk::min (hostBlockSize - done, fifoChunkSize);
+            
+            for (i = 0; i < numInputs; ++i)
+                writeToFifo (inputFifos.atUnchecked (i).getArray(), inputFifoSize, 
+                             wrapFifo (fifoInputStart + numFifoInputFrames, inputFifoSize),
+                             this->inputs.atUnchecked (i) + done, count);
+            
+            numFifoInputFrames += count;
+            
+            while (numFifoInputFrames >= graphBlockSize)
+            {
+                // the input FIFO is a whole number of graph blocks so these never wrap
+                for (i = 0; i < numInputs; ++i)
+                {
+                    BusType& bus = this->busses.atUnchecked (i);
+                    bus.write (this->info.getTimeStamp(), graphBlockSize, inputFifos.atUnchecked (i).getArray() + fifoInputStart);
+                }
+                
+                fifoInputStart = wrapFifo (fifoInputStart + graphBlockSize, inputFifoSize);
+                numFifoInputFrames -= graphBlockSize;
+                
+                processGraph();
+                
+                for (i = 0; i < numOutputs; ++i)
+                    writeToFifo (outputFifos.atUnchecked (i).getArray(), outputFifoSize, 
+                                 wrapFifo (fifoOutputStart + numFifoOutputFrames, outputFifoSize),
+                                 this->outputUnit.getOutputSamples (i), graphBlockSize);
+                
+                numFifoOutputFrames += graphBlockSize;
+                
+                this->info.offsetTimeStamp (SampleRate::getDefault().getSampleDurationInTicks() * graphBlockSize);
+            }
+            
+            // an irregular block needs more than was buffered so add latency rather than drop out
+            if (numFifoOutputFrames < count)
+            {
+                const int shortfall = count - numFifoOutputFrames;
+                
+                fifoOutputStart = wrapFifo (fifoOutputStart - shortfall + outputFifoSize, outputFifoSize);
+                
+                for (i = 0; i < numOutputs; ++i)
+                    zeroFifo (outputFifos.atUnchecked (i).getArray(), outputFifoSize, fifoOutputStart, shortfall);
+                
+                numFifoOutputFrames += shortfall;
+                latency += shortfall;
+            }
+            
+            minSpareOutputFrames = plonk::min (minSpareOutputFrames, numFifoOutputFrames - count);
+            
+            for (i = 0; i < numOutputs; ++i)
+                readFromFifo (this->outputs.atUnchecked (i) + done, outputFifos.atUnchecked (i).getArray(), 
+                              outputFifoSize, fifoOutputStart, count);
+            
+            fifoOutputStart = wrapFifo (fifoOutputStart + count, outputFifoSize);
+            numFifoOutputFrames -= count;
+            done += count;
+        }
+        
+        numFramesSinceDrain += hostBlockSize;
+        
+        // latency that was added but not needed since the last check is dropped
+        if (numFramesSinceDrain >= latencyDrainFrames)
+        {
+            const int drain = plonk::min (minSpareOutputFrames, latency.getValue() - baseLatency);
+            
+            if (drain > 0)
+            {
+                fifoOutputStart = wrapFifo (fifoOutputStart + drain, outputFifoSize);
+                numFifoOutputFrames -= drain;
+                latency -= drain;
+            }
+            
+            minSpareOutputFrames = outputFifoSize;
+            numFramesSinceDrain = 0;
+        }
+    }
+    
+    /** @internal */
+    PLONK_INLINE_LOW void processGraph() throw()
+    {
+        if (useExecutionPlan)
+            this->executionPlan.process (this->info);
+        else
+            this->outputUnit.process (this->info);
+    }
+    
+    /** Points a channel's output at other samples, carrying over its last value. @internal */
+    static void referOutputTo (ChannelInternalType* const internal, SampleType* const samples, const int graphBlockSize) throw()
+    {
+        BufferType& outputBuffer = internal->getOutputBuffer();
+        samples[graphBlockSize - 1] = outputBuffer.last(); // for channels that read their previous output
+        outputBuffer.referTo (graphBlockSize, samples);
+    }
+    
+    /** Finds the output channels that can render straight into the device's buffers. @internal */
+    void initDirectOutputs() throw()
+    {
+        releaseDirectOutputs();
+        
+        const int numOutputs = this->outputs.length();
+        const int graphBlockSize = BlockSize::getDefault().getValue();
+        const int numChannels = outputUnit.getNumChannels();
+        
+        for (int i = 0; i < numOutputs; ++i)
+        {
+            ChannelInternalType* internal = 0;
+            
+            if (i < numChannels)
+            {
+                internal = outputUnit.atUnchecked (i).getInternal();
+                
+                // a channel can only render to one output
+                if (! canOutputDirect (internal, graphBlockSize))
+                    internal = 0;
+            }
+            
+            if (internal != 0)
+            {
+                // keep the channel's own buffer to give back in releaseDirectOutputs()
+                BufferType home = internal->getOutputBuffer();
+                internal->setOutputBuffer (BufferType::withArrayNoCopy (graphBlockSize, home.getArray()));
+                directOutputHomes.add (home);
+            }
+            else
+            {
+                directOutputHomes.add (BufferType());
+            }
+            
+            directOutputs.add (internal);
+        }
+    }
+    
+    /** Gives the output channels back their own buffers. @internal */
+    void releaseDirectOutputs() throw()
+    {
+        const int numDirectOutputs = directOutputs.length();
+        
+        for (int i = 0; i < numDirectOutputs; ++i)
+        {
+            ChannelInternalType* const internal = directOutputs.atUnchecked (i);
+            
+            if (internal != 0)
+            {
+                const SampleType value = internal->getOutputBuffer().last();
+                internal->removeExternalBuffer (directOutputHomes.atUnchecked (i));
+                internal->getOutputBuffer().last() = value;
+            }
+        }
+        
+        directOutputs.clear();
+        directOutputHomes.clear();
+    }
+    
+    /** @internal */
+    static bool canOutputDirect (const ChannelInternalType* internal, const int graphBlockSize) throw()
+    {
+        return (internal != 0) &&
+               ! internal->isNull() &&
+               ! internal->isConstant() &&
+               ! internal->isProxy() &&
+               ! internal->isProxyOwner() &&
+               ! internal->isUsingExternalBuffer() &&
+               internal->canUseExternalBuffer() &&
+               (internal->getBlockSize().getValue() == graphBlockSize) &&
+               (internal->getOutputBuffer().length() == graphBlockSize) &&
+               (internal->getOverlap().getValue() == 1.0);
+    }
+    
+    /** @internal */
+    static PLONK_INLINE_LOW int wrapFifo (const int position, const int fifoSize) throw()
+    {
+        return position >= fifoSize ? position - fifoSize : position;
+    }
+    
+    /** @internal */
+    static void writeToFifo (SampleType* const fifo, const int fifoSize, const int position, 
+                             const SampleType* const source, const int numSamples) throw()
+    {
+        const int first = plonk::min (numSamples, fifoSize - position);
+        BufferType::copyData (fifo + position, source, first);
+        
+        if (first < numSamples)
+            BufferType::copyData (fifo, source + first, numSamples - first);
+    }
+    
+    /** @internal */
+    static void readFromFifo (SampleType* const dest, const SampleType* const fifo, const int fifoSize, 
+                              const int position, const int numSamples) throw()
+    {
+        const int first = plonk::min (numSamples, fifoSize - position);
+        BufferType::copyData (dest, fifo + position, first);
+        
+        if (first < numSamples)
+            BufferType::copyData (dest + first, fifo, numSamples - first);
+    }
+    
+    /** @internal */
+    static void zeroFifo (SampleType* const fifo, const int fifoSize, const int position, const int numSamples) throw()
+    {
+        const int first = plonk::min (numSamples, fifoSize - position);
+        BufferType::zeroData (fifo + position, first);
+        
+        if (first < numSamples)
+            BufferType::zeroData (fifo, numSamples - first);
+    }
+    
     /** @internal */
     void startHostInternal() throw()
     {
         initFormat();
         outputUnit = constructGraph();
+        
+        if (useExecutionPlan)
+            executionPlan.setRoot (outputUnit);
+        
+        initDirectOutputs();
         hostStarting();
         
 //        const int numInputs = this->inputs.length();
@@ -255,34 +569,104 @@ protected:
 
     PLONK_INLINE_LOW void setIsPaused (const bool state) throw() { isPaused = state; }
     
+    /** Tell the host the device's block size has changed while it is running.
+     The FIFOs between the host and graph are set up again for the new size,
+     this must not be called at the same time as process(). */
+    void hostBlockSizeChanged (const int newSize) throw()
+    {
+        preferredHostBlockSize = newSize;
+        
+        if (getIsRunning())
+            initFifos();
+    }
+    
 private:
     double preferredHostSampleRate;
     int preferredHostBlockSize;
     int preferredGraphBlockSize;
+    bool useExecutionPlan;
+    bool useDirectInputs;
 	AtomicInt isRunning;
     AtomicInt isPaused;
     OptionDictionary otherOptions;
 
     ProcessInfo info;
     UnitType outputUnit;
+    ExecutionPlanType executionPlan;
     BussesType busses;
     ConstBufferArray inputs;
     BufferArray outputs;    
     
+    BuffersType inputFifos;             // rings of a whole number of graph blocks
+    BuffersType outputFifos;
+    int fifoChunkSize;
+    int fifoInputStart;                 // read positions in the rings
+    int numFifoInputFrames;
+    int fifoOutputStart;
+    int numFifoOutputFrames;
+    AtomicInt latency;
+    int baseLatency;                    // the latency the block sizes need, latency only drains down to this
+    int minSpareOutputFrames;           // fewest output frames left over by a chunk since the last drain
+    int numFramesSinceDrain;
+    int latencyDrainFrames;             // how often unused latency is drained
+    
+    ObjectArray<ChannelInternalType*> directOutputs;    // null for outputs that are copied
+    BuffersType directOutputHomes;                      // hold the channels' last values between callbacks
+    
     PLONK_INLINE_LOW void initFormat() throw()
     {
         SampleRate::getDefault().setValue (preferredHostSampleRate);
         
-        // preferredGraphBlockSize must be less that the hardware size 
-        // and divide into the hardware size without a remainder.
-        if ((preferredGraphBlockSize == 0) ||
-            (preferredHostBlockSize <= preferredGraphBlockSize) ||
-            ((preferredHostBlockSize % preferredGraphBlockSize) != 0))
-        {
+        if (preferredGraphBlockSize <= 0)
             preferredGraphBlockSize = preferredHostBlockSize;
-        }
         
         BlockSize::getDefault().setValue (preferredGraphBlockSize); 
+        
+        initFifos();
+    }
+    
+    /** Makes the FIFOs used when the host's blocks are not a multiple of the graph's. */
+    void initFifos() throw()
+    {
+        const int graphBlockSize = preferredGraphBlockSize;
+        const int numInputs = this->inputs.length();
+        const int numOutputs = this->outputs.length();
+        int i, a, b;
+        
+        // greatest common divisor
+        for (a = graphBlockSize, b = plonk::max (preferredHostBlockSize, 1); b != 0;)
+        {
+            const int r = a % b;
+            a = b;
+            b = r;
+        }
+        
+        fifoChunkSize = plonk::max (preferredHostBlockSize, graphBlockSize);
+        
+        // the input FIFO holds less than a graph block plus a chunk, in whole graph blocks
+        const int inputFifoSize = graphBlockSize * (fifoChunkSize / graphBlockSize + 2);
+        
+        // the output FIFO holds up to the latency (less than one graph block) plus a chunk and a graph block
+        const int outputFifoSize = fifoChunkSize + graphBlockSize * 2;
+        
+        inputFifos.clear();
+        outputFifos.clear();
+        
+        for (i = 0; i < numInputs; ++i)
+            inputFifos.add (BufferType::withSize (inputFifoSize, true));
+        
+        for (i = 0; i < numOutputs; ++i)
+            outputFifos.add (BufferType::withSize (outputFifoSize, true));
+        
+        baseLatency = graphBlockSize - a;
+        latency = baseLatency;
+        fifoInputStart = 0;
+        numFifoInputFrames = 0;
+        fifoOutputStart = 0;
+        numFifoOutputFrames = baseLatency; // primed with silence
+        minSpareOutputFrames = outputFifoSize;
+        numFramesSinceDrain = 0;
+        latencyDrainFrames = plonk::max (fifoChunkSize, int (preferredHostSampleRate));
     }
 
 };
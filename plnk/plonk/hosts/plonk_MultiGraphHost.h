@@ -0,0 +1,753 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_MULTIGRAPHHOST_H
+#define PLONK_MULTIGRAPHHOST_H
+
+#include "../core/plonk_SmartPointer.h"
+#include "../core/plonk_SmartPointerContainer.h"
+#include "../core/plonk_Thread.h"
+#include "../core/plonk_Lock.h"
+
+
+/** One graph rendered by a MultiGraphHost.
+ The graph renders into a FIFO of whole blocks which the consumer drains
+ using read(). The host only renders the graph when there is space for
+ another block so a consumer that stops reading stops the graph (back
+ pressure) rather than losing output.
+ 
+ A real-time graph's deadline is when the consumer, reading at the graph's
+ sample rate from its last read, would have used up the frames in the FIFO.
+ An offline graph has no deadline, it is rendered in time not needed by
+ real-time graphs as fast as it is read.
+ 
+ The FIFO of a real-time graph is moved to its worker's memory node before
+ the worker first renders it. */
+template<class SampleType>
+class HostedGraphInternal : public SmartPointer
+{
+public:
+    typedef UnitBase<SampleType>            UnitType;
+    typedef NumericalArray<SampleType>      BufferType;
+
+    HostedGraphInternal (UnitType const& unitToUse, const bool realTimeToUse, const int numBlocks) throw()
+    :   unit (unitToUse),
+        numChannels (unitToUse.getNumChannels()),
+        blockSize (unitToUse.getBlockSize (0).getValue()),
+        sampleRate (unitToUse.getSampleRate (0).getValue()),
+        blockDurationInTicks (unitToUse.atUnchecked (0).getBlockDurationInTicks()),
+        capacity (plonk::max (numBlocks, 1) * blockSize),
+        realTime (realTimeToUse),
+        worker (-1),
+        node (-1),
+        expectedLoad (0.0),
+        loadAverage (0.0),
+        peakLoad (0.0)
+    {
+        plonk_assert (numChannels > 0);
+        plonk_assert (blockSize > 0);
+        plonk_assert (sampleRate > 0.0);
+        
+        fifo = BufferType::withSize (numChannels * capacity, true);
+    }
+    
+    ~HostedGraphInternal()
+    {
+    }
+    
+    /** Returns @c true if there is space in the FIFO for another block. */
+    PLONK_INLINE_LOW bool isReady() const throw()
+    {
+        return (writePosition.getValue() - readPosition.getValue() + blockSize) <= capacity;
+    }
+    
+    /** Returns the time by which the next block should be rendered. */
+    PLONK_INLINE_LOW double getDeadline() const throw()
+    {
+        if (!realTime)
+            return PLONK_INFINITY;
+        
+        const double numBuffered = double (writePosition.getValue() - readPosition.getValue());
+        return readTime.getValue() + numBuffered / sampleRate;
+    }
+    
+    /** Renders one block into the FIFO and accounts for the time it took. */
+    void render (const double deadline) throw()
+    {
+        const double startTime = pl_TimeNow();
+        
+        unit.process (info);
+        
+        const LongLong position = writePosition.getValue();
+        const int offset = int (position % capacity);
+        SampleType* const fifoArray = fifo.getArray();
+        
+        for (int i = 0; i < numChannels; ++i)
+            BufferType::copyData (fifoArray + i * capacity + offset, unit.getOutputSamples (i), blockSize);
+        
+        info.offsetTimeStamp (blockDurationInTicks);
+        writePosition.setValue (position + blockSize);
+        
+        const double endTime = pl_TimeNow();
+        const double duration = endTime - startTime;
+        const double load = duration * sampleRate / blockSize;
+        
+        // only the rendering thread writes these
+        cpuTime.setValue (cpuTime.getValue() + duration);
+        loadAverage.setValue ((numBlocksRendered.getValue() == 0) ? load : loadAverage.getValue() + (load - loadAverage.getValue()) * 0.05);
+        peakLoad.setValue (plonk::max (peakLoad.getValue(), load));
+        ++numBlocksRendered;
+        
+        if (endTime > deadline)
+            ++numDeadlineMisses;
+    }
+    
+    /** Copies up to @e numFrames frames from the FIFO, zeroing any frames not yet rendered.
+     Returns the number of frames that were available. */
+    int read (SampleType* const* outputs, const int numOutputs, const int numFrames) throw()
+    {
+        const LongLong position = readPosition.getValue();
+        const int numAvailable = int (plonk::min (writePosition.getValue() - position, LongLong (numFrames)));
+        const int offset = int (position % capacity);
+        const int numFirst = plonk::min (numAvailable, capacity - offset);
+        const SampleType* const fifoArray = fifo.getArray();
+        
+        for (int i = 0; i < numOutputs; ++i)
+        {
+            SampleType* const output = outputs[i];
+            
+            if (i < numChannels)
+            {
+                const SampleType* const channel = fifoArray + i * capacity;
+                
+                if (numFirst > 0)
+                    BufferType::copyData (output, channel + offset, numFirst);
+                
+                if (numAvailable > numFirst)
+                    BufferType::copyData (output + numFirst, channel, numAvailable - numFirst);
+                
+                if (numFrames > numAvailable)
+                    BufferType::zeroData (output + numAvailable, numFrames - numAvailable);
+            }
+            else if (numFrames > 0)
+            {
+                BufferType::zeroData (output, numFrames);
+            }
+        }
+        
+        readTime.setValue (pl_TimeNow());
+        readPosition.setValue (position + numAvailable);
+        
+        if (realTime && (numAvailable < numFrames))
+            ++numUnderruns;
+        
+        event.signal();
+        
+        return numAvailable;
+    }
+    
+    /** Renders up to @e numBlocks blocks on the calling thread and returns their mean load. */
+    double probe (const int numBlocks) throw()
+    {
+        for (int i = 0; (i < numBlocks) && isReady(); ++i)
+            render (PLONK_INFINITY);
+        
+        const int numRendered = numBlocksRendered.getValue();
+        return numRendered > 0 ? cpuTime.getValue() * sampleRate / (double (numRendered) * blockSize) : 0.0;
+    }
+    
+    /** Sets the worker that renders this graph and the event that wakes it. */
+    void setWorker (const int workerToUse, Lock const& eventToUse, const double expectedLoadToUse) throw()
+    {
+        worker = workerToUse;
+        event = eventToUse;
+        expectedLoad = expectedLoadToUse;
+        readTime.setValue (pl_TimeNow());
+    }
+    
+    /** Moves the FIFO to a memory node, this is called by the rendering worker. */
+    void placeOnNode (const int nodeToUse) throw()
+    {
+        if ((nodeToUse < 0) || (nodeToUse == node))
+            return;
+        
+        Memory::placeOnNode (fifo.getArray(), UnsignedLong (fifo.length()) * sizeof (SampleType), nodeToUse);
+        node = nodeToUse;
+    }
+    
+    /** Claims an offline graph for rendering, returns @c false if another worker has it. */
+    PLONK_INLINE_LOW bool claim() throw()           { return busy.compareAndSwap (0, 1); }
+    PLONK_INLINE_LOW void unclaim() throw()         { busy.setValue (0); }
+    
+    /** The load counted against the worker, the larger of the expected and measured load. */
+    PLONK_INLINE_LOW double getCommittedLoad() const throw()    { return plonk::max (expectedLoad, loadAverage.getValue()); }
+    
+    PLONK_INLINE_LOW int getWorker() const throw()              { return worker; }
+    
+    friend class HostedGraphBase<SampleType>;
+    
+private:
+    UnitType unit;
+    ProcessInfo info;
+    const int numChannels;
+    const int blockSize;
+    const double sampleRate;
+    const double blockDurationInTicks;
+    const int capacity;
+    const bool realTime;
+    int worker;
+    int node;                   // where the FIFO was placed, only the rendering thread writes this
+    double expectedLoad;
+    Lock event;
+    BufferType fifo;
+    AtomicLongLong writePosition;
+    AtomicLongLong readPosition;
+    AtomicDouble readTime;
+    AtomicInt busy;
+    AtomicInt numBlocksRendered;
+    AtomicInt numDeadlineMisses;
+    AtomicInt numUnderruns;
+    AtomicDouble cpuTime;
+    AtomicDouble loadAverage;
+    AtomicDouble peakLoad;
+};
+
+//------------------------------------------------------------------------------
+
+/** A graph added to a MultiGraphHost.
+ Read the graph's output with read(). The accounting functions may be
+ called from any thread. Loads are the time taken to render a block as a
+ fraction of the block's duration.
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class HostedGraphBase : public SmartPointerContainer< HostedGraphInternal<SampleType> >
+{
+public:
+    typedef HostedGraphInternal<SampleType>     Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef UnitBase<SampleType>                UnitType;
+    
+    HostedGraphBase() throw()
+    :   Base (static_cast<Internal*> (0))
+    {
+    }
+    
+    explicit HostedGraphBase (Internal* internalToUse) throw()
+    :   Base (internalToUse)
+    {
+    }
+    
+    HostedGraphBase (HostedGraphBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    HostedGraphBase& operator= (HostedGraphBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    /** Copies the next @e numFrames frames of each channel to @e outputs.
+     Frames not yet rendered are zeroed. Returns the number of frames that were available. */
+    PLONK_INLINE_LOW int read (SampleType* const* outputs, const int numOutputs, const int numFrames) throw()
+    {
+        return this->getInternal()->read (outputs, numOutputs, numFrames);
+    }
+    
+    PLONK_INLINE_LOW const UnitType& getUnit() const throw()            { return this->getInternal()->unit; }
+    PLONK_INLINE_LOW int getNumChannels() const throw()                 { return this->getInternal()->numChannels; }
+    PLONK_INLINE_LOW int getBlockSize() const throw()                   { return this->getInternal()->blockSize; }
+    PLONK_INLINE_LOW double getSampleRate() const throw()               { return this->getInternal()->sampleRate; }
+    PLONK_INLINE_LOW bool isRealTime() const throw()                    { return this->getInternal()->realTime; }
+    
+    /** The worker that renders this graph, -1 for offline graphs. */
+    PLONK_INLINE_LOW int getWorker() const throw()                      { return this->getInternal()->getWorker(); }
+    
+    PLONK_INLINE_LOW int getNumFramesAvailable() const throw()
+    {
+        return int (this->getInternal()->writePosition.getValue() - this->getInternal()->readPosition.getValue());
+    }
+    
+    PLONK_INLINE_LOW int getNumBlocksRendered() const throw()           { return this->getInternal()->numBlocksRendered.getValue(); }
+    PLONK_INLINE_LOW int getNumDeadlineMisses() const throw()           { return this->getInternal()->numDeadlineMisses.getValue(); }
+    PLONK_INLINE_LOW int getNumUnderruns() const throw()                { return this->getInternal()->numUnderruns.getValue(); }
+    
+    /** The total time spent rendering this graph in seconds. */
+    PLONK_INLINE_LOW double getCpuTime() const throw()                  { return this->getInternal()->cpuTime.getValue(); }
+    
+    PLONK_INLINE_LOW double getLoad() const throw()                     { return this->getInternal()->loadAverage.getValue(); }
+    PLONK_INLINE_LOW double getPeakLoad() const throw()                 { return this->getInternal()->peakLoad.getValue(); }
+    
+    /** The load the graph was admitted with. */
+    PLONK_INLINE_LOW double getExpectedLoad() const throw()             { return this->getInternal()->expectedLoad; }
+};
+
+//------------------------------------------------------------------------------
+
+template<class SampleType>
+class MultiGraphHostInternal : public SmartPointer
+{
+public:
+    typedef UnitBase<SampleType>                    UnitType;
+    typedef HostedGraphBase<SampleType>             HostedGraphType;
+    typedef HostedGraphInternal<SampleType>         HostedGraphInternalType;
+    typedef ObjectArray<HostedGraphType>            HostedGraphArray;
+    
+    class Worker : public Threading::Thread
+    {
+    public:
+        Worker (const int i, Lock const& e) throw()
+        :   Threading::Thread ("plonk::MultiGraphHost::Worker"),
+            index (i),
+            event (e),
+            node (-1),
+            nextOffline (0)
+        {
+        }
+        
+        ~Worker()
+        {
+            delete pending.swap (0);
+        }
+        
+        ResultCode run() throw()
+        {
+            // the affinity has been applied by now so this is the node of the worker's core
+            const int currentNode = Memory::getCurrentNode();
+            node.setValue (currentNode);
+            
+            // graphs only become ready when they are read or published, both signal the event
+            while (!getShouldExit())
+            {
+                if (!renderNext (currentNode))
+                    event.wait();
+            }
+            
+            return PlankResult_OK;
+        }
+        
+        /** Gives the worker a new list of the graphs it may render.
+         This is called by the host with its lock held, the worker picks up 
+         the list before its next block without taking the lock. */
+        void publish (HostedGraphArray* const list) throw()
+        {
+            // a list the worker has not picked up yet was never seen by it
+            delete pending.swap (list);
+            event.signal();
+        }
+        
+        /** The memory node of the worker, -1 until it has started. */
+        PLONK_INLINE_LOW int getNode() const throw()    { return node.getValue(); }
+        
+    private:
+        const int index;
+        Lock event;
+        AtomicInt node;
+        AtomicValue<HostedGraphArray*> pending;
+        HostedGraphArray graphs;                    // only the worker's thread uses these
+        int nextOffline;
+        
+        /** Renders the next block for the worker.
+         This is the ready real-time graph on the worker with the earliest
+         deadline or, if there isn't one, the next ready offline graph. Returns
+         @c false if there was nothing to render. */
+        bool renderNext (const int workerNode) throw()
+        {
+            HostedGraphArray* const list = pending.swap (0);
+            
+            if (list != 0)
+            {
+                graphs = *list;
+                delete list;
+            }
+            
+            const int numGraphs = graphs.length();
+            HostedGraphType* const graphArray = graphs.getArray();
+            HostedGraphInternalType* graph = 0;
+            double deadline = PLONK_INFINITY;
+            int i;
+            
+            for (i = 0; i < numGraphs; ++i)
+            {
+                HostedGraphInternalType* const candidate = graphArray[i].getInternal();
+                
+                if ((candidate->getWorker() == index) && candidate->isReady())
+                {
+                    const double candidateDeadline = candidate->getDeadline();
+                    
+                    if ((graph == 0) || (candidateDeadline < deadline))
+                    {
+                        graph = candidate;
+                        deadline = candidateDeadline;
+                    }
+                }
+            }
+            
+            if (graph == 0)
+            {
+                for (i = 0; i < numGraphs; ++i)
+                {
+                    const int offlineIndex = (nextOffline + i) % numGraphs;
+                    HostedGraphInternalType* const candidate = graphArray[offlineIndex].getInternal();
+                    
+                    if ((candidate->getWorker() < 0) && candidate->isReady() && candidate->claim())
+                    {
+                        graph = candidate;
+                        nextOffline = offlineIndex + 1;
+                        break;
+                    }
+                }
+            }
+            
+            if (graph == 0)
+                return false;
+                        
+            // real-time graphs stay on their worker so are worth moving to its node, offline graphs move between workers
+            if (graph->getWorker() >= 0)
+                graph->placeOnNode (workerNode);
+            
+            graph->render (deadline);
+            
+            if (graph->getWorker() < 0)
+                graph->unclaim();
+            
+            return true;
+        }
+    };
+    
+    MultiGraphHostInternal (const int numWorkersToUse,
+                            const double maxLoadToUse,
+                            const int priority,
+                            const bool pinWorkers) throw()
+    :   numWorkers (numWorkersToUse > 0 ? numWorkersToUse : Threading::getNumCores()),
+        maxLoad (maxLoadToUse),
+        lock (Lock::MutexLock),
+        nextOfflineWorker (0)
+    {
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            // a semaphore so read() can wake the worker from an audio thread without blocking
+            const Lock event (Lock::SemaphoreLock);
+            Worker* const worker = new Worker (i, event);
+            
+            // these are applied by the thread when it starts
+            if (pinWorkers)
+                worker->setAffinityIsolated (i);
+            
+            if (priority >= 0)
+                worker->setPriority (priority);
+            
+            events.add (event);
+            workers.add (worker);
+            worker->start();
+        }
+    }
+    
+    ~MultiGraphHostInternal()
+    {
+        int i;
+        
+        for (i = 0; i < numWorkers; ++i)
+        {
+            workers.atUnchecked (i)->setShouldExit();
+            events.atUnchecked (i).signal();
+        }
+        
+        for (i = 0; i < numWorkers; ++i)
+        {
+            Worker* const worker = workers.atUnchecked (i);
+            worker->wait();
+            delete worker;
+        }
+    }
+    
+    /** Adds a graph, returns a null graph if a real-time graph is not admitted.
+     A real-time graph is given to the worker with the lowest committed load
+     that can take the graph's load without going over the maximum, 
+     preferring workers on @e node if it is not -1. If the load is not given 
+     the graph is first rendered for a few blocks on the calling thread to 
+     measure it. */
+    HostedGraphType add (UnitType const& unit, const bool realTime, const int numBlocks, const double load, const int node) throw()
+    {
+        HostedGraphType graph (new HostedGraphInternalType (unit, realTime, numBlocks));
+        HostedGraphInternalType* const internal = graph.getInternal();
+        
+        if (!realTime)
+        {
+            const AutoLock l (lock);
+            const int worker = nextOfflineWorker;
+            nextOfflineWorker = (nextOfflineWorker + 1) % numWorkers;
+            internal->setWorker (-1, events.atUnchecked (worker), 0.0);
+            graphs.add (graph);
+            publishUnlocked (-1);
+            return graph;
+        }
+        
+        const double expectedLoad = (load > 0.0) ? load : internal->probe (plonk::min (numBlocks, 4));
+        
+        const AutoLock l (lock);
+        int worker = -1;
+        double lowestLoad = 0.0;
+        bool workerOnNode = false;
+        
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            const double workerLoad = getWorkerLoadUnlocked (i);
+            const bool onNode = (node < 0) || (workers.atUnchecked (i)->getNode() == node);
+            
+            if (((workerLoad + expectedLoad) <= maxLoad) &&
+                ((worker < 0) || (onNode && !workerOnNode) || ((onNode == workerOnNode) && (workerLoad < lowestLoad))))
+            {
+                worker = i;
+                lowestLoad = workerLoad;
+                workerOnNode = onNode;
+            }
+        }
+        
+        if (worker < 0)
+        {
+            ++numRejected;
+            return HostedGraphType();
+        }
+        
+        internal->setWorker (worker, events.atUnchecked (worker), expectedLoad);
+        graphs.add (graph);
+        publishUnlocked (worker);
+        
+        return graph;
+    }
+    
+    /** Stops rendering a graph. */
+    void remove (HostedGraphType const& graph) throw()
+    {
+        const AutoLock l (lock);
+        
+        graphs.removeItem (graph);
+        publishUnlocked (graph.getWorker());
+    }
+    
+    /** The sum of the committed loads of the real-time graphs on a worker. */
+    double getWorkerLoad (const int workerIndex) throw()
+    {
+        const AutoLock l (lock);
+        return getWorkerLoadUnlocked (workerIndex);
+    }
+    
+    PLONK_INLINE_LOW int getNumWorkers() const throw()          { return numWorkers; }
+    PLONK_INLINE_LOW double getMaxLoad() const throw()          { return maxLoad; }
+    
+    /** The memory node of a worker, -1 if it has not started yet. */
+    PLONK_INLINE_LOW int getWorkerNode (const int workerIndex) const throw()  { return workers.atUnchecked (workerIndex)->getNode(); }
+    PLONK_INLINE_LOW int getNumRejected() const throw()         { return numRejected.getValue(); }
+    
+    int getNumGraphs() throw()
+    {
+        const AutoLock l (lock);
+        return graphs.length();
+    }
+    
+    HostedGraphArray getGraphs() throw()
+    {
+        const AutoLock l (lock);
+        return graphs.copy();
+    }
+    
+private:
+    const int numWorkers;
+    const double maxLoad;
+    Lock lock;
+    HostedGraphArray graphs;
+    ObjectArray<Worker*> workers;
+    ObjectArray<Lock> events;
+    int nextOfflineWorker;
+    AtomicInt numRejected;
+    
+    /** Gives a worker (or all of them if @e workerIndex is -1) a new list of 
+     its real-time graphs and the offline graphs. The workers never take the 
+     lock so adding or removing graphs doesn't hold them up. */
+    void publishUnlocked (const int workerIndex) throw()
+    {
+        const int numGraphs = graphs.length();
+        const HostedGraphType* const graphArray = graphs.getArray();
+        
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            if ((workerIndex >= 0) && (i != workerIndex))
+                continue;
+            
+            HostedGraphArray* const list = new HostedGraphArray;
+            
+            for (int j = 0; j < numGraphs; ++j)
+            {
+                const int graphWorker = graphArray[j].getWorker();
+                
+                if ((graphWorker < 0) || (graphWorker == i))
+                    list->add (graphArray[j]);
+            }
+            
+            workers.atUnchecked (i)->publish (list);
+        }
+    }
+    
+    double getWorkerLoadUnlocked (const int workerIndex) const throw()
+    {
+        const int numGraphs = graphs.length();
+        const HostedGraphType* const graphArray = graphs.getArray();
+        double total = 0.0;
+        
+        for (int i = 0; i < numGraphs; ++i)
+        {
+            const HostedGraphInternalType* const graph = graphArray[i].getInternal();
+            
+            if (graph->getWorker() == workerIndex)
+                total += graph->getCommittedLoad();
+        }
+        
+        return total;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Renders many independent graphs on a fixed pool of worker threads.
+ Each graph is added with its own unit so may have its own sample rate and
+ block size, these are taken from the unit's first channel so the units
+ should be created with explicit sample rates and block sizes rather than the
+ defaults. Each graph renders into its own FIFO and the output is collected
+ with HostedGraph::read().
+ 
+ Real-time graphs go through admission control: each is given the worker
+ with the lowest committed load (the sum of the larger of the expected and
+ measured loads of its graphs) that can take it without going over
+ @e maxLoad. Graphs that do not fit are rejected. A real-time graph stays on
+ its worker so its state stays in that core's cache, and each worker renders
+ its graphs earliest deadline first.
+ 
+ Offline graphs are not admitted to a worker. Any worker with no real-time
+ graph ready renders them, as fast as they are read.
+ 
+ On NUMA machines each worker renders its real-time graphs' FIFOs from
+ memory on its own node. A graph whose data is on a particular node (e.g., a 
+ Signal loaded on that node or moved there with SignalBase::placeOnNode())
+ can be added with that node so it is given a worker on the node if one has
+ room. The graph's units are not moved, so create them on a thread on the 
+ same node where this matters.
+ 
+ @code
+ MultiGraphHost host (4);
+ Unit unit = Sine::ar (440, 0.1, 0, BlockSize (256), SampleRate (48000));
+ HostedGraph graph = host.add (unit);
+ 
+ if (graph.isNull())
+    ... // rejected
+ 
+ // then from the session's output thread
+ float* outputs[1] = { buffer };
+ graph.read (outputs, 1, 256);
+ @endcode
+ @ingroup PlonkOtherUserClasses */
+template<class SampleType>
+class MultiGraphHostBase : public SmartPointerContainer< MultiGraphHostInternal<SampleType> >
+{
+public:
+    typedef MultiGraphHostInternal<SampleType>  Internal;
+    typedef SmartPointerContainer<Internal>     Base;
+    typedef UnitBase<SampleType>                UnitType;
+    typedef HostedGraphBase<SampleType>         HostedGraphType;
+    typedef ObjectArray<HostedGraphType>        HostedGraphArray;
+    
+    /** Create a host and start its workers.
+     @param numWorkers  The number of worker threads, 0 uses one per core.
+     @param maxLoad     The maximum committed load of the real-time graphs on each worker.
+     @param priority    The priority of the workers (see Threading::Thread::setPriority()) or -1 for the default.
+     @param pinWorkers  Pin each worker to a core, preferring isolated cores. */
+    MultiGraphHostBase (const int numWorkers = 0,
+                        const double maxLoad = 0.7,
+                        const int priority = -1,
+                        const bool pinWorkers = true) throw()
+    :   Base (new Internal (numWorkers, maxLoad, priority, pinWorkers))
+    {
+    }
+    
+    MultiGraphHostBase (MultiGraphHostBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    MultiGraphHostBase& operator= (MultiGraphHostBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    /** Adds a graph.
+     @param unit        The graph's output unit.
+     @param realTime    @c true for a real-time graph, @c false for an offline graph.
+     @param numBlocks   The size of the graph's FIFO in blocks.
+     @param load        The expected load of a real-time graph, 0 to measure it.
+     @param node        The memory node to prefer for a real-time graph's worker, -1 for any.
+     @return The graph or a null graph if it was rejected. */
+    PLONK_INLINE_LOW HostedGraphType add (UnitType const& unit,
+                                          const bool realTime = true,
+                                          const int numBlocks = 4,
+                                          const double load = 0.0,
+                                          const int node = -1) throw()
+    {
+        return this->getInternal()->add (unit, realTime, numBlocks, load, node);
+    }
+    
+    PLONK_INLINE_LOW void remove (HostedGraphType const& graph) throw()  { this->getInternal()->remove (graph); }
+    PLONK_INLINE_LOW int getNumGraphs() const throw()                   { return this->getInternal()->getNumGraphs(); }
+    PLONK_INLINE_LOW HostedGraphArray getGraphs() const throw()         { return this->getInternal()->getGraphs(); }
+    PLONK_INLINE_LOW int getNumWorkers() const throw()                  { return this->getInternal()->getNumWorkers(); }
+    PLONK_INLINE_LOW double getMaxLoad() const throw()                  { return this->getInternal()->getMaxLoad(); }
+    PLONK_INLINE_LOW double getWorkerLoad (const int worker) const throw() { return this->getInternal()->getWorkerLoad (worker); }
+    PLONK_INLINE_LOW int getWorkerNode (const int worker) const throw() { return this->getInternal()->getWorkerNode (worker); }
+    PLONK_INLINE_LOW int getNumRejected() const throw()                 { return this->getInternal()->getNumRejected(); }
+};
+
+typedef HostedGraphBase<PLONK_TYPE_DEFAULT>     HostedGraph;
+typedef MultiGraphHostBase<PLONK_TYPE_DEFAULT>  MultiGraphHost;
+
+
+#endif // PLONK_MULTIGRAPHHOST_H
@@ -0,0 +1,292 @@
+/*
+ -------------------------------------------------------------------------------
+ This file is part of the Plink, Plonk, Plank libraries
+  by Martin Robinson
+ 
+ http://code.google.com/p/pl-nk/
+ 
+ Copyright University of the West of England, Bristol 2011-15
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+ * Neither the name of University of the West of England, Bristol nor 
+   the names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL UNIVERSITY OF THE WEST OF ENGLAND, BRISTOL BE 
+ LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ 
+ This software makes use of third party libraries. For more information see:
+ doc/license.txt included in the distribution.
+ -------------------------------------------------------------------------------
+ */
+
+#ifndef PLONK_JSONSTREAM_H
+#define PLONK_JSONSTREAM_H
+
+
+class JSONReaderInternal : public SmartPointer
+{
+public:
+    PLONK_INLINE_LOW JSONReaderInternal (BinaryFile const& fileToUse) throw()
+    :   file (fileToUse)
+    {
+        pl_JSONReader_Init (&peer);
+        
+        if (file.canRead())
+            pl_JSONReader_Open (&peer, file.getInternal()->getPeerRef());
+    }
+    
+    PLONK_INLINE_LOW ~JSONReaderInternal()
+    {
+        pl_JSONReader_DeInit (&peer);
+    }
+    
+    friend class JSONReader;
+    
+private:
+    PlankJSONReader peer;
+    BinaryFile file;
+};
+
+
+/** Reads a JSON file one token at a time without building a JSON object tree.
+ Numerical arrays, including the binary and compressed formats written by JSON 
+ and JSONWriter, are decoded directly into the destination array. If the
+ destination array is not empty it is filled in place and must be the same 
+ length as the array in the file, otherwise a new array is allocated. */
+class JSONReader : public SmartPointerContainer<JSONReaderInternal>
+{
+public:
+    typedef SmartPointerContainer<JSONReaderInternal> Base;
+    
+    PLONK_INLINE_LOW JSONReader (BinaryFile const& file) throw()
+    :   Base (new JSONReaderInternal (file))
+    {
+    }
+    
+    PLONK_INLINE_LOW ResultCode next (PlankJSONToken& token) throw()
+    {
+        return pl_JSONReader_Next (getPeerRef(), &token);
+    }
+    
+    PLONK_INLINE_LOW PlankJSONToken getToken() throw()              { return pl_JSONReader_GetToken (getPeerRef()); }
+    PLONK_INLINE_LOW const char* getCString() throw()               { return pl_JSONReader_GetString (getPeerRef()); }
+    PLONK_INLINE_LOW Text getText() throw()                         { return pl_JSONReader_GetString (getPeerRef()); }
+    PLONK_INLINE_LOW LongLong getInt() throw()                      { return pl_JSONReader_GetInt (getPeerRef()); }
+    PLONK_INLINE_LOW double getDouble() throw()                     { return pl_JSONReader_GetDouble (getPeerRef()); }
+    PLONK_INLINE_LOW int getDepth() throw()                         { return pl_JSONReader_GetDepth (getPeerRef()); }
+    PLONK_INLINE_LOW bool isKey (const char* key) throw()           { return (getToken() == PlankJSONToken_Key) && (strcmp (getCString(), key) == 0); }
+    
+    PLONK_INLINE_LOW ResultCode skipValue() throw()
+    {
+        return pl_JSONReader_SkipValue (getPeerRef());
+    }
+    
+    PLONK_INLINE_LOW ResultCode parse (PlankJSONReaderFunction function, void* userData) throw()
+    {
+        return pl_JSONReader_Parse (getPeerRef(), function, userData);
+    }
+    
+    PLONK_INLINE_LOW ResultCode read (LongLong& value) throw()      { return pl_JSONReader_ReadInt (getPeerRef(), &value); }
+    PLONK_INLINE_LOW ResultCode read (float& value) throw()         { return pl_JSONReader_ReadFloat (getPeerRef(), &value); }
+    PLONK_INLINE_LOW ResultCode read (double& value) throw()        { return pl_JSONReader_ReadDouble (getPeerRef(), &value); }
+    
+    ResultCode read (LongLongArray& values) throw()
+    {
+        if (values.length() > 0)
+        {
+            Long count;
+            const ResultCode result = pl_JSONReader_ReadIntArrayInto (getPeerRef(), values.getArray(), values.length(), &count);
+            return ((result == PlankResult_OK) && (count != values.length())) ? PlankResult_ItemCountInvalid : result;
+        }
+        
+        PlankDynamicArray array;
+        pl_DynamicArray_Init (&array);
+        
+        const ResultCode result = pl_JSONReader_ReadIntArray (getPeerRef(), &array);
+        
+        if (result == PlankResult_OK)
+            values = LongLongArray::withArray ((int)pl_DynamicArray_GetSize (&array), static_cast<LongLong*> (pl_DynamicArray_GetArray (&array)));
+        else
+            pl_DynamicArray_DeInit (&array);
+        
+        return result;
+    }
+
+    ResultCode read (FloatArray& values) throw()
+    {
+        if (values.length() > 0)
+        {
+            Long count;
+            const ResultCode result = pl_JSONReader_ReadFloatArrayInto (getPeerRef(), values.getArray(), values.length(), &count);
+            return ((result == PlankResult_OK) && (count != values.length())) ? PlankResult_ItemCountInvalid : result;
+        }
+        
+        PlankDynamicArray array;
+        pl_DynamicArray_Init (&array);
+        
+        const ResultCode result = pl_JSONReader_ReadFloatArray (getPeerRef(), &array);
+        
+        if (result == PlankResult_OK)
+            values = FloatArray::withArray ((int)pl_DynamicArray_GetSize (&array), static_cast<float*> (pl_DynamicArray_GetArray (&array)));
+        else
+            pl_DynamicArray_DeInit (&array);
+        
+        return result;
+    }
+
+    ResultCode read (DoubleArray& values) throw()
+    {
+        if (values.length() > 0)
+        {
+            Long count;
+            const ResultCode result = pl_JSONReader_ReadDoubleArrayInto (getPeerRef(), values.getArray(), values.length(), &count);
+            return ((result == PlankResult_OK) && (count != values.length())) ? PlankResult_ItemCountInvalid : result;
+        }
+        
+        PlankDynamicArray array;
+        pl_DynamicArray_Init (&array);
+        
+        const ResultCode result = pl_JSONReader_ReadDoubleArray (getPeerRef(), &array);
+        
+        if (result == PlankResult_OK)
+            values = DoubleArray::withArray ((int)pl_DynamicArray_GetSize (&array), static_cast<double*> (pl_DynamicArray_GetArray (&array)));
+        else
+            pl_DynamicArray_DeInit (&array);
+        
+        return result;
+    }
+    
+private:
+    PLONK_INLINE_LOW PlankJSONReaderRef getPeerRef() throw() { return &getInternal()->peer; }
+};
+
+
+class JSONWriterInternal : public SmartPointer
+{
+public:
+    PLONK_INLINE_LOW JSONWriterInternal (BinaryFile const& fileToUse, const int flags) throw()
+    :   file (fileToUse)
+    {
+        pl_JSONWriter_Init (&peer);
+        
+        if (file.canWrite())
+            pl_JSONWriter_Open (&peer, file.getInternal()->getPeerRef(), flags);
+    }
+    
+    PLONK_INLINE_LOW ~JSONWriterInternal()
+    {
+        pl_JSONWriter_DeInit (&peer);
+    }
+    
+    friend class JSONWriter;
+    
+private:
+    PlankJSONWriter peer;
+    BinaryFile file;
+};
+
+
+/** Writes a JSON file as values are added without building a JSON object tree.
+ Arrays can be written in the same plain, binary or compressed formats as JSON
+ and are encoded straight from the array. Any buffered output is written when
+ the last copy of the writer is destroyed or when flush() is called. */
+class JSONWriter : public SmartPointerContainer<JSONWriterInternal>
+{
+public:
+    typedef SmartPointerContainer<JSONWriterInternal> Base;
+    
+    PLONK_INLINE_LOW JSONWriter (BinaryFile const& file, const int flags = PLANK_JSON_DEFAULTFLAGS) throw()
+    :   Base (new JSONWriterInternal (file, flags))
+    {
+    }
+    
+    PLONK_INLINE_LOW ResultCode flush() throw()                                 { return pl_JSONWriter_Flush (getPeerRef()); }
+    
+    PLONK_INLINE_LOW ResultCode beginObject() throw()                           { return pl_JSONWriter_BeginObject (getPeerRef()); }
+    PLONK_INLINE_LOW ResultCode endObject() throw()                             { return pl_JSONWriter_EndObject (getPeerRef()); }
+    PLONK_INLINE_LOW ResultCode beginArray() throw()                            { return pl_JSONWriter_BeginArray (getPeerRef()); }
+    PLONK_INLINE_LOW ResultCode endArray() throw()                              { return pl_JSONWriter_EndArray (getPeerRef()); }
+    PLONK_INLINE_LOW ResultCode key (const char* key) throw()                   { return pl_JSONWriter_Key (getPeerRef(), key); }
+    
+    PLONK_INLINE_LOW ResultCode write (const char* text) throw()                { return pl_JSONWriter_String (getPeerRef(), text); }
+    PLONK_INLINE_LOW ResultCode write (Text const& text) throw()                { return pl_JSONWriter_String (getPeerRef(), text.getArray()); }
+    PLONK_INLINE_LOW ResultCode write (const int value) throw()                 { return pl_JSONWriter_Int (getPeerRef(), LongLong (value)); }
+    PLONK_INLINE_LOW ResultCode write (const Long value) throw()                { return pl_JSONWriter_Int (getPeerRef(), LongLong (value)); }
+    PLONK_INLINE_LOW ResultCode write (const LongLong value) throw()            { return pl_JSONWriter_Int (getPeerRef(), value); }
+    PLONK_INLINE_LOW ResultCode write (const float value) throw()               { return pl_JSONWriter_Float (getPeerRef(), value); }
+    PLONK_INLINE_LOW ResultCode write (const double value) throw()              { return pl_JSONWriter_Double (getPeerRef(), value); }
+    PLONK_INLINE_LOW ResultCode writeBool (const bool state) throw()            { return pl_JSONWriter_Bool (getPeerRef(), state); }
+    PLONK_INLINE_LOW ResultCode writeNull() throw()                             { return pl_JSONWriter_Null (getPeerRef()); }
+
+    PLONK_INLINE_LOW ResultCode writeBinary (const LongLong value) throw()      { return pl_JSONWriter_IntBinary (getPeerRef(), value); }
+    PLONK_INLINE_LOW ResultCode writeBinary (const float value) throw()         { return pl_JSONWriter_FloatBinary (getPeerRef(), value); }
+    PLONK_INLINE_LOW ResultCode writeBinary (const double value) throw()        { return pl_JSONWriter_DoubleBinary (getPeerRef(), value); }
+
+    PLONK_INLINE_LOW ResultCode write (LongLongArray const& values) throw()
+    {
+        return pl_JSONWriter_IntArray (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode write (FloatArray const& values) throw()
+    {
+        return pl_JSONWriter_FloatArray (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode write (DoubleArray const& values) throw()
+    {
+        return pl_JSONWriter_DoubleArray (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeBinary (LongLongArray const& values) throw()
+    {
+        return pl_JSONWriter_IntArrayBinary (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeBinary (FloatArray const& values) throw()
+    {
+        return pl_JSONWriter_FloatArrayBinary (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeBinary (DoubleArray const& values) throw()
+    {
+        return pl_JSONWriter_DoubleArrayBinary (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeCompressed (LongLongArray const& values) throw()
+    {
+        return pl_JSONWriter_IntArrayCompressed (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeCompressed (FloatArray const& values) throw()
+    {
+        return pl_JSONWriter_FloatArrayCompressed (getPeerRef(), values.getArray(), values.length());
+    }
+    
+    PLONK_INLINE_LOW ResultCode writeCompressed (DoubleArray const& values) throw()
+    {
+        return pl_JSONWriter_DoubleArrayCompressed (getPeerRef(), values.getArray(), values.length());
+    }
+    
+private:
+    PLONK_INLINE_LOW PlankJSONWriterRef getPeerRef() throw() { return &getInternal()->peer; }
+};
+
+
+#endif // PLONK_JSONSTREAM_H
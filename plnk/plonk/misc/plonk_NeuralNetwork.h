@@ -88,6 +88,19 @@ public:
         networkOutputs.referTo (pl_NeuralNetworkF_GetNumOutputs (&network),
                                 const_cast<float*> (pl_NeuralNetworkF_GetOutputsPtr (&network)));
         
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    NeuralNetworkInternal (PlankNeuralNetworkFRef source) throw()
+    {
+        ResultCode result = pl_NeuralNetworkF_InitCopy (&network, source);
+        plonk_assert (result == PlankResult_OK);
+        
+        networkOutputs.referTo (pl_NeuralNetworkF_GetNumOutputs (&network),
+                                const_cast<float*> (pl_NeuralNetworkF_GetOutputsPtr (&network)));
+        
 #ifndef PLONK_DEBUG
         (void)result;
 #endif
@@ -178,6 +191,57 @@ private:
 #endif
     }
     
+    PLONK_INLINE_LOW void propogateBatch (VectorType& outputs, VectorType const& inputs, const int numPatterns) throw()
+    {
+        plonk_assert (inputs.length() == (numPatterns * this->getNumInputs()));
+        
+        outputs.setSize (numPatterns * this->getNumOutputs(), false);
+        ResultCode result = pl_NeuralNetworkF_PropogateBatch (&network, inputs.getArray(), numPatterns, outputs.getArray());
+        plonk_assert (result == PlankResult_OK);
+        
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW void propogateBatch (float* outputs, const float* inputs, const int numPatterns) throw()
+    {
+        ResultCode result = pl_NeuralNetworkF_PropogateBatch (&network, inputs, numPatterns, outputs);
+        plonk_assert (result == PlankResult_OK);
+        
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW void reserveBatch (const int maxPatterns) throw()
+    {
+        ResultCode result = pl_NeuralNetworkF_ReserveBatch (&network, maxPatterns);
+        plonk_assert (result == PlankResult_OK);
+        
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW void backPropBatch (VectorType const& inputs, VectorType const& targets, const int numPatterns, const int numThreads) throw()
+    {
+        plonk_assert (inputs.length() == (numPatterns * this->getNumInputs()));
+        plonk_assert (targets.length() == (numPatterns * this->getNumOutputs()));
+        
+        ResultCode result = pl_NeuralNetworkF_BackPropBatch (&network, inputs.getArray(), targets.getArray(), numPatterns, numThreads);
+        plonk_assert (result == PlankResult_OK);
+        
+#ifndef PLONK_DEBUG
+        (void)result;
+#endif
+    }
+    
+    PLONK_INLINE_LOW bool copyWeights (NeuralNetworkInternal* source) throw()
+    {
+        return pl_NeuralNetworkF_CopyWeights (&network, &source->network) == PlankResult_OK;
+    }
+    
     PLONK_INLINE_LOW void setActFunc (ActFunc const& function) throw()
     {
         ResultCode result = pl_NeuralNetworkF_SetActFunc (&network, function);
@@ -332,6 +396,22 @@ public:
         return *this;
 	}
     
+    /** Make an independent copy of this network. 
+     The copy has the same structure, weights and settings but does not 
+     share any memory with the original. */
+    NeuralNetworkBase deepCopy() const throw()
+    {
+        return NeuralNetworkBase (new Internal (&this->getInternal()->network));
+    }
+    
+    /** Copy the weights and thresholds from another network.
+     This does not allocate memory.
+     @return @c false if the networks have different structures. */
+    PLONK_INLINE_LOW bool copyWeights (NeuralNetworkBase const& source) throw()
+    {
+        return this->getInternal()->copyWeights (source.getInternal());
+    }
+    
     PLONK_INLINE_LOW const VectorType& propogate (VectorType const& inputs) throw()
     {
         return this->getInternal()->propogate (inputs);
@@ -359,6 +439,74 @@ public:
         }
     }
     
+    /** Propogate many input vectors at once.
+     @param outputs Receives the output vectors, one after another.
+     @param inputs The input vectors, one after another.
+     @param numPatterns The number of input vectors in @c inputs. */
+    PLONK_INLINE_LOW void propogateBatch (VectorType& outputs, VectorType const& inputs, const int numPatterns) throw()
+    {
+        return this->getInternal()->propogateBatch (outputs, inputs, numPatterns);
+    }
+    
+    /** Propogate many input vectors at once without allocating memory.
+     Call reserveBatch() first so that this is safe to use on the audio thread.
+     @param outputs Receives numPatterns * getNumOutputs() values.
+     @param inputs The numPatterns * getNumInputs() input values. 
+     @param numPatterns The number of input vectors. */
+    PLONK_INLINE_LOW void propogateBatch (float* outputs, const float* inputs, const int numPatterns) throw()
+    {
+        return this->getInternal()->propogateBatch (outputs, inputs, numPatterns);
+    }
+    
+    /** Allocate the scratch space needed to propogate batches of up to @c maxPatterns. */
+    PLONK_INLINE_LOW void reserveBatch (const int maxPatterns) throw()
+    {
+        return this->getInternal()->reserveBatch (maxPatterns);
+    }
+    
+    /** Update the weights once from the mean gradient of a batch of patterns.
+     @param inputs The input vectors, one after another.
+     @param targets The target vectors, one after another.
+     @param numPatterns The number of patterns.
+     @param numThreads The number of threads to split the batch between, 0 uses one per core. */
+    PLONK_INLINE_LOW void backPropBatch (VectorType const& inputs, VectorType const& targets, const int numPatterns, const int numThreads = 1) throw()
+    {
+        return this->getInternal()->backPropBatch (inputs, targets, numPatterns, numThreads);
+    }
+    
+    /** Train using mini-batches rather than updating after every pattern. */
+    void trainBatch (Patterns const& patterns, const int numEpochs, const int batchSize, const int numThreads = 1) throw()
+    {
+        const int numPatterns = patterns.length();
+        const Pattern* patternArray = patterns.getArray();
+        const int numInputs = this->getNumInputs();
+        const int numOutputs = this->getNumOutputs();
+        const int batchSizeChecked = plonk::max (1, batchSize);
+        
+        VectorType inputs = VectorType::withSize (numPatterns * numInputs);
+        VectorType targets = VectorType::withSize (numPatterns * numOutputs);
+        
+        for (int j = 0; j < numPatterns; ++j)
+        {
+            VectorType::copyData (inputs.getArray() + j * numInputs, patternArray[j].i.getArray(), numInputs);
+            VectorType::copyData (targets.getArray() + j * numOutputs, patternArray[j].t.getArray(), numOutputs);
+        }
+        
+        for (int i = 0; i < numEpochs; ++i)
+        {
+            for (int j = 0; j < numPatterns; j += batchSizeChecked)
+            {
+                const int numPatternsThisTime = plonk::min (batchSizeChecked, numPatterns - j);
+                
+                pl_NeuralNetworkF_BackPropBatch (&this->getInternal()->network,
+                                                 inputs.getArray() + j * numInputs,
+                                                 targets.getArray() + j * numOutputs,
+                                                 numPatternsThisTime,
+                                                 numThreads);
+            }
+        }
+    }
+    
     void reset (const ValueType amount = 0.1f) throw()
     {
         pl_NeuralNetworkF_Reset (&this->getInternal()->network, amount);
@@ -404,5 +552,166 @@ public:
 
 typedef NeuralNetworkBase<float> FloatNeuralNetwork;
 
+//------------------------------------------------------------------------------
+
+template<class ValueType>
+class NeuralNetworkDoubleBufferInternal : public SmartPointer
+{
+public:
+    typedef NeuralNetworkBase<ValueType>    NetworkType;
+    
+    enum StateFlags
+    {
+        ActiveMask = 1,
+        Pending = 2
+    };
+    
+    NeuralNetworkDoubleBufferInternal (NetworkType const& network) throw()
+    :   state (0)
+    {
+        networks[0] = network.deepCopy();
+        networks[1] = network.deepCopy();
+    }
+    
+    PLONK_INLINE_LOW bool setWeights (NetworkType const& source) throw()
+    {
+        const int current = state.getValue();
+        
+        if (current & Pending)
+            return false;
+        
+        if (! networks[(current & ActiveMask) ^ 1].copyWeights (source))
+            return false;
+        
+        return state.compareAndSwap (current, current | Pending);
+    }
+    
+    PLONK_INLINE_LOW NetworkType& getActive() throw()
+    {
+        const int current = state.getValue();
+        
+        if ((current & Pending) && state.compareAndSwap (current, (current & ActiveMask) ^ 1))
+            return networks[(current & ActiveMask) ^ 1];
+        
+        return networks[current & ActiveMask];
+    }
+    
+    PLONK_INLINE_LOW NetworkType& getNetwork (const int index) throw()
+    {
+        return networks[index & 1];
+    }
+    
+    PLONK_INLINE_LOW bool isPending() const throw()
+    {
+        return (state.getValue() & Pending) != 0;
+    }
+    
+private:
+    NetworkType networks[2];
+    AtomicInt state;
+};
+
+//------------------------------------------------------------------------------
+
+/** Shares a neural network between a control thread and the audio thread.
+ Two copies of the network are held. The audio thread evaluates the active 
+ copy while new weights are copied into the other, the copies are then 
+ swapped by the audio thread the next time it asks for the active network. 
+ Neither side takes a lock or allocates memory once constructed. Only one 
+ thread should call setWeights() and only one thread should call getActive().
+ @ingroup PlonkMiscClasses */
+template<class ValueType>                                               
+class NeuralNetworkDoubleBufferBase : public SmartPointerContainer<NeuralNetworkDoubleBufferInternal<ValueType> >
+{
+public:
+    typedef NeuralNetworkDoubleBufferInternal<ValueType>        Internal;
+    typedef SmartPointerContainer<Internal>                     Base;
+    typedef WeakPointerContainer<NeuralNetworkDoubleBufferBase> Weak;
+    typedef typename Internal::NetworkType                      NetworkType;
+    
+    NeuralNetworkDoubleBufferBase() throw()
+    :   Base (new Internal (NetworkType()))
+    {
+    }
+    
+    /** Create a double buffer holding two copies of a network.
+     The network is copied so later changes to @c network itself are not seen, 
+     use setWeights() to update the copies. */
+    NeuralNetworkDoubleBufferBase (NetworkType const& network) throw()
+    :   Base (new Internal (network))
+    {
+    }
+    
+    explicit NeuralNetworkDoubleBufferBase (Internal* internalToUse) throw()
+	:	Base (internalToUse)
+	{
+	} 
+    
+    /** Copy constructor.
+	 Note that a deep copy is not made, the copy will refer to exactly the same data. */
+    NeuralNetworkDoubleBufferBase (NeuralNetworkDoubleBufferBase const& copy) throw()
+    :   Base (static_cast<Base const&> (copy))
+    {
+    }
+    
+    NeuralNetworkDoubleBufferBase (Dynamic const& other) throw()
+    :   Base (other.as<NeuralNetworkDoubleBufferBase>().getInternal())
+    {
+    }    
+    
+    /** Assignment operator. */
+    NeuralNetworkDoubleBufferBase& operator= (NeuralNetworkDoubleBufferBase const& other) throw()
+	{
+		if (this != &other)
+            this->setInternal (other.getInternal());
+        
+        return *this;
+	}
+    
+    static NeuralNetworkDoubleBufferBase fromWeak (Weak const& weak) throw()
+    {
+        return weak.fromWeak();
+    }    
+    
+    static const NeuralNetworkDoubleBufferBase& getNull() throw()
+	{
+		static NeuralNetworkDoubleBufferBase null;
+		return null;
+	}	
+    
+    /** Queue new weights for the audio thread.
+     The weights are copied into the inactive network immediately and are 
+     picked up at the audio thread's next call to getActive(). 
+     @return @c false if the previous weights have not been picked up yet or 
+     if @c source has a different structure, in which case nothing changes. */
+    PLONK_INLINE_LOW bool setWeights (NetworkType const& source) throw()
+    {
+        return this->getInternal()->setWeights (source);
+    }
+    
+    /** Get the network to evaluate, swapping in any pending weights. 
+     This should only be called from the thread evaluating the network. */
+    PLONK_INLINE_LOW NetworkType& getActive() throw()
+    {
+        return this->getInternal()->getActive();
+    }
+    
+    /** Get one of the two copies directly, for preparing them before use. */
+    PLONK_INLINE_LOW NetworkType& getNetwork (const int index) const throw()
+    {
+        return this->getInternal()->getNetwork (index);
+    }
+    
+    /** Determine whether weights are waiting to be picked up. */
+    PLONK_INLINE_LOW bool isPending() const throw()
+    {
+        return this->getInternal()->isPending();
+    }
+    
+    PLONK_OBJECTARROWOPERATOR(NeuralNetworkDoubleBufferBase);
+};
+
+typedef NeuralNetworkDoubleBufferBase<float> FloatNeuralNetworkDoubleBuffer;
+
 
 #endif // PLONK_NEURALNETWORK_H